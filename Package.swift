@@ -37,10 +37,16 @@ let package = Package(
             path: "Sources/CxxHash",
             publicHeadersPath: "include"
         ),
+        // 系统 zlib（预置字典 deflate，用于全局库文本列压缩）
+        .systemLibrary(
+            name: "CZlib",
+            path: "Sources/CZlib"
+        ),
         .target(
             name: "FindItCore",
             dependencies: [
                 "CxxHash",
+                "CZlib",
                 .product(name: "GRDB", package: "GRDB.swift"),
                 .product(name: "WhisperKit", package: "WhisperKit"),
                 .product(name: "MLXVLM", package: "mlx-swift-lm"),
@@ -0,0 +1,2 @@
+// 系统 zlib（macOS 自带 libz）：全局库文本列的预置字典压缩
+#include <zlib.h>
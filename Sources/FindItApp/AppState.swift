@@ -43,6 +43,11 @@ final class AppState {
     /// 数据库是否已初始化
     var isInitialized = false
 
+    /// FTS5 索引空闲维护（数据库打开后启动）
+    private(set) var ftsMaintenance: FTSMaintenance?
+    /// 全局库后台 WAL 检查点
+    private(set) var walCheckpointer: WALCheckpointer?
+
     /// 初始化错误信息
     var initError: String?
 
@@ -52,6 +57,9 @@ final class AppState {
     /// FileWatcherManager 引用（由 ContentView 注入）
     weak var fileWatcherManager: FileWatcherManager?
 
+    /// SearchState 引用（由 ContentView 注入，移除文件夹后增量刷新向量索引）
+    weak var searchState: SearchState?
+
     /// 卷信息缓存（避免每次 reloadFolders 都做文件系统调用）
     private var volumeInfoCache: [String: VolumeResolver.VolumeInfo] = [:]
 
@@ -69,6 +77,17 @@ final class AppState {
                 try DatabaseManager.openGlobalDatabase()
             }.value
             self.globalDB = db
+            let maintenance = FTSMaintenance(db: db, mode: IndexingOptions.load().performanceMode)
+            self.ftsMaintenance = maintenance
+            await maintenance.start()
+            let checkpointer = WALCheckpointer(db: db)
+            self.walCheckpointer = checkpointer
+            await checkpointer.start()
+            // 后台整理长文本：首次训练字典，并把仍为明文的描述 / 转录改写为压缩存储
+            Task.detached(priority: .background) {
+                _ = try? TextCompression.compact(db)
+            }
+            FolderDatabasePool.shared.startIdleSweep()
             loadBookmarks()
             try reloadFolders()
             self.isInitialized = true
@@ -113,7 +132,7 @@ final class AppState {
             volumeInfoCache[path] = volumeInfo
 
             try await Task.detached(priority: .userInitiated) {
-                let folderDB = try DatabaseManager.openFolderDatabase(at: path)
+                let folderDB = try FolderDatabasePool.shared.database(at: path)
 
                 // 便携索引：检测并修复路径偏移（跨机器/路径变更）
                 let rebaseResult = try PathRebaser.rebaseIfNeeded(
@@ -164,7 +183,7 @@ final class AppState {
             volumeInfoCache[path] = volumeInfo
 
             try await Task.detached(priority: .userInitiated) {
-                let folderDB = try DatabaseManager.openFolderDatabase(at: path)
+                let folderDB = try FolderDatabasePool.shared.database(at: path)
 
                 // 便携索引：检测并修复路径偏移（跨机器/路径变更）
                 let rebaseResult = try PathRebaser.rebaseIfNeeded(
@@ -215,7 +234,11 @@ final class AppState {
         fileWatcherManager?.unwatchFolder(path)
         guard let globalDB = globalDB else { return }
 
-        try SyncEngine.removeFolderData(folderPath: path, from: globalDB)
+        let removedClipIds = try SyncEngine.removeFolderData(folderPath: path, from: globalDB)
+        FolderDatabasePool.shared.close(folderPath: path)
+        if let searchState {
+            Task { await searchState.applyRemovedClips(removedClipIds) }
+        }
 
         // 同时移除该文件夹下的所有子文件夹书签
         subfolderBookmarks.removeAll { bookmark in
@@ -101,12 +101,14 @@ struct ContentView: View {
             appState.indexingManager = indexingManager
             volumeMonitor.appState = appState
             volumeMonitor.indexingManager = indexingManager
+            volumeMonitor.searchState = searchState
             volumeMonitor.startMonitoring()
             fileWatcherManager.appState = appState
             fileWatcherManager.indexingManager = indexingManager
             fileWatcherManager.searchState = searchState
             indexingManager.fileWatcherManager = fileWatcherManager
             appState.fileWatcherManager = fileWatcherManager
+            appState.searchState = searchState
             NotificationManager.requestPermission()
             await appState.initialize()
             // 启动时主动对账卷路径重定向（处理“卷已挂载但无出现事件”的场景）。
@@ -115,13 +117,24 @@ struct ContentView: View {
             // 启动后自动恢复可达文件夹的索引任务（含 pending/failed/orphan 恢复路径）。
             indexingManager.indexPendingFolders()
             searchState.loadFacets()
+            searchState.startVectorStoreWarmup()
+            searchState.loadClipMetadataCache()
+            // 继续上次未完成的文件回收（删除视频后的缩略图 / SRT）
+            Task.detached(priority: .background) {
+                let folders = await appState.folders
+                for folder in folders where folder.isAvailable {
+                    if let folderDB = try? FolderDatabasePool.shared.database(at: folder.folderPath) {
+                        FileGarbageCollector.shared.schedule(folderPath: folder.folderPath, folderDB: folderDB)
+                    }
+                }
+            }
             // 清理过期 orphaned 记录
             Task.detached(priority: .utility) {
                 let retention = IndexingOptions.load().orphanedRetentionDays
                 guard retention > 0 else { return }
                 let folders = await appState.folders
                 for folder in folders where folder.isAvailable {
-                    if let folderDB = try? DatabaseManager.openFolderDatabase(at: folder.folderPath) {
+                    if let folderDB = try? FolderDatabasePool.shared.database(at: folder.folderPath) {
                         let result = try? OrphanRecovery.cleanupExpired(
                             retentionDays: retention,
                             folderPath: folder.folderPath,
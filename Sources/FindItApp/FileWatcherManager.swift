@@ -193,7 +193,7 @@ final class FileWatcherManager {
         let folderDB: DatabasePool
         do {
             folderDB = try await runBlockingIO {
-                try DatabaseManager.openFolderDatabase(at: folderPath)
+                try FolderDatabasePool.shared.database(at: folderPath)
             }
         } catch {
             print("[FileWatcherManager] 无法打开文件夹数据库: \(error)")
@@ -255,12 +255,12 @@ final class FileWatcherManager {
                 }
                 if result.markedCount > 0 {
                     try? appState?.reloadFolders()
-                    searchState?.invalidateVectorStore()
+                    await searchState?.applyRemovedClips(result.removedGlobalClipIds)
                     print("[FileWatcherManager] 软删除 \(result.markedCount) 个视频 from \(folderPath)")
                 }
             } else {
                 // 硬删除：立即清除所有数据
-                let count = try await runBlockingIO {
+                let result = try await runBlockingIO {
                     try VideoManager.removeVideos(
                         videoPaths: paths,
                         folderPath: folderPath,
@@ -268,10 +268,10 @@ final class FileWatcherManager {
                         globalDB: globalDB
                     )
                 }
-                if count > 0 {
+                if result.removedFromFolder > 0 {
                     try? appState?.reloadFolders()
-                    searchState?.invalidateVectorStore()
-                    print("[FileWatcherManager] 硬删除 \(count) 个视频 from \(folderPath)")
+                    await searchState?.applyRemovedClips(result.removedGlobalClipIds)
+                    print("[FileWatcherManager] 硬删除 \(result.removedFromFolder) 个视频 from \(folderPath)")
                 }
             }
         } catch {
@@ -64,7 +64,7 @@ final class IndexingManager {
 
     /// FileWatcherManager 引用（用于索引冲突信号）
     weak var fileWatcherManager: FileWatcherManager?
-    /// SearchState 引用（用于索引后失效 VectorStore）
+    /// SearchState 引用（用于索引后增量刷新 VectorStore）
     weak var searchState: SearchState?
 
     // MARK: - 私有状态
@@ -265,7 +265,7 @@ final class IndexingManager {
         let folderDB: DatabasePool
         do {
             folderDB = try await runBlockingIO {
-                try DatabaseManager.openFolderDatabase(at: folderPath)
+                try FolderDatabasePool.shared.database(at: folderPath)
             }
         } catch {
             print("[IndexingManager] 打开文件夹数据库失败: \(error)")
@@ -331,8 +331,8 @@ final class IndexingManager {
                 }
             }
         )
-        if let syncResult, syncResult.syncedClips > 0 {
-            searchState?.invalidateVectorStore()
+        if let syncResult, syncResult.hasClipChanges {
+            await searchState?.applySyncDelta(syncResult)
         }
 
         currentVideoName = nil
@@ -377,7 +377,7 @@ final class IndexingManager {
         let folderDB: DatabasePool
         do {
             folderDB = try await runBlockingIO {
-                try DatabaseManager.openFolderDatabase(at: folderPath)
+                try FolderDatabasePool.shared.database(at: folderPath)
             }
         } catch {
             print("[IndexingManager] 打开文件夹数据库失败（增量）: \(error)")
@@ -440,8 +440,8 @@ final class IndexingManager {
                 }
             }
         )
-        if let syncResult, syncResult.syncedClips > 0 {
-            searchState?.invalidateVectorStore()
+        if let syncResult, syncResult.hasClipChanges {
+            await searchState?.applySyncDelta(syncResult)
         }
 
         currentVideoName = nil
@@ -459,6 +459,9 @@ final class IndexingManager {
         let newScheduler = IndexingScheduler(mode: mode)
         scheduler = newScheduler
         currentMode = mode
+        if let maintenance = appState?.ftsMaintenance {
+            Task { await maintenance.setMode(mode) }
+        }
         return newScheduler
     }
 
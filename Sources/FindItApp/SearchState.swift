@@ -6,6 +6,8 @@ import FindItCore
 ///
 /// 管理搜索查询、结果列表和搜索模式。
 /// 两层搜索：FTS5 即时执行（<5ms）+ 向量搜索 300ms debounce。
+/// 查询嵌入在输入停顿后推测式启动（`SpeculativeQueryEmbedder`），
+/// debounce 结束时通常已就绪，直接进入 VectorStore 搜索。
 /// 过滤和排序在内存中应用于搜索结果。
 @Observable
 @MainActor
@@ -15,6 +17,7 @@ final class SearchState {
         didSet {
             if query != oldValue {
                 performFTSSearch()
+                speculateQueryEmbedding()
                 scheduleVectorSearch()
             }
         }
@@ -53,7 +56,6 @@ final class SearchState {
     var folderFilter: Set<String>? = nil {
         didSet {
             if folderFilter != oldValue {
-                invalidateVectorFilterCache()
                 performFTSSearch()
                 scheduleVectorSearch()
                 loadFacets()
@@ -65,7 +67,6 @@ final class SearchState {
     var pathPrefixFilter: String? = nil {
         didSet {
             if pathPrefixFilter != oldValue {
-                invalidateVectorFilterCache()
                 performFTSSearch()
                 scheduleVectorSearch()
             }
@@ -84,30 +85,127 @@ final class SearchState {
     /// 是否已尝试初始化 provider（避免反复尝试）
     private var hasTriedInitProvider = false
 
+    /// 推测式查询嵌入器（与 embeddingProvider 同时初始化）
+    private var queryEmbedder: SpeculativeQueryEmbedder?
+
     /// 内存向量存储（批量矩阵搜索，100K clips ~25ms）
     private var vectorStore: VectorStore?
 
     /// 是否正在加载 VectorStore（避免重复加载）
     private var isLoadingVectorStore = false
 
-    /// 向量过滤缓存 key（folder/path 过滤变化时失效）
-    private struct VectorFilterCacheKey: Equatable {
-        let folderFilter: Set<String>?
-        let pathPrefixFilter: String?
+    /// VectorStore 后台预热（启动时恢复快照或流式构建）
+    private var vectorStoreWarmup: VectorStoreWarmup?
 
-        var requiresFiltering: Bool { folderFilter != nil || pathPrefixFilter != nil }
-    }
+    /// 预热状态（侧边栏指示器显示）
+    var vectorStoreStatus: VectorStoreWarmup.Status = .idle
+
+    /// VectorStore 失效代数（加载期间发生失效时丢弃过期结果）
+    private var vectorStoreGeneration = 0
+
+    /// 向量过滤位图缓存（按文件夹/路径前缀缓存，切换过滤范围直接命中）
+    private let vectorFilterBitmaps = VectorFilterBitmapCache()
+
+    /// 规划统计缓存（clip 总数 / 文件夹计数，随同步失效）
+    private let plannerStatistics = QueryStatisticsCache()
+
+    /// 片段元数据列式缓存（向量结果补全不再查询 SQLite）
+    private let clipMetadata = ClipMetadataCache(fileURL: try? ClipMetadataCache.defaultURL())
 
-    /// 过滤缓存（避免每次输入都重复查询 clip_id 集合）
-    private var vectorFilterCache: (key: VectorFilterCacheKey, clipIDs: Set<Int64>)?
+    /// VectorStore 加载期间到达的同步增量（加载完成后补应用）
+    private var pendingSyncDeltas: [SyncEngine.SyncResult] = []
 
     /// 使 VectorStore 缓存失效
     ///
-    /// 当视频被删除时由 FileWatcherManager 调用，
-    /// 确保下次向量搜索重新从数据库加载最新数据。
+    /// 用于无法表达为增量的变化（如添加文件夹）或增量刷新失败，
+    /// 下次向量搜索重新加载；视频删除走 `applyRemovedClips`。
     func invalidateVectorStore() {
         vectorStore = nil
+        vectorStoreGeneration += 1
+        pendingSyncDeltas.removeAll()
         invalidateVectorFilterCache()
+        plannerStatistics.invalidate()
+        if let warmup = vectorStoreWarmup {
+            vectorStoreWarmup = nil
+            vectorStoreStatus = .idle
+            Task { await warmup.invalidate() }
+        }
+    }
+
+    /// 后台加载片段元数据缓存（指纹一致时直接映射磁盘文件）
+    func loadClipMetadataCache() {
+        reloadClipMetadataCache(rebuild: false)
+    }
+
+    private func reloadClipMetadataCache(rebuild: Bool) {
+        guard let db = appState?.globalDB else { return }
+        let cache = clipMetadata
+        Task.detached(priority: .utility) {
+            if rebuild {
+                try? await cache.rebuild(from: db)
+            } else {
+                try? await cache.load(from: db)
+            }
+        }
+    }
+
+    /// 启动 VectorStore 后台预热
+    ///
+    /// 由 ContentView 在启动完成后调用：有快照时直接恢复，
+    /// 否则后台分页构建，首次向量搜索无需再等待全量加载。
+    func startVectorStoreWarmup() {
+        guard vectorStore == nil,
+              let provider = getEmbeddingProvider(),
+              let db = appState?.globalDB else { return }
+        let warmup = ensureVectorStoreWarmup(provider: provider, db: db)
+        Task { await warmup.start() }
+    }
+
+    /// 按同步增量原地刷新 VectorStore
+    ///
+    /// 由 IndexingManager 在每轮索引同步后调用。只读取新增/更新 clip 的
+    /// embedding 并批量 append/remove，避免活跃索引期间反复全量重载。
+    /// 刷新失败时回退为失效（下次查询全量重载）。
+    func applySyncDelta(_ result: SyncEngine.SyncResult) async {
+        // 过滤位图绑定 store 行布局，增删行后自动重建；
+        // 但路径重定向后的强制同步只改 file_path、不增删行，路径前缀位图需显式失效
+        guard result.hasClipChanges else { return }
+        let bitmaps = vectorFilterBitmaps
+        await bitmaps.invalidatePathPrefixes()
+        plannerStatistics.invalidate()
+
+        if let db = appState?.globalDB {
+            do {
+                try await clipMetadata.applySyncDelta(result, from: db)
+            } catch {
+                // 元数据缓存刷新失败：全量重建，期间补全回退 SQLite
+                reloadClipMetadataCache(rebuild: true)
+            }
+        }
+
+        // 正在加载：记录下来，加载完成后补应用（重复应用是幂等的）
+        if isLoadingVectorStore {
+            pendingSyncDeltas.append(result)
+            return
+        }
+        // 尚未加载：下次查询的懒加载会读到最新数据
+        guard let store = vectorStore, let db = appState?.globalDB else { return }
+
+        do {
+            try await store.applySyncDelta(result, from: db)
+            await vectorStoreWarmup?.scheduleSnapshotSave()
+        } catch {
+            invalidateVectorStore()
+        }
+    }
+
+    /// 按删除的全局 clip_id 原地移除 VectorStore 与元数据缓存中的行
+    ///
+    /// 由 FileWatcherManager 在软删除（orphaned）/ 硬删除视频后调用，
+    /// 与同步增量走同一路径：加载中则排队补应用，完成后延迟保存快照。
+    func applyRemovedClips(_ clipIds: [Int64]) async {
+        guard !clipIds.isEmpty else { return }
+        await applySyncDelta(SyncEngine.SyncResult(syncedVideos: 0, syncedClips: 0, removedClipIds: clipIds))
     }
 
     // MARK: - FTS5 即时搜索
@@ -136,6 +234,19 @@ final class SearchState {
         }
     }
 
+    // MARK: - 推测式查询嵌入
+
+    /// 输入变化时为当前文本安排推测嵌入（与 debounce 并行）
+    ///
+    /// 过短的输入不推测，连续输入只在停顿后发出一次请求，
+    /// 同时只有一个在飞请求，新输入会取消旧请求。
+    private func speculateQueryEmbedding() {
+        let trimmed = query.trimmingCharacters(in: .whitespacesAndNewlines)
+        guard !trimmed.isEmpty, searchMode != .fts else { return }
+        guard getEmbeddingProvider() != nil, let embedder = queryEmbedder else { return }
+        Task { await embedder.prefetch(trimmed) }
+    }
+
     // MARK: - 向量搜索 debounce
 
     /// 调度 300ms 延迟的向量搜索
@@ -166,7 +277,7 @@ final class SearchState {
 
         // 懒初始化 embedding provider
         let provider = getEmbeddingProvider()
-        guard let provider = provider else { return }
+        guard let provider = provider, let embedder = queryEmbedder else { return }
 
         isVectorSearching = true
         defer { isVectorSearching = false }
@@ -175,37 +286,57 @@ final class SearchState {
             // 确保 VectorStore 已加载
             await loadVectorStoreIfNeeded(provider: provider, db: db)
 
-            let allowedClipIDs = try await resolveAllowedClipIDs(db: db)
-
-            let queryEmbedding = try await provider.embed(text: trimmed)
-
-            // 再次检查查询没变
-            guard trimmed == self.query.trimmingCharacters(in: .whitespacesAndNewlines) else { return }
-
-            // VectorStore 批量搜索（~25ms for 100K clips）
-            let storeResults: [(clipId: Int64, similarity: Float)]?
-            if let store = vectorStore {
-                storeResults = await store.search(
-                    query: queryEmbedding,
-                    limit: 100,
-                    allowedClipIDs: allowedClipIDs
-                )
-            } else {
-                storeResults = nil
-            }
-
+            // 按索引统计规划执行策略（FTS 已足够时不再计算查询向量）
             let mode = self.searchMode
             let filter = self.folderFilter
             let prefix = self.pathPrefixFilter
+            let storeCount = await vectorStore?.count
+            let statisticsCache = plannerStatistics
+            let plan = try await db.read { dbConn in
+                let stats = try QueryPlanner.statistics(
+                    dbConn, query: trimmed,
+                    folderPaths: filter, pathPrefixFilter: prefix,
+                    vectorStoreCount: storeCount, cache: statisticsCache
+                )
+                return QueryPlanner.plan(query: trimmed, mode: mode, hasEmbedding: true, statistics: stats, limit: 50)
+            }
+
+            var queryEmbedding: [Float]?
+            var storeResults: [(clipId: Int64, similarity: Float)]?
+            if plan.runsVector {
+                // 推测任务通常已在输入时启动，此处多为缓存/在飞命中
+                let embedding = try await embedder.embedding(for: trimmed)
+                queryEmbedding = embedding
+
+                // 再次检查查询没变
+                guard trimmed == self.query.trimmingCharacters(in: .whitespacesAndNewlines) else { return }
+
+                // VectorStore 批量搜索（~25ms for 100K clips）
+                if plan.vectorAccess == .store, let store = vectorStore {
+                    storeResults = try await vectorFilterBitmaps.search(
+                        store: store,
+                        query: embedding,
+                        plan: plan,
+                        folders: filter,
+                        pathPrefix: prefix,
+                        db: db
+                    )
+                }
+            }
+
+            let capturedEmbedding = queryEmbedding
             let capturedStoreResults = storeResults
+            let metadata = clipMetadata
             let hybridResults = try await db.read { dbConn in
                 try SearchEngine.hybridSearch(
                     dbConn,
                     query: trimmed,
-                    queryEmbedding: queryEmbedding,
+                    queryEmbedding: capturedEmbedding,
                     embeddingModel: provider.name,
                     vectorStoreResults: capturedStoreResults,
+                    metadataCache: metadata,
                     mode: mode,
+                    plan: plan,
                     folderPaths: filter,
                     pathPrefixFilter: prefix,
                     limit: 50
@@ -218,33 +349,63 @@ final class SearchState {
     }
 
     /// 懒加载 VectorStore（首次向量搜索时触发）
+    ///
+    /// 复用后台预热任务：预热进行中则等待其完成，未启动则立即启动。
     private func loadVectorStoreIfNeeded(provider: any EmbeddingProvider, db: DatabasePool) async {
         guard vectorStore == nil, !isLoadingVectorStore else { return }
         isLoadingVectorStore = true
         defer { isLoadingVectorStore = false }
 
+        let generation = vectorStoreGeneration
+        let warmup = ensureVectorStoreWarmup(provider: provider, db: db)
+        guard let store = await warmup.store(), generation == vectorStoreGeneration else {
+            // 加载失败不致命，回退到逐行扫描
+            return
+        }
+
         do {
-            let entries: [(clipId: Int64, embeddingData: Data)] = try await db.read { dbConn in
-                let rows = try Row.fetchAll(dbConn, sql: """
-                    SELECT clip_id, embedding
-                    FROM clips
-                    WHERE embedding IS NOT NULL AND embedding_model = ?
-                    """, arguments: [provider.name])
-                return rows.compactMap { row in
-                    guard let clipId = row["clip_id"] as? Int64,
-                          let data = row["embedding"] as? Data else { return nil }
-                    return (clipId: clipId, embeddingData: data)
-                }
+            // 补应用加载期间到达的同步增量
+            let deltas = pendingSyncDeltas
+            pendingSyncDeltas.removeAll()
+            for delta in deltas {
+                try await store.applySyncDelta(delta, from: db)
+            }
+            if !deltas.isEmpty {
+                await warmup.scheduleSnapshotSave()
             }
-
-            let store = VectorStore(dimensions: provider.dimensions, embeddingModel: provider.name)
-            await store.load(entries: entries)
             self.vectorStore = store
         } catch {
-            // 加载失败不致命，回退到逐行扫描
+            // 增量补应用失败：丢弃 store，下次重新构建
+            invalidateVectorStore()
         }
     }
 
+    /// 获取或创建预热器（快照路径按 embedding model 区分）
+    ///
+    /// 模型或维度变化时旧快照不可能再匹配，替换预热器的同时删除。
+    private func ensureVectorStoreWarmup(
+        provider: any EmbeddingProvider,
+        db: DatabasePool
+    ) -> VectorStoreWarmup {
+        if let warmup = vectorStoreWarmup {
+            if warmup.embeddingModel == provider.name, warmup.dimensions == provider.dimensions {
+                return warmup
+            }
+            Task { await warmup.invalidate(discardingSnapshot: true) }
+        }
+        let warmup = VectorStoreWarmup(
+            db: db,
+            embeddingModel: provider.name,
+            dimensions: provider.dimensions,
+            snapshotURL: try? VectorStoreSnapshot.defaultURL(embeddingModel: provider.name),
+            onStatus: { [weak self] status in
+                Task { @MainActor in self?.vectorStoreStatus = status }
+            }
+        )
+        vectorStoreWarmup = warmup
+        return warmup
+    }
+
     /// 获取或初始化 embedding provider
     ///
     /// 策略：Gemini（768 维，云端） → NLEmbedding（512 维，离线）。
@@ -265,6 +426,7 @@ final class SearchState {
                 config: config.toEmbeddingConfig()
             )
             self.embeddingProvider = provider
+            self.queryEmbedder = SpeculativeQueryEmbedder(provider: provider)
             return provider
         }
 
@@ -272,66 +434,16 @@ final class SearchState {
         let nlProvider = NLEmbeddingProvider()
         if nlProvider.isAvailable() {
             self.embeddingProvider = nlProvider
+            self.queryEmbedder = SpeculativeQueryEmbedder(provider: nlProvider)
             return nlProvider
         }
 
         return nil
     }
 
-    /// 解析向量过滤所需 clip_id 集合（有过滤时）
-    ///
-    /// 返回 nil 表示“无需过滤”（全局搜索）；
-    /// 返回空集表示“过滤后无候选”，向量搜索应直接返回空结果。
-    private func resolveAllowedClipIDs(db: DatabasePool) async throws -> Set<Int64>? {
-        let key = VectorFilterCacheKey(
-            folderFilter: folderFilter,
-            pathPrefixFilter: pathPrefixFilter
-        )
-        guard key.requiresFiltering else { return nil }
-
-        if let cache = vectorFilterCache, cache.key == key {
-            return cache.clipIDs
-        }
-
-        let ids: Set<Int64>
-        if let folders = key.folderFilter, folders.isEmpty {
-            ids = []
-        } else {
-            ids = try await db.read { dbConn in
-                var args = StatementArguments()
-                var whereClauses: [String] = []
-
-                if let folders = key.folderFilter {
-                    let sortedFolders = folders.sorted()
-                    let placeholders = sortedFolders.map { _ in "?" }.joined(separator: ", ")
-                    whereClauses.append("c.source_folder IN (\(placeholders))")
-                    for path in sortedFolders {
-                        args += [path]
-                    }
-                }
-
-                if let prefix = key.pathPrefixFilter {
-                    whereClauses.append("v.file_path LIKE ? || '/%'")
-                    args += [prefix]
-                }
-
-                let whereSQL = whereClauses.isEmpty ? "" : "WHERE " + whereClauses.joined(separator: " AND ")
-                let rows = try Int64.fetchAll(dbConn, sql: """
-                    SELECT c.clip_id
-                    FROM clips c
-                    LEFT JOIN videos v ON v.video_id = c.video_id
-                    \(whereSQL)
-                    """, arguments: args)
-                return Set(rows)
-            }
-        }
-
-        vectorFilterCache = (key: key, clipIDs: ids)
-        return ids
-    }
-
     private func invalidateVectorFilterCache() {
-        vectorFilterCache = nil
+        let bitmaps = vectorFilterBitmaps
+        Task { await bitmaps.invalidate() }
     }
 
     // MARK: - 分面统计
@@ -356,6 +468,7 @@ final class SearchState {
         if let index = results.firstIndex(where: { $0.clipId == clipId }) {
             results[index].rating = rating
         }
+        clipMetadata.patch(clipId: clipId) { $0.rating = rating }
     }
 
     /// 更新片段颜色标签（内存同步，触发 displayResults 重算）
@@ -363,6 +476,7 @@ final class SearchState {
         if let index = results.firstIndex(where: { $0.clipId == clipId }) {
             results[index].colorLabel = colorLabel
         }
+        clipMetadata.patch(clipId: clipId) { $0.colorLabel = colorLabel }
     }
 
     // MARK: - 公开方法
@@ -380,6 +494,9 @@ final class SearchState {
     /// 清空搜索
     func clearSearch() {
         vectorSearchTask?.cancel()
+        if let embedder = queryEmbedder {
+            Task { await embedder.cancelPending() }
+        }
         query = ""
         results = []
     }
@@ -186,7 +186,7 @@ struct ClipCard: View {
     private func setRating(_ rating: Int) {
         do {
             // 写入文件夹库（Source of truth）
-            let folderDB = try DatabaseManager.openFolderDatabase(at: result.sourceFolder)
+            let folderDB = try FolderDatabasePool.shared.database(at: result.sourceFolder)
             try folderDB.write { db in
                 try ClipLabel.updateRating(db, clipId: result.sourceClipId, rating: rating)
             }
@@ -204,7 +204,7 @@ struct ClipCard: View {
     private func setColorLabel(_ label: ColorLabel?) {
         do {
             // 写入文件夹库
-            let folderDB = try DatabaseManager.openFolderDatabase(at: result.sourceFolder)
+            let folderDB = try FolderDatabasePool.shared.database(at: result.sourceFolder)
             try folderDB.write { db in
                 try ClipLabel.updateColorLabel(db, clipId: result.sourceClipId, label: label)
             }
@@ -222,27 +222,19 @@ struct ClipCard: View {
     }
 
     /// 同步颜色标签到视频文件的 Finder 标签系统
+    ///
+    /// 入队后立即返回，由 `FileTagWriter` 合并同一文件的连续修改并按卷批量写出。
     private func syncFinderTag(label: ColorLabel?) {
-        guard let filePath = result.filePath,
-              FileManager.default.fileExists(atPath: filePath) else { return }
-        do {
-            if label != nil {
-                try ClipLabel.syncFinderTag(filePath: filePath, label: label)
-            } else {
-                // 清除时检查同视频其他片段是否仍有颜色
-                let effectiveLabel: ColorLabel?
-                if let videoId = result.videoId, let db = globalDB {
-                    effectiveLabel = try db.read { dbConn in
-                        try ClipLabel.effectiveVideoColor(dbConn, videoId: videoId)
-                    }
-                } else {
-                    effectiveLabel = nil
-                }
-                try ClipLabel.syncFinderTag(filePath: filePath, label: effectiveLabel)
+        guard let filePath = result.filePath else { return }
+        var effectiveLabel = label
+        if label == nil, let videoId = result.videoId, let db = globalDB {
+            // 清除时检查同视频其他片段是否仍有颜色
+            effectiveLabel = try? db.read { dbConn in
+                try ClipLabel.effectiveVideoColor(dbConn, videoId: videoId)
             }
-        } catch {
-            // Finder 标签同步失败不致命（文件可能在只读卷上）
         }
+        // 写入失败不致命（文件可能在只读卷上），由写入器记录
+        FileTagWriter.shared.enqueue(path: filePath, label: effectiveLabel)
     }
 
     // MARK: - Helpers
@@ -147,3 +147,31 @@ struct IndexingProgressRing: View {
         return hasErrors ? .orange.opacity(0.7) : .secondary.opacity(0.5)
     }
 }
+
+/// 向量索引预热指示器
+///
+/// 启动时 VectorStore 在后台恢复/构建期间显示小型转圈，
+/// 悬停提示加载进度；就绪后自动隐藏。
+struct VectorStoreStatusIndicator: View {
+    @Environment(SearchState.self) private var searchState
+
+    var body: some View {
+        if searchState.vectorStoreStatus.isWarming {
+            ProgressView()
+                .controlSize(.small)
+                .help(helpText)
+                .accessibilityLabel(helpText)
+        }
+    }
+
+    private var helpText: String {
+        switch searchState.vectorStoreStatus {
+        case .restoringSnapshot:
+            return "正在恢复语义索引…"
+        case .building(let loaded, let total):
+            return "正在加载语义索引 \(loaded)/\(total)"
+        default:
+            return ""
+        }
+    }
+}
@@ -7,6 +7,7 @@ import FindItCore
 /// 使用 LazyVGrid 自适应布局展示搜索结果卡片。
 /// 列数随窗口宽度自动调整（最小卡片宽度 200px）。
 /// 支持键盘方向键导航，选中项自动滚动到可见区域。
+/// 卡片出现时按滚动位置预取后续缩略图。
 struct ResultsGrid: View {
     let results: [SearchEngine.SearchResult]
     let resultCount: Int
@@ -24,7 +25,7 @@ struct ResultsGrid: View {
         ScrollView {
             ScrollViewReader { proxy in
                 LazyVGrid(columns: columns, spacing: 12) {
-                    ForEach(results, id: \.clipId) { result in
+                    ForEach(Array(results.enumerated()), id: \.element.clipId) { index, result in
                         ClipCard(
                             result: result,
                             isSelected: result.clipId == selectedClipId,
@@ -33,9 +34,13 @@ struct ResultsGrid: View {
                             onSelect: { selectedClipId = result.clipId }
                         )
                         .id(result.clipId)
+                        .onAppear { prefetchThumbnails(from: index) }
                     }
                 }
                 .padding(16)
+                .onChange(of: results.map(\.clipId)) {
+                    prefetchThumbnails(from: 0)
+                }
                 .onChange(of: selectedClipId) {
                     guard scrollOnSelect, let id = selectedClipId else { return }
                     scrollOnSelect = false
@@ -67,6 +72,16 @@ struct ResultsGrid: View {
         }
     }
 
+    /// 按滚动位置预取缩略图
+    ///
+    /// 卡片出现时预取其后若干行，快速滚动时新的窗口会替换旧的预取批次。
+    private func prefetchThumbnails(from index: Int) {
+        guard index < results.count else { return }
+        let lookahead = max(columnsPerRow, 1) * 6
+        let paths = results[index...].prefix(lookahead).compactMap(\.thumbnailPath)
+        Task { await ThumbnailService.shared.prefetch(paths) }
+    }
+
     /// 根据容器宽度计算自适应列数
     ///
     /// 匹配 `GridItem(.adaptive(minimum: 200, maximum: 400), spacing: 12)` 的布局逻辑。
@@ -123,6 +123,8 @@ struct SidebarView: View {
 
                 Spacer()
 
+                VectorStoreStatusIndicator()
+
                 IndexingProgressRing(indexingManager: indexingManager)
             }
             .padding()
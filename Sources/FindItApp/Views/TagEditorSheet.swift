@@ -113,7 +113,7 @@ struct TagEditorSheet: View {
 
     private func loadTags() {
         do {
-            let folderDB = try DatabaseManager.openFolderDatabase(at: sourceFolder)
+            let folderDB = try FolderDatabasePool.shared.database(at: sourceFolder)
             currentTags = try folderDB.read { db in
                 try TagManager.fetchUserTags(db, clipId: sourceClipId)
             }
@@ -146,7 +146,7 @@ struct TagEditorSheet: View {
         guard !trimmed.isEmpty, !currentTags.contains(trimmed) else { return }
 
         do {
-            let folderDB = try DatabaseManager.openFolderDatabase(at: sourceFolder)
+            let folderDB = try FolderDatabasePool.shared.database(at: sourceFolder)
             try folderDB.write { db in
                 try TagManager.addTags(db, clipId: sourceClipId, tags: [trimmed])
             }
@@ -159,7 +159,7 @@ struct TagEditorSheet: View {
 
     private func removeTag(_ tag: String) {
         do {
-            let folderDB = try DatabaseManager.openFolderDatabase(at: sourceFolder)
+            let folderDB = try FolderDatabasePool.shared.database(at: sourceFolder)
             try folderDB.write { db in
                 try TagManager.removeTags(db, clipId: sourceClipId, tags: [tag])
             }
@@ -174,7 +174,7 @@ struct TagEditorSheet: View {
     private func syncToGlobal() {
         guard let gdb = globalDB else { return }
         do {
-            let folderDB = try DatabaseManager.openFolderDatabase(at: sourceFolder)
+            let folderDB = try FolderDatabasePool.shared.database(at: sourceFolder)
             _ = try SyncEngine.sync(
                 folderPath: sourceFolder,
                 folderDB: folderDB,
@@ -20,6 +20,9 @@ final class VolumeMonitor {
     /// IndexingManager 引用
     weak var indexingManager: IndexingManager?
 
+    /// SearchState 引用（路径变更后刷新搜索缓存）
+    weak var searchState: SearchState?
+
     /// DiskArbitration session
     private var session: DASession?
 
@@ -118,6 +121,9 @@ final class VolumeMonitor {
         guard let mountPointURL = description[kDADiskDescriptionVolumePathKey as String] as? URL else { return }
         let mountPoint = mountPointURL.path
 
+        // 挂载表可能尚未收到自己的回调，先失效再解析
+        MountTable.shared.invalidate()
+
         // 通过 VolumeResolver 获取卷信息（URL.resourceValues，安全的 Swift API）
         let volumeInfo = VolumeResolver.resolve(path: mountPoint)
         let volumeName = volumeInfo.name
@@ -137,6 +143,7 @@ final class VolumeMonitor {
         let mountPoint = mountPointURL.path
 
         let volumeName = description[kDADiskDescriptionVolumeNameKey as String] as? String
+        MountTable.shared.invalidate()
 
         print("[VolumeMonitor] 卷卸载: \(volumeName ?? "未知") at \(mountPoint)")
 
@@ -208,6 +215,11 @@ final class VolumeMonitor {
         }
 
         if !affectedFolders.isEmpty {
+            // 释放离线文件夹的连接池（卷已不可访问，保留只会占用描述符）
+            for path in affectedFolders {
+                FolderDatabasePool.shared.close(folderPath: path)
+            }
+
             // 获取卷名（用于通知），在 reloadFolders 之前取
             let volumeName = appState.folders
                 .first { affectedFolders.contains($0.folderPath) }?
@@ -235,7 +247,8 @@ final class VolumeMonitor {
 
         do {
             // 修复文件夹库路径（source of truth）
-            let folderDB = try DatabaseManager.openFolderDatabase(at: newPath)
+            FolderDatabasePool.shared.close(folderPath: oldPath)
+            let folderDB = try FolderDatabasePool.shared.database(at: newPath)
             let rebaseResult = try PathRebaser.rebaseIfNeeded(
                 folderDB: folderDB,
                 newPath: newPath
@@ -255,12 +268,16 @@ final class VolumeMonitor {
             }
 
             // Force sync 更新全局库中的路径字段（file_path, srt_path, thumbnail_path 等）
-            let _ = try SyncEngine.sync(
+            let syncResult = try SyncEngine.sync(
                 folderPath: newPath,
                 folderDB: folderDB,
                 globalDB: globalDB,
                 force: true
             )
+            // 路径字段变化需反映到元数据缓存（VectorStore 向量不变，增量刷新幂等）
+            if syncResult.hasClipChanges, let searchState {
+                Task { await searchState.applySyncDelta(syncResult) }
+            }
 
             print("[VolumeMonitor] 路径更新: \(oldPath) → \(newPath), rebase=\(rebaseResult.didRebase)")
         } catch {
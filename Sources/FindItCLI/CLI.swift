@@ -15,15 +15,22 @@ struct FindItCLI: AsyncParsableCommand {
             DbInitCommand.self,
             InsertMockCommand.self,
             SyncCommand.self,
+            FTSMaintainCommand.self,
+            CompressTextCommand.self,
+            StorageBenchCommand.self,
             SearchCommand.self,
+            DialogueCommand.self,
+            ServeCommand.self,
             FFmpegCheckCommand.self,
             ExtractAudioCommand.self,
             DetectScenesCommand.self,
             ExtractKeyframesCommand.self,
+            ThumbnailsCommand.self,
             TranscribeCommand.self,
             AnalyzeCommand.self,
             IndexCommand.self,
             EmbedCommand.self,
+            ColorSignaturesCommand.self,
         ]
     )
 }
@@ -250,6 +257,127 @@ struct SyncCommand: ParsableCommand {
     }
 }
 
+// MARK: - fts-maintain
+
+struct FTSMaintainCommand: AsyncParsableCommand {
+    static let configuration = CommandConfiguration(
+        commandName: "fts-maintain",
+        abstract: "检查并维护全局 FTS5 索引段结构（merge / optimize）"
+    )
+
+    @Option(name: .long, help: "性能模式: full_speed / balanced / background")
+    var mode: String = "balanced"
+
+    @Flag(name: .long, help: "立即执行完整 optimize（合并为单个段）")
+    var optimize = false
+
+    @Flag(name: .long, help: "只显示段结构，不做维护")
+    var dryRun = false
+
+    func run() async throws {
+        guard let perfMode = PerformanceMode(rawValue: mode) else {
+            print("错误: 未知性能模式 \(mode)")
+            throw ExitCode.failure
+        }
+        let globalDB = try DatabaseManager.openGlobalDatabase()
+
+        guard let structure = try globalDB.read({ try FTSSegmentStructure.read($0) }) else {
+            print("FTS 索引为空")
+            return
+        }
+        print("段结构: \(structure.segmentCount) 段 / \(structure.levels.count) 层 / \(structure.pageCount) 叶页")
+        for (index, level) in structure.levels.enumerated() where !level.segmentPages.isEmpty {
+            print("  L\(index): \(level.segmentPages.count) 段, 叶页 \(level.segmentPages)")
+        }
+        guard !dryRun else { return }
+
+        let maintenance = FTSMaintenance(db: globalDB, mode: perfMode)
+        let report = try await maintenance.runOnce(forceOptimize: optimize)
+        let action: String
+        switch report.action {
+        case .skipped: action = "系统受限，跳过"
+        case .idle: action = "无需维护"
+        case .merged(let steps): action = "增量合并 \(steps) 步"
+        case .optimized: action = "完整 optimize"
+        }
+        print("✓ \(action): \(report.segmentsBefore) → \(report.segmentsAfter) 段 (\(String(format: "%.0f", report.elapsed * 1000)) ms)")
+    }
+}
+
+// MARK: - compress-text
+
+struct CompressTextCommand: ParsableCommand {
+    static let configuration = CommandConfiguration(
+        commandName: "compress-text",
+        abstract: "训练文本字典并把全局索引中的长描述 / 转录改写为压缩存储"
+    )
+
+    @Flag(name: .long, help: "无视已有字典，按当前内容重新训练")
+    var retrain = false
+
+    func run() throws {
+        let globalDB = try DatabaseManager.openGlobalDatabase()
+        let report = try TextCompression.compact(globalDB, retrain: retrain)
+
+        if let dictionaryId = report.dictionaryId {
+            print("字典: \(String(format: "%016llx", dictionaryId))\(report.trained ? "（新训练）" : "")")
+        } else {
+            print("样本不足，未训练字典（仅做无字典压缩）")
+        }
+        guard report.rewrittenRows > 0 else {
+            print("✓ 没有需要压缩的行")
+            return
+        }
+        let ratio = Double(report.bytesBefore) / Double(max(report.bytesAfter, 1))
+        print("✓ 改写 \(report.rewrittenRows) 行: \(report.bytesBefore) → \(report.bytesAfter) 字节 (\(String(format: "%.1f", ratio))x)")
+    }
+}
+
+// MARK: - storage-bench
+
+struct StorageBenchCommand: ParsableCommand {
+    static let configuration = CommandConfiguration(
+        commandName: "storage-bench",
+        abstract: "对比 SQLite 默认配置与调优存储配置的读写性能"
+    )
+
+    @Option(name: .long, help: "写入 clip 数")
+    var clips: Int = 20_000
+
+    @Option(name: .long, help: "每个写事务的 clip 数")
+    var batch: Int = 50
+
+    @Option(name: .long, help: "随机点查次数")
+    var reads: Int = 5_000
+
+    @Option(name: .long, help: "临时库目录（默认系统临时目录，建议指定到实际素材盘）")
+    var directory: String?
+
+    func run() throws {
+        let workload = StorageBenchmark.Workload(clips: clips, batchSize: batch, pointReads: reads)
+        let dir = directory.map { URL(fileURLWithPath: $0, isDirectory: true) }
+            ?? FileManager.default.temporaryDirectory
+
+        print("负载: \(clips) clips / 每批 \(batch) / \(reads) 次点查 / 目录 \(dir.path)")
+        let cases: [(String, StorageProfile, Bool)] = [
+            ("sqlite-default", .sqliteDefault, false),
+            ("global-profile", .global, true),
+        ]
+        for (name, profile, checkpoint) in cases {
+            let r = try StorageBenchmark.run(
+                profile: profile, name: name, backgroundCheckpoint: checkpoint,
+                workload: workload, directory: dir
+            )
+            print("""
+                [\(r.profileName)]
+                  写入 \(String(format: "%.2f", r.writeSeconds)) s, 提交 p50 \(String(format: "%.2f", r.commitP50)) ms / p99 \(String(format: "%.2f", r.commitP99)) ms / 最大 \(String(format: "%.1f", r.commitMax)) ms
+                  点查 p50 \(String(format: "%.1f", r.readP50)) µs / p99 \(String(format: "%.1f", r.readP99)) µs, FTS 平均 \(String(format: "%.2f", r.ftsMean)) ms
+                  主库 \(r.databaseBytes / 1024) KB, WAL \(r.walBytes / 1024) KB
+                """)
+        }
+    }
+}
+
 // MARK: - search
 
 struct SearchCommand: AsyncParsableCommand {
@@ -258,20 +386,62 @@ struct SearchCommand: AsyncParsableCommand {
         abstract: "在全局索引中搜索视频片段（支持 FTS5 + 向量混合搜索）"
     )
 
-    @Argument(help: "搜索关键词")
-    var query: String
+    @Argument(help: "搜索关键词（--palette / --like 时可省略）")
+    var query: String = ""
 
     @Option(name: .shortAndLong, help: "最大结果数")
     var limit: Int = 20
 
+    @Option(name: .long, help: "调色板检索：颜色名或 #RRGGBB，逗号分隔，可带 :权重（如 \"orange:2,teal\"）")
+    var palette: String?
+
+    @Option(name: .long, help: "找相似镜头：与指定 clip_id（全局库）画面最相似的片段")
+    var like: Int64?
+
     @Option(name: .long, help: "搜索模式: fts, vector, hybrid, auto (默认 auto)")
     var mode: String = "auto"
 
     @Option(name: .long, help: "Gemini API Key (用于向量搜索的查询嵌入)")
     var apiKey: String?
 
+    @Flag(name: .long, help: "通过常驻守护进程搜索（需先运行 findit-cli serve）")
+    var daemon: Bool = false
+
+    @Option(name: .long, help: "守护进程 socket 路径 (默认 ~/Library/Application Support/FindIt/search.sock)")
+    var socket: String?
+
+    @Flag(name: .long, help: "输出查询执行计划")
+    var explain: Bool = false
+
+    @Flag(name: .long, help: "折叠重复结果（多盘副本 / 近似 take，实验性）")
+    var dedup: Bool = false
+
+    @Flag(name: .long, help: "按视频文件返回（每个文件一条，附最相关片段）")
+    var byVideo: Bool = false
+
+    @Option(name: .long, help: "视频级得分: max（最佳片段）或 sumN（前 N 个片段之和，如 sum3）")
+    var videoScore: String = "max"
+
+    @Option(name: .long, help: "视频级搜索时每个文件附带的片段数")
+    var clipsPerVideo: Int = 3
+
     func run() async throws {
-        let globalDB = try DatabaseManager.openGlobalDatabase()
+        if let palette {
+            try runPaletteSearch(palette)
+            return
+        }
+        if let like {
+            try await runSimilarSearch(clipId: like)
+            return
+        }
+        guard !query.trimmingCharacters(in: .whitespacesAndNewlines).isEmpty else {
+            print("错误: 请提供搜索关键词、--palette 或 --like")
+            throw ExitCode.failure
+        }
+        if byVideo {
+            try await runVideoSearch()
+            return
+        }
 
         // 解析搜索模式
         let searchMode: SearchEngine.SearchMode
@@ -282,40 +452,49 @@ struct SearchCommand: AsyncParsableCommand {
         default:        searchMode = .auto
         }
 
+        if daemon {
+            let response = try daemonRequest(SearchDaemonRequest(
+                id: 0, op: .search, query: query, limit: limit, mode: searchMode, record: true, explain: explain,
+                dedup: dedup
+            ))
+            if let plan = response.plan {
+                print(plan + "\n")
+            }
+            let model = response.embeddingModel
+            let modeDesc = model != nil ? "混合(\(model ?? "?"))" : "FTS5"
+            let elapsed = String(format: "%.1f", response.elapsedMs ?? 0)
+            printResults(response.results ?? [], modeDesc: "\(modeDesc), 守护进程 \(elapsed)ms")
+            return
+        }
+
+        let globalDB = try DatabaseManager.openGlobalDatabase()
+
+        // 执行计划（FTS 已足够时跳过查询嵌入，省去一次模型/API 调用）
+        let trimmed = query.trimmingCharacters(in: .whitespacesAndNewlines)
+        let resultLimit = limit
+        let plan = try await globalDB.read { db in
+            let stats = try QueryPlanner.statistics(db, query: trimmed)
+            return QueryPlanner.plan(
+                query: trimmed, mode: searchMode, hasEmbedding: searchMode != .fts,
+                statistics: stats, limit: resultLimit
+            )
+        }
+        if explain {
+            print(plan.explain() + "\n")
+        }
+
         // 准备查询向量（如果需要语义搜索）
         var queryEmbedding: [Float]?
         var embeddingModel: String?
 
-        if searchMode != .fts {
-            // 尝试 Gemini embedding
-            if let apiKey = try? APIKeyManager.resolveAPIKey(override: apiKey) {
-                let provider = GeminiEmbeddingProvider(apiKey: apiKey)
-                if provider.isAvailable() {
-                    do {
-                        queryEmbedding = try await provider.embed(text: query)
-                        embeddingModel = provider.name
-                    } catch {
-                        print("警告: Gemini 嵌入失败: \(error.localizedDescription)")
-                    }
-                }
-            }
-
-            // Gemini 不可用则尝试 NLEmbedding
-            if queryEmbedding == nil {
-                let nlProvider = NLEmbeddingProvider()
-                if nlProvider.isAvailable() {
-                    do {
-                        queryEmbedding = try await nlProvider.embed(text: query)
-                        embeddingModel = nlProvider.name
-                    } catch {
-                        // NLEmbedding 也失败，退化为纯 FTS
-                    }
-                }
-            }
+        if plan.runsVector, let embedded = await embedQuery() {
+            queryEmbedding = embedded.embedding
+            embeddingModel = embedded.model
         }
 
         let finalQueryEmbedding = queryEmbedding
         let finalEmbeddingModel = embeddingModel
+        let diversify: ResultDiversifier.Options? = dedup ? .default : nil
         let results = try await globalDB.read { db in
             try SearchEngine.hybridSearch(
                 db,
@@ -323,16 +502,196 @@ struct SearchCommand: AsyncParsableCommand {
                 queryEmbedding: finalQueryEmbedding,
                 embeddingModel: finalEmbeddingModel,
                 mode: searchMode,
-                limit: limit
+                plan: plan,
+                limit: resultLimit,
+                diversify: diversify
             )
         }
 
+        let modeDesc = queryEmbedding != nil ? "混合(\(embeddingModel ?? "?"))" : "FTS5"
+        printResults(results, modeDesc: modeDesc)
+        guard !results.isEmpty else { return }
+
+        // 记录搜索历史
+        try await globalDB.write { db in
+            try SearchEngine.recordSearch(db, query: query, resultCount: results.count)
+        }
+    }
+
+    /// 发送请求到常驻守护进程（连接失败或请求失败时打印错误并退出）
+    private func daemonRequest(_ request: SearchDaemonRequest) throws -> SearchDaemonResponse {
+        let socketPath = try socket ?? SearchDaemon.defaultSocketPath()
+        let response: SearchDaemonResponse
+        do {
+            let client = try SearchDaemonClient(socketPath: socketPath)
+            response = try client.send(request)
+        } catch {
+            print("错误: \(error.localizedDescription)")
+            print("请先运行 findit-cli serve 启动守护进程")
+            throw ExitCode.failure
+        }
+        guard response.ok else {
+            print("错误: \(response.error ?? "守护进程搜索失败")")
+            throw ExitCode.failure
+        }
+        return response
+    }
+
+    /// 查询文本嵌入（Gemini 优先，回退 NLEmbedding；均不可用返回 nil）
+    private func embedQuery() async -> (embedding: [Float], model: String)? {
+        // 尝试 Gemini embedding
+        if let apiKey = try? APIKeyManager.resolveAPIKey(override: apiKey) {
+            let provider = GeminiEmbeddingProvider(apiKey: apiKey)
+            if provider.isAvailable() {
+                do {
+                    return (try await provider.embed(text: query), provider.name)
+                } catch {
+                    print("警告: Gemini 嵌入失败: \(error.localizedDescription)")
+                }
+            }
+        }
+
+        // Gemini 不可用则尝试 NLEmbedding
+        let nlProvider = NLEmbeddingProvider()
+        if nlProvider.isAvailable() {
+            // NLEmbedding 也失败，退化为纯 FTS
+            if let embedding = try? await nlProvider.embed(text: query) {
+                return (embedding, nlProvider.name)
+            }
+        }
+        return nil
+    }
+
+    /// 视频级搜索（每个文件一条，聚合在向量 Top-K 选择内完成）
+    private func runVideoSearch() async throws {
+        let aggregation: VectorStore.VideoAggregation
+        switch videoScore.lowercased() {
+        case "max":
+            aggregation = .max
+        case let spec where spec.hasPrefix("sum"):
+            guard let n = Int(spec.dropFirst(3)), n > 0 else {
+                print("错误: --video-score 应为 max 或 sumN（如 sum3）")
+                throw ExitCode.failure
+            }
+            aggregation = .topSum(n)
+        default:
+            print("错误: --video-score 应为 max 或 sumN（如 sum3）")
+            throw ExitCode.failure
+        }
+
+        guard let (embedding, model) = await embedQuery() else {
+            print("错误: 视频级搜索需要向量嵌入（Gemini 或 NLEmbedding 均不可用）")
+            throw ExitCode.failure
+        }
+
+        let globalDB = try DatabaseManager.openGlobalDatabase()
+        let loadStart = Date()
+        let entries = try await globalDB.read { db in
+            try Row.fetchAll(db, sql: """
+                SELECT clip_id, embedding FROM clips
+                WHERE embedding IS NOT NULL AND embedding_model = ?
+                """, arguments: [model]
+            ).map { row -> (clipId: Int64, embeddingData: Data) in
+                (row["clip_id"], row["embedding"])
+            }
+        }
+        let store = VectorStore(dimensions: embedding.count, embeddingModel: model)
+        await store.load(entries: entries)
+        let loadMs = Date().timeIntervalSince(loadStart) * 1000
+
+        let start = Date()
+        let videos = try await SearchEngine.videoSearch(
+            globalDB, store: store, queryEmbedding: embedding,
+            aggregation: aggregation, clipsPerVideo: clipsPerVideo, limit: limit
+        )
+        let elapsed = String(format: "%.1f", Date().timeIntervalSince(start) * 1000)
+
+        guard !videos.isEmpty else {
+            print("未找到匹配「\(query)」的视频")
+            return
+        }
+        print("找到 \(videos.count) 个视频 (模式: 视频级(\(model)), \(entries.count) 个向量, 加载 \(String(format: "%.0f", loadMs))ms, 检索 \(elapsed)ms):\n")
+        for (i, video) in videos.enumerated() {
+            print("[\(i + 1)] \(video.fileName ?? "未知文件")  得分: \(String(format: "%.4f", video.score))")
+            if let path = video.filePath {
+                print("    路径: \(path)")
+            }
+            for clip in video.clips {
+                let timeRange = formatTime(clip.startTime) + " → " + formatTime(clip.endTime)
+                let sim = clip.similarity.map { String(format: "%.4f", $0) } ?? "-"
+                print("    · \(timeRange) \(clip.scene ?? clip.clipDescription ?? "未命名") (\(sim))")
+            }
+            print()
+        }
+    }
+
+    /// 调色板检索（色彩签名扫描，不经过 FTS / 向量）
+    ///
+    /// `--daemon` 时由守护进程的常驻索引检索，免去每次加载全部签名。
+    private func runPaletteSearch(_ spec: String) throws {
+        let signature: ColorSignature
+        do {
+            signature = try ColorSignature.palette(spec)
+        } catch {
+            print("错误: \(error.localizedDescription)")
+            throw ExitCode.failure
+        }
+
+        if daemon {
+            let response = try daemonRequest(SearchDaemonRequest(id: 0, op: .palette, limit: limit, palette: spec))
+            let elapsed = String(format: "%.1f", response.elapsedMs ?? 0)
+            printResults(response.results ?? [], modeDesc: "调色板, 守护进程 \(elapsed)ms")
+            return
+        }
+
+        let globalDB = try DatabaseManager.openGlobalDatabase()
+        let start = Date()
+        let (results, indexed) = try globalDB.read { db in
+            let index = try PaletteIndex.load(db)
+            return (try SearchEngine.paletteSearch(db, palette: signature, index: index, limit: limit), index.count)
+        }
+        let elapsed = String(format: "%.1f", Date().timeIntervalSince(start) * 1000)
+        printResults(results, modeDesc: "调色板, \(indexed) 个签名, \(elapsed)ms")
+    }
+
+    /// 找相似镜头（关键帧视觉特征近邻，不经过文本）
+    ///
+    /// `--daemon` 时由守护进程的常驻视觉 store 检索，免去每次加载全部视觉向量。
+    private func runSimilarSearch(clipId: Int64) async throws {
+        if daemon {
+            let response = try daemonRequest(SearchDaemonRequest(id: 0, op: .similar, limit: limit, clipId: clipId))
+            let elapsed = String(format: "%.1f", response.elapsedMs ?? 0)
+            printResults(response.results ?? [], modeDesc: "相似镜头, 守护进程 \(elapsed)ms")
+            return
+        }
+
+        let globalDB = try DatabaseManager.openGlobalDatabase()
+        let loadStart = Date()
+        let store = try await VisualSimilarity.loadStore(from: globalDB)
+        let loadMs = Date().timeIntervalSince(loadStart) * 1000
+
+        let start = Date()
+        let results = try await VisualSimilarity.similarClips(
+            to: clipId, store: store, db: globalDB, limit: limit
+        )
+        let elapsed = String(format: "%.1f", Date().timeIntervalSince(start) * 1000)
+        if results.isEmpty, try await globalDB.read({
+            try VisualSimilarity.vector($0, clipId: clipId, model: store.embeddingModel)
+        }) == nil {
+            print("错误: clip \(clipId) 没有视觉特征（需重新索引）")
+            throw ExitCode.failure
+        }
+        let count = await store.count
+        printResults(results, modeDesc: "相似镜头, \(count) 个向量, 加载 \(String(format: "%.0f", loadMs))ms, 检索 \(elapsed)ms")
+    }
+
+    /// 打印搜索结果
+    private func printResults(_ results: [SearchEngine.SearchResult], modeDesc: String) {
         if results.isEmpty {
-            print("未找到匹配「\(query)」的结果")
+            print("未找到匹配「\(palette ?? like.map { "clip \($0)" } ?? query)」的结果")
             return
         }
 
-        let modeDesc = queryEmbedding != nil ? "混合(\(embeddingModel ?? "?"))" : "FTS5"
         print("找到 \(results.count) 个结果 (模式: \(modeDesc)):\n")
 
         for (i, r) in results.enumerated() {
@@ -350,6 +709,9 @@ struct SearchCommand: AsyncParsableCommand {
             if let transcript = r.transcript {
                 print("    转录: \(transcript)")
             }
+            if let duplicates = r.duplicateClipIds, !duplicates.isEmpty {
+                print("    重复: 另有 \(duplicates.count) 个副本/近似片段 (clip \(duplicates.map(String.init).joined(separator: ", ")))")
+            }
             // 显示分数
             var scores: [String] = []
             if r.rank != 0 {
@@ -366,11 +728,6 @@ struct SearchCommand: AsyncParsableCommand {
             }
             print()
         }
-
-        // 记录搜索历史
-        try await globalDB.write { db in
-            try SearchEngine.recordSearch(db, query: query, resultCount: results.count)
-        }
     }
 
     /// 秒数格式化为 mm:ss
@@ -381,6 +738,149 @@ struct SearchCommand: AsyncParsableCommand {
     }
 }
 
+// MARK: - dialogue
+
+struct DialogueCommand: ParsableCommand {
+    static let configuration = CommandConfiguration(
+        commandName: "dialogue",
+        abstract: "台词搜索：返回命中字幕的精确时间码"
+    )
+
+    @Argument(help: "搜索内容（支持 \"短语\"、前缀*、NEAR()）")
+    var query: String
+
+    @Option(name: .shortAndLong, help: "最大结果数")
+    var limit: Int = 20
+
+    @Option(name: .long, help: "邻近搜索：各词之间最多间隔的词数")
+    var near: Int?
+
+    func run() throws {
+        let globalDB = try DatabaseManager.openGlobalDatabase()
+        let ftsQuery = near.map { TranscriptIndex.nearQuery(query, distance: $0) } ?? query
+
+        let hits = try globalDB.read { db in
+            try TranscriptIndex.search(db, query: ftsQuery, limit: limit)
+        }
+        if hits.isEmpty {
+            print("未找到匹配「\(query)」的台词")
+            return
+        }
+
+        print("找到 \(hits.count) 条台词:\n")
+        for (i, hit) in hits.enumerated() {
+            let speaker = hit.speaker.map { "\($0): " } ?? ""
+            print("[\(i + 1)] \(formatTime(hit.matchTime))  \(speaker)\(hit.snippet)")
+            print("    文件: \(hit.fileName ?? "?")  字幕 \(formatTime(hit.startTime)) → \(formatTime(hit.endTime))")
+            if let clipId = hit.clipId {
+                print("    片段: #\(clipId)")
+            }
+            print()
+        }
+    }
+
+    /// 秒数格式化为 mm:ss.s
+    private func formatTime(_ seconds: Double) -> String {
+        let m = Int(seconds) / 60
+        let s = seconds - Double(m * 60)
+        return String(format: "%d:%04.1f", m, s)
+    }
+}
+
+// MARK: - serve
+
+struct ServeCommand: AsyncParsableCommand {
+    static let configuration = CommandConfiguration(
+        commandName: "serve",
+        abstract: "启动常驻搜索守护进程（Unix socket，JSON Lines 协议）"
+    )
+
+    @Option(name: .long, help: "socket 路径 (默认 ~/Library/Application Support/FindIt/search.sock)")
+    var socket: String?
+
+    @Option(name: .long, help: "Gemini API Key (用于向量搜索的查询嵌入)")
+    var apiKey: String?
+
+    @Flag(name: .long, help: "仅 FTS5（不加载嵌入模型与向量索引）")
+    var ftsOnly: Bool = false
+
+    func run() async throws {
+        let globalDB = try DatabaseManager.openGlobalDatabase()
+        let socketPath = try socket ?? SearchDaemon.defaultSocketPath()
+
+        // 查询嵌入 provider：Gemini 优先，NLEmbedding 回退
+        var provider: (any EmbeddingProvider)?
+        if !ftsOnly {
+            if let key = try? APIKeyManager.resolveAPIKey(override: apiKey) {
+                let gemini = GeminiEmbeddingProvider(apiKey: key)
+                if gemini.isAvailable() { provider = gemini }
+            }
+            if provider == nil {
+                let nlProvider = NLEmbeddingProvider()
+                if nlProvider.isAvailable() { provider = nlProvider }
+            }
+        }
+
+        let snapshotURL = provider.flatMap { try? VectorStoreSnapshot.defaultURL(embeddingModel: $0.name) }
+        let daemon = SearchDaemon(db: globalDB, provider: provider, snapshotURL: snapshotURL)
+        let server = SearchDaemonServer(socketPath: socketPath, daemon: daemon)
+        do {
+            try server.start()
+        } catch {
+            print("错误: \(error.localizedDescription)")
+            throw ExitCode.failure
+        }
+        await daemon.start()
+
+        print("搜索守护进程已启动: \(socketPath)")
+        print("嵌入模型: \(provider?.name ?? "无 (仅 FTS5)")")
+        print("按 Ctrl-C 或发送 {\"id\":1,\"op\":\"shutdown\"} 停止")
+
+        // 等待 shutdown 请求或 SIGINT/SIGTERM
+        await withCheckedContinuation { (continuation: CheckedContinuation<Void, Never>) in
+            let once = ResumeOnce(continuation)
+            Task { await daemon.onShutdown { once.resume() } }
+
+            signal(SIGINT, SIG_IGN)
+            signal(SIGTERM, SIG_IGN)
+            let sources = [SIGINT, SIGTERM].map { sig in
+                let source = DispatchSource.makeSignalSource(signal: sig, queue: .main)
+                source.setEventHandler { once.resume() }
+                source.resume()
+                return source
+            }
+            once.retain(sources)
+        }
+
+        server.stop()
+        print("搜索守护进程已停止")
+    }
+
+    /// 保证 continuation 只恢复一次（shutdown 请求与信号可能同时到达）
+    private final class ResumeOnce: @unchecked Sendable {
+        private let lock = NSLock()
+        private var continuation: CheckedContinuation<Void, Never>?
+        private var retained: [Any] = []
+
+        init(_ continuation: CheckedContinuation<Void, Never>) {
+            self.continuation = continuation
+        }
+
+        func retain(_ objects: [Any]) {
+            lock.lock(); defer { lock.unlock() }
+            retained.append(contentsOf: objects)
+        }
+
+        func resume() {
+            lock.lock()
+            let pending = continuation
+            continuation = nil
+            lock.unlock()
+            pending?.resume()
+        }
+    }
+}
+
 // MARK: - ffmpeg-check
 
 struct FFmpegCheckCommand: ParsableCommand {
@@ -524,6 +1024,64 @@ struct ExtractKeyframesCommand: ParsableCommand {
     }
 }
 
+// MARK: - thumbnails
+
+struct ThumbnailsCommand: AsyncParsableCommand {
+    static let configuration = CommandConfiguration(
+        commandName: "thumbnails",
+        abstract: "预热缩略图磁盘缓存（与 App 共用）"
+    )
+
+    @Option(name: .long, help: "素材文件夹路径 (默认: 全局索引中的所有片段)")
+    var folder: String?
+
+    @Option(name: .long, help: "并发解码数")
+    var jobs: Int = 4
+
+    func run() async throws {
+        let paths: [String]
+        if let folder {
+            let folderPath = (folder as NSString).standardizingPath
+            let folderDB = try DatabaseManager.openFolderDatabase(at: folderPath)
+            paths = try await folderDB.read { db in
+                try String.fetchAll(db, sql: "SELECT thumbnail_path FROM clips WHERE thumbnail_path IS NOT NULL")
+            }
+        } else {
+            let globalDB = try DatabaseManager.openGlobalDatabase()
+            paths = try await globalDB.read { db in
+                try String.fetchAll(db, sql: "SELECT thumbnail_path FROM clips WHERE thumbnail_path IS NOT NULL")
+            }
+        }
+
+        guard !paths.isEmpty else {
+            print("没有需要缓存的缩略图")
+            return
+        }
+
+        let service = ThumbnailService.shared
+        let start = CFAbsoluteTimeGetCurrent()
+        print("预热 \(paths.count) 张缩略图...")
+
+        await withTaskGroup(of: Void.self) { group in
+            var iterator = paths.makeIterator()
+            for _ in 0..<max(1, jobs) {
+                guard let path = iterator.next() else { break }
+                group.addTask { _ = await service.thumbnail(for: path) }
+            }
+            while await group.next() != nil {
+                guard let path = iterator.next() else { continue }
+                group.addTask { _ = await service.thumbnail(for: path) }
+            }
+        }
+
+        let stats = await service.stats
+        let diskCount = await service.diskCount
+        let elapsed = String(format: "%.1f", CFAbsoluteTimeGetCurrent() - start)
+        print("✓ 完成 (\(elapsed)s): 已缓存 \(stats.diskHits), 新解码 \(stats.decodes), 失败 \(stats.failures)")
+        print("  磁盘缓存: \(diskCount) 张")
+    }
+}
+
 // MARK: - transcribe
 
 struct TranscribeCommand: AsyncParsableCommand {
@@ -764,6 +1322,9 @@ struct IndexCommand: AsyncParsableCommand {
     @Flag(name: .long, help: "跳过视觉分析")
     var skipVision: Bool = false
 
+    @Flag(name: .long, help: "仍向视觉模型请求光线/色调（默认由像素统计计算）")
+    var vlmColorFields: Bool = false
+
     @Flag(name: .long, help: "强制重新索引已完成的视频")
     var force: Bool = false
 
@@ -934,6 +1495,7 @@ struct IndexCommand: AsyncParsableCommand {
                 rateLimiter: rateLimiter,
                 embeddingProvider: embeddingProvider,
                 skipStt: skipStt,
+                visionFields: VisionField.modelFields(includePixelDerived: vlmColorFields),
                 onProgress: { progress in
                     print("  [\(progress.fileName)] \(progress.stage)")
                 },
@@ -982,6 +1544,7 @@ struct IndexCommand: AsyncParsableCommand {
                         whisperKit: whisperKit,
                         embeddingProvider: embeddingProvider,
                         skipStt: skipStt,
+                        visionFields: VisionField.modelFields(includePixelDerived: vlmColorFields),
                         onProgress: { msg in print("  \(msg)") }
                     )
 
@@ -1163,3 +1726,42 @@ struct EmbedCommand: AsyncParsableCommand {
         print("同步到全局索引: \(syncResult.syncedClips) 个片段")
     }
 }
+
+// MARK: - color-signatures
+
+struct ColorSignaturesCommand: ParsableCommand {
+    static let configuration = CommandConfiguration(
+        commandName: "color-signatures",
+        abstract: "为已索引的视频片段补算色彩签名（调色板检索）"
+    )
+
+    @Option(name: .long, help: "素材文件夹路径")
+    var folder: String
+
+    @Flag(name: .long, help: "重新计算已有签名的片段")
+    var force: Bool = false
+
+    func run() throws {
+        let folderPath = (folder as NSString).standardizingPath
+        let folderDB = try DatabaseManager.openFolderDatabase(at: folderPath)
+
+        let result = try PipelineManager.backfillColorSignatures(folderDB: folderDB, force: force) { done, total in
+            print("  \(done)/\(total)")
+        }
+        guard result.updated + result.skipped > 0 else {
+            print("无需补算签名的片段" + (force ? "" : " (使用 --force 重新计算)"))
+            return
+        }
+        print("\n完成! 写入 \(result.updated) 个签名, 跳过 \(result.skipped) 个（缩略图缺失或无法解码）")
+
+        // 同步到全局库（force: true 因为签名更新不改变 rowid）
+        let globalDB = try DatabaseManager.openGlobalDatabase()
+        let syncResult = try SyncEngine.sync(
+            folderPath: folderPath,
+            folderDB: folderDB,
+            globalDB: globalDB,
+            force: true
+        )
+        print("同步到全局索引: \(syncResult.syncedClips) 个片段")
+    }
+}
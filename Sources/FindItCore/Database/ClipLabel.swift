@@ -112,23 +112,31 @@ public enum ClipLabel {
     /// - Finder 颜色色点（通过 `\n{number}` 后缀）
     /// - 标签名称（DaVinci Resolve / Final Cut Pro 导入为关键词）
     /// 保留文件已有的非颜色标签不受影响。
-    public static func syncFinderTag(filePath: String, label: ColorLabel?) throws {
-        let nsurl = URL(fileURLWithPath: filePath) as NSURL
-
-        // 读取现有标签
-        var tagValue: AnyObject?
-        try nsurl.getResourceValue(&tagValue, forKey: .tagNamesKey)
-        var tags = (tagValue as? [String]) ?? []
+    ///
+    /// 同步读改写，UI 中请改用 `FileTagWriter.shared.enqueue` 异步批量写入。
+    ///
+    /// - Parameter backend: 标签存储后端（默认 macOS Finder 标签）
+    public static func syncFinderTag(
+        filePath: String,
+        label: ColorLabel?,
+        backend: FileTagBackend = FileTagWriter.shared.backend
+    ) throws {
+        let existing = try backend.readTags(path: filePath)
+        let tags = mergedTags(existing, label: label)
+        guard tags != existing else { return }
+        try backend.writeTags(tags, path: filePath)
+    }
 
-        // 移除已有的颜色标签（保留用户自定义标签如 "B-roll"）
+    /// 用新的颜色标签替换已有颜色标签（保留用户自定义标签如 "B-roll"）
+    static func mergedTags(_ existing: [String], label: ColorLabel?) -> [String] {
+        // Finder 返回的颜色标签不带编号后缀，写入时带 "\nNumber"，两种形式都视为颜色标签
         let colorNames = Set(ColorLabel.allCases.map(\.finderTagName))
-        tags.removeAll { colorNames.contains($0) }
-
-        // 添加新颜色标签（"Name\nNumber" 格式驱动 Finder 色点 + NLE 关键词）
+        var tags = existing.filter { tag in
+            !colorNames.contains(String(tag.split(separator: "\n", maxSplits: 1).first ?? ""))
+        }
         if let label = label {
             tags.append("\(label.finderTagName)\n\(label.finderLabelNumber)")
         }
-
-        try nsurl.setResourceValue(tags, forKey: .tagNamesKey)
+        return tags
     }
 }
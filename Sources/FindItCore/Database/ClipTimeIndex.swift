@@ -0,0 +1,125 @@
+import Foundation
+import GRDB
+
+/// clip 时间区间索引
+///
+/// "哪个 clip 覆盖 t 时刻"（台词映射、播放器同步、NLE 回传、孤儿重对齐）
+/// 原先按 `video_id` 取出该视频全部 clip 再逐行比较起止时间，长素材上是线性扫描。
+/// 文件夹库与全局库都维护 `clips_time_rtree`（触发器随 clips 增删改同步），
+/// 点查 / 区间查询先经 R*Tree 定位候选，再按 clips 原值精确过滤。
+///
+/// 区间约定为半开 `[start_time, end_time)`：相邻 clip 的交界时刻只属于后一个。
+public enum ClipTimeIndex {
+
+    /// R*Tree 虚拟表名
+    public static let tableName = "clips_time_rtree"
+
+    /// clip 时间区间
+    public struct Span: Sendable, Codable, Equatable, Hashable {
+        public let clipId: Int64
+        public let videoId: Int64
+        public let startTime: Double
+        public let endTime: Double
+
+        public init(clipId: Int64, videoId: Int64, startTime: Double, endTime: Double) {
+            self.clipId = clipId
+            self.videoId = videoId
+            self.startTime = startTime
+            self.endTime = endTime
+        }
+    }
+
+    // MARK: - 查询
+
+    /// 覆盖 `time` 的全部 clip（按起始时间升序）
+    public static func clips(_ db: Database, videoId: Int64, at time: Double) throws -> [Span] {
+        try fetchSpans(db, sql: """
+            \(candidateSQL)
+              AND r.start_time <= ? AND r.end_time >= ?
+              AND c.start_time <= ? AND c.end_time > ?
+            ORDER BY c.start_time, c.clip_id
+            """, arguments: [videoId, videoId, videoId, time, time, time, time])
+    }
+
+    /// 覆盖 `time` 的 clip（多个重叠时取起始最晚者，即最贴近该时刻的切分）
+    public static func clip(_ db: Database, videoId: Int64, at time: Double) throws -> Span? {
+        try fetchSpans(db, sql: """
+            \(candidateSQL)
+              AND r.start_time <= ? AND r.end_time >= ?
+              AND c.start_time <= ? AND c.end_time > ?
+            ORDER BY c.start_time DESC, c.clip_id DESC
+            LIMIT 1
+            """, arguments: [videoId, videoId, videoId, time, time, time, time]).first
+    }
+
+    /// 与 `[from, to)` 有重叠的全部 clip（按起始时间升序）
+    ///
+    /// `from == to` 时退化为点查。
+    public static func clips(_ db: Database, videoId: Int64, from: Double, to: Double) throws -> [Span] {
+        guard to > from else {
+            return to == from ? try clips(db, videoId: videoId, at: from) : []
+        }
+        return try fetchSpans(db, sql: """
+            \(candidateSQL)
+              AND r.start_time <= ? AND r.end_time >= ?
+              AND c.start_time < ? AND c.end_time > ?
+            ORDER BY c.start_time, c.clip_id
+            """, arguments: [videoId, videoId, videoId, to, from, to, from])
+    }
+
+    /// 覆盖 `videoIdExpr` 在 `timeExpr` 时刻的 clip_id 标量子查询（供其他查询内联）
+    ///
+    /// 表达式原样拼入 SQL，只能传列名等受信片段。
+    static func coveringClipSQL(videoId videoIdExpr: String, time timeExpr: String) -> String {
+        """
+        (SELECT c.clip_id FROM \(tableName) r
+         JOIN clips c ON c.clip_id = r.clip_id
+         WHERE r.video_lo <= \(videoIdExpr) AND r.video_hi >= \(videoIdExpr)
+           AND r.start_time <= \(timeExpr) AND r.end_time >= \(timeExpr)
+           AND c.video_id = \(videoIdExpr)
+           AND c.start_time <= \(timeExpr) AND c.end_time > \(timeExpr)
+         ORDER BY c.start_time DESC, c.clip_id DESC LIMIT 1)
+        """
+    }
+
+    // MARK: - 维护
+
+    /// 按 clips 表全量重建（索引疑似漂移时使用；正常写入由触发器维护）
+    public static func rebuild(_ db: Database) throws {
+        try db.execute(sql: "DELETE FROM \(tableName)")
+        try db.execute(sql: """
+            INSERT INTO \(tableName) (clip_id, video_lo, video_hi, start_time, end_time)
+            SELECT clip_id, video_id, video_id, MIN(start_time, end_time), MAX(start_time, end_time)
+            FROM clips WHERE video_id IS NOT NULL
+            """)
+    }
+
+    /// 索引条目数是否与有归属视频的 clip 数一致（诊断用）
+    public static func isConsistent(_ db: Database) throws -> Bool {
+        let indexed = try Int.fetchOne(db, sql: "SELECT COUNT(*) FROM \(tableName)") ?? 0
+        let clips = try Int.fetchOne(db, sql: "SELECT COUNT(*) FROM clips WHERE video_id IS NOT NULL") ?? 0
+        return indexed == clips
+    }
+
+    // MARK: - Private
+
+    /// R*Tree 候选 + clips 回表（参数依次为 video_id × 3）
+    private static let candidateSQL = """
+        SELECT c.clip_id, c.video_id, c.start_time, c.end_time
+        FROM \(tableName) r
+        JOIN clips c ON c.clip_id = r.clip_id
+        WHERE r.video_lo <= ? AND r.video_hi >= ?
+          AND c.video_id = ?
+        """
+
+    private static func fetchSpans(_ db: Database, sql: String, arguments: StatementArguments) throws -> [Span] {
+        try Row.fetchAll(db, sql: sql, arguments: arguments).map { row in
+            Span(
+                clipId: row["clip_id"],
+                videoId: row["video_id"],
+                startTime: row["start_time"],
+                endTime: row["end_time"]
+            )
+        }
+    }
+}
@@ -40,7 +40,9 @@ public final class DatabaseManager {
     static let globalFileName = "search.sqlite"
 
     /// App 的 Application Support 目录
-    private static func appSupportDirectory() throws -> URL {
+    ///
+    /// 包内可见，供 VectorStore 快照等派生缓存定位存储位置。
+    static func appSupportDirectory() throws -> URL {
         guard let base = FileManager.default.urls(for: .applicationSupportDirectory, in: .userDomainMask).first else {
             throw StorageError.appSupportNotFound
         }
@@ -57,6 +59,13 @@ public final class DatabaseManager {
     /// - Parameter folderPath: 素材文件夹的绝对路径
     /// - Returns: 配置好 WAL 模式的数据库连接池
     public static func openFolderDatabase(at folderPath: String) throws -> DatabasePool {
+        let pool = try openPool(at: folderDatabasePath(for: folderPath), profile: .folder)
+        try migrateFolderIfNeeded(pool)
+        return pool
+    }
+
+    /// 文件夹级索引数据库文件路径（确保 `.clip-index` 目录存在）
+    static func folderDatabasePath(for folderPath: String) throws -> String {
         let folderURL = URL(fileURLWithPath: folderPath, isDirectory: true)
 
         // 检查文件夹是否存在
@@ -74,10 +83,27 @@ public final class DatabaseManager {
             throw StorageError.cannotCreateIndexDirectory(indexDir.path)
         }
 
-        let dbPath = indexDir.appendingPathComponent(indexFileName).path
-        let pool = try openPool(at: dbPath)
-        try Migrations.folderMigrator().migrate(pool)
-        return pool
+        return indexDir.appendingPathComponent(indexFileName).path
+    }
+
+    /// 文件夹库 schema 版本（= 已注册迁移数）
+    ///
+    /// 迁移完成后写入 `PRAGMA user_version`。打开时版本一致即跳过迁移器，
+    /// 只读文件头一个字段，不再逐个查询 `grdb_migrations`。
+    static let folderSchemaVersion = Migrations.folderMigrator().migrations.count
+
+    /// 按缓存的 schema 版本决定是否执行文件夹库迁移
+    ///
+    /// - Returns: 是否实际执行了迁移器
+    @discardableResult
+    static func migrateFolderIfNeeded(_ writer: DatabaseWriter) throws -> Bool {
+        let version = try writer.read { try Int.fetchOne($0, sql: "PRAGMA user_version") ?? 0 }
+        guard version != folderSchemaVersion else { return false }
+        try Migrations.folderMigrator().migrate(writer)
+        try writer.writeWithoutTransaction { db in
+            try db.execute(sql: "PRAGMA user_version = \(folderSchemaVersion)")
+        }
+        return true
     }
 
     // MARK: - 全局搜索索引
@@ -97,7 +123,7 @@ public final class DatabaseManager {
         }
 
         let dbPath = dir.appendingPathComponent(globalFileName).path
-        let pool = try openPool(at: dbPath)
+        let pool = try openPool(at: dbPath, profile: .global)
         try Migrations.globalMigrator().migrate(pool)
         return pool
     }
@@ -128,10 +154,20 @@ public final class DatabaseManager {
     // MARK: - Private
 
     /// 以 WAL 模式打开 DatabasePool
-    private static func openPool(at path: String) throws -> DatabasePool {
+    ///
+    /// - Parameters:
+    ///   - profile: 按数据库角色选择的存储配置（pragma 在每个连接打开时执行）
+    ///   - configure: 在默认配置基础上追加设置（读连接数等）
+    static func openPool(
+        at path: String,
+        profile: StorageProfile = .sqliteDefault,
+        configure: (inout Configuration) -> Void = { _ in }
+    ) throws -> DatabasePool {
         do {
             var config = Configuration()
             config.foreignKeysEnabled = true
+            profile.apply(to: &config)
+            configure(&config)
             // GRDB 的 DatabasePool 默认使用 WAL 模式
             let pool = try DatabasePool(path: path, configuration: config)
             return pool
@@ -0,0 +1,349 @@
+import Foundation
+import GRDB
+
+/// FTS5 索引段结构
+///
+/// 解析自影子表 `<table>_data` 中 rowid = 10 的 structure 记录
+/// （格式见 SQLite fts5_index.c `fts5StructureDecode`）。
+/// 段数随零散写入增长，每次查询需合并所有段的 doclist，段越多越慢。
+public struct FTSSegmentStructure: Sendable, Equatable {
+
+    /// 单层段信息
+    public struct Level: Sendable, Equatable {
+        /// 正在进行的增量合并涉及的段数（0 = 无）
+        public var merging: Int
+        /// 各段叶页数
+        public var segmentPages: [Int]
+    }
+
+    /// structure 记录的 rowid（FTS5_STRUCTURE_ROWID）
+    static let structureRowid: Int64 = 10
+
+    /// 写入计数器：写入 level 0 的叶页总数（只随新数据增长，合并不计入）
+    public var writeCounter: UInt64
+    /// 各层（0 = 最新、最小的段）
+    public var levels: [Level]
+
+    /// 段总数
+    public var segmentCount: Int { levels.reduce(0) { $0 + $1.segmentPages.count } }
+
+    /// 叶页总数
+    public var pageCount: Int { levels.reduce(0) { $0 + $1.segmentPages.reduce(0, +) } }
+
+    /// 单层最多段数（达到 crisismerge 时写入方会被强制同步合并）
+    public var maxSegmentsPerLevel: Int { levels.map(\.segmentPages.count).max() ?? 0 }
+
+    /// 读取 FTS5 表的段结构（表不存在或尚无数据时返回 nil）
+    public static func read(_ db: Database, table: String = "clips_fts") throws -> FTSSegmentStructure? {
+        guard try db.tableExists("\(table)_data") else { return nil }
+        let data = try Data.fetchOne(
+            db,
+            sql: "SELECT block FROM \"\(table)_data\" WHERE id = ?",
+            arguments: [structureRowid]
+        )
+        return data.flatMap(decode)
+    }
+
+    /// 解码 structure 记录（格式损坏时返回 nil）
+    static func decode(_ data: Data) -> FTSSegmentStructure? {
+        let bytes = [UInt8](data)
+        // 4 字节 cookie
+        var offset = 4
+        guard bytes.count >= offset else { return nil }
+
+        // V2 记录（SQLite 3.43+，支持 contentless delete）：每段附加 5 个字段
+        let isV2 = bytes.count >= 8 && bytes[4..<8].elementsEqual([0xFF, 0x00, 0x00, 0x01])
+        if isV2 { offset += 4 }
+
+        guard let levelCount = varint(bytes, &offset),
+              let segmentTotal = varint(bytes, &offset),
+              let writeCounter = varint(bytes, &offset) else { return nil }
+        if isV2 {
+            guard varint(bytes, &offset) != nil else { return nil } // nOriginCntr
+        }
+        // 防御损坏记录导致的超大分配
+        guard levelCount <= 64, segmentTotal <= 2000 else { return nil }
+
+        var levels: [Level] = []
+        for _ in 0..<levelCount {
+            guard let merging = varint(bytes, &offset),
+                  let segments = varint(bytes, &offset),
+                  segments <= segmentTotal else { return nil }
+            var pages: [Int] = []
+            for _ in 0..<segments {
+                guard varint(bytes, &offset) != nil, // iSegid
+                      let first = varint(bytes, &offset),
+                      let last = varint(bytes, &offset) else { return nil }
+                if isV2 {
+                    // iOrigin1, iOrigin2, nPgTombstone, nEntryTombstone, nEntry
+                    for _ in 0..<5 {
+                        guard varint(bytes, &offset) != nil else { return nil }
+                    }
+                }
+                pages.append(last >= first ? Int(last - first + 1) : 0)
+            }
+            levels.append(Level(merging: Int(merging), segmentPages: pages))
+        }
+        return FTSSegmentStructure(writeCounter: writeCounter, levels: levels)
+    }
+
+    /// SQLite varint：前 8 字节每字节 7 位（高位为续位），第 9 字节取全部 8 位，大端
+    private static func varint(_ bytes: [UInt8], _ offset: inout Int) -> UInt64? {
+        var value: UInt64 = 0
+        for i in 0..<9 {
+            guard offset < bytes.count else { return nil }
+            let byte = bytes[offset]
+            offset += 1
+            if i == 8 {
+                return (value << 8) | UInt64(byte)
+            }
+            value = (value << 7) | UInt64(byte & 0x7F)
+            if byte & 0x80 == 0 { return value }
+        }
+        return value
+    }
+}
+
+/// FTS5 索引空闲维护
+///
+/// `clips_fts` 持续承受同步、标签、评分带来的零散写入，每次写入都会产生
+/// 新的 level-0 段。FTS5 自带的 automerge 只在写入时顺带合并，
+/// 长期运行后段数仍会累积，查询延迟缓慢上升。本 actor 周期性检查段结构：
+///
+/// 1. 按 `PerformanceMode` 和当前段数调整 `automerge` / `crisismerge` / `usermerge`
+/// 2. 段数超过阈值时，在时间预算内执行若干次增量 `'merge'`（每步独立事务，不长时间占用写锁）
+/// 3. 库静默（写入计数器长时间不变）且仍有多个段时执行一次完整 `'optimize'`
+///
+/// 低电量模式或热量 `.serious` 以上时跳过本轮。
+public actor FTSMaintenance {
+
+    /// 维护策略
+    public struct Policy: Sendable, Equatable {
+        /// 写入时自动合并阈值（单层段数达到时合并，FTS5 默认 4）
+        public var automerge: Int
+        /// 写入时强制合并阈值（FTS5 默认 16）
+        public var crisismerge: Int
+        /// 'merge' 命令的单层最少段数（FTS5 默认 4）
+        public var usermerge: Int
+        /// 单次 'merge' 步进的叶页数
+        public var mergePages: Int
+        /// 每轮增量合并的时间预算（秒）
+        public var mergeBudget: TimeInterval
+        /// 段数超过此值才执行增量合并
+        public var mergeThreshold: Int
+        /// 静默多久后允许 'optimize'（秒）
+        public var optimizeAfterIdle: TimeInterval
+
+        /// 按性能模式给出策略
+        ///
+        /// 非全速模式提高 automerge，让写入路径少做合并，由空闲维护补上。
+        public static func standard(for mode: PerformanceMode) -> Policy {
+            switch mode {
+            case .fullSpeed:
+                return Policy(automerge: 4, crisismerge: 16, usermerge: 2, mergePages: 1000,
+                              mergeBudget: 0.25, mergeThreshold: 4, optimizeAfterIdle: 120)
+            case .balanced:
+                return Policy(automerge: 8, crisismerge: 16, usermerge: 2, mergePages: 500,
+                              mergeBudget: 0.1, mergeThreshold: 8, optimizeAfterIdle: 600)
+            case .background:
+                return Policy(automerge: 8, crisismerge: 24, usermerge: 2, mergePages: 200,
+                              mergeBudget: 0.05, mergeThreshold: 12, optimizeAfterIdle: 1800)
+            }
+        }
+    }
+
+    /// 单轮维护结果
+    public struct Report: Sendable, Equatable {
+        /// 执行的操作
+        public enum Action: Sendable, Equatable {
+            /// 系统受限（低电量 / 过热），未执行
+            case skipped
+            /// 段结构良好，无需处理
+            case idle
+            /// 增量合并（步数）
+            case merged(steps: Int)
+            /// 完整优化
+            case optimized
+        }
+
+        public var action: Action
+        public var segmentsBefore: Int
+        public var segmentsAfter: Int
+        public var elapsed: TimeInterval
+    }
+
+    /// 全局搜索索引
+    private let db: DatabaseWriter
+
+    /// FTS5 表名
+    public nonisolated let table: String
+
+    /// 系统是否受限（可注入，便于测试）
+    private let isConstrained: @Sendable () -> Bool
+
+    private var mode: PerformanceMode
+    private var lastWriteCounter: UInt64?
+    private var lastWriteAt = Date()
+    private var optimizedWriteCounter: UInt64?
+    private var loopTask: Task<Void, Never>?
+
+    public init(
+        db: DatabaseWriter,
+        mode: PerformanceMode = .balanced,
+        table: String = "clips_fts",
+        isConstrained: @escaping @Sendable () -> Bool = FTSMaintenance.systemIsConstrained
+    ) {
+        self.db = db
+        self.mode = mode
+        self.table = table
+        self.isConstrained = isConstrained
+    }
+
+    // MARK: - 公开方法
+
+    /// 更新性能模式（下一轮生效）
+    public func setMode(_ mode: PerformanceMode) {
+        self.mode = mode
+    }
+
+    /// 启动周期维护（幂等）
+    ///
+    /// - Parameter interval: 检查间隔（默认 60 秒）
+    public func start(interval: Duration = .seconds(60)) {
+        guard loopTask == nil else { return }
+        loopTask = Task(priority: .background) { [weak self] in
+            while !Task.isCancelled {
+                try? await Task.sleep(for: interval)
+                guard !Task.isCancelled, let self else { break }
+                _ = try? await self.runOnce()
+            }
+        }
+    }
+
+    /// 停止周期维护
+    public func stop() {
+        loopTask?.cancel()
+        loopTask = nil
+    }
+
+    /// 执行一轮维护
+    ///
+    /// - Parameters:
+    ///   - now: 当前时间（测试注入）
+    ///   - forceOptimize: 忽略静默条件直接 optimize（CLI 手动维护）
+    @discardableResult
+    public func runOnce(now: Date = Date(), forceOptimize: Bool = false) throws -> Report {
+        let started = Date()
+        let table = self.table
+        guard let before = try db.read({ try FTSSegmentStructure.read($0, table: table) }) else {
+            return Report(action: .idle, segmentsBefore: 0, segmentsAfter: 0, elapsed: 0)
+        }
+        guard forceOptimize || !isConstrained() else {
+            return Report(action: .skipped, segmentsBefore: before.segmentCount,
+                          segmentsAfter: before.segmentCount, elapsed: 0)
+        }
+
+        // 写入计数器变化 = 有新数据写入（首次观察按刚写入处理）
+        if before.writeCounter != lastWriteCounter {
+            lastWriteCounter = before.writeCounter
+            lastWriteAt = now
+        }
+
+        let policy = Self.effectivePolicy(.standard(for: mode), structure: before)
+        try applyConfig(policy)
+
+        var action = Report.Action.idle
+        let quiescent = now.timeIntervalSince(lastWriteAt) >= policy.optimizeAfterIdle
+        if before.segmentCount > 1,
+           forceOptimize || (quiescent && optimizedWriteCounter != before.writeCounter) {
+            try db.write { db in
+                try db.execute(sql: "INSERT INTO \"\(table)\"(\"\(table)\") VALUES('optimize')")
+            }
+            optimizedWriteCounter = before.writeCounter
+            action = .optimized
+        } else if before.segmentCount > policy.mergeThreshold {
+            action = .merged(steps: try merge(policy: policy))
+        }
+
+        let after = try db.read { try FTSSegmentStructure.read($0, table: table) }
+        return Report(
+            action: action,
+            segmentsBefore: before.segmentCount,
+            segmentsAfter: after?.segmentCount ?? 0,
+            elapsed: Date().timeIntervalSince(started)
+        )
+    }
+
+    /// 低电量模式或热量 `.serious` 以上
+    public static func systemIsConstrained() -> Bool {
+        let info = ProcessInfo.processInfo
+        if info.isLowPowerModeEnabled { return true }
+        switch info.thermalState {
+        case .serious, .critical: return true
+        default: return false
+        }
+    }
+
+    // MARK: - 内部方法
+
+    /// 段数远超阈值（写入持续快于空闲合并）时降低 automerge，让写入路径分担合并
+    static func effectivePolicy(_ base: Policy, structure: FTSSegmentStructure) -> Policy {
+        var policy = base
+        if structure.segmentCount > base.crisismerge * 2 {
+            policy.automerge = 2
+        }
+        return policy
+    }
+
+    /// 写入 FTS5 配置（`<table>_config` 中已是目标值时跳过，避免无谓写事务）
+    private func applyConfig(_ policy: Policy) throws {
+        let table = self.table
+        let desired: [(String, Int)] = [
+            ("automerge", policy.automerge),
+            ("crisismerge", policy.crisismerge),
+            ("usermerge", policy.usermerge),
+        ]
+        let current = try db.read { db -> [String: Int] in
+            let rows = try Row.fetchAll(db, sql: "SELECT k, v FROM \"\(table)_config\"")
+            var values: [String: Int] = [:]
+            for row in rows {
+                if let key: String = row["k"], let value: Int = row["v"] {
+                    values[key] = value
+                }
+            }
+            return values
+        }
+        let changes = desired.filter { current[$0.0] != $0.1 }
+        guard !changes.isEmpty else { return }
+        try db.write { db in
+            for (key, value) in changes {
+                try db.execute(
+                    sql: "INSERT INTO \"\(table)\"(\"\(table)\", rank) VALUES(?, ?)",
+                    arguments: [key, value]
+                )
+            }
+        }
+    }
+
+    /// 时间预算内的增量合并
+    ///
+    /// 每步独立写事务；total_changes 增量 < 2 表示已无可合并内容（SQLite 文档约定）。
+    private func merge(policy: Policy) throws -> Int {
+        let table = self.table
+        let deadline = Date().addingTimeInterval(policy.mergeBudget)
+        var steps = 0
+        repeat {
+            let progressed = try db.write { db -> Bool in
+                let before = db.totalChangesCount
+                try db.execute(
+                    sql: "INSERT INTO \"\(table)\"(\"\(table)\", rank) VALUES('merge', ?)",
+                    arguments: [policy.mergePages]
+                )
+                return db.totalChangesCount - before >= 2
+            }
+            guard progressed else { break }
+            steps += 1
+        } while Date() < deadline && !Task.isCancelled
+        return steps
+    }
+}
@@ -0,0 +1,231 @@
+import Foundation
+import GRDB
+
+/// 文件夹级数据库连接池管理器
+///
+/// `DatabaseManager.openFolderDatabase` 每次调用都新建完整的 `DatabasePool`
+/// （WAL 写连接 + 最多 5 个读连接，各自独立页缓存），注册的文件夹一多，
+/// 文件描述符和内存随文件夹数线性增长。本管理器：
+/// - 按需打开：第一次访问某文件夹时才建池，之后复用同一个池
+/// - 共享页缓存预算：每个连接的 `cache_size` = 总预算 / (最大池数 × 每池连接数)
+/// - 闲置关闭：超过 `idleTimeout` 未访问、或超出 `maxOpenPools` 时按 LRU 释放
+/// - 后台检查点：闲置回收时顺带对仍打开的池执行 PASSIVE 检查点
+/// - 迁移缓存：借助 `PRAGMA user_version` 跳过已是最新 schema 的迁移检查
+///
+/// 释放只是移除管理器持有的引用；调用方仍持有的池在最后一个引用释放时由 GRDB 关闭，
+/// 因此不会打断进行中的读写。
+public final class FolderDatabasePool: @unchecked Sendable {
+
+    /// 管理器配置
+    public struct Config: Sendable {
+        /// 闲置多久后关闭（秒）
+        public var idleTimeout: TimeInterval
+        /// 同时保持打开的池上限
+        public var maxOpenPools: Int
+        /// 所有文件夹库共享的页缓存预算（KiB）
+        public var cacheBudgetKiB: Int
+        /// 每个池的读连接上限
+        public var maximumReaderCount: Int
+
+        public static let `default` = Config()
+
+        public init(
+            idleTimeout: TimeInterval = 300,
+            maxOpenPools: Int = 8,
+            cacheBudgetKiB: Int = 48 * 1024,
+            maximumReaderCount: Int = 2
+        ) {
+            self.idleTimeout = idleTimeout
+            self.maxOpenPools = max(1, maxOpenPools)
+            self.cacheBudgetKiB = cacheBudgetKiB
+            self.maximumReaderCount = max(1, maximumReaderCount)
+        }
+
+        /// 每个连接分到的页缓存（KiB，不低于 512）
+        public var perConnectionCacheKiB: Int {
+            max(512, cacheBudgetKiB / (maxOpenPools * (maximumReaderCount + 1)))
+        }
+    }
+
+    /// App 共享实例
+    public static let shared = FolderDatabasePool()
+
+    public let config: Config
+
+    private struct Entry {
+        let pool: DatabasePool
+        var lastUsed: Date
+    }
+
+    /// 进行中的打开操作：同一路径的并发请求等待首个请求的结果
+    private final class Opening: @unchecked Sendable {
+        private let condition = NSCondition()
+        private var result: Result<DatabasePool, Error>?
+
+        func finish(_ result: Result<DatabasePool, Error>) {
+            condition.lock()
+            self.result = result
+            condition.broadcast()
+            condition.unlock()
+        }
+
+        func wait() throws -> DatabasePool {
+            condition.lock(); defer { condition.unlock() }
+            while result == nil { condition.wait() }
+            return try result!.get()
+        }
+    }
+
+    private let lock = NSLock()
+    private var entries: [String: Entry] = [:]
+    private var openings: [String: Opening] = [:]
+    private var sweepTask: Task<Void, Never>?
+
+    public init(config: Config = .default) {
+        self.config = config
+    }
+
+    deinit {
+        sweepTask?.cancel()
+    }
+
+    // MARK: - 获取
+
+    /// 获取文件夹库连接池（未打开时打开并按需迁移）
+    ///
+    /// 锁内只查缓存；建池与迁移在锁外进行，不阻塞其他文件夹的访问。
+    /// 同一文件夹的并发请求等待首个请求的结果，只会建一个池。
+    ///
+    /// - Parameter folderPath: 素材文件夹的绝对路径
+    /// - Throws: `StorageError`（文件夹不可访问、无法创建索引目录、打开失败）
+    public func database(at folderPath: String, now: Date = Date()) throws -> DatabasePool {
+        lock.lock()
+        if var entry = entries[folderPath] {
+            entry.lastUsed = now
+            entries[folderPath] = entry
+            lock.unlock()
+            return entry.pool
+        }
+        if let pending = openings[folderPath] {
+            lock.unlock()
+            return try pending.wait()
+        }
+        let opening = Opening()
+        openings[folderPath] = opening
+        lock.unlock()
+
+        let result = Result { try open(folderPath: folderPath) }
+
+        lock.lock()
+        // 打开期间被 close 移除的请求不入缓存（调用方仍拿到可用的池）
+        if openings[folderPath] === opening {
+            openings.removeValue(forKey: folderPath)
+            if case .success(let pool) = result {
+                entries[folderPath] = Entry(pool: pool, lastUsed: now)
+                evictOverflow()
+            }
+        }
+        lock.unlock()
+        opening.finish(result)
+        return try result.get()
+    }
+
+    /// 建池并按需迁移（不持锁）
+    private func open(folderPath: String) throws -> DatabasePool {
+        var profile = StorageProfile.folder
+        profile.cacheSizeKiB = config.perConnectionCacheKiB
+        let pool = try DatabaseManager.openPool(
+            at: DatabaseManager.folderDatabasePath(for: folderPath),
+            profile: profile
+        ) { [config] configuration in
+            configuration.maximumReaderCount = config.maximumReaderCount
+        }
+        try DatabaseManager.migrateFolderIfNeeded(pool)
+        return pool
+    }
+
+    // MARK: - 释放
+
+    /// 当前打开的文件夹路径
+    public var openFolderPaths: [String] {
+        lock.lock(); defer { lock.unlock() }
+        return entries.keys.sorted()
+    }
+
+    /// 关闭指定文件夹的池（卷卸载、移除文件夹时调用）
+    public func close(folderPath: String) {
+        lock.lock()
+        let entry = entries.removeValue(forKey: folderPath)
+        openings.removeValue(forKey: folderPath)
+        lock.unlock()
+        entry?.pool.releaseMemory()
+    }
+
+    /// 关闭所有池
+    public func closeAll() {
+        lock.lock()
+        let closed = entries.values.map(\.pool)
+        entries.removeAll()
+        openings.removeAll()
+        lock.unlock()
+        closed.forEach { $0.releaseMemory() }
+    }
+
+    /// 关闭闲置超时的池
+    ///
+    /// - Returns: 关闭的数量
+    @discardableResult
+    public func closeIdle(now: Date = Date()) -> Int {
+        lock.lock()
+        let expired = entries.filter { now.timeIntervalSince($0.value.lastUsed) >= config.idleTimeout }
+        for path in expired.keys { entries.removeValue(forKey: path) }
+        lock.unlock()
+        expired.values.forEach { $0.pool.releaseMemory() }
+        return expired.count
+    }
+
+    /// 对所有打开的池执行一次 WAL 检查点
+    public func checkpointAll() {
+        lock.lock()
+        let pools = entries.values.map(\.pool)
+        lock.unlock()
+        for pool in pools {
+            _ = try? WALCheckpointer.checkpoint(pool)
+        }
+    }
+
+    /// 启动后台闲置回收 + 检查点（间隔为闲置超时的一半，至少 10 秒）
+    public func startIdleSweep() {
+        lock.lock(); defer { lock.unlock() }
+        guard sweepTask == nil else { return }
+        let interval = max(10, config.idleTimeout / 2)
+        sweepTask = Task.detached(priority: .utility) { [weak self] in
+            while !Task.isCancelled {
+                try? await Task.sleep(nanoseconds: UInt64(interval * 1_000_000_000))
+                guard let self, !Task.isCancelled else { return }
+                self.closeIdle()
+                self.checkpointAll()
+            }
+        }
+    }
+
+    /// 停止后台闲置回收
+    public func stopIdleSweep() {
+        lock.lock(); defer { lock.unlock() }
+        sweepTask?.cancel()
+        sweepTask = nil
+    }
+
+    // MARK: - Private
+
+    /// 超出上限时按最近使用时间淘汰（调用方持锁）
+    private func evictOverflow() {
+        guard entries.count > config.maxOpenPools else { return }
+        let victims = entries
+            .sorted { $0.value.lastUsed < $1.value.lastUsed }
+            .prefix(entries.count - config.maxOpenPools)
+        for (path, _) in victims {
+            entries.removeValue(forKey: path)
+        }
+    }
+}
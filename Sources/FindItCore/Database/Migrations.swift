@@ -139,9 +139,146 @@ public enum Migrations {
             )
         }
 
+        // 带时间码的转录片段（每条 STT 字幕一行，短语命中可定位到具体时刻）
+        migrator.registerMigration("v9_addTranscriptSegments") { db in
+            try db.create(table: "transcript_segments") { t in
+                t.autoIncrementedPrimaryKey("segment_id")
+                t.column("video_id", .integer).notNull()
+                    .references("videos", onDelete: .cascade)
+                t.column("segment_index", .integer).notNull()
+                t.column("start_time", .double).notNull()
+                t.column("end_time", .double).notNull()
+                t.column("speaker", .text)
+                t.column("text", .text).notNull()
+            }
+            try db.create(
+                index: "idx_transcript_segments_video",
+                on: "transcript_segments",
+                columns: ["video_id", "segment_index"]
+            )
+        }
+
+        // 整数纳秒时间戳：videos 的时间列新增 *_ns INTEGER 列作为比较/排序依据
+        migrator.registerMigration("v10_addEpochNanosecondTimestamps") { db in
+            for column in videoTimestampColumns {
+                try db.alter(table: "videos") { t in
+                    t.add(column: "\(column)_ns", .integer)
+                }
+                try db.execute(sql: """
+                    UPDATE videos SET \(column)_ns = \(nanosecondsSQL(column))
+                    WHERE \(column) IS NOT NULL
+                    """)
+            }
+            try db.create(
+                index: "idx_videos_orphaned_at_ns",
+                on: "videos",
+                columns: ["index_status", "orphaned_at_ns"]
+            )
+            try db.create(index: "idx_videos_indexed_at_ns", on: "videos", columns: ["indexed_at_ns"])
+
+            // 旧 TEXT 列保留为镜像（便携索引可能仍被旧版本读取），由触发器双向同步：
+            // 只写 *_ns 时回填字符串，只写字符串（旧版本/手工 SQL）时回填 *_ns。
+            // 两侧已在同一秒内一致时不触发，避免用秒级字符串覆盖纳秒值。
+            for column in videoTimestampColumns {
+                let outOfSync = "(new.\(column)_ns / 1000000000) IS NOT CAST(strftime('%s', new.\(column)) AS INTEGER)"
+                try db.execute(sql: """
+                    CREATE TRIGGER videos_\(column)_ns_from_text AFTER UPDATE OF \(column) ON videos
+                    WHEN new.\(column) IS NOT old.\(column) AND new.\(column)_ns IS old.\(column)_ns
+                        AND \(outOfSync)
+                    BEGIN
+                        UPDATE videos SET \(column)_ns = \(nanosecondsSQL("new.\(column)"))
+                        WHERE video_id = new.video_id;
+                    END
+                    """)
+                try db.execute(sql: """
+                    CREATE TRIGGER videos_\(column)_text_from_ns AFTER UPDATE OF \(column)_ns ON videos
+                    WHEN new.\(column)_ns IS NOT old.\(column)_ns AND new.\(column) IS old.\(column)
+                        AND \(outOfSync)
+                    BEGIN
+                        UPDATE videos SET \(column) = \(datetimeSQL("new.\(column)_ns"))
+                        WHERE video_id = new.video_id;
+                    END
+                    """)
+            }
+            let fill = videoTimestampColumns.map { column in
+                """
+                \(column)_ns = COALESCE(new.\(column)_ns, \(nanosecondsSQL("new.\(column)"))),
+                        \(column) = COALESCE(new.\(column), \(datetimeSQL("new.\(column)_ns")))
+                """
+            }.joined(separator: ",\n        ")
+            let missing = videoTimestampColumns.map { column in
+                "(new.\(column) IS NULL) <> (new.\(column)_ns IS NULL)"
+            }.joined(separator: " OR ")
+            try db.execute(sql: """
+                CREATE TRIGGER videos_timestamps_ai AFTER INSERT ON videos
+                WHEN \(missing)
+                BEGIN
+                    UPDATE videos SET
+                        \(fill)
+                    WHERE video_id = new.video_id;
+                END
+                """)
+        }
+
+        // 管线阶段产物检查点（崩溃/中断后从最后提交的单元继续）
+        migrator.registerMigration("v11_addStageArtifacts") { db in
+            try db.create(table: "stage_artifacts") { t in
+                t.column("video_id", .integer).notNull()
+                    .references("videos", onDelete: .cascade)
+                t.column("kind", .text).notNull()
+                t.column("unit", .integer).notNull().defaults(to: 0)
+                t.column("file_hash", .text).notNull()
+                t.column("payload", .text).notNull()
+                t.column("updated_at_ns", .integer).notNull()
+                t.primaryKey(["video_id", "kind", "unit"])
+            }
+        }
+
+        // 色彩签名：量化 Lab 直方图（64 字节，调色板检索）
+        migrator.registerMigration("v12_addColorSignature") { db in
+            try db.alter(table: "clips") { t in
+                t.add(column: "color_signature", .blob)
+            }
+        }
+
+        // 关键帧视觉特征（"找相似镜头"，与文本 embedding 独立）
+        migrator.registerMigration("v13_addVisualEmbedding") { db in
+            try db.alter(table: "clips") { t in
+                t.add(column: "visual_embedding", .blob)
+                t.add(column: "visual_model", .text)
+            }
+        }
+
+        // 文件回收队列（删除视频后由 FileGarbageCollector 后台清理缩略图 / SRT）
+        migrator.registerMigration("v14_addFileGarbage") { db in
+            try db.create(table: "file_garbage") { t in
+                t.column("path", .text).primaryKey()
+                t.column("enqueued_at_ns", .integer).notNull()
+                t.column("attempts", .integer).notNull().defaults(to: 0)
+            }
+        }
+
+        // clip 时间区间 R*Tree（时间码点查 / 区间查询，见 ClipTimeIndex）
+        migrator.registerMigration("v15_addClipTimeIndex") { db in
+            try createClipTimeIndex(db)
+        }
+
         return migrator
     }
 
+    /// videos 表中以 `*_ns` 整数列镜像的时间列
+    static let videoTimestampColumns = ["file_modified", "created_at", "indexed_at", "orphaned_at"]
+
+    /// SQLite datetime 字符串 → 纳秒（秒级精度）
+    private static func nanosecondsSQL(_ expression: String) -> String {
+        "CAST(strftime('%s', \(expression)) AS INTEGER) * 1000000000"
+    }
+
+    /// 纳秒 → SQLite datetime 字符串
+    private static func datetimeSQL(_ expression: String) -> String {
+        "datetime(\(expression) / 1000000000, 'unixepoch')"
+    }
+
     // MARK: - 全局搜索索引迁移
 
     /// 为全局搜索索引数据库注册迁移
@@ -361,6 +498,315 @@ public enum Migrations {
             }
         }
 
+        // 查询规划：FTS5 词项文档频率（fts5vocab 只是索引视图，无需维护）
+        migrator.registerMigration("v9_addFTSVocab") { db in
+            try db.execute(sql: """
+                CREATE VIRTUAL TABLE IF NOT EXISTS clips_fts_vocab USING fts5vocab(clips_fts, row)
+                """)
+        }
+
+        // 转录片段镜像 + 独立 FTS5 索引（台词搜索返回片段级时间码）
+        migrator.registerMigration("v10_addTranscriptSegments") { db in
+            try db.create(table: "transcript_segments") { t in
+                t.autoIncrementedPrimaryKey("segment_id")
+                t.column("source_folder", .text).notNull()
+                t.column("source_segment_id", .integer).notNull()
+                t.column("source_video_id", .integer).notNull()
+                t.column("video_id", .integer)
+                t.column("start_time", .double).notNull()
+                t.column("end_time", .double).notNull()
+                t.column("speaker", .text)
+                t.column("text", .text).notNull()
+                t.uniqueKey(["source_folder", "source_segment_id"])
+            }
+            try db.create(
+                index: "idx_transcript_segments_video",
+                on: "transcript_segments",
+                columns: ["video_id", "start_time"]
+            )
+            try db.create(
+                index: "idx_transcript_segments_source_video",
+                on: "transcript_segments",
+                columns: ["source_folder", "source_video_id"]
+            )
+
+            try db.execute(sql: """
+                CREATE VIRTUAL TABLE transcript_fts USING fts5(
+                    text,
+                    content='transcript_segments',
+                    content_rowid='segment_id'
+                )
+                """)
+            try db.execute(sql: """
+                CREATE TRIGGER transcript_fts_ai AFTER INSERT ON transcript_segments BEGIN
+                    INSERT INTO transcript_fts(rowid, text) VALUES (new.segment_id, new.text);
+                END
+                """)
+            try db.execute(sql: """
+                CREATE TRIGGER transcript_fts_bd BEFORE DELETE ON transcript_segments BEGIN
+                    INSERT INTO transcript_fts(transcript_fts, rowid, text)
+                    VALUES ('delete', old.segment_id, old.text);
+                END
+                """)
+            try db.execute(sql: """
+                CREATE TRIGGER transcript_fts_bu BEFORE UPDATE ON transcript_segments BEGIN
+                    INSERT INTO transcript_fts(transcript_fts, rowid, text)
+                    VALUES ('delete', old.segment_id, old.text);
+                END
+                """)
+            try db.execute(sql: """
+                CREATE TRIGGER transcript_fts_au AFTER UPDATE ON transcript_segments BEGIN
+                    INSERT INTO transcript_fts(rowid, text) VALUES (new.segment_id, new.text);
+                END
+                """)
+
+            try db.alter(table: "sync_meta") { t in
+                t.add(column: "last_synced_segment_rowid", .integer).defaults(to: 0)
+            }
+        }
+
+        // 色彩签名镜像（调色板检索）
+        migrator.registerMigration("v11_addColorSignature") { db in
+            try db.alter(table: "clips") { t in
+                t.add(column: "color_signature", .blob)
+            }
+        }
+
+        // 视觉特征镜像（"找相似镜头"）
+        migrator.registerMigration("v12_addVisualEmbedding") { db in
+            try db.alter(table: "clips") { t in
+                t.add(column: "visual_embedding", .blob)
+                t.add(column: "visual_model", .text)
+            }
+        }
+
+        // clip 时间区间 R*Tree（台词 → clip 映射等时间码查询）
+        migrator.registerMigration("v13_addClipTimeIndex") { db in
+            try createClipTimeIndex(db)
+        }
+
+        // 文本列压缩（见 TextCompression）：字典表 + FTS5 经解压视图读取内容（v16 改为无内容 FTS）
+        migrator.registerMigration("v14_addTextCompression") { db in
+            // 迁移连接上临时注册解压函数（下方 rebuild 经视图读取；v16 起 schema 不再引用）
+            try TextCompression.withLegacyFunction(db) {
+                try db.create(table: "text_dictionaries") { t in
+                    t.column("dict_id", .integer).primaryKey()
+                    t.column("dictionary", .blob).notNull()
+                    t.column("sample_count", .integer).notNull()
+                    t.column("created_at_ns", .integer).notNull()
+                }
+
+                // FTS5 外部内容：description / transcript 可能为压缩 BLOB，经视图解压
+                try db.execute(sql: """
+                    CREATE VIEW clips_fts_content AS
+                    SELECT clip_id, tags,
+                           findit_text(description) AS description,
+                           findit_text(transcript) AS transcript,
+                           user_tags
+                    FROM clips
+                    """)
+
+                try db.execute(sql: "DROP TRIGGER IF EXISTS clips_fts_ai")
+                try db.execute(sql: "DROP TRIGGER IF EXISTS clips_fts_bd")
+                try db.execute(sql: "DROP TRIGGER IF EXISTS clips_fts_bu")
+                try db.execute(sql: "DROP TRIGGER IF EXISTS clips_fts_au")
+                try db.execute(sql: "DROP TABLE IF EXISTS clips_fts")
+
+                try db.execute(sql: """
+                    CREATE VIRTUAL TABLE clips_fts USING fts5(
+                        tags,
+                        description,
+                        transcript,
+                        user_tags,
+                        content='clips_fts_content',
+                        content_rowid='clip_id'
+                    )
+                    """)
+
+                try db.execute(sql: """
+                    CREATE TRIGGER clips_fts_ai AFTER INSERT ON clips BEGIN
+                        INSERT INTO clips_fts(rowid, tags, description, transcript, user_tags)
+                        VALUES (new.clip_id, new.tags, findit_text(new.description),
+                                findit_text(new.transcript), new.user_tags);
+                    END
+                    """)
+
+                try db.execute(sql: """
+                    CREATE TRIGGER clips_fts_bd BEFORE DELETE ON clips BEGIN
+                        INSERT INTO clips_fts(clips_fts, rowid, tags, description, transcript, user_tags)
+                        VALUES ('delete', old.clip_id, old.tags, findit_text(old.description),
+                                findit_text(old.transcript), old.user_tags);
+                    END
+                    """)
+
+                // 只在索引文本实际变化时更新 FTS：评分 / 色标等列的更新，
+                // 以及同一文本由明文改写为压缩存储，都不再重建 FTS 条目
+                let textChanged = """
+                    old.tags IS NOT new.tags OR old.user_tags IS NOT new.user_tags
+                        OR (old.description IS NOT new.description
+                            AND findit_text(old.description) IS NOT findit_text(new.description))
+                        OR (old.transcript IS NOT new.transcript
+                            AND findit_text(old.transcript) IS NOT findit_text(new.transcript))
+                    """
+
+                try db.execute(sql: """
+                    CREATE TRIGGER clips_fts_bu BEFORE UPDATE OF tags, description, transcript, user_tags ON clips
+                    WHEN \(textChanged)
+                    BEGIN
+                        INSERT INTO clips_fts(clips_fts, rowid, tags, description, transcript, user_tags)
+                        VALUES ('delete', old.clip_id, old.tags, findit_text(old.description),
+                                findit_text(old.transcript), old.user_tags);
+                    END
+                    """)
+
+                try db.execute(sql: """
+                    CREATE TRIGGER clips_fts_au AFTER UPDATE OF tags, description, transcript, user_tags ON clips
+                    WHEN \(textChanged)
+                    BEGIN
+                        INSERT INTO clips_fts(rowid, tags, description, transcript, user_tags)
+                        VALUES (new.clip_id, new.tags, findit_text(new.description),
+                                findit_text(new.transcript), new.user_tags);
+                    END
+                    """)
+
+                try db.execute(sql: "INSERT INTO clips_fts(clips_fts) VALUES('rebuild')")
+            }
+        }
+
+        // 清理早期版本删除视频时遗留的转录片段（FTS5 触发器同步移除索引）
+        migrator.registerMigration("v15_purgeOrphanTranscriptSegments") { db in
+            try db.execute(sql: """
+                DELETE FROM transcript_segments
+                WHERE NOT EXISTS (
+                    SELECT 1 FROM videos v
+                    WHERE v.source_folder = transcript_segments.source_folder
+                      AND v.source_video_id = transcript_segments.source_video_id
+                )
+                """)
+        }
+
+        // FTS5 改为无内容表（见 TextCompression）：原文只存在 clips，触发器不调用应用函数，
+        // 连接无需注册函数或打开 trusted_schema
+        migrator.registerMigration("v16_contentlessFTS") { db in
+            for trigger in ["clips_fts_ai", "clips_fts_bd", "clips_fts_bu", "clips_fts_au",
+                            "clips_fts_ad", "clips_fts_au_tags", "clips_fts_au_text"] {
+                try db.execute(sql: "DROP TRIGGER IF EXISTS \(trigger)")
+            }
+            try db.execute(sql: "DROP TABLE IF EXISTS clips_fts")
+            try db.execute(sql: "DROP VIEW IF EXISTS clips_fts_content")
+
+            // 无内容表：只存倒排索引，原文留在 clips（可压缩），同一文本不存两份。
+            // 列值读出为 NULL；contentless_delete 允许按 rowid 删除，不支持改部分列，
+            // 因此更新一律整行删除后重插
+            try db.execute(sql: """
+                CREATE VIRTUAL TABLE clips_fts USING fts5(
+                    tags,
+                    description,
+                    transcript,
+                    user_tags,
+                    content='',
+                    contentless_delete=1
+                )
+                """)
+
+            // 压缩 BLOB 在 SQL 中无法解码：触发器只处理两列都是 TEXT 的行，
+            // 含压缩值的行由写入方在同一事务内经 TextCompression.indexText 整行补写
+            let plainText = "typeof(new.description) <> 'blob' AND typeof(new.transcript) <> 'blob'"
+
+            try db.execute(sql: """
+                CREATE TRIGGER clips_fts_ai AFTER INSERT ON clips
+                WHEN \(plainText)
+                BEGIN
+                    INSERT INTO clips_fts(rowid, tags, description, transcript, user_tags)
+                    VALUES (new.clip_id, new.tags, new.description, new.transcript, new.user_tags);
+                END
+                """)
+
+            try db.execute(sql: """
+                CREATE TRIGGER clips_fts_ad AFTER DELETE ON clips BEGIN
+                    DELETE FROM clips_fts WHERE rowid = old.clip_id;
+                END
+                """)
+
+            // 评分 / 色标等列的更新不触及 FTS；由明文改写为压缩存储（compact）
+            // 新值为 BLOB，同样跳过，FTS 条目保持不变
+            try db.execute(sql: """
+                CREATE TRIGGER clips_fts_au AFTER UPDATE OF tags, description, transcript, user_tags ON clips
+                WHEN \(plainText)
+                    AND (old.tags IS NOT new.tags OR old.description IS NOT new.description
+                         OR old.transcript IS NOT new.transcript OR old.user_tags IS NOT new.user_tags)
+                BEGIN
+                    DELETE FROM clips_fts WHERE rowid = new.clip_id;
+                    INSERT INTO clips_fts(rowid, tags, description, transcript, user_tags)
+                    VALUES (new.clip_id, new.tags, new.description, new.transcript, new.user_tags);
+                END
+                """)
+
+            // 回填：明文行直接插入，含压缩值的行在 Swift 侧解码后补写
+            try db.execute(sql: """
+                INSERT INTO clips_fts(rowid, tags, description, transcript, user_tags)
+                SELECT clip_id, tags, description, transcript, user_tags FROM clips
+                WHERE typeof(description) <> 'blob' AND typeof(transcript) <> 'blob'
+                """)
+            let compressed = try Int64.fetchAll(db, sql: """
+                SELECT clip_id FROM clips
+                WHERE typeof(description) = 'blob' OR typeof(transcript) = 'blob'
+                """)
+            for clipId in compressed {
+                try TextCompression.reindex(db, clipId: clipId)
+            }
+        }
+
         return migrator
     }
+
+    // MARK: - 共享步骤
+
+    /// 创建 clips 时间区间 R*Tree 并回填（文件夹库与全局库 clips 表结构一致）
+    ///
+    /// 每个 clip 一个二维框：(video_id, video_id) × (start_time, end_time)。
+    /// R*Tree 坐标为 32 位浮点，存储时向外取整，查询结果是超集，
+    /// 由 `ClipTimeIndex` 再按 clips 原值精确过滤。
+    /// 起止颠倒的 clip 按 MIN/MAX 入库，避免 R*Tree 约束失败阻塞写入。
+    static func createClipTimeIndex(_ db: Database) throws {
+        try db.execute(sql: """
+            CREATE VIRTUAL TABLE clips_time_rtree USING rtree(
+                clip_id,
+                video_lo, video_hi,
+                start_time, end_time
+            )
+            """)
+
+        try db.execute(sql: """
+            INSERT INTO clips_time_rtree (clip_id, video_lo, video_hi, start_time, end_time)
+            SELECT clip_id, video_id, video_id, MIN(start_time, end_time), MAX(start_time, end_time)
+            FROM clips WHERE video_id IS NOT NULL
+            """)
+
+        try db.execute(sql: """
+            CREATE TRIGGER clips_time_ai AFTER INSERT ON clips
+            WHEN new.video_id IS NOT NULL
+            BEGIN
+                INSERT INTO clips_time_rtree (clip_id, video_lo, video_hi, start_time, end_time)
+                VALUES (new.clip_id, new.video_id, new.video_id,
+                        MIN(new.start_time, new.end_time), MAX(new.start_time, new.end_time));
+            END
+            """)
+
+        try db.execute(sql: """
+            CREATE TRIGGER clips_time_ad AFTER DELETE ON clips BEGIN
+                DELETE FROM clips_time_rtree WHERE clip_id = old.clip_id;
+            END
+            """)
+
+        try db.execute(sql: """
+            CREATE TRIGGER clips_time_au AFTER UPDATE OF clip_id, video_id, start_time, end_time ON clips BEGIN
+                DELETE FROM clips_time_rtree WHERE clip_id = old.clip_id;
+                INSERT INTO clips_time_rtree (clip_id, video_lo, video_hi, start_time, end_time)
+                SELECT new.clip_id, new.video_id, new.video_id,
+                       MIN(new.start_time, new.end_time), MAX(new.start_time, new.end_time)
+                WHERE new.video_id IS NOT NULL;
+            END
+            """)
+    }
 }
@@ -78,6 +78,11 @@ public struct Video: Codable, FetchableRecord, MutablePersistableRecord {
     public var priority: Int
     public var lastProcessedClip: Int?
     public var srtPath: String?
+    /// 纳秒时间戳（`Timestamp`，比较与排序以这些列为准；字符串列由触发器镜像）
+    public var fileModifiedNs: Int64?
+    public var createdAtNs: Int64?
+    public var indexedAtNs: Int64?
+    public var orphanedAtNs: Int64?
 
     public static let databaseTableName = "videos"
 
@@ -98,6 +103,10 @@ public struct Video: Codable, FetchableRecord, MutablePersistableRecord {
         case priority
         case lastProcessedClip = "last_processed_clip"
         case srtPath = "srt_path"
+        case fileModifiedNs = "file_modified_ns"
+        case createdAtNs = "created_at_ns"
+        case indexedAtNs = "indexed_at_ns"
+        case orphanedAtNs = "orphaned_at_ns"
     }
 
     public init(
@@ -116,7 +125,11 @@ public struct Video: Codable, FetchableRecord, MutablePersistableRecord {
         orphanedAt: String? = nil,
         priority: Int = 0,
         lastProcessedClip: Int? = nil,
-        srtPath: String? = nil
+        srtPath: String? = nil,
+        fileModifiedNs: Int64? = nil,
+        createdAtNs: Int64? = nil,
+        indexedAtNs: Int64? = nil,
+        orphanedAtNs: Int64? = nil
     ) {
         self.videoId = videoId
         self.folderId = folderId
@@ -134,11 +147,58 @@ public struct Video: Codable, FetchableRecord, MutablePersistableRecord {
         self.priority = priority
         self.lastProcessedClip = lastProcessedClip
         self.srtPath = srtPath
+        self.fileModifiedNs = fileModifiedNs
+        self.createdAtNs = createdAtNs
+        self.indexedAtNs = indexedAtNs
+        self.orphanedAtNs = orphanedAtNs
     }
 
     public mutating func didInsert(_ inserted: InsertionSuccess) {
         videoId = inserted.rowID
     }
+
+    /// 编码时间列：纳秒值优先
+    ///
+    /// 有纳秒值时只写 `*_ns` 列，字符串镜像由触发器生成（内存中的旧字符串不会覆盖它）；
+    /// 只有字符串时（旧调用方）写字符串，由触发器反推纳秒值；两者皆空时写 NULL。
+    public func encode(to encoder: Encoder) throws {
+        var container = encoder.container(keyedBy: CodingKeys.self)
+        try container.encode(videoId, forKey: .videoId)
+        try container.encode(folderId, forKey: .folderId)
+        try container.encode(filePath, forKey: .filePath)
+        try container.encode(fileName, forKey: .fileName)
+        try container.encode(duration, forKey: .duration)
+        try container.encode(fileSize, forKey: .fileSize)
+        try container.encode(fileHash, forKey: .fileHash)
+        try container.encode(indexStatus, forKey: .indexStatus)
+        try container.encode(indexError, forKey: .indexError)
+        try container.encode(priority, forKey: .priority)
+        try container.encode(lastProcessedClip, forKey: .lastProcessedClip)
+        try container.encode(srtPath, forKey: .srtPath)
+
+        let timestamps: [(Int64?, String?, CodingKeys, CodingKeys)] = [
+            (fileModifiedNs, fileModified, .fileModifiedNs, .fileModified),
+            (createdAtNs, createdAt, .createdAtNs, .createdAt),
+            (indexedAtNs, indexedAt, .indexedAtNs, .indexedAt),
+            (orphanedAtNs, orphanedAt, .orphanedAtNs, .orphanedAt),
+        ]
+        for (nanoseconds, text, nanosecondsKey, textKey) in timestamps {
+            if let nanoseconds {
+                try container.encode(nanoseconds, forKey: nanosecondsKey)
+            } else if let text {
+                try container.encode(text, forKey: textKey)
+            } else {
+                try container.encodeNil(forKey: nanosecondsKey)
+                try container.encodeNil(forKey: textKey)
+            }
+        }
+    }
+
+    /// 文件修改时间（UI 展示用）
+    public var fileModifiedDate: Date? { fileModifiedNs.map(Timestamp.date) }
+
+    /// 索引完成时间（UI 展示用）
+    public var indexedDate: Date? { indexedAtNs.map(Timestamp.date) }
 }
 
 // MARK: - Clip
@@ -173,6 +233,9 @@ public struct Clip: Codable, FetchableRecord, MutablePersistableRecord {
     public var userTags: String?
     public var rating: Int
     public var colorLabel: String?
+    public var colorSignature: Data?
+    public var visualEmbedding: Data?
+    public var visualModel: String?
     public var createdAt: String
 
     public static let databaseTableName = "clips"
@@ -199,6 +262,9 @@ public struct Clip: Codable, FetchableRecord, MutablePersistableRecord {
         case userTags = "user_tags"
         case rating
         case colorLabel = "color_label"
+        case colorSignature = "color_signature"
+        case visualEmbedding = "visual_embedding"
+        case visualModel = "visual_model"
         case createdAt = "created_at"
     }
 
@@ -224,6 +290,9 @@ public struct Clip: Codable, FetchableRecord, MutablePersistableRecord {
         userTags: String? = nil,
         rating: Int = 0,
         colorLabel: String? = nil,
+        colorSignature: Data? = nil,
+        visualEmbedding: Data? = nil,
+        visualModel: String? = nil,
         createdAt: String? = nil
     ) {
         self.clipId = clipId
@@ -247,6 +316,9 @@ public struct Clip: Codable, FetchableRecord, MutablePersistableRecord {
         self.userTags = userTags
         self.rating = rating
         self.colorLabel = colorLabel
+        self.colorSignature = colorSignature
+        self.visualEmbedding = visualEmbedding
+        self.visualModel = visualModel
         self.createdAt = createdAt ?? Self.sqliteDatetime()
     }
 
@@ -317,7 +389,8 @@ public struct Clip: Codable, FetchableRecord, MutablePersistableRecord {
 
     /// 复用的 UTC 日期格式化器（避免每次调用重新创建）
     ///
-    /// 包内可见，供 PipelineManager 等模块格式化文件修改时间。
+    /// 仅用于仍以 TEXT 存储的时间列（clips.created_at、watched_folders.last_seen_at）；
+    /// videos 的时间比较使用 `Timestamp` 纳秒整数。
     static let utcFormatter: DateFormatter = {
         let formatter = DateFormatter()
         formatter.dateFormat = "yyyy-MM-dd HH:mm:ss"
@@ -419,7 +492,7 @@ extension Video {
         self.indexStatus = status
         self.indexError = error
         if status == "completed" {
-            self.indexedAt = Clip.sqliteDatetime()
+            self.indexedAtNs = Timestamp.now()
         }
         try update(db)
     }
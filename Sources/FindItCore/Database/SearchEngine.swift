@@ -10,7 +10,7 @@ public enum SearchEngine {
     // MARK: - 搜索模式
 
     /// 搜索模式
-    public enum SearchMode: String, CaseIterable {
+    public enum SearchMode: String, CaseIterable, Codable, Sendable {
         /// 纯 FTS5 关键词搜索
         case fts
         /// 纯向量语义搜索
@@ -39,7 +39,7 @@ public enum SearchEngine {
     // MARK: - 搜索结果
 
     /// 搜索结果
-    public struct SearchResult: Sendable {
+    public struct SearchResult: Sendable, Codable {
         /// 全局库 clip_id
         public let clipId: Int64
         /// 来源文件夹路径
@@ -82,6 +82,11 @@ public enum SearchEngine {
         public let similarity: Double?
         /// 融合后的最终得分（0-1，越大越相关）
         public let finalScore: Double?
+        /// 去重时折叠进本条的重复片段（副本 / 近似 take，按排名顺序；nil = 无重复或未去重）
+        public var duplicateClipIds: [Int64]?
+
+        /// 所在重复组的大小（含本条）
+        public var groupSize: Int { 1 + (duplicateClipIds?.count ?? 0) }
     }
 
     // MARK: - FTS5 搜索
@@ -127,7 +132,7 @@ public enum SearchEngine {
             LIMIT ?
             """, arguments: args)
 
-        return rows.map { row in
+        return try rows.map { row in
             SearchResult(
                 clipId: row["clip_id"],
                 sourceFolder: row["source_folder"],
@@ -138,9 +143,9 @@ public enum SearchEngine {
                 startTime: row["start_time"],
                 endTime: row["end_time"],
                 scene: row["scene"],
-                clipDescription: row["description"],
+                clipDescription: try TextCompression.text(row["description"], in: db),
                 tags: row["tags"],
-                transcript: row["transcript"],
+                transcript: try TextCompression.text(row["transcript"], in: db),
                 thumbnailPath: row["thumbnail_path"],
                 userTags: row["user_tags"],
                 rating: row["rating"] ?? 0,
@@ -166,8 +171,11 @@ public enum SearchEngine {
     ///   - queryEmbedding: 查询文本的嵌入向量（nil = 退化为纯 FTS5）
     ///   - embeddingModel: 嵌入模型名称（只匹配此模型的向量）
     ///   - vectorStoreResults: VectorStore 预计算的 (clipId, similarity) 对（nil = 回退逐行扫描）
+    ///   - metadataCache: 片段元数据缓存（VectorStore 结果从缓存补全，nil = 查询 SQLite）
     ///   - mode: 搜索模式
+    ///   - plan: `QueryPlanner` 生成的执行计划（nil = 按模式启发式执行）
     ///   - limit: 最大返回条数
+    ///   - diversify: 融合后折叠副本与近似 take（nil = 不去重）
     /// - Returns: 按融合得分排序的搜索结果
     public static func hybridSearch(
         _ db: Database,
@@ -175,21 +183,64 @@ public enum SearchEngine {
         queryEmbedding: [Float]? = nil,
         embeddingModel: String? = nil,
         vectorStoreResults: [(clipId: Int64, similarity: Float)]? = nil,
+        metadataCache: ClipMetadataCache? = nil,
         mode: SearchMode = .auto,
+        plan: QueryPlan? = nil,
         folderPaths: Set<String>? = nil,
         pathPrefixFilter: String? = nil,
-        limit: Int = 50
+        limit: Int = 50,
+        diversify: ResultDiversifier.Options? = nil
     ) throws -> [SearchResult] {
+        if let diversify {
+            // 多取一些候选，折叠重复后仍能填满 limit
+            let candidates = diversify.candidateLimit(for: limit)
+            var candidatePlan = plan
+            if var widened = plan {
+                widened.resultLimit = candidates
+                if widened.runsFTS { widened.ftsLimit = max(widened.ftsLimit, candidates) }
+                if widened.runsVector { widened.vectorDepth = max(widened.vectorDepth, candidates) }
+                candidatePlan = widened
+            }
+            let ranked = try hybridSearch(
+                db,
+                query: query,
+                queryEmbedding: queryEmbedding,
+                embeddingModel: embeddingModel,
+                vectorStoreResults: vectorStoreResults,
+                metadataCache: metadataCache,
+                mode: mode,
+                plan: candidatePlan,
+                folderPaths: folderPaths,
+                pathPrefixFilter: pathPrefixFilter,
+                limit: candidates
+            )
+            return try ResultDiversifier.diversify(db, results: ranked, options: diversify, limit: limit)
+        }
+
         let trimmed = query.trimmingCharacters(in: .whitespacesAndNewlines)
         guard !trimmed.isEmpty else { return [] }
 
+        if let plan {
+            return try execute(
+                plan,
+                db,
+                query: trimmed,
+                queryEmbedding: queryEmbedding,
+                embeddingModel: embeddingModel,
+                vectorStoreResults: vectorStoreResults,
+                metadataCache: metadataCache,
+                folderPaths: folderPaths,
+                pathPrefixFilter: pathPrefixFilter
+            )
+        }
+
         // 根据模式决定权重
         let weights = resolveWeights(query: trimmed, mode: mode, hasEmbedding: queryEmbedding != nil)
 
         // 纯向量模式
         if mode == .vector || (mode == .auto && weights.ftsWeight == 0) {
             if let storeResults = vectorStoreResults {
-                return try vectorSearchFromStore(db, storeResults: storeResults, folderPaths: folderPaths, pathPrefixFilter: pathPrefixFilter, limit: limit)
+                return try vectorSearchFromStore(db, storeResults: storeResults, metadataCache: metadataCache, folderPaths: folderPaths, pathPrefixFilter: pathPrefixFilter, limit: limit)
             }
             guard let embedding = queryEmbedding, let model = embeddingModel else {
                 return [] // 无向量时返回空
@@ -213,6 +264,7 @@ public enum SearchEngine {
             queryEmbedding: embedding,
             embeddingModel: model,
             vectorStoreResults: vectorStoreResults,
+            metadataCache: metadataCache,
             weights: weights,
             folderPaths: folderPaths,
             pathPrefixFilter: pathPrefixFilter,
@@ -220,6 +272,57 @@ public enum SearchEngine {
         )
     }
 
+    // MARK: - 按计划执行
+
+    /// 按 `QueryPlan` 执行：只运行计划选中的分支，按计划深度取回
+    ///
+    /// 后过滤计划中 `vectorStoreResults` 为全库 top-K，补全时按过滤条件剔除。
+    /// 计划要求向量检索但缺少查询向量时，退化为只执行 FTS。
+    static func execute(
+        _ plan: QueryPlan,
+        _ db: Database,
+        query: String,
+        queryEmbedding: [Float]?,
+        embeddingModel: String?,
+        vectorStoreResults: [(clipId: Int64, similarity: Float)]?,
+        metadataCache: ClipMetadataCache?,
+        folderPaths: Set<String>?,
+        pathPrefixFilter: String?
+    ) throws -> [SearchResult] {
+        let hasVector = vectorStoreResults != nil || (queryEmbedding != nil && embeddingModel != nil)
+        guard !plan.runsVector || hasVector else {
+            return try search(db, query: query, folderPaths: folderPaths, pathPrefixFilter: pathPrefixFilter, limit: plan.resultLimit)
+        }
+
+        let ftsResults = plan.runsFTS
+            ? try search(db, query: query, folderPaths: folderPaths, pathPrefixFilter: pathPrefixFilter, limit: plan.ftsLimit)
+            : []
+
+        var vectorResults: [SearchResult] = []
+        if plan.runsVector {
+            if let storeResults = vectorStoreResults {
+                vectorResults = try vectorSearchFromStore(
+                    db, storeResults: storeResults, metadataCache: metadataCache,
+                    folderPaths: folderPaths, pathPrefixFilter: pathPrefixFilter, limit: plan.vectorDepth
+                )
+            } else if let embedding = queryEmbedding, let model = embeddingModel {
+                vectorResults = try vectorSearch(
+                    db, queryEmbedding: embedding, embeddingModel: model,
+                    folderPaths: folderPaths, pathPrefixFilter: pathPrefixFilter, limit: plan.vectorDepth
+                )
+            }
+        }
+
+        switch (plan.runsFTS, plan.runsVector) {
+        case (true, true):
+            return fuse(ftsResults: ftsResults, vectorResults: vectorResults, weights: plan.weights, limit: plan.resultLimit)
+        case (false, true):
+            return Array(vectorResults.prefix(plan.resultLimit))
+        default:
+            return Array(ftsResults.prefix(plan.resultLimit))
+        }
+    }
+
     // MARK: - 向量搜索
 
     /// 纯向量搜索
@@ -252,15 +355,22 @@ public enum SearchEngine {
             WHERE c.embedding IS NOT NULL AND c.embedding_model = ?\(filterSQL)\(prefixSQL)
             """, arguments: args)
 
-        var results: [(SearchResult, Double)] = []
+        var scored: [(clipId: Int64, similarity: Double, row: Row)] = []
 
         for row in rows {
             guard let embeddingData = row["embedding"] as? Data else { continue }
             let clipEmbedding = EmbeddingUtils.deserializeEmbedding(embeddingData)
             let similarity = Double(EmbeddingUtils.cosineSimilarity(queryEmbedding, clipEmbedding))
+            scored.append((row["clip_id"], similarity, row))
+        }
 
-            let result = SearchResult(
-                clipId: row["clip_id"],
+        // 按相似度降序排列（同分时按 clipId 升序保证稳定性）
+        scored.sort { $0.similarity > $1.similarity || ($0.similarity == $1.similarity && $0.clipId < $1.clipId) }
+
+        // 只为最终返回的行解压文本列
+        return try scored.prefix(limit).map { clipId, similarity, row in
+            SearchResult(
+                clipId: clipId,
                 sourceFolder: row["source_folder"],
                 sourceClipId: row["source_clip_id"],
                 videoId: row["video_id"],
@@ -269,9 +379,9 @@ public enum SearchEngine {
                 startTime: row["start_time"],
                 endTime: row["end_time"],
                 scene: row["scene"],
-                clipDescription: row["description"],
+                clipDescription: try TextCompression.text(row["description"], in: db),
                 tags: row["tags"],
-                transcript: row["transcript"],
+                transcript: try TextCompression.text(row["transcript"], in: db),
                 thumbnailPath: row["thumbnail_path"],
                 userTags: row["user_tags"],
                 rating: row["rating"] ?? 0,
@@ -282,28 +392,55 @@ public enum SearchEngine {
                 similarity: similarity,
                 finalScore: similarity
             )
-            results.append((result, similarity))
         }
-
-        // 按相似度降序排列（同分时按 clipId 升序保证稳定性）
-        results.sort { $0.1 > $1.1 || ($0.1 == $1.1 && $0.0.clipId < $1.0.clipId) }
-        return Array(results.prefix(limit).map { $0.0 })
     }
 
     // MARK: - VectorStore 加速搜索
 
     /// 从 VectorStore 预计算结果构建 SearchResult
     ///
-    /// VectorStore 只返回 (clipId, similarity)，此方法从数据库查询元数据补全。
+    /// VectorStore 只返回 (clipId, similarity)，此方法补全元数据：
+    /// 提供已加载的 `metadataCache` 时直接从列式缓存读取（缓存缺失的行回退 SQLite），
+    /// 否则从数据库查询。
     static func vectorSearchFromStore(
         _ db: Database,
         storeResults: [(clipId: Int64, similarity: Float)],
+        metadataCache: ClipMetadataCache? = nil,
         folderPaths: Set<String>? = nil,
         pathPrefixFilter: String? = nil,
         limit: Int = 50
     ) throws -> [SearchResult] {
         guard !storeResults.isEmpty else { return [] }
 
+        if let cache = metadataCache, cache.isLoaded {
+            return try hydrateFromCache(
+                cache,
+                db: db,
+                storeResults: storeResults,
+                folderPaths: folderPaths,
+                pathPrefixFilter: pathPrefixFilter,
+                limit: limit
+            )
+        }
+        return try hydrateFromDatabase(
+            db,
+            storeResults: storeResults,
+            folderPaths: folderPaths,
+            pathPrefixFilter: pathPrefixFilter,
+            limit: limit
+        )
+    }
+
+    /// 从 SQLite 补全 VectorStore 结果
+    private static func hydrateFromDatabase(
+        _ db: Database,
+        storeResults: [(clipId: Int64, similarity: Float)],
+        folderPaths: Set<String>?,
+        pathPrefixFilter: String?,
+        limit: Int
+    ) throws -> [SearchResult] {
+        guard !storeResults.isEmpty else { return [] }
+
         // SQLite 默认变量上限通常为 999，预留少量参数给其他过滤条件
         let candidateResults = Array(storeResults.prefix(900))
         let similarities = Dictionary(uniqueKeysWithValues: candidateResults.map { ($0.clipId, Double($0.similarity)) })
@@ -329,12 +466,17 @@ public enum SearchEngine {
             WHERE c.clip_id IN (\(placeholders))\(filterSQL)\(prefixSQL)
             """, arguments: args)
 
-        // 构建结果并按相似度排序
-        var results: [SearchResult] = []
-        for row in rows {
-            let clipId: Int64 = row["clip_id"]
-            let sim = similarities[clipId] ?? 0.0
-            results.append(SearchResult(
+        // 按相似度排序，只为最终返回的行解压文本列
+        let ranked = rows
+            .map { row -> (clipId: Int64, similarity: Double, row: Row) in
+                let clipId: Int64 = row["clip_id"]
+                return (clipId, similarities[clipId] ?? 0.0, row)
+            }
+            .sorted { $0.similarity > $1.similarity || ($0.similarity == $1.similarity && $0.clipId < $1.clipId) }
+            .prefix(limit)
+
+        return try ranked.map { clipId, sim, row in
+            SearchResult(
                 clipId: clipId,
                 sourceFolder: row["source_folder"],
                 sourceClipId: row["source_clip_id"],
@@ -344,9 +486,9 @@ public enum SearchEngine {
                 startTime: row["start_time"],
                 endTime: row["end_time"],
                 scene: row["scene"],
-                clipDescription: row["description"],
+                clipDescription: try TextCompression.text(row["description"], in: db),
                 tags: row["tags"],
-                transcript: row["transcript"],
+                transcript: try TextCompression.text(row["transcript"], in: db),
                 thumbnailPath: row["thumbnail_path"],
                 userTags: row["user_tags"],
                 rating: row["rating"] ?? 0,
@@ -356,7 +498,56 @@ public enum SearchEngine {
                 rank: 0.0,
                 similarity: sim,
                 finalScore: sim
-            ))
+            )
+        }
+    }
+
+    /// 从元数据缓存补全 VectorStore 结果（按 store 顺序，过滤语义同 SQL）
+    ///
+    /// 过滤与排序只用缓存字段；文本字段只为截断到 `limit` 后的行按主键读取。
+    /// 缓存中缺失的 clip（如刚同步、增量尚未进入缓存）回退 SQLite 补全。
+    static func hydrateFromCache(
+        _ cache: ClipMetadataCache,
+        db: Database,
+        storeResults: [(clipId: Int64, similarity: Float)],
+        folderPaths: Set<String>?,
+        pathPrefixFilter: String?,
+        limit: Int
+    ) throws -> [SearchResult] {
+        if let folderPaths, folderPaths.isEmpty { return [] }
+        let records = cache.records(for: storeResults.map(\.clipId))
+        let prefix = pathPrefixFilter.map { $0.lowercased() + "/" }
+
+        var matched: [(record: ClipMetadataRecord, similarity: Double)] = []
+        var missing: [(clipId: Int64, similarity: Float)] = []
+        for entry in storeResults {
+            guard let record = records[entry.clipId] else {
+                missing.append(entry)
+                continue
+            }
+            if let folderPaths, !folderPaths.contains(record.sourceFolder) { continue }
+            // LIKE 对 ASCII 不区分大小写
+            if let prefix, !(record.filePath?.lowercased().hasPrefix(prefix) ?? false) { continue }
+            matched.append((record, Double(entry.similarity)))
+        }
+        matched.sort {
+            $0.similarity > $1.similarity ||
+            ($0.similarity == $1.similarity && $0.record.clipId < $1.record.clipId)
+        }
+        let shown = matched.prefix(limit)
+        let texts = try ClipTextFields.fetch(db, clipIds: shown.map(\.record.clipId))
+
+        var results = shown.map { record, sim in
+            SearchResult(record: record, text: texts[record.clipId], rank: 0.0, similarity: sim, finalScore: sim)
+        }
+        if !missing.isEmpty {
+            results += try hydrateFromDatabase(
+                db,
+                storeResults: missing,
+                folderPaths: folderPaths,
+                pathPrefixFilter: pathPrefixFilter,
+                limit: limit
+            )
         }
 
         results.sort {
@@ -375,6 +566,7 @@ public enum SearchEngine {
         queryEmbedding: [Float],
         embeddingModel: String,
         vectorStoreResults: [(clipId: Int64, similarity: Float)]? = nil,
+        metadataCache: ClipMetadataCache? = nil,
         weights: SearchWeights,
         folderPaths: Set<String>? = nil,
         pathPrefixFilter: String? = nil,
@@ -386,7 +578,7 @@ public enum SearchEngine {
         // 2. 向量搜索（VectorStore 加速或逐行扫描回退）
         let vectorResults: [SearchResult]
         if let storeResults = vectorStoreResults {
-            vectorResults = try vectorSearchFromStore(db, storeResults: storeResults, folderPaths: folderPaths, pathPrefixFilter: pathPrefixFilter, limit: limit * 2)
+            vectorResults = try vectorSearchFromStore(db, storeResults: storeResults, metadataCache: metadataCache, folderPaths: folderPaths, pathPrefixFilter: pathPrefixFilter, limit: limit * 2)
         } else {
             vectorResults = try vectorSearch(
                 db, queryEmbedding: queryEmbedding,
@@ -394,6 +586,16 @@ public enum SearchEngine {
             )
         }
 
+        return fuse(ftsResults: ftsResults, vectorResults: vectorResults, weights: weights, limit: limit)
+    }
+
+    /// 两路结果归一化后按权重融合
+    static func fuse(
+        ftsResults: [SearchResult],
+        vectorResults: [SearchResult],
+        weights: SearchWeights,
+        limit: Int
+    ) -> [SearchResult] {
         // 3. 构建 clipId → 数据映射
         var ftsScores: [Int64: Double] = [:]
         var vectorScores: [Int64: Double] = [:]
@@ -534,7 +736,7 @@ public enum SearchEngine {
     /// - `nil`: 不过滤（全局搜索）→ 返回空字符串
     /// - 空集: 过滤为"无文件夹"→ 返回 ` AND 0`（零结果）
     /// - 非空集: 返回 ` AND c.source_folder IN (?, ?, ...)`
-    private static func folderFilterSQL(folderPaths: Set<String>?) -> String {
+    static func folderFilterSQL(folderPaths: Set<String>?) -> String {
         guard let paths = folderPaths else { return "" }
         if paths.isEmpty { return " AND 0" }
         let placeholders = paths.map { _ in "?" }.joined(separator: ", ")
@@ -545,7 +747,7 @@ public enum SearchEngine {
     ///
     /// 逐个 append 避免类型擦除问题（GRDB v6 StatementArguments 陷阱）。
     /// 排序保证确定性查询计划。
-    private static func appendFolderArgs(_ args: inout StatementArguments, folderPaths: Set<String>?) {
+    static func appendFolderArgs(_ args: inout StatementArguments, folderPaths: Set<String>?) {
         guard let paths = folderPaths else { return }
         for path in paths.sorted() {
             args += [path]
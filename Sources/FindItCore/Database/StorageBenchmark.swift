@@ -0,0 +1,213 @@
+import Foundation
+import GRDB
+
+/// 存储配置基准测试
+///
+/// 在临时目录新建全局库，按给定 `StorageProfile` 模拟一次同步 + 搜索负载：
+/// - 写入：分批事务插入带向量 BLOB 的 clip（触发 FTS5 索引），记录每次提交耗时，
+///   最大值即写入停顿
+/// - 读取：按随机 clip_id 读取元数据 + 向量（搜索结果补全的访问模式），
+///   以及若干 FTS 查询
+///
+/// 同一组随机种子下对比不同配置，用于验证 pragma 调整的实际效果。
+public enum StorageBenchmark {
+
+    /// 基准参数
+    public struct Workload: Sendable {
+        /// 总 clip 数
+        public var clips: Int
+        /// 每个写事务的 clip 数
+        public var batchSize: Int
+        /// 随机点查次数
+        public var pointReads: Int
+        /// FTS 查询次数
+        public var ftsQueries: Int
+        /// 向量维度
+        public var dimensions: Int
+
+        public init(clips: Int = 20_000, batchSize: Int = 50, pointReads: Int = 5_000,
+                    ftsQueries: Int = 200, dimensions: Int = 1024) {
+            self.clips = clips
+            self.batchSize = max(1, batchSize)
+            self.pointReads = pointReads
+            self.ftsQueries = ftsQueries
+            self.dimensions = dimensions
+        }
+    }
+
+    /// 单个配置的测量结果
+    public struct Result: Sendable {
+        public let profileName: String
+        /// 写入总耗时（秒）
+        public let writeSeconds: Double
+        /// 提交耗时 p50 / p99 / 最大（毫秒）
+        public let commitP50: Double
+        public let commitP99: Double
+        public let commitMax: Double
+        /// 点查耗时 p50 / p99（微秒）
+        public let readP50: Double
+        public let readP99: Double
+        /// FTS 查询平均耗时（毫秒）
+        public let ftsMean: Double
+        /// 主库 + WAL 文件大小（字节）
+        public let databaseBytes: Int
+        public let walBytes: Int
+    }
+
+    /// 运行一次基准
+    ///
+    /// - Parameters:
+    ///   - profile: 被测存储配置
+    ///   - name: 结果中显示的名称
+    ///   - backgroundCheckpoint: 写入期间是否由后台线程执行 PASSIVE 检查点
+    ///   - workload: 负载参数
+    ///   - directory: 临时库所在目录（结束后删除库文件）
+    public static func run(
+        profile: StorageProfile,
+        name: String,
+        backgroundCheckpoint: Bool,
+        workload: Workload = Workload(),
+        directory: URL = FileManager.default.temporaryDirectory
+    ) throws -> Result {
+        let path = directory.appendingPathComponent("storage-bench-\(UUID().uuidString).sqlite").path
+        defer {
+            for suffix in ["", "-wal", "-shm"] {
+                try? FileManager.default.removeItem(atPath: path + suffix)
+            }
+        }
+
+        let pool = try DatabaseManager.openPool(at: path, profile: profile)
+        try Migrations.globalMigrator().migrate(pool)
+
+        var generator = SplitMix64(seed: 42)
+        let words = ["海滩", "日落", "城市", "夜景", "人物", "访谈", "航拍", "森林", "雨天", "街道",
+                     "beach", "sunset", "city", "drone", "portrait", "forest", "street", "night"]
+
+        // 写入阶段
+        let stop = StopFlag()
+        let checkpointThread: Thread?
+        if backgroundCheckpoint {
+            let thread = Thread {
+                while !stop.isSet {
+                    _ = try? WALCheckpointer.checkpoint(pool)
+                    Thread.sleep(forTimeInterval: 0.05)
+                }
+            }
+            thread.qualityOfService = .utility
+            thread.start()
+            checkpointThread = thread
+        } else {
+            checkpointThread = nil
+        }
+
+        var commits: [Double] = []
+        let writeStart = Date()
+        var inserted = 0
+        while inserted < workload.clips {
+            let count = min(workload.batchSize, workload.clips - inserted)
+            let rows: [(String, String, Data)] = (0..<count).map { _ in
+                let text = (0..<12).map { _ in words[Int(generator.next() % UInt64(words.count))] }
+                let vector = (0..<workload.dimensions).map { _ in Float(generator.nextUnit() - 0.5) }
+                return (text.prefix(4).joined(separator: ","), text.joined(separator: " "),
+                        EmbeddingUtils.serializeEmbedding(vector))
+            }
+            let base = inserted
+            let start = DispatchTime.now()
+            try pool.write { db in
+                let statement = try db.makeStatement(sql: """
+                    INSERT INTO clips (source_folder, source_clip_id, start_time, end_time, tags, description, embedding)
+                    VALUES ('/bench', ?, 0, 5, ?, ?, ?)
+                    """)
+                for (offset, row) in rows.enumerated() {
+                    try statement.execute(arguments: [base + offset, row.0, row.1, row.2])
+                }
+            }
+            commits.append(milliseconds(since: start))
+            inserted += count
+        }
+        let writeSeconds = Date().timeIntervalSince(writeStart)
+        stop.set()
+        while checkpointThread?.isFinished == false { Thread.sleep(forTimeInterval: 0.01) }
+
+        // 读取阶段
+        var reads: [Double] = []
+        reads.reserveCapacity(workload.pointReads)
+        try pool.read { db in
+            let statement = try db.makeStatement(sql: """
+                SELECT clip_id, tags, description, embedding FROM clips WHERE clip_id = ?
+                """)
+            for _ in 0..<workload.pointReads {
+                let id = Int64(generator.next() % UInt64(max(1, workload.clips))) + 1
+                let start = DispatchTime.now()
+                _ = try Row.fetchOne(statement, arguments: [id])
+                reads.append(milliseconds(since: start) * 1000)
+            }
+        }
+
+        var ftsTotal = 0.0
+        try pool.read { db in
+            for i in 0..<workload.ftsQueries {
+                let start = DispatchTime.now()
+                _ = try Int64.fetchAll(db, sql: """
+                    SELECT rowid FROM clips_fts WHERE clips_fts MATCH ? ORDER BY rank LIMIT 50
+                    """, arguments: ["\(words[i % words.count]) \(words[(i * 7 + 3) % words.count])"])
+                ftsTotal += milliseconds(since: start)
+            }
+        }
+
+        let walBytes = fileSize(path + "-wal")
+        return Result(
+            profileName: name,
+            writeSeconds: writeSeconds,
+            commitP50: percentile(commits, 0.5),
+            commitP99: percentile(commits, 0.99),
+            commitMax: commits.max() ?? 0,
+            readP50: percentile(reads, 0.5),
+            readP99: percentile(reads, 0.99),
+            ftsMean: workload.ftsQueries > 0 ? ftsTotal / Double(workload.ftsQueries) : 0,
+            databaseBytes: fileSize(path),
+            walBytes: walBytes
+        )
+    }
+
+    // MARK: - Helpers
+
+    static func percentile(_ values: [Double], _ p: Double) -> Double {
+        guard !values.isEmpty else { return 0 }
+        let sorted = values.sorted()
+        let index = Int((Double(sorted.count - 1) * p).rounded())
+        return sorted[min(sorted.count - 1, max(0, index))]
+    }
+
+    private static func milliseconds(since start: DispatchTime) -> Double {
+        Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1_000_000
+    }
+
+    private static func fileSize(_ path: String) -> Int {
+        ((try? FileManager.default.attributesOfItem(atPath: path))?[.size] as? NSNumber)?.intValue ?? 0
+    }
+
+    /// 确定性随机数（不同配置使用相同数据）
+    struct SplitMix64 {
+        var state: UInt64
+        init(seed: UInt64) { state = seed }
+        mutating func next() -> UInt64 {
+            state &+= 0x9E37_79B9_7F4A_7C15
+            var z = state
+            z = (z ^ (z >> 30)) &* 0xBF58_476D_1CE4_E5B9
+            z = (z ^ (z >> 27)) &* 0x94D0_49BB_1331_11EB
+            return z ^ (z >> 31)
+        }
+        mutating func nextUnit() -> Double {
+            Double(next() >> 11) / Double(1 << 53)
+        }
+    }
+
+    /// 跨线程停止标志
+    final class StopFlag: @unchecked Sendable {
+        private let lock = NSLock()
+        private var value = false
+        var isSet: Bool { lock.lock(); defer { lock.unlock() }; return value }
+        func set() { lock.lock(); value = true; lock.unlock() }
+    }
+}
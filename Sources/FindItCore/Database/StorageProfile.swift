@@ -0,0 +1,195 @@
+import Foundation
+import GRDB
+
+/// SQLite 存储配置（按数据库角色区分的 pragma 组合）
+///
+/// 两类库的负载差异很大：
+/// - 文件夹库：索引时持续小事务写入（每个 clip 多次 UPDATE），读取很少
+/// - 全局库：同步时批量写入，其余时间是搜索的随机读（FTS 段页 + 向量 BLOB）
+///
+/// 默认的 4 KB 页让 4 KB 以上的向量 BLOB 落到溢出页链表，全局库改用 16 KB 页；
+/// `page_size` 只对新建库生效（WAL 模式下已有库需退出 WAL 后 VACUUM 才能改变）。
+///
+/// WAL 自动检查点调高到安全上限，日常检查点由 `WALCheckpointer` 在后台完成，
+/// 避免提交事务的线程被同步检查点卡住（写入停顿）。
+public struct StorageProfile: Sendable, Equatable {
+
+    /// 数据库角色
+    public enum Role: String, Sendable, CaseIterable {
+        /// 文件夹级索引库（写多读少）
+        case folder
+        /// 全局搜索库（读多，批量写）
+        case global
+    }
+
+    /// 新建库的页大小（字节，nil = SQLite 默认 4096）
+    public var pageSize: Int?
+    /// 内存映射上限（字节，0 = 不映射）
+    public var mmapSize: Int
+    /// 每个连接的页缓存（KiB，nil = SQLite 默认 2 MB）
+    public var cacheSizeKiB: Int?
+    /// 自动检查点阈值（WAL 页数，nil = SQLite 默认 1000）
+    public var walAutocheckpoint: Int?
+    /// 检查点后 WAL 文件保留上限（字节，nil = 不截断）
+    public var journalSizeLimit: Int?
+    /// `synchronous` 级别（WAL 下 NORMAL 不会损坏数据库，只可能丢失最后几个事务）
+    public var synchronous: String?
+    /// 临时表 / 排序放内存
+    public var tempStoreMemory: Bool
+
+    public init(
+        pageSize: Int? = nil,
+        mmapSize: Int = 0,
+        cacheSizeKiB: Int? = nil,
+        walAutocheckpoint: Int? = nil,
+        journalSizeLimit: Int? = nil,
+        synchronous: String? = nil,
+        tempStoreMemory: Bool = false
+    ) {
+        self.pageSize = pageSize
+        self.mmapSize = mmapSize
+        self.cacheSizeKiB = cacheSizeKiB
+        self.walAutocheckpoint = walAutocheckpoint
+        self.journalSizeLimit = journalSizeLimit
+        self.synchronous = synchronous
+        self.tempStoreMemory = tempStoreMemory
+    }
+
+    /// GRDB / SQLite 默认值（基准对照组）
+    public static let sqliteDefault = StorageProfile()
+
+    /// 文件夹库：小事务频繁写入
+    ///
+    /// 页缓存由 `FolderDatabasePool` 按全局预算另行分配。
+    /// 不做内存映射：文件夹库常位于外置 / 网络卷，卷被拔出时映射页上的
+    /// 读取会触发 SIGBUS 而不是可处理的 I/O 错误；读取又很少，映射也无收益。
+    public static let folder = StorageProfile(
+        mmapSize: 0,
+        walAutocheckpoint: 4000,
+        journalSizeLimit: 16 * 1024 * 1024,
+        synchronous: "NORMAL",
+        tempStoreMemory: true
+    )
+
+    /// 全局库：随机读为主，大 BLOB
+    public static let global = StorageProfile(
+        pageSize: 16384,
+        mmapSize: 512 * 1024 * 1024,
+        cacheSizeKiB: 32 * 1024,
+        walAutocheckpoint: 8000,
+        journalSizeLimit: 64 * 1024 * 1024,
+        synchronous: "NORMAL",
+        tempStoreMemory: true
+    )
+
+    /// 按角色取默认配置
+    public static func standard(for role: Role) -> StorageProfile {
+        switch role {
+        case .folder: return .folder
+        case .global: return .global
+        }
+    }
+
+    /// 对应的 pragma 语句（按执行顺序）
+    ///
+    /// `page_size` 必须在建任何表之前执行，已有库上执行无副作用。
+    public var pragmas: [String] {
+        var statements: [String] = []
+        if let pageSize { statements.append("PRAGMA page_size = \(pageSize)") }
+        if mmapSize > 0 { statements.append("PRAGMA mmap_size = \(mmapSize)") }
+        if let cacheSizeKiB { statements.append("PRAGMA cache_size = -\(cacheSizeKiB)") }
+        if let walAutocheckpoint { statements.append("PRAGMA wal_autocheckpoint = \(walAutocheckpoint)") }
+        if let journalSizeLimit { statements.append("PRAGMA journal_size_limit = \(journalSizeLimit)") }
+        if let synchronous { statements.append("PRAGMA synchronous = \(synchronous)") }
+        if tempStoreMemory { statements.append("PRAGMA temp_store = MEMORY") }
+        return statements
+    }
+
+    /// 写入 GRDB 配置（每个新连接打开时执行）
+    public func apply(to config: inout Configuration) {
+        let statements = pragmas
+        guard !statements.isEmpty else { return }
+        config.prepareDatabase { db in
+            for sql in statements {
+                try db.execute(sql: sql)
+            }
+        }
+    }
+}
+
+/// 后台 WAL 检查点
+///
+/// 定期执行 `PRAGMA wal_checkpoint(PASSIVE)`：不等待读事务、不阻塞写入，
+/// 把已提交页回写主库，使 WAL 保持较短，读取时少查 WAL 索引。
+/// WAL 超过 `truncateThresholdPages` 时尝试 TRUNCATE（仅在无读写冲突时成功，
+/// 失败不重试、等下一轮），回收磁盘空间。
+public actor WALCheckpointer {
+
+    /// 单次检查点结果
+    public struct Report: Sendable, Equatable {
+        /// 是否因读写冲突未完全完成（SQLITE_BUSY）
+        public let busy: Bool
+        /// 执行前 WAL 页数
+        public let walPages: Int
+        /// 已回写页数
+        public let checkpointedPages: Int
+        /// 是否执行了 TRUNCATE
+        public let truncated: Bool
+    }
+
+    private let db: DatabaseWriter
+    private let truncateThresholdPages: Int
+    private var task: Task<Void, Never>?
+
+    /// - Parameters:
+    ///   - db: 数据库（WAL 模式）
+    ///   - truncateThresholdPages: WAL 超过该页数时尝试 TRUNCATE
+    public init(db: DatabaseWriter, truncateThresholdPages: Int = 4000) {
+        self.db = db
+        self.truncateThresholdPages = truncateThresholdPages
+    }
+
+    /// 启动后台检查点（重复调用无副作用）
+    public func start(interval: TimeInterval = 30) {
+        guard task == nil else { return }
+        task = Task.detached(priority: .utility) { [weak self] in
+            while !Task.isCancelled {
+                try? await Task.sleep(nanoseconds: UInt64(interval * 1_000_000_000))
+                guard let self, !Task.isCancelled else { return }
+                _ = try? await self.runOnce()
+            }
+        }
+    }
+
+    /// 停止后台检查点
+    public func stop() {
+        task?.cancel()
+        task = nil
+    }
+
+    /// 执行一次检查点
+    @discardableResult
+    public func runOnce() throws -> Report {
+        try Self.checkpoint(db, truncateThresholdPages: truncateThresholdPages)
+    }
+
+    /// 同步执行检查点（供非 actor 调用方使用，如文件夹连接池的闲置回收）
+    @discardableResult
+    public static func checkpoint(_ db: DatabaseWriter, truncateThresholdPages: Int = 4000) throws -> Report {
+        try db.writeWithoutTransaction { db in
+            let passive = try Row.fetchOne(db, sql: "PRAGMA wal_checkpoint(PASSIVE)")
+            let busy = (passive?[0] as Int?) ?? 0
+            let walPages = (passive?[1] as Int?) ?? 0
+            var checkpointed = (passive?[2] as Int?) ?? 0
+
+            // 全部回写且 WAL 偏大时截断文件
+            var truncated = false
+            if busy == 0, walPages >= truncateThresholdPages, checkpointed == walPages {
+                let row = try Row.fetchOne(db, sql: "PRAGMA wal_checkpoint(TRUNCATE)")
+                truncated = ((row?[0] as Int?) ?? 1) == 0
+                if truncated { checkpointed = walPages }
+            }
+            return Report(busy: busy != 0, walPages: max(0, walPages), checkpointedPages: max(0, checkpointed), truncated: truncated)
+        }
+    }
+}
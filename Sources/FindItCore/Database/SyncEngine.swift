@@ -17,6 +17,56 @@ public enum SyncEngine {
         public let syncedVideos: Int
         /// 本次同步的片段数
         public let syncedClips: Int
+        /// 新插入全局库的 clip_id（全局库 ID）
+        public let addedClipIds: [Int64]
+        /// 已存在、被本次同步覆盖更新的 clip_id（全局库 ID）
+        public let updatedClipIds: [Int64]
+        /// 已从全局库删除的 clip_id（全局库 ID，如重索引前清理的旧片段）
+        public let removedClipIds: [Int64]
+        /// 本次同步的转录片段数
+        public let syncedSegments: Int
+
+        public init(
+            syncedVideos: Int,
+            syncedClips: Int,
+            addedClipIds: [Int64] = [],
+            updatedClipIds: [Int64] = [],
+            removedClipIds: [Int64] = [],
+            syncedSegments: Int = 0
+        ) {
+            self.syncedVideos = syncedVideos
+            self.syncedClips = syncedClips
+            self.addedClipIds = addedClipIds
+            self.updatedClipIds = updatedClipIds
+            self.removedClipIds = removedClipIds
+            self.syncedSegments = syncedSegments
+        }
+
+        /// 是否有任何 clip 级变更（VectorStore 等派生索引需刷新）
+        public var hasClipChanges: Bool {
+            !addedClipIds.isEmpty || !updatedClipIds.isEmpty || !removedClipIds.isEmpty
+        }
+
+        /// 追加同步之外删除的 clip_id（如管线重索引时清理的旧片段）
+        ///
+        /// 已在本次同步中重新写入的 ID 不计入删除。
+        public func addingRemovedClipIds(_ ids: [Int64]) -> SyncResult {
+            guard !ids.isEmpty else { return self }
+            let live = Set(addedClipIds).union(updatedClipIds)
+            var seen = Set(removedClipIds)
+            var removed = removedClipIds
+            for id in ids where !live.contains(id) && seen.insert(id).inserted {
+                removed.append(id)
+            }
+            return SyncResult(
+                syncedVideos: syncedVideos,
+                syncedClips: syncedClips,
+                addedClipIds: addedClipIds,
+                updatedClipIds: updatedClipIds,
+                removedClipIds: removed,
+                syncedSegments: syncedSegments
+            )
+        }
     }
 
     /// 每批同步的最大记录数（控制内存峰值）
@@ -42,15 +92,20 @@ public enum SyncEngine {
         // 1. 从全局库读取该文件夹的同步进度
         let meta = try globalDB.read { db in
             try Row.fetchOne(db, sql: """
-                SELECT last_synced_video_rowid, last_synced_clip_rowid
+                SELECT last_synced_video_rowid, last_synced_clip_rowid, last_synced_segment_rowid
                 FROM sync_meta WHERE folder_path = ?
                 """, arguments: [folderPath])
         }
         var currentVideoRowId: Int64 = force ? 0 : (meta?["last_synced_video_rowid"] ?? 0)
         var currentClipRowId: Int64 = force ? 0 : (meta?["last_synced_clip_rowid"] ?? 0)
+        var currentSegmentRowId: Int64 = force ? 0 : (meta?["last_synced_segment_rowid"] ?? 0)
 
         var totalSyncedVideos = 0
         var totalSyncedClips = 0
+        var addedClipIds: [Int64] = []
+        var updatedClipIds: [Int64] = []
+        // 本次写入过 video / clip 的 source_video_id（转录片段对账范围）
+        var touchedSourceVideoIds = Set<Int64>()
 
         // 优先使用文件夹库中持久化的卷信息（稳定、可测试）；
         // 缺失时回退到实时文件系统解析。
@@ -157,6 +212,7 @@ public enum SyncEngine {
                         continue
                     }
                     syncedVideosInBatch += 1
+                    if let vid = video.videoId { touchedSourceVideoIds.insert(vid) }
                     if let vid = video.videoId, vid > currentVideoRowId {
                         currentVideoRowId = vid
                     }
@@ -191,12 +247,12 @@ public enum SyncEngine {
                        "start_time", "end_time", "thumbnail_path"]
             + visionCols
             + ["tags", "transcript", "embedding", "embedding_model", "user_tags",
-               "rating", "color_label"]
+               "rating", "color_label", "color_signature", "visual_embedding", "visual_model"]
         let placeholders = allCols.map { _ in "?" }.joined(separator: ", ")
         let conflictSet = (["video_id", "start_time", "end_time", "thumbnail_path"]
             + visionCols
             + ["tags", "transcript", "embedding", "embedding_model", "user_tags",
-               "rating", "color_label"])
+               "rating", "color_label", "color_signature", "visual_embedding", "visual_model"])
             .map { "\($0) = excluded.\($0)" }
             .joined(separator: ",\n                            ")
         let clipSQL = """
@@ -207,6 +263,8 @@ public enum SyncEngine {
                 \(conflictSet)
             """
         let activeFields = VisionField.allActive
+        // 长文本列按库字典压缩写入（见 TextCompression）
+        let textEncoder = try globalDB.read { try TextCompression.Encoder($0) }
 
         while true {
             let batch = try folderDB.read { db in
@@ -217,6 +275,13 @@ public enum SyncEngine {
             var syncedClipsInBatch = 0
 
             try globalDB.write { db in
+                // 本批已存在于全局库的 source_clip_id → clip_id（区分新增/更新，供增量刷新派生索引）
+                let existingIds = try existingGlobalClipIds(
+                    db,
+                    folderPath: folderPath,
+                    sourceClipIds: batch.compactMap(\.clipId)
+                )
+
                 for clip in batch {
                     // 跳过属于被排除视频的 clips
                     if let videoId = clip.videoId, excludedSourceVideoIds.contains(videoId) {
@@ -230,6 +295,8 @@ public enum SyncEngine {
 
                     let tagsForFTS = convertTagsForFTS(clip.tags)
                     let userTagsForFTS = convertTagsForFTS(clip.userTags)
+                    let encodedDescription = textEncoder.encode(clip.clipDescription)
+                    let encodedTranscript = textEncoder.encode(clip.transcript)
 
                     var args: [DatabaseValueConvertible?] = []
                     args.append(folderPath)
@@ -239,15 +306,19 @@ public enum SyncEngine {
                     args.append(clip.endTime)
                     args.append(clip.thumbnailPath)
                     for field in activeFields {
-                        args.append(clip.visionValue(for: field))
+                        let value = clip.visionValue(for: field)
+                        args.append(field == .description ? encodedDescription : value as DatabaseValueConvertible?)
                     }
                     args.append(tagsForFTS)
-                    args.append(clip.transcript)
+                    args.append(encodedTranscript)
                     args.append(clip.embedding)
                     args.append(clip.embeddingModel)
                     args.append(userTagsForFTS)
                     args.append(clip.rating)
                     args.append(clip.colorLabel)
+                    args.append(clip.colorSignature)
+                    args.append(clip.visualEmbedding)
+                    args.append(clip.visualModel)
 
                     do {
                         try db.execute(sql: clipSQL, arguments: StatementArguments(args))
@@ -259,6 +330,22 @@ public enum SyncEngine {
                         continue
                     }
                     syncedClipsInBatch += 1
+                    if let videoId = clip.videoId { touchedSourceVideoIds.insert(videoId) }
+                    let globalClipId: Int64
+                    if let cid = clip.clipId, let globalId = existingIds[cid] {
+                        globalClipId = globalId
+                        updatedClipIds.append(globalId)
+                    } else {
+                        globalClipId = db.lastInsertedRowID
+                        addedClipIds.append(globalClipId)
+                    }
+                    // 压缩值不经触发器索引，补写原文
+                    if encodedDescription is Data || encodedTranscript is Data {
+                        try TextCompression.indexText(
+                            db, clipId: globalClipId,
+                            description: clip.clipDescription, transcript: clip.transcript
+                        )
+                    }
                     if let cid = clip.clipId, cid > currentClipRowId {
                         currentClipRowId = cid
                     }
@@ -269,39 +356,229 @@ public enum SyncEngine {
             if batch.count < batchSize { break }
         }
 
-        // 6. 始终更新同步进度（确保空文件夹也有记录，UI 才能显示）
+        // 6. 分批同步转录片段
+        let syncedSegments = try syncTranscriptSegments(
+            folderPath: folderPath,
+            folderDB: folderDB,
+            globalDB: globalDB,
+            videoIdMap: videoIdMap,
+            excludedSourceVideoIds: excludedSourceVideoIds,
+            touchedSourceVideoIds: touchedSourceVideoIds,
+            cursor: &currentSegmentRowId
+        )
+
+        // 7. 始终更新同步进度（确保空文件夹也有记录，UI 才能显示）
         try globalDB.write { db in
             try db.execute(sql: """
                 INSERT INTO sync_meta (
                     folder_path, volume_uuid, volume_name,
-                    last_synced_video_rowid, last_synced_clip_rowid, last_synced_at
+                    last_synced_video_rowid, last_synced_clip_rowid, last_synced_segment_rowid, last_synced_at
                 )
-                VALUES (?, ?, ?, ?, ?, datetime('now'))
+                VALUES (?, ?, ?, ?, ?, ?, datetime('now'))
                 ON CONFLICT(folder_path) DO UPDATE SET
                     volume_uuid = COALESCE(excluded.volume_uuid, sync_meta.volume_uuid),
                     volume_name = COALESCE(excluded.volume_name, sync_meta.volume_name),
                     last_synced_video_rowid = excluded.last_synced_video_rowid,
                     last_synced_clip_rowid = excluded.last_synced_clip_rowid,
+                    last_synced_segment_rowid = excluded.last_synced_segment_rowid,
                     last_synced_at = excluded.last_synced_at
-                """, arguments: [folderPath, volumeUUID, volumeName, currentVideoRowId, currentClipRowId])
+                """, arguments: [
+                    folderPath, volumeUUID, volumeName,
+                    currentVideoRowId, currentClipRowId, currentSegmentRowId,
+                ])
         }
 
-        return SyncResult(syncedVideos: totalSyncedVideos, syncedClips: totalSyncedClips)
+        return SyncResult(
+            syncedVideos: totalSyncedVideos,
+            syncedClips: totalSyncedClips,
+            addedClipIds: addedClipIds,
+            updatedClipIds: updatedClipIds,
+            syncedSegments: syncedSegments
+        )
     }
 
     /// 删除全局库中指定文件夹的所有同步数据
     ///
     /// 用于文件夹被移除时清理全局库。
-    public static func removeFolderData(folderPath: String, from globalDB: DatabaseWriter) throws {
+    ///
+    /// - Returns: 删除的全局 clip_id（供 VectorStore 等派生索引增量移除）
+    @discardableResult
+    public static func removeFolderData(folderPath: String, from globalDB: DatabaseWriter) throws -> [Int64] {
         try globalDB.write { db in
+            let removed = try Int64.fetchAll(db, sql: "SELECT clip_id FROM clips WHERE source_folder = ?", arguments: [folderPath])
             try db.execute(sql: "DELETE FROM clips WHERE source_folder = ?", arguments: [folderPath])
+            try db.execute(sql: "DELETE FROM transcript_segments WHERE source_folder = ?", arguments: [folderPath])
             try db.execute(sql: "DELETE FROM videos WHERE source_folder = ?", arguments: [folderPath])
             try db.execute(sql: "DELETE FROM sync_meta WHERE folder_path = ?", arguments: [folderPath])
+            return removed
         }
     }
 
     // MARK: - Private
 
+    /// 增量同步转录片段
+    ///
+    /// 文件夹库重新转录时整体替换某个视频的片段（新 segment_id 总是更大），
+    /// 因此对本批涉及的每个视频，全局库中 source_segment_id 小于该视频
+    /// 当前首个片段 ID 的记录都是旧转录，先删除再写入。
+    ///
+    /// 重新转录得到零个片段时没有新行进入批次，因此另按 `touchedSourceVideoIds`
+    /// 对账：本次同步过 video 或 clip、但文件夹库中已无片段的视频，删除其全局片段。
+    ///
+    /// - Returns: 实际写入的片段数
+    static func syncTranscriptSegments(
+        folderPath: String,
+        folderDB: DatabaseReader,
+        globalDB: DatabaseWriter,
+        videoIdMap: [Int64: Int64],
+        excludedSourceVideoIds: Set<Int64>,
+        touchedSourceVideoIds: Set<Int64> = [],
+        cursor: inout Int64
+    ) throws -> Int {
+        // 旧版本文件夹库（只读打开未迁移）没有该表
+        guard try folderDB.read({ try $0.tableExists("transcript_segments") }) else { return 0 }
+
+        var synced = 0
+        while true {
+            let lastRowId = cursor
+            let (batch, blockStarts) = try folderDB.read { db -> ([Row], [Int64: Int64]) in
+                let rows = try Row.fetchAll(db, sql: """
+                    SELECT segment_id, video_id, start_time, end_time, speaker, text
+                    FROM transcript_segments
+                    WHERE segment_id > ?
+                    ORDER BY segment_id
+                    LIMIT ?
+                    """, arguments: [lastRowId, batchSize])
+                let videoIds = Array(Set(rows.map { $0["video_id"] as Int64 }))
+                var starts: [Int64: Int64] = [:]
+                if !videoIds.isEmpty {
+                    let placeholders = videoIds.map { _ in "?" }.joined(separator: ", ")
+                    var args = StatementArguments()
+                    for id in videoIds { args += [id] }
+                    for row in try Row.fetchAll(db, sql: """
+                        SELECT video_id, MIN(segment_id) AS first_id FROM transcript_segments
+                        WHERE video_id IN (\(placeholders)) GROUP BY video_id
+                        """, arguments: args) {
+                        starts[row["video_id"]] = row["first_id"]
+                    }
+                }
+                return (rows, starts)
+            }
+            guard !batch.isEmpty else { break }
+
+            try globalDB.write { db in
+                for (sourceVideoId, firstId) in blockStarts {
+                    try db.execute(sql: """
+                        DELETE FROM transcript_segments
+                        WHERE source_folder = ? AND source_video_id = ? AND source_segment_id < ?
+                        """, arguments: [folderPath, sourceVideoId, firstId])
+                }
+
+                for row in batch {
+                    let segmentId: Int64 = row["segment_id"]
+                    let sourceVideoId: Int64 = row["video_id"]
+                    cursor = max(cursor, segmentId)
+                    guard !excludedSourceVideoIds.contains(sourceVideoId),
+                          let globalVideoId = videoIdMap[sourceVideoId] else { continue }
+                    try db.execute(sql: """
+                        INSERT INTO transcript_segments
+                            (source_folder, source_segment_id, source_video_id, video_id,
+                             start_time, end_time, speaker, text)
+                        VALUES (?, ?, ?, ?, ?, ?, ?, ?)
+                        ON CONFLICT(source_folder, source_segment_id) DO UPDATE SET
+                            video_id = excluded.video_id,
+                            start_time = excluded.start_time,
+                            end_time = excluded.end_time,
+                            speaker = excluded.speaker,
+                            text = excluded.text
+                        """, arguments: [
+                            folderPath, segmentId, sourceVideoId, globalVideoId,
+                            row["start_time"] as Double, row["end_time"] as Double,
+                            row["speaker"] as String?, row["text"] as String,
+                        ])
+                    synced += 1
+                }
+            }
+
+            if batch.count < batchSize { break }
+        }
+
+        try removeSegmentsOfUntranscribedVideos(
+            folderPath: folderPath,
+            folderDB: folderDB,
+            globalDB: globalDB,
+            sourceVideoIds: touchedSourceVideoIds
+        )
+        return synced
+    }
+
+    /// 删除文件夹库中已无转录片段的视频在全局库中的片段
+    private static func removeSegmentsOfUntranscribedVideos(
+        folderPath: String,
+        folderDB: DatabaseReader,
+        globalDB: DatabaseWriter,
+        sourceVideoIds: Set<Int64>
+    ) throws {
+        guard !sourceVideoIds.isEmpty else { return }
+        let ids = Array(sourceVideoIds)
+        let chunks = stride(from: 0, to: ids.count, by: batchSize).map {
+            Array(ids[$0..<min($0 + batchSize, ids.count)])
+        }
+
+        let untranscribed = try folderDB.read { db -> [Int64] in
+            var missing: [Int64] = []
+            for chunk in chunks {
+                let placeholders = chunk.map { _ in "?" }.joined(separator: ", ")
+                let present = try Set(Int64.fetchAll(db, sql: """
+                    SELECT DISTINCT video_id FROM transcript_segments
+                    WHERE video_id IN (\(placeholders))
+                    """, arguments: StatementArguments(chunk)))
+                missing += chunk.filter { !present.contains($0) }
+            }
+            return missing
+        }
+        guard !untranscribed.isEmpty else { return }
+
+        try globalDB.write { db in
+            for start in stride(from: 0, to: untranscribed.count, by: batchSize) {
+                let chunk = untranscribed[start..<min(start + batchSize, untranscribed.count)]
+                let placeholders = chunk.map { _ in "?" }.joined(separator: ", ")
+                var args: StatementArguments = [folderPath]
+                args += StatementArguments(chunk)
+                try db.execute(sql: """
+                    DELETE FROM transcript_segments
+                    WHERE source_folder = ? AND source_video_id IN (\(placeholders))
+                    """, arguments: args)
+            }
+        }
+    }
+
+    /// 查询一批 source_clip_id 在全局库中已有的 clip_id
+    ///
+    /// 命中 `(source_folder, source_clip_id)` 唯一索引；按 SQLite 变量上限分块。
+    static func existingGlobalClipIds(
+        _ db: Database,
+        folderPath: String,
+        sourceClipIds: [Int64]
+    ) throws -> [Int64: Int64] {
+        var map: [Int64: Int64] = [:]
+        for start in stride(from: 0, to: sourceClipIds.count, by: 900) {
+            let chunk = sourceClipIds[start..<min(start + 900, sourceClipIds.count)]
+            let placeholders = chunk.map { _ in "?" }.joined(separator: ", ")
+            var args = StatementArguments()
+            args += [folderPath]
+            for id in chunk { args += [id] }
+            let rows = try Row.fetchAll(db, sql: """
+                SELECT source_clip_id, clip_id FROM clips
+                WHERE source_folder = ? AND source_clip_id IN (\(placeholders))
+                """, arguments: args)
+            for row in rows {
+                map[row["source_clip_id"]] = row["clip_id"]
+            }
+        }
+        return map
+    }
+
     /// 将 tags 从 JSON 数组格式转为空格分隔文本
     ///
     /// 输入: `["海滩","户外","全景"]`
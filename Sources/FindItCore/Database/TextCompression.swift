@@ -0,0 +1,433 @@
+import Foundation
+import GRDB
+import CxxHash
+import CZlib
+
+/// 文本压缩相关错误
+public enum TextCompressionError: LocalizedError {
+    /// 压缩值引用的字典不存在
+    case unknownDictionary(Int64)
+    /// 压缩数据损坏
+    case corrupt
+
+    public var errorDescription: String? {
+        switch self {
+        case .unknownDictionary(let id):
+            return "文本压缩字典不存在: \(id)"
+        case .corrupt:
+            return "压缩文本数据损坏"
+        }
+    }
+}
+
+/// 全局库文本列压缩
+///
+/// 转录密集的素材库中 `clips.description` / `clips.transcript` 占全局库体积的大头，
+/// 搜索时这些页与 FTS 段页、向量页争抢页缓存。长文本以 BLOB 形式压缩存储：
+///
+/// - 编码：raw deflate + 预置字典（按库训练，见 `TextDictionaryTrainer`），
+///   短文本借助字典中的高频片段也能压缩；压缩后不更短的值保持 TEXT 原样
+/// - 格式：`"FZ"` + 版本 + 字典 ID（8 字节，0 = 无字典）+ 原文字节数（4 字节）+ 负载
+/// - 字典按内容哈希标识、只增不删，旧值始终可解
+/// - `clips_fts` 是无内容表（`content=''`），只存索引不存原文，schema 不引用任何应用函数：
+///   触发器只索引两列都是 TEXT 的行，写入压缩值的一方（同步）随后用 `indexText` 整行补写；
+///   同一文本由明文改写为压缩存储时 FTS 不变
+/// - 补全结果在 Swift 侧解码（`text(_:in:)`），只解压最终返回的行
+///
+/// 文件夹库保持明文：它是便携的源数据，旧版本可能直接读取。
+public enum TextCompression {
+
+    /// 压缩存储的全局库 clips 列
+    public static let columns = ["description", "transcript"]
+
+    /// v14 迁移使用过的解压 SQL 函数名（v16 起 schema 不再引用）
+    static let legacyFunctionName = "findit_text"
+
+    /// 短于此字节数的文本不尝试压缩
+    static let minimumBytes = 64
+
+    /// 压缩值头部
+    static let magic: [UInt8] = [0x46, 0x5A]
+    static let formatVersion: UInt8 = 1
+    static let headerSize = 15
+
+    /// 压缩字典
+    public struct CompressionDictionary: Sendable, Equatable {
+        /// 内容哈希（XXH3，非 0）
+        public let id: Int64
+        public let data: Data
+
+        public init(data: Data) {
+            let hash = data.withUnsafeBytes { Int64(bitPattern: XXH3_64bits($0.baseAddress, $0.count)) }
+            self.id = hash == 0 ? 1 : hash
+            self.data = data
+        }
+    }
+
+    // MARK: - 编码
+
+    /// 写入端编码器（同步 / 整理时按当前字典压缩）
+    public struct Encoder: Sendable {
+        public let dictionary: CompressionDictionary?
+
+        public init(dictionary: CompressionDictionary?) {
+            self.dictionary = dictionary
+        }
+
+        /// 使用库中当前字典
+        public init(_ db: Database) throws {
+            self.dictionary = try TextCompression.activeDictionary(db)
+        }
+
+        /// 压缩文本（nil 保持 nil；过短或压缩后不更短时原样返回文本）
+        public func encode(_ text: String?) -> DatabaseValueConvertible? {
+            guard let text else { return nil }
+            let bytes = Array(text.utf8)
+            guard bytes.count >= TextCompression.minimumBytes, bytes.count <= Int(UInt32.max),
+                  let payload = bytes.withUnsafeBytes({ TextCompression.compress($0, dictionary: dictionary?.data) }),
+                  payload.count + TextCompression.headerSize < bytes.count else {
+                return text
+            }
+
+            var blob = Data(capacity: TextCompression.headerSize + payload.count)
+            blob.append(contentsOf: TextCompression.magic)
+            blob.append(TextCompression.formatVersion)
+            withUnsafeBytes(of: (dictionary?.id ?? 0).littleEndian) { blob.append(contentsOf: $0) }
+            withUnsafeBytes(of: UInt32(bytes.count).littleEndian) { blob.append(contentsOf: $0) }
+            blob.append(contentsOf: payload)
+            return blob
+        }
+    }
+
+    // MARK: - 解码
+
+    /// 读取可能被压缩的文本列（TEXT 原样返回，压缩 BLOB 解压）
+    public static func text(_ value: DatabaseValue, in db: Database) throws -> String? {
+        try decode(value) { try dictionaryData(db, id: $0) }
+    }
+
+    /// 解码核心（字典由调用方按 ID 提供）
+    static func decode(_ value: DatabaseValue, dictionary lookup: (Int64) throws -> Data?) throws -> String? {
+        switch value.storage {
+        case .null:
+            return nil
+        case .string(let text):
+            return text
+        case .int64(let number):
+            return String(number)
+        case .double(let number):
+            return String(number)
+        case .blob(let data):
+            guard let header = Header(data) else {
+                // 非本格式的 BLOB（手工写入）按 UTF-8 读取
+                return String(data: data, encoding: .utf8)
+            }
+            var dictionary: Data?
+            if header.dictionaryId != 0 {
+                guard let found = try lookup(header.dictionaryId) else {
+                    throw TextCompressionError.unknownDictionary(header.dictionaryId)
+                }
+                dictionary = found
+            }
+            let decoded = data.withUnsafeBytes { raw in
+                decompress(
+                    UnsafeRawBufferPointer(rebasing: raw[headerSize...]),
+                    rawLength: header.rawLength,
+                    dictionary: dictionary
+                )
+            }
+            guard let decoded else { throw TextCompressionError.corrupt }
+            return String(decoding: decoded, as: UTF8.self)
+        }
+    }
+
+    /// 压缩值头部
+    struct Header {
+        let dictionaryId: Int64
+        let rawLength: Int
+
+        init?(_ data: Data) {
+            guard data.count > TextCompression.headerSize else { return nil }
+            let parsed: (Bool, Int64, UInt32) = data.withUnsafeBytes { raw in
+                let matches = raw[0] == TextCompression.magic[0] && raw[1] == TextCompression.magic[1]
+                    && raw[2] == TextCompression.formatVersion
+                let id = raw.loadUnaligned(fromByteOffset: 3, as: Int64.self)
+                let length = raw.loadUnaligned(fromByteOffset: 11, as: UInt32.self)
+                return (matches, Int64(littleEndian: id), UInt32(littleEndian: length))
+            }
+            guard parsed.0, parsed.2 > 0 else { return nil }
+            dictionaryId = parsed.1
+            rawLength = Int(parsed.2)
+        }
+    }
+
+    // MARK: - 字典
+
+    /// 当前字典（最近训练的一个；未训练返回 nil）
+    public static func activeDictionary(_ db: Database) throws -> CompressionDictionary? {
+        guard let data = try Data.fetchOne(db, sql: """
+            SELECT dictionary FROM text_dictionaries
+            ORDER BY created_at_ns DESC, dict_id
+            LIMIT 1
+            """) else {
+            return nil
+        }
+        return CompressionDictionary(data: data)
+    }
+
+    /// 保存字典并设为当前字典（内容相同的字典只保存一份）
+    public static func store(_ db: Database, dictionary: CompressionDictionary, sampleCount: Int) throws {
+        try db.execute(sql: """
+            INSERT INTO text_dictionaries (dict_id, dictionary, sample_count, created_at_ns)
+            VALUES (?, ?, ?, ?)
+            ON CONFLICT(dict_id) DO UPDATE SET created_at_ns = excluded.created_at_ns
+            """, arguments: [dictionary.id, dictionary.data, sampleCount, Timestamp.nanoseconds(Date())])
+        registry.insert(dictionary.data, for: dictionary.id)
+    }
+
+    /// 按 ID 取字典（进程内缓存，未命中时读库）
+    static func dictionaryData(_ db: Database, id: Int64) throws -> Data? {
+        if let cached = registry.data(for: id) { return cached }
+        guard let data = try Data.fetchOne(db, sql: """
+            SELECT dictionary FROM text_dictionaries WHERE dict_id = ?
+            """, arguments: [id]) else {
+            return nil
+        }
+        registry.insert(data, for: id)
+        return data
+    }
+
+    /// 进程内字典缓存（ID 为内容哈希，跨库共享安全）
+    private static let registry = DictionaryRegistry()
+
+    private final class DictionaryRegistry: @unchecked Sendable {
+        private let lock = NSLock()
+        private var dictionaries: [Int64: Data] = [:]
+
+        func data(for id: Int64) -> Data? {
+            lock.lock()
+            defer { lock.unlock() }
+            return dictionaries[id]
+        }
+
+        func insert(_ data: Data, for id: Int64) {
+            lock.lock()
+            dictionaries[id] = data
+            lock.unlock()
+        }
+    }
+
+    // MARK: - FTS
+
+    /// 为含压缩值的 clip 重写 `clips_fts` 条目
+    ///
+    /// 触发器跳过 description / transcript 含 BLOB 的行，写入后在同一事务内调用。
+    /// 传入的是解压后的完整原文，nil 表示该列为空；tags / user_tags 取 clips 当前值。
+    /// 无内容表不支持改部分列，整行删除后重插。
+    public static func indexText(_ db: Database, clipId: Int64, description: String?, transcript: String?) throws {
+        try db.execute(sql: "DELETE FROM clips_fts WHERE rowid = ?", arguments: [clipId])
+        try db.execute(sql: """
+            INSERT INTO clips_fts(rowid, tags, description, transcript, user_tags)
+            SELECT clip_id, tags, ?, ?, user_tags FROM clips WHERE clip_id = ?
+            """, arguments: [description, transcript, clipId])
+    }
+
+    /// 按 clips 当前值（解压后）重写 `clips_fts` 条目
+    ///
+    /// 供手头没有原文的写入方使用，例如只改了 tags 或一列文本、另一列仍是压缩值。
+    public static func reindex(_ db: Database, clipId: Int64) throws {
+        guard let row = try Row.fetchOne(db, sql: """
+            SELECT description, transcript FROM clips WHERE clip_id = ?
+            """, arguments: [clipId]) else {
+            return
+        }
+        try indexText(
+            db, clipId: clipId,
+            description: text(row["description"], in: db),
+            transcript: text(row["transcript"], in: db)
+        )
+    }
+
+    /// 仅供 v14 迁移：临时注册 `findit_text(value)` 执行 `body`，结束后注销并恢复 `trusted_schema`
+    ///
+    /// v14 的 FTS 内容视图与触发器引用该函数，v16 已移除；
+    /// 新建的库在两次迁移之间不会写入 clips，函数不需要留在连接上。
+    static func withLegacyFunction<T>(_ db: Database, _ body: () throws -> T) throws -> T {
+        let function = DatabaseFunction(legacyFunctionName, argumentCount: 1, pure: true) { [unowned db] values in
+            try decode(values[0]) { try dictionaryData(db, id: $0) }
+        }
+        let trusted = try Bool.fetchOne(db, sql: "PRAGMA trusted_schema") ?? true
+        db.add(function: function)
+        try db.execute(sql: "PRAGMA trusted_schema = ON")
+        defer {
+            db.remove(function: function)
+            try? db.execute(sql: "PRAGMA trusted_schema = \(trusted ? "ON" : "OFF")")
+        }
+        return try body()
+    }
+
+    // MARK: - 整理
+
+    /// 整理结果
+    public struct CompactionReport: Sendable, Equatable {
+        /// 使用的字典（nil = 样本不足，无字典压缩）
+        public var dictionaryId: Int64?
+        /// 本次是否训练了新字典
+        public var trained: Bool
+        /// 改写为压缩存储的行数
+        public var rewrittenRows: Int
+        /// 改写列的原文字节数
+        public var bytesBefore: Int
+        /// 改写列的存储字节数
+        public var bytesAfter: Int
+    }
+
+    /// 训练字典（尚无字典或 `retrain`）并把仍为明文的长文本改写为压缩存储
+    ///
+    /// 每批在一个写事务内读取并改写，不会覆盖期间同步写入的新值。
+    /// 改写为压缩值不触发 FTS 触发器，内容不变的改写不会重建 FTS 条目。
+    /// 重新训练后旧值保留原字典，不重新压缩。
+    @discardableResult
+    public static func compact(
+        _ writer: DatabaseWriter,
+        retrain: Bool = false,
+        trainer: TextDictionaryTrainer = TextDictionaryTrainer(),
+        batchSize: Int = 500
+    ) throws -> CompactionReport {
+        var report = CompactionReport(dictionaryId: nil, trained: false, rewrittenRows: 0, bytesBefore: 0, bytesAfter: 0)
+
+        var dictionary = try writer.read { try activeDictionary($0) }
+        if dictionary == nil || retrain {
+            let samples = try writer.read { try sampleTexts($0, limit: trainer.sampleLimit) }
+            if let data = trainer.train(samples) {
+                let trained = CompressionDictionary(data: data)
+                try writer.write { try store($0, dictionary: trained, sampleCount: samples.count) }
+                dictionary = trained
+                report.trained = true
+            }
+        }
+        report.dictionaryId = dictionary?.id
+        let encoder = Encoder(dictionary: dictionary)
+
+        let plainLong = columns.map {
+            "(typeof(\($0)) = 'text' AND length(CAST(\($0) AS BLOB)) >= \(minimumBytes))"
+        }.joined(separator: " OR ")
+        var lastClipId: Int64 = .min
+        while true {
+            let scanned: Int = try writer.write { db in
+                let rows = try Row.fetchAll(db, sql: """
+                    SELECT clip_id, \(columns.joined(separator: ", ")) FROM clips
+                    WHERE clip_id > ? AND (\(plainLong))
+                    ORDER BY clip_id
+                    LIMIT ?
+                    """, arguments: [lastClipId, batchSize])
+                for row in rows {
+                    lastClipId = row["clip_id"]
+                    var values: [DatabaseValueConvertible?] = []
+                    var changed = false
+                    for column in columns {
+                        let original: DatabaseValue = row[column]
+                        guard case .string(let text) = original.storage else {
+                            values.append(original)
+                            continue
+                        }
+                        let encoded = encoder.encode(text)
+                        if let blob = encoded as? Data {
+                            changed = true
+                            report.bytesBefore += text.utf8.count
+                            report.bytesAfter += blob.count
+                        }
+                        values.append(encoded)
+                    }
+                    guard changed else { continue }
+                    let assignments = columns.map { "\($0) = ?" }.joined(separator: ", ")
+                    try db.execute(
+                        sql: "UPDATE clips SET \(assignments) WHERE clip_id = ?",
+                        arguments: StatementArguments(values + [lastClipId])
+                    )
+                    report.rewrittenRows += 1
+                }
+                return rows.count
+            }
+            if scanned < batchSize { break }
+        }
+        return report
+    }
+
+    /// 随机抽取训练样本（已压缩的值先解压）
+    static func sampleTexts(_ db: Database, limit: Int) throws -> [String] {
+        let rows = try Row.fetchAll(db, sql: """
+            SELECT \(columns.joined(separator: ", ")) FROM clips
+            WHERE \(columns.map { "\($0) IS NOT NULL" }.joined(separator: " OR "))
+            ORDER BY random()
+            LIMIT ?
+            """, arguments: [limit])
+        var samples: [String] = []
+        for row in rows {
+            for column in columns {
+                if let text = try text(row[column], in: db), !text.isEmpty {
+                    samples.append(text)
+                }
+            }
+        }
+        return samples
+    }
+
+    // MARK: - deflate
+
+    /// raw deflate（可选预置字典）
+    static func compress(_ input: UnsafeRawBufferPointer, dictionary: Data?) -> [UInt8]? {
+        guard let base = input.baseAddress, input.count > 0 else { return nil }
+        var stream = z_stream()
+        guard deflateInit2_(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY,
+                            zlibVersion(), Int32(MemoryLayout<z_stream>.size)) == Z_OK else {
+            return nil
+        }
+        defer { deflateEnd(&stream) }
+        if let dictionary, !dictionary.isEmpty {
+            let status = dictionary.withUnsafeBytes { raw in
+                deflateSetDictionary(&stream, raw.bindMemory(to: Bytef.self).baseAddress, uInt(raw.count))
+            }
+            guard status == Z_OK else { return nil }
+        }
+
+        var output = [UInt8](repeating: 0, count: Int(deflateBound(&stream, uLong(input.count))))
+        let status: Int32 = output.withUnsafeMutableBufferPointer { out in
+            stream.next_in = UnsafeMutablePointer(mutating: base.assumingMemoryBound(to: Bytef.self))
+            stream.avail_in = uInt(input.count)
+            stream.next_out = out.baseAddress
+            stream.avail_out = uInt(out.count)
+            return deflate(&stream, Z_FINISH)
+        }
+        guard status == Z_STREAM_END else { return nil }
+        output.removeSubrange(Int(stream.total_out)...)
+        return output
+    }
+
+    /// raw inflate（字典须与压缩时一致）
+    static func decompress(_ payload: UnsafeRawBufferPointer, rawLength: Int, dictionary: Data?) -> [UInt8]? {
+        guard let base = payload.baseAddress, payload.count > 0, rawLength > 0 else { return nil }
+        var stream = z_stream()
+        guard inflateInit2_(&stream, -MAX_WBITS, zlibVersion(), Int32(MemoryLayout<z_stream>.size)) == Z_OK else {
+            return nil
+        }
+        defer { inflateEnd(&stream) }
+        if let dictionary, !dictionary.isEmpty {
+            let status = dictionary.withUnsafeBytes { raw in
+                inflateSetDictionary(&stream, raw.bindMemory(to: Bytef.self).baseAddress, uInt(raw.count))
+            }
+            guard status == Z_OK else { return nil }
+        }
+
+        var output = [UInt8](repeating: 0, count: rawLength)
+        let status: Int32 = output.withUnsafeMutableBufferPointer { out in
+            stream.next_in = UnsafeMutablePointer(mutating: base.assumingMemoryBound(to: Bytef.self))
+            stream.avail_in = uInt(payload.count)
+            stream.next_out = out.baseAddress
+            stream.avail_out = uInt(out.count)
+            return inflate(&stream, Z_FINISH)
+        }
+        guard status == Z_STREAM_END, Int(stream.total_out) == rawLength else { return nil }
+        return output
+    }
+}
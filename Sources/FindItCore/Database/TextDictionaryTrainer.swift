@@ -0,0 +1,122 @@
+import Foundation
+
+/// 文本压缩字典训练
+///
+/// 简化版 COVER：统计样本中 8 字节片段（k-mer）的文档频率，
+/// 把样本切成固定长度的候选段，按段内高频 k-mer 的频率之和打分，
+/// 贪心选取得分最高且与已选内容重复不多的段，直到填满容量。
+///
+/// deflate 的预置字典只能在 32 KB 窗口内回溯，且距离越近编码越短，
+/// 因此得分最高的段放在字典末尾。
+public struct TextDictionaryTrainer: Sendable {
+
+    /// 字典容量（字节，不超过 deflate 窗口 32 KB）
+    public var capacity: Int
+    /// 候选段长度（字节）
+    public var segmentSize: Int
+    /// 训练抽样行数
+    public var sampleLimit: Int
+    /// 样本数少于此值不训练
+    public var minimumSamples: Int
+    /// 单个样本最多参与训练的字节数（长转录只取开头）
+    public var maxBytesPerSample: Int
+
+    public init(
+        capacity: Int = 16 * 1024,
+        segmentSize: Int = 64,
+        sampleLimit: Int = 1000,
+        minimumSamples: Int = 32,
+        maxBytesPerSample: Int = 2048
+    ) {
+        self.capacity = min(max(capacity, 256), 32 * 1024)
+        self.segmentSize = max(segmentSize, Self.kmerSize * 2)
+        self.sampleLimit = max(1, sampleLimit)
+        self.minimumSamples = max(1, minimumSamples)
+        self.maxBytesPerSample = max(segmentSize, maxBytesPerSample)
+    }
+
+    /// k-mer 长度（字节，恰好装入一个 UInt64）
+    static let kmerSize = 8
+
+    /// 训练字典
+    ///
+    /// - Returns: 字典内容；样本不足或没有重复片段时返回 nil
+    public func train(_ samples: [String]) -> Data? {
+        let documents = samples.map { Array($0.utf8.prefix(maxBytesPerSample)) }
+            .filter { $0.count >= Self.kmerSize }
+        guard documents.count >= minimumSamples else { return nil }
+
+        // 1. k-mer 文档频率（同一样本内重复只计一次）
+        var frequency: [UInt64: Int32] = [:]
+        for document in documents {
+            var seen = Set<UInt64>()
+            Self.forEachKmer(document[...]) { kmer in
+                if seen.insert(kmer).inserted { frequency[kmer, default: 0] += 1 }
+            }
+        }
+
+        // 2. 候选段（半段步长重叠切分）打分：只计至少出现在两个样本中的 k-mer
+        var candidates: [(score: Int, document: Int, start: Int)] = []
+        let step = max(1, segmentSize / 2)
+        for (index, document) in documents.enumerated() {
+            var start = 0
+            while start + Self.kmerSize <= document.count {
+                let end = min(start + segmentSize, document.count)
+                let value = score(document[start..<end], frequency: frequency, covered: [])
+                if value > 0 { candidates.append((value, index, start)) }
+                if end == document.count { break }
+                start += step
+            }
+        }
+        candidates.sort { $0.score > $1.score || ($0.score == $1.score && ($0.document, $0.start) < ($1.document, $1.start)) }
+
+        // 3. 贪心选取：已选段覆盖的 k-mer 不再计分，重复过半的段跳过
+        var covered = Set<UInt64>()
+        var selected: [ArraySlice<UInt8>] = []
+        var total = 0
+        for candidate in candidates where total < capacity {
+            let document = documents[candidate.document]
+            let end = min(candidate.start + segmentSize, document.count)
+            let segment = document[candidate.start..<end]
+            let remaining = score(segment, frequency: frequency, covered: covered)
+            guard remaining * 2 >= candidate.score else { continue }
+
+            let take = segment.prefix(capacity - total)
+            selected.append(take)
+            total += take.count
+            Self.forEachKmer(take) { covered.insert($0) }
+        }
+        guard !selected.isEmpty else { return nil }
+
+        // 4. 高分段放在末尾（距离待压缩数据最近）
+        var dictionary = Data(capacity: total)
+        for segment in selected.reversed() {
+            dictionary.append(contentsOf: segment)
+        }
+        return dictionary
+    }
+
+    /// 段得分：未覆盖的高频 k-mer 频率之和
+    private func score(_ segment: ArraySlice<UInt8>, frequency: [UInt64: Int32], covered: Set<UInt64>) -> Int {
+        var total = 0
+        var counted = Set<UInt64>()
+        Self.forEachKmer(segment) { kmer in
+            guard !covered.contains(kmer), counted.insert(kmer).inserted,
+                  let count = frequency[kmer], count >= 2 else { return }
+            total += Int(count)
+        }
+        return total
+    }
+
+    /// 遍历字节序列中的全部 k-mer（按小端打包为 UInt64）
+    private static func forEachKmer(_ bytes: ArraySlice<UInt8>, _ body: (UInt64) -> Void) {
+        guard bytes.count >= kmerSize else { return }
+        var kmer: UInt64 = 0
+        var filled = 0
+        for byte in bytes {
+            kmer = (kmer >> 8) | (UInt64(byte) << 56)
+            filled += 1
+            if filled >= kmerSize { body(kmer) }
+        }
+    }
+}
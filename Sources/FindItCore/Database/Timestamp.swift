@@ -0,0 +1,70 @@
+import Foundation
+#if canImport(Darwin)
+import Darwin
+#else
+import Glibc
+#endif
+
+/// 整数时间戳（Unix 纪元纳秒）
+///
+/// 文件夹库 `videos` 的时间列以 INTEGER 纳秒存储（`*_ns` 列），
+/// 跳过检测、排序、过期查询都是整数比较，不经过 `DateFormatter`。
+/// 字符串形式只在 UI 展示时由 `date(_:)` 转换。
+///
+/// 文件修改时间直接取 `stat()` 的 timespec，保留纳秒精度：
+/// 秒级字符串会把同一秒内的两次修改判为"未变"，也会因格式化舍入产生误判。
+public enum Timestamp {
+
+    /// 每秒纳秒数
+    public static let nanosecondsPerSecond: Int64 = 1_000_000_000
+
+    /// 当前时间
+    public static func now() -> Int64 {
+        var ts = timespec()
+        clock_gettime(CLOCK_REALTIME, &ts)
+        return nanoseconds(ts)
+    }
+
+    /// `Date` → 纳秒
+    public static func nanoseconds(_ date: Date) -> Int64 {
+        Int64((date.timeIntervalSince1970 * Double(nanosecondsPerSecond)).rounded())
+    }
+
+    /// 纳秒 → `Date`（UI 边界使用）
+    public static func date(_ nanoseconds: Int64) -> Date {
+        Date(timeIntervalSince1970: Double(nanoseconds) / Double(nanosecondsPerSecond))
+    }
+
+    /// 指定时长之前的时间点
+    public static func ago(seconds: TimeInterval, from now: Int64 = Timestamp.now()) -> Int64 {
+        now - Int64(seconds * Double(nanosecondsPerSecond))
+    }
+
+    /// 文件大小与修改时间
+    public struct FileStat: Sendable, Equatable {
+        public let size: Int64
+        public let modified: Int64
+    }
+
+    /// 读取文件大小与修改时间（一次 `stat` 系统调用，文件不存在时返回 nil）
+    ///
+    /// 跟随符号链接，取目标文件的修改时间。
+    public static func stat(path: String) -> FileStat? {
+        #if canImport(Darwin)
+        var info = Darwin.stat()
+        guard Darwin.stat(path, &info) == 0 else { return nil }
+        let mtime = info.st_mtimespec
+        #else
+        var info = Glibc.stat()
+        guard Glibc.stat(path, &info) == 0 else { return nil }
+        let mtime = info.st_mtim
+        #endif
+        return FileStat(size: Int64(info.st_size), modified: nanoseconds(mtime))
+    }
+
+    // MARK: - Private
+
+    private static func nanoseconds(_ ts: timespec) -> Int64 {
+        Int64(ts.tv_sec) * nanosecondsPerSecond + Int64(ts.tv_nsec)
+    }
+}
@@ -0,0 +1,199 @@
+import Foundation
+import GRDB
+
+/// 带时间码的转录片段索引
+///
+/// `clips.transcript` 把一个场景内的所有字幕拼接成一段文本，
+/// 命中后无法定位到具体时刻，且补全结果时必须加载整段转录。
+/// 本索引按 STT 字幕粒度存储（文件夹库 `transcript_segments`），
+/// 同步到全局库后由独立的 `transcript_fts` 检索，命中直接返回字幕起止时间，
+/// 并按匹配词在字幕内的位置估算说出该词的时刻。
+///
+/// 字幕短（通常 < 15 秒），BM25 在片段粒度上天然带有邻近性；
+/// 需要显式控制距离时可用 `nearQuery(_:distance:)` 构造 `NEAR()` 查询。
+public enum TranscriptIndex {
+
+    /// 台词命中
+    public struct Hit: Sendable, Codable, Equatable {
+        /// 全局库 segment_id
+        public let segmentId: Int64
+        /// 来源文件夹路径
+        public let sourceFolder: String
+        /// 全局库 video_id
+        public let videoId: Int64?
+        /// 覆盖该时刻的全局库 clip_id（片段已被重新切分时可能为 nil）
+        public let clipId: Int64?
+        /// 视频文件路径
+        public let filePath: String?
+        /// 视频文件名
+        public let fileName: String?
+        /// 字幕起始时间（秒）
+        public let startTime: Double
+        /// 字幕结束时间（秒）
+        public let endTime: Double
+        /// 首个匹配词的估计时刻（按字符位置在字幕时长内线性插值）
+        public let matchTime: Double
+        /// 说话人（STT 未区分说话人时为 nil）
+        public let speaker: String?
+        /// 匹配词以 `[` `]` 标出的上下文摘要
+        public let snippet: String
+        /// FTS5 BM25 排名分数（越小越相关）
+        public let rank: Double
+    }
+
+    /// 摘要上下文词数
+    static let snippetTokens = 16
+
+    // MARK: - 文件夹库写入
+
+    /// 替换视频的转录片段（重新转录时整体覆盖）
+    ///
+    /// 新片段的 segment_id 总是大于旧片段，同步时据此识别并清理全局库中的旧片段。
+    ///
+    /// - Parameters:
+    ///   - db: 文件夹库连接（写事务内）
+    ///   - videoId: 文件夹库 video_id
+    ///   - segments: STT 输出的字幕片段
+    ///   - speakers: 与 `segments` 对齐的说话人（nil = 未区分）
+    public static func replaceSegments(
+        _ db: Database,
+        videoId: Int64,
+        segments: [TranscriptSegment],
+        speakers: [String?]? = nil
+    ) throws {
+        try db.execute(sql: "DELETE FROM transcript_segments WHERE video_id = ?", arguments: [videoId])
+        let statement = try db.makeStatement(sql: """
+            INSERT INTO transcript_segments (video_id, segment_index, start_time, end_time, speaker, text)
+            VALUES (?, ?, ?, ?, ?, ?)
+            """)
+        for (i, segment) in segments.enumerated() {
+            let text = segment.text.trimmingCharacters(in: .whitespacesAndNewlines)
+            guard !text.isEmpty else { continue }
+            let speaker = speakers.flatMap { i < $0.count ? $0[i] : nil }
+            try statement.execute(arguments: [
+                videoId, segment.index, segment.startTime, segment.endTime, speaker, text,
+            ])
+        }
+    }
+
+    /// 读取视频的转录片段（按时间顺序）
+    public static func fetchSegments(_ db: Database, videoId: Int64) throws -> [TranscriptSegment] {
+        try Row.fetchAll(db, sql: """
+            SELECT segment_index, start_time, end_time, text FROM transcript_segments
+            WHERE video_id = ? ORDER BY segment_index
+            """, arguments: [videoId]).map { row in
+            TranscriptSegment(
+                index: row["segment_index"],
+                startTime: row["start_time"],
+                endTime: row["end_time"],
+                text: row["text"]
+            )
+        }
+    }
+
+    // MARK: - 全局库检索
+
+    /// 台词搜索
+    ///
+    /// 支持 FTS5 查询语法（短语 `"..."`、前缀、`NEAR()`）。
+    /// 只读取命中字幕本身，不加载 clip 的完整转录。
+    ///
+    /// - Parameters:
+    ///   - db: 全局库连接
+    ///   - query: 查询文本
+    ///   - folderPaths: 文件夹过滤（nil = 不过滤）
+    ///   - pathPrefixFilter: 路径前缀过滤（子文件夹书签）
+    ///   - limit: 最大返回条数
+    public static func search(
+        _ db: Database,
+        query: String,
+        folderPaths: Set<String>? = nil,
+        pathPrefixFilter: String? = nil,
+        limit: Int = 50
+    ) throws -> [Hit] {
+        let trimmed = query.trimmingCharacters(in: .whitespacesAndNewlines)
+        guard !trimmed.isEmpty else { return [] }
+
+        var filterSQL = ""
+        var args = StatementArguments()
+        args += [trimmed]
+        if let folderPaths {
+            if folderPaths.isEmpty {
+                filterSQL += " AND 0"
+            } else {
+                let placeholders = folderPaths.map { _ in "?" }.joined(separator: ", ")
+                filterSQL += " AND s.source_folder IN (\(placeholders))"
+                for path in folderPaths.sorted() { args += [path] }
+            }
+        }
+        if let pathPrefixFilter {
+            filterSQL += " AND v.file_path LIKE ? || '/%'"
+            args += [pathPrefixFilter]
+        }
+        args += [limit]
+
+        // highlight 使用控制字符作标记，便于定位匹配词在原文中的字符偏移
+        let rows = try Row.fetchAll(db, sql: """
+            SELECT s.segment_id, s.source_folder, s.video_id,
+                   s.start_time, s.end_time, s.speaker,
+                   v.file_path, v.file_name,
+                   \(ClipTimeIndex.coveringClipSQL(videoId: "s.video_id", time: "s.start_time")) AS clip_id,
+                   highlight(transcript_fts, 0, char(1), char(2)) AS marked,
+                   snippet(transcript_fts, 0, '[', ']', '…', \(snippetTokens)) AS snippet,
+                   transcript_fts.rank
+            FROM transcript_fts
+            JOIN transcript_segments s ON s.segment_id = transcript_fts.rowid
+            JOIN videos v ON v.video_id = s.video_id
+            WHERE transcript_fts MATCH ?\(filterSQL)
+            ORDER BY transcript_fts.rank
+            LIMIT ?
+            """, arguments: args)
+
+        return rows.map { row in
+            let start: Double = row["start_time"]
+            let end: Double = row["end_time"]
+            let marked: String = row["marked"] ?? ""
+            return Hit(
+                segmentId: row["segment_id"],
+                sourceFolder: row["source_folder"],
+                videoId: row["video_id"],
+                clipId: row["clip_id"],
+                filePath: row["file_path"],
+                fileName: row["file_name"],
+                startTime: start,
+                endTime: end,
+                matchTime: matchTime(marked: marked, startTime: start, endTime: end),
+                speaker: row["speaker"],
+                snippet: row["snippet"] ?? "",
+                rank: row["rank"]
+            )
+        }
+    }
+
+    /// 将普通关键词查询改写为 `NEAR()` 邻近查询
+    ///
+    /// 查询已含引号、括号或布尔运算符时原样返回（尊重用户语法）。
+    ///
+    /// - Parameters:
+    ///   - query: 用户输入
+    ///   - distance: 词项之间最多间隔的词数
+    public static func nearQuery(_ query: String, distance: Int) -> String {
+        let words = query.split(whereSeparator: \.isWhitespace).map(String.init)
+        let hasSyntax = query.contains { "\"()*:^".contains($0) }
+            || words.contains { ["AND", "OR", "NOT", "NEAR"].contains($0) }
+        guard !hasSyntax, words.count > 1 else { return query }
+        let phrases = words.map { "\"\($0)\"" }.joined(separator: " ")
+        return "NEAR(\(phrases), \(max(0, distance)))"
+    }
+
+    /// 按首个匹配标记的字符偏移在字幕时长内线性插值
+    static func matchTime(marked: String, startTime: Double, endTime: Double) -> Double {
+        let plain = marked.unicodeScalars.filter { $0 != "\u{1}" && $0 != "\u{2}" }
+        guard let markIndex = marked.unicodeScalars.firstIndex(of: "\u{1}"), !plain.isEmpty else {
+            return startTime
+        }
+        let offset = marked.unicodeScalars.distance(from: marked.unicodeScalars.startIndex, to: markIndex)
+        let fraction = Double(offset) / Double(plain.count)
+        return startTime + max(0, endTime - startTime) * fraction
+    }
+}
@@ -34,6 +34,58 @@ public enum AudioExtractor {
         return outputPath
     }
 
+    /// 从已提取的 WAV 中截取一段（流复制，不重新解码视频）
+    ///
+    /// 命令: `ffmpeg -ss start -t duration -i input.wav -c copy -y output.wav`
+    ///
+    /// - Parameters:
+    ///   - inputPath: 整段 WAV 路径
+    ///   - outputPath: 输出 WAV 路径
+    ///   - start: 起始时间（秒）
+    ///   - duration: 截取时长（秒）
+    ///   - config: FFmpeg 配置
+    /// - Returns: 输出文件路径
+    @discardableResult
+    public static func extractSlice(
+        inputPath: String,
+        outputPath: String,
+        start: Double,
+        duration: Double,
+        config: FFmpegConfig = .default
+    ) throws -> String {
+        guard FileManager.default.fileExists(atPath: inputPath) else {
+            throw FFmpegError.inputFileNotFound(path: inputPath)
+        }
+
+        let args = buildSliceArguments(
+            inputPath: inputPath, outputPath: outputPath, start: start, duration: duration
+        )
+        _ = try FFmpegBridge.run(arguments: args, config: config)
+
+        guard FileManager.default.fileExists(atPath: outputPath) else {
+            throw FFmpegError.outputFileNotCreated(path: outputPath)
+        }
+
+        return outputPath
+    }
+
+    /// 构建音频截取命令参数
+    static func buildSliceArguments(
+        inputPath: String,
+        outputPath: String,
+        start: Double,
+        duration: Double
+    ) -> [String] {
+        [
+            "-ss", String(format: "%.3f", start),
+            "-t", String(format: "%.3f", duration),
+            "-i", inputPath,
+            "-c", "copy",            // PCM 直接复制
+            "-y",
+            outputPath
+        ]
+    }
+
     /// 构建音频提取命令参数
     static func buildArguments(inputPath: String, outputPath: String) -> [String] {
         [
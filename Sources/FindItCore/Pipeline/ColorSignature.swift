@@ -0,0 +1,251 @@
+import Foundation
+import Accelerate
+
+/// 色彩签名：量化 Lab 直方图（64 字节，可直接做 SIMD 直方图相交）
+///
+/// 分桶方式（共 64 桶）：
+/// - 0-3：中性色（色度 C* < 12），按 L* 四等分
+/// - 4-63：彩色，L* 五档 × 色相 12 扇区（每 30°）
+///
+/// 像素在相邻两档 L* 间、彩色像素再在相邻两个色相扇区间线性分配权重，
+/// 避免亮度或色相落在档位边界时查询与素材分到不同桶。
+/// 各桶权重归一化为总和不超过 255 的 `UInt8`，
+/// 因此两签名逐桶取小后求和不会溢出。
+public struct ColorSignature: Sendable, Equatable {
+
+    /// 桶数
+    public static let binCount = 64
+
+    /// 中性色桶数（按 L* 分档）
+    static let neutralBins = 4
+
+    /// 色相扇区数
+    static let hueSectors = 12
+
+    /// 彩色 L* 档数
+    static let lightnessLevels = 5
+
+    /// 中性色色度阈值（C*）
+    static let neutralChroma: Float = 12
+
+    /// 归一化总量
+    static let totalMass: Float = 255
+
+    /// 各桶权重
+    public let bins: SIMD64<UInt8>
+
+    public init(bins: SIMD64<UInt8>) {
+        self.bins = bins
+    }
+
+    /// 从任意尺度的直方图归一化（向下取整，保证总和 ≤ 255）
+    init(histogram: [Float]) {
+        let total = histogram.reduce(0, +)
+        var bins = SIMD64<UInt8>()
+        if total > 0 {
+            for i in 0..<Self.binCount {
+                bins[i] = UInt8(min(Self.totalMass, (histogram[i] / total * Self.totalMass).rounded(.down)))
+            }
+        }
+        self.bins = bins
+    }
+
+    /// 签名总量（空签名为 0）
+    public var mass: Int {
+        var sum = 0
+        for i in 0..<Self.binCount { sum += Int(bins[i]) }
+        return sum
+    }
+
+    // MARK: - 相似度
+
+    /// 直方图相交：Σ min(self, other) / Σ self（0-1，self 为查询时即"调色板覆盖度"）
+    public func intersection(_ other: ColorSignature) -> Float {
+        let mass = self.mass
+        guard mass > 0 else { return 0 }
+        return Float(Self.overlap(bins, other.bins)) / Float(mass)
+    }
+
+    /// 逐桶取小后求和（总和 ≤ 255，UInt8 回绕求和即精确值）
+    @inline(__always)
+    static func overlap(_ a: SIMD64<UInt8>, _ b: SIMD64<UInt8>) -> UInt8 {
+        pointwiseMin(a, b).wrappedSum()
+    }
+
+    // MARK: - 序列化
+
+    /// BLOB 表示（64 字节）
+    public var data: Data {
+        withUnsafeBytes(of: bins) { Data($0) }
+    }
+
+    /// 从 BLOB 恢复（长度不符返回 nil）
+    public init?(data: Data) {
+        guard data.count == Self.binCount else { return nil }
+        var bins = SIMD64<UInt8>()
+        for (i, byte) in data.enumerated() { bins[i] = byte }
+        self.bins = bins
+    }
+
+    // MARK: - 分桶
+
+    /// 把一个 Lab 颜色按权重累加进直方图
+    ///
+    /// - Parameters:
+    ///   - chroma: C*（√(a² + b²)）
+    ///   - hue: 色相角（弧度，atan2(b, a)）
+    static func accumulate(
+        l: Float,
+        chroma: Float,
+        hue: Float,
+        weight: Float,
+        into histogram: inout [Float]
+    ) {
+        guard chroma >= neutralChroma else {
+            let (level, upper) = lightnessShare(l, levels: neutralBins)
+            histogram[level] += weight * (1 - upper)
+            histogram[level + 1] += weight * upper
+            return
+        }
+        let (level, upper) = lightnessShare(l, levels: lightnessLevels)
+        var degrees = hue * 180 / .pi
+        if degrees < 0 { degrees += 360 }
+        // 扇区中心位于 15°、45°、…：position 的整数部分为左侧扇区，小数部分为右侧扇区权重
+        let position = degrees / (360 / Float(hueSectors)) - 0.5
+        let lower = Int(position.rounded(.down))
+        let fraction = position - Float(lower)
+        let left = (lower % hueSectors + hueSectors) % hueSectors
+        let right = (left + 1) % hueSectors
+        for (row, rowWeight) in [(level, 1 - upper), (level + 1, upper)] where rowWeight > 0 {
+            let base = neutralBins + row * hueSectors
+            histogram[base + left] += weight * rowWeight * (1 - fraction)
+            histogram[base + right] += weight * rowWeight * fraction
+        }
+    }
+
+    /// L* 在相邻两档间的分配
+    ///
+    /// 档中心位于每档中点（如五档时 10、30、…、90），两端档中心以外全部归入端档。
+    ///
+    /// - Returns: 下侧档位（上侧为 +1）与上侧档位权重
+    static func lightnessShare(_ l: Float, levels: Int) -> (lower: Int, upper: Float) {
+        let position = max(0, min(Float(levels - 1), l / 100 * Float(levels) - 0.5))
+        let lower = min(levels - 2, Int(position.rounded(.down)))
+        return (lower, position - Float(lower))
+    }
+
+    /// 由逐像素 Lab 平面计算签名
+    init(l: [Float], a: [Float], b: [Float]) {
+        let count = l.count
+        var chroma = [Float](repeating: 0, count: count)
+        var hue = [Float](repeating: 0, count: count)
+        vDSP_vdist(a, 1, b, 1, &chroma, 1, vDSP_Length(count))
+        var n = Int32(count)
+        vvatan2f(&hue, b, a, &n)
+
+        var histogram = [Float](repeating: 0, count: Self.binCount)
+        for i in 0..<count {
+            Self.accumulate(l: l[i], chroma: chroma[i], hue: hue[i], weight: 1, into: &histogram)
+        }
+        self.init(histogram: histogram)
+    }
+
+    /// 多个签名按等权平均（多帧合并）
+    public static func average(_ signatures: [ColorSignature]) -> ColorSignature? {
+        guard !signatures.isEmpty else { return nil }
+        var histogram = [Float](repeating: 0, count: binCount)
+        for signature in signatures {
+            let mass = Float(signature.mass)
+            guard mass > 0 else { continue }
+            for i in 0..<binCount { histogram[i] += Float(signature.bins[i]) / mass }
+        }
+        return ColorSignature(histogram: histogram)
+    }
+}
+
+// MARK: - 调色板查询
+
+/// 调色板解析错误
+public enum PaletteError: LocalizedError {
+    case empty
+    case unknownColor(String)
+    case invalidWeight(String)
+
+    public var errorDescription: String? {
+        switch self {
+        case .empty:
+            return "调色板为空"
+        case .unknownColor(let token):
+            return "无法识别的颜色: \(token)（支持颜色名或 #RRGGBB）"
+        case .invalidWeight(let token):
+            return "无效的颜色权重: \(token)"
+        }
+    }
+}
+
+extension ColorSignature {
+
+    /// 颜色名 → 代表 sRGB（与 `LocalVisionAnalyzer.nearestColorName` 词表一致）
+    static let namedColors: [String: (UInt8, UInt8, UInt8)] = [
+        "black": (20, 20, 20),
+        "gray": (128, 128, 128),
+        "grey": (128, 128, 128),
+        "white": (240, 240, 240),
+        "red": (200, 30, 30),
+        "orange": (235, 130, 40),
+        "yellow": (240, 215, 50),
+        "green": (50, 160, 60),
+        "cyan": (40, 190, 200),
+        "teal": (0, 128, 128),
+        "blue": (40, 80, 200),
+        "purple": (120, 60, 170),
+        "pink": (235, 120, 170),
+        "brown": (120, 75, 40),
+    ]
+
+    /// 由调色板描述构建查询签名
+    ///
+    /// 格式：逗号或空格分隔的颜色，每项为颜色名或 `#RRGGBB`，
+    /// 可带 `:权重` 后缀（缺省等权），如 `"orange:2, teal"`、`"#1f3a5c #d9a441"`。
+    public static func palette(_ spec: String) throws -> ColorSignature {
+        let tokens = spec
+            .split(whereSeparator: { $0 == "," || $0 == " " })
+            .map { $0.trimmingCharacters(in: .whitespaces).lowercased() }
+            .filter { !$0.isEmpty }
+        guard !tokens.isEmpty else { throw PaletteError.empty }
+
+        var colors: [(rgb: (UInt8, UInt8, UInt8), weight: Float)] = []
+        for token in tokens {
+            let parts = token.split(separator: ":", maxSplits: 1).map(String.init)
+            var weight: Float = 1
+            if parts.count == 2 {
+                guard let w = Float(parts[1]), w > 0 else { throw PaletteError.invalidWeight(token) }
+                weight = w
+            }
+            guard let rgb = parseColor(parts[0]) else { throw PaletteError.unknownColor(token) }
+            colors.append((rgb, weight))
+        }
+
+        let pixels = colors.flatMap { [$0.rgb.0, $0.rgb.1, $0.rgb.2, 255] }
+        let lab = PixelStatistics.LabBuffer(ThumbnailImage(width: colors.count, height: 1, pixels: pixels))
+        var histogram = [Float](repeating: 0, count: binCount)
+        for (i, color) in colors.enumerated() {
+            accumulate(
+                l: lab.l[i],
+                chroma: (lab.a[i] * lab.a[i] + lab.b[i] * lab.b[i]).squareRoot(),
+                hue: atan2(lab.b[i], lab.a[i]),
+                weight: color.weight,
+                into: &histogram
+            )
+        }
+        return ColorSignature(histogram: histogram)
+    }
+
+    /// 颜色名或十六进制（`#RRGGBB` / `RRGGBB`）
+    static func parseColor(_ token: String) -> (UInt8, UInt8, UInt8)? {
+        if let named = namedColors[token] { return named }
+        let hex = token.hasPrefix("#") ? String(token.dropFirst()) : token
+        guard hex.count == 6, let value = UInt32(hex, radix: 16) else { return nil }
+        return (UInt8(value >> 16 & 0xFF), UInt8(value >> 8 & 0xFF), UInt8(value & 0xFF))
+    }
+}
@@ -142,6 +142,33 @@ public enum FFmpegBridge {
         config: FFmpegConfig = .default,
         timeout: TimeInterval? = nil
     ) throws -> ProcessResult {
+        let output = try execute(arguments: arguments, config: config, timeout: timeout)
+        return ProcessResult(
+            exitCode: output.exitCode,
+            stdout: String(data: output.stdout, encoding: .utf8) ?? "",
+            stderr: output.stderr
+        )
+    }
+
+    /// 执行 FFmpeg 命令并返回原始 stdout 字节
+    ///
+    /// 用于 `pipe:1` 输出的二进制数据（如 image2pipe 的 JPEG 流），
+    /// 不经 UTF-8 解码。
+    ///
+    /// - Throws: FFmpegError（同 `run`）
+    public static func runCapturingOutput(
+        arguments: [String],
+        config: FFmpegConfig = .default,
+        timeout: TimeInterval? = nil
+    ) throws -> Data {
+        try execute(arguments: arguments, config: config, timeout: timeout).stdout
+    }
+
+    private static func execute(
+        arguments: [String],
+        config: FFmpegConfig,
+        timeout: TimeInterval?
+    ) throws -> (exitCode: Int32, stdout: Data, stderr: String) {
         try validateExecutable(config: config)
 
         let process = Process()
@@ -190,7 +217,6 @@ public enum FFmpegBridge {
         timeoutItem.cancel()
         group.wait()
 
-        let stdout = String(data: stdoutResult, encoding: .utf8) ?? ""
         let stderr = String(data: stderrResult, encoding: .utf8) ?? ""
 
         // 检查是否因超时被终止
@@ -205,7 +231,7 @@ public enum FFmpegBridge {
             )
         }
 
-        return ProcessResult(exitCode: process.terminationStatus, stdout: stdout, stderr: stderr)
+        return (process.terminationStatus, stdoutResult, stderr)
     }
 
     // MARK: - Internal
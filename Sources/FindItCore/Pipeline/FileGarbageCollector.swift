@@ -0,0 +1,171 @@
+import Foundation
+import GRDB
+
+/// 文件系统延迟回收
+///
+/// 删除视频时，缩略图目录、降级 SRT 等文件不在调用方路径上同步删除，
+/// 而是与数据库删除在同一事务内写入文件夹库 `file_garbage` 表，
+/// 由后台任务分批、限速回收：
+/// - 持久化：进程退出 / 崩溃后队列仍在，下次 `schedule` 继续
+/// - 限速：每批 `batchSize` 项，批间休眠 `batchInterval`，不与索引争抢磁盘
+/// - 路径已不存在视为完成；其他失败累计次数，超过 `maxAttempts` 放弃
+/// - 仍被 `videos.srt_path` 引用的路径（同名视频重新加入）跳过不删
+/// - 删除前先剔除路径在缩略图打包缓存中的条目（缓存键含 mtime，删除后无法再算出）
+public final class FileGarbageCollector: @unchecked Sendable {
+
+    /// 回收器配置
+    public struct Config: Sendable {
+        /// 每批回收的路径数
+        public var batchSize: Int
+        /// 批间休眠（秒）
+        public var batchInterval: TimeInterval
+        /// 单个路径最大尝试次数
+        public var maxAttempts: Int
+
+        public static let `default` = Config()
+
+        public init(batchSize: Int = 32, batchInterval: TimeInterval = 0.2, maxAttempts: Int = 5) {
+            self.batchSize = max(1, batchSize)
+            self.batchInterval = batchInterval
+            self.maxAttempts = max(1, maxAttempts)
+        }
+    }
+
+    /// App 共享实例
+    public static let shared = FileGarbageCollector(thumbnails: .shared)
+
+    public let config: Config
+
+    /// 缩略图服务（nil = 不清理打包缓存）
+    public let thumbnails: ThumbnailService?
+
+    private let lock = NSLock()
+    /// 文件夹路径 → 回收任务（每个文件夹至多一个）
+    private var workers: [String: Task<Void, Never>] = [:]
+    /// 任务运行期间再次 `schedule` 的文件夹（队列见空后再检查一轮）
+    private var rescheduled: Set<String> = []
+
+    public init(config: Config = .default, thumbnails: ThumbnailService? = nil) {
+        self.config = config
+        self.thumbnails = thumbnails
+    }
+
+    // MARK: - 入队
+
+    /// 写入回收队列（应在删除数据库记录的同一事务内调用）
+    public static func enqueue(_ db: Database, paths: [String]) throws {
+        let now = Timestamp.nanoseconds(Date())
+        let statement = try db.cachedStatement(sql: """
+            INSERT OR IGNORE INTO file_garbage (path, enqueued_at_ns) VALUES (?, ?)
+            """)
+        for path in paths where !path.isEmpty {
+            try statement.execute(arguments: [path, now])
+        }
+    }
+
+    /// 待回收路径数
+    public static func pendingCount(_ db: Database) throws -> Int {
+        try Int.fetchOne(db, sql: "SELECT COUNT(*) FROM file_garbage") ?? 0
+    }
+
+    // MARK: - 回收
+
+    /// 启动文件夹的后台回收（幂等，已有任务运行时直接返回）
+    public func schedule(folderPath: String, folderDB: DatabaseWriter) {
+        lock.lock(); defer { lock.unlock() }
+        guard workers[folderPath] == nil else {
+            rescheduled.insert(folderPath)
+            return
+        }
+        workers[folderPath] = Task.detached(priority: .background) { [weak self] in
+            while !Task.isCancelled, let self {
+                let collected = (try? self.collectBatch(folderDB: folderDB)) ?? 0
+                if collected == 0 {
+                    guard self.continueAfterDrain(folderPath: folderPath) else { return }
+                    continue
+                }
+                try? await Task.sleep(nanoseconds: UInt64(self.config.batchInterval * 1_000_000_000))
+            }
+        }
+    }
+
+    /// 停止所有后台回收（队列保留，下次 `schedule` 继续）
+    public func cancelAll() {
+        lock.lock(); defer { lock.unlock() }
+        workers.values.forEach { $0.cancel() }
+        workers.removeAll()
+        rescheduled.removeAll()
+    }
+
+    /// 回收一批
+    ///
+    /// - Returns: 本批处理（删除、跳过或放弃）的路径数，0 = 队列已空
+    @discardableResult
+    public func collectBatch(folderDB: DatabaseWriter, fileManager: FileManager = .default) throws -> Int {
+        let batch = try folderDB.read { db in
+            try Row.fetchAll(db, sql: """
+                SELECT path, attempts,
+                       EXISTS (SELECT 1 FROM videos WHERE srt_path = file_garbage.path) AS referenced
+                FROM file_garbage
+                ORDER BY enqueued_at_ns
+                LIMIT ?
+                """, arguments: [config.batchSize])
+        }
+        guard !batch.isEmpty else { return 0 }
+
+        // 文件操作在事务外执行
+        var done: [String] = []
+        var failed: [String] = []
+        for row in batch {
+            let path: String = row["path"]
+            let attempts: Int = row["attempts"]
+            let referenced: Bool = row["referenced"]
+            if referenced || !fileManager.fileExists(atPath: path) {
+                done.append(path)
+                continue
+            }
+            thumbnails?.evictFromDisk(path: path)
+            do {
+                try fileManager.removeItem(atPath: path)
+                done.append(path)
+            } catch {
+                if attempts + 1 >= config.maxAttempts {
+                    print("[FileGarbageCollector] 放弃回收: \(path) - \(error.localizedDescription)")
+                    done.append(path)
+                } else {
+                    failed.append(path)
+                }
+            }
+        }
+
+        try folderDB.write { db in
+            for path in done {
+                try db.execute(sql: "DELETE FROM file_garbage WHERE path = ?", arguments: [path])
+            }
+            for path in failed {
+                try db.execute(sql: "UPDATE file_garbage SET attempts = attempts + 1 WHERE path = ?", arguments: [path])
+            }
+        }
+        return batch.count
+    }
+
+    /// 同步回收全部（CLI / 测试；不限速）
+    @discardableResult
+    public func collectAll(folderDB: DatabaseWriter, fileManager: FileManager = .default) throws -> Int {
+        var total = 0
+        while true {
+            let collected = try collectBatch(folderDB: folderDB, fileManager: fileManager)
+            guard collected > 0 else { return total }
+            total += collected
+        }
+    }
+
+    /// 队列见空：期间有新的 `schedule` 则再跑一轮，否则注销任务
+    private func continueAfterDrain(folderPath: String) -> Bool {
+        lock.lock(); defer { lock.unlock() }
+        if rescheduled.remove(folderPath) != nil { return true }
+        workers[folderPath] = nil
+        return false
+    }
+
+}
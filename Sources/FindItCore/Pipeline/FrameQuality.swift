@@ -0,0 +1,166 @@
+import Foundation
+import Accelerate
+
+/// 单帧质量评分
+public struct FrameQualityScore: Sendable, Equatable {
+    /// 清晰度：亮度 Laplacian 方差（0-255 亮度刻度，运动模糊 / 失焦帧通常 < 20）
+    public let sharpness: Float
+    /// 平均亮度（0-1）
+    public let meanLuma: Float
+    /// 近黑像素占比（亮度 < 16）
+    public let darkFraction: Float
+    /// 过曝像素占比（亮度 ≥ 248）
+    public let brightFraction: Float
+    /// 色彩丰富度（Hasler–Süsstrunk，灰度画面为 0，鲜艳画面 > 80）
+    public let colorfulness: Float
+
+    /// 综合得分（0-1，越大越适合作为代表帧）
+    ///
+    /// 清晰度占主导，其次是曝光；近乎全黑（淡入淡出、转场黑场）的帧直接压低。
+    public var overall: Float {
+        let sharp = min(1, log1p(sharpness) / log1p(500))
+        let exposure = max(0, 1 - abs(meanLuma - 0.45) / 0.45) * (1 - max(darkFraction, brightFraction))
+        let color = min(1, colorfulness / 80)
+        let score = 0.55 * sharp + 0.3 * exposure + 0.15 * color
+        return darkFraction > 0.9 ? score * 0.1 : score
+    }
+}
+
+/// 关键帧质量评分
+///
+/// 在缩小到 256px 的亮度平面上用 vDSP 计算：
+/// - 3×3 Laplacian 卷积的方差（清晰度）
+/// - 64 级亮度直方图（黑场 / 过曝占比）
+/// - 对立色通道 rg / yb 的均值与标准差（色彩丰富度）
+///
+/// 用于从每个场景的候选帧中挑选代表缩略图，并淘汰多余的低质量帧，
+/// 减少送入 VLM 的图片数和磁盘占用。
+public enum FrameQuality {
+
+    /// 评分时的最长边像素（512px 关键帧缩小一半，噪声更低、速度更快）
+    static let analysisSize = 256
+
+    /// 直方图级数
+    static let histogramBins = 64
+
+    /// 读取图片并评分（无法解码时返回 nil）
+    public static func score(path: String) -> FrameQualityScore? {
+        guard let image = ThumbnailService.decode(path: path, maxPixelSize: analysisSize) else { return nil }
+        return score(image)
+    }
+
+    /// 对内存中的编码图像评分（关键帧写盘前选帧，无法解码时返回 nil）
+    public static func score(data: Data) -> FrameQualityScore? {
+        guard let image = ThumbnailService.decode(data: data, maxPixelSize: analysisSize) else { return nil }
+        return score(image)
+    }
+
+    /// 对 RGBA8 像素评分
+    public static func score(_ image: ThumbnailImage) -> FrameQualityScore {
+        let count = image.width * image.height
+        let n = vDSP_Length(count)
+        var r = [Float](repeating: 0, count: count)
+        var g = [Float](repeating: 0, count: count)
+        var b = [Float](repeating: 0, count: count)
+        image.pixels.withUnsafeBufferPointer { px in
+            guard let base = px.baseAddress else { return }
+            vDSP_vfltu8(base, 4, &r, 1, n)
+            vDSP_vfltu8(base + 1, 4, &g, 1, n)
+            vDSP_vfltu8(base + 2, 4, &b, 1, n)
+        }
+
+        // 亮度（BT.601）
+        var luma = [Float](repeating: 0, count: count)
+        luma.withUnsafeMutableBufferPointer { out in
+            guard let y = out.baseAddress else { return }
+            var kr: Float = 0.299, kg: Float = 0.587, kb: Float = 0.114
+            vDSP_vsmul(r, 1, &kr, y, 1, n)
+            vDSP_vsma(g, 1, &kg, y, 1, y, 1, n)
+            vDSP_vsma(b, 1, &kb, y, 1, y, 1, n)
+        }
+
+        var meanLuma: Float = 0
+        vDSP_meanv(luma, 1, &meanLuma, n)
+
+        // 亮度直方图
+        var histogram = [Int](repeating: 0, count: histogramBins)
+        let binWidth = 256 / histogramBins
+        for value in luma {
+            histogram[min(histogramBins - 1, Int(value) / binWidth)] += 1
+        }
+        let total = Float(max(1, count))
+        let dark = Float(histogram[0..<(16 / binWidth)].reduce(0, +)) / total
+        let bright = Float(histogram[(248 / binWidth)...].reduce(0, +)) / total
+
+        return FrameQualityScore(
+            sharpness: laplacianVariance(luma, width: image.width, height: image.height),
+            meanLuma: meanLuma / 255,
+            darkFraction: dark,
+            brightFraction: bright,
+            colorfulness: colorfulness(r: r, g: g, b: b)
+        )
+    }
+
+    /// 从候选帧中选出得分最高的一帧
+    ///
+    /// 全部无法解码时回退到第一帧（保持旧行为）。
+    public static func selectBest(from paths: [String]) -> String? {
+        let scored = paths.compactMap { path in score(path: path).map { (path, $0.overall) } }
+        return scored.max { $0.1 < $1.1 }?.0 ?? paths.first
+    }
+
+    // MARK: - 内核
+
+    /// 4 邻域 Laplacian 方差（只统计内部像素，vDSP_f3x3 会把边缘置零）
+    static func laplacianVariance(_ luma: [Float], width: Int, height: Int) -> Float {
+        guard width >= 3, height >= 3 else { return 0 }
+        let kernel: [Float] = [0, 1, 0,
+                               1, -4, 1,
+                               0, 1, 0]
+        var laplacian = [Float](repeating: 0, count: luma.count)
+        vDSP_f3x3(luma, vDSP_Length(height), vDSP_Length(width), kernel, &laplacian)
+
+        var sum: Float = 0
+        var sumSquares: Float = 0
+        let interior = vDSP_Length(width - 2)
+        laplacian.withUnsafeBufferPointer { buffer in
+            guard let base = buffer.baseAddress else { return }
+            for row in 1..<(height - 1) {
+                let start = base + row * width + 1
+                var rowSum: Float = 0
+                var rowSquares: Float = 0
+                vDSP_sve(start, 1, &rowSum, interior)
+                vDSP_svesq(start, 1, &rowSquares, interior)
+                sum += rowSum
+                sumSquares += rowSquares
+            }
+        }
+        let n = Float((width - 2) * (height - 2))
+        let mean = sum / n
+        return max(0, sumSquares / n - mean * mean)
+    }
+
+    /// Hasler–Süsstrunk 色彩丰富度：σ_rgyb + 0.3 μ_rgyb
+    static func colorfulness(r: [Float], g: [Float], b: [Float]) -> Float {
+        let n = vDSP_Length(r.count)
+        guard n > 0 else { return 0 }
+        var rg = [Float](repeating: 0, count: r.count)
+        var yb = [Float](repeating: 0, count: r.count)
+        // rg = R - G
+        vDSP_vsub(g, 1, r, 1, &rg, 1, n)
+        // yb = (R + G) / 2 - B
+        vDSP_vadd(r, 1, g, 1, &yb, 1, n)
+        yb.withUnsafeMutableBufferPointer { out in
+            guard let base = out.baseAddress else { return }
+            var half: Float = 0.5
+            vDSP_vsmsb(base, 1, &half, b, 1, base, 1, n)
+        }
+
+        var meanRG: Float = 0, stdRG: Float = 0
+        var meanYB: Float = 0, stdYB: Float = 0
+        vDSP_normalize(rg, 1, nil, 1, &meanRG, &stdRG, n)
+        vDSP_normalize(yb, 1, nil, 1, &meanYB, &stdYB, n)
+        return (stdRG * stdRG + stdYB * stdYB).squareRoot()
+            + 0.3 * (meanRG * meanRG + meanYB * meanYB).squareRoot()
+    }
+}
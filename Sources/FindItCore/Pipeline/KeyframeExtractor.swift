@@ -12,28 +12,33 @@ public enum KeyframeExtractor {
         public var thumbnailShortEdge: Int
         /// JPEG 质量 (FFmpeg -q:v, 1-31, 越小质量越高; 5 ≈ 80%)
         public var jpegQuality: Int
-        /// 每场景最大帧数
+        /// 每场景最大候选帧数（评分后按 keepFramesPerScene 保留）
         public var maxFramesPerScene: Int
         /// 帧数计算的时长除数（秒）
         public var frameDurationDivisor: Double
+        /// 质量评分后每场景保留的帧数（其余候选帧不写盘，不送入视觉分析）
+        public var keepFramesPerScene: Int
 
         public static let `default` = Config(
             thumbnailShortEdge: 512,
             jpegQuality: 5,
             maxFramesPerScene: 3,
-            frameDurationDivisor: 5.0
+            frameDurationDivisor: 5.0,
+            keepFramesPerScene: 2
         )
 
         public init(
             thumbnailShortEdge: Int = 512,
             jpegQuality: Int = 5,
             maxFramesPerScene: Int = 3,
-            frameDurationDivisor: Double = 5.0
+            frameDurationDivisor: Double = 5.0,
+            keepFramesPerScene: Int = 2
         ) {
             self.thumbnailShortEdge = thumbnailShortEdge
             self.jpegQuality = jpegQuality
             self.maxFramesPerScene = maxFramesPerScene
             self.frameDurationDivisor = frameDurationDivisor
+            self.keepFramesPerScene = keepFramesPerScene
         }
     }
 
@@ -45,12 +50,16 @@ public enum KeyframeExtractor {
         public let timestamp: Double
         /// 输出文件路径
         public let filePath: String
+        /// `FrameQuality` 综合得分（nil = 未评分或无法解码）
+        public var quality: Float? = nil
     }
 
     /// 为一组场景片段提取关键帧
     ///
-    /// 每个场景使用单次 FFmpeg 调用批量提取所有关键帧，
+    /// 每个场景使用单次 FFmpeg 调用批量提取所有候选帧，
     /// 避免逐帧启动子进程的开销（10 场景 × 3 帧 = 30 次降为 10 次调用）。
+    /// 候选帧经 `image2pipe` 输出到内存，按 `FrameQuality` 评分后只把
+    /// 得分最高的 `config.keepFramesPerScene` 帧写入输出目录，落选帧不落盘。
     ///
     /// - Parameters:
     ///   - inputPath: 视频文件路径
@@ -58,7 +67,7 @@ public enum KeyframeExtractor {
     ///   - outputDirectory: 输出目录路径（不存在时自动创建）
     ///   - config: 提取配置
     ///   - ffmpegConfig: FFmpeg 路径配置
-    /// - Returns: 提取的关键帧列表
+    /// - Returns: 写入的关键帧列表（每场景按时间顺序）
     public static func extractKeyframes(
         inputPath: String,
         segments: [SceneSegment],
@@ -83,73 +92,63 @@ public enum KeyframeExtractor {
             let timestamps = frameTimestamps(segment: segment, frameCount: frameCount)
             guard !timestamps.isEmpty else { continue }
 
+            var candidates: [(timestamp: Double, jpeg: Data)] = []
             if timestamps.count == 1 {
                 // 单帧：沿用 -ss seek 模式（最快）
-                let fileName = String(format: "scene_%03d_frame_%02d.jpg", sceneIndex, 0)
-                let outputPath = (outputDirectory as NSString).appendingPathComponent(fileName)
                 let args = buildExtractArguments(
                     inputPath: inputPath,
                     timestamp: timestamps[0],
-                    outputPath: outputPath,
+                    outputPath: pipeOutput,
                     config: config
                 )
-                _ = try FFmpegBridge.run(arguments: args, config: ffmpegConfig)
-                if FileManager.default.fileExists(atPath: outputPath) {
-                    frames.append(ExtractedFrame(
-                        sceneIndex: sceneIndex,
-                        timestamp: timestamps[0],
-                        filePath: outputPath
-                    ))
-                }
+                let stream = try FFmpegBridge.runCapturingOutput(arguments: pipeArguments(args), config: ffmpegConfig)
+                candidates = zip(timestamps, splitJPEGStream(stream)).map { (timestamp: $0, jpeg: $1) }
             } else {
                 // 多帧：单次 FFmpeg 调用批量提取
-                let outputPattern = (outputDirectory as NSString)
-                    .appendingPathComponent(String(format: "scene_%03d_frame_%%02d.jpg", sceneIndex))
                 let args = buildBatchExtractArguments(
                     inputPath: inputPath,
                     segment: segment,
                     timestamps: timestamps,
-                    outputPattern: outputPattern,
+                    outputPattern: pipeOutput,
                     config: config
                 )
-                _ = try FFmpegBridge.run(arguments: args, config: ffmpegConfig)
-
-                // 收集实际生成的文件
-                var batchFrameCount = 0
-                for (frameIndex, timestamp) in timestamps.enumerated() {
-                    let fileName = String(format: "scene_%03d_frame_%02d.jpg", sceneIndex, frameIndex)
-                    let outputPath = (outputDirectory as NSString).appendingPathComponent(fileName)
-                    if FileManager.default.fileExists(atPath: outputPath) {
-                        frames.append(ExtractedFrame(
-                            sceneIndex: sceneIndex,
-                            timestamp: timestamp,
-                            filePath: outputPath
-                        ))
-                        batchFrameCount += 1
-                    }
-                }
+                let stream = try FFmpegBridge.runCapturingOutput(arguments: pipeArguments(args), config: ffmpegConfig)
+                candidates = zip(timestamps, splitJPEGStream(stream)).map { (timestamp: $0, jpeg: $1) }
 
                 // 安全网：批量提取产出 0 帧时，用单帧模式在场景中点补提 1 帧
-                if batchFrameCount == 0 {
+                if candidates.isEmpty {
                     let midpoint = (segment.startTime + segment.endTime) / 2
-                    let fallbackName = String(format: "scene_%03d_frame_00.jpg", sceneIndex)
-                    let fallbackPath = (outputDirectory as NSString).appendingPathComponent(fallbackName)
                     let fallbackArgs = buildExtractArguments(
                         inputPath: inputPath,
                         timestamp: midpoint,
-                        outputPath: fallbackPath,
+                        outputPath: pipeOutput,
                         config: config
                     )
-                    _ = try? FFmpegBridge.run(arguments: fallbackArgs, config: ffmpegConfig)
-                    if FileManager.default.fileExists(atPath: fallbackPath) {
-                        frames.append(ExtractedFrame(
-                            sceneIndex: sceneIndex,
-                            timestamp: midpoint,
-                            filePath: fallbackPath
-                        ))
+                    if let stream = try? FFmpegBridge.runCapturingOutput(
+                        arguments: pipeArguments(fallbackArgs),
+                        config: ffmpegConfig
+                    ), let jpeg = splitJPEGStream(stream).first {
+                        candidates = [(midpoint, jpeg)]
                     }
                 }
             }
+            guard !candidates.isEmpty else { continue }
+
+            // 只有一帧时无需评分（缩略图没有其他选择）
+            let scores: [Float?] = candidates.count > 1
+                ? candidates.map { FrameQuality.score(data: $0.jpeg)?.overall }
+                : [nil]
+            for frameIndex in selectFrames(scores: scores, keep: config.keepFramesPerScene) {
+                let fileName = String(format: "scene_%03d_frame_%02d.jpg", sceneIndex, frameIndex)
+                let outputPath = (outputDirectory as NSString).appendingPathComponent(fileName)
+                try candidates[frameIndex].jpeg.write(to: URL(fileURLWithPath: outputPath), options: .atomic)
+                frames.append(ExtractedFrame(
+                    sceneIndex: sceneIndex,
+                    timestamp: candidates[frameIndex].timestamp,
+                    filePath: outputPath,
+                    quality: scores[frameIndex]
+                ))
+            }
         }
 
         return frames
@@ -157,6 +156,53 @@ public enum KeyframeExtractor {
 
     // MARK: - Internal 纯函数
 
+    /// FFmpeg 标准输出目标
+    static let pipeOutput = "pipe:1"
+
+    /// 把提取参数的输出改为 stdout 上的 MJPEG 图像流（`-q:v` 等编码参数不变）
+    static func pipeArguments(_ arguments: [String]) -> [String] {
+        guard arguments.last == pipeOutput else { return arguments }
+        return Array(arguments.dropLast()) + ["-f", "image2pipe", "-c:v", "mjpeg", pipeOutput]
+    }
+
+    /// 按 SOI (FFD8) / EOI (FFD9) 标记切分 image2pipe 输出的 JPEG 流
+    ///
+    /// 熵编码数据中的 0xFF 都经过字节填充（后跟 0x00），
+    /// 因此帧内不会出现 FFD9，按首个 EOI 截断即可。截断的末帧丢弃。
+    static func splitJPEGStream(_ stream: Data) -> [Data] {
+        let bytes = [UInt8](stream)
+        var images: [Data] = []
+        var index = 0
+        while index + 1 < bytes.count {
+            guard bytes[index] == 0xFF, bytes[index + 1] == 0xD8 else {
+                index += 1
+                continue
+            }
+            var end = index + 2
+            while end + 1 < bytes.count, !(bytes[end] == 0xFF && bytes[end + 1] == 0xD9) {
+                end += 1
+            }
+            guard end + 1 < bytes.count else { break }
+            images.append(Data(bytes[index...(end + 1)]))
+            index = end + 2
+        }
+        return images
+    }
+
+    /// 按质量得分选出要保留的候选帧索引
+    ///
+    /// 保留得分最高的 `keep` 帧（同分取较早者），结果按时间顺序返回，
+    /// 供视觉分析理解动作。无法解码的帧按 0 分计；全部无法评分时保留最早的 `keep` 帧。
+    static func selectFrames(scores: [Float?], keep: Int) -> [Int] {
+        let limit = max(1, keep)
+        guard scores.count > limit else { return Array(scores.indices) }
+        let ranked = scores.indices.sorted { lhs, rhs in
+            let (l, r) = (scores[lhs] ?? 0, scores[rhs] ?? 0)
+            return l != r ? l > r : lhs < rhs
+        }
+        return ranked.prefix(limit).sorted()
+    }
+
     /// 计算场景应提取的帧数
     ///
     /// `max(1, min(maxFrames, duration / divisor))`
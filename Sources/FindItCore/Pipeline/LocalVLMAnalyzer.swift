@@ -84,10 +84,12 @@ public enum LocalVLMAnalyzer {
     /// - Parameters:
     ///   - imagePath: JPEG 图片文件路径
     ///   - container: 已加载的模型容器
+    ///   - fields: 提示词中要求模型输出的字段
     /// - Returns: 结构化分析结果
     public static func analyzeImage(
         imagePath: String,
-        container: ModelContainer
+        container: ModelContainer,
+        fields: [VisionField] = VisionField.allActive
     ) async throws -> AnalysisResult {
         guard FileManager.default.fileExists(atPath: imagePath) else {
             throw VisionAnalyzerError.imageEncodingFailed(path: imagePath)
@@ -97,7 +99,7 @@ public enum LocalVLMAnalyzer {
         let session = ChatSession(container)
 
         let response = try await session.respond(
-            to: analysisPrompt,
+            to: analysisPrompt(fields: fields),
             image: .url(imageURL)
         )
 
@@ -111,10 +113,12 @@ public enum LocalVLMAnalyzer {
     /// - Parameters:
     ///   - imagePaths: JPEG 图片文件路径数组
     ///   - container: 已加载的模型容器
+    ///   - fields: 提示词中要求模型输出的字段
     /// - Returns: 结构化分析结果
     public static func analyzeClip(
         imagePaths: [String],
-        container: ModelContainer
+        container: ModelContainer,
+        fields: [VisionField] = VisionField.allActive
     ) async throws -> AnalysisResult {
         guard !imagePaths.isEmpty else {
             return emptyResult()
@@ -122,7 +126,7 @@ public enum LocalVLMAnalyzer {
 
         // 单张直接分析
         if imagePaths.count == 1 {
-            return try await analyzeImage(imagePath: imagePaths[0], container: container)
+            return try await analyzeImage(imagePath: imagePaths[0], container: container, fields: fields)
         }
 
         // 多帧：发送前 3 张（避免上下文过长）
@@ -138,7 +142,7 @@ public enum LocalVLMAnalyzer {
 
         let session = ChatSession(container)
         let response = try await session.respond(
-            to: analysisPrompt,
+            to: analysisPrompt(fields: fields),
             images: images,
             videos: []
         )
@@ -155,7 +159,12 @@ public enum LocalVLMAnalyzer {
 
     /// 分析提示词（由 VisionField 数据驱动生成）
     static var analysisPrompt: String {
-        VisionField.buildVLMPrompt()
+        analysisPrompt(fields: VisionField.allActive)
+    }
+
+    /// 仅包含指定字段的分析提示词
+    static func analysisPrompt(fields: [VisionField]) -> String {
+        VisionField.buildVLMPrompt(fields: fields)
     }
 
     /// 创建空的 AnalysisResult
@@ -7,6 +7,7 @@ import CoreImage
 /// 使用 macOS 内置 Vision/CoreImage 框架提取图像元数据，
 /// 零依赖、零下载、完全离线。可填充 AnalysisResult 的 6/9 字段：
 /// scene, subjects, objects, shotType, lighting, colors。
+/// 其中 lighting / colors 由 `PixelStatistics` 从像素直接计算（精确值，合并时优先于模型输出）。
 ///
 /// description、mood、actions 仍需 Gemini API 补充。
 public enum LocalVisionAnalyzer {
@@ -32,20 +33,22 @@ public enum LocalVisionAnalyzer {
     /// 最多保留的分类标签数
     static let maxClassificationLabels = 8
 
-    /// 共享 CIContext（线程安全，避免每次调用重新分配 GPU 资源）
-    private static let sharedCIContext = CIContext()
-
     // MARK: - 公开接口
 
     /// 分析单张图片
     ///
     /// 使用 VNClassifyImageRequest 提取场景/物体标签，
     /// VNDetectFace/HumanRectanglesRequest 检测人物，
-    /// CIAreaAverage/CIKMeans 提取光线和颜色。
+    /// PixelStatistics 计算光线和颜色。
     ///
     /// - Parameter imagePath: JPEG 图片绝对路径
     /// - Returns: 含 6/9 字段的 AnalysisResult
     public static func analyze(imagePath: String) throws -> AnalysisResult {
+        try analyzeFrame(imagePath: imagePath).result
+    }
+
+    /// 单帧分析，同时返回像素统计（供多帧合并）
+    static func analyzeFrame(imagePath: String) throws -> (result: AnalysisResult, statistics: ImageStatistics?) {
         let url = URL(fileURLWithPath: imagePath)
         guard let ciImage = CIImage(contentsOf: url) else {
             throw AnalysisError.imageLoadFailed(path: imagePath)
@@ -71,73 +74,77 @@ public enum LocalVisionAnalyzer {
         let (scene, objects) = extractSceneAndObjects(from: classifications)
         let subjects = inferSubjects(faceCount: faces.count, humanCount: humans.count)
         let shotType = inferShotType(faces: faces)
-        let lighting = analyzeLighting(ciImage: ciImage)
-        let colors = extractDominantColors(ciImage: ciImage)
+        let statistics = PixelStatistics.analyze(path: imagePath)
 
-        return AnalysisResult(
+        let result = AnalysisResult(
             scene: scene,
             subjects: subjects,
             actions: [],
             objects: objects,
             mood: nil,
             shotType: shotType,
-            lighting: lighting,
-            colors: colors,
+            lighting: statistics?.lighting,
+            colors: statistics?.colors,
             description: nil
         )
+        return (result, statistics)
     }
 
     /// 分析多张关键帧并合并为单个 clip 的分析结果
     ///
-    /// 对每帧独立分析，然后取多数投票（场景/镜头/光线）和并集（人物/物体）。
+    /// 对每帧独立分析，然后取多数投票（场景/镜头）和并集（人物/物体）；
+    /// 光线与颜色由各帧像素统计合并后重新计算。
     /// 单帧分析失败时跳过该帧。
     ///
     /// - Parameter imagePaths: 关键帧图片路径数组
     /// - Returns: 合并后的 AnalysisResult
     public static func analyzeClip(imagePaths: [String]) throws -> AnalysisResult {
-        guard !imagePaths.isEmpty else {
-            return AnalysisResult(
-                scene: nil, subjects: [], actions: [], objects: [],
-                mood: nil, shotType: nil, lighting: nil, colors: nil,
-                description: nil
-            )
-        }
+        try analyzeClipFrames(imagePaths: imagePaths).result
+    }
+
+    /// 多帧分析，同时返回合并后的像素统计（供写入色彩签名）
+    static func analyzeClipFrames(
+        imagePaths: [String]
+    ) throws -> (result: AnalysisResult, statistics: ImageStatistics?) {
+        let empty = AnalysisResult(
+            scene: nil, subjects: [], actions: [], objects: [],
+            mood: nil, shotType: nil, lighting: nil, colors: nil,
+            description: nil
+        )
+        guard !imagePaths.isEmpty else { return (empty, nil) }
 
         var results: [AnalysisResult] = []
+        var statistics: [ImageStatistics] = []
         for path in imagePaths {
             do {
-                results.append(try analyze(imagePath: path))
+                let frame = try analyzeFrame(imagePath: path)
+                results.append(frame.result)
+                if let stats = frame.statistics { statistics.append(stats) }
             } catch {
                 continue
             }
         }
 
-        guard !results.isEmpty else {
-            return AnalysisResult(
-                scene: nil, subjects: [], actions: [], objects: [],
-                mood: nil, shotType: nil, lighting: nil, colors: nil,
-                description: nil
-            )
-        }
+        guard !results.isEmpty else { return (empty, nil) }
 
         let scene = mostFrequent(results.compactMap(\.scene))
         let subjects = dedup(results.flatMap(\.subjects))
         let objects = Array(dedup(results.flatMap(\.objects)).prefix(10))
         let shotType = mostFrequent(results.compactMap(\.shotType))
-        let lighting = mostFrequent(results.compactMap(\.lighting))
-        let colors = results.first(where: { $0.colors != nil })?.colors
+        let combined = PixelStatistics.combine(statistics)
 
-        return AnalysisResult(
+        let result = AnalysisResult(
             scene: scene,
             subjects: subjects,
             actions: [],
             objects: objects,
             mood: nil,
             shotType: shotType,
-            lighting: lighting,
-            colors: colors,
+            lighting: combined?.lighting,
+            colors: combined?.colors,
             description: nil
         )
+        return (result, combined)
     }
 
     /// 将本地分析结果与 Gemini 分析结果合并
@@ -145,6 +152,7 @@ public enum LocalVisionAnalyzer {
     /// 使用 VisionField.mergeStrategy 决定每个字段的合并策略：
     /// - `.preferNonNil`: remote 非 nil 优先，否则保留 local
     /// - `.preferNonEmptyArray`: remote 非空数组优先，否则保留 local
+    /// - `.preferLocal`: local 非 nil 优先（像素统计字段），否则采用 remote
     ///
     /// - Parameters:
     ///   - local: 本地分析结果
@@ -152,7 +160,10 @@ public enum LocalVisionAnalyzer {
     /// - Returns: 合并后的 AnalysisResult
     public static func mergeResults(local: AnalysisResult, remote: AnalysisResult) -> AnalysisResult {
         func mergeString(_ field: VisionField) -> String? {
-            remote.stringValue(for: field) ?? local.stringValue(for: field)
+            if case .preferLocal = field.mergeStrategy {
+                return local.stringValue(for: field) ?? remote.stringValue(for: field)
+            }
+            return remote.stringValue(for: field) ?? local.stringValue(for: field)
         }
 
         func mergeArray(_ field: VisionField) -> [String] {
@@ -249,27 +260,6 @@ public enum LocalVisionAnalyzer {
 
     // MARK: - 光线分析
 
-    /// 使用 CIAreaAverage 分析图像平均亮度
-    static func analyzeLighting(ciImage: CIImage) -> String? {
-        let extent = ciImage.extent
-
-        guard let filter = CIFilter(name: "CIAreaAverage", parameters: [
-            kCIInputImageKey: ciImage,
-            kCIInputExtentKey: CIVector(cgRect: extent)
-        ]),
-        let outputImage = filter.outputImage else {
-            return nil
-        }
-
-        var pixel = [Float](repeating: 0, count: 4)
-        sharedCIContext.render(outputImage, toBitmap: &pixel, rowBytes: 16,
-                       bounds: CGRect(x: 0, y: 0, width: 1, height: 1),
-                       format: .RGBAf, colorSpace: nil)
-
-        let luminance = 0.2126 * pixel[0] + 0.7152 * pixel[1] + 0.0722 * pixel[2]
-        return classifyLighting(luminance: luminance)
-    }
-
     /// 根据亮度值分类光线条件（纯函数，可测试）
     static func classifyLighting(luminance: Float) -> String {
         switch luminance {
@@ -283,44 +273,6 @@ public enum LocalVisionAnalyzer {
 
     // MARK: - 主色提取
 
-    /// 使用 CIKMeans 提取主色调，输出命名颜色
-    static func extractDominantColors(ciImage: CIImage, count: Int = 5) -> String? {
-        let extent = ciImage.extent
-
-        guard let filter = CIFilter(name: "CIKMeans", parameters: [
-            kCIInputImageKey: ciImage,
-            kCIInputExtentKey: CIVector(cgRect: extent),
-            "inputCount": count,
-            "inputPasses": 5
-        ]),
-        let outputImage = filter.outputImage else {
-            return nil
-        }
-
-        let outputExtent = outputImage.extent
-        let width = Int(outputExtent.width)
-        guard width > 0 else { return nil }
-
-        var pixels = [Float](repeating: 0, count: width * 4)
-        sharedCIContext.render(outputImage, toBitmap: &pixels, rowBytes: width * 16,
-                       bounds: outputExtent, format: .RGBAf, colorSpace: nil)
-
-        var colorNames: [String] = []
-        var seen = Set<String>()
-        for i in 0..<width {
-            let r = UInt8(max(0, min(255, pixels[i * 4 + 0] * 255)))
-            let g = UInt8(max(0, min(255, pixels[i * 4 + 1] * 255)))
-            let b = UInt8(max(0, min(255, pixels[i * 4 + 2] * 255)))
-            let name = nearestColorName(r: r, g: g, b: b)
-            if !seen.contains(name) {
-                seen.insert(name)
-                colorNames.append(name)
-            }
-        }
-
-        return colorNames.isEmpty ? nil : colorNames.joined(separator: " ")
-    }
-
     /// 将 RGB 值映射为命名颜色（便于搜索）
     static func nearestColorName(r: UInt8, g: UInt8, b: UInt8) -> String {
         let rf = Float(r) / 255, gf = Float(g) / 255, bf = Float(b) / 255
@@ -13,8 +13,11 @@ public enum OrphanRecovery {
     public struct MarkResult: Sendable {
         /// 标记为 orphaned 的视频数
         public let markedCount: Int
+        /// 从全局库删除的 clip_id（全局库 ID，供 VectorStore 等派生索引增量移除）
+        public let removedGlobalClipIds: [Int64]
+
         /// 从全局库删除的 clips 数
-        public let globalClipsRemoved: Int
+        public var globalClipsRemoved: Int { removedGlobalClipIds.count }
     }
 
     /// 恢复结果
@@ -35,7 +38,7 @@ public enum OrphanRecovery {
 
     /// 将单个视频标记为 orphaned（软删除）
     ///
-    /// 文件夹库: UPDATE status='orphaned', orphaned_at=now
+    /// 文件夹库: UPDATE status='orphaned', orphaned_at_ns=now
     /// 全局库: DELETE clips + videos（搜索不可见）
     /// 文件系统: 保留缩略图和 SRT（恢复时复用）
     ///
@@ -57,12 +60,12 @@ public enum OrphanRecovery {
         guard let videoId = video.videoId else { return nil }
 
         // 2. 文件夹库: 标记为 orphaned
-        let now = Clip.sqliteDatetime()
+        let now = Timestamp.now()
         try folderDB.write { db in
             try db.execute(
                 sql: """
                     UPDATE videos
-                    SET index_status = 'orphaned', orphaned_at = ?
+                    SET index_status = 'orphaned', orphaned_at_ns = ?
                     WHERE video_id = ?
                     """,
                 arguments: [now, videoId]
@@ -70,7 +73,7 @@ public enum OrphanRecovery {
         }
 
         // 3. 全局库: 删除（搜索不可见）
-        var globalClips = 0
+        var globalClips: [Int64] = []
         if let globalDB = globalDB {
             globalClips = try cleanGlobalRecords(
                 folderPath: folderPath,
@@ -79,7 +82,7 @@ public enum OrphanRecovery {
             )
         }
 
-        return MarkResult(markedCount: 1, globalClipsRemoved: globalClips)
+        return MarkResult(markedCount: 1, removedGlobalClipIds: globalClips)
     }
 
     /// 批量标记为 orphaned
@@ -91,7 +94,7 @@ public enum OrphanRecovery {
         globalDB: DatabaseWriter? = nil
     ) throws -> MarkResult {
         var totalMarked = 0
-        var totalGlobalClips = 0
+        var removedClipIds: [Int64] = []
 
         for path in videoPaths {
             do {
@@ -102,7 +105,7 @@ public enum OrphanRecovery {
                     globalDB: globalDB
                 ) {
                     totalMarked += result.markedCount
-                    totalGlobalClips += result.globalClipsRemoved
+                    removedClipIds += result.removedGlobalClipIds
                 }
             } catch {
                 print("[OrphanRecovery] 标记失败: \(path) - \(error)")
@@ -111,7 +114,7 @@ public enum OrphanRecovery {
 
         return MarkResult(
             markedCount: totalMarked,
-            globalClipsRemoved: totalGlobalClips
+            removedGlobalClipIds: removedClipIds
         )
     }
 
@@ -139,7 +142,7 @@ public enum OrphanRecovery {
             try Row.fetchOne(db, sql: """
                 SELECT video_id FROM videos
                 WHERE file_hash = ? AND index_status = 'orphaned'
-                ORDER BY orphaned_at DESC LIMIT 1
+                ORDER BY orphaned_at_ns DESC LIMIT 1
                 """, arguments: [fileHash])
         }) else {
             return nil
@@ -152,10 +155,9 @@ public enum OrphanRecovery {
 
         // 2. 获取文件信息
         let newFileName = (newVideoPath as NSString).lastPathComponent
-        let attrs = try? FileManager.default.attributesOfItem(atPath: newVideoPath)
-        let newFileSize = attrs?[.size] as? Int64
-        let newFileMtime = (attrs?[.modificationDate] as? Date)
-            .map { Clip.sqliteDatetime($0) }
+        let fileStat = Timestamp.stat(path: newVideoPath)
+        let newFileSize = fileStat?.size
+        let newFileMtime = fileStat?.modified
 
         // 3. 先删 pending（释放 file_path UNIQUE 约束），再恢复 orphaned
         try folderDB.write { db in
@@ -168,8 +170,8 @@ public enum OrphanRecovery {
                 sql: """
                     UPDATE videos
                     SET file_path = ?, file_name = ?, file_size = ?,
-                        file_modified = ?, index_status = 'completed',
-                        orphaned_at = NULL
+                        file_modified_ns = ?, index_status = 'completed',
+                        orphaned_at_ns = NULL
                     WHERE video_id = ?
                     """,
                 arguments: [newVideoPath, newFileName, newFileSize,
@@ -194,7 +196,7 @@ public enum OrphanRecovery {
 
     /// 清理过期 orphaned 记录
     ///
-    /// 硬删除 orphaned_at 超过 retentionDays 的视频及其 clips，
+    /// 硬删除 orphaned_at_ns 超过 retentionDays 的视频及其 clips，
     /// 并清理关联的缩略图目录和 SRT 文件。
     /// 文件 I/O 在 GRDB write 事务之外执行。
     public static func cleanupExpired(
@@ -210,7 +212,7 @@ public enum OrphanRecovery {
         let cutoffDate = Calendar.current.date(
             byAdding: .day, value: -retentionDays, to: Date()
         )!
-        let cutoff = Clip.sqliteDatetime(cutoffDate)
+        let cutoff = Timestamp.nanoseconds(cutoffDate)
 
         // 1. 读取过期记录（在事务外收集文件路径）
         struct ExpiredVideo {
@@ -221,7 +223,7 @@ public enum OrphanRecovery {
         let expired: [ExpiredVideo] = try folderDB.read { db in
             let rows = try Row.fetchAll(db, sql: """
                 SELECT video_id, srt_path FROM videos
-                WHERE index_status = 'orphaned' AND orphaned_at < ?
+                WHERE index_status = 'orphaned' AND orphaned_at_ns < ?
                 """, arguments: [cutoff])
             return rows.map {
                 ExpiredVideo(videoId: $0["video_id"], srtPath: $0["srt_path"])
@@ -268,27 +270,37 @@ public enum OrphanRecovery {
 
     // MARK: - Private
 
-    /// 从全局库删除指定视频的 clips 和 video 记录
+    /// 从全局库删除指定视频的 clips、转录片段和 video 记录
     @discardableResult
     private static func cleanGlobalRecords(
         folderPath: String,
         sourceVideoId: Int64,
         globalDB: DatabaseWriter
-    ) throws -> Int {
+    ) throws -> [Int64] {
         try globalDB.write { db in
             let row = try Row.fetchOne(db, sql: """
                 SELECT video_id FROM videos
                 WHERE source_folder = ? AND source_video_id = ?
                 """, arguments: [folderPath, sourceVideoId])
 
-            guard let globalVideoId: Int64 = row?["video_id"] else { return 0 }
+            guard let globalVideoId: Int64 = row?["video_id"] else { return [] }
 
             // 删除 clips（FTS5 触发器自动更新索引）
+            let clipsRemoved = try Int64.fetchAll(
+                db,
+                sql: "SELECT clip_id FROM clips WHERE video_id = ?",
+                arguments: [globalVideoId]
+            )
             try db.execute(
                 sql: "DELETE FROM clips WHERE video_id = ?",
                 arguments: [globalVideoId]
             )
-            let clipsRemoved = db.changesCount
+
+            // 删除转录片段（按来源键，video_id 未映射的片段同样清除）
+            try db.execute(
+                sql: "DELETE FROM transcript_segments WHERE source_folder = ? AND source_video_id = ?",
+                arguments: [folderPath, sourceVideoId]
+            )
 
             // 删除 video
             try db.execute(
@@ -15,7 +15,9 @@ import MLXLMCommon
 /// ```
 ///
 /// 支持断点续传：Vision 分析每完成一个 clip 更新 `last_processed_clip`，
-/// 中断后恢复时只处理剩余 clips。
+/// 中断后恢复时只处理剩余 clips。阶段内部产物（场景切点、提取的音频、语言、
+/// 已转录分块、嵌入进度）逐单元提交到 `StageArtifacts`，以 `file_hash` 判定有效性，
+/// 崩溃或睡眠后从最后提交的单元继续，不重复解码与转录。
 public enum PipelineManager {
 
     // MARK: - 数据类型
@@ -67,6 +69,8 @@ public enum PipelineManager {
         public let requiresForceSync: Bool
         /// 是否因无音轨而跳过 STT（非致命降级）
         public let sttSkippedNoAudio: Bool
+        /// 重索引时从全局库清理掉的旧 clip_id（并行模式由调度器并入最终同步结果）
+        public let removedGlobalClipIds: [Int64]
 
         public init(
             videoId: Int64,
@@ -76,7 +80,8 @@ public enum PipelineManager {
             srtPath: String?,
             syncResult: SyncEngine.SyncResult?,
             requiresForceSync: Bool = false,
-            sttSkippedNoAudio: Bool = false
+            sttSkippedNoAudio: Bool = false,
+            removedGlobalClipIds: [Int64] = []
         ) {
             self.videoId = videoId
             self.clipsCreated = clipsCreated
@@ -86,6 +91,7 @@ public enum PipelineManager {
             self.syncResult = syncResult
             self.requiresForceSync = requiresForceSync
             self.sttSkippedNoAudio = sttSkippedNoAudio
+            self.removedGlobalClipIds = removedGlobalClipIds
         }
     }
 
@@ -144,9 +150,30 @@ public enum PipelineManager {
 
     /// 为 clip 选择代表性缩略图路径
     ///
-    /// 返回该场景的第一帧路径（如有）。
+    /// 按 `FrameQuality` 综合得分（清晰度 / 曝光 / 色彩）选最佳帧；
+    /// 均无法解码时返回第一帧。
     static func selectThumbnail(from frames: [String]) -> String? {
-        frames.first
+        frames.count > 1 ? FrameQuality.selectBest(from: frames) : frames.first
+    }
+
+    /// 各场景的代表缩略图
+    ///
+    /// 取 `KeyframeExtractor` 写盘前评出的最高分帧（帧已按质量精选，无需重新解码）；
+    /// 场景内均未评分时取第一帧。
+    static func representativeThumbnails(
+        frames: [KeyframeExtractor.ExtractedFrame],
+        sceneCount: Int
+    ) -> [String?] {
+        var best = [KeyframeExtractor.ExtractedFrame?](repeating: nil, count: sceneCount)
+        for frame in frames {
+            guard frame.sceneIndex >= 0 && frame.sceneIndex < sceneCount else { continue }
+            if let current = best[frame.sceneIndex],
+               (frame.quality ?? -1) <= (current.quality ?? -1) {
+                continue
+            }
+            best[frame.sceneIndex] = frame
+        }
+        return best.map { $0?.filePath }
     }
 
     // MARK: - 全流程编排
@@ -173,6 +200,9 @@ public enum PipelineManager {
     ///   - embeddingProvider: 向量嵌入提供者（nil = 跳过嵌入）
     ///   - skipStt: 跳过所有语音转录（包括 SpeechAnalyzer）
     ///   - skipSync: 跳过同步到全局索引（并行模式由调用方统一同步）
+    ///   - visionFields: 视觉模型需回答的字段（默认不含光线/色调，由像素统计填充；
+    ///     本地没有像素统计值的 clip 仍请求这两项）
+    ///   - visualExtractor: 关键帧视觉特征提取器（nil = 不计算，"找相似镜头"不可用）
     ///   - ffmpegConfig: FFmpeg 配置
     ///   - onProgress: 进度回调
     /// - Returns: 处理结果
@@ -188,6 +218,8 @@ public enum PipelineManager {
         embeddingProvider: EmbeddingProvider? = nil,
         skipStt: Bool = false,
         skipSync: Bool = false,
+        visionFields: [VisionField] = VisionField.modelFields(),
+        visualExtractor: (any VisualFeatureExtractor)? = TinyImageDescriptor(),
         ffmpegConfig: FFmpegConfig = .default,
         onProgress: (@Sendable (String) -> Void)? = nil
     ) async throws -> ProcessingResult {
@@ -204,16 +236,23 @@ public enum PipelineManager {
 
         // 三层跳过检测（已完成的视频）
         if currentStage == .completed {
-            // 层 1: file_size + file_modified 快速比较（零文件 I/O）
-            let attrs = try? FileManager.default.attributesOfItem(atPath: videoPath)
-            let currentSize = attrs?[.size] as? Int64
-            let currentMtime = (attrs?[.modificationDate] as? Date)
-                .map { Clip.utcFormatter.string(from: $0) }
+            // 层 1: file_size + 纳秒 mtime 整数比较（单次 stat，零文件 I/O）
+            let fileStat = Timestamp.stat(path: videoPath)
+            let currentSize = fileStat?.size
+            let currentMtime = fileStat?.modified
 
             let sizeMatch = currentSize == video.fileSize
-            let mtimeMatch = currentMtime == video.fileModified
+            let mtimeMatch = currentMtime != nil && currentMtime == video.fileModifiedNs
 
-            if sizeMatch && mtimeMatch {
+            // 迁移自秒级字符串的旧值：同一秒内视为未变，顺带升级为纳秒精度（避免全库重新哈希）
+            if sizeMatch, !mtimeMatch, let currentMtime, let stored = video.fileModifiedNs,
+               stored % Timestamp.nanosecondsPerSecond == 0,
+               currentMtime / Timestamp.nanosecondsPerSecond == stored / Timestamp.nanosecondsPerSecond {
+                try await folderDB.write { db in
+                    try db.execute(sql: """
+                        UPDATE videos SET file_modified_ns = ? WHERE video_id = ?
+                        """, arguments: [currentMtime, videoId])
+                }
                 progress("已完成且文件未变，跳过")
                 return ProcessingResult(
                     videoId: videoId, clipsCreated: 0, clipsAnalyzed: 0,
@@ -221,8 +260,26 @@ public enum PipelineManager {
                 )
             }
 
-            // 层 2: size/mtime 变了 → 计算哈希验证内容是否真的变了
-            if let storedHash = video.fileHash {
+            // 嵌入阶段在 completed 之后运行：上次中断时留有进度检查点，文件未变则继续嵌入
+            var resumeEmbedding = false
+            if sizeMatch && mtimeMatch, let provider = embeddingProvider {
+                let pending = try loadArtifact(
+                    StageArtifacts.EmbeddingProgress.self, kind: .embedding,
+                    videoId: videoId, fileHash: video.fileHash, folderDB: folderDB
+                )
+                resumeEmbedding = pending?.model == provider.name
+            }
+
+            if resumeEmbedding {
+                progress("继续未完成的向量嵌入...")
+            } else if sizeMatch && mtimeMatch {
+                progress("已完成且文件未变，跳过")
+                return ProcessingResult(
+                    videoId: videoId, clipsCreated: 0, clipsAnalyzed: 0,
+                    clipsEmbedded: 0, srtPath: video.srtPath, syncResult: nil
+                )
+            } else if let storedHash = video.fileHash {
+                // 层 2: size/mtime 变了 → 计算哈希验证内容是否真的变了
                 try Task.checkCancellation()
                 progress("元数据变更，哈希校验中...")
                 let currentHash = try FileHasher.hash128(filePath: videoPath)
@@ -230,7 +287,7 @@ public enum PipelineManager {
                     // 内容未变，仅元数据变更 → 更新 mtime 后跳过
                     try await folderDB.write { db in
                         try db.execute(sql: """
-                            UPDATE videos SET file_size = ?, file_modified = ?
+                            UPDATE videos SET file_size = ?, file_modified_ns = ?
                             WHERE video_id = ?
                             """, arguments: [currentSize, currentMtime, videoId])
                     }
@@ -246,7 +303,7 @@ public enum PipelineManager {
                 try await folderDB.write { db in
                     try db.execute(sql: """
                         UPDATE videos SET index_status = 'pending', index_error = NULL,
-                            file_size = ?, file_modified = ?, file_hash = NULL,
+                            file_size = ?, file_modified_ns = ?, file_hash = NULL,
                             last_processed_clip = NULL
                         WHERE video_id = ?
                         """, arguments: [currentSize, currentMtime, videoId])
@@ -269,7 +326,7 @@ public enum PipelineManager {
                     try await folderDB.write { db in
                         try db.execute(sql: """
                             UPDATE videos SET index_status = 'pending', index_error = NULL,
-                                file_size = ?, file_modified = ?, file_hash = NULL,
+                                file_size = ?, file_modified_ns = ?, file_hash = NULL,
                                 last_processed_clip = NULL
                             WHERE video_id = ?
                             """, arguments: [currentSize, currentMtime, videoId])
@@ -282,7 +339,7 @@ public enum PipelineManager {
                     let hash = try FileHasher.hash128(filePath: videoPath)
                     try await folderDB.write { db in
                         try db.execute(sql: """
-                            UPDATE videos SET file_hash = ?, file_size = ?, file_modified = ?
+                            UPDATE videos SET file_hash = ?, file_size = ?, file_modified_ns = ?
                             WHERE video_id = ?
                             """, arguments: [hash, currentSize, currentMtime, videoId])
                     }
@@ -299,10 +356,9 @@ public enum PipelineManager {
         // - 哈希一致：快速恢复 completed，并要求 force 同步回填全局索引。
         // - 哈希缺失/不一致：回到 pending 全量重建，避免复用过期片段数据。
         if currentStage == .orphaned {
-            let attrs = try? FileManager.default.attributesOfItem(atPath: videoPath)
-            let currentSize = attrs?[.size] as? Int64
-            let currentMtime = (attrs?[.modificationDate] as? Date)
-                .map { Clip.utcFormatter.string(from: $0) }
+            let fileStat = Timestamp.stat(path: videoPath)
+            let currentSize = fileStat?.size
+            let currentMtime = fileStat?.modified
 
             if let storedHash = video.fileHash {
                 try Task.checkCancellation()
@@ -315,9 +371,9 @@ public enum PipelineManager {
                             UPDATE videos
                             SET index_status = 'completed',
                                 index_error = NULL,
-                                orphaned_at = NULL,
+                                orphaned_at_ns = NULL,
                                 file_size = ?,
-                                file_modified = ?,
+                                file_modified_ns = ?,
                                 file_hash = ?
                             WHERE video_id = ?
                             """, arguments: [currentSize, currentMtime, currentHash, videoId])
@@ -364,9 +420,9 @@ public enum PipelineManager {
                     UPDATE videos
                     SET index_status = 'pending',
                         index_error = NULL,
-                        orphaned_at = NULL,
+                        orphaned_at_ns = NULL,
                         file_size = ?,
-                        file_modified = ?,
+                        file_modified_ns = ?,
                         file_hash = NULL,
                         last_processed_clip = NULL
                     WHERE video_id = ?
@@ -380,23 +436,30 @@ public enum PipelineManager {
             progress("计算文件哈希...")
             try Task.checkCancellation()
             let hash = try FileHasher.hash128(filePath: videoPath)
-            let attrs = try? FileManager.default.attributesOfItem(atPath: videoPath)
-            let currentMtime = (attrs?[.modificationDate] as? Date)
-                .map { Clip.utcFormatter.string(from: $0) }
+            let currentMtime = Timestamp.stat(path: videoPath)?.modified
             try await folderDB.write { db in
                 try db.execute(sql: """
-                    UPDATE videos SET file_hash = ?, file_modified = ?
+                    UPDATE videos SET file_hash = ?, file_modified_ns = ?
                     WHERE video_id = ?
                     """, arguments: [hash, currentMtime, videoId])
             }
         }
 
-        // Orphan 恢复: 新 pending 视频计算 hash 后，尝试匹配 orphaned 记录
-        if currentStage == .pending, let hash = try await folderDB.read({ db in
+        // 阶段产物以当前文件哈希为有效性依据（旧数据无哈希时不启用检查点）
+        let fileHash = try await folderDB.read { db in
             try String.fetchOne(db, sql: """
                 SELECT file_hash FROM videos WHERE video_id = ?
                 """, arguments: [videoId])
-        }) {
+        }
+        if let fileHash {
+            let doomed = try await folderDB.write { db in
+                try StageArtifacts.discardStale(db, videoId: videoId, fileHash: fileHash)
+            }
+            StageArtifacts.removeFiles(doomed)
+        }
+
+        // Orphan 恢复: 新 pending 视频计算 hash 后，尝试匹配 orphaned 记录
+        if currentStage == .pending, let hash = fileHash {
             try Task.checkCancellation()
             if let recovery = try OrphanRecovery.attemptRecovery(
                 fileHash: hash,
@@ -437,6 +500,8 @@ public enum PipelineManager {
         var frameGroups: [[String]] = []
         var extractedAudioPath: String?
         var skipSttBecauseNoAudio = false
+        var videoDuration = video.duration ?? 0
+        var removedGlobalClipIds: [Int64] = []
 
         // 2. FFmpeg 准备阶段（场景检测 + 关键帧 + 本地视觉分析）
         //    对 pending 或 failed 状态的视频需要执行
@@ -452,29 +517,67 @@ public enum PipelineManager {
                     try FileManager.default.createDirectory(
                         atPath: tmpDir, withIntermediateDirectories: true
                     )
-                    audioOutputPath = (tmpDir as NSString)
-                        .appendingPathComponent("video_\(videoId).wav")
+                    audioOutputPath = StageArtifacts.audioPath(
+                        directory: tmpDir, folderPath: folderPath, videoId: videoId
+                    )
                 }
 
-                let detection = try SceneDetector.detectScenesOptimized(
-                    inputPath: videoPath,
-                    audioOutputPath: audioOutputPath,
-                    ffmpegConfig: ffmpegConfig
-                )
-                try Task.checkCancellation()
-                let duration = detection.duration
-                sceneSegments = detection.scenes
-                extractedAudioPath = detection.audioExtracted ? audioOutputPath : nil
-                if needsAudio && !detection.audioExtracted {
-                    skipSttBecauseNoAudio = true
-                    progress("视频无音轨，跳过语音转录")
+                let duration: Double
+                if let cuts = try loadArtifact(
+                    StageArtifacts.SceneCuts.self, kind: .scenes,
+                    videoId: videoId, fileHash: fileHash, folderDB: folderDB
+                ) {
+                    // 上次在关键帧/本地分析阶段中断：复用切点，不再解码整段视频
+                    duration = cuts.duration
+                    sceneSegments = cuts.scenes
+                    if needsAudio, let audio = try loadArtifact(
+                        StageArtifacts.AudioFile.self, kind: .audio,
+                        videoId: videoId, fileHash: fileHash, folderDB: folderDB
+                    ), audio.isIntact {
+                        extractedAudioPath = audio.path
+                    }
+                    if needsAudio && cuts.hasAudio == false {
+                        skipSttBecauseNoAudio = true
+                        progress("视频无音轨，跳过语音转录")
+                    }
+                    progress("复用场景检测检查点")
+                } else {
+                    let detection = try SceneDetector.detectScenesOptimized(
+                        inputPath: videoPath,
+                        audioOutputPath: audioOutputPath,
+                        ffmpegConfig: ffmpegConfig
+                    )
+                    try Task.checkCancellation()
+                    duration = detection.duration
+                    sceneSegments = detection.scenes
+                    extractedAudioPath = detection.audioExtracted ? audioOutputPath : nil
+                    if needsAudio && !detection.audioExtracted {
+                        skipSttBecauseNoAudio = true
+                        progress("视频无音轨，跳过语音转录")
+                    }
+
+                    try saveArtifact(
+                        StageArtifacts.SceneCuts(
+                            duration: duration, scenes: sceneSegments,
+                            hasAudio: needsAudio ? detection.audioExtracted : nil
+                        ),
+                        kind: .scenes, videoId: videoId, fileHash: fileHash, folderDB: folderDB
+                    )
+                    if let path = extractedAudioPath, let audio = StageArtifacts.AudioFile.capture(path: path) {
+                        try saveArtifact(
+                            audio,
+                            kind: .audio, videoId: videoId, fileHash: fileHash, folderDB: folderDB
+                        )
+                    }
                 }
+                videoDuration = duration
 
                 try updateVideoDuration(folderDB: folderDB, videoId: videoId, duration: duration)
                 progress("检测到 \(sceneSegments.count) 个场景 (时长: \(Int(duration))s)")
 
                 guard !sceneSegments.isEmpty else {
                     progress("视频无有效场景，标记为完成")
+                    try clearArtifacts(videoId: videoId, folderDB: folderDB)
                     try updateVideoStatus(folderDB: folderDB, videoId: videoId, status: .completed)
                     return ProcessingResult(
                         videoId: videoId, clipsCreated: 0, clipsAnalyzed: 0,
@@ -485,6 +588,7 @@ public enum PipelineManager {
                 // 关键帧提取
                 progress("提取关键帧中...")
                 let thumbDir = thumbnailDirectory(folderPath: folderPath, videoId: videoId)
+                // 候选帧在内存中按质量评分，每场景只写入 keepFramesPerScene 帧
                 let frames = try KeyframeExtractor.extractKeyframes(
                     inputPath: videoPath,
                     segments: sceneSegments,
@@ -492,13 +596,14 @@ public enum PipelineManager {
                     ffmpegConfig: ffmpegConfig
                 )
                 try Task.checkCancellation()
-                progress("提取了 \(frames.count) 帧")
                 frameGroups = groupFramesByScene(frames: frames, sceneCount: sceneSegments.count)
+                let thumbnails = representativeThumbnails(frames: frames, sceneCount: sceneSegments.count)
+                progress("按质量提取了 \(frames.count) 帧")
 
                 // 删除旧 clips（重索引场景）
                 // 先清理全局库中该视频的旧 clips，防止孤儿记录
                 if let globalDB = globalDB {
-                    try cleanGlobalClipsForVideo(
+                    removedGlobalClipIds = try deleteGlobalClipsForVideo(
                         folderPath: folderPath,
                         sourceVideoId: videoId,
                         globalDB: globalDB
@@ -509,6 +614,8 @@ public enum PipelineManager {
                         sql: "DELETE FROM clips WHERE video_id = ?",
                         arguments: [videoId]
                     )
+                    // clips 重建后旧的嵌入进度无效
+                    try StageArtifacts.clear(db, videoId: videoId, kinds: [.embedding])
                 }
 
                 // 创建 Clip 骨架记录
@@ -516,11 +623,12 @@ public enum PipelineManager {
                     videoId: videoId,
                     segments: sceneSegments,
                     frameGroups: frameGroups,
+                    thumbnails: thumbnails,
                     folderDB: folderDB
                 )
                 progress("创建了 \(clipsCreated) 个片段记录")
 
-                // 2f. 本地视觉分析 (Apple Vision 框架，零网络)
+                // 2f. 本地视觉分析 (Apple Vision 框架 + 像素统计 / 视觉特征，零网络)
                 progress("本地视觉分析中...")
                 let freshClips = try await folderDB.read { db in
                     try Clip.fetchAll(forVideo: videoId, in: db)
@@ -532,8 +640,20 @@ public enum PipelineManager {
                     let paths = index < frameGroups.count ? frameGroups[index] : []
                     guard !paths.isEmpty else { continue }
                     do {
-                        let localResult = try LocalVisionAnalyzer.analyzeClip(imagePaths: paths)
-                        try updateClipVision(clipId: clipId, result: localResult, folderDB: folderDB)
+                        let local = try LocalVisionAnalyzer.analyzeClipFrames(imagePaths: paths)
+                        try updateClipVision(clipId: clipId, result: local.result, folderDB: folderDB)
+                        if let signature = local.statistics?.colorSignature, signature.mass > 0 {
+                            try updateClipColorSignature(clipId: clipId, signature: signature, folderDB: folderDB)
+                        }
+                        if let extractor = visualExtractor,
+                           let vector = extractor.clipFeatures(imagePaths: paths) {
+                            try updateClipVisualEmbedding(
+                                clipId: clipId,
+                                data: EmbeddingUtils.serializeEmbedding(vector),
+                                model: extractor.name,
+                                folderDB: folderDB
+                            )
+                        }
                         localAnalyzed += 1
                     } catch {
                         progress("场景 \(index + 1) 本地分析失败: \(error.localizedDescription)")
@@ -572,14 +692,21 @@ public enum PipelineManager {
             sttAvailable = await isSttAvailable(whisperKit: whisperKit)
         }
         if sttAvailable && currentStage.isBefore(.sttDone) {
+            var sttAudioPath: String?
             do {
                 try Task.checkCancellation()
                 try updateVideoStatus(folderDB: folderDB, videoId: videoId, status: .sttRunning)
 
-                // 音频（使用 FFmpeg 阶段预提取的，或现场提取）
+                // 音频（使用 FFmpeg 阶段预提取的、上次中断留下的，或现场提取）
                 let audioPath: String
                 if let preExtracted = extractedAudioPath {
                     audioPath = preExtracted
+                } else if let audio = try loadArtifact(
+                    StageArtifacts.AudioFile.self, kind: .audio,
+                    videoId: videoId, fileHash: fileHash, folderDB: folderDB
+                ), audio.isIntact {
+                    audioPath = audio.path
+                    progress("复用已提取的音频")
                 } else {
                     try Task.checkCancellation()
                     progress("提取音频中...")
@@ -587,21 +714,35 @@ public enum PipelineManager {
                     try FileManager.default.createDirectory(
                         atPath: tmpDir, withIntermediateDirectories: true
                     )
-                    audioPath = (tmpDir as NSString).appendingPathComponent("video_\(videoId).wav")
+                    audioPath = StageArtifacts.audioPath(
+                        directory: tmpDir, folderPath: folderPath, videoId: videoId
+                    )
                     try AudioExtractor.extractAudio(
                         inputPath: videoPath,
                         outputPath: audioPath,
                         config: ffmpegConfig
                     )
+                    if let audio = StageArtifacts.AudioFile.capture(path: audioPath) {
+                        try saveArtifact(
+                            audio,
+                            kind: .audio, videoId: videoId, fileHash: fileHash, folderDB: folderDB
+                        )
+                    }
                 }
-                // 确保临时音频文件在成功或失败时都被清理
-                defer { try? FileManager.default.removeItem(atPath: audioPath) }
+                // 临时音频在阶段结束（成功或失败）后清理；取消时随检查点保留以便续传
+                sttAudioPath = audioPath
 
                 // 语言检测
                 var detectedLanguage: String?
                 var preTranscribedSegments: [TranscriptSegment]?
 
-                if let wk = whisperKit {
+                if let cached = try loadArtifact(
+                    StageArtifacts.Language.self, kind: .language,
+                    videoId: videoId, fileHash: fileHash, folderDB: folderDB
+                ) {
+                    detectedLanguage = cached.language
+                    progress("复用语言检测结果: \(cached.language ?? "未知")")
+                } else if let wk = whisperKit {
                     // WhisperKit 多采样投票检测
                     progress("检测语言中...")
                     let langResult = try await STTProcessor.detectLanguage(
@@ -626,6 +767,10 @@ public enum PipelineManager {
                         progress("检测到语言: \(lang)")
                     }
                 }
+                try saveArtifact(
+                    StageArtifacts.Language(language: detectedLanguage),
+                    kind: .language, videoId: videoId, fileHash: fileHash, folderDB: folderDB
+                )
 
                 // 转录（自动选择最优引擎）
                 let segments: [TranscriptSegment]
@@ -639,10 +784,17 @@ public enum PipelineManager {
                 } else {
                     try Task.checkCancellation()
                     progress("语音转录中...")
-                    let result = try await STTProcessor.transcribeWithBestAvailable(
+                    let result = try await transcribeResumable(
                         audioPath: audioPath,
+                        chunks: StageArtifacts.transcriptChunks(
+                            scenes: sceneSegments, duration: videoDuration
+                        ),
                         language: detectedLanguage,
                         whisperKit: whisperKit,
+                        videoId: videoId,
+                        fileHash: fileHash,
+                        folderDB: folderDB,
+                        ffmpegConfig: ffmpegConfig,
                         onProgress: onProgress
                     )
                     segments = result.segments
@@ -665,6 +817,7 @@ public enum PipelineManager {
                 try updateClipsTranscript(
                     videoId: videoId,
                     texts: mappedTexts,
+                    segments: segments,
                     folderDB: folderDB
                 )
 
@@ -681,6 +834,9 @@ public enum PipelineManager {
                 try updateVideoStatus(folderDB: folderDB, videoId: videoId, status: .sttDone)
 
             } catch is CancellationError {
+                if fileHash == nil, let sttAudioPath {
+                    try? FileManager.default.removeItem(atPath: sttAudioPath)
+                }
                 throw CancellationError()
             } catch {
                 // STT 失败不致命，记录错误继续
@@ -688,6 +844,10 @@ public enum PipelineManager {
                 // 仍然推进到 sttDone 以允许 vision 继续
                 try? updateVideoStatus(folderDB: folderDB, videoId: videoId, status: .sttDone)
             }
+            if let sttAudioPath {
+                try? FileManager.default.removeItem(atPath: sttAudioPath)
+            }
+            try? clearArtifacts(videoId: videoId, kinds: [.audio, .language, .transcript], folderDB: folderDB)
         } else if !sttAvailable && currentStage.isBefore(.sttDone) {
             // 跳过 STT
             try updateVideoStatus(folderDB: folderDB, videoId: videoId, status: .sttDone)
@@ -698,6 +858,8 @@ public enum PipelineManager {
         let hasVisionEngine = apiKey != nil || vlmContainer != nil
         if hasVisionEngine && currentStage.isBefore(.completed) {
             try updateVideoStatus(folderDB: folderDB, videoId: videoId, status: .visionRunning)
+            // 视觉结果会改写 clip 文本，之前的嵌入进度作废
+            try clearArtifacts(videoId: videoId, kinds: [.embedding], folderDB: folderDB)
 
             let clips = try await folderDB.read { db in
                 try Clip.fetchAll(forVideo: videoId, in: db)
@@ -728,6 +890,9 @@ public enum PipelineManager {
                 }
                 guard !paths.isEmpty else { continue }
 
+                // 本地像素统计缺失的 clip 仍向模型请求光线/色调
+                let fields = VisionField.modelFields(visionFields, localValue: clip.visionValue(for:))
+
                 do {
                     let result: AnalysisResult
                     if let key = apiKey {
@@ -737,7 +902,8 @@ public enum PipelineManager {
                         }
                         result = try await VisionAnalyzer.analyzeScene(
                             imagePaths: paths,
-                            apiKey: key
+                            apiKey: key,
+                            config: VisionAnalyzer.Config(fields: fields)
                         )
                         if let limiter = rateLimiter {
                             await limiter.reportSuccess()
@@ -746,7 +912,8 @@ public enum PipelineManager {
                         // 本地 VLM 分析
                         result = try await LocalVLMAnalyzer.analyzeClip(
                             imagePaths: paths,
-                            container: container
+                            container: container,
+                            fields: fields
                         )
                     } else {
                         continue
@@ -789,6 +956,11 @@ public enum PipelineManager {
             // 跳过 Gemini/VLM vision，直接标记完成（LocalVisionAnalyzer 已在步骤 2f 填充基础数据）
             try updateVideoStatus(folderDB: folderDB, videoId: videoId, status: .completed)
         }
+        if currentStage.isBefore(.completed) {
+            try? clearArtifacts(
+                videoId: videoId, kinds: [.scenes, .audio, .language, .transcript], folderDB: folderDB
+            )
+        }
 
         // 5. 向量嵌入（批量，非致命）
         var clipsEmbedded = 0
@@ -799,23 +971,41 @@ public enum PipelineManager {
                 try Clip.fetchAll(forVideo: videoId, in: db)
             }
 
+            // 断点：上次中断前已完成的 clip 跳过（按 clip_id 升序推进）
+            let resumeAfter = try loadArtifact(
+                StageArtifacts.EmbeddingProgress.self, kind: .embedding,
+                videoId: videoId, fileHash: fileHash, folderDB: folderDB
+            ).flatMap { $0.model == provider.name ? $0.lastClipId : nil } ?? 0
+            if resumeAfter > 0 {
+                progress("从断点继续嵌入（clip \(resumeAfter) 之后）")
+            }
+
             var clipTexts: [(clipId: Int64, text: String)] = []
-            for clip in allClips {
-                guard let cid = clip.clipId else { continue }
+            for clip in allClips.sorted(by: { ($0.clipId ?? 0) < ($1.clipId ?? 0) }) {
+                guard let cid = clip.clipId, cid > resumeAfter else { continue }
                 let text = EmbeddingUtils.composeClipText(clip: clip)
                 guard !text.isEmpty else { continue }
                 clipTexts.append((cid, text))
             }
 
             if !clipTexts.isEmpty {
+                // 状态已是 completed：进度检查点同时标记"嵌入未完成"，供下次跳过检测识别
+                try saveArtifact(
+                    StageArtifacts.EmbeddingProgress(model: provider.name, lastClipId: resumeAfter),
+                    kind: .embedding, videoId: videoId, fileHash: fileHash, folderDB: folderDB
+                )
+            }
+
+            for batchStart in stride(from: 0, to: clipTexts.count, by: embeddingCheckpointInterval) {
+                let batch = clipTexts[batchStart..<min(batchStart + embeddingCheckpointInterval, clipTexts.count)]
                 do {
                     try Task.checkCancellation()
-                    let vectors = try await provider.embedBatch(texts: clipTexts.map(\.text))
-                    for (index, vector) in vectors.enumerated() where index < clipTexts.count {
+                    let vectors = try await provider.embedBatch(texts: batch.map(\.text))
+                    for (offset, vector) in vectors.enumerated() where offset < batch.count {
                         try Task.checkCancellation()
                         let data = EmbeddingUtils.serializeEmbedding(vector)
                         try updateClipEmbedding(
-                            clipId: clipTexts[index].clipId, data: data,
+                            clipId: batch[batch.startIndex + offset].clipId, data: data,
                             model: provider.name, folderDB: folderDB
                         )
                         clipsEmbedded += 1
@@ -825,7 +1015,7 @@ public enum PipelineManager {
                 } catch {
                     // 批量失败，降级为逐个嵌入
                     progress("批量嵌入失败，逐个重试...")
-                    for (cid, text) in clipTexts {
+                    for (cid, text) in batch {
                         try Task.checkCancellation()
                         do {
                             let vector = try await provider.embed(text: text)
@@ -842,7 +1032,14 @@ public enum PipelineManager {
                         }
                     }
                 }
+                if let last = batch.last {
+                    try saveArtifact(
+                        StageArtifacts.EmbeddingProgress(model: provider.name, lastClipId: last.clipId),
+                        kind: .embedding, videoId: videoId, fileHash: fileHash, folderDB: folderDB
+                    )
+                }
             }
+            try clearArtifacts(videoId: videoId, kinds: [.embedding], folderDB: folderDB)
             progress("嵌入完成: \(clipsEmbedded)/\(allClips.count)")
         }
 
@@ -855,7 +1052,7 @@ public enum PipelineManager {
                 folderPath: folderPath,
                 folderDB: folderDB,
                 globalDB: globalDB
-            )
+            ).addingRemovedClipIds(removedGlobalClipIds)
             syncResult = sr
             progress("同步完成: \(sr.syncedVideos) 视频, \(sr.syncedClips) 片段")
         }
@@ -867,12 +1064,240 @@ public enum PipelineManager {
             clipsEmbedded: clipsEmbedded,
             srtPath: srtPath,
             syncResult: syncResult,
-            sttSkippedNoAudio: skipSttBecauseNoAudio
+            sttSkippedNoAudio: skipSttBecauseNoAudio,
+            removedGlobalClipIds: removedGlobalClipIds
         )
     }
 
+    // MARK: - 色彩签名补算
+
+    /// 补算色彩签名结果
+    public struct ColorSignatureBackfill: Sendable, Equatable {
+        /// 写入签名的 clip 数
+        public var updated = 0
+        /// 缩略图缺失或无法解码而跳过的 clip 数
+        public var skipped = 0
+    }
+
+    /// 为缺少色彩签名的 clip 从代表缩略图补算签名
+    ///
+    /// 签名功能上线前索引的素材没有 `color_signature`，调色板检索查不到；
+    /// 不重跑索引流程，只读缩略图统计像素。分桶方式调整后用 `force` 全部重算。
+    /// 每 `batchSize` 个 clip 提交一次，完成后需同步全局库（`force: true`）。
+    ///
+    /// - Parameters:
+    ///   - folderDB: 文件夹级数据库连接
+    ///   - force: 重算已有签名的 clip
+    ///   - batchSize: 每次写事务的 clip 数
+    ///   - onProgress: 进度回调（已处理数, 总数）
+    @discardableResult
+    public static func backfillColorSignatures(
+        folderDB: DatabaseWriter,
+        force: Bool = false,
+        batchSize: Int = 100,
+        onProgress: ((Int, Int) -> Void)? = nil
+    ) throws -> ColorSignatureBackfill {
+        let targets = try folderDB.read { db in
+            try Row.fetchAll(db, sql: """
+                SELECT clip_id, thumbnail_path FROM clips
+                \(force ? "" : "WHERE color_signature IS NULL")
+                ORDER BY clip_id
+                """).map { (clipId: $0["clip_id"] as Int64, path: $0["thumbnail_path"] as String?) }
+        }
+
+        var result = ColorSignatureBackfill()
+        for start in stride(from: 0, to: targets.count, by: max(1, batchSize)) {
+            let batch = targets[start..<min(start + max(1, batchSize), targets.count)]
+            // 解码在事务外
+            var signatures: [(Int64, Data)] = []
+            for target in batch {
+                guard let path = target.path,
+                      let signature = PixelStatistics.analyze(path: path)?.colorSignature,
+                      signature.mass > 0 else {
+                    result.skipped += 1
+                    continue
+                }
+                signatures.append((target.clipId, signature.data))
+            }
+            try folderDB.write { db in
+                for (clipId, data) in signatures {
+                    try db.execute(
+                        sql: "UPDATE clips SET color_signature = ? WHERE clip_id = ?",
+                        arguments: [data, clipId]
+                    )
+                }
+            }
+            result.updated += signatures.count
+            onProgress?(start + batch.count, targets.count)
+        }
+        return result
+    }
+
     // MARK: - 内部辅助方法
 
+    /// 嵌入阶段每提交一次进度检查点处理的 clip 数
+    static let embeddingCheckpointInterval = 32
+
+    /// 读取阶段产物（视频无哈希时不启用检查点，返回 nil）
+    static func loadArtifact<T: Decodable>(
+        _ type: T.Type,
+        kind: StageArtifacts.Kind,
+        unit: Int = 0,
+        videoId: Int64,
+        fileHash: String?,
+        folderDB: DatabaseWriter
+    ) throws -> T? {
+        guard let fileHash else { return nil }
+        return try folderDB.read { db in
+            try StageArtifacts.load(db, type, kind: kind, unit: unit, videoId: videoId, fileHash: fileHash)
+        }
+    }
+
+    /// 提交阶段产物（视频无哈希时跳过）
+    static func saveArtifact<T: Encodable>(
+        _ value: T,
+        kind: StageArtifacts.Kind,
+        unit: Int = 0,
+        videoId: Int64,
+        fileHash: String?,
+        folderDB: DatabaseWriter
+    ) throws {
+        guard let fileHash else { return }
+        try folderDB.write { db in
+            try StageArtifacts.save(db, value, kind: kind, unit: unit, videoId: videoId, fileHash: fileHash)
+        }
+    }
+
+    /// 清除阶段产物（引用的临时音频在事务提交后删除）
+    static func clearArtifacts(
+        videoId: Int64,
+        kinds: [StageArtifacts.Kind]? = nil,
+        folderDB: DatabaseWriter
+    ) throws {
+        let doomed = try folderDB.write { db in
+            try StageArtifacts.clear(db, videoId: videoId, kinds: kinds)
+        }
+        StageArtifacts.removeFiles(doomed)
+    }
+
+    /// 分块转录，每完成一块即提交检查点
+    ///
+    /// 已提交的分块直接复用；只有一个分块时整段转录（不截取）。
+    /// 已提交分块的边界与当前规划不一致（场景列表变化）时全部作废重来。
+    ///
+    /// - Returns: 合并后的转录片段（重新编号）与使用的引擎
+    static func transcribeResumable(
+        audioPath: String,
+        chunks: [(start: Double, end: Double)],
+        language: String?,
+        whisperKit: WhisperKit?,
+        videoId: Int64,
+        fileHash: String?,
+        folderDB: DatabaseWriter,
+        ffmpegConfig: FFmpegConfig = .default,
+        onProgress: (@Sendable (String) -> Void)? = nil
+    ) async throws -> (segments: [TranscriptSegment], engine: String) {
+        let progress = onProgress ?? { _ in }
+
+        var committed: [Int: StageArtifacts.TranscriptChunk] = [:]
+        if let fileHash {
+            let stored = try folderDB.read { db in
+                try StageArtifacts.loadAll(
+                    db, StageArtifacts.TranscriptChunk.self, kind: .transcript,
+                    videoId: videoId, fileHash: fileHash
+                )
+            }
+            let aligned = stored.allSatisfy { unit, chunk in
+                unit < chunks.count
+                    && abs(chunks[unit].start - chunk.start) < 0.001
+                    && abs(chunks[unit].end - chunk.end) < 0.001
+            }
+            if aligned {
+                committed = Dictionary(uniqueKeysWithValues: stored.map { ($0.unit, $0.value) })
+            } else {
+                try clearArtifacts(videoId: videoId, kinds: [.transcript], folderDB: folderDB)
+            }
+        }
+        if !committed.isEmpty {
+            progress("复用已转录分块 \(committed.count)/\(chunks.count)")
+        }
+
+        var engine = "检查点"
+        // 按空分块处理、但未提交检查点的模型加载失败（全部分块都如此时原样抛出）
+        var modelLoadFailure: Error?
+        for (unit, range) in chunks.enumerated() where committed[unit] == nil {
+            try Task.checkCancellation()
+            var segments: [TranscriptSegment]
+            var checkpoint = true
+            if chunks.count == 1 {
+                let result = try await STTProcessor.transcribeWithBestAvailable(
+                    audioPath: audioPath,
+                    language: language,
+                    whisperKit: whisperKit,
+                    onProgress: onProgress
+                )
+                segments = result.segments
+                engine = result.engine
+            } else {
+                progress("转录分块 \(unit + 1)/\(chunks.count)...")
+                let slicePath = (audioPath as NSString).deletingPathExtension + "_part\(unit).wav"
+                defer { try? FileManager.default.removeItem(atPath: slicePath) }
+                try AudioExtractor.extractSlice(
+                    inputPath: audioPath,
+                    outputPath: slicePath,
+                    start: range.start,
+                    duration: range.end - range.start,
+                    config: ffmpegConfig
+                )
+                do {
+                    let result = try await STTProcessor.transcribeWithBestAvailable(
+                        audioPath: slicePath,
+                        language: language,
+                        whisperKit: whisperKit
+                    )
+                    segments = result.segments
+                    engine = result.engine
+                } catch STTError.emptyTranscription {
+                    // 静音分块
+                    segments = []
+                } catch STTError.modelLoadFailed(let detail) where whisperKit == nil {
+                    // SpeechAnalyzer 对静音分块也报告 modelLoadFailed，且无 WhisperKit 可回退。
+                    // 无法与真正的加载失败区分：本次按空分块合并，但不提交检查点，
+                    // 下次运行重新转录该分块，而不是永久记为无台词
+                    segments = []
+                    checkpoint = false
+                    modelLoadFailure = STTError.modelLoadFailed(detail: detail)
+                }
+                segments = segments.map {
+                    TranscriptSegment(
+                        index: $0.index,
+                        startTime: $0.startTime + range.start,
+                        endTime: $0.endTime + range.start,
+                        text: $0.text
+                    )
+                }
+            }
+
+            let chunk = StageArtifacts.TranscriptChunk(start: range.start, end: range.end, segments: segments)
+            if checkpoint {
+                try saveArtifact(chunk, kind: .transcript, unit: unit, videoId: videoId, fileHash: fileHash, folderDB: folderDB)
+            }
+            committed[unit] = chunk
+        }
+
+        let merged = (0..<chunks.count).flatMap { committed[$0]?.segments ?? [] }
+        guard !merged.isEmpty else { throw modelLoadFailure ?? STTError.emptyTranscription }
+        let segments = merged.enumerated().map { offset, segment in
+            TranscriptSegment(
+                index: offset + 1,
+                startTime: segment.startTime,
+                endTime: segment.endTime,
+                text: segment.text
+            )
+        }
+        return (segments, engine)
+    }
+
     /// 清理全局库中指定视频的旧 clips
     ///
     /// 在重索引视频时调用，防止旧 source_clip_id 在全局库中残留为孤儿记录。
@@ -888,19 +1313,39 @@ public enum PipelineManager {
         sourceVideoId: Int64,
         globalDB: DatabaseWriter
     ) throws -> Int {
+        try deleteGlobalClipsForVideo(
+            folderPath: folderPath,
+            sourceVideoId: sourceVideoId,
+            globalDB: globalDB
+        ).count
+    }
+
+    /// 清理全局库中指定视频的旧 clips，并返回被删除的全局 clip_id
+    ///
+    /// 返回值供 VectorStore 等派生索引做增量移除（见 `SyncEngine.SyncResult.removedClipIds`）。
+    static func deleteGlobalClipsForVideo(
+        folderPath: String,
+        sourceVideoId: Int64,
+        globalDB: DatabaseWriter
+    ) throws -> [Int64] {
         try globalDB.write { db in
             let globalVideoRow = try Row.fetchOne(db, sql: """
                 SELECT video_id FROM videos
                 WHERE source_folder = ? AND source_video_id = ?
                 """, arguments: [folderPath, sourceVideoId])
             guard let globalVideoId: Int64 = globalVideoRow?["video_id"] else {
-                return 0
+                return []
             }
+            let clipIds = try Int64.fetchAll(
+                db,
+                sql: "SELECT clip_id FROM clips WHERE video_id = ?",
+                arguments: [globalVideoId]
+            )
             try db.execute(
                 sql: "DELETE FROM clips WHERE video_id = ?",
                 arguments: [globalVideoId]
             )
-            return db.changesCount
+            return clipIds
         }
     }
 
@@ -932,19 +1377,16 @@ public enum PipelineManager {
 
         // 获取文件信息
         let fileName = (videoPath as NSString).lastPathComponent
-        let attrs = try? FileManager.default.attributesOfItem(atPath: videoPath)
-        let fileSize = attrs?[.size] as? Int64
-        let fileMtime = (attrs?[.modificationDate] as? Date)
-            .map { Clip.utcFormatter.string(from: $0) }
+        let fileStat = Timestamp.stat(path: videoPath)
 
         // 插入新记录
         var video = Video(
             folderId: folderId,
             filePath: videoPath,
             fileName: fileName,
-            fileSize: fileSize,
-            fileModified: fileMtime,
-            createdAt: Clip.sqliteDatetime()
+            fileSize: fileStat?.size,
+            fileModifiedNs: fileStat?.modified,
+            createdAtNs: Timestamp.now()
         )
         try folderDB.write { db in
             try video.insert(db)
@@ -970,9 +1412,9 @@ public enum PipelineManager {
         try folderDB.write { db in
             try db.execute(sql: """
                 UPDATE videos SET index_status = ?, index_error = ?,
-                    indexed_at = CASE WHEN ? = 'completed' THEN datetime('now') ELSE indexed_at END
+                    indexed_at_ns = CASE WHEN ? = 'completed' THEN ? ELSE indexed_at_ns END
                 WHERE video_id = ?
-                """, arguments: [status.rawValue, error, status.rawValue, videoId])
+                """, arguments: [status.rawValue, error, status.rawValue, Timestamp.now(), videoId])
         }
     }
 
@@ -991,18 +1433,26 @@ public enum PipelineManager {
     }
 
     /// 创建 Clip 骨架记录（含缩略图路径）
+    ///
+    /// - Parameter thumbnails: 已选好的各场景缩略图（nil = 按 `selectThumbnail` 现场挑选）
     @discardableResult
     static func createClipRecords(
         videoId: Int64,
         segments: [SceneSegment],
         frameGroups: [[String]],
+        thumbnails: [String?]? = nil,
         folderDB: DatabaseWriter
     ) throws -> Int {
         try folderDB.write { db in
             for (index, segment) in segments.enumerated() {
-                let thumbnail = index < frameGroups.count
-                    ? selectThumbnail(from: frameGroups[index])
-                    : nil
+                let thumbnail: String?
+                if let thumbnails, index < thumbnails.count {
+                    thumbnail = thumbnails[index]
+                } else {
+                    thumbnail = index < frameGroups.count
+                        ? selectThumbnail(from: frameGroups[index])
+                        : nil
+                }
 
                 var clip = Clip(
                     videoId: videoId,
@@ -1016,13 +1466,15 @@ public enum PipelineManager {
         }
     }
 
-    /// 更新 clips 的 transcript 字段
+    /// 更新 clips 的 transcript 字段，并以同一事务写入带时间码的转录片段
     static func updateClipsTranscript(
         videoId: Int64,
         texts: [String?],
+        segments: [TranscriptSegment],
         folderDB: DatabaseWriter
     ) throws {
         try folderDB.write { db in
+            try TranscriptIndex.replaceSegments(db, videoId: videoId, segments: segments)
             let clips = try Clip.fetchAll(forVideo: videoId, in: db)
             for (index, clip) in clips.enumerated() {
                 guard index < texts.count, let text = texts[index], !text.isEmpty else { continue }
@@ -1063,6 +1515,35 @@ public enum PipelineManager {
         }
     }
 
+    /// 更新 clip 的色彩签名
+    static func updateClipColorSignature(
+        clipId: Int64,
+        signature: ColorSignature,
+        folderDB: DatabaseWriter
+    ) throws {
+        try folderDB.write { db in
+            try db.execute(
+                sql: "UPDATE clips SET color_signature = ? WHERE clip_id = ?",
+                arguments: [signature.data, clipId]
+            )
+        }
+    }
+
+    /// 更新 clip 的视觉特征向量
+    static func updateClipVisualEmbedding(
+        clipId: Int64,
+        data: Data,
+        model: String,
+        folderDB: DatabaseWriter
+    ) throws {
+        try folderDB.write { db in
+            try db.execute(
+                sql: "UPDATE clips SET visual_embedding = ?, visual_model = ? WHERE clip_id = ?",
+                arguments: [data, model, clipId]
+            )
+        }
+    }
+
     /// 更新 clip 的嵌入向量
     static func updateClipEmbedding(
         clipId: Int64,
@@ -0,0 +1,356 @@
+import Foundation
+import Accelerate
+
+/// 画面主色（CIELAB 聚类中心）
+public struct DominantColor: Sendable, Equatable {
+    /// L*（0-100）
+    public let l: Float
+    /// a*（绿 ← 0 → 红）
+    public let a: Float
+    /// b*（蓝 ← 0 → 黄）
+    public let b: Float
+    /// 聚类成员的平均 sRGB（0-255，用于命名与展示）
+    public let red: UInt8
+    public let green: UInt8
+    public let blue: UInt8
+    /// 像素占比（0-1）
+    public let weight: Float
+
+    /// 命名颜色（与 `LocalVisionAnalyzer.nearestColorName` 词表一致，便于搜索）
+    public var name: String {
+        LocalVisionAnalyzer.nearestColorName(r: red, g: green, b: blue)
+    }
+}
+
+/// 单帧（或多帧合并）的像素统计
+public struct ImageStatistics: Sendable, Equatable {
+    /// 主色（按占比降序）
+    public let dominantColors: [DominantColor]
+    /// 平均亮度（L* / 100，0-1）
+    public let brightness: Float
+    /// 对比度（L* 标准差 / 100）
+    public let contrast: Float
+    /// 相关色温估计（开尔文，由平均色度按 McCamy 公式计算）
+    public let colorTemperature: Float
+    /// 量化 Lab 直方图（调色板检索）
+    public let colorSignature: ColorSignature
+
+    /// `lighting` 字段：亮度等级，对比度 / 色温明显时追加描述
+    ///
+    /// 例: `"normal"`、`"dark, high contrast"`、`"bright, warm light"`
+    public var lighting: String {
+        var parts = [LocalVisionAnalyzer.classifyLighting(luminance: brightness)]
+        if contrast >= PixelStatistics.highContrast { parts.append("high contrast") }
+        if colorTemperature < PixelStatistics.warmBelow {
+            parts.append("warm light")
+        } else if colorTemperature > PixelStatistics.coolAbove {
+            parts.append("cool light")
+        }
+        return parts.joined(separator: ", ")
+    }
+
+    /// `colors` 字段：占比不低于阈值的命名主色，空格分隔（如 `"blue white gray"`）
+    public var colors: String? {
+        var seen = Set<String>()
+        let names = dominantColors
+            .filter { $0.weight >= PixelStatistics.minimumNamedWeight }
+            .map(\.name)
+            .filter { seen.insert($0).inserted }
+        return names.isEmpty ? nil : names.joined(separator: " ")
+    }
+}
+
+/// 像素统计分析器
+///
+/// 取代让视觉模型描述"光线 / 色调"：这些信息由像素统计即可确定性得出，
+/// 交给模型既花 token 又增加延迟，结果还不稳定。
+///
+/// 在缩小到 96px 的帧上用 vDSP / vForce 完成：
+/// - sRGB → 线性 → XYZ → CIELAB 的逐像素转换（向量化）
+/// - Lab 空间 k-means 主色聚类（按 L* 分位数确定性初始化，结果可复现）
+/// - 亮度（平均 L*）、对比度（L* 标准差）、色温（平均色度 → McCamy CCT）
+/// - 量化 Lab 直方图签名（`ColorSignature`，调色板检索）
+public enum PixelStatistics {
+
+    /// 分析时的最长边像素
+    static let analysisSize = 96
+
+    /// 主色聚类数
+    static let clusterCount = 5
+
+    /// k-means 最大迭代次数
+    static let maxIterations = 12
+
+    /// 对比度阈值（L* 标准差 / 100）
+    static let highContrast: Float = 0.28
+
+    /// 暖色温上限（K）
+    static let warmBelow: Float = 4000
+
+    /// 冷色温下限（K）
+    static let coolAbove: Float = 7500
+
+    /// 主色参与命名的最低占比
+    static let minimumNamedWeight: Float = 0.05
+
+    // MARK: - 公开接口
+
+    /// 读取图片并统计（无法解码时返回 nil）
+    public static func analyze(path: String) -> ImageStatistics? {
+        guard let image = ThumbnailService.decode(path: path, maxPixelSize: analysisSize) else { return nil }
+        return analyze(image)
+    }
+
+    /// 对 RGBA8 像素统计
+    public static func analyze(_ image: ThumbnailImage) -> ImageStatistics {
+        let count = image.width * image.height
+        guard count > 0 else {
+            return ImageStatistics(
+                dominantColors: [], brightness: 0, contrast: 0, colorTemperature: 6500,
+                colorSignature: ColorSignature(bins: .zero)
+            )
+        }
+        let lab = LabBuffer(image)
+
+        var meanL: Float = 0
+        var stdL: Float = 0
+        vDSP_normalize(lab.l, 1, nil, 1, &meanL, &stdL, vDSP_Length(count))
+
+        return ImageStatistics(
+            dominantColors: kMeans(lab, k: min(clusterCount, count)),
+            brightness: meanL / 100,
+            contrast: stdL / 100,
+            colorTemperature: correlatedColorTemperature(x: lab.meanX, y: lab.meanY, z: lab.meanZ),
+            colorSignature: ColorSignature(l: lab.l, a: lab.a, b: lab.b)
+        )
+    }
+
+    /// 合并同一 clip 多帧的统计（主色按帧平均占比合并，签名与数值取平均）
+    public static func combine(_ frames: [ImageStatistics]) -> ImageStatistics? {
+        guard !frames.isEmpty else { return nil }
+        let n = Float(frames.count)
+        let colors = frames
+            .flatMap { frame in
+                frame.dominantColors.map {
+                    DominantColor(l: $0.l, a: $0.a, b: $0.b,
+                                  red: $0.red, green: $0.green, blue: $0.blue,
+                                  weight: $0.weight / n)
+                }
+            }
+            .sorted { $0.weight > $1.weight }
+        return ImageStatistics(
+            dominantColors: colors,
+            brightness: frames.map(\.brightness).reduce(0, +) / n,
+            contrast: frames.map(\.contrast).reduce(0, +) / n,
+            colorTemperature: frames.map(\.colorTemperature).reduce(0, +) / n,
+            colorSignature: ColorSignature.average(frames.map(\.colorSignature)) ?? ColorSignature(bins: .zero)
+        )
+    }
+
+    // MARK: - 色彩空间转换
+
+    /// 平面化的 Lab 缓冲 + 原始 sRGB（0-1）
+    struct LabBuffer {
+        var l: [Float]
+        var a: [Float]
+        var b: [Float]
+        var red: [Float]
+        var green: [Float]
+        var blue: [Float]
+        var meanX: Float = 0
+        var meanY: Float = 0
+        var meanZ: Float = 0
+
+        init(_ image: ThumbnailImage) {
+            let count = image.width * image.height
+            let n = vDSP_Length(count)
+            var rawR = [Float](repeating: 0, count: count)
+            var rawG = [Float](repeating: 0, count: count)
+            var rawB = [Float](repeating: 0, count: count)
+            image.pixels.withUnsafeBufferPointer { px in
+                guard let base = px.baseAddress else { return }
+                vDSP_vfltu8(base, 4, &rawR, 1, n)
+                vDSP_vfltu8(base + 1, 4, &rawG, 1, n)
+                vDSP_vfltu8(base + 2, 4, &rawB, 1, n)
+            }
+            red = [Float](repeating: 0, count: count)
+            green = [Float](repeating: 0, count: count)
+            blue = [Float](repeating: 0, count: count)
+            var scale: Float = 1 / 255
+            vDSP_vsmul(rawR, 1, &scale, &red, 1, n)
+            vDSP_vsmul(rawG, 1, &scale, &green, 1, n)
+            vDSP_vsmul(rawB, 1, &scale, &blue, 1, n)
+
+            let lr = Self.linearize(red)
+            let lg = Self.linearize(green)
+            let lb = Self.linearize(blue)
+
+            // 线性 sRGB → XYZ（D65）
+            func mix(_ kr: Float, _ kg: Float, _ kb: Float) -> [Float] {
+                var out = [Float](repeating: 0, count: count)
+                var kr = kr, kg = kg, kb = kb
+                out.withUnsafeMutableBufferPointer { buffer in
+                    guard let o = buffer.baseAddress else { return }
+                    vDSP_vsmul(lr, 1, &kr, o, 1, n)
+                    vDSP_vsma(lg, 1, &kg, o, 1, o, 1, n)
+                    vDSP_vsma(lb, 1, &kb, o, 1, o, 1, n)
+                }
+                return out
+            }
+            let x = mix(0.4124564, 0.3575761, 0.1804375)
+            let y = mix(0.2126729, 0.7151522, 0.0721750)
+            let z = mix(0.0193339, 0.1191920, 0.9503041)
+            var mx: Float = 0, my: Float = 0, mz: Float = 0
+            vDSP_meanv(x, 1, &mx, n)
+            vDSP_meanv(y, 1, &my, n)
+            vDSP_meanv(z, 1, &mz, n)
+
+            // XYZ → Lab（以 D65 白点归一）
+            let fx = Self.labF(x, white: 0.95047)
+            let fy = Self.labF(y, white: 1.0)
+            let fz = Self.labF(z, white: 1.08883)
+
+            l = [Float](repeating: 0, count: count)
+            a = [Float](repeating: 0, count: count)
+            b = [Float](repeating: 0, count: count)
+            var difference = [Float](repeating: 0, count: count)
+            var k116: Float = 116, minus16: Float = -16, k500: Float = 500, k200: Float = 200
+            vDSP_vsmsa(fy, 1, &k116, &minus16, &l, 1, n)
+            vDSP_vsub(fy, 1, fx, 1, &difference, 1, n)    // fx - fy
+            vDSP_vsmul(difference, 1, &k500, &a, 1, n)
+            vDSP_vsub(fz, 1, fy, 1, &difference, 1, n)    // fy - fz
+            vDSP_vsmul(difference, 1, &k200, &b, 1, n)
+            meanX = mx
+            meanY = my
+            meanZ = mz
+        }
+
+        /// sRGB 传递函数逆变换
+        static func linearize(_ c: [Float]) -> [Float] {
+            var count = Int32(c.count)
+            var shifted = [Float](repeating: 0, count: c.count)
+            var k: Float = 1 / 1.055, offset: Float = 0.055 / 1.055
+            vDSP_vsmsa(c, 1, &k, &offset, &shifted, 1, vDSP_Length(c.count))
+            var exponent = [Float](repeating: 2.4, count: c.count)
+            var high = [Float](repeating: 0, count: c.count)
+            vvpowf(&high, &exponent, shifted, &count)
+            var out = high
+            for i in 0..<c.count where c[i] <= 0.04045 {
+                out[i] = c[i] / 12.92
+            }
+            return out
+        }
+
+        /// CIELAB f(t)
+        static func labF(_ v: [Float], white: Float) -> [Float] {
+            var count = Int32(v.count)
+            var t = [Float](repeating: 0, count: v.count)
+            var inv = 1 / white
+            vDSP_vsmul(v, 1, &inv, &t, 1, vDSP_Length(v.count))
+            var out = [Float](repeating: 0, count: v.count)
+            vvcbrtf(&out, t, &count)
+            let epsilon: Float = 216.0 / 24389.0
+            let kappa: Float = 24389.0 / 27.0
+            for i in 0..<v.count where t[i] <= epsilon {
+                out[i] = (kappa * t[i] + 16) / 116
+            }
+            return out
+        }
+    }
+
+    /// McCamy 近似：平均 XYZ → 相关色温（K），近黑画面返回 6500
+    static func correlatedColorTemperature(x: Float, y: Float, z: Float) -> Float {
+        let sum = x + y + z
+        guard sum > 1e-4 else { return 6500 }
+        let cx = x / sum
+        let cy = y / sum
+        guard abs(0.1858 - cy) > 1e-6 else { return 6500 }
+        let n = (cx - 0.3320) / (0.1858 - cy)
+        let cct = 449 * n * n * n + 3525 * n * n + 6823.3 * n + 5520.33
+        return min(25000, max(1000, cct))
+    }
+
+    // MARK: - k-means
+
+    /// Lab 空间 k-means
+    ///
+    /// 初始中心取 L* 排序后的等分位像素（确定性，同一帧结果稳定）；
+    /// 每轮对每个中心用 vDSP 计算全体像素的平方距离，再逐像素取最小。
+    static func kMeans(_ lab: LabBuffer, k: Int) -> [DominantColor] {
+        let count = lab.l.count
+        let n = vDSP_Length(count)
+        guard k > 0 else { return [] }
+
+        let byLightness = (0..<count).sorted { lab.l[$0] < lab.l[$1] }
+        var centers: [(l: Float, a: Float, b: Float)] = (0..<k).map { i in
+            let p = byLightness[min(count - 1, (2 * i + 1) * count / (2 * k))]
+            return (lab.l[p], lab.a[p], lab.b[p])
+        }
+
+        var assignment = [Int](repeating: -1, count: count)
+        var best = [Float](repeating: 0, count: count)
+        var distance = [Float](repeating: 0, count: count)
+        var scratch = [Float](repeating: 0, count: count)
+
+        for _ in 0..<maxIterations {
+            // 分配：逐中心计算平方距离，保留最近中心
+            var next = [Int](repeating: 0, count: count)
+            for (c, center) in centers.enumerated() {
+                distance.withUnsafeMutableBufferPointer { buffer in
+                    guard let d = buffer.baseAddress else { return }
+                    vDSP_vclr(d, 1, n)
+                    for (channel, value) in [(lab.l, center.l), (lab.a, center.a), (lab.b, center.b)] {
+                        var negated = -value
+                        vDSP_vsadd(channel, 1, &negated, &scratch, 1, n)
+                        vDSP_vma(scratch, 1, scratch, 1, d, 1, d, 1, n)
+                    }
+                }
+                if c == 0 {
+                    best = distance
+                } else {
+                    for i in 0..<count where distance[i] < best[i] {
+                        best[i] = distance[i]
+                        next[i] = c
+                    }
+                }
+            }
+            guard next != assignment else { break }
+            assignment = next
+
+            // 更新
+            var sums = [(l: Float, a: Float, b: Float, n: Float)](repeating: (0, 0, 0, 0), count: k)
+            for i in 0..<count {
+                let c = assignment[i]
+                sums[c].l += lab.l[i]
+                sums[c].a += lab.a[i]
+                sums[c].b += lab.b[i]
+                sums[c].n += 1
+            }
+            for c in 0..<k where sums[c].n > 0 {
+                centers[c] = (sums[c].l / sums[c].n, sums[c].a / sums[c].n, sums[c].b / sums[c].n)
+            }
+        }
+
+        // 汇总：占比 + 成员平均 sRGB
+        var members = [(r: Float, g: Float, b: Float, n: Float)](repeating: (0, 0, 0, 0), count: k)
+        for i in 0..<count {
+            let c = assignment[i]
+            members[c].r += lab.red[i]
+            members[c].g += lab.green[i]
+            members[c].b += lab.blue[i]
+            members[c].n += 1
+        }
+        func byte(_ v: Float) -> UInt8 { UInt8(max(0, min(255, (v * 255).rounded()))) }
+        return (0..<k)
+            .filter { members[$0].n > 0 }
+            .map { c in
+                let m = members[c]
+                return DominantColor(
+                    l: centers[c].l, a: centers[c].a, b: centers[c].b,
+                    red: byte(m.r / m.n), green: byte(m.g / m.n), blue: byte(m.b / m.n),
+                    weight: m.n / Float(count)
+                )
+            }
+            .sorted { $0.weight > $1.weight }
+    }
+}
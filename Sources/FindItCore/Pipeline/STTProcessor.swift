@@ -7,7 +7,7 @@ import WhisperKit
 /// 转录片段（项目内部类型，不依赖 WhisperKit）
 ///
 /// 表示一段带时间戳的转录文本，用于 SRT 生成和 Clip 映射。
-public struct TranscriptSegment: Equatable, Sendable {
+public struct TranscriptSegment: Equatable, Codable, Sendable {
     /// 片段序号（1-based，用于 SRT 编号）
     public let index: Int
     /// 起始时间（秒）
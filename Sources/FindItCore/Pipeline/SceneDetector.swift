@@ -1,7 +1,7 @@
 import Foundation
 
 /// 场景片段
-public struct SceneSegment: Equatable {
+public struct SceneSegment: Equatable, Codable {
     /// 场景起始时间（秒）
     public let startTime: Double
     /// 场景结束时间（秒）
@@ -0,0 +1,277 @@
+import Foundation
+import GRDB
+import CxxHash
+
+/// 管线阶段产物检查点
+///
+/// `videos.index_status` 只记录粗粒度阶段；阶段内部的中间结果不落盘时，
+/// 两小时素材在 STT 中途崩溃或系统睡眠会从解码、转录重新开始。
+/// 本模块把这些产物逐单元提交到文件夹库 `stage_artifacts` 表：
+///
+/// | kind         | unit     | payload                      |
+/// |--------------|----------|------------------------------|
+/// | `scenes`     | 0        | 场景切点 + 时长              |
+/// | `audio`      | 0        | 已提取 WAV 路径 + 大小 + 哈希 |
+/// | `language`   | 0        | 检测出的语言                 |
+/// | `transcript` | 分块序号 | 该分块的转录片段             |
+/// | `embedding`  | 0        | 嵌入模型 + 最后完成的 clip   |
+///
+/// 每行记录写入时的 `file_hash`，读取时哈希不一致即视为无效（文件内容已变），
+/// 阶段完成后由管线清除对应产物，表中只保留进行中的视频。
+///
+/// 清除函数只改数据库并返回需删除的临时文件，由调用方在事务提交后删除
+/// （或写入 `file_garbage`），文件操作不在写事务内执行。
+public enum StageArtifacts {
+
+    /// 产物类型
+    public enum Kind: String, CaseIterable, Sendable {
+        case scenes
+        case audio
+        case language
+        case transcript
+        case embedding
+    }
+
+    /// 场景切点
+    public struct SceneCuts: Codable, Equatable {
+        public let duration: Double
+        public let scenes: [SceneSegment]
+        /// 是否有音轨（nil = 检测时未提取音频，未知）
+        public let hasAudio: Bool?
+
+        public init(duration: Double, scenes: [SceneSegment], hasAudio: Bool? = nil) {
+            self.duration = duration
+            self.scenes = scenes
+            self.hasAudio = hasAudio
+        }
+    }
+
+    /// 已提取的音频文件
+    public struct AudioFile: Codable, Equatable {
+        public let path: String
+        public let size: Int64
+        /// 内容 xxHash3-128（nil = 旧版本检查点，不可复用）
+        public let contentHash: String?
+
+        public init(path: String, size: Int64, contentHash: String?) {
+            self.path = path
+            self.size = size
+            self.contentHash = contentHash
+        }
+
+        /// 记录刚提取完成的音频（文件不存在或无法读取时返回 nil）
+        public static func capture(path: String) -> AudioFile? {
+            guard let size = Timestamp.stat(path: path)?.size,
+                  let hash = try? FileHasher.hash128(filePath: path) else { return nil }
+            return AudioFile(path: path, size: size, contentHash: hash)
+        }
+
+        /// 文件仍存在，大小与内容哈希都一致
+        ///
+        /// 大小先行快速排除中途中断的半截 WAV；哈希排除同路径被其他提取覆盖的文件。
+        public var isIntact: Bool {
+            guard let contentHash, Timestamp.stat(path: path)?.size == size else { return false }
+            return FileHasher.verify(filePath: path, expectedHash: contentHash) == .valid
+        }
+    }
+
+    /// 语言检测结果（nil = 已检测但未识别出语言）
+    public struct Language: Codable, Equatable {
+        public let language: String?
+
+        public init(language: String?) {
+            self.language = language
+        }
+    }
+
+    /// 转录分块（时间为整段音频上的绝对秒数）
+    public struct TranscriptChunk: Codable, Equatable {
+        public let start: Double
+        public let end: Double
+        public let segments: [TranscriptSegment]
+
+        public init(start: Double, end: Double, segments: [TranscriptSegment]) {
+            self.start = start
+            self.end = end
+            self.segments = segments
+        }
+    }
+
+    /// 嵌入进度（按 clip_id 升序处理）
+    public struct EmbeddingProgress: Codable, Equatable {
+        public let model: String
+        public let lastClipId: Int64
+
+        public init(model: String, lastClipId: Int64) {
+            self.model = model
+            self.lastClipId = lastClipId
+        }
+    }
+
+    // MARK: - 读写
+
+    /// 提交产物（同一 video/kind/unit 覆盖）
+    public static func save<T: Encodable>(
+        _ db: Database,
+        _ value: T,
+        kind: Kind,
+        unit: Int = 0,
+        videoId: Int64,
+        fileHash: String
+    ) throws {
+        let payload = String(decoding: try JSONEncoder().encode(value), as: UTF8.self)
+        try db.execute(sql: """
+            INSERT OR REPLACE INTO stage_artifacts
+                (video_id, kind, unit, file_hash, payload, updated_at_ns)
+            VALUES (?, ?, ?, ?, ?, ?)
+            """, arguments: [videoId, kind.rawValue, unit, fileHash, payload, Timestamp.now()])
+    }
+
+    /// 读取产物（不存在、哈希不匹配或无法解码时返回 nil）
+    public static func load<T: Decodable>(
+        _ db: Database,
+        _ type: T.Type,
+        kind: Kind,
+        unit: Int = 0,
+        videoId: Int64,
+        fileHash: String
+    ) throws -> T? {
+        let payload = try String.fetchOne(db, sql: """
+            SELECT payload FROM stage_artifacts
+            WHERE video_id = ? AND kind = ? AND unit = ? AND file_hash = ?
+            """, arguments: [videoId, kind.rawValue, unit, fileHash])
+        return payload.flatMap { try? JSONDecoder().decode(T.self, from: Data($0.utf8)) }
+    }
+
+    /// 读取某类产物的全部单元（按 unit 升序）
+    public static func loadAll<T: Decodable>(
+        _ db: Database,
+        _ type: T.Type,
+        kind: Kind,
+        videoId: Int64,
+        fileHash: String
+    ) throws -> [(unit: Int, value: T)] {
+        let rows = try Row.fetchAll(db, sql: """
+            SELECT unit, payload FROM stage_artifacts
+            WHERE video_id = ? AND kind = ? AND file_hash = ?
+            ORDER BY unit
+            """, arguments: [videoId, kind.rawValue, fileHash])
+        return rows.compactMap { row in
+            let payload: String = row["payload"]
+            guard let value = try? JSONDecoder().decode(T.self, from: Data(payload.utf8)) else { return nil }
+            return (row["unit"], value)
+        }
+    }
+
+    /// 清除产物（kinds 为 nil 时清除该视频全部产物）
+    ///
+    /// - Returns: 被清除产物引用的临时音频文件（事务提交后由调用方删除）
+    @discardableResult
+    public static func clear(_ db: Database, videoId: Int64, kinds: [Kind]? = nil) throws -> [String] {
+        let kinds = kinds ?? Kind.allCases
+        var doomed: [String] = []
+        if kinds.contains(.audio) {
+            doomed = try audioPaths(db, sql: """
+                SELECT payload FROM stage_artifacts WHERE video_id = ? AND kind = 'audio'
+                """, arguments: [videoId])
+        }
+        let placeholders = kinds.map { _ in "?" }.joined(separator: ", ")
+        var arguments: StatementArguments = [videoId]
+        arguments += StatementArguments(kinds.map(\.rawValue))
+        try db.execute(
+            sql: "DELETE FROM stage_artifacts WHERE video_id = ? AND kind IN (\(placeholders))",
+            arguments: arguments
+        )
+        return doomed
+    }
+
+    /// 清除哈希与当前文件不一致的产物（文件内容变更后的残留）
+    ///
+    /// - Returns: 被清除产物引用的临时音频文件（事务提交后由调用方删除）
+    @discardableResult
+    public static func discardStale(_ db: Database, videoId: Int64, fileHash: String) throws -> [String] {
+        let doomed = try audioPaths(db, sql: """
+            SELECT payload FROM stage_artifacts
+            WHERE video_id = ? AND kind = 'audio' AND file_hash <> ?
+            """, arguments: [videoId, fileHash])
+        try db.execute(sql: """
+            DELETE FROM stage_artifacts WHERE video_id = ? AND file_hash <> ?
+            """, arguments: [videoId, fileHash])
+        return doomed
+    }
+
+    /// 视频全部产物引用的临时音频文件（删除视频前在同一事务内读取）
+    public static func audioPaths(_ db: Database, videoIds: [Int64]) throws -> [String] {
+        guard !videoIds.isEmpty else { return [] }
+        let placeholders = videoIds.map { _ in "?" }.joined(separator: ", ")
+        return try audioPaths(db, sql: """
+            SELECT payload FROM stage_artifacts WHERE kind = 'audio' AND video_id IN (\(placeholders))
+            """, arguments: StatementArguments(videoIds))
+    }
+
+    /// 删除 `clear` / `discardStale` 返回的临时文件（在写事务外调用）
+    public static func removeFiles(_ paths: [String]) {
+        for path in paths {
+            try? FileManager.default.removeItem(atPath: path)
+        }
+    }
+
+    // MARK: - 音频路径
+
+    /// 临时 WAV 路径：`<directory>/audio_<文件夹路径哈希>_<videoId>.wav`
+    ///
+    /// video_id 只在单个文件夹库内唯一，文件名带上文件夹路径哈希，
+    /// 避免不同文件夹的同号视频共用临时目录时互相覆盖。
+    public static func audioPath(directory: String, folderPath: String, videoId: Int64) -> String {
+        let folderKey = folderPath.utf8CString.withUnsafeBytes { raw in
+            // 不含末尾 NUL
+            UInt64(XXH3_64bits(raw.baseAddress, raw.count - 1))
+        }
+        let name = String(format: "audio_%016llx_%lld.wav", folderKey, videoId)
+        return (directory as NSString).appendingPathComponent(name)
+    }
+
+    // MARK: - 转录分块
+
+    /// 单个转录分块的目标时长（秒）
+    public static let transcriptChunkTarget: Double = 600
+
+    /// 规划转录分块
+    ///
+    /// 在 `[start + target, start + 2 × target]` 内的第一个场景切点处断开
+    /// （切点通常是停顿，不易截断句子），区间内无切点时按 target 硬切。
+    /// 不超过 1.5 × target 的素材只有一个分块（整段转录，与不分块时行为一致）。
+    /// 场景列表来自检查点或 clips 表，同一视频多次调用结果一致，保证恢复时单元对齐。
+    ///
+    /// - Returns: `(start, end)` 数组，首尾相接覆盖 `[0, duration]`
+    public static func transcriptChunks(
+        scenes: [SceneSegment],
+        duration: Double,
+        target: Double = transcriptChunkTarget
+    ) -> [(start: Double, end: Double)] {
+        let total = duration > 0 ? duration : (scenes.map(\.endTime).max() ?? 0)
+        guard target > 0, total > target * 1.5 else { return [(0, total)] }
+
+        let cutPoints = scenes.map(\.endTime).filter { $0 > 0 && $0 < total }.sorted()
+        var cuts: [Double] = []
+        var start = 0.0
+        var i = 0
+        while total - start > target * 1.5 {
+            let lower = start + target
+            let upper = start + target * 2
+            while i < cutPoints.count && cutPoints[i] < lower { i += 1 }
+            let cut = (i < cutPoints.count && cutPoints[i] <= upper) ? cutPoints[i] : lower
+            cuts.append(cut)
+            start = cut
+        }
+        return zip([0] + cuts, cuts + [total]).map { ($0, $1) }
+    }
+
+    // MARK: - Private
+
+    private static func audioPaths(_ db: Database, sql: String, arguments: StatementArguments) throws -> [String] {
+        try String.fetchAll(db, sql: sql, arguments: arguments).compactMap { payload in
+            (try? JSONDecoder().decode(AudioFile.self, from: Data(payload.utf8)))?.path
+        }
+    }
+}
@@ -4,144 +4,195 @@ import GRDB
 /// 视频记录管理（删除 + 清理）
 ///
 /// 负责从文件夹库和全局库中删除视频记录，
-/// 并清理关联的缩略图目录和 SRT 文件。
+/// 关联的缩略图目录和 SRT 文件交由 `FileGarbageCollector` 后台回收。
 public enum VideoManager {
 
     /// 删除结果
     public struct RemovalResult: Sendable {
         /// 从文件夹库删除的视频数
         public let removedFromFolder: Int
+        /// 从全局库删除的 clip_id（全局库 ID，供 VectorStore 等派生索引增量移除）
+        public let removedGlobalClipIds: [Int64]
+
         /// 从全局库删除的 clips 数
-        public let removedGlobalClips: Int
+        public var removedGlobalClips: Int { removedGlobalClipIds.count }
+
+        static let empty = RemovalResult(removedFromFolder: 0, removedGlobalClipIds: [])
     }
 
     /// 删除单个视频及其所有关联数据
     ///
-    /// 执行顺序:
-    /// 1. 在文件夹库中查找视频记录
-    /// 2. 从全局库删除对应的 clips 和 videos 记录
-    /// 3. 从文件夹库删除视频记录（clips 通过 ON DELETE CASCADE 自动删除）
-    /// 4. 清理缩略图目录
-    /// 5. 清理 SRT 文件（仅当 SRT 不在视频同目录时）
+    /// 等价于只含一个路径的 `removeVideos`。
     ///
     /// - Parameters:
     ///   - videoPath: 被删除的视频文件绝对路径
     ///   - folderPath: 所属监控文件夹路径
     ///   - folderDB: 文件夹级数据库连接
     ///   - globalDB: 全局搜索索引连接（nil 时跳过全局库清理）
+    ///   - collector: 文件回收器（nil = 只入队，不启动后台回收）
     /// - Returns: true 表示找到并删除了视频记录，false 表示未找到
     @discardableResult
     public static func removeVideo(
         videoPath: String,
         folderPath: String,
         folderDB: DatabaseWriter,
-        globalDB: DatabaseWriter? = nil
+        globalDB: DatabaseWriter? = nil,
+        collector: FileGarbageCollector? = .shared
     ) throws -> Bool {
-        // 1. 查找视频记录
-        guard let video = try folderDB.read({ db in
-            try Video.fetchByPath(db, path: videoPath)
-        }) else {
-            return false
-        }
-
-        guard let videoId = video.videoId else { return false }
-
-        // 2. 全局库清理
-        if let globalDB = globalDB {
-            try cleanGlobalRecords(
-                folderPath: folderPath,
-                sourceVideoId: videoId,
-                globalDB: globalDB
-            )
-        }
-
-        // 3. 文件夹库删除（CASCADE 自动删除 clips）
-        try folderDB.write { db in
-            try db.execute(
-                sql: "DELETE FROM videos WHERE video_id = ?",
-                arguments: [videoId]
-            )
-        }
-
-        // 4. 清理缩略图目录
-        let thumbDir = PipelineManager.thumbnailDirectory(
-            folderPath: folderPath, videoId: videoId
-        )
-        try? FileManager.default.removeItem(atPath: thumbDir)
-
-        // 5. 清理 SRT 文件（仅 App Support 下的降级路径）
-        if let srtPath = video.srtPath,
-           !srtPath.hasPrefix((videoPath as NSString).deletingLastPathComponent) {
-            try? FileManager.default.removeItem(atPath: srtPath)
-        }
-
-        return true
+        try removeVideos(
+            videoPaths: [videoPath],
+            folderPath: folderPath,
+            folderDB: folderDB,
+            globalDB: globalDB,
+            collector: collector
+        ).removedFromFolder > 0
     }
 
     /// 批量删除多个视频及其关联数据
     ///
-    /// 对每个视频路径执行 `removeVideo()`，返回成功删除的数量。
-    /// 单个视频删除失败不影响其余视频。
+    /// 执行顺序:
+    /// 1. 在文件夹库中按路径批量查找视频记录
+    /// 2. 全局库一个事务内按集合删除对应的 clips 和 videos
+    /// 3. 文件夹库一个事务内删除视频记录（clips 通过 ON DELETE CASCADE 自动删除），
+    ///    同一事务把缩略图目录、降级 SRT 和阶段产物的临时 WAV 写入 `file_garbage` 回收队列
+    ///    （缩略图打包缓存中的对应条目由回收器在删除目录前剔除）
+    /// 4. 唤醒后台回收器，文件删除不占用调用方时间
+    ///
+    /// 耗时只与数据库行数有关，与缩略图文件数无关。
     ///
     /// - Parameters:
-    ///   - videoPaths: 被删除的视频文件路径列表
+    ///   - videoPaths: 被删除的视频文件路径列表（不存在的路径忽略）
     ///   - folderPath: 所属监控文件夹路径
     ///   - folderDB: 文件夹级数据库连接
     ///   - globalDB: 全局搜索索引连接（nil 时跳过全局库清理）
-    /// - Returns: 成功删除的视频数量
+    ///   - collector: 文件回收器（nil = 只入队，不启动后台回收）
+    /// - Returns: 实际删除的视频数量与全局库删除的 clip_id
     @discardableResult
     public static func removeVideos(
         videoPaths: [String],
         folderPath: String,
         folderDB: DatabaseWriter,
-        globalDB: DatabaseWriter? = nil
-    ) throws -> Int {
-        var count = 0
-        for path in videoPaths {
-            do {
-                if try removeVideo(
-                    videoPath: path,
-                    folderPath: folderPath,
-                    folderDB: folderDB,
-                    globalDB: globalDB
-                ) {
-                    count += 1
-                }
-            } catch {
-                print("[VideoManager] 删除失败: \(path) - \(error)")
+        globalDB: DatabaseWriter? = nil,
+        collector: FileGarbageCollector? = .shared
+    ) throws -> RemovalResult {
+        let uniquePaths = Array(Set(videoPaths))
+        guard !uniquePaths.isEmpty else { return .empty }
+
+        // 1. 查找视频记录
+        struct Target {
+            let videoId: Int64
+            let filePath: String
+            let srtPath: String?
+        }
+        let targets: [Target] = try folderDB.read { db in
+            var found: [Target] = []
+            for chunk in chunked(uniquePaths) {
+                let rows = try Row.fetchAll(db, sql: """
+                    SELECT video_id, file_path, srt_path FROM videos
+                    WHERE file_path IN (\(placeholders(chunk.count)))
+                    """, arguments: StatementArguments(chunk))
+                found += rows.map { Target(videoId: $0["video_id"], filePath: $0["file_path"], srtPath: $0["srt_path"]) }
             }
+            return found
         }
-        return count
+        guard !targets.isEmpty else { return .empty }
+        let videoIds = targets.map(\.videoId)
+
+        // 2. 全局库清理
+        var removedClipIds: [Int64] = []
+        if let globalDB = globalDB {
+            removedClipIds = try cleanGlobalRecords(
+                folderPath: folderPath,
+                sourceVideoIds: videoIds,
+                globalDB: globalDB
+            )
+        }
+
+        // 3. 文件夹库删除（CASCADE 自动删除 clips）+ 文件回收入队
+        var garbage = targets.flatMap { target -> [String] in
+            var paths = [PipelineManager.thumbnailDirectory(folderPath: folderPath, videoId: target.videoId)]
+            // SRT 仅清理 App Support 下的降级路径（不在视频同目录）
+            if let srtPath = target.srtPath,
+               !srtPath.hasPrefix((target.filePath as NSString).deletingLastPathComponent) {
+                paths.append(srtPath)
+            }
+            return paths
+        }
+        try folderDB.write { db in
+            for chunk in chunked(videoIds) {
+                // stage_artifacts 随 videos 级联删除，先取出其引用的临时音频
+                garbage += try StageArtifacts.audioPaths(db, videoIds: Array(chunk))
+                try db.execute(
+                    sql: "DELETE FROM videos WHERE video_id IN (\(placeholders(chunk.count)))",
+                    arguments: StatementArguments(chunk)
+                )
+            }
+            try FileGarbageCollector.enqueue(db, paths: garbage)
+        }
+
+        // 4. 后台回收文件
+        collector?.schedule(folderPath: folderPath, folderDB: folderDB)
+
+        return RemovalResult(removedFromFolder: targets.count, removedGlobalClipIds: removedClipIds)
     }
 
     // MARK: - Private
 
-    /// 从全局库删除指定视频的 clips 和 video 记录
+    /// 从全局库按集合删除指定视频的 clips、转录片段和 video 记录（单个事务）
+    ///
+    /// - Returns: 删除的全局 clip_id
     private static func cleanGlobalRecords(
         folderPath: String,
-        sourceVideoId: Int64,
+        sourceVideoIds: [Int64],
         globalDB: DatabaseWriter
-    ) throws {
+    ) throws -> [Int64] {
         try globalDB.write { db in
-            // 先查 global video_id
-            let row = try Row.fetchOne(db, sql: """
-                SELECT video_id FROM videos
-                WHERE source_folder = ? AND source_video_id = ?
-                """, arguments: [folderPath, sourceVideoId])
-
-            guard let globalVideoId: Int64 = row?["video_id"] else { return }
-
-            // 删除 clips（FTS5 触发器自动更新索引）
-            try db.execute(
-                sql: "DELETE FROM clips WHERE video_id = ?",
-                arguments: [globalVideoId]
-            )
+            var removed: [Int64] = []
+            for chunk in chunked(sourceVideoIds) {
+                var args: StatementArguments = [folderPath]
+                args += StatementArguments(chunk)
+                let globalVideos = """
+                    SELECT video_id FROM videos
+                    WHERE source_folder = ? AND source_video_id IN (\(placeholders(chunk.count)))
+                    """
 
-            // 删除 video
-            try db.execute(
-                sql: "DELETE FROM videos WHERE video_id = ?",
-                arguments: [globalVideoId]
-            )
+                // 删除 clips（FTS5 触发器自动更新索引）
+                removed += try Int64.fetchAll(
+                    db,
+                    sql: "SELECT clip_id FROM clips WHERE video_id IN (\(globalVideos))",
+                    arguments: args
+                )
+                try db.execute(
+                    sql: "DELETE FROM clips WHERE video_id IN (\(globalVideos))",
+                    arguments: args
+                )
+
+                // 删除转录片段（按来源键）
+                try db.execute(
+                    sql: """
+                        DELETE FROM transcript_segments
+                        WHERE source_folder = ? AND source_video_id IN (\(placeholders(chunk.count)))
+                        """,
+                    arguments: args
+                )
+
+                // 删除 videos
+                try db.execute(
+                    sql: "DELETE FROM videos WHERE video_id IN (\(globalVideos))",
+                    arguments: args
+                )
+            }
+            return removed
         }
     }
+
+    /// IN 列表分块（低于 SQLite 绑定参数上限）
+    private static func chunked<T>(_ values: [T], size: Int = 500) -> [ArraySlice<T>] {
+        stride(from: 0, to: values.count, by: size).map { values[$0..<min($0 + size, values.count)] }
+    }
+
+    /// n 个 `?` 占位符
+    private static func placeholders(_ count: Int) -> String {
+        Array(repeating: "?", count: count).joined(separator: ",")
+    }
 }
@@ -271,6 +271,8 @@ public enum VisionAnalyzer {
         public var requestTimeoutSeconds: Double
         /// 最大重试次数（针对 429/503）
         public var maxRetries: Int
+        /// response_schema 包含的字段
+        public var fields: [VisionField]
 
         public static let `default` = Config(
             model: "gemini-2.5-flash",
@@ -283,12 +285,14 @@ public enum VisionAnalyzer {
             model: String = "gemini-2.5-flash",
             maxImagesPerRequest: Int = 10,
             requestTimeoutSeconds: Double = 60.0,
-            maxRetries: Int = 3
+            maxRetries: Int = 3,
+            fields: [VisionField] = VisionField.allActive
         ) {
             self.model = model
             self.maxImagesPerRequest = maxImagesPerRequest
             self.requestTimeoutSeconds = requestTimeoutSeconds
             self.maxRetries = maxRetries
+            self.fields = fields
         }
     }
 
@@ -322,8 +326,8 @@ public enum VisionAnalyzer {
     /// 构建 Gemini response_schema（结构化输出）
     ///
     /// 委托 VisionField.buildResponseSchema() 实现数据驱动。
-    static func buildResponseSchema() -> [String: Any] {
-        VisionField.buildResponseSchema()
+    static func buildResponseSchema(fields: [VisionField] = VisionField.allActive) -> [String: Any] {
+        VisionField.buildResponseSchema(fields: fields)
     }
 
     // MARK: - 请求构建
@@ -359,7 +363,7 @@ public enum VisionAnalyzer {
             ],
             "generationConfig": [
                 "response_mime_type": "application/json",
-                "response_schema": buildResponseSchema(),
+                "response_schema": buildResponseSchema(fields: config.fields),
             ],
         ]
 
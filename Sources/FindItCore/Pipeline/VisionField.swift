@@ -51,6 +51,8 @@ public enum VisionField: String, CaseIterable, Sendable {
         case preferNonNil
         /// 远程非空数组优先，否则保留本地
         case preferNonEmptyArray
+        /// 本地非 nil 优先（像素统计精确值），否则采用远程
+        case preferLocal
     }
 
     // MARK: - 计算属性
@@ -94,9 +96,18 @@ public enum VisionField: String, CaseIterable, Sendable {
         }
     }
 
+    /// 是否由像素统计直接计算（`PixelStatistics`），无需视觉模型
+    public var isPixelDerived: Bool {
+        switch self {
+        case .lighting, .colors: return true
+        default: return false
+        }
+    }
+
     /// 合并策略
     public var mergeStrategy: MergeStrategy {
-        isArray ? .preferNonEmptyArray : .preferNonNil
+        if isPixelDerived { return .preferLocal }
+        return isArray ? .preferNonEmptyArray : .preferNonNil
     }
 
     /// Gemini response_schema 描述
@@ -171,6 +182,31 @@ public enum VisionField: String, CaseIterable, Sendable {
         Array(allCases)
     }
 
+    /// 需要视觉模型回答的字段
+    ///
+    /// - Parameter includePixelDerived: 是否仍向模型请求光线/色调
+    ///   （默认否：本地像素统计已精确填充，省去这部分提示词与输出 token）
+    public static func modelFields(includePixelDerived: Bool = false) -> [VisionField] {
+        includePixelDerived ? allActive : allActive.filter { !$0.isPixelDerived }
+    }
+
+    /// 单个 clip 需要视觉模型回答的字段
+    ///
+    /// 在 `fields` 基础上补回本地没有值的光线/色调：恢复模式下未重跑本地分析，
+    /// 或该 clip 的像素统计失败时，仍由模型填充，不留空。
+    ///
+    /// - Parameters:
+    ///   - fields: 调用方配置的模型字段
+    ///   - localValue: clip 现有的本地字段值
+    public static func modelFields(
+        _ fields: [VisionField],
+        localValue: (VisionField) -> String?
+    ) -> [VisionField] {
+        allActive.filter { field in
+            fields.contains(field) || (field.isPixelDerived && localValue(field) == nil)
+        }
+    }
+
     // MARK: - 静态工具方法
 
     /// 构建 Gemini response_schema（结构化输出）
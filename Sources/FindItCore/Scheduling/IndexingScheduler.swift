@@ -139,9 +139,11 @@ public final class IndexingScheduler: @unchecked Sendable {
     ///   - rateLimiter: Gemini 限速器
     ///   - embeddingProvider: 嵌入 provider
     ///   - skipStt: 跳过所有语音转录
+    ///   - visionFields: 视觉模型需回答的字段
     ///   - onProgress: 视频进度回调（从并发 Task 调用，非 MainActor）
     ///   - onComplete: 单视频完成回调（从并发 Task 调用，非 MainActor）
-    /// - Returns: 最终同步结果（globalDB 为 nil 时返回 nil）
+    /// - Returns: 最终同步结果（globalDB 为 nil 时返回 nil）；
+    ///   含本轮新增/更新/删除的全局 clip_id，供 VectorStore 增量刷新
     public func processVideos(
         _ videos: [String],
         folderPath: String,
@@ -151,6 +153,7 @@ public final class IndexingScheduler: @unchecked Sendable {
         rateLimiter: GeminiRateLimiter? = nil,
         embeddingProvider: (any EmbeddingProvider)? = nil,
         skipStt: Bool = false,
+        visionFields: [VisionField] = VisionField.modelFields(),
         onProgress: @Sendable @escaping (VideoProgress) -> Void = { _ in },
         onComplete: @Sendable @escaping (VideoOutcome) -> Void = { _ in }
     ) async -> SyncEngine.SyncResult? {
@@ -159,13 +162,14 @@ public final class IndexingScheduler: @unchecked Sendable {
         let sem = videoSemaphore
         let monitor = resourceMonitor
         var requiresForceSync = false
+        var removedGlobalClipIds: [Int64] = []
 
         // 启动资源监控，动态调整信号量
         await monitor.startMonitoring { recommended in
             Task { await sem.setMaxPermits(recommended) }
         }
 
-        await withTaskGroup(of: Bool.self) { group in
+        await withTaskGroup(of: (requiresForceSync: Bool, removedGlobalClipIds: [Int64]).self) { group in
             for videoPath in videos {
                 // 协作式取消检查
                 guard !Task.isCancelled else { break }
@@ -197,6 +201,7 @@ public final class IndexingScheduler: @unchecked Sendable {
                             embeddingProvider: embeddingProvider,
                             skipStt: skipStt,
                             skipSync: true,
+                            visionFields: visionFields,
                             onProgress: { stage in
                                 onProgress(VideoProgress(
                                     videoPath: videoPath,
@@ -215,12 +220,12 @@ public final class IndexingScheduler: @unchecked Sendable {
                             clipsEmbedded: result.clipsEmbedded,
                             sttSkippedNoAudio: result.sttSkippedNoAudio
                         ))
-                        return result.requiresForceSync
+                        return (result.requiresForceSync, result.removedGlobalClipIds)
 
                     } catch is CancellationError {
                         await sem.release()
                         onComplete(.skipped(videoPath: videoPath))
-                        return false
+                        return (false, [])
 
                     } catch {
                         await sem.release()
@@ -228,13 +233,14 @@ public final class IndexingScheduler: @unchecked Sendable {
                             videoPath: videoPath,
                             error: error.localizedDescription
                         ))
-                        return false
+                        return (false, [])
                     }
                 }
             }
             // withTaskGroup 自动等待所有 child tasks 完成
-            for await childRequiresForceSync in group {
-                requiresForceSync = requiresForceSync || childRequiresForceSync
+            for await child in group {
+                requiresForceSync = requiresForceSync || child.requiresForceSync
+                removedGlobalClipIds.append(contentsOf: child.removedGlobalClipIds)
             }
         }
 
@@ -248,7 +254,7 @@ public final class IndexingScheduler: @unchecked Sendable {
                     folderDB: folderDB,
                     globalDB: globalDB,
                     force: requiresForceSync
-                )
+                ).addingRemovedClipIds(removedGlobalClipIds)
                 if sr.syncedClips > 0 || sr.syncedVideos > 0 {
                     onProgress(VideoProgress(
                         videoPath: folderPath,
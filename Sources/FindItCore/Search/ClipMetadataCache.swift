@@ -0,0 +1,700 @@
+import Foundation
+import GRDB
+import CxxHash
+
+/// 搜索结果展示所需的片段元数据（一行）
+///
+/// 只含定位与结果卡片的短字段；描述、转录等长文本不进缓存，
+/// 补全时只为最终展示的行从 SQLite 读取（`ClipTextFields`）。
+public struct ClipMetadataRecord: Sendable, Equatable {
+    public var clipId: Int64
+    public var sourceFolder: String
+    public var sourceClipId: Int64
+    public var videoId: Int64?
+    public var filePath: String?
+    public var fileName: String?
+    public var startTime: Double
+    public var endTime: Double
+    public var thumbnailPath: String?
+    public var rating: Int
+    public var colorLabel: String?
+    public var shotType: String?
+    public var mood: String?
+
+    /// 缓存列（长文本列见 `ClipTextFields.selectSQL`）
+    static let selectSQL = """
+        SELECT c.clip_id, c.source_folder, c.source_clip_id, c.video_id,
+               v.file_path, v.file_name,
+               c.start_time, c.end_time, c.thumbnail_path,
+               c.rating, c.color_label, c.shot_type, c.mood
+        FROM clips c
+        LEFT JOIN videos v ON v.video_id = c.video_id
+        """
+
+    init(row: Row) {
+        clipId = row["clip_id"]
+        sourceFolder = row["source_folder"]
+        sourceClipId = row["source_clip_id"]
+        videoId = row["video_id"]
+        filePath = row["file_path"]
+        fileName = row["file_name"]
+        startTime = row["start_time"]
+        endTime = row["end_time"]
+        thumbnailPath = row["thumbnail_path"]
+        rating = row["rating"] ?? 0
+        colorLabel = row["color_label"]
+        shotType = row["shot_type"]
+        mood = row["mood"]
+    }
+
+    init(
+        clipId: Int64, sourceFolder: String, sourceClipId: Int64, videoId: Int64?,
+        filePath: String?, fileName: String?, startTime: Double, endTime: Double,
+        thumbnailPath: String?, rating: Int, colorLabel: String?,
+        shotType: String?, mood: String?
+    ) {
+        self.clipId = clipId
+        self.sourceFolder = sourceFolder
+        self.sourceClipId = sourceClipId
+        self.videoId = videoId
+        self.filePath = filePath
+        self.fileName = fileName
+        self.startTime = startTime
+        self.endTime = endTime
+        self.thumbnailPath = thumbnailPath
+        self.rating = rating
+        self.colorLabel = colorLabel
+        self.shotType = shotType
+        self.mood = mood
+    }
+}
+
+/// 片段文本字段（不进缓存，按展示行读取）
+struct ClipTextFields: Equatable {
+    var scene: String?
+    var clipDescription: String?
+    var tags: String?
+    var transcript: String?
+    var userTags: String?
+
+    /// 按 clip_id 读取（主键分块查询；长文本列可能是压缩 BLOB，需要连接查字典）
+    static func fetch(_ db: Database, clipIds: [Int64]) throws -> [Int64: ClipTextFields] {
+        var fields: [Int64: ClipTextFields] = [:]
+        fields.reserveCapacity(clipIds.count)
+        for start in stride(from: 0, to: clipIds.count, by: 900) {
+            let chunk = clipIds[start..<min(start + 900, clipIds.count)]
+            let placeholders = chunk.map { _ in "?" }.joined(separator: ", ")
+            var args = StatementArguments()
+            for id in chunk { args += [id] }
+            let rows = try Row.fetchAll(db, sql: """
+                SELECT clip_id, scene, description, tags, transcript, user_tags
+                FROM clips WHERE clip_id IN (\(placeholders))
+                """, arguments: args)
+            for row in rows {
+                let clipId: Int64 = row["clip_id"]
+                fields[clipId] = ClipTextFields(
+                    scene: row["scene"],
+                    clipDescription: try TextCompression.text(row["description"], in: db),
+                    tags: row["tags"],
+                    transcript: try TextCompression.text(row["transcript"], in: db),
+                    userTags: row["user_tags"]
+                )
+            }
+        }
+        return fields
+    }
+}
+
+extension SearchEngine.SearchResult {
+    /// 由缓存记录、文本字段和评分构建搜索结果
+    init(record: ClipMetadataRecord, text: ClipTextFields?, rank: Double, similarity: Double?, finalScore: Double?) {
+        self.init(
+            clipId: record.clipId,
+            sourceFolder: record.sourceFolder,
+            sourceClipId: record.sourceClipId,
+            videoId: record.videoId,
+            filePath: record.filePath,
+            fileName: record.fileName,
+            startTime: record.startTime,
+            endTime: record.endTime,
+            scene: text?.scene,
+            clipDescription: text?.clipDescription,
+            tags: text?.tags,
+            transcript: text?.transcript,
+            thumbnailPath: record.thumbnailPath,
+            userTags: text?.userTags,
+            rating: record.rating,
+            colorLabel: record.colorLabel,
+            shotType: record.shotType,
+            mood: record.mood,
+            rank: rank,
+            similarity: similarity,
+            finalScore: finalScore
+        )
+    }
+}
+
+/// 片段元数据列式缓存
+///
+/// 把搜索结果展示用的热字段按 clip_id 排序写成列式文件（定长列 + 字符串池），
+/// 以 mmap 方式打开，结果补全（hydration）直接按行读取，不再对每页结果
+/// 执行 clips ⋈ videos 查询。描述、转录、标签等文本不进字符串池（否则文件体积
+/// 与库中文本相当），只为最终返回的行按主键读取。
+///
+/// 增量策略（基础文件 + 内存覆盖层）：
+/// - 基础文件不可变；同步增量、评分/颜色修改写入覆盖层（含删除标记）
+/// - 覆盖层超过阈值时合并重写基础文件（`compactIfNeeded`）
+/// - 合并 / 重建只清除已折叠进新基础文件、且此后未再修改的覆盖层条目
+/// - 加载 / 重建期间到达的同步增量与局部修改排队，完成后补应用
+/// - 文件头保存全局库指纹，启动时不一致则全量重建
+///
+/// 文件格式（小端）：
+/// ```
+/// "FCM1" | version u32 | count u64 | fingerprint (u32 len + utf8)
+/// | clip_id i64[n] | source_clip_id i64[n] | video_id i64[n] (-1 = NULL)
+/// | start_time f64[n] | end_time f64[n] | rating i32[n]
+/// | 7 个字符串列 u64[n]（offset << 32 | length，UInt64.max = NULL）
+/// | pool_len u64 | 字符串池 utf8 | xxh3_64 u64
+/// ```
+public final class ClipMetadataCache: @unchecked Sendable {
+
+    /// 覆盖层行数超过此值时合并重写
+    public static let compactionThreshold = 4096
+
+    /// 缓存文件路径（nil = 纯内存，不持久化）
+    public let fileURL: URL?
+
+    private let lock = NSLock()
+    private var base: ClipMetadataColumns?
+
+    /// 覆盖层：clip_id → 新记录（nil = 已删除）
+    private var overlay: [Int64: ClipMetadataRecord?] = [:]
+
+    /// 覆盖层条目的写入代数（合并时据此判断条目是否已折叠）
+    private var overlayStamps: [Int64: UInt64] = [:]
+    private var overlayGeneration: UInt64 = 0
+
+    /// 进行中的加载 / 重建数
+    private var activeLoads = 0
+
+    /// 加载 / 重建期间到达的同步增量（完成后补应用，重复应用是幂等的）
+    private var pendingSyncDeltas: [SyncEngine.SyncResult] = []
+
+    /// 加载 / 重建期间到达的局部修改（完成后补应用）
+    private var pendingPatches: [(clipId: Int64, update: (inout ClipMetadataRecord) -> Void)] = []
+
+    public init(fileURL: URL?) {
+        self.fileURL = fileURL
+    }
+
+    /// 默认路径（~/Library/Application Support/FindIt/clip-metadata.cache）
+    public static func defaultURL() throws -> URL {
+        try DatabaseManager.appSupportDirectory().appendingPathComponent("clip-metadata.cache")
+    }
+
+    // MARK: - 状态
+
+    /// 是否已加载（未加载时调用方应回退 SQLite）
+    public var isLoaded: Bool {
+        lock.lock(); defer { lock.unlock() }
+        return base != nil
+    }
+
+    /// 有效行数（基础文件 + 覆盖层）
+    public var count: Int {
+        lock.lock(); defer { lock.unlock() }
+        guard let base else { return 0 }
+        var total = base.count
+        for (clipId, record) in overlay {
+            let inBase = base.row(for: clipId) != nil
+            if inBase && record == nil { total -= 1 }
+            if !inBase && record != nil { total += 1 }
+        }
+        return total
+    }
+
+    // MARK: - 加载 / 重建
+
+    /// 打开缓存：文件指纹与全局库一致则直接映射，否则全量重建
+    ///
+    /// - Returns: 是否复用了磁盘文件
+    @discardableResult
+    public func load(from db: DatabaseReader) async throws -> Bool {
+        try await whileLoading(from: db) {
+            self.lock.lock()
+            let folded = self.overlayStamps
+            self.lock.unlock()
+            let fingerprint = try await db.read { try Self.fingerprint($0) }
+
+            if let url = self.fileURL,
+               let data = try? Data(contentsOf: url, options: .mappedIfSafe),
+               let columns = try? ClipMetadataColumns(data: data),
+               columns.fingerprint == fingerprint {
+                self.replaceBase(columns, folded: folded)
+                return true
+            }
+
+            try await self.rebuildBase(from: db)
+            return false
+        }
+    }
+
+    /// 全量重建（单次顺序扫描）
+    public func rebuild(from db: DatabaseReader) async throws {
+        try await whileLoading(from: db) {
+            try await self.rebuildBase(from: db)
+        }
+    }
+
+    // MARK: - 读取
+
+    /// 按 clip_id 批量读取记录（缺失的 ID 不出现在结果中）
+    public func records<S: Sequence>(for clipIds: S) -> [Int64: ClipMetadataRecord] where S.Element == Int64 {
+        lock.lock(); defer { lock.unlock() }
+        guard let base else { return [:] }
+        var result: [Int64: ClipMetadataRecord] = [:]
+        for clipId in clipIds {
+            if let patched = overlay[clipId] {
+                if let patched { result[clipId] = patched }
+            } else if let row = base.row(for: clipId) {
+                result[clipId] = base.record(at: row)
+            }
+        }
+        return result
+    }
+
+    // MARK: - 增量更新
+
+    /// 按同步结果增量刷新（只读取新增/更新的行）
+    ///
+    /// 加载 / 重建进行中时排队，完成后补应用（重建读取的快照可能早于本次同步）。
+    public func applySyncDelta(_ result: SyncEngine.SyncResult, from db: DatabaseReader) async throws {
+        guard result.hasClipChanges else { return }
+        lock.lock()
+        if activeLoads > 0 {
+            pendingSyncDeltas.append(result)
+            lock.unlock()
+            return
+        }
+        let loaded = base != nil
+        lock.unlock()
+        // 尚未加载：之后的加载会读到最新数据
+        guard loaded else { return }
+
+        try await applyToOverlay(result, from: db)
+        try await compactIfNeeded(from: db)
+    }
+
+    /// 局部修改单个片段（评分/颜色标签等用户编辑）
+    ///
+    /// 修改只进入内存覆盖层，磁盘文件随即标记为过期（删除），
+    /// 保证进程退出前未合并时下次启动不会读到旧值。
+    /// 加载 / 重建进行中时排队，完成后补应用。
+    public func patch(clipId: Int64, _ update: @escaping (inout ClipMetadataRecord) -> Void) {
+        lock.lock()
+        defer { lock.unlock() }
+        if activeLoads > 0 {
+            pendingPatches.append((clipId, update))
+            invalidateFile()
+            return
+        }
+        guard base != nil else {
+            // 未加载：修改不改变库指纹，磁盘文件须失效，否则下次加载读到旧值
+            invalidateFile()
+            return
+        }
+        applyPatch(clipId: clipId, update)
+    }
+
+    /// 覆盖层超过阈值时合并重写基础文件
+    public func compactIfNeeded(from db: DatabaseReader) async throws {
+        lock.lock()
+        let needsCompaction = overlay.count >= Self.compactionThreshold
+        lock.unlock()
+        guard needsCompaction else { return }
+        try await compact(from: db)
+    }
+
+    /// 合并基础文件与覆盖层并重写
+    ///
+    /// 合并期间写入覆盖层的条目（增量、局部修改）保留到下一次合并。
+    public func compact(from db: DatabaseReader) async throws {
+        let fingerprint = try await db.read { try Self.fingerprint($0) }
+        lock.lock()
+        guard let base else { lock.unlock(); return }
+        let folded = overlayStamps
+        var merged: [ClipMetadataRecord] = []
+        merged.reserveCapacity(base.count + overlay.count)
+        for row in 0..<base.count {
+            let clipId = base.clipId(at: row)
+            if let patched = overlay[clipId] {
+                if let patched { merged.append(patched) }
+            } else {
+                merged.append(base.record(at: row))
+            }
+        }
+        for case let (clipId, record?) in overlay where base.row(for: clipId) == nil {
+            merged.append(record)
+        }
+        lock.unlock()
+
+        merged.sort { $0.clipId < $1.clipId }
+        try install(records: merged, fingerprint: fingerprint, folded: folded)
+    }
+
+    // MARK: - Private
+
+    /// 标记加载 / 重建进行中，结束后补应用期间排队的增量与修改
+    private func whileLoading<T>(from db: DatabaseReader, _ body: () async throws -> T) async throws -> T {
+        lock.lock()
+        activeLoads += 1
+        lock.unlock()
+
+        let value: T
+        do {
+            value = try await body()
+        } catch {
+            try? await finishLoading(from: db)
+            throw error
+        }
+        try await finishLoading(from: db)
+        return value
+    }
+
+    /// 补应用排队的增量（补应用期间仍在排队，直到队列清空才结束加载状态）
+    private func finishLoading(from db: DatabaseReader) async throws {
+        while true {
+            lock.lock()
+            if activeLoads > 1 {
+                // 还有其他加载进行中，由最后一个负责补应用
+                activeLoads -= 1
+                lock.unlock()
+                return
+            }
+            let deltas = pendingSyncDeltas
+            pendingSyncDeltas.removeAll()
+            if deltas.isEmpty {
+                // 局部修改只改内存，和结束加载状态在同一临界区内完成
+                let patches = pendingPatches
+                pendingPatches.removeAll()
+                if base != nil {
+                    for (clipId, update) in patches { applyPatch(clipId: clipId, update) }
+                }
+                activeLoads = 0
+                lock.unlock()
+                return
+            }
+            let loaded = base != nil
+            lock.unlock()
+
+            do {
+                for delta in deltas where loaded {
+                    try await applyToOverlay(delta, from: db)
+                }
+            } catch {
+                lock.lock()
+                activeLoads = 0
+                pendingSyncDeltas.removeAll()
+                pendingPatches.removeAll()
+                lock.unlock()
+                throw error
+            }
+        }
+    }
+
+    /// 从库读取全部记录并替换基础文件
+    private func rebuildBase(from db: DatabaseReader) async throws {
+        // 读取前的覆盖层已反映在库中；读取开始后写入的条目保留
+        lock.lock()
+        let folded = overlayStamps
+        lock.unlock()
+        let (records, fingerprint) = try await db.read { dbConn in
+            let rows = try Row.fetchAll(dbConn, sql: ClipMetadataRecord.selectSQL + "\nORDER BY c.clip_id")
+            return (rows.map(ClipMetadataRecord.init(row:)), try Self.fingerprint(dbConn))
+        }
+        try install(records: records, fingerprint: fingerprint, folded: folded)
+    }
+
+    /// 读取增量涉及的行写入覆盖层
+    private func applyToOverlay(_ result: SyncEngine.SyncResult, from db: DatabaseReader) async throws {
+        let changed = result.addedClipIds + result.updatedClipIds
+        let fetched = try await db.read { try Self.fetchRecords($0, clipIds: changed) }
+
+        lock.lock()
+        for clipId in result.removedClipIds { setOverlay(clipId, nil) }
+        for clipId in changed { setOverlay(clipId, nil) }
+        for record in fetched { setOverlay(record.clipId, record) }
+        lock.unlock()
+    }
+
+    /// 在当前记录上应用局部修改（调用方持有锁）
+    private func applyPatch(clipId: Int64, _ update: (inout ClipMetadataRecord) -> Void) {
+        guard let base else { return }
+        var record: ClipMetadataRecord
+        if let patched = overlay[clipId] {
+            guard let patched else { return }
+            record = patched
+        } else if let row = base.row(for: clipId) {
+            record = base.record(at: row)
+        } else {
+            return
+        }
+        update(&record)
+        setOverlay(clipId, record)
+        invalidateFile()
+    }
+
+    /// 写入覆盖层条目并记录写入代数（调用方持有锁）
+    private func setOverlay(_ clipId: Int64, _ record: ClipMetadataRecord?) {
+        overlayGeneration += 1
+        overlay[clipId] = .some(record)
+        overlayStamps[clipId] = overlayGeneration
+    }
+
+    /// 删除磁盘文件（已映射的数据在 unlink 后仍然有效）
+    private func invalidateFile() {
+        if let url = fileURL {
+            try? FileManager.default.removeItem(at: url)
+        }
+    }
+
+    /// 编码、写盘并切换为新的基础文件
+    ///
+    /// - Parameter folded: 已折叠进 `records` 的覆盖层条目及其写入代数；
+    ///   只清除代数未变的条目，期间的新写入保留在覆盖层
+    private func install(records: [ClipMetadataRecord], fingerprint: String, folded: [Int64: UInt64]) throws {
+        let data = ClipMetadataColumns.encode(records, fingerprint: fingerprint)
+        var columns = try ClipMetadataColumns(data: data)
+        if let url = fileURL {
+            try FileManager.default.createDirectory(
+                at: url.deletingLastPathComponent(),
+                withIntermediateDirectories: true
+            )
+            try data.write(to: url, options: .atomic)
+            if let mapped = try? Data(contentsOf: url, options: .mappedIfSafe),
+               let mappedColumns = try? ClipMetadataColumns(data: mapped) {
+                columns = mappedColumns
+            }
+        }
+        replaceBase(columns, folded: folded)
+    }
+
+    /// 切换基础文件，清除已折叠的覆盖层条目
+    private func replaceBase(_ columns: ClipMetadataColumns, folded: [Int64: UInt64]) {
+        lock.lock()
+        defer { lock.unlock() }
+        base = columns
+        for (clipId, stamp) in folded where overlayStamps[clipId] == stamp {
+            overlay.removeValue(forKey: clipId)
+            overlayStamps.removeValue(forKey: clipId)
+        }
+        // 仍有未折叠的条目：磁盘文件不含它们（局部修改不改变指纹），标记过期
+        if !overlay.isEmpty { invalidateFile() }
+    }
+
+    /// 全局库指纹（clip 数、最大 clip_id、最近同步时间）
+    static func fingerprint(_ db: Database) throws -> String {
+        let row = try Row.fetchOne(db, sql: """
+            SELECT COUNT(*) AS clip_count, COALESCE(MAX(clip_id), 0) AS max_clip_id FROM clips
+            """)
+        let lastSynced = try String.fetchOne(db, sql: "SELECT MAX(last_synced_at) FROM sync_meta")
+        let count: Int = row?["clip_count"] ?? 0
+        let maxId: Int64 = row?["max_clip_id"] ?? 0
+        return "\(count)|\(maxId)|\(lastSynced ?? "")"
+    }
+
+    /// 按 clip_id 读取记录（分块 IN 查询）
+    static func fetchRecords(_ db: Database, clipIds: [Int64]) throws -> [ClipMetadataRecord] {
+        var records: [ClipMetadataRecord] = []
+        records.reserveCapacity(clipIds.count)
+        for start in stride(from: 0, to: clipIds.count, by: 900) {
+            let chunk = clipIds[start..<min(start + 900, clipIds.count)]
+            let placeholders = chunk.map { _ in "?" }.joined(separator: ", ")
+            var args = StatementArguments()
+            for id in chunk { args += [id] }
+            let rows = try Row.fetchAll(db, sql: ClipMetadataRecord.selectSQL + """
+
+                WHERE c.clip_id IN (\(placeholders))
+                """, arguments: args)
+            records.append(contentsOf: rows.map(ClipMetadataRecord.init(row:)))
+        }
+        return records
+    }
+}
+
+// MARK: - 列式文件
+
+/// 列式缓存文件的只读视图（基于 mmap 的 Data，按需解码单行）
+struct ClipMetadataColumns {
+
+    static let magic: [UInt8] = Array("FCM1".utf8)
+    static let version: UInt32 = 2
+    static let stringColumnCount = 7
+    static let nullString = UInt64.max
+
+    let data: Data
+    let count: Int
+    let fingerprint: String
+
+    private let clipIdOffset: Int
+    private let sourceClipIdOffset: Int
+    private let videoIdOffset: Int
+    private let startTimeOffset: Int
+    private let endTimeOffset: Int
+    private let ratingOffset: Int
+    private let stringsOffset: Int
+    private let poolOffset: Int
+
+    init(data: Data) throws {
+        self.data = data
+        let total = data.count
+        guard total >= 24 else { throw VectorStoreSnapshotError.truncated }
+
+        let header: (count: Int, fingerprint: String, columnsStart: Int) = try data.withUnsafeBytes { raw in
+            guard Array(raw.prefix(Self.magic.count)) == Self.magic else {
+                throw VectorStoreSnapshotError.badMagic
+            }
+            let bodyLength = total - 8
+            let stored = raw.loadUnaligned(fromByteOffset: bodyLength, as: UInt64.self)
+            guard UInt64(XXH3_64bits(raw.baseAddress, bodyLength)) == stored else {
+                throw VectorStoreSnapshotError.checksumMismatch
+            }
+            let version = raw.loadUnaligned(fromByteOffset: 4, as: UInt32.self)
+            guard version == Self.version else { throw VectorStoreSnapshotError.unsupportedVersion(version) }
+            let count = Int(raw.loadUnaligned(fromByteOffset: 8, as: UInt64.self))
+            let fpLength = Int(raw.loadUnaligned(fromByteOffset: 16, as: UInt32.self))
+            guard 20 + fpLength <= bodyLength else { throw VectorStoreSnapshotError.truncated }
+            let fp = String(decoding: UnsafeRawBufferPointer(rebasing: raw[20..<(20 + fpLength)]), as: UTF8.self)
+            return (count, fp, 20 + fpLength)
+        }
+
+        count = header.count
+        fingerprint = header.fingerprint
+        clipIdOffset = header.columnsStart
+        sourceClipIdOffset = clipIdOffset + count * 8
+        videoIdOffset = sourceClipIdOffset + count * 8
+        startTimeOffset = videoIdOffset + count * 8
+        endTimeOffset = startTimeOffset + count * 8
+        ratingOffset = endTimeOffset + count * 8
+        stringsOffset = ratingOffset + count * 4
+        let poolLengthOffset = stringsOffset + count * 8 * Self.stringColumnCount
+        guard poolLengthOffset + 8 <= total - 8 else { throw VectorStoreSnapshotError.truncated }
+        let poolLength = data.withUnsafeBytes {
+            Int($0.loadUnaligned(fromByteOffset: poolLengthOffset, as: UInt64.self))
+        }
+        poolOffset = poolLengthOffset + 8
+        guard poolOffset + poolLength == total - 8 else { throw VectorStoreSnapshotError.truncated }
+    }
+
+    // MARK: - 读取
+
+    func clipId(at row: Int) -> Int64 {
+        load(Int64.self, at: clipIdOffset + row * 8)
+    }
+
+    /// 二分查找 clip_id 所在行
+    func row(for clipId: Int64) -> Int? {
+        var low = 0
+        var high = count - 1
+        while low <= high {
+            let mid = (low + high) / 2
+            let value = self.clipId(at: mid)
+            if value == clipId { return mid }
+            if value < clipId { low = mid + 1 } else { high = mid - 1 }
+        }
+        return nil
+    }
+
+    func record(at row: Int) -> ClipMetadataRecord {
+        let videoId = load(Int64.self, at: videoIdOffset + row * 8)
+        return ClipMetadataRecord(
+            clipId: clipId(at: row),
+            sourceFolder: string(column: 0, row: row) ?? "",
+            sourceClipId: load(Int64.self, at: sourceClipIdOffset + row * 8),
+            videoId: videoId >= 0 ? videoId : nil,
+            filePath: string(column: 1, row: row),
+            fileName: string(column: 2, row: row),
+            startTime: Double(bitPattern: load(UInt64.self, at: startTimeOffset + row * 8)),
+            endTime: Double(bitPattern: load(UInt64.self, at: endTimeOffset + row * 8)),
+            thumbnailPath: string(column: 3, row: row),
+            rating: Int(load(Int32.self, at: ratingOffset + row * 4)),
+            colorLabel: string(column: 4, row: row),
+            shotType: string(column: 5, row: row),
+            mood: string(column: 6, row: row)
+        )
+    }
+
+    private func load<T: FixedWidthInteger>(_ type: T.Type, at offset: Int) -> T {
+        data.withUnsafeBytes { T(littleEndian: $0.loadUnaligned(fromByteOffset: offset, as: T.self)) }
+    }
+
+    private func string(column: Int, row: Int) -> String? {
+        let ref = load(UInt64.self, at: stringsOffset + (column * count + row) * 8)
+        guard ref != Self.nullString else { return nil }
+        let start = poolOffset + Int(ref >> 32)
+        let length = Int(ref & 0xFFFF_FFFF)
+        return data.withUnsafeBytes { raw in
+            String(decoding: UnsafeRawBufferPointer(rebasing: raw[start..<(start + length)]), as: UTF8.self)
+        }
+    }
+
+    // MARK: - 编码
+
+    /// 编码列式文件（records 必须按 clip_id 升序）
+    static func encode(_ records: [ClipMetadataRecord], fingerprint: String) -> Data {
+        var pool = Data()
+        var interned: [String: UInt64] = [:]
+
+        func ref(_ string: String?) -> UInt64 {
+            guard let string else { return nullString }
+            if let existing = interned[string] { return existing }
+            let bytes = Array(string.utf8)
+            let value = UInt64(pool.count) << 32 | UInt64(bytes.count)
+            pool.append(contentsOf: bytes)
+            interned[string] = value
+            return value
+        }
+
+        var stringColumns = [[UInt64]](repeating: [], count: stringColumnCount)
+        for column in stringColumns.indices {
+            stringColumns[column].reserveCapacity(records.count)
+        }
+        for record in records {
+            let fields: [String?] = [
+                record.sourceFolder, record.filePath, record.fileName,
+                record.thumbnailPath, record.colorLabel, record.shotType, record.mood,
+            ]
+            for (column, field) in fields.enumerated() {
+                stringColumns[column].append(ref(field))
+            }
+        }
+
+        var data = Data()
+        data.append(contentsOf: magic)
+        append(&data, version)
+        append(&data, UInt64(records.count))
+        let fpBytes = Array(fingerprint.utf8)
+        append(&data, UInt32(fpBytes.count))
+        data.append(contentsOf: fpBytes)
+
+        for record in records { append(&data, record.clipId) }
+        for record in records { append(&data, record.sourceClipId) }
+        for record in records { append(&data, record.videoId ?? -1) }
+        for record in records { append(&data, record.startTime.bitPattern) }
+        for record in records { append(&data, record.endTime.bitPattern) }
+        for record in records { append(&data, Int32(clamping: record.rating)) }
+        for column in stringColumns {
+            for value in column { append(&data, value) }
+        }
+        append(&data, UInt64(pool.count))
+        data.append(pool)
+
+        let checksum = data.withUnsafeBytes { XXH3_64bits($0.baseAddress, $0.count) }
+        append(&data, UInt64(checksum))
+        return data
+    }
+
+    private static func append<T: FixedWidthInteger>(_ data: inout Data, _ value: T) {
+        withUnsafeBytes(of: value.littleEndian) { data.append(contentsOf: $0) }
+    }
+}
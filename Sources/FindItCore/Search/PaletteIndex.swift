@@ -0,0 +1,175 @@
+import Foundation
+import GRDB
+
+/// 调色板索引 — 色彩签名的紧凑扫描
+///
+/// 每个 clip 一个 64 字节 `ColorSignature`，按行连续存放于
+/// `[SIMD64<UInt8>]`；查询时逐行 `pointwiseMin` + 横向求和做直方图相交，
+/// 一行只需一次 64 字节向量比较。100 万 clip 约 64 MB，单次扫描为毫秒级。
+///
+/// 值类型：由调用方决定持有方式（CLI 一次性加载，守护进程常驻并按同步增量刷新）。
+public struct PaletteIndex: Sendable {
+
+    /// 连续签名（与 clipIds 行对齐）
+    private var signatures: [SIMD64<UInt8>] = []
+
+    /// 对应的 clip IDs
+    private var clipIds: [Int64] = []
+
+    /// clip_id → 行号
+    private var rowIndex: [Int64: Int] = [:]
+
+    /// 已加载的签名数量
+    public var count: Int { clipIds.count }
+
+    public init() {}
+
+    /// 由 (clip_id, color_signature BLOB) 构建（长度不符的 BLOB 跳过）
+    public init(entries: [(clipId: Int64, signatureData: Data)]) {
+        signatures.reserveCapacity(entries.count)
+        clipIds.reserveCapacity(entries.count)
+        rowIndex.reserveCapacity(entries.count)
+        for (clipId, data) in entries {
+            guard let signature = ColorSignature(data: data) else { continue }
+            upsert(clipId: clipId, signature: signature)
+        }
+    }
+
+    /// 从全局库加载全部签名
+    public static func load(_ db: Database) throws -> PaletteIndex {
+        let rows = try Row.fetchAll(db, sql: """
+            SELECT clip_id, color_signature FROM clips WHERE color_signature IS NOT NULL
+            """)
+        return PaletteIndex(entries: rows.map { row -> (clipId: Int64, signatureData: Data) in
+            (row["clip_id"], row["color_signature"])
+        })
+    }
+
+    // MARK: - 增量维护
+
+    /// 新增或替换
+    public mutating func upsert(clipId: Int64, signature: ColorSignature) {
+        if let row = rowIndex[clipId] {
+            signatures[row] = signature.bins
+        } else {
+            rowIndex[clipId] = clipIds.count
+            clipIds.append(clipId)
+            signatures.append(signature.bins)
+        }
+    }
+
+    /// 批量移除（单次遍历压缩，保持剩余行顺序）
+    public mutating func remove(clipIds removed: Set<Int64>) {
+        guard removed.contains(where: { rowIndex[$0] != nil }) else { return }
+        var write = 0
+        for read in 0..<clipIds.count where !removed.contains(clipIds[read]) {
+            clipIds[write] = clipIds[read]
+            signatures[write] = signatures[read]
+            write += 1
+        }
+        clipIds.removeSubrange(write...)
+        signatures.removeSubrange(write...)
+        rowIndex.removeAll(keepingCapacity: true)
+        for (row, clipId) in clipIds.enumerated() { rowIndex[clipId] = row }
+    }
+
+    /// 按同步结果增量刷新（与 `VectorStore.applySyncDelta` 对应）
+    ///
+    /// 只读取新增/更新 clip 的签名（按 SQLite 变量上限分块）；
+    /// 签名为空或无效的 clip 与已删除的 clip 一并移除。
+    public mutating func applySyncDelta(_ result: SyncEngine.SyncResult, from db: Database) throws {
+        guard result.hasClipChanges else { return }
+        let changed = result.addedClipIds + result.updatedClipIds
+        var present = Set<Int64>()
+        for start in stride(from: 0, to: changed.count, by: 900) {
+            let chunk = changed[start..<min(start + 900, changed.count)]
+            let placeholders = chunk.map { _ in "?" }.joined(separator: ", ")
+            let rows = try Row.fetchAll(db, sql: """
+                SELECT clip_id, color_signature FROM clips
+                WHERE color_signature IS NOT NULL AND clip_id IN (\(placeholders))
+                """, arguments: StatementArguments(chunk))
+            for row in rows {
+                guard let data = row["color_signature"] as? Data,
+                      let signature = ColorSignature(data: data) else { continue }
+                let clipId: Int64 = row["clip_id"]
+                upsert(clipId: clipId, signature: signature)
+                present.insert(clipId)
+            }
+        }
+        var removals = Set(result.removedClipIds)
+        for id in changed where !present.contains(id) {
+            removals.insert(id)
+        }
+        remove(clipIds: removals)
+    }
+
+    // MARK: - 搜索
+
+    /// 按调色板覆盖度检索
+    ///
+    /// 得分 = Σ min(query, clip) / Σ query（1 = 查询的每种颜色在画面中占比都不低于查询权重）。
+    ///
+    /// - Parameters:
+    ///   - query: 查询签名（通常由 `ColorSignature.palette(_:)` 构建）
+    ///   - limit: 最大结果数
+    ///   - minScore: 最低得分（0-1）
+    /// - Returns: 按得分降序（同分按 clip_id 升序）
+    public func search(
+        _ query: ColorSignature,
+        limit: Int = 50,
+        minScore: Float = 0
+    ) -> [(clipId: Int64, score: Float)] {
+        let mass = query.mass
+        guard mass > 0, limit > 0, !signatures.isEmpty else { return [] }
+        let q = query.bins
+        let threshold = UInt8(max(0, min(255, (minScore * Float(mass)).rounded(.up))))
+
+        // 有界 top-K：按 (overlap 降序, 行号升序) 维护，满员后只接受更优者
+        var top: [(overlap: UInt8, row: Int)] = []
+        top.reserveCapacity(limit + 1)
+        signatures.withUnsafeBufferPointer { rows in
+            for row in 0..<rows.count {
+                let overlap = ColorSignature.overlap(q, rows[row])
+                guard overlap >= threshold, overlap > 0 else { continue }
+                if top.count == limit, let worst = top.last, overlap <= worst.overlap { continue }
+                let position = top.firstIndex { $0.overlap < overlap } ?? top.count
+                top.insert((overlap, row), at: position)
+                if top.count > limit { top.removeLast() }
+            }
+        }
+
+        return top
+            .map { (clipId: clipIds[$0.row], score: Float($0.overlap) / Float(mass)) }
+            .sorted { $0.score > $1.score || ($0.score == $1.score && $0.clipId < $1.clipId) }
+    }
+}
+
+extension SearchEngine {
+
+    /// 调色板检索：签名扫描 + 元数据补全
+    ///
+    /// - Parameters:
+    ///   - palette: 查询签名
+    ///   - index: 已加载的索引（nil = 从全局库临时加载）
+    ///   - folderPaths: 限定文件夹（nil = 全部）
+    ///   - limit: 最大结果数
+    /// - Returns: `similarity` / `finalScore` 为调色板覆盖度
+    public static func paletteSearch(
+        _ db: Database,
+        palette: ColorSignature,
+        index: PaletteIndex? = nil,
+        folderPaths: Set<String>? = nil,
+        limit: Int = 50
+    ) throws -> [SearchResult] {
+        let index = try index ?? PaletteIndex.load(db)
+        // 文件夹过滤在补全阶段执行，扫描时多取候选
+        let candidates = folderPaths == nil ? limit : max(limit, 900)
+        let hits = index.search(palette, limit: candidates)
+        return try vectorSearchFromStore(
+            db,
+            storeResults: hits.map { ($0.clipId, $0.score) },
+            folderPaths: folderPaths,
+            limit: limit
+        )
+    }
+}
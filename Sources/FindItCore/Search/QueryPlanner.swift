@@ -0,0 +1,428 @@
+import Foundation
+import GRDB
+
+/// 查询统计（规划输入）
+public struct QueryStatistics: Sendable, Equatable {
+    /// 全局库 clip 总数
+    public var totalClips: Int
+    /// 过滤范围内的 clip 数（nil = 未过滤）
+    public var scopeClips: Int?
+    /// 各查询词项的文档频率（前缀词为前缀范围内文档频率之和）
+    public var termFrequencies: [String: Int]
+    /// FTS 命中数上界（全库，nil = 无法估计）
+    public var ftsEstimate: Int?
+    /// 估计是否精确（单个非前缀词项且无排除项时文档频率即命中数）
+    public var ftsEstimateIsExact: Bool
+    /// VectorStore 行数（nil = 未加载）
+    public var vectorStoreCount: Int?
+
+    public init(
+        totalClips: Int,
+        scopeClips: Int? = nil,
+        termFrequencies: [String: Int] = [:],
+        ftsEstimate: Int? = nil,
+        ftsEstimateIsExact: Bool = false,
+        vectorStoreCount: Int? = nil
+    ) {
+        self.totalClips = totalClips
+        self.scopeClips = scopeClips
+        self.termFrequencies = termFrequencies
+        self.ftsEstimate = ftsEstimate
+        self.ftsEstimateIsExact = ftsEstimateIsExact
+        self.vectorStoreCount = vectorStoreCount
+    }
+
+    /// 过滤选择率（0-1，未过滤为 1）
+    public var selectivity: Double {
+        guard let scopeClips else { return 1 }
+        guard totalClips > 0 else { return 0 }
+        return min(1, Double(scopeClips) / Double(totalClips))
+    }
+
+    /// 过滤范围内的 FTS 命中估计（假设词项与过滤条件独立）
+    public var ftsEstimateInScope: Int? {
+        ftsEstimate.map { Int((Double($0) * selectivity).rounded(.up)) }
+    }
+}
+
+/// 混合搜索执行计划
+public struct QueryPlan: Sendable {
+
+    /// 向量检索方式
+    public enum VectorAccess: String, Sendable {
+        /// 不执行向量检索
+        case none
+        /// VectorStore 内存精确 top-K（vDSP 批量点积）
+        case store
+        /// SQLite 逐行扫描（VectorStore 未加载）
+        case scan
+    }
+
+    /// 过滤条件相对向量检索的位置
+    public enum FilterPlacement: String, Sendable {
+        /// 无过滤
+        case none
+        /// 先过滤：行位图/SQL 条件限定候选，再取 top-K
+        case prefilter
+        /// 后过滤：全库 top-K（按选择率放大），补全时剔除范围外结果
+        case postfilter
+    }
+
+    /// 融合权重
+    public var weights: SearchEngine.SearchWeights
+    /// FTS 取回条数（0 = 跳过 FTS）
+    public var ftsLimit: Int
+    /// 向量检索方式
+    public var vectorAccess: VectorAccess
+    /// 向量 top-K 候选数（后过滤时已按选择率放大）
+    public var vectorCandidates: Int
+    /// 过滤后参与融合的向量结果数
+    public var vectorDepth: Int
+    /// 过滤位置
+    public var filterPlacement: FilterPlacement
+    /// 最终返回条数
+    public var resultLimit: Int
+    /// 规划所用统计
+    public var statistics: QueryStatistics
+    /// 决策说明（EXPLAIN 输出）
+    public var notes: [String]
+
+    /// 是否执行 FTS
+    public var runsFTS: Bool { ftsLimit > 0 }
+
+    /// 是否执行向量检索
+    public var runsVector: Bool { vectorAccess != .none }
+
+    /// EXPLAIN 风格的计划描述
+    public func explain() -> String {
+        var lines: [String] = []
+        let strategy: String
+        switch (runsFTS, runsVector) {
+        case (true, true): strategy = "HYBRID"
+        case (true, false): strategy = "FTS ONLY"
+        case (false, true): strategy = "VECTOR ONLY"
+        case (false, false): strategy = "EMPTY"
+        }
+        lines.append("PLAN \(strategy) limit=\(resultLimit)")
+        if runsFTS {
+            let estimate = statistics.ftsEstimateInScope.map(String.init) ?? "?"
+            lines.append("  FTS5 MATCH limit=\(ftsLimit) est_matches=\(estimate) weight=\(format(weights.ftsWeight))")
+        }
+        if runsVector {
+            lines.append("  VECTOR \(vectorAccess.rawValue.uppercased()) top_k=\(vectorCandidates) depth=\(vectorDepth) weight=\(format(weights.vectorWeight))")
+        }
+        if filterPlacement != .none {
+            lines.append("  FILTER \(filterPlacement.rawValue.uppercased()) selectivity=\(format(statistics.selectivity))")
+        }
+        let store = statistics.vectorStoreCount.map(String.init) ?? "unloaded"
+        lines.append("  STATS clips=\(statistics.totalClips) scope=\(statistics.scopeClips.map(String.init) ?? "all") store=\(store)")
+        if !statistics.termFrequencies.isEmpty {
+            let terms = statistics.termFrequencies.sorted { $0.key < $1.key }
+                .map { "\($0.key)=\($0.value)" }
+                .joined(separator: " ")
+            lines.append("  TERMS \(terms)")
+        }
+        for note in notes {
+            lines.append("  -- \(note)")
+        }
+        return lines.joined(separator: "\n")
+    }
+
+    private func format(_ value: Double) -> String {
+        String(format: "%.2f", value)
+    }
+}
+
+/// 基于代价的混合搜索规划器
+///
+/// 用索引统计替代纯字符串启发式决定执行策略：
+/// - 词项文档频率（`clips_fts_vocab`）估计 FTS 命中数，预估 0 命中时跳过 FTS
+/// - 过滤选择率（按文件夹 / 路径前缀计数）决定先过滤还是后过滤，
+///   以及后过滤时 top-K 的放大倍数
+/// - VectorStore 是否已加载决定精确 top-K 还是 SQLite 扫描
+///
+/// 权重仍以 `SearchEngine.resolveWeights` 为基线（引号 / 长句规则），
+/// 规划器只在统计表明某一路无效或多余时调整。
+public enum QueryPlanner {
+
+    /// 后过滤的选择率下限（低于此值用行位图先过滤）
+    public static let postfilterSelectivity = 0.5
+
+    /// 后过滤 top-K 的额外余量
+    static let postfilterSlack = 1.2
+
+    // MARK: - 查询解析
+
+    /// 查询词项
+    public struct Term: Sendable, Equatable {
+        /// unicode61 分词后的小写词项
+        public let text: String
+        /// 前缀匹配（`foo*`）
+        public let isPrefix: Bool
+        /// 排除项（`NOT foo`）
+        public let isNegated: Bool
+    }
+
+    /// 解析后的查询
+    public struct ParsedQuery: Sendable, Equatable {
+        public var terms: [Term]
+        /// 含引号短语
+        public var hasPhrase: Bool
+        /// 含 OR（命中数为并集）
+        public var hasOr: Bool
+    }
+
+    /// 按 FTS5 语法和 unicode61 分词规则解析查询
+    public static func parse(_ query: String) -> ParsedQuery {
+        var parsed = ParsedQuery(terms: [], hasPhrase: query.contains("\""), hasOr: false)
+        var negateNext = false
+
+        for chunk in chunks(query) {
+            switch chunk.text {
+            case "AND" where !chunk.quoted:
+                continue
+            case "OR" where !chunk.quoted:
+                parsed.hasOr = true
+                continue
+            case "NOT" where !chunk.quoted:
+                negateNext = true
+                continue
+            default:
+                break
+            }
+
+            var text = chunk.text
+            // 列过滤 `tags:海滩`
+            if !chunk.quoted, let colon = text.firstIndex(of: ":") {
+                text = String(text[text.index(after: colon)...])
+            }
+            text = text.trimmingCharacters(in: CharacterSet(charactersIn: "()^+"))
+            let isPrefix = !chunk.quoted && text.hasSuffix("*")
+
+            let tokens = tokenize(text)
+            for (i, token) in tokens.enumerated() {
+                parsed.terms.append(Term(
+                    text: token,
+                    isPrefix: isPrefix && i == tokens.count - 1,
+                    isNegated: negateNext
+                ))
+            }
+            negateNext = false
+        }
+        return parsed
+    }
+
+    /// unicode61 分词：字母/数字/私用区为词字符，其余为分隔符；大小写与变音符折叠
+    static func tokenize(_ text: String) -> [String] {
+        var tokens: [String] = []
+        var current = String.UnicodeScalarView()
+        for scalar in text.unicodeScalars {
+            let isTokenChar = CharacterSet.letters.contains(scalar)
+                || CharacterSet.decimalDigits.contains(scalar)
+                || scalar.properties.generalCategory == .privateUse
+                || scalar.properties.generalCategory == .otherNumber
+                || scalar.properties.generalCategory == .letterNumber
+            if isTokenChar {
+                current.append(scalar)
+            } else if !current.isEmpty {
+                tokens.append(String(current))
+                current = String.UnicodeScalarView()
+            }
+        }
+        if !current.isEmpty { tokens.append(String(current)) }
+        return tokens.map { $0.folding(options: [.caseInsensitive, .diacriticInsensitive], locale: nil) }
+    }
+
+    /// 按空白切分，引号内保持整体
+    private static func chunks(_ query: String) -> [(text: String, quoted: Bool)] {
+        var result: [(String, Bool)] = []
+        var current = ""
+        var inQuote = false
+        for char in query {
+            if char == "\"" {
+                if !current.isEmpty { result.append((current, inQuote)) }
+                current = ""
+                inQuote.toggle()
+            } else if char.isWhitespace && !inQuote {
+                if !current.isEmpty { result.append((current, false)) }
+                current = ""
+            } else {
+                current.append(char)
+            }
+        }
+        if !current.isEmpty { result.append((current, inQuote)) }
+        return result
+    }
+
+    // MARK: - 统计
+
+    /// 收集规划所需统计
+    ///
+    /// 无缓存时 clip 总数与文件夹计数为 `COUNT(*)`（按行数线性），路径前缀为 videos 的 `LIKE` 全扫描；
+    /// 常驻调用方（App / 守护进程）传入 `cache`，这些计数只在同步后重算一次，
+    /// 每次查询只剩 fts5vocab 词频查找。
+    public static func statistics(
+        _ db: Database,
+        query: String,
+        folderPaths: Set<String>? = nil,
+        pathPrefixFilter: String? = nil,
+        vectorStoreCount: Int? = nil,
+        cache: QueryStatisticsCache? = nil
+    ) throws -> QueryStatistics {
+        let totalClips = try cache?.totalClips(db)
+            ?? Int.fetchOne(db, sql: "SELECT COUNT(*) FROM clips") ?? 0
+        var stats = QueryStatistics(totalClips: totalClips, vectorStoreCount: vectorStoreCount)
+
+        // 过滤范围
+        if folderPaths != nil || pathPrefixFilter != nil {
+            var scope = Double(totalClips)
+            if let folderPaths {
+                scope = try Double(cache?.clipCount(db, folderPaths: folderPaths)
+                    ?? folderClipCount(db, folderPaths: folderPaths))
+            }
+            if let pathPrefixFilter {
+                // 路径前缀无法走索引：按视频占比估计，避免 clips ⋈ videos 全扫描
+                scope *= try cache?.pathPrefixFraction(db, prefix: pathPrefixFilter)
+                    ?? pathPrefixFraction(db, prefix: pathPrefixFilter)
+            }
+            stats.scopeClips = Int(scope.rounded(.up))
+        }
+
+        // 词项文档频率
+        let parsed = parse(query)
+        let positives = parsed.terms.filter { !$0.isNegated }
+        guard !positives.isEmpty, try db.tableExists("clips_fts_vocab") else { return stats }
+
+        var frequencies: [Int] = []
+        for term in positives {
+            let doc: Int
+            if term.isPrefix {
+                doc = try Int.fetchOne(db, sql: """
+                    SELECT COALESCE(SUM(doc), 0) FROM clips_fts_vocab WHERE term >= ? AND term < ?
+                    """, arguments: [term.text, term.text + "\u{10FFFF}"]) ?? 0
+            } else {
+                doc = try Int.fetchOne(db, sql: """
+                    SELECT doc FROM clips_fts_vocab WHERE term = ?
+                    """, arguments: [term.text]) ?? 0
+            }
+            stats.termFrequencies[term.text] = doc
+            frequencies.append(doc)
+        }
+        // AND 取最小（上界），OR 取和
+        let estimate = parsed.hasOr ? frequencies.reduce(0, +) : (frequencies.min() ?? 0)
+        stats.ftsEstimate = min(estimate, totalClips)
+        stats.ftsEstimateIsExact = parsed.terms.count == 1 && !positives[0].isPrefix
+        return stats
+    }
+
+    /// 路径前缀下的视频占比（0-1）
+    static func pathPrefixFraction(_ db: Database, prefix: String) throws -> Double {
+        let totalVideos = try Int.fetchOne(db, sql: "SELECT COUNT(*) FROM videos") ?? 0
+        let matchedVideos = try Int.fetchOne(
+            db,
+            sql: "SELECT COUNT(*) FROM videos WHERE file_path LIKE ? || '/%'",
+            arguments: [prefix]
+        ) ?? 0
+        return totalVideos > 0 ? Double(matchedVideos) / Double(totalVideos) : 0
+    }
+
+    private static func folderClipCount(_ db: Database, folderPaths: Set<String>) throws -> Int {
+        guard !folderPaths.isEmpty else { return 0 }
+        let sorted = folderPaths.sorted()
+        let placeholders = sorted.map { _ in "?" }.joined(separator: ", ")
+        var args = StatementArguments()
+        for path in sorted { args += [path] }
+        return try Int.fetchOne(db, sql: """
+            SELECT COUNT(*) FROM clips WHERE source_folder IN (\(placeholders))
+            """, arguments: args) ?? 0
+    }
+
+    // MARK: - 规划
+
+    /// 根据模式与统计生成执行计划
+    ///
+    /// - Parameters:
+    ///   - query: 已 trim 的查询
+    ///   - mode: 搜索模式
+    ///   - hasEmbedding: 能否得到查询向量
+    ///   - statistics: `statistics(_:...)` 的结果
+    ///   - limit: 最终返回条数
+    public static func plan(
+        query: String,
+        mode: SearchEngine.SearchMode,
+        hasEmbedding: Bool,
+        statistics: QueryStatistics,
+        limit: Int
+    ) -> QueryPlan {
+        let limit = max(1, limit)
+        var notes: [String] = []
+        var weights = SearchEngine.resolveWeights(query: query, mode: mode, hasEmbedding: hasEmbedding)
+        let inScope = statistics.ftsEstimateInScope
+        let filtered = statistics.scopeClips != nil
+
+        // 1. 选择执行的分支
+        var runFTS = weights.ftsWeight > 0
+        var runVector = hasEmbedding && weights.vectorWeight > 0
+
+        if filtered, statistics.scopeClips == 0 {
+            runFTS = false
+            runVector = false
+            notes.append("过滤范围为空")
+        }
+        if runFTS, runVector, let inScope, inScope == 0 {
+            runFTS = false
+            weights = SearchEngine.SearchWeights(ftsWeight: 0, vectorWeight: 1)
+            notes.append("词项文档频率为 0，跳过 FTS")
+        }
+        if mode == .auto, runFTS, runVector, weights.ftsWeight >= SearchEngine.SearchWeights.exactMatch.ftsWeight,
+           statistics.ftsEstimateIsExact, !filtered, let inScope, inScope >= limit {
+            runVector = false
+            weights = SearchEngine.SearchWeights(ftsWeight: 1, vectorWeight: 0)
+            notes.append("精确词项命中 \(inScope) ≥ \(limit)，跳过向量检索")
+        }
+
+        // 2. 向量检索方式
+        var access: QueryPlan.VectorAccess = .none
+        if runVector {
+            if statistics.vectorStoreCount != nil {
+                access = .store
+            } else {
+                access = .scan
+                notes.append("VectorStore 未加载，SQLite 逐行扫描 \(statistics.scopeClips ?? statistics.totalClips) 行")
+            }
+        }
+
+        // 3. 取回深度：融合时两路各取 2 倍，单路只取 limit
+        let fused = runFTS && runVector
+        let depth = fused ? limit * 2 : limit
+        let ftsLimit = runFTS ? depth : 0
+
+        // 4. 过滤位置与 top-K
+        var placement: QueryPlan.FilterPlacement = .none
+        var candidates = runVector ? depth : 0
+        if runVector, filtered {
+            if access == .store, statistics.selectivity >= postfilterSelectivity {
+                placement = .postfilter
+                candidates = Int((Double(depth) / statistics.selectivity * postfilterSlack).rounded(.up))
+                notes.append("选择率 \(String(format: "%.2f", statistics.selectivity)) 较高，全库 top-\(candidates) 后过滤")
+            } else {
+                placement = .prefilter
+            }
+        }
+        if let storeCount = statistics.vectorStoreCount, access == .store {
+            candidates = min(candidates, max(storeCount, 1))
+        }
+
+        return QueryPlan(
+            weights: weights,
+            ftsLimit: ftsLimit,
+            vectorAccess: access,
+            vectorCandidates: candidates,
+            vectorDepth: runVector ? depth : 0,
+            filterPlacement: placement,
+            resultLimit: limit,
+            statistics: statistics,
+            notes: notes
+        )
+    }
+}
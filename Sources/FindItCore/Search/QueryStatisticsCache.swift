@@ -0,0 +1,82 @@
+import Foundation
+import GRDB
+
+/// 查询规划统计缓存
+///
+/// clip 总数、各文件夹 clip 数与路径前缀视频占比只随同步变化，
+/// 不必每次搜索都 `COUNT(*)` 全表、`LIKE` 扫描 videos。
+/// 首次使用时一次 `GROUP BY source_folder` 取得总数与各文件夹计数，
+/// 路径前缀按前缀逐个缓存；之后每次规划只剩 fts5vocab 词频查找。
+///
+/// 失效策略：持有方在同步增量、删除视频/文件夹后调用 `invalidate()`。
+/// 读取期间发生失效时不写回，避免把旧计数缓存下来。
+public final class QueryStatisticsCache: @unchecked Sendable {
+
+    private let lock = NSLock()
+
+    /// 失效代数（读取前后比对，期间失效则丢弃结果）
+    private var generation = 0
+
+    /// source_folder → clip 数（nil = 未加载）
+    private var folderCounts: [String: Int]?
+
+    /// 路径前缀 → 匹配视频占比
+    private var prefixFractions: [String: Double] = [:]
+
+    public init() {}
+
+    /// 清空全部缓存计数
+    public func invalidate() {
+        lock.lock(); defer { lock.unlock() }
+        generation += 1
+        folderCounts = nil
+        prefixFractions.removeAll()
+    }
+
+    /// clip 总数
+    func totalClips(_ db: Database) throws -> Int {
+        try counts(db).values.reduce(0, +)
+    }
+
+    /// 指定文件夹的 clip 数之和
+    func clipCount(_ db: Database, folderPaths: Set<String>) throws -> Int {
+        let counts = try counts(db)
+        return folderPaths.reduce(0) { $0 + (counts[$1] ?? 0) }
+    }
+
+    /// 路径前缀下的视频占比（0-1）
+    func pathPrefixFraction(_ db: Database, prefix: String) throws -> Double {
+        lock.lock()
+        let cached = prefixFractions[prefix]
+        let start = generation
+        lock.unlock()
+        if let cached { return cached }
+
+        let fraction = try QueryPlanner.pathPrefixFraction(db, prefix: prefix)
+        lock.lock(); defer { lock.unlock() }
+        if generation == start { prefixFractions[prefix] = fraction }
+        return fraction
+    }
+
+    // MARK: - Private
+
+    private func counts(_ db: Database) throws -> [String: Int] {
+        lock.lock()
+        let cached = folderCounts
+        let start = generation
+        lock.unlock()
+        if let cached { return cached }
+
+        let rows = try Row.fetchAll(db, sql: """
+            SELECT source_folder, COUNT(*) AS clip_count FROM clips GROUP BY source_folder
+            """)
+        var loaded: [String: Int] = [:]
+        for row in rows {
+            let folder: String = row["source_folder"]
+            loaded[folder] = row["clip_count"]
+        }
+        lock.lock(); defer { lock.unlock() }
+        if generation == start { folderCounts = loaded }
+        return loaded
+    }
+}
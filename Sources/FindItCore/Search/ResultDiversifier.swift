@@ -0,0 +1,217 @@
+import Foundation
+import Accelerate
+import GRDB
+
+/// 搜索结果去重 / 多样化
+///
+/// 融合排序之后执行，把两类重复折叠为一组、只保留组内排名最高的一条：
+/// - 副本：`file_hash` 相同且时间范围一致（同一素材拷在多块盘上）
+/// - 近似镜头：向量余弦相似度 ≥ 阈值（同一机位的多条 take）
+///
+/// 分组采用"代表元"贪心：按排名顺序扫描，每条结果与已保留的代表比较，
+/// 命中则并入该组，否则自成一组。只与代表比较，避免相似链条把不同镜头串成一组。
+/// 候选两两相似度由一次 vDSP 矩阵乘（M × Mᵀ）批量计算。
+public enum ResultDiversifier {
+
+    /// 去重参数
+    public struct Options: Sendable {
+        /// 近似判定阈值（余弦相似度）
+        public var similarityThreshold: Float
+        /// 用于近似判定的向量来源
+        public var source: VectorStore.Source
+        /// 向量模型（nil = 视觉默认提取器；文本来源时应传入查询所用模型）
+        public var embeddingModel: String?
+        /// 候选倍数：先取 limit × factor 条再去重截断，保证折叠后仍能填满一页
+        public var candidateFactor: Double
+
+        public init(
+            similarityThreshold: Float = 0.97,
+            source: VectorStore.Source = .visual,
+            embeddingModel: String? = nil,
+            candidateFactor: Double = 1.5
+        ) {
+            self.similarityThreshold = similarityThreshold
+            self.source = source
+            self.embeddingModel = embeddingModel
+            self.candidateFactor = candidateFactor
+        }
+
+        /// 默认：视觉特征 + 0.97 阈值
+        ///
+        /// 阈值尚未在真实素材上校准，调用方默认不去重（`hybridSearch` 的 `diversify` 为 nil），
+        /// 只在能展示 `duplicateClipIds` 的入口（CLI `--dedup`）显式开启。
+        public static let `default` = Options()
+
+        /// 去重前需要的候选条数
+        public func candidateLimit(for limit: Int) -> Int {
+            max(limit, Int((Double(limit) * candidateFactor).rounded(.up)))
+        }
+
+        /// 实际比较的向量模型
+        var resolvedModel: String {
+            embeddingModel ?? TinyImageDescriptor().name
+        }
+    }
+
+    /// 去重并截断
+    ///
+    /// - Parameters:
+    ///   - db: 全局库数据库连接
+    ///   - results: 已按相关度排序的结果
+    ///   - options: 去重参数
+    ///   - limit: 最大返回条数
+    /// - Returns: 每组一条（组内最高分），`duplicateClipIds` 记录被折叠的成员
+    public static func diversify(
+        _ db: Database,
+        results: [SearchEngine.SearchResult],
+        options: Options = .default,
+        limit: Int
+    ) throws -> [SearchEngine.SearchResult] {
+        guard results.count > 1 else { return Array(results.prefix(limit)) }
+
+        let signals = try fetchSignals(db, clipIds: results.map(\.clipId), options: options)
+        let keys = results.map { signals[$0.clipId]?.copyKey }
+        let vectors = results.map { signals[$0.clipId]?.vector }
+        let groups = group(copyKeys: keys, vectors: vectors, threshold: options.similarityThreshold)
+
+        return groups.prefix(limit).map { members in
+            var best = results[members[0]]
+            if members.count > 1 {
+                best.duplicateClipIds = members.dropFirst().map { results[$0].clipId }
+            }
+            return best
+        }
+    }
+
+    // MARK: - 分组
+
+    /// 按排名顺序贪心分组
+    ///
+    /// - Parameters:
+    ///   - copyKeys: 每条结果的副本键（nil = 不参与副本判定）
+    ///   - vectors: 每条结果的向量（nil 或维度不一致 = 不参与近似判定）
+    ///   - threshold: 余弦相似度阈值
+    /// - Returns: 各组成员下标（组按代表排名排序，组内首个为代表）
+    static func group(copyKeys: [String?], vectors: [[Float]?], threshold: Float) -> [[Int]] {
+        let n = copyKeys.count
+        let similarity = gramMatrix(vectors)
+
+        var groups: [[Int]] = []
+        var groupOfKey: [String: Int] = [:]
+        for i in 0..<n {
+            // 1. 副本：同一 file_hash + 时间范围
+            if let key = copyKeys[i], let g = groupOfKey[key] {
+                groups[g].append(i)
+                continue
+            }
+            // 2. 近似镜头：与已保留代表的余弦相似度
+            var matched: Int?
+            if let similarity, similarity.valid[i] {
+                for (index, members) in groups.enumerated() {
+                    let rep = members[0]
+                    guard similarity.valid[rep] else { continue }
+                    if similarity.matrix[i * n + rep] >= threshold {
+                        matched = index
+                        break
+                    }
+                }
+            }
+            if let matched {
+                groups[matched].append(i)
+            } else {
+                groups.append([i])
+                matched = groups.count - 1
+            }
+            if let key = copyKeys[i], groupOfKey[key] == nil {
+                groupOfKey[key] = matched
+            }
+        }
+        return groups
+    }
+
+    /// 批量两两余弦相似度
+    ///
+    /// 有效向量 L2 归一化后排成 M[k×D]，一次 vDSP_mmul 得到 M × Mᵀ。
+    /// 为便于按结果下标查表，返回矩阵按 n×n 展开（无效行全 0）。
+    ///
+    /// - Returns: (各下标是否有有效向量, n×n 相似度)；有效向量不足两个时返回 nil
+    static func gramMatrix(_ vectors: [[Float]?]) -> (valid: [Bool], matrix: [Float])? {
+        let n = vectors.count
+        guard let dimensions = vectors.lazy.compactMap({ $0?.count }).first(where: { $0 > 0 }) else { return nil }
+
+        var valid: [Int] = []
+        var packed: [Float] = []
+        for (i, vector) in vectors.enumerated() {
+            guard let vector, vector.count == dimensions else { continue }
+            let normalized = TinyImageDescriptor.l2Normalized(vector)
+            guard normalized.contains(where: { $0 != 0 }) else { continue }
+            valid.append(i)
+            packed += normalized
+        }
+        let k = valid.count
+        guard k >= 2 else { return nil }
+
+        // M[k×D] × Mᵀ[D×k] → G[k×k]
+        var transposed = [Float](repeating: 0, count: k * dimensions)
+        vDSP_mtrans(packed, 1, &transposed, 1, vDSP_Length(dimensions), vDSP_Length(k))
+        var gram = [Float](repeating: 0, count: k * k)
+        vDSP_mmul(packed, 1, transposed, 1, &gram, 1, vDSP_Length(k), vDSP_Length(k), vDSP_Length(dimensions))
+
+        // 展开到 n×n，按原下标寻址
+        var isValid = [Bool](repeating: false, count: n)
+        for i in valid { isValid[i] = true }
+        var matrix = [Float](repeating: 0, count: n * n)
+        for (a, i) in valid.enumerated() {
+            for (b, j) in valid.enumerated() {
+                matrix[i * n + j] = gram[a * k + b]
+            }
+        }
+        return (isValid, matrix)
+    }
+
+    // MARK: - 数据读取
+
+    /// 单条结果的去重依据
+    struct Signal {
+        var copyKey: String?
+        var vector: [Float]?
+    }
+
+    /// 副本键：file_hash + 时间范围（0.1 秒粒度，容忍浮点误差）
+    static func copyKey(fileHash: String?, startTime: Double, endTime: Double) -> String? {
+        guard let fileHash, !fileHash.isEmpty else { return nil }
+        let start = Int((startTime * 10).rounded())
+        let end = Int((endTime * 10).rounded())
+        return "\(fileHash)#\(start)-\(end)"
+    }
+
+    /// 批量读取 file_hash 与指定来源的向量
+    static func fetchSignals(_ db: Database, clipIds: [Int64], options: Options) throws -> [Int64: Signal] {
+        guard !clipIds.isEmpty else { return [:] }
+        let vectorColumn = options.source.vectorColumn
+        let modelColumn = options.source.modelColumn
+        let placeholders = Array(repeating: "?", count: clipIds.count).joined(separator: ",")
+        var args = StatementArguments()
+        args += [options.resolvedModel]
+        for id in clipIds { args += [id] }
+
+        let rows = try Row.fetchAll(db, sql: """
+            SELECT c.clip_id, c.start_time, c.end_time, v.file_hash,
+                   CASE WHEN c.\(modelColumn) = ? THEN c.\(vectorColumn) END AS vector
+            FROM clips c
+            LEFT JOIN videos v ON v.video_id = c.video_id
+            WHERE c.clip_id IN (\(placeholders))
+            """, arguments: args)
+
+        var signals: [Int64: Signal] = [:]
+        signals.reserveCapacity(rows.count)
+        for row in rows {
+            let data: Data? = row["vector"]
+            signals[row["clip_id"]] = Signal(
+                copyKey: copyKey(fileHash: row["file_hash"], startTime: row["start_time"], endTime: row["end_time"]),
+                vector: data.map(EmbeddingUtils.deserializeEmbedding)
+            )
+        }
+        return signals
+    }
+}
@@ -0,0 +1,82 @@
+import Foundation
+
+/// 与 VectorStore 行号对齐的位图
+///
+/// 第 i 位表示 VectorStore 第 i 行是否在过滤范围内。
+/// 100K clips 仅占 12.5 KB，按 64 位字做交/并运算，
+/// 替代 `Set<Int64>` 逐行哈希探测。
+///
+/// 位图只对生成它的 store 布局（`layout`）有效；
+/// store 行集合变化（load/append/remove/restore）后需重建。
+public struct RowBitmap: Sendable, Equatable {
+
+    /// 生成位图时的 store 布局
+    public let layout: VectorStore.Layout
+
+    /// 行数（位数）
+    public let rowCount: Int
+
+    /// 位存储（每字 64 行）
+    private(set) var words: [UInt64]
+
+    /// 创建空位图
+    public init(layout: VectorStore.Layout, rowCount: Int) {
+        self.layout = layout
+        self.rowCount = rowCount
+        self.words = [UInt64](repeating: 0, count: (rowCount + 63) / 64)
+    }
+
+    /// 置位（越界行忽略）
+    public mutating func insert(_ row: Int) {
+        guard row >= 0, row < rowCount else { return }
+        words[row >> 6] |= 1 << UInt64(row & 63)
+    }
+
+    /// 是否包含指定行
+    public func contains(_ row: Int) -> Bool {
+        guard row >= 0, row < rowCount else { return false }
+        return words[row >> 6] & (1 << UInt64(row & 63)) != 0
+    }
+
+    /// 置位行数
+    public var cardinality: Int {
+        words.reduce(0) { $0 + $1.nonzeroBitCount }
+    }
+
+    /// 是否为空
+    public var isEmpty: Bool {
+        words.allSatisfy { $0 == 0 }
+    }
+
+    /// 交集（布局必须一致）
+    public func intersection(_ other: RowBitmap) -> RowBitmap {
+        precondition(layout == other.layout, "RowBitmap 布局不一致")
+        var result = self
+        for i in result.words.indices {
+            result.words[i] &= other.words[i]
+        }
+        return result
+    }
+
+    /// 并集（布局必须一致）
+    public func union(_ other: RowBitmap) -> RowBitmap {
+        precondition(layout == other.layout, "RowBitmap 布局不一致")
+        var result = self
+        for i in result.words.indices {
+            result.words[i] |= other.words[i]
+        }
+        return result
+    }
+
+    /// 按行号升序遍历置位行
+    public func forEachRow(_ body: (Int) -> Void) {
+        for (wordIndex, word) in words.enumerated() {
+            var remaining = word
+            while remaining != 0 {
+                let bit = remaining.trailingZeroBitCount
+                body(wordIndex << 6 | bit)
+                remaining &= remaining - 1
+            }
+        }
+    }
+}
@@ -0,0 +1,478 @@
+import Foundation
+import GRDB
+
+// MARK: - 协议
+
+/// 常驻搜索守护进程请求（JSON Lines，每行一个请求）
+///
+/// ```
+/// {"id":1,"op":"search","query":"海滩日落","limit":20,"mode":"auto"}
+/// {"id":2,"op":"palette","palette":"orange:2,teal","limit":20}
+/// {"id":3,"op":"similar","clipId":42,"limit":20}
+/// {"id":4,"op":"ping"}
+/// ```
+public struct SearchDaemonRequest: Codable, Sendable, Equatable {
+
+    /// 请求类型
+    public enum Operation: String, Codable, Sendable {
+        /// 搜索
+        case search
+        /// 调色板检索（常驻 `PaletteIndex`）
+        case palette
+        /// 找相似镜头（常驻视觉向量 store）
+        case similar
+        /// 探活
+        case ping
+        /// 运行状态
+        case stats
+        /// 停止守护进程
+        case shutdown
+    }
+
+    /// 请求 ID（原样回显，支持客户端流水线）
+    public var id: Int
+    public var op: Operation
+    public var query: String?
+    public var limit: Int?
+    public var mode: SearchEngine.SearchMode?
+    /// 文件夹过滤（nil = 全部）
+    public var folders: [String]?
+    /// 路径前缀过滤
+    public var pathPrefix: String?
+    /// 是否记录搜索历史
+    public var record: Bool?
+    /// 是否返回执行计划（EXPLAIN）
+    public var explain: Bool?
+    /// 是否折叠副本与近似 take（nil = 不去重）
+    public var dedup: Bool?
+    /// 调色板（op = palette 时，格式同 `ColorSignature.palette(_:)`）
+    public var palette: String?
+    /// 目标 clip_id（op = similar 时，全局库 ID）
+    public var clipId: Int64?
+
+    public init(
+        id: Int,
+        op: Operation,
+        query: String? = nil,
+        limit: Int? = nil,
+        mode: SearchEngine.SearchMode? = nil,
+        folders: [String]? = nil,
+        pathPrefix: String? = nil,
+        record: Bool? = nil,
+        explain: Bool? = nil,
+        dedup: Bool? = nil,
+        palette: String? = nil,
+        clipId: Int64? = nil
+    ) {
+        self.id = id
+        self.op = op
+        self.query = query
+        self.limit = limit
+        self.mode = mode
+        self.folders = folders
+        self.pathPrefix = pathPrefix
+        self.record = record
+        self.explain = explain
+        self.dedup = dedup
+        self.palette = palette
+        self.clipId = clipId
+    }
+}
+
+/// 常驻搜索守护进程响应
+public struct SearchDaemonResponse: Codable, Sendable {
+    public var id: Int
+    public var ok: Bool
+    public var error: String?
+    public var results: [SearchEngine.SearchResult]?
+    /// 实际使用的嵌入模型（nil = 纯 FTS5）
+    public var embeddingModel: String?
+    /// 服务端耗时（毫秒）
+    public var elapsedMs: Double?
+    /// 运行状态（op = stats 时）
+    public var stats: SearchDaemon.Stats?
+    /// 执行计划（请求 explain 时）
+    public var plan: String?
+
+    public init(
+        id: Int,
+        ok: Bool,
+        error: String? = nil,
+        results: [SearchEngine.SearchResult]? = nil,
+        embeddingModel: String? = nil,
+        elapsedMs: Double? = nil,
+        stats: SearchDaemon.Stats? = nil,
+        plan: String? = nil
+    ) {
+        self.id = id
+        self.ok = ok
+        self.error = error
+        self.results = results
+        self.embeddingModel = embeddingModel
+        self.elapsedMs = elapsedMs
+        self.stats = stats
+        self.plan = plan
+    }
+}
+
+// MARK: - 守护进程
+
+/// 常驻搜索服务
+///
+/// 持有全局库连接、embedding provider、预热后的 VectorStore、调色板索引、视觉向量 store
+/// 和查询向量缓存，使批量/脚本调用免去每次冷启动（打开数据库 + 初始化 provider + 全量加载向量 / 签名）。
+/// 传输层见 `SearchDaemonServer`；本类型只负责请求处理，便于测试。
+public actor SearchDaemon {
+
+    /// 运行统计
+    public struct Stats: Codable, Sendable, Equatable {
+        public var requests = 0
+        public var searches = 0
+        public var failures = 0
+        public var vectorCount = 0
+        public var paletteCount = 0
+        public var visualCount = 0
+        public var embeddingModel: String?
+        public var uptimeSeconds: Double = 0
+    }
+
+    /// 默认 socket 路径（~/Library/Application Support/FindIt/search.sock）
+    public static func defaultSocketPath() throws -> String {
+        try DatabaseManager.appSupportDirectory().appendingPathComponent("search.sock").path
+    }
+
+    private let db: DatabaseWriter
+    private let embedder: SpeculativeQueryEmbedder?
+    private let warmup: VectorStoreWarmup?
+    private let filterBitmaps = VectorFilterBitmapCache()
+    private let startedAt = Date()
+    private var stats = Stats()
+
+    /// 常驻调色板索引（首次调色板检索时加载，之后随同步增量刷新）
+    private var paletteIndex: PaletteIndex?
+
+    /// 常驻视觉向量 store（首次找相似镜头时加载，之后随同步增量刷新）
+    private var visualStore: VectorStore?
+    /// 视觉 store 的过滤位图（与文本 store 分开缓存，避免交替查询互相挤出）
+    private let visualBitmaps = VectorFilterBitmapCache()
+
+    /// 规划统计缓存（clip 总数 / 文件夹计数，随同步失效）
+    private let plannerStatistics = QueryStatisticsCache()
+
+    /// 常驻索引对应的全局库指纹（其他进程索引后据此判定过期）
+    private var indexFingerprint: VectorStoreSnapshot.Fingerprint?
+    private var lastFreshnessCheck: Date = .distantPast
+
+    /// 指纹检查最小间隔（秒）
+    static let freshnessCheckInterval: TimeInterval = 5
+    private var shutdownHandler: (@Sendable () -> Void)?
+
+    /// - Parameters:
+    ///   - db: 全局搜索索引
+    ///   - provider: 查询嵌入 provider（nil = 仅 FTS5）
+    ///   - snapshotURL: VectorStore 快照路径（nil = 不使用快照）
+    public init(
+        db: DatabaseWriter,
+        provider: (any EmbeddingProvider)?,
+        snapshotURL: URL? = nil
+    ) {
+        self.db = db
+        if let provider {
+            self.embedder = SpeculativeQueryEmbedder(provider: provider, capacity: 256)
+            self.warmup = VectorStoreWarmup(
+                db: db,
+                embeddingModel: provider.name,
+                dimensions: provider.dimensions,
+                snapshotURL: snapshotURL
+            )
+        } else {
+            self.embedder = nil
+            self.warmup = nil
+        }
+        self.stats.embeddingModel = provider?.name
+    }
+
+    /// 启动 VectorStore 后台预热
+    public func start() async {
+        await warmup?.start(priority: .userInitiated)
+    }
+
+    /// 收到 shutdown 请求时的回调
+    public func onShutdown(_ handler: @escaping @Sendable () -> Void) {
+        shutdownHandler = handler
+    }
+
+    /// 处理一行请求（JSON），返回一行响应（JSON，不含换行）
+    public func handle(line: Data) async -> Data {
+        let response: SearchDaemonResponse
+        do {
+            let request = try JSONDecoder().decode(SearchDaemonRequest.self, from: line)
+            response = await handle(request)
+        } catch {
+            stats.failures += 1
+            response = SearchDaemonResponse(id: 0, ok: false, error: "无效请求: \(error.localizedDescription)")
+        }
+        return (try? JSONEncoder().encode(response)) ?? Data(#"{"id":0,"ok":false}"#.utf8)
+    }
+
+    /// 处理单个请求
+    public func handle(_ request: SearchDaemonRequest) async -> SearchDaemonResponse {
+        stats.requests += 1
+        switch request.op {
+        case .ping:
+            return SearchDaemonResponse(id: request.id, ok: true)
+        case .stats:
+            var snapshot = stats
+            snapshot.uptimeSeconds = Date().timeIntervalSince(startedAt)
+            if case .ready(let count, _) = await warmup?.status {
+                snapshot.vectorCount = count
+            }
+            snapshot.paletteCount = paletteIndex?.count ?? 0
+            snapshot.visualCount = await visualStore?.count ?? 0
+            return SearchDaemonResponse(id: request.id, ok: true, stats: snapshot)
+        case .shutdown:
+            shutdownHandler?()
+            return SearchDaemonResponse(id: request.id, ok: true)
+        case .search, .palette, .similar:
+            do {
+                switch request.op {
+                case .palette: return try await paletteSearch(request)
+                case .similar: return try await similarSearch(request)
+                default: return try await search(request)
+                }
+            } catch {
+                stats.failures += 1
+                return SearchDaemonResponse(id: request.id, ok: false, error: error.localizedDescription)
+            }
+        }
+    }
+
+    /// 按同步增量原地刷新常驻索引（与 App 的 `SearchState.applySyncDelta` 对应）
+    ///
+    /// 同进程内的同步直接调用。全部索引刷新成功时记下当前指纹，
+    /// 随后的过期检查不会再整体重建；否则交由过期检查丢弃重建。
+    public func applySyncDelta(_ result: SyncEngine.SyncResult) async {
+        guard result.hasClipChanges else { return }
+        var complete = true
+
+        if let warmup {
+            if case .ready = await warmup.status, let store = await warmup.store() {
+                do {
+                    try await store.applySyncDelta(result, from: db)
+                    await warmup.scheduleSnapshotSave()
+                } catch {
+                    complete = false
+                }
+            } else {
+                // 预热中：构建可能早于本次同步读取，无法确认已包含
+                complete = false
+            }
+        }
+
+        if let index = paletteIndex {
+            do {
+                paletteIndex = try await db.read { dbConn in
+                    var updated = index
+                    try updated.applySyncDelta(result, from: dbConn)
+                    return updated
+                }
+            } catch {
+                paletteIndex = nil
+            }
+        }
+
+        if let visual = visualStore {
+            do {
+                try await visual.applySyncDelta(result, from: db)
+            } catch {
+                visualStore = nil
+            }
+        }
+
+        // 增删行后位图按布局自动重建；同步可能改写路径，前缀位图显式失效
+        await filterBitmaps.invalidatePathPrefixes()
+        await visualBitmaps.invalidatePathPrefixes()
+        plannerStatistics.invalidate()
+
+        if complete {
+            indexFingerprint = try? await db.read { try VectorStoreSnapshot.Fingerprint.current($0) }
+        }
+    }
+
+    // MARK: - Private
+
+    private func search(_ request: SearchDaemonRequest) async throws -> SearchDaemonResponse {
+        let start = DispatchTime.now().uptimeNanoseconds
+        let query = (request.query ?? "").trimmingCharacters(in: .whitespacesAndNewlines)
+        guard !query.isEmpty else {
+            return SearchDaemonResponse(id: request.id, ok: false, error: "缺少 query")
+        }
+        stats.searches += 1
+
+        let mode = request.mode ?? .auto
+        let limit = max(1, request.limit ?? 20)
+        let folders = request.folders.map(Set.init)
+        let pathPrefix = request.pathPrefix
+
+        // 按索引统计规划（FTS 已足够时不计算查询向量）；其他进程写入后统计缓存随指纹失效
+        await discardStaleIndexes()
+        var store: VectorStore?
+        if mode != .fts, embedder != nil {
+            store = await currentStore()
+        }
+        let storeCount = await store?.count
+        let hasEmbedder = embedder != nil
+        let statisticsCache = plannerStatistics
+        let plan = try await db.read { dbConn in
+            let statistics = try QueryPlanner.statistics(
+                dbConn, query: query,
+                folderPaths: folders, pathPrefixFilter: pathPrefix,
+                vectorStoreCount: storeCount, cache: statisticsCache
+            )
+            return QueryPlanner.plan(query: query, mode: mode, hasEmbedding: hasEmbedder, statistics: statistics, limit: limit)
+        }
+
+        // 查询向量（LRU 缓存命中时无需调用模型）
+        var queryEmbedding: [Float]?
+        var storeResults: [(clipId: Int64, similarity: Float)]?
+        if plan.runsVector, let embedder {
+            queryEmbedding = try? await embedder.embedding(for: query)
+            if let embedding = queryEmbedding, plan.vectorAccess == .store, let store {
+                storeResults = try await filterBitmaps.search(
+                    store: store,
+                    query: embedding,
+                    plan: plan,
+                    folders: folders,
+                    pathPrefix: pathPrefix,
+                    db: db
+                )
+            }
+        }
+
+        let model = queryEmbedding != nil ? embedder?.provider.name : nil
+        let embedding = queryEmbedding
+        let capturedStoreResults = storeResults
+        let diversify: ResultDiversifier.Options? = request.dedup == true ? .default : nil
+        let results = try await db.read { dbConn in
+            try SearchEngine.hybridSearch(
+                dbConn,
+                query: query,
+                queryEmbedding: embedding,
+                embeddingModel: model,
+                vectorStoreResults: capturedStoreResults,
+                mode: mode,
+                plan: plan,
+                folderPaths: folders,
+                pathPrefixFilter: pathPrefix,
+                limit: limit,
+                diversify: diversify
+            )
+        }
+
+        if request.record == true {
+            let count = results.count
+            try? await db.write { dbConn in
+                try SearchEngine.recordSearch(dbConn, query: query, resultCount: count)
+            }
+        }
+
+        let elapsed = Double(DispatchTime.now().uptimeNanoseconds - start) / 1_000_000
+        return SearchDaemonResponse(
+            id: request.id,
+            ok: true,
+            results: results,
+            embeddingModel: model,
+            elapsedMs: elapsed,
+            plan: request.explain == true ? plan.explain() : nil
+        )
+    }
+
+    private func paletteSearch(_ request: SearchDaemonRequest) async throws -> SearchDaemonResponse {
+        let start = DispatchTime.now().uptimeNanoseconds
+        guard let spec = request.palette else {
+            return SearchDaemonResponse(id: request.id, ok: false, error: "缺少 palette")
+        }
+        let signature = try ColorSignature.palette(spec)
+        stats.searches += 1
+
+        let index = try await currentPaletteIndex()
+        let limit = max(1, request.limit ?? 20)
+        let folders = request.folders.map(Set.init)
+        let results = try await db.read { dbConn in
+            try SearchEngine.paletteSearch(dbConn, palette: signature, index: index, folderPaths: folders, limit: limit)
+        }
+
+        let elapsed = Double(DispatchTime.now().uptimeNanoseconds - start) / 1_000_000
+        return SearchDaemonResponse(id: request.id, ok: true, results: results, elapsedMs: elapsed)
+    }
+
+    private func similarSearch(_ request: SearchDaemonRequest) async throws -> SearchDaemonResponse {
+        let start = DispatchTime.now().uptimeNanoseconds
+        guard let clipId = request.clipId else {
+            return SearchDaemonResponse(id: request.id, ok: false, error: "缺少 clipId")
+        }
+        stats.searches += 1
+
+        let store = try await currentVisualStore()
+        let model = store.embeddingModel
+        guard try await db.read({ try VisualSimilarity.vector($0, clipId: clipId, model: model) }) != nil else {
+            return SearchDaemonResponse(id: request.id, ok: false, error: "clip \(clipId) 没有视觉特征（需重新索引）")
+        }
+        let results = try await VisualSimilarity.similarClips(
+            to: clipId, store: store, db: db,
+            folderPaths: request.folders.map(Set.init),
+            limit: max(1, request.limit ?? 20),
+            filterBitmaps: visualBitmaps
+        )
+
+        let elapsed = Double(DispatchTime.now().uptimeNanoseconds - start) / 1_000_000
+        return SearchDaemonResponse(id: request.id, ok: true, results: results, elapsedMs: elapsed)
+    }
+
+    /// 获取 VectorStore（过期时由预热器重建）
+    private func currentStore() async -> VectorStore? {
+        guard let warmup else { return nil }
+        await discardStaleIndexes()
+        return await warmup.store()
+    }
+
+    /// 获取常驻调色板索引（未加载或已过期时从全局库加载）
+    private func currentPaletteIndex() async throws -> PaletteIndex {
+        await discardStaleIndexes()
+        if let paletteIndex { return paletteIndex }
+        let loaded = try await db.read { try PaletteIndex.load($0) }
+        paletteIndex = loaded
+        return loaded
+    }
+
+    /// 获取常驻视觉向量 store（未加载或已过期时从全局库加载）
+    private func currentVisualStore() async throws -> VectorStore {
+        await discardStaleIndexes()
+        if let visualStore { return visualStore }
+        let loaded = try await VisualSimilarity.loadStore(from: db)
+        visualStore = loaded
+        return loaded
+    }
+
+    /// 定期比对全局库指纹，丢弃过期的常驻索引（下次使用时重建）
+    ///
+    /// 其他进程（App / CLI 索引）的同步与删除不经过 `applySyncDelta`，
+    /// 只能通过指纹发现；检查本身只是两条聚合查询。
+    private func discardStaleIndexes() async {
+        let now = Date()
+        guard now.timeIntervalSince(lastFreshnessCheck) >= Self.freshnessCheckInterval else { return }
+        lastFreshnessCheck = now
+        guard let current = try? await db.read({ try VectorStoreSnapshot.Fingerprint.current($0) }) else {
+            return
+        }
+        if let previous = indexFingerprint, previous != current {
+            await warmup?.invalidate()
+            await filterBitmaps.invalidate()
+            await visualBitmaps.invalidate()
+            plannerStatistics.invalidate()
+            paletteIndex = nil
+            visualStore = nil
+        }
+        indexFingerprint = current
+    }
+}
@@ -0,0 +1,303 @@
+import Foundation
+
+/// 守护进程 socket 错误
+public enum SearchDaemonSocketError: LocalizedError {
+    /// socket 路径超过 sun_path 上限
+    case pathTooLong(String)
+    /// 系统调用失败
+    case systemCall(String, errno: Int32)
+    /// 守护进程未运行或连接被拒绝
+    case notRunning(String)
+    /// socket 路径上已有守护进程在监听
+    case alreadyRunning(String)
+    /// 响应不完整或无法解析
+    case badResponse
+
+    public var errorDescription: String? {
+        switch self {
+        case .pathTooLong(let path):
+            return "socket 路径过长: \(path)"
+        case .systemCall(let call, let code):
+            return "\(call) 失败: \(String(cString: strerror(code)))"
+        case .notRunning(let path):
+            return "搜索守护进程未运行: \(path)"
+        case .alreadyRunning(let path):
+            return "搜索守护进程已在运行: \(path)"
+        case .badResponse:
+            return "搜索守护进程响应无效"
+        }
+    }
+}
+
+// MARK: - 服务端
+
+/// Unix domain socket 传输层（JSON Lines）
+///
+/// 每个连接一个读循环，请求按行顺序处理、按行顺序回写，
+/// 客户端可在一个连接上流水线发送多条请求。
+public final class SearchDaemonServer: @unchecked Sendable {
+
+    public let socketPath: String
+    private let daemon: SearchDaemon
+    private var listenFD: Int32 = -1
+    private let queue = DispatchQueue(label: "findit.search-daemon.accept")
+
+    public init(socketPath: String, daemon: SearchDaemon) {
+        self.socketPath = socketPath
+        self.daemon = daemon
+    }
+
+    deinit {
+        stop()
+    }
+
+    /// 绑定并开始监听
+    ///
+    /// 路径上已有 socket 时先试连：有守护进程在监听则抛出 `.alreadyRunning`，
+    /// 只有连接被拒绝（上次异常退出的残留文件）才删除后重新绑定。
+    public func start() throws {
+        try SearchDaemonSocket.removeStaleSocket(at: socketPath)
+        let fd = try SearchDaemonSocket.makeSocket()
+        var addr = try SearchDaemonSocket.address(for: socketPath)
+        // 仅当前用户可访问：bind 创建 socket 文件时即为 0600，不留默认权限窗口
+        let previousMask = umask(0o177)
+        let bound = withUnsafePointer(to: &addr) {
+            $0.withMemoryRebound(to: sockaddr.self, capacity: 1) {
+                bind(fd, $0, socklen_t(MemoryLayout<sockaddr_un>.size))
+            }
+        }
+        let bindErrno = errno
+        umask(previousMask)
+        guard bound == 0 else {
+            close(fd)
+            throw SearchDaemonSocketError.systemCall("bind", errno: bindErrno)
+        }
+        guard listen(fd, 64) == 0 else {
+            let code = errno
+            close(fd)
+            throw SearchDaemonSocketError.systemCall("listen", errno: code)
+        }
+        listenFD = fd
+        queue.async { [weak self] in self?.acceptLoop(fd) }
+    }
+
+    /// 停止监听并删除 socket 文件
+    public func stop() {
+        guard listenFD >= 0 else { return }
+        shutdown(listenFD, Int32(SHUT_RDWR))
+        close(listenFD)
+        listenFD = -1
+        unlink(socketPath)
+    }
+
+    // MARK: - Private
+
+    private func acceptLoop(_ fd: Int32) {
+        while true {
+            let client = accept(fd, nil, nil)
+            if client < 0 {
+                if errno == EINTR { continue }
+                return // 监听 socket 已关闭
+            }
+            SearchDaemonSocket.disableSigpipe(client)
+            let daemon = self.daemon
+            Thread.detachNewThread {
+                Self.serve(client: client, daemon: daemon)
+            }
+        }
+    }
+
+    /// 连接读循环（专用线程阻塞读，请求交给 actor 处理）
+    private static func serve(client: Int32, daemon: SearchDaemon) {
+        defer { close(client) }
+        // 请求行有上限：客户端不发换行也不会让守护进程内存无限增长
+        var reader = SearchDaemonSocket.LineReader(fd: client, maxLineLength: SearchDaemonSocket.maxRequestLength)
+        while let line = reader.nextLine() {
+            guard !line.isEmpty else { continue }
+            let response = SearchDaemonSocket.blockingAwait {
+                await daemon.handle(line: line)
+            }
+            guard SearchDaemonSocket.writeLine(client, response) else { return }
+        }
+    }
+}
+
+// MARK: - 客户端
+
+/// 守护进程同步客户端（CLI `search --daemon` 使用）
+public final class SearchDaemonClient {
+
+    private let fd: Int32
+    private var reader: SearchDaemonSocket.LineReader
+    private var nextID = 1
+
+    /// 连接到守护进程
+    ///
+    /// - Throws: 守护进程未运行时抛出 `.notRunning`
+    public init(socketPath: String) throws {
+        let fd = try SearchDaemonSocket.makeSocket()
+        var addr = try SearchDaemonSocket.address(for: socketPath)
+        let connected = withUnsafePointer(to: &addr) {
+            $0.withMemoryRebound(to: sockaddr.self, capacity: 1) {
+                connect(fd, $0, socklen_t(MemoryLayout<sockaddr_un>.size))
+            }
+        }
+        guard connected == 0 else {
+            close(fd)
+            throw SearchDaemonSocketError.notRunning(socketPath)
+        }
+        SearchDaemonSocket.disableSigpipe(fd)
+        self.fd = fd
+        self.reader = SearchDaemonSocket.LineReader(fd: fd, maxLineLength: SearchDaemonSocket.maxResponseLength)
+    }
+
+    deinit {
+        close(fd)
+    }
+
+    /// 发送请求并等待响应（请求 ID 自动分配）
+    public func send(_ request: SearchDaemonRequest) throws -> SearchDaemonResponse {
+        var request = request
+        request.id = nextID
+        nextID += 1
+
+        let payload = try JSONEncoder().encode(request)
+        guard SearchDaemonSocket.writeLine(fd, payload) else {
+            throw SearchDaemonSocketError.systemCall("write", errno: errno)
+        }
+        guard let line = reader.nextLine() else {
+            throw SearchDaemonSocketError.badResponse
+        }
+        let response = try JSONDecoder().decode(SearchDaemonResponse.self, from: line)
+        guard response.id == request.id else { throw SearchDaemonSocketError.badResponse }
+        return response
+    }
+}
+
+// MARK: - 内部工具
+
+enum SearchDaemonSocket {
+
+    /// 单条请求上限（查询 JSON 远小于此）
+    static let maxRequestLength = 1 << 20
+
+    /// 单条响应上限（大 limit 的结果列表）
+    static let maxResponseLength = 64 << 20
+
+    /// 删除残留 socket 文件（有守护进程在监听时抛出 `.alreadyRunning`）
+    static func removeStaleSocket(at path: String) throws {
+        let fd = try makeSocket()
+        defer { close(fd) }
+        var addr = try address(for: path)
+        let connected = withUnsafePointer(to: &addr) {
+            $0.withMemoryRebound(to: sockaddr.self, capacity: 1) {
+                connect(fd, $0, socklen_t(MemoryLayout<sockaddr_un>.size))
+            }
+        }
+        if connected == 0 {
+            throw SearchDaemonSocketError.alreadyRunning(path)
+        }
+        switch errno {
+        case ENOENT:
+            return
+        case ECONNREFUSED:
+            unlink(path)
+        case let code:
+            throw SearchDaemonSocketError.systemCall("connect", errno: code)
+        }
+    }
+
+    static func makeSocket() throws -> Int32 {
+        let fd = socket(AF_UNIX, Int32(SOCK_STREAM), 0)
+        guard fd >= 0 else {
+            throw SearchDaemonSocketError.systemCall("socket", errno: errno)
+        }
+        return fd
+    }
+
+    static func address(for path: String) throws -> sockaddr_un {
+        var addr = sockaddr_un()
+        addr.sun_family = sa_family_t(AF_UNIX)
+        let bytes = Array(path.utf8)
+        let capacity = MemoryLayout.size(ofValue: addr.sun_path)
+        guard bytes.count < capacity else {
+            throw SearchDaemonSocketError.pathTooLong(path)
+        }
+        withUnsafeMutableBytes(of: &addr.sun_path) { buffer in
+            buffer.copyBytes(from: bytes)
+            buffer[bytes.count] = 0
+        }
+        return addr
+    }
+
+    /// 对端关闭时 write 返回 EPIPE 而不是杀死进程
+    static func disableSigpipe(_ fd: Int32) {
+        var on: Int32 = 1
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, socklen_t(MemoryLayout<Int32>.size))
+    }
+
+    /// 写入一行（自动追加换行），失败返回 false
+    static func writeLine(_ fd: Int32, _ payload: Data) -> Bool {
+        var data = payload
+        data.append(0x0A)
+        return data.withUnsafeBytes { buffer in
+            var offset = 0
+            while offset < buffer.count {
+                let written = write(fd, buffer.baseAddress! + offset, buffer.count - offset)
+                if written < 0 {
+                    if errno == EINTR { continue }
+                    return false
+                }
+                offset += written
+            }
+            return true
+        }
+    }
+
+    /// 在当前（非协作池）线程上同步等待异步结果
+    static func blockingAwait<T: Sendable>(_ operation: @escaping @Sendable () async -> T) -> T {
+        let semaphore = DispatchSemaphore(value: 0)
+        let box = ResultBox<T>()
+        Task {
+            box.value = await operation()
+            semaphore.signal()
+        }
+        semaphore.wait()
+        return box.value!
+    }
+
+    private final class ResultBox<T>: @unchecked Sendable {
+        var value: T?
+    }
+
+    /// 按换行切分的缓冲读取器
+    struct LineReader {
+        let fd: Int32
+        /// 单行上限（字节，不含换行）
+        let maxLineLength: Int
+        private var buffer = Data()
+
+        init(fd: Int32, maxLineLength: Int) {
+            self.fd = fd
+            self.maxLineLength = maxLineLength
+        }
+
+        /// 读取下一行（不含换行符），连接关闭或行超过上限返回 nil
+        mutating func nextLine() -> Data? {
+            var chunk = [UInt8](repeating: 0, count: 64 * 1024)
+            while true {
+                if let newline = buffer.firstIndex(of: 0x0A) {
+                    guard newline - buffer.startIndex <= maxLineLength else { return nil }
+                    let line = buffer[buffer.startIndex..<newline]
+                    buffer.removeSubrange(buffer.startIndex...newline)
+                    return Data(line)
+                }
+                guard buffer.count <= maxLineLength else { return nil }
+                let count = read(fd, &chunk, chunk.count)
+                if count < 0, errno == EINTR { continue }
+                guard count > 0 else { return nil }
+                buffer.append(contentsOf: chunk[0..<count])
+            }
+        }
+    }
+}
@@ -0,0 +1,213 @@
+import Foundation
+
+/// 推测式查询嵌入器
+///
+/// 在 FTS 即时搜索 + 向量搜索 debounce 的两层模型中，把查询嵌入
+/// 提前到 debounce 结束之前：输入停顿 `idleInterval` 后为当前文本启动 `embed`，
+/// debounce 结束时通常已经拿到向量，可直接进入 VectorStore 搜索。
+///
+/// 设计决策：
+/// - 嵌入可能是按次计费的远程 API：短于 `minimumLength` 的输入不推测，
+///   连续输入期间只保留最后一个待发请求，停顿后才真正调用模型
+/// - 同一时刻最多一个推测任务在飞，新输入到达时取消旧任务；
+///   尚未发出的请求被取消后不会再调用模型
+/// - 小容量 LRU 缓存最近的前缀向量（退格、重复输入直接命中）
+/// - `embedding(for:)` 优先复用缓存/在飞任务，未命中才现场计算
+public actor SpeculativeQueryEmbedder {
+
+    /// 命中统计（调试/观测用）
+    public struct Stats: Sendable, Equatable {
+        /// 缓存直接命中
+        public var cacheHits = 0
+        /// 复用在飞的推测任务
+        public var inFlightHits = 0
+        /// 未命中，现场计算
+        public var misses = 0
+        /// 被新输入取消的推测任务（含尚未发出的待发请求）
+        public var cancelled = 0
+    }
+
+    /// 嵌入提供者
+    public nonisolated let provider: any EmbeddingProvider
+
+    /// 缓存容量（条）
+    public let capacity: Int
+
+    /// 推测的最短输入（字符数，归一化后）
+    public let minimumLength: Int
+
+    /// 输入停顿多久后才发出推测请求
+    public let idleInterval: Duration
+
+    /// 当前统计
+    public private(set) var stats = Stats()
+
+    /// 前缀 → 向量缓存
+    private var cache: [String: [Float]] = [:]
+
+    /// LRU 顺序（末尾最近使用）
+    private var recency: [String] = []
+
+    /// 在飞的推测任务
+    private var inFlight: (text: String, task: Task<[Float], Error>)?
+
+    /// 等待输入停顿、尚未发出的推测请求
+    private var pending: (text: String, task: Task<Void, Never>)?
+
+    public init(
+        provider: any EmbeddingProvider,
+        capacity: Int = 16,
+        minimumLength: Int = 2,
+        idleInterval: Duration = .milliseconds(150)
+    ) {
+        self.provider = provider
+        self.capacity = max(1, capacity)
+        self.minimumLength = max(1, minimumLength)
+        self.idleInterval = idleInterval
+    }
+
+    // MARK: - 公开方法
+
+    /// 为当前输入安排推测嵌入（立即返回）
+    ///
+    /// 输入停顿 `idleInterval` 后才发出请求，期间的新输入替换待发请求；
+    /// 已缓存、已在飞或已待发的相同文本不会重复请求；
+    /// 过短的输入不推测，并取消旧文本的请求。
+    public func prefetch(_ text: String) {
+        let key = Self.normalize(text)
+        guard key.count >= minimumLength else {
+            cancelPending()
+            return
+        }
+        if cache[key] != nil {
+            touch(key)
+            return
+        }
+        if inFlight?.text == key || pending?.text == key { return }
+        schedule(key)
+    }
+
+    /// 获取查询向量（debounce 结束后调用）
+    ///
+    /// 命中缓存立即返回；命中在飞任务则等待其完成；否则现场计算。
+    /// 若等待期间任务被更新的输入取消，抛出 `CancellationError`。
+    public func embedding(for text: String) async throws -> [Float] {
+        let key = Self.normalize(text)
+        if let cached = cache[key] {
+            touch(key)
+            stats.cacheHits += 1
+            return cached
+        }
+
+        let task: Task<[Float], Error>
+        if let current = inFlight, current.text == key {
+            stats.inFlightHits += 1
+            task = current.task
+        } else if let waiting = pending, waiting.text == key {
+            // 待发请求正是所需文本：不再等停顿，立即发出
+            stats.inFlightHits += 1
+            waiting.task.cancel()
+            pending = nil
+            task = start(key)
+        } else {
+            stats.misses += 1
+            task = start(key)
+        }
+
+        let vector = try await task.value
+        finish(key, vector: vector)
+        return vector
+    }
+
+    /// 取消待发与在飞任务（例如清空搜索框）
+    public func cancelPending() {
+        if let waiting = pending {
+            waiting.task.cancel()
+            stats.cancelled += 1
+        }
+        pending = nil
+        if let current = inFlight {
+            current.task.cancel()
+            stats.cancelled += 1
+        }
+        inFlight = nil
+    }
+
+    /// 是否已缓存指定文本的向量
+    public func isCached(_ text: String) -> Bool {
+        cache[Self.normalize(text)] != nil
+    }
+
+    // MARK: - Private
+
+    /// 安排待发请求：停顿 `idleInterval` 后仍是最新输入才发出
+    private func schedule(_ key: String) {
+        guard idleInterval > .zero else {
+            start(key)
+            return
+        }
+        cancelPending()
+
+        let delay = idleInterval
+        let task = Task { [weak self] in
+            try? await Task.sleep(for: delay)
+            guard !Task.isCancelled else { return }
+            await self?.firePending(key)
+        }
+        pending = (text: key, task: task)
+    }
+
+    /// 停顿结束：发出仍有效的待发请求
+    private func firePending(_ key: String) {
+        guard pending?.text == key else { return }
+        pending = nil
+        start(key)
+    }
+
+    /// 启动新的推测任务（取消旧任务）
+    @discardableResult
+    private func start(_ key: String) -> Task<[Float], Error> {
+        cancelPending()
+
+        let provider = self.provider
+        let task = Task<[Float], Error> {
+            // 发出前已被取消（新输入到达）则不调用模型
+            try Task.checkCancellation()
+            return try await provider.embed(text: key)
+        }
+        inFlight = (text: key, task: task)
+
+        // 推测结果落入缓存（调用方未等待时也能被后续查询复用）
+        Task { [weak self] in
+            guard let vector = try? await task.value else { return }
+            await self?.finish(key, vector: vector)
+        }
+        return task
+    }
+
+    /// 记录完成结果并清理在飞状态
+    private func finish(_ key: String, vector: [Float]) {
+        if inFlight?.text == key {
+            inFlight = nil
+        }
+        guard !vector.isEmpty else { return }
+        if cache[key] == nil, cache.count >= capacity, let oldest = recency.first {
+            cache.removeValue(forKey: oldest)
+            recency.removeFirst()
+        }
+        cache[key] = vector
+        touch(key)
+    }
+
+    private func touch(_ key: String) {
+        if let idx = recency.firstIndex(of: key) {
+            recency.remove(at: idx)
+        }
+        recency.append(key)
+    }
+
+    /// 与 SearchState 相同的查询归一化（去首尾空白）
+    static func normalize(_ text: String) -> String {
+        text.trimmingCharacters(in: .whitespacesAndNewlines)
+    }
+}
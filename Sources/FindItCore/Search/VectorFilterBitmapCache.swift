@@ -0,0 +1,225 @@
+import Foundation
+import GRDB
+
+/// 向量搜索过滤位图缓存
+///
+/// 按"过滤原子"（单个文件夹 / 路径前缀）缓存与 VectorStore 行对齐的 `RowBitmap`，
+/// 组合过滤时用位运算合成：文件夹集合取并集，再与路径前缀取交集。
+/// 侧边栏在文件夹之间切换只命中已有位图，不再重新查询、构建 clip_id 集合。
+///
+/// 失效策略：
+/// - 位图绑定 store 布局，store 增删行或被替换后自动按需重建
+/// - 路径变化等不改变行集合的数据变更需调用 `invalidatePathPrefixes()` / `invalidate()`
+public actor VectorFilterBitmapCache {
+
+    /// 过滤原子
+    public enum Scope: Hashable, Sendable {
+        /// 单个索引文件夹（clips.source_folder）
+        case folder(String)
+        /// 视频路径前缀（子文件夹书签）
+        case pathPrefix(String)
+    }
+
+    /// 命中统计
+    public struct Stats: Sendable, Equatable {
+        public var hits = 0
+        public var misses = 0
+    }
+
+    /// 最多缓存的原子位图数
+    public let capacity: Int
+
+    /// 当前统计
+    public private(set) var stats = Stats()
+
+    /// 原子 → 位图
+    private var entries: [Scope: RowBitmap] = [:]
+
+    /// LRU 顺序（末尾最近使用）
+    private var recency: [Scope] = []
+
+    public init(capacity: Int = 32) {
+        self.capacity = max(1, capacity)
+    }
+
+    // MARK: - 公开方法
+
+    /// 清空全部位图
+    public func invalidate() {
+        entries.removeAll()
+        recency.removeAll()
+    }
+
+    /// 清空路径前缀位图（视频路径变化时调用）
+    ///
+    /// 卷重新挂载后的路径重定向改写 `file_path` 而 clip_id 不变，
+    /// store 布局不变，前缀位图不会自动过期；文件夹位图按 source_folder 键控，不受影响。
+    public func invalidatePathPrefixes() {
+        let isPrefix: (Scope) -> Bool = { scope in
+            if case .pathPrefix = scope { return true }
+            return false
+        }
+        entries = entries.filter { !isPrefix($0.key) }
+        recency.removeAll(where: isPrefix)
+    }
+
+    /// 解析过滤条件对应的行位图
+    ///
+    /// 构建期间 store 发生增删时，返回的位图布局已过期，
+    /// `VectorStore.search(query:limit:allowedRows:)` 会拒绝并返回 nil。
+    ///
+    /// - Returns: nil 表示无需过滤（全局搜索）；空位图表示过滤后无候选
+    public func bitmap(
+        folders: Set<String>?,
+        pathPrefix: String?,
+        store: VectorStore,
+        db: DatabaseReader
+    ) async throws -> RowBitmap? {
+        guard folders != nil || pathPrefix != nil else { return nil }
+        // 空位图与布局一次取得，保证行数与布局一致
+        let empty = await store.rowBitmap(for: [Int64]())
+        let layout = empty.layout
+
+        var result: RowBitmap?
+        if let folders {
+            var combined = empty
+            for folder in folders.sorted() {
+                let folderBitmap = try await atom(.folder(folder), layout: layout, store: store, db: db)
+                guard folderBitmap.layout == layout else { return folderBitmap }
+                combined = combined.union(folderBitmap)
+            }
+            result = combined
+        }
+        if let pathPrefix {
+            let prefixBitmap = try await atom(.pathPrefix(pathPrefix), layout: layout, store: store, db: db)
+            guard prefixBitmap.layout == layout else { return prefixBitmap }
+            result = result.map { $0.intersection(prefixBitmap) } ?? prefixBitmap
+        }
+        return result
+    }
+
+    /// 带过滤的向量搜索
+    ///
+    /// 搜索期间 store 若发生增删（位图过期），重建位图重试一次；
+    /// 仍过期时退化为 clip_id 集合过滤，保证结果正确。
+    public func search(
+        store: VectorStore,
+        query: [Float],
+        limit: Int,
+        folders: Set<String>?,
+        pathPrefix: String?,
+        db: DatabaseReader
+    ) async throws -> [(clipId: Int64, similarity: Float)] {
+        for _ in 0..<2 {
+            guard let rows = try await bitmap(folders: folders, pathPrefix: pathPrefix, store: store, db: db) else {
+                return await store.search(query: query, limit: limit)
+            }
+            if let results = await store.search(query: query, limit: limit, allowedRows: rows) {
+                return results
+            }
+        }
+        let allowed = try await db.read { dbConn in
+            try Self.fetchClipIds(dbConn, folders: folders, pathPrefix: pathPrefix)
+        }
+        return await store.search(query: query, limit: limit, allowedClipIDs: Set(allowed))
+    }
+
+    /// 按执行计划检索
+    ///
+    /// 后过滤计划直接取全库 top-K（K 已按选择率放大），过滤留给结果补全；
+    /// 其余情况按计划的 K 走位图先过滤。
+    public func search(
+        store: VectorStore,
+        query: [Float],
+        plan: QueryPlan,
+        folders: Set<String>?,
+        pathPrefix: String?,
+        db: DatabaseReader
+    ) async throws -> [(clipId: Int64, similarity: Float)] {
+        if plan.filterPlacement == .postfilter {
+            return await store.search(query: query, limit: plan.vectorCandidates)
+        }
+        return try await search(
+            store: store, query: query, limit: plan.vectorCandidates,
+            folders: folders, pathPrefix: pathPrefix, db: db
+        )
+    }
+
+    // MARK: - Private
+
+    /// 获取单个原子的位图（布局匹配则命中缓存）
+    private func atom(
+        _ scope: Scope,
+        layout: VectorStore.Layout,
+        store: VectorStore,
+        db: DatabaseReader
+    ) async throws -> RowBitmap {
+        if let cached = entries[scope], cached.layout == layout {
+            stats.hits += 1
+            touch(scope)
+            return cached
+        }
+        stats.misses += 1
+
+        let ids = try await db.read { dbConn in
+            switch scope {
+            case .folder(let folder):
+                return try Self.fetchClipIds(dbConn, folders: [folder], pathPrefix: nil)
+            case .pathPrefix(let prefix):
+                return try Self.fetchClipIds(dbConn, folders: nil, pathPrefix: prefix)
+            }
+        }
+        let bitmap = await store.rowBitmap(for: ids)
+        // 构建期间 store 变化：不缓存，交由调用方重试
+        guard bitmap.layout == layout else { return bitmap }
+
+        if entries[scope] == nil, entries.count >= capacity, let oldest = recency.first {
+            entries.removeValue(forKey: oldest)
+            recency.removeFirst()
+        }
+        entries[scope] = bitmap
+        touch(scope)
+        return bitmap
+    }
+
+    private func touch(_ scope: Scope) {
+        if let idx = recency.firstIndex(of: scope) {
+            recency.remove(at: idx)
+        }
+        recency.append(scope)
+    }
+
+    /// 查询过滤范围内的 clip_id（source_folder 走唯一索引前缀）
+    static func fetchClipIds(
+        _ db: Database,
+        folders: Set<String>?,
+        pathPrefix: String?
+    ) throws -> [Int64] {
+        if let folders, folders.isEmpty { return [] }
+
+        var args = StatementArguments()
+        var whereClauses: [String] = []
+
+        if let folders {
+            let sortedFolders = folders.sorted()
+            let placeholders = sortedFolders.map { _ in "?" }.joined(separator: ", ")
+            whereClauses.append("c.source_folder IN (\(placeholders))")
+            for path in sortedFolders {
+                args += [path]
+            }
+        }
+
+        if let pathPrefix {
+            whereClauses.append("v.file_path LIKE ? || '/%'")
+            args += [pathPrefix]
+        }
+
+        let whereSQL = whereClauses.isEmpty ? "" : "WHERE " + whereClauses.joined(separator: " AND ")
+        return try Int64.fetchAll(db, sql: """
+            SELECT c.clip_id
+            FROM clips c
+            LEFT JOIN videos v ON v.video_id = c.video_id
+            \(whereSQL)
+            """, arguments: args)
+    }
+}
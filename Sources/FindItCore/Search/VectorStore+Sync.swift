@@ -0,0 +1,117 @@
+import Foundation
+import GRDB
+
+// MARK: - VectorStore 同步增量刷新
+
+extension VectorStore {
+
+    /// 按同步结果增量刷新向量存储
+    ///
+    /// 只读取本次新增/更新 clip 的 embedding（按 SQLite 变量上限分块），
+    /// 然后在 actor 内一次性批量 remove + append，替代"失效 → 全量重载"。
+    ///
+    /// - embedding 为空或模型与 store 不一致的 clip 视为移除（避免残留旧向量）
+    /// - 删除的 clip 直接移除
+    /// - 同一读事务内读取库指纹，记为 `appliedFingerprint`
+    ///
+    /// - Parameters:
+    ///   - result: `SyncEngine.sync` 返回的同步结果
+    ///   - db: 全局搜索索引（只读）
+    /// - Returns: 实际写入 store 的向量数
+    @discardableResult
+    public func applySyncDelta(
+        _ result: SyncEngine.SyncResult,
+        from db: DatabaseReader
+    ) async throws -> Int {
+        guard result.hasClipChanges else { return 0 }
+
+        let changed = result.addedClipIds + result.updatedClipIds
+        let model = embeddingModel
+        let source = source
+        let (upserts, fingerprint) = try await db.read { dbConn in
+            (
+                try Self.fetchEmbeddings(dbConn, clipIds: changed, embeddingModel: model, source: source),
+                try VectorStoreSnapshot.Fingerprint.current(dbConn, embeddingModel: model)
+            )
+        }
+
+        var removals = Set(result.removedClipIds)
+        let present = Set(upserts.map(\.clipId))
+        for id in changed where !present.contains(id) {
+            removals.insert(id)
+        }
+
+        apply(upserts: upserts, removals: removals)
+        recordAppliedFingerprint(fingerprint)
+        return upserts.count
+    }
+
+    /// 按 clip_id 读取指定模型的 embedding（分块 IN 查询）
+    static func fetchEmbeddings(
+        _ db: Database,
+        clipIds: [Int64],
+        embeddingModel: String,
+        source: Source = .text
+    ) throws -> [(clipId: Int64, embeddingData: Data)] {
+        var entries: [(clipId: Int64, embeddingData: Data)] = []
+        entries.reserveCapacity(clipIds.count)
+
+        for start in stride(from: 0, to: clipIds.count, by: 900) {
+            let chunk = clipIds[start..<min(start + 900, clipIds.count)]
+            let placeholders = chunk.map { _ in "?" }.joined(separator: ", ")
+            var args = StatementArguments()
+            args += [embeddingModel]
+            for id in chunk { args += [id] }
+
+            let rows = try Row.fetchAll(db, sql: """
+                SELECT clip_id, \(source.vectorColumn) AS vector
+                FROM clips
+                WHERE \(source.vectorColumn) IS NOT NULL AND \(source.modelColumn) = ?
+                  AND clip_id IN (\(placeholders))
+                """, arguments: args)
+            for row in rows {
+                guard let clipId = row["clip_id"] as? Int64,
+                      let data = row["vector"] as? Data else { continue }
+                entries.append((clipId: clipId, embeddingData: data))
+            }
+        }
+        return entries
+    }
+}
+
+// MARK: - 视频分组
+
+extension VectorStore {
+
+    /// 为尚未分组的行读取所属 video_id（分块 IN 查询）
+    ///
+    /// 只查询新加入的行：首次调用读取全部，之后每次同步只补齐增量。
+    /// 读取期间新加入的行保持未分配，`searchVideos` 将其视为独立视频。
+    ///
+    /// - Returns: 本次分配的行数
+    @discardableResult
+    public func refreshVideoGroups(from db: DatabaseReader) async throws -> Int {
+        let pending = unassignedVideoClipIds()
+        guard !pending.isEmpty else { return 0 }
+
+        let videoOfClip: [Int64: Int64?] = try await db.read { dbConn in
+            var map: [Int64: Int64?] = [:]
+            map.reserveCapacity(pending.count)
+            for start in stride(from: 0, to: pending.count, by: 900) {
+                let chunk = pending[start..<min(start + 900, pending.count)]
+                // 全局库中已不存在的 clip 视为无所属视频，避免每次重复查询
+                for clipId in chunk { map[clipId] = .some(nil) }
+                let placeholders = chunk.map { _ in "?" }.joined(separator: ", ")
+                let rows = try Row.fetchAll(dbConn, sql: """
+                    SELECT clip_id, video_id FROM clips WHERE clip_id IN (\(placeholders))
+                    """, arguments: StatementArguments(chunk))
+                for row in rows {
+                    map[row["clip_id"]] = .some(row["video_id"])
+                }
+            }
+            return map
+        }
+        assignVideos(videoOfClip)
+        return videoOfClip.count
+    }
+}
@@ -12,6 +12,7 @@ import Accelerate
 ///
 /// 设计决策：
 /// - actor 保证并发安全（load/append/remove 与 search 互斥）
+/// - clip_id → 行号索引，同步增量可批量原地 append/remove（无需全量重载）
 /// - 连续 Float 数组 + cblas_sgemv 利用 AMX 矩阵协处理器
 /// - 预计算范数避免重复计算（存储向量不变，范数只算一次）
 public actor VectorStore {
@@ -25,21 +26,103 @@ public actor VectorStore {
     /// 预计算的 L2 范数 |v|（与 clipIds 对齐）
     private var norms: [Float] = []
 
+    /// clip_id → 行号索引（增量 append/remove 免线性查找）
+    private var rowIndex: [Int64: Int] = [:]
+
+    /// 行所属视频分组槽位（与 clipIds 对齐；-1 = 尚未分配，见 `refreshVideoGroups`）
+    private var videoSlots: [Int32] = []
+
+    /// 槽位 → 全局库 video_id（nil = clip 无所属视频，独占一个槽位）
+    private var slotVideoIds: [Int64?] = []
+
+    /// video_id → 槽位
+    private var slotOfVideo: [Int64: Int32] = [:]
+
     /// 向量维度
     public let dimensions: Int
 
     /// 当前加载的 embedding model 名称
     public let embeddingModel: String
 
+    /// 向量来源列
+    public enum Source: Sendable {
+        /// 文本嵌入（`embedding` / `embedding_model`）
+        case text
+        /// 关键帧视觉特征（`visual_embedding` / `visual_model`）
+        case visual
+
+        var vectorColumn: String {
+            switch self {
+            case .text:   return "embedding"
+            case .visual: return "visual_embedding"
+            }
+        }
+
+        var modelColumn: String {
+            switch self {
+            case .text:   return "embedding_model"
+            case .visual: return "visual_model"
+            }
+        }
+    }
+
+    /// 向量来源（同步增量刷新按此读取对应列）
+    public let source: Source
+
     /// 已加载的向量数量
     public var count: Int { clipIds.count }
 
     /// 是否已加载数据
     public var isEmpty: Bool { clipIds.isEmpty }
 
-    public init(dimensions: Int, embeddingModel: String) {
+    /// 行布局标识（store 实例 + 行集合代数）
+    ///
+    /// `RowBitmap` 只对同一布局有效；行内向量原地替换不改变布局。
+    public struct Layout: Sendable, Hashable {
+        let storeID: UInt64
+        let generation: UInt64
+    }
+
+    /// 进程内唯一的 store 标识
+    ///
+    /// 单调递增：对象地址在 store 释放后会被复用，代数又都从小值开始，
+    /// 用地址作标识时旧 store 的位图可能通过新 store 的校验。
+    public nonisolated let storeID: UInt64
+
+    /// store 标识分配器
+    private static let storeIDs = StoreIDCounter()
+
+    private final class StoreIDCounter: @unchecked Sendable {
+        private let lock = NSLock()
+        private var last: UInt64 = 0
+
+        func next() -> UInt64 {
+            lock.lock()
+            defer { lock.unlock() }
+            last += 1
+            return last
+        }
+    }
+
+    /// 行集合代数（增删行时递增）
+    private var generation: UInt64 = 0
+
+    /// 本 store 内容对应的全局库指纹（nil = 未知）
+    ///
+    /// 构建 / 恢复时由预热记录，每次同步增量与所读 embedding 在同一读事务内更新。
+    /// 快照以此标记，而不是保存时刻的库状态：保存前提交、尚未应用的同步不会被误记为已包含。
+    public private(set) var appliedFingerprint: VectorStoreSnapshot.Fingerprint?
+
+    /// 当前行布局
+    public var layout: Layout {
+        Layout(storeID: storeID, generation: generation)
+    }
+
+    public init(dimensions: Int, embeddingModel: String, source: Source = .text) {
         self.dimensions = dimensions
         self.embeddingModel = embeddingModel
+        self.source = source
+        self.storeID = Self.storeIDs.next()
     }
 
     // MARK: - 数据加载
@@ -54,50 +137,134 @@ public actor VectorStore {
         vectors.removeAll(keepingCapacity: true)
         clipIds.removeAll(keepingCapacity: true)
         norms.removeAll(keepingCapacity: true)
+        generation &+= 1
+        rowIndex.removeAll(keepingCapacity: true)
+        resetVideoGroups(rowCount: 0)
+        appliedFingerprint = nil
 
         vectors.reserveCapacity(entries.count * dimensions)
         clipIds.reserveCapacity(entries.count)
         norms.reserveCapacity(entries.count)
+        rowIndex.reserveCapacity(entries.count)
 
         for (clipId, data) in entries {
-            let vector = deserializeEmbedding(data)
-            guard vector.count == dimensions else { continue }
-
-            let norm = computeNorm(vector)
-            guard norm > 0 else { continue }
-
-            clipIds.append(clipId)
-            vectors.append(contentsOf: vector)
-            norms.append(norm)
+            upsertRow(clipId: clipId, vector: deserializeEmbedding(data))
         }
     }
 
     /// 增量添加单个向量（新索引的 clip）
     public func append(clipId: Int64, embedding: [Float]) {
-        guard embedding.count == dimensions else { return }
+        upsertRow(clipId: clipId, vector: embedding)
+    }
 
-        let norm = computeNorm(embedding)
-        guard norm > 0 else { return }
+    /// 批量增量添加（已存在的 clip_id 原地替换）
+    ///
+    /// 用于同步增量刷新：新增行追加到末尾，已有行原地覆盖，
+    /// 不触发全量重建。
+    ///
+    /// - Parameter entries: (clip_id, embedding BLOB) 对
+    public func append(entries: [(clipId: Int64, embeddingData: Data)]) {
+        guard !entries.isEmpty else { return }
+        vectors.reserveCapacity(vectors.count + entries.count * dimensions)
+        clipIds.reserveCapacity(clipIds.count + entries.count)
+        norms.reserveCapacity(norms.count + entries.count)
 
-        // 已存在则替换
-        if let idx = clipIds.firstIndex(of: clipId) {
-            let offset = idx * dimensions
-            vectors.replaceSubrange(offset..<(offset + dimensions), with: embedding)
-            norms[idx] = norm
-        } else {
-            clipIds.append(clipId)
-            vectors.append(contentsOf: embedding)
-            norms.append(norm)
+        for (clipId, data) in entries {
+            upsertRow(clipId: clipId, vector: deserializeEmbedding(data))
         }
     }
 
     /// 移除向量（clip 被删除时）
     public func remove(clipId: Int64) {
-        guard let idx = clipIds.firstIndex(of: clipId) else { return }
-        clipIds.remove(at: idx)
-        let offset = idx * dimensions
-        vectors.removeSubrange(offset..<(offset + dimensions))
-        norms.remove(at: idx)
+        remove(clipIds: [clipId])
+    }
+
+    /// 批量移除向量
+    ///
+    /// 单次遍历压缩存储（保持剩余行的相对顺序），
+    /// 避免逐个 `removeSubrange` 导致的 O(n·k) 搬移。
+    ///
+    /// - Parameter ids: 要移除的 clip_id 集合（不存在的 ID 忽略）
+    public func remove(clipIds ids: Set<Int64>) {
+        let doomed = ids.filter { rowIndex[$0] != nil }
+        guard !doomed.isEmpty else { return }
+
+        var write = 0
+        for read in 0..<clipIds.count {
+            let clipId = clipIds[read]
+            if doomed.contains(clipId) {
+                rowIndex.removeValue(forKey: clipId)
+                continue
+            }
+            if write != read {
+                clipIds[write] = clipId
+                norms[write] = norms[read]
+                videoSlots[write] = videoSlots[read]
+                let src = read * dimensions
+                let dst = write * dimensions
+                for d in 0..<dimensions {
+                    vectors[dst + d] = vectors[src + d]
+                }
+                rowIndex[clipId] = write
+            }
+            write += 1
+        }
+
+        clipIds.removeLast(clipIds.count - write)
+        norms.removeLast(norms.count - write)
+        videoSlots.removeLast(videoSlots.count - write)
+        vectors.removeLast(vectors.count - write * dimensions)
+        generation &+= 1
+    }
+
+    /// 一次性应用同步增量（先删后增，单次 actor 互斥）
+    ///
+    /// - Parameters:
+    ///   - upserts: 新增或更新的 (clip_id, embedding BLOB)
+    ///   - removals: 需要移除的 clip_id（含 embedding 被清空/换模型的 clip）
+    public func apply(
+        upserts: [(clipId: Int64, embeddingData: Data)],
+        removals: Set<Int64>
+    ) {
+        remove(clipIds: removals)
+        append(entries: upserts)
+    }
+
+    /// 是否包含指定 clip
+    public func contains(clipId: Int64) -> Bool {
+        rowIndex[clipId] != nil
+    }
+
+    // MARK: - 快照
+
+    /// 导出全部行数据（供 `VectorStoreSnapshot` 持久化）
+    public func exportRows() -> (clipIds: [Int64], norms: [Float], vectors: [Float]) {
+        (clipIds, norms, vectors)
+    }
+
+    /// 从快照行数据恢复（跳过反序列化与范数计算）
+    ///
+    /// 三个数组长度不一致时拒绝恢复并返回 false，store 保持不变。
+    @discardableResult
+    public func restore(clipIds ids: [Int64], norms ns: [Float], vectors vs: [Float]) -> Bool {
+        guard ids.count == ns.count, vs.count == ids.count * dimensions else { return false }
+        clipIds = ids
+        norms = ns
+        vectors = vs
+        generation &+= 1
+        resetVideoGroups(rowCount: ids.count)
+        appliedFingerprint = nil
+        rowIndex.removeAll(keepingCapacity: true)
+        rowIndex.reserveCapacity(ids.count)
+        for (row, id) in ids.enumerated() {
+            rowIndex[id] = row
+        }
+        return true
+    }
+
+    /// 记录当前内容对应的全局库指纹（预热构建 / 快照恢复后调用）
+    public func recordAppliedFingerprint(_ fingerprint: VectorStoreSnapshot.Fingerprint?) {
+        appliedFingerprint = fingerprint
     }
 
     // MARK: - 批量搜索
@@ -117,14 +284,234 @@ public actor VectorStore {
         limit: Int = 50,
         allowedClipIDs: Set<Int64>? = nil
     ) -> [(clipId: Int64, similarity: Float)] {
+        guard let scores = cosineSimilarities(query: query) else { return [] }
+
+        // Top-K 排序（可选 clip_id 过滤）
+        let candidateIndices: [Int]
+        if let allowedClipIDs {
+            var filtered: [Int] = []
+            filtered.reserveCapacity(min(allowedClipIDs.count, scores.count))
+            for index in 0..<scores.count where allowedClipIDs.contains(clipIds[index]) {
+                filtered.append(index)
+            }
+            candidateIndices = filtered
+        } else {
+            candidateIndices = Array(0..<scores.count)
+        }
+        return topK(candidateIndices, scores: scores, limit: limit)
+    }
+
+    /// 位图过滤搜索：仅在 `allowedRows` 置位的行中取 Top-K
+    ///
+    /// 位图按行号直接取候选，无需逐行哈希探测 clip_id。
+    ///
+    /// - Returns: 位图布局与当前 store 不一致（期间发生增删）时返回 nil，调用方应重建位图
+    public func search(
+        query: [Float],
+        limit: Int = 50,
+        allowedRows: RowBitmap
+    ) -> [(clipId: Int64, similarity: Float)]? {
+        guard allowedRows.layout == layout else { return nil }
+        guard let scores = cosineSimilarities(query: query) else { return [] }
+
+        var candidateIndices: [Int] = []
+        candidateIndices.reserveCapacity(allowedRows.cardinality)
+        allowedRows.forEachRow { candidateIndices.append($0) }
+        return topK(candidateIndices, scores: scores, limit: limit)
+    }
+
+    /// 将 clip_id 列表映射为当前布局的行位图（不在 store 中的 ID 忽略）
+    public func rowBitmap<S: Sequence>(for ids: S) -> RowBitmap where S.Element == Int64 {
+        var bitmap = RowBitmap(layout: layout, rowCount: clipIds.count)
+        for id in ids {
+            if let row = rowIndex[id] {
+                bitmap.insert(row)
+            }
+        }
+        return bitmap
+    }
+
+    // MARK: - 按视频分组搜索
+
+    /// 视频级聚合方式
+    public enum VideoAggregation: Sendable, Equatable {
+        /// 取视频内最相似 clip 的得分
+        case max
+        /// 视频内前 n 个 clip 得分之和（奖励多处命中的长素材）
+        case topSum(Int)
+    }
+
+    /// 视频级命中
+    public struct VideoHit: Sendable {
+        /// 全局库 video_id（nil = clip 无所属视频）
+        public let videoId: Int64?
+        /// 聚合得分
+        public let score: Float
+        /// 视频内最相似的 clip（按相似度降序）
+        public let clips: [(clipId: Int64, similarity: Float)]
+    }
+
+    /// 尚未分配视频分组的 clip
+    func unassignedVideoClipIds() -> [Int64] {
+        var ids: [Int64] = []
+        for row in 0..<clipIds.count where videoSlots[row] < 0 {
+            ids.append(clipIds[row])
+        }
+        return ids
+    }
+
+    /// 写入 clip → video 映射（已不在 store 中的 clip 忽略）
+    func assignVideos(_ videoOfClip: [Int64: Int64?]) {
+        for (clipId, videoId) in videoOfClip {
+            guard let row = rowIndex[clipId], videoSlots[row] < 0 else { continue }
+            if let videoId, let slot = slotOfVideo[videoId] {
+                videoSlots[row] = slot
+                continue
+            }
+            let slot = Int32(slotVideoIds.count)
+            slotVideoIds.append(videoId)
+            if let videoId { slotOfVideo[videoId] = slot }
+            videoSlots[row] = slot
+        }
+    }
+
+    /// 视频级 Top-K：聚合在选择过程中完成
+    ///
+    /// 一次扫描全部得分，按行的分组槽位维护每个视频的前 m 个 clip
+    /// （m = max(clipsPerVideo, topSum 的 n)，定长平铺数组，无逐行字典查找），
+    /// 再对视频聚合分取前 `limit` 个。与"取大量 clip 再按视频去重"相比，
+    /// 结果不受 clip 候选深度限制：长素材的大量相似 clip 只占一个名额。
+    ///
+    /// 尚未分配分组的行（刚加入、未经 `refreshVideoGroups`）各自视为独立视频。
+    ///
+    /// - Parameters:
+    ///   - query: 查询向量
+    ///   - limit: 最多返回的视频数
+    ///   - clipsPerVideo: 每个视频附带的 clip 数
+    ///   - aggregation: 视频得分聚合方式
+    ///   - allowedClipIDs: 可选 clip 过滤集合
+    /// - Returns: 按聚合得分降序（同分按最佳 clip_id 升序）
+    public func searchVideos(
+        query: [Float],
+        limit: Int = 20,
+        clipsPerVideo: Int = 3,
+        aggregation: VideoAggregation = .max,
+        allowedClipIDs: Set<Int64>? = nil
+    ) -> [VideoHit] {
+        guard limit > 0, let scores = cosineSimilarities(query: query) else { return [] }
+
+        let sumCount: Int
+        if case .topSum(let n) = aggregation { sumCount = max(1, n) } else { sumCount = 1 }
+        let keep = max(1, clipsPerVideo, sumCount)
+        let slotCount = slotVideoIds.count
+
+        // 每个槽位的前 keep 个 (得分, 行)，降序；空位为 (-inf, -1)
+        var topScores = [Float](repeating: -.infinity, count: slotCount * keep)
+        var topRows = [Int](repeating: -1, count: slotCount * keep)
+        var unassigned: [Int] = []
+
+        for row in 0..<scores.count {
+            if let allowedClipIDs, !allowedClipIDs.contains(clipIds[row]) { continue }
+            let slot = Int(videoSlots[row])
+            guard slot >= 0 else {
+                unassigned.append(row)
+                continue
+            }
+            let base = slot * keep
+            let score = scores[row]
+            guard ranksBefore(score, row, than: topScores[base + keep - 1], topRows[base + keep - 1]) else { continue }
+
+            var i = keep - 1
+            while i > 0, ranksBefore(score, row, than: topScores[base + i - 1], topRows[base + i - 1]) {
+                topScores[base + i] = topScores[base + i - 1]
+                topRows[base + i] = topRows[base + i - 1]
+                i -= 1
+            }
+            topScores[base + i] = score
+            topRows[base + i] = row
+        }
+
+        // 聚合：(视频得分, 最佳行, 槽位 / -1 = 未分配单行)
+        var groups: [(score: Float, bestRow: Int, slot: Int)] = []
+        for slot in 0..<slotCount where topRows[slot * keep] >= 0 {
+            let base = slot * keep
+            var aggregate: Float = 0
+            for i in 0..<sumCount where topRows[base + i] >= 0 {
+                aggregate += topScores[base + i]
+            }
+            groups.append((aggregate, topRows[base], slot))
+        }
+        for row in unassigned {
+            groups.append((scores[row], row, -1))
+        }
+        groups.sort {
+            $0.score > $1.score || ($0.score == $1.score && clipIds[$0.bestRow] < clipIds[$1.bestRow])
+        }
+
+        return groups.prefix(limit).map { group in
+            guard group.slot >= 0 else {
+                return VideoHit(videoId: nil, score: group.score, clips: [(clipIds[group.bestRow], scores[group.bestRow])])
+            }
+            let base = group.slot * keep
+            let clips = (0..<min(clipsPerVideo, keep)).compactMap { i -> (clipId: Int64, similarity: Float)? in
+                let row = topRows[base + i]
+                return row >= 0 ? (clipIds[row], topScores[base + i]) : nil
+            }
+            return VideoHit(videoId: slotVideoIds[group.slot], score: group.score, clips: clips)
+        }
+    }
+
+    /// (得分降序, clip_id 升序) 比较；空位 (row = -1) 排在最后
+    private func ranksBefore(_ score: Float, _ row: Int, than otherScore: Float, _ otherRow: Int) -> Bool {
+        guard otherRow >= 0 else { return true }
+        return score > otherScore || (score == otherScore && clipIds[row] < clipIds[otherRow])
+    }
+
+    // MARK: - Private
+
+    /// 插入或原地替换一行；维度不符或零向量时跳过
+    ///
+    /// 已存在的 clip 若新向量无效，则移除旧行，避免残留过期 embedding。
+    private func upsertRow(clipId: Int64, vector: [Float]) {
+        let norm = vector.count == dimensions ? computeNorm(vector) : 0
+        guard norm > 0 else {
+            if rowIndex[clipId] != nil { remove(clipIds: [clipId]) }
+            return
+        }
+
+        if let idx = rowIndex[clipId] {
+            let offset = idx * dimensions
+            vectors.replaceSubrange(offset..<(offset + dimensions), with: vector)
+            norms[idx] = norm
+        } else {
+            rowIndex[clipId] = clipIds.count
+            clipIds.append(clipId)
+            generation &+= 1
+            vectors.append(contentsOf: vector)
+            norms.append(norm)
+            videoSlots.append(-1)
+        }
+    }
+
+    /// 清空视频分组（全部行回到未分配）
+    private func resetVideoGroups(rowCount: Int) {
+        videoSlots = [Int32](repeating: -1, count: rowCount)
+        slotVideoIds.removeAll(keepingCapacity: true)
+        slotOfVideo.removeAll(keepingCapacity: true)
+    }
+
+    /// 全部行与查询的余弦相似度（维度不符或零查询向量返回 nil）
+    ///
+    /// 使用 vDSP_mmul 一次矩阵运算计算全部点积，再除以预计算范数。
+    private func cosineSimilarities(query: [Float]) -> [Float]? {
         let n = clipIds.count
-        guard n > 0, query.count == dimensions else { return [] }
+        guard n > 0, query.count == dimensions else { return nil }
 
         // 1. Query norm
         var queryNormSq: Float = 0
         vDSP_dotpr(query, 1, query, 1, &queryNormSq, vDSP_Length(dimensions))
         let queryNorm = sqrt(queryNormSq)
-        guard queryNorm > 0 else { return [] }
+        guard queryNorm > 0 else { return nil }
 
         // 2. 批量点积: vectors[N×D] × query[D×1] → dots[N×1]
         var dotProducts = [Float](repeating: 0, count: n)
@@ -145,37 +532,31 @@ public actor VectorStore {
         for i in 0..<n {
             dotProducts[i] /= (queryNorm * norms[i])
         }
+        return dotProducts
+    }
 
-        // 4. Top-K 排序（可选 clip_id 过滤）
-        let candidateIndices: [Int]
-        if let allowedClipIDs {
-            var filtered: [Int] = []
-            filtered.reserveCapacity(min(allowedClipIDs.count, n))
-            for index in 0..<n where allowedClipIDs.contains(clipIds[index]) {
-                filtered.append(index)
-            }
-            candidateIndices = filtered
-        } else {
-            candidateIndices = Array(0..<n)
-        }
-        guard !candidateIndices.isEmpty else { return [] }
+    /// 候选行按相似度降序取前 K（同分按 clip_id 升序，保证稳定）
+    private func topK(
+        _ candidates: [Int],
+        scores: [Float],
+        limit: Int
+    ) -> [(clipId: Int64, similarity: Float)] {
+        guard !candidates.isEmpty else { return [] }
 
-        let k = min(limit, candidateIndices.count)
-        var indices = candidateIndices
+        let k = min(limit, candidates.count)
+        var indices = candidates
         // partialSort: 只需要前 K 个最大值
         // 对 100K 数据，full sort ~5ms，可接受
         indices.sort {
-            dotProducts[$0] > dotProducts[$1] ||
-            (dotProducts[$0] == dotProducts[$1] && clipIds[$0] < clipIds[$1])
+            scores[$0] > scores[$1] ||
+            (scores[$0] == scores[$1] && clipIds[$0] < clipIds[$1])
         }
 
         return indices.prefix(k).map { i in
-            (clipId: clipIds[i], similarity: dotProducts[i])
+            (clipId: clipIds[i], similarity: scores[i])
         }
     }
 
-    // MARK: - Private
-
     private func computeNorm(_ vector: [Float]) -> Float {
         var normSq: Float = 0
         vDSP_dotpr(vector, 1, vector, 1, &normSq, vDSP_Length(vector.count))
@@ -0,0 +1,287 @@
+import Foundation
+import GRDB
+import CxxHash
+
+/// VectorStore 快照错误
+public enum VectorStoreSnapshotError: LocalizedError {
+    /// 文件头不是快照格式
+    case badMagic
+    /// 不支持的快照版本
+    case unsupportedVersion(UInt32)
+    /// 文件被截断或长度字段非法
+    case truncated
+    /// XXH3 校验和不匹配（文件损坏）
+    case checksumMismatch
+    /// 快照的维度/模型与期望不一致
+    case modelMismatch(expected: String, got: String)
+
+    public var errorDescription: String? {
+        switch self {
+        case .badMagic:
+            return "向量快照格式无效"
+        case .unsupportedVersion(let version):
+            return "不支持的向量快照版本: \(version)"
+        case .truncated:
+            return "向量快照文件不完整"
+        case .checksumMismatch:
+            return "向量快照校验和不匹配"
+        case .modelMismatch(let expected, let got):
+            return "向量快照模型不匹配: 期望 \(expected), 实际 \(got)"
+        }
+    }
+}
+
+/// VectorStore 磁盘快照
+///
+/// 将 VectorStore 的行数据（clip_id / 范数 / 连续向量）原样写入单个二进制文件，
+/// 启动时直接恢复，免去全库 `SELECT embedding` + 反序列化 + 范数计算。
+///
+/// 文件格式（小端，native 布局）：
+/// ```
+/// "FVS1" | version u32 | dimensions u32 | model (u32 len + utf8)
+/// | fingerprint (u32 len + utf8) | count u64
+/// | clip_ids i64[count] | norms f32[count] | vectors f32[count × dim]
+/// | xxh3_64 u64（覆盖之前所有字节）
+/// ```
+///
+/// 快照携带全局库指纹（`Fingerprint`），与当前库不一致时视为过期，
+/// 由调用方回退到数据库流式构建。
+public enum VectorStoreSnapshot {
+
+    /// 文件魔数
+    static let magic: [UInt8] = Array("FVS1".utf8)
+
+    /// 当前格式版本
+    static let version: UInt32 = 1
+
+    // MARK: - 指纹
+
+    /// 全局库向量数据指纹
+    ///
+    /// 由 embedding 行数、最大 clip_id 和最近同步时间组成。
+    /// 任何一次同步或删除都会改变指纹，保证过期快照不会被误用。
+    public struct Fingerprint: Sendable, Equatable {
+        public let clipCount: Int
+        public let maxClipId: Int64
+        public let lastSyncedAt: String?
+
+        public init(clipCount: Int, maxClipId: Int64, lastSyncedAt: String?) {
+            self.clipCount = clipCount
+            self.maxClipId = maxClipId
+            self.lastSyncedAt = lastSyncedAt
+        }
+
+        /// 读取当前全局库指纹（命中 embedding_model 索引）
+        public static func current(_ db: Database, embeddingModel: String) throws -> Fingerprint {
+            let row = try Row.fetchOne(db, sql: """
+                SELECT COUNT(*) AS clip_count, COALESCE(MAX(clip_id), 0) AS max_clip_id
+                FROM clips
+                WHERE embedding IS NOT NULL AND embedding_model = ?
+                """, arguments: [embeddingModel])
+            let lastSynced = try String.fetchOne(db, sql: "SELECT MAX(last_synced_at) FROM sync_meta")
+            return Fingerprint(
+                clipCount: row?["clip_count"] ?? 0,
+                maxClipId: row?["max_clip_id"] ?? 0,
+                lastSyncedAt: lastSynced
+            )
+        }
+
+        /// 读取全局库整体指纹（不限模型）
+        ///
+        /// 守护进程据此判定常驻索引（向量、调色板等）是否被其他进程的同步或删除改变。
+        public static func current(_ db: Database) throws -> Fingerprint {
+            let row = try Row.fetchOne(db, sql: """
+                SELECT COUNT(*) AS clip_count, COALESCE(MAX(clip_id), 0) AS max_clip_id FROM clips
+                """)
+            let lastSynced = try String.fetchOne(db, sql: "SELECT MAX(last_synced_at) FROM sync_meta")
+            return Fingerprint(
+                clipCount: row?["clip_count"] ?? 0,
+                maxClipId: row?["max_clip_id"] ?? 0,
+                lastSyncedAt: lastSynced
+            )
+        }
+
+        /// 序列化为单行字符串（写入快照头）
+        var encoded: String {
+            "\(clipCount)|\(maxClipId)|\(lastSyncedAt ?? "")"
+        }
+    }
+
+    /// 快照内容
+    public struct Contents: Sendable {
+        public let dimensions: Int
+        public let embeddingModel: String
+        public let fingerprint: String
+        public let clipIds: [Int64]
+        public let norms: [Float]
+        public let vectors: [Float]
+    }
+
+    // MARK: - 路径
+
+    /// 默认快照路径
+    ///
+    /// 位于 `~/Library/Application Support/FindIt/vector-<model>.snapshot`，
+    /// 每个 embedding model 独立一份。
+    public static func defaultURL(embeddingModel: String) throws -> URL {
+        let safeName = embeddingModel.map { $0.isLetter || $0.isNumber || $0 == "-" ? $0 : "_" }
+        return try DatabaseManager.appSupportDirectory()
+            .appendingPathComponent("vector-\(String(safeName)).snapshot")
+    }
+
+    // MARK: - 写入
+
+    /// 将 store 写入快照文件（原子替换）
+    public static func write(
+        _ store: VectorStore,
+        fingerprint: Fingerprint,
+        to url: URL
+    ) async throws {
+        let rows = await store.exportRows()
+        let data = encode(
+            dimensions: store.dimensions,
+            embeddingModel: store.embeddingModel,
+            fingerprint: fingerprint.encoded,
+            clipIds: rows.clipIds,
+            norms: rows.norms,
+            vectors: rows.vectors
+        )
+        try FileManager.default.createDirectory(
+            at: url.deletingLastPathComponent(),
+            withIntermediateDirectories: true
+        )
+        try data.write(to: url, options: .atomic)
+    }
+
+    /// 编码快照字节
+    static func encode(
+        dimensions: Int,
+        embeddingModel: String,
+        fingerprint: String,
+        clipIds: [Int64],
+        norms: [Float],
+        vectors: [Float]
+    ) -> Data {
+        var data = Data()
+        data.reserveCapacity(64 + clipIds.count * 12 + vectors.count * 4)
+        data.append(contentsOf: magic)
+        appendScalar(&data, version)
+        appendScalar(&data, UInt32(dimensions))
+        appendString(&data, embeddingModel)
+        appendString(&data, fingerprint)
+        appendScalar(&data, UInt64(clipIds.count))
+        clipIds.withUnsafeBytes { data.append(contentsOf: $0) }
+        norms.withUnsafeBytes { data.append(contentsOf: $0) }
+        vectors.withUnsafeBytes { data.append(contentsOf: $0) }
+
+        let checksum = data.withUnsafeBytes { buffer in
+            XXH3_64bits(buffer.baseAddress, buffer.count)
+        }
+        appendScalar(&data, UInt64(checksum))
+        return data
+    }
+
+    // MARK: - 读取
+
+    /// 读取并校验快照文件
+    ///
+    /// - Throws: 格式、版本、校验和或模型不匹配时抛出 `VectorStoreSnapshotError`
+    public static func read(
+        from url: URL,
+        dimensions: Int,
+        embeddingModel: String
+    ) throws -> Contents {
+        let data = try Data(contentsOf: url, options: .mappedIfSafe)
+        let contents = try decode(data)
+        guard contents.dimensions == dimensions, contents.embeddingModel == embeddingModel else {
+            throw VectorStoreSnapshotError.modelMismatch(
+                expected: "\(embeddingModel)/\(dimensions)",
+                got: "\(contents.embeddingModel)/\(contents.dimensions)"
+            )
+        }
+        return contents
+    }
+
+    /// 解码快照字节（含校验和验证）
+    static func decode(_ data: Data) throws -> Contents {
+        try data.withUnsafeBytes { (raw: UnsafeRawBufferPointer) throws -> Contents in
+            guard raw.count >= magic.count + 8 else { throw VectorStoreSnapshotError.truncated }
+            guard Array(raw.prefix(magic.count)) == magic else { throw VectorStoreSnapshotError.badMagic }
+
+            let bodyLength = raw.count - 8
+            let stored = raw.loadUnaligned(fromByteOffset: bodyLength, as: UInt64.self)
+            let computed = XXH3_64bits(raw.baseAddress, bodyLength)
+            guard UInt64(computed) == stored else { throw VectorStoreSnapshotError.checksumMismatch }
+
+            var reader = Reader(raw: raw, offset: magic.count, limit: bodyLength)
+            let version: UInt32 = try reader.scalar()
+            guard version == Self.version else { throw VectorStoreSnapshotError.unsupportedVersion(version) }
+            let dimensions = Int(try reader.scalar() as UInt32)
+            let model = try reader.string()
+            let fingerprint = try reader.string()
+            let count = Int(try reader.scalar() as UInt64)
+
+            let clipIds: [Int64] = try reader.array(count: count)
+            let norms: [Float] = try reader.array(count: count)
+            let vectors: [Float] = try reader.array(count: count * dimensions)
+            guard reader.offset == bodyLength else { throw VectorStoreSnapshotError.truncated }
+
+            return Contents(
+                dimensions: dimensions,
+                embeddingModel: model,
+                fingerprint: fingerprint,
+                clipIds: clipIds,
+                norms: norms,
+                vectors: vectors
+            )
+        }
+    }
+
+    // MARK: - Private
+
+    private static func appendScalar<T: FixedWidthInteger>(_ data: inout Data, _ value: T) {
+        withUnsafeBytes(of: value.littleEndian) { data.append(contentsOf: $0) }
+    }
+
+    private static func appendString(_ data: inout Data, _ string: String) {
+        let bytes = Array(string.utf8)
+        appendScalar(&data, UInt32(bytes.count))
+        data.append(contentsOf: bytes)
+    }
+
+    /// 顺序读取器（越界即抛出 truncated）
+    private struct Reader {
+        let raw: UnsafeRawBufferPointer
+        var offset: Int
+        let limit: Int
+
+        mutating func scalar<T: FixedWidthInteger>() throws -> T {
+            let size = MemoryLayout<T>.size
+            guard offset + size <= limit else { throw VectorStoreSnapshotError.truncated }
+            let value = raw.loadUnaligned(fromByteOffset: offset, as: T.self)
+            offset += size
+            return T(littleEndian: value)
+        }
+
+        mutating func string() throws -> String {
+            let length = Int(try scalar() as UInt32)
+            guard offset + length <= limit else { throw VectorStoreSnapshotError.truncated }
+            let bytes = UnsafeRawBufferPointer(rebasing: raw[offset..<(offset + length)])
+            offset += length
+            return String(decoding: bytes, as: UTF8.self)
+        }
+
+        mutating func array<T>(count: Int) throws -> [T] {
+            let byteCount = count * MemoryLayout<T>.stride
+            guard count >= 0, offset + byteCount <= limit else { throw VectorStoreSnapshotError.truncated }
+            let result = [T](unsafeUninitializedCapacity: count) { buffer, initialized in
+                UnsafeMutableRawBufferPointer(buffer).copyMemory(
+                    from: UnsafeRawBufferPointer(rebasing: raw[offset..<(offset + byteCount)])
+                )
+                initialized = count
+            }
+            offset += byteCount
+            return result
+        }
+    }
+}
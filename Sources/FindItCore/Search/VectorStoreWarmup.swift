@@ -0,0 +1,226 @@
+import Foundation
+import GRDB
+
+/// VectorStore 后台预热
+///
+/// 启动时在后台构建 VectorStore，使首次向量搜索无需等待全量加载：
+/// 1. 优先从磁盘快照恢复（指纹与当前全局库一致时）
+/// 2. 否则按 clip_id 分页流式读取 embedding，逐块 append（不阻塞主线程）
+/// 3. 构建完成后写入新快照，供下次启动使用
+///
+/// 预热期间的查询通过 `store()` 等待同一个任务，不会触发重复加载。
+public actor VectorStoreWarmup {
+
+    /// 预热状态
+    public enum Status: Sendable, Equatable {
+        /// 未启动
+        case idle
+        /// 正在从快照恢复
+        case restoringSnapshot
+        /// 正在从数据库构建（已加载 / 总数）
+        case building(loaded: Int, total: Int)
+        /// 已就绪
+        case ready(count: Int, fromSnapshot: Bool)
+        /// 失败（查询时回退到逐行扫描）
+        case failed(String)
+
+        /// 是否仍在预热中
+        public var isWarming: Bool {
+            switch self {
+            case .restoringSnapshot, .building: return true
+            default: return false
+            }
+        }
+    }
+
+    /// 每页读取的 clip 数
+    static let pageSize = 2000
+
+    /// 全局搜索索引
+    private let db: DatabaseReader
+
+    /// embedding 模型名
+    public nonisolated let embeddingModel: String
+
+    /// 向量维度
+    public nonisolated let dimensions: Int
+
+    /// 快照路径（nil 表示不使用快照）
+    public nonisolated let snapshotURL: URL?
+
+    /// 状态回调（在 actor 上下文调用，UI 需自行切回主线程）
+    private let onStatus: (@Sendable (Status) -> Void)?
+
+    /// 当前状态
+    public private(set) var status: Status = .idle {
+        didSet { onStatus?(status) }
+    }
+
+    /// 预热任务
+    private var task: Task<VectorStore?, Never>?
+
+    /// 快照延迟保存任务
+    private var saveTask: Task<Void, Never>?
+
+    public init(
+        db: DatabaseReader,
+        embeddingModel: String,
+        dimensions: Int,
+        snapshotURL: URL?,
+        onStatus: (@Sendable (Status) -> Void)? = nil
+    ) {
+        self.db = db
+        self.embeddingModel = embeddingModel
+        self.dimensions = dimensions
+        self.snapshotURL = snapshotURL
+        self.onStatus = onStatus
+    }
+
+    // MARK: - 公开方法
+
+    /// 启动后台预热（幂等，重复调用不会重复构建）
+    public func start(priority: TaskPriority = .utility) {
+        guard task == nil else { return }
+        task = Task(priority: priority) { [weak self] in
+            await self?.build()
+        }
+    }
+
+    /// 获取预热完成的 store（未启动时立即启动并等待）
+    public func store() async -> VectorStore? {
+        if task == nil { start(priority: .userInitiated) }
+        return await task?.value
+    }
+
+    /// 立即将当前 store 写入快照
+    ///
+    /// 快照标记 store 最后应用的库指纹（见 `VectorStore.appliedFingerprint`），
+    /// 而不是保存时刻的库状态；指纹未知时不保存。
+    public func saveSnapshot() async {
+        guard let url = snapshotURL, let store = await task?.value,
+              let fingerprint = await store.appliedFingerprint else { return }
+        do {
+            // 先取指纹再导出行：期间应用的增量只会让内容比指纹更新（下次启动判定过期，安全）
+            try await VectorStoreSnapshot.write(store, fingerprint: fingerprint, to: url)
+        } catch {
+            // 快照只是加速手段，写入失败不影响搜索
+        }
+    }
+
+    /// 延迟保存快照（增量同步后调用，连续同步只保存最后一次）
+    public func scheduleSnapshotSave(after delay: Duration = .seconds(30)) {
+        guard snapshotURL != nil else { return }
+        saveTask?.cancel()
+        saveTask = Task(priority: .background) { [weak self] in
+            try? await Task.sleep(for: delay)
+            guard !Task.isCancelled else { return }
+            await self?.saveSnapshot()
+        }
+    }
+
+    /// 失效：丢弃当前 store，下次 `start()` 重新构建
+    ///
+    /// 快照默认保留：恢复时按库指纹校验，过期快照自然不会被采用。
+    /// 只有 embedding 模型或维度实际变化（快照不可能再匹配）时才传 `discardingSnapshot`。
+    public func invalidate(discardingSnapshot: Bool = false) {
+        task?.cancel()
+        task = nil
+        saveTask?.cancel()
+        saveTask = nil
+        status = .idle
+        if discardingSnapshot, let url = snapshotURL {
+            try? FileManager.default.removeItem(at: url)
+        }
+    }
+
+    // MARK: - Private
+
+    private func build() async -> VectorStore? {
+        let store = VectorStore(dimensions: dimensions, embeddingModel: embeddingModel)
+        do {
+            // 先取指纹：构建期间新到的同步会改变指纹，下次启动自然判定过期
+            let fingerprint = try await db.read { [embeddingModel] dbConn in
+                try VectorStoreSnapshot.Fingerprint.current(dbConn, embeddingModel: embeddingModel)
+            }
+
+            if let url = snapshotURL, FileManager.default.fileExists(atPath: url.path) {
+                status = .restoringSnapshot
+                if await restoreSnapshot(into: store, from: url, fingerprint: fingerprint) {
+                    await store.recordAppliedFingerprint(fingerprint)
+                    status = .ready(count: await store.count, fromSnapshot: true)
+                    return store
+                }
+            }
+
+            try await streamBuild(into: store, total: fingerprint.clipCount)
+            if Task.isCancelled { return nil }
+            await store.recordAppliedFingerprint(fingerprint)
+            status = .ready(count: await store.count, fromSnapshot: false)
+
+            if let url = snapshotURL {
+                try? await VectorStoreSnapshot.write(store, fingerprint: fingerprint, to: url)
+            }
+            return store
+        } catch {
+            if !Task.isCancelled {
+                status = .failed(error.localizedDescription)
+            }
+            return nil
+        }
+    }
+
+    /// 尝试从快照恢复（格式错误或指纹过期返回 false）
+    private func restoreSnapshot(
+        into store: VectorStore,
+        from url: URL,
+        fingerprint: VectorStoreSnapshot.Fingerprint
+    ) async -> Bool {
+        guard let contents = try? VectorStoreSnapshot.read(
+            from: url,
+            dimensions: dimensions,
+            embeddingModel: embeddingModel
+        ), contents.fingerprint == fingerprint.encoded else {
+            return false
+        }
+        return await store.restore(
+            clipIds: contents.clipIds,
+            norms: contents.norms,
+            vectors: contents.vectors
+        )
+    }
+
+    /// 按 clip_id keyset 分页流式构建（每页一次短读事务，页间让出执行权）
+    private func streamBuild(into store: VectorStore, total: Int) async throws {
+        var lastClipId: Int64 = 0
+        var loaded = 0
+        status = .building(loaded: 0, total: total)
+
+        while !Task.isCancelled {
+            let cursor = lastClipId
+            let page: [(clipId: Int64, embeddingData: Data)] = try await db.read { [embeddingModel] dbConn in
+                let rows = try Row.fetchAll(dbConn, sql: """
+                    SELECT clip_id, embedding
+                    FROM clips
+                    WHERE embedding IS NOT NULL AND embedding_model = ?
+                      AND clip_id > ?
+                    ORDER BY clip_id
+                    LIMIT ?
+                    """, arguments: [embeddingModel, cursor, Self.pageSize])
+                return rows.compactMap { row in
+                    guard let clipId = row["clip_id"] as? Int64,
+                          let data = row["embedding"] as? Data else { return nil }
+                    return (clipId: clipId, embeddingData: data)
+                }
+            }
+            guard let last = page.last else { break }
+
+            await store.append(entries: page)
+            lastClipId = last.clipId
+            loaded += page.count
+            status = .building(loaded: loaded, total: max(total, loaded))
+
+            if page.count < Self.pageSize { break }
+            await Task.yield()
+        }
+    }
+}
@@ -0,0 +1,93 @@
+import Foundation
+import GRDB
+
+extension SearchEngine {
+
+    /// 视频级搜索结果（每个视频一条，附最相关的 clips）
+    public struct VideoResult: Sendable, Codable {
+        /// 全局库 video_id（nil = clip 无所属视频）
+        public let videoId: Int64?
+        /// 视频文件路径
+        public let filePath: String?
+        /// 视频文件名
+        public let fileName: String?
+        /// 视频聚合得分
+        public let score: Double
+        /// 视频内最相关的 clips（按相似度降序）
+        public let clips: [SearchResult]
+    }
+
+    /// 视频级向量搜索："哪些文件"而非"哪些片段"
+    ///
+    /// 聚合在 `VectorStore.searchVideos` 的 Top-K 选择内完成，
+    /// 这里只补齐分组与元数据。
+    ///
+    /// - Parameters:
+    ///   - db: 全局库（读取 clip → video 映射与元数据）
+    ///   - store: 已加载的向量存储
+    ///   - queryEmbedding: 查询向量
+    ///   - aggregation: 视频得分聚合方式
+    ///   - clipsPerVideo: 每个视频附带的 clip 数
+    ///   - folderPaths: 限定文件夹（nil = 全部；在 Top-K 选择前按 clip 过滤）
+    ///   - limit: 最多返回的视频数
+    public static func videoSearch(
+        _ db: DatabaseReader,
+        store: VectorStore,
+        queryEmbedding: [Float],
+        aggregation: VectorStore.VideoAggregation = .max,
+        clipsPerVideo: Int = 3,
+        folderPaths: Set<String>? = nil,
+        limit: Int = 20
+    ) async throws -> [VideoResult] {
+        try await store.refreshVideoGroups(from: db)
+
+        var allowed: Set<Int64>?
+        if let folderPaths {
+            allowed = try await db.read { dbConn in
+                var args = StatementArguments()
+                appendFolderArgs(&args, folderPaths: folderPaths)
+                let clipIds = try Int64.fetchAll(dbConn, sql: """
+                    SELECT c.clip_id FROM clips c WHERE 1 = 1\(folderFilterSQL(folderPaths: folderPaths))
+                    """, arguments: args)
+                return Set(clipIds)
+            }
+        }
+
+        let hits = await store.searchVideos(
+            query: queryEmbedding,
+            limit: limit,
+            clipsPerVideo: clipsPerVideo,
+            aggregation: aggregation,
+            allowedClipIDs: allowed
+        )
+        return try await db.read { dbConn in
+            try hydrateVideoHits(dbConn, hits: hits)
+        }
+    }
+
+    /// 视频命中补全元数据（一次批量查询，保持命中顺序）
+    static func hydrateVideoHits(_ db: Database, hits: [VectorStore.VideoHit]) throws -> [VideoResult] {
+        let flat = hits.flatMap(\.clips)
+        var byClip: [Int64: SearchResult] = [:]
+        byClip.reserveCapacity(flat.count)
+        // vectorSearchFromStore 单次最多补全 900 条
+        for start in stride(from: 0, to: flat.count, by: 900) {
+            let chunk = Array(flat[start..<min(start + 900, flat.count)])
+            for result in try vectorSearchFromStore(db, storeResults: chunk, limit: chunk.count) {
+                byClip[result.clipId] = result
+            }
+        }
+
+        return hits.compactMap { hit in
+            let clips = hit.clips.compactMap { byClip[$0.clipId] }
+            guard let first = clips.first else { return nil }
+            return VideoResult(
+                videoId: hit.videoId ?? first.videoId,
+                filePath: first.filePath,
+                fileName: first.fileName,
+                score: Double(hit.score),
+                clips: clips
+            )
+        }
+    }
+}
@@ -0,0 +1,176 @@
+import Foundation
+import Accelerate
+
+// MARK: - VisualFeatureExtractor
+
+/// 关键帧视觉特征提取协议
+///
+/// 与 `EmbeddingProvider` 平行：文本嵌入来自 `composeClipText`，措辞不同的
+/// 相同画面并不相邻；视觉特征直接由像素计算，用于"找相似镜头"。
+/// `name` 写入 `visual_model` 列，检索时只比较同一提取器的向量。
+public protocol VisualFeatureExtractor: Sendable {
+    /// 提取器标识名（如 "tiny-image-v2"）
+    var name: String { get }
+
+    /// 输出向量维度
+    var dimensions: Int { get }
+
+    /// 解码关键帧时的最长边像素
+    var inputSize: Int { get }
+
+    /// 单帧特征（维度 = `dimensions`）
+    func features(of image: ThumbnailImage) -> [Float]
+}
+
+extension VisualFeatureExtractor {
+
+    /// clip 级特征：各帧特征取平均后 L2 归一化（无可解码帧时返回 nil）
+    public func clipFeatures(imagePaths: [String]) -> [Float]? {
+        let frames = imagePaths.compactMap { ThumbnailService.decode(path: $0, maxPixelSize: inputSize) }
+        return clipFeatures(images: frames)
+    }
+
+    /// clip 级特征（已解码的帧）
+    public func clipFeatures(images: [ThumbnailImage]) -> [Float]? {
+        guard !images.isEmpty else { return nil }
+        var sum = [Float](repeating: 0, count: dimensions)
+        for image in images {
+            let vector = features(of: image)
+            guard vector.count == dimensions else { continue }
+            sum.withUnsafeMutableBufferPointer { acc in
+                guard let p = acc.baseAddress else { return }
+                vDSP_vadd(p, 1, vector, 1, p, 1, vDSP_Length(dimensions))
+            }
+        }
+        let normalized = TinyImageDescriptor.l2Normalized(sum)
+        return normalized.contains { $0 != 0 } ? normalized : nil
+    }
+}
+
+// MARK: - TinyImageDescriptor
+
+/// 确定性基线提取器：微缩图 + GIST 式方向能量
+///
+/// 纯像素计算、无模型依赖，任何平台结果一致：
+/// - 微缩图：8×8 网格的平均 Lab（192 维），刻画构图与色块分布
+/// - 方向能量：L* 梯度按 4×4 网格 × 8 个无符号方向累加幅值（128 维），刻画纹理与线条走向
+///
+/// 两部分各自去均值（微缩图按 L/a/b 通道）、L2 归一化后等权拼接，整体单位长度，
+/// 余弦相似度即点积。不去均值时各维几乎全为正，任意两帧余弦都接近 1；
+/// 去均值后只比较构图与纹理，整体曝光 / 色偏不影响结果（色调检索见调色板）。
+public struct TinyImageDescriptor: VisualFeatureExtractor {
+
+    public let name = "tiny-image-v2"
+    public let dimensions = 320
+    public let inputSize = 64
+
+    /// 微缩图网格边长
+    static let colorGrid = 8
+
+    /// 方向能量网格边长
+    static let gradientGrid = 4
+
+    /// 无符号方向数（0-180°）
+    static let orientationBins = 8
+
+    public init() {}
+
+    public func features(of image: ThumbnailImage) -> [Float] {
+        let width = image.width
+        let height = image.height
+        guard width > 0, height > 0 else { return [Float](repeating: 0, count: dimensions) }
+        let lab = PixelStatistics.LabBuffer(image)
+
+        // 1. 微缩图：逐格平均 Lab
+        let g = Self.colorGrid
+        var tiny = [Float](repeating: 0, count: g * g * 3)
+        var counts = [Float](repeating: 0, count: g * g)
+        for y in 0..<height {
+            let cy = y * g / height
+            for x in 0..<width {
+                let cell = cy * g + x * g / width
+                let i = y * width + x
+                tiny[cell * 3] += lab.l[i] / 100
+                tiny[cell * 3 + 1] += lab.a[i] / 100
+                tiny[cell * 3 + 2] += lab.b[i] / 100
+                counts[cell] += 1
+            }
+        }
+        for cell in 0..<g * g where counts[cell] > 0 {
+            for c in 0..<3 { tiny[cell * 3 + c] /= counts[cell] }
+        }
+
+        // 2. 方向能量：中心差分梯度 → 幅值 + 无符号方向
+        let gist = Self.orientationEnergy(l: lab.l, width: width, height: height)
+
+        let half: Float = 0.5.squareRoot()
+        return Self.l2Normalized(Self.meanCentered(tiny, channels: 3)).map { $0 * half }
+            + Self.l2Normalized(Self.meanCentered(gist, channels: 1)).map { $0 * half }
+    }
+
+    /// 逐通道去均值（`channels` 个通道交错存放）
+    static func meanCentered(_ v: [Float], channels: Int) -> [Float] {
+        let count = v.count / channels
+        guard count > 0 else { return v }
+        var out = v
+        out.withUnsafeMutableBufferPointer { buffer in
+            guard let base = buffer.baseAddress else { return }
+            for c in 0..<channels {
+                var mean: Float = 0
+                vDSP_meanv(base + c, vDSP_Stride(channels), &mean, vDSP_Length(count))
+                var negated = -mean
+                vDSP_vsadd(base + c, vDSP_Stride(channels), &negated,
+                           base + c, vDSP_Stride(channels), vDSP_Length(count))
+            }
+        }
+        return out
+    }
+
+    /// L* 梯度方向能量（gradientGrid² × orientationBins 维）
+    static func orientationEnergy(l: [Float], width: Int, height: Int) -> [Float] {
+        let g = gradientGrid
+        var histogram = [Float](repeating: 0, count: g * g * orientationBins)
+        guard width >= 3, height >= 3 else { return histogram }
+
+        // 内部像素的水平 / 垂直差分（按行向量化）
+        let inner = width - 2
+        var gx = [Float](repeating: 0, count: inner)
+        var gy = [Float](repeating: 0, count: inner)
+        var magnitude = [Float](repeating: 0, count: inner)
+        var angle = [Float](repeating: 0, count: inner)
+        var n = Int32(inner)
+        l.withUnsafeBufferPointer { plane in
+            guard let base = plane.baseAddress else { return }
+            for y in 1..<(height - 1) {
+                let row = base + y * width
+                vDSP_vsub(row, 1, row + 2, 1, &gx, 1, vDSP_Length(inner))                 // right - left
+                vDSP_vsub(row - width + 1, 1, row + width + 1, 1, &gy, 1, vDSP_Length(inner))  // down - up
+                vDSP_vdist(gx, 1, gy, 1, &magnitude, 1, vDSP_Length(inner))
+                vvatan2f(&angle, gy, gx, &n)
+
+                let cy = y * g / height
+                for i in 0..<inner where magnitude[i] > 0 {
+                    // 无符号方向：θ 与 θ ± π 视为同一方向，折叠到 [0, π)
+                    var theta = angle[i]
+                    if theta < 0 { theta += .pi }
+                    if theta >= .pi { theta -= .pi }
+                    let bin = min(orientationBins - 1, Int(theta / .pi * Float(orientationBins)))
+                    let cx = (i + 1) * g / width
+                    histogram[(cy * g + cx) * orientationBins + bin] += magnitude[i]
+                }
+            }
+        }
+        return histogram
+    }
+
+    /// L2 归一化（零向量原样返回）
+    static func l2Normalized(_ v: [Float]) -> [Float] {
+        var sumSquares: Float = 0
+        vDSP_svesq(v, 1, &sumSquares, vDSP_Length(v.count))
+        guard sumSquares > 0 else { return v }
+        var scale = 1 / sumSquares.squareRoot()
+        var out = [Float](repeating: 0, count: v.count)
+        vDSP_vsmul(v, 1, &scale, &out, 1, vDSP_Length(v.count))
+        return out
+    }
+}
@@ -0,0 +1,78 @@
+import Foundation
+import GRDB
+
+/// "找相似镜头"：基于关键帧视觉特征的 clip 近邻检索
+///
+/// 视觉向量单独装入一个 `VectorStore`（`source: .visual`），
+/// 复用文本向量的连续存储、sgemv 批量点积与 top-K 逻辑；
+/// 查询向量直接取自目标 clip，全程无文本往返。
+/// CLI 每次加载一次性 store；守护进程常驻持有并按同步增量刷新。
+public enum VisualSimilarity {
+
+    /// 从全局库加载指定提取器的全部视觉向量
+    public static func loadStore(
+        from db: DatabaseReader,
+        extractor: any VisualFeatureExtractor = TinyImageDescriptor()
+    ) async throws -> VectorStore {
+        let model = extractor.name
+        let entries = try await db.read { db in
+            try Row.fetchAll(db, sql: """
+                SELECT clip_id, visual_embedding FROM clips
+                WHERE visual_embedding IS NOT NULL AND visual_model = ?
+                """, arguments: [model]
+            ).map { row -> (clipId: Int64, embeddingData: Data) in
+                (row["clip_id"], row["visual_embedding"])
+            }
+        }
+        let store = VectorStore(dimensions: extractor.dimensions, embeddingModel: model, source: .visual)
+        await store.load(entries: entries)
+        return store
+    }
+
+    /// 读取 clip 的视觉向量（模型不一致或未计算时返回 nil）
+    public static func vector(_ db: Database, clipId: Int64, model: String) throws -> [Float]? {
+        let data = try Data.fetchOne(db, sql: """
+            SELECT visual_embedding FROM clips
+            WHERE clip_id = ? AND visual_embedding IS NOT NULL AND visual_model = ?
+            """, arguments: [clipId, model])
+        return data.map(EmbeddingUtils.deserializeEmbedding)
+    }
+
+    /// 与指定 clip 视觉最相似的片段（不含自身）
+    ///
+    /// - Parameters:
+    ///   - clipId: 全局库 clip_id
+    ///   - store: 已加载的视觉向量 store
+    ///   - db: 全局搜索索引
+    ///   - folderPaths: 限定文件夹（nil = 全部）
+    ///   - limit: 最大结果数
+    ///   - filterBitmaps: 与 `store` 配套的过滤位图缓存（常驻调用方传入以复用；nil = 本次临时构建）
+    /// - Returns: `similarity` 为视觉余弦相似度；目标 clip 无视觉向量时返回空
+    public static func similarClips(
+        to clipId: Int64,
+        store: VectorStore,
+        db: DatabaseReader,
+        folderPaths: Set<String>? = nil,
+        limit: Int = 20,
+        filterBitmaps: VectorFilterBitmapCache? = nil
+    ) async throws -> [SearchEngine.SearchResult] {
+        let model = store.embeddingModel
+        guard let query = try await db.read({ try vector($0, clipId: clipId, model: model) }) else {
+            return []
+        }
+        // 文件夹范围按行位图在 top-K 之前过滤，候选数不受范围大小影响（多取 1 条留给自身）
+        let bitmaps = filterBitmaps ?? VectorFilterBitmapCache()
+        let hits = try await bitmaps.search(
+            store: store, query: query, limit: limit + 1,
+            folders: folderPaths, pathPrefix: nil, db: db
+        ).filter { $0.clipId != clipId }
+        return try await db.read { db in
+            try SearchEngine.vectorSearchFromStore(
+                db,
+                storeResults: hits,
+                folderPaths: folderPaths,
+                limit: limit
+            )
+        }
+    }
+}
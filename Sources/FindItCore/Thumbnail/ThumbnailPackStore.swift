@@ -0,0 +1,307 @@
+import Foundation
+import CxxHash
+
+/// 缩略图打包磁盘缓存
+///
+/// 所有下采样后的缩略图追加写入单个文件，避免每张缩略图一个小文件：
+/// 冷启动时一次顺序扫描条目头建立索引，之后每次命中只需一次 `pread`，
+/// 外接慢速磁盘上也不会逐个打开原始 JPEG。
+///
+/// 文件格式（小端）：
+/// ```
+/// "FTP1" | version u32
+/// | 条目: key u64 | width u32 | height u32 | length u32 | xxh3_64 u64 | RGBA8[length]
+/// ```
+///
+/// - 同一 key 重复写入时以文件中最后一条为准
+/// - 宽高与长度均为 0 的条目是删除标记（墓碑），压缩时随被删条目一起丢弃
+/// - 末尾不完整的条目（进程中途退出）在打开时截断
+/// - 文件超过容量上限时，保留最近写入的条目重写（约为上限的 3/4）
+/// - 每条以单次 `write` 追加（O_APPEND），App 与 CLI 可共享同一文件；
+///   读取未命中时检查文件是否被其他进程追加或重写
+public final class ThumbnailPackStore: @unchecked Sendable {
+
+    /// 文件魔数
+    static let magic: [UInt8] = Array("FTP1".utf8)
+
+    /// 当前格式版本
+    static let version: UInt32 = 1
+
+    /// 文件头长度
+    static let headerSize = 8
+
+    /// 条目头长度
+    static let entryHeaderSize = 28
+
+    /// 索引项
+    struct Entry {
+        let offset: Int
+        let width: Int
+        let height: Int
+        let length: Int
+        let checksum: UInt64
+    }
+
+    /// 缓存文件路径
+    public let url: URL
+
+    /// 容量上限（字节）
+    public let budgetBytes: Int
+
+    private let lock = NSLock()
+    private var fd: Int32 = -1
+    private var inode: UInt64 = 0
+    private var index: [UInt64: Entry] = [:]
+    private var endOffset = 0
+
+    /// 打开（或创建）缓存文件
+    public init(url: URL, budgetBytes: Int = 256 * 1024 * 1024) throws {
+        self.url = url
+        self.budgetBytes = max(budgetBytes, 1024 * 1024)
+        try FileManager.default.createDirectory(
+            at: url.deletingLastPathComponent(),
+            withIntermediateDirectories: true
+        )
+        try reopen()
+    }
+
+    deinit {
+        if fd >= 0 { close(fd) }
+    }
+
+    // MARK: - 状态
+
+    /// 条目数（去重后）
+    public var count: Int {
+        lock.lock(); defer { lock.unlock() }
+        return index.count
+    }
+
+    /// 文件字节数
+    public var fileSize: Int {
+        lock.lock(); defer { lock.unlock() }
+        return endOffset
+    }
+
+    // MARK: - 读写
+
+    /// 读取缩略图（校验失败视为未命中）
+    public func read(key: UInt64) -> ThumbnailImage? {
+        lock.lock(); defer { lock.unlock() }
+        if index[key] == nil {
+            refreshIfChanged()
+        }
+        guard let entry = index[key] else { return nil }
+
+        var pixels = [UInt8](repeating: 0, count: entry.length)
+        let readCount = pixels.withUnsafeMutableBytes { buffer in
+            pread(fd, buffer.baseAddress, entry.length, off_t(entry.offset + Self.entryHeaderSize))
+        }
+        guard readCount == entry.length,
+              pixels.withUnsafeBytes({ XXH3_64bits($0.baseAddress, $0.count) }) == entry.checksum else {
+            index.removeValue(forKey: key)
+            return nil
+        }
+        return ThumbnailImage(width: entry.width, height: entry.height, pixels: pixels)
+    }
+
+    /// 追加写入缩略图（超过容量上限时自动压缩）
+    public func write(key: UInt64, image: ThumbnailImage) throws {
+        let checksum = image.pixels.withUnsafeBytes { XXH3_64bits($0.baseAddress, $0.count) }
+        var record = Data(capacity: Self.entryHeaderSize + image.byteCount)
+        Self.append(&record, key)
+        Self.append(&record, UInt32(image.width))
+        Self.append(&record, UInt32(image.height))
+        Self.append(&record, UInt32(image.byteCount))
+        Self.append(&record, UInt64(checksum))
+        record.append(contentsOf: image.pixels)
+
+        lock.lock(); defer { lock.unlock() }
+        // 先吸收其他进程的追加，保证 endOffset 与文件末尾一致
+        refreshIfChanged()
+        let written = record.withUnsafeBytes { appendBytes(fd, $0.baseAddress, $0.count) }
+        guard written == record.count else {
+            let code = errno
+            // 写入不完整：截断回原长度
+            _ = ftruncate(fd, off_t(endOffset))
+            throw ThumbnailCacheError.systemCall("write", errno: code)
+        }
+        // O_APPEND 写在真实文件末尾（可能在其他进程的追加之后）
+        let end = Int(lseek(fd, 0, SEEK_CUR))
+        index[key] = Entry(
+            offset: end - record.count,
+            width: image.width,
+            height: image.height,
+            length: image.byteCount,
+            checksum: UInt64(checksum)
+        )
+        endOffset = end
+
+        if endOffset > budgetBytes {
+            try compact(targetBytes: budgetBytes * 3 / 4)
+        }
+    }
+
+    /// 删除条目（追加墓碑，其他进程扫描到后同样失效）
+    public func remove(keys: [UInt64]) throws {
+        lock.lock(); defer { lock.unlock() }
+        refreshIfChanged()
+        let doomed = keys.filter { index[$0] != nil }
+        guard !doomed.isEmpty else { return }
+
+        var record = Data(capacity: doomed.count * Self.entryHeaderSize)
+        for key in doomed {
+            Self.append(&record, key)
+            Self.append(&record, UInt32(0))
+            Self.append(&record, UInt32(0))
+            Self.append(&record, UInt32(0))
+            Self.append(&record, UInt64(0))
+        }
+        let written = record.withUnsafeBytes { appendBytes(fd, $0.baseAddress, $0.count) }
+        guard written == record.count else {
+            let code = errno
+            _ = ftruncate(fd, off_t(endOffset))
+            throw ThumbnailCacheError.systemCall("write", errno: code)
+        }
+        doomed.forEach { index.removeValue(forKey: $0) }
+        endOffset = Int(lseek(fd, 0, SEEK_CUR))
+    }
+
+    /// 清空缓存文件
+    public func removeAll() throws {
+        lock.lock(); defer { lock.unlock() }
+        guard ftruncate(fd, off_t(Self.headerSize)) == 0 else {
+            throw ThumbnailCacheError.systemCall("ftruncate", errno: errno)
+        }
+        index.removeAll()
+        endOffset = Self.headerSize
+    }
+
+    // MARK: - Private（调用方持有 lock）
+
+    private func reopen() throws {
+        let newFD = open(url.path, O_RDWR | O_CREAT | O_APPEND, 0o644)
+        guard newFD >= 0 else {
+            throw ThumbnailCacheError.systemCall("open", errno: errno)
+        }
+        if fd >= 0 { close(fd) }
+        fd = newFD
+        index.removeAll()
+        endOffset = 0
+
+        var info = stat()
+        fstat(fd, &info)
+        inode = UInt64(info.st_ino)
+        let size = Int(info.st_size)
+
+        var header = [UInt8](repeating: 0, count: Self.headerSize)
+        let headerRead = size >= Self.headerSize
+            ? header.withUnsafeMutableBytes { pread(fd, $0.baseAddress, Self.headerSize, 0) }
+            : 0
+        let valid = headerRead == Self.headerSize
+            && Array(header[0..<4]) == Self.magic
+            && header.withUnsafeBytes({ $0.loadUnaligned(fromByteOffset: 4, as: UInt32.self) }) == Self.version
+        if !valid {
+            // 新文件或格式不兼容：重置
+            _ = ftruncate(fd, 0)
+            var fresh = Data(Self.magic)
+            Self.append(&fresh, Self.version)
+            _ = fresh.withUnsafeBytes { appendBytes(fd, $0.baseAddress, $0.count) }
+            endOffset = Self.headerSize
+            return
+        }
+        endOffset = Self.headerSize
+        scan(upTo: size, truncateTail: true)
+    }
+
+    /// 从 endOffset 扫描条目头到 size
+    ///
+    /// 只在打开时截断不完整的尾部；运行中扫描到的不完整条目
+    /// 可能是其他进程正在写入，留待下次扫描。
+    private func scan(upTo size: Int, truncateTail: Bool) {
+        var header = [UInt8](repeating: 0, count: Self.entryHeaderSize)
+        var offset = endOffset
+        while offset + Self.entryHeaderSize <= size {
+            let readCount = header.withUnsafeMutableBytes {
+                pread(fd, $0.baseAddress, Self.entryHeaderSize, off_t(offset))
+            }
+            guard readCount == Self.entryHeaderSize else { break }
+            let (key, width, height, length, checksum) = header.withUnsafeBytes { raw in (
+                UInt64(littleEndian: raw.loadUnaligned(fromByteOffset: 0, as: UInt64.self)),
+                Int(UInt32(littleEndian: raw.loadUnaligned(fromByteOffset: 8, as: UInt32.self))),
+                Int(UInt32(littleEndian: raw.loadUnaligned(fromByteOffset: 12, as: UInt32.self))),
+                Int(UInt32(littleEndian: raw.loadUnaligned(fromByteOffset: 16, as: UInt32.self))),
+                UInt64(littleEndian: raw.loadUnaligned(fromByteOffset: 20, as: UInt64.self))
+            ) }
+            guard length == width * height * 4,
+                  offset + Self.entryHeaderSize + length <= size else { break }
+            if length == 0 {
+                index.removeValue(forKey: key)
+            } else {
+                index[key] = Entry(offset: offset, width: width, height: height, length: length, checksum: checksum)
+            }
+            offset += Self.entryHeaderSize + length
+        }
+        if truncateTail, offset < size {
+            _ = ftruncate(fd, off_t(offset))
+        }
+        endOffset = offset
+    }
+
+    /// 文件被其他进程重写（inode 变化）时重新打开，被追加时扫描新增部分
+    private func refreshIfChanged() {
+        var pathInfo = stat()
+        guard stat(url.path, &pathInfo) == 0 else {
+            try? reopen()
+            return
+        }
+        if UInt64(pathInfo.st_ino) != inode {
+            try? reopen()
+        } else if Int(pathInfo.st_size) > endOffset {
+            scan(upTo: Int(pathInfo.st_size), truncateTail: false)
+        }
+    }
+
+    /// 保留最近写入（文件偏移最大）的条目，写入临时文件后原子替换
+    private func compact(targetBytes: Int) throws {
+        let newestFirst = index.sorted { $0.value.offset > $1.value.offset }
+        var kept: [(key: UInt64, entry: Entry)] = []
+        var total = Self.headerSize
+        for (key, entry) in newestFirst {
+            let size = Self.entryHeaderSize + entry.length
+            guard total + size <= targetBytes else { break }
+            kept.append((key, entry))
+            total += size
+        }
+
+        var output = Data(capacity: total)
+        output.append(contentsOf: Self.magic)
+        Self.append(&output, Self.version)
+        for (_, entry) in kept.reversed() {
+            var record = [UInt8](repeating: 0, count: Self.entryHeaderSize + entry.length)
+            let readCount = record.withUnsafeMutableBytes {
+                pread(fd, $0.baseAddress, $0.count, off_t(entry.offset))
+            }
+            guard readCount == record.count else { continue }
+            output.append(contentsOf: record)
+        }
+
+        let tempURL = url.appendingPathExtension("\(getpid()).tmp")
+        try output.write(to: tempURL)
+        guard rename(tempURL.path, url.path) == 0 else {
+            let code = errno
+            try? FileManager.default.removeItem(at: tempURL)
+            throw ThumbnailCacheError.systemCall("rename", errno: code)
+        }
+        try reopen()
+    }
+
+    private static func append<T: FixedWidthInteger>(_ data: inout Data, _ value: T) {
+        withUnsafeBytes(of: value.littleEndian) { data.append(contentsOf: $0) }
+    }
+}
+
+/// 文件级包装：类内的 `write(key:image:)` 会遮蔽系统 `write`
+private func appendBytes(_ fd: Int32, _ buffer: UnsafeRawPointer?, _ count: Int) -> Int {
+    write(fd, buffer, count)
+}
@@ -0,0 +1,154 @@
+import Foundation
+
+/// 缩略图像素数据（RGBA8，预乘 alpha，行宽 = width × 4）
+public struct ThumbnailImage: Sendable, Equatable {
+    public let width: Int
+    public let height: Int
+    public let pixels: [UInt8]
+
+    public init(width: Int, height: Int, pixels: [UInt8]) {
+        precondition(pixels.count == width * height * 4, "像素数据长度与尺寸不一致")
+        self.width = width
+        self.height = height
+        self.pixels = pixels
+    }
+
+    /// 像素字节数
+    public var byteCount: Int { pixels.count }
+}
+
+/// 缩略图下采样内核
+///
+/// 面积平均（box filter）可分离两遍：先水平、后垂直，
+/// 每个像素的四个通道作为 `SIMD4<Float>` 一次累加。
+/// 源像素按覆盖比例加权，非整数倍缩放也不会丢行/丢列，
+/// 效果接近 `kCGImageSourceThumbnailMaxPixelSize`，但与平台解码器无关。
+public enum ThumbnailResizer {
+
+    /// 单个目标像素的源像素范围与权重
+    struct Tap {
+        let start: Int
+        let weights: [Float]
+    }
+
+    /// 按最长边限制计算目标尺寸（不放大）
+    public static func targetSize(width: Int, height: Int, maxPixelSize: Int) -> (width: Int, height: Int) {
+        let longEdge = max(width, height)
+        guard longEdge > maxPixelSize, longEdge > 0 else { return (width, height) }
+        let scale = Double(maxPixelSize) / Double(longEdge)
+        return (
+            max(1, Int((Double(width) * scale).rounded())),
+            max(1, Int((Double(height) * scale).rounded()))
+        )
+    }
+
+    /// 下采样 RGBA8 像素
+    ///
+    /// - Parameters:
+    ///   - source: 源像素（RGBA8，预乘 alpha）
+    ///   - width: 源宽度
+    ///   - height: 源高度
+    ///   - rowBytes: 源行字节数（≥ width × 4）
+    ///   - targetWidth: 目标宽度（≤ width）
+    ///   - targetHeight: 目标高度（≤ height）
+    /// - Returns: 目标像素（行宽 = targetWidth × 4）
+    public static func downsample(
+        _ source: UnsafeRawBufferPointer,
+        width: Int,
+        height: Int,
+        rowBytes: Int,
+        targetWidth: Int,
+        targetHeight: Int
+    ) -> [UInt8] {
+        precondition(rowBytes >= width * 4 && source.count >= rowBytes * (height - 1) + width * 4)
+        let xTaps = taps(source: width, destination: targetWidth)
+        let yTaps = taps(source: height, destination: targetHeight)
+
+        // 水平遍：height × targetWidth 的中间结果
+        var horizontal = [SIMD4<Float>](repeating: .zero, count: height * targetWidth)
+        horizontal.withUnsafeMutableBufferPointer { out in
+            for y in 0..<height {
+                let row = source.baseAddress! + y * rowBytes
+                let outRow = y * targetWidth
+                for (x, tap) in xTaps.enumerated() {
+                    var acc = SIMD4<Float>.zero
+                    var pixel = row + tap.start * 4
+                    for weight in tap.weights {
+                        let p = pixel.loadUnaligned(as: SIMD4<UInt8>.self)
+                        acc += SIMD4<Float>(p) * weight
+                        pixel += 4
+                    }
+                    out[outRow + x] = acc
+                }
+            }
+        }
+
+        // 垂直遍：逐行累加整行，内层循环连续访问
+        var result = [UInt8](repeating: 0, count: targetWidth * targetHeight * 4)
+        var acc = [SIMD4<Float>](repeating: .zero, count: targetWidth)
+        let maxValue = SIMD4<Float>(repeating: 255)
+        horizontal.withUnsafeBufferPointer { rows in
+            result.withUnsafeMutableBytes { out in
+                for (y, tap) in yTaps.enumerated() {
+                    for x in 0..<targetWidth { acc[x] = .zero }
+                    for (offset, weight) in tap.weights.enumerated() {
+                        let row = (tap.start + offset) * targetWidth
+                        for x in 0..<targetWidth {
+                            acc[x] += rows[row + x] * weight
+                        }
+                    }
+                    let outRow = y * targetWidth * 4
+                    for x in 0..<targetWidth {
+                        let clamped = acc[x].rounded(.toNearestOrAwayFromZero)
+                            .clamped(lowerBound: .zero, upperBound: maxValue)
+                        out.storeBytes(
+                            of: SIMD4<UInt8>(truncatingIfNeeded: SIMD4<Int32>(clamped)),
+                            toByteOffset: outRow + x * 4,
+                            as: SIMD4<UInt8>.self
+                        )
+                    }
+                }
+            }
+        }
+        return result
+    }
+
+    /// 下采样为 `ThumbnailImage`（不超过 maxPixelSize 时原样复制）
+    public static func downsample(
+        _ source: UnsafeRawBufferPointer,
+        width: Int,
+        height: Int,
+        rowBytes: Int,
+        maxPixelSize: Int
+    ) -> ThumbnailImage {
+        let target = targetSize(width: width, height: height, maxPixelSize: maxPixelSize)
+        let pixels = downsample(
+            source, width: width, height: height, rowBytes: rowBytes,
+            targetWidth: target.width, targetHeight: target.height
+        )
+        return ThumbnailImage(width: target.width, height: target.height, pixels: pixels)
+    }
+
+    /// 计算一维面积平均的采样表（权重归一化）
+    static func taps(source: Int, destination: Int) -> [Tap] {
+        let scale = Float(source) / Float(destination)
+        return (0..<destination).map { d in
+            let low = Float(d) * scale
+            let high = min(Float(d + 1) * scale, Float(source))
+            let first = min(Int(low), source - 1)
+            let last = max(first + 1, min(Int(high.rounded(.up)), source))
+            var weights: [Float] = []
+            weights.reserveCapacity(last - first)
+            for s in first..<last {
+                weights.append(max(0, min(high, Float(s + 1)) - max(low, Float(s))))
+            }
+            let total = weights.reduce(0, +)
+            if total > 0 {
+                weights = weights.map { $0 / total }
+            } else {
+                weights = [1] + [Float](repeating: 0, count: weights.count - 1)
+            }
+            return Tap(start: first, weights: weights)
+        }
+    }
+}
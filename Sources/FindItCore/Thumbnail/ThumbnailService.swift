@@ -0,0 +1,321 @@
+import Foundation
+import CoreGraphics
+import ImageIO
+import CxxHash
+
+/// 缩略图缓存错误
+public enum ThumbnailCacheError: LocalizedError {
+    /// 系统调用失败
+    case systemCall(String, errno: Int32)
+
+    public var errorDescription: String? {
+        switch self {
+        case .systemCall(let call, let code):
+            return "缩略图缓存 \(call) 失败: \(String(cString: strerror(code)))"
+        }
+    }
+}
+
+/// 缩略图服务（App 网格与 CLI 共用）
+///
+/// 三级缓存：
+/// 1. 内存 LRU（按路径，默认 200 张）
+/// 2. 打包磁盘缓存 `ThumbnailPackStore`（按 XXH3(路径 + mtime + 尺寸)，跨进程/跨启动共享）
+/// 3. 原始缩略图文件：ImageIO 解码 + `ThumbnailResizer` 下采样，结果写回磁盘缓存
+///
+/// 同一路径的并发请求合并为一次加载；`prefetch` 按滚动位置预取，
+/// 新的预取窗口会取消上一批尚未开始的预取。
+public actor ThumbnailService {
+
+    /// App 与 CLI 共用实例（磁盘缓存位于 Application Support）
+    public static let shared = ThumbnailService(packURL: try? ThumbnailService.defaultURL())
+
+    /// 预取并发数
+    public static let prefetchConcurrency = 4
+
+    /// 命中统计
+    public struct Stats: Sendable, Equatable {
+        public var memoryHits = 0
+        public var diskHits = 0
+        public var decodes = 0
+        public var failures = 0
+    }
+
+    /// 加载来源
+    enum Source: Sendable {
+        case disk
+        case decoded
+        case failed
+    }
+
+    /// 单次加载结果
+    struct Loaded: Sendable {
+        let image: ThumbnailImage?
+        let source: Source
+    }
+
+    /// 最长边像素上限
+    public nonisolated let maxPixelSize: Int
+
+    /// 内存缓存条数
+    public nonisolated let memoryCapacity: Int
+
+    /// 当前统计
+    public private(set) var stats = Stats()
+
+    private nonisolated let pack: ThumbnailPackStore?
+    private var memory: [String: ThumbnailImage] = [:]
+    private var recency: [String] = []
+    private var inFlight: [String: Task<Loaded, Never>] = [:]
+    private var prefetchTask: Task<Void, Never>?
+
+    /// - Parameters:
+    ///   - packURL: 磁盘缓存路径（nil 或打开失败时只用内存缓存）
+    ///   - maxPixelSize: 最长边像素上限（网格卡片 300px）
+    ///   - memoryCapacity: 内存缓存条数（300×169 RGBA 约 200 KB/张）
+    ///   - diskBudgetBytes: 磁盘缓存容量上限
+    public init(
+        packURL: URL?,
+        maxPixelSize: Int = 300,
+        memoryCapacity: Int = 200,
+        diskBudgetBytes: Int = 256 * 1024 * 1024
+    ) {
+        self.maxPixelSize = maxPixelSize
+        self.memoryCapacity = max(1, memoryCapacity)
+        self.pack = packURL.flatMap { try? ThumbnailPackStore(url: $0, budgetBytes: diskBudgetBytes) }
+    }
+
+    /// 默认磁盘缓存路径（~/Library/Application Support/FindIt/thumbnails.pack）
+    public static func defaultURL() throws -> URL {
+        try DatabaseManager.appSupportDirectory().appendingPathComponent("thumbnails.pack")
+    }
+
+    // MARK: - 公开方法
+
+    /// 获取缩略图（内存 → 磁盘缓存 → 解码）
+    ///
+    /// - Returns: nil 表示文件不存在或无法解码
+    public func thumbnail(for path: String, priority: TaskPriority = .userInitiated) async -> ThumbnailImage? {
+        if let cached = memory[path] {
+            stats.memoryHits += 1
+            touch(path)
+            return cached
+        }
+        if let running = inFlight[path] {
+            return await running.value.image
+        }
+
+        let pack = self.pack
+        let maxPixelSize = self.maxPixelSize
+        let task = Task.detached(priority: priority) {
+            Self.loadUncached(path: path, maxPixelSize: maxPixelSize, pack: pack)
+        }
+        inFlight[path] = task
+        let loaded = await task.value
+        inFlight.removeValue(forKey: path)
+
+        switch loaded.source {
+        case .disk: stats.diskHits += 1
+        case .decoded: stats.decodes += 1
+        case .failed: stats.failures += 1
+        }
+        if let image = loaded.image {
+            insert(path, image)
+        }
+        return loaded.image
+    }
+
+    /// 按滚动位置预取（替换上一批预取）
+    ///
+    /// - Parameter paths: 即将进入可见区域的缩略图路径，按优先顺序排列
+    public func prefetch(_ paths: [String]) {
+        prefetchTask?.cancel()
+        let pending = paths.filter { memory[$0] == nil }
+        guard !pending.isEmpty else {
+            prefetchTask = nil
+            return
+        }
+        prefetchTask = Task(priority: .utility) {
+            await withTaskGroup(of: Void.self) { group in
+                var iterator = pending.makeIterator()
+                for _ in 0..<Self.prefetchConcurrency {
+                    guard let path = iterator.next() else { break }
+                    group.addTask { _ = await self.thumbnail(for: path, priority: .utility) }
+                }
+                while await group.next() != nil {
+                    guard !Task.isCancelled, let path = iterator.next() else { continue }
+                    group.addTask { _ = await self.thumbnail(for: path, priority: .utility) }
+                }
+            }
+        }
+    }
+
+    /// 移除单个路径的内存缓存（缩略图文件被重新生成时）
+    public func invalidate(path: String) {
+        memory.removeValue(forKey: path)
+        recency.removeAll { $0 == path }
+    }
+
+    /// 剔除文件（或目录下全部文件）在磁盘缓存中的条目
+    ///
+    /// 缓存键含 mtime，须在文件删除前调用；内存缓存不受影响（App 刷新结果时自然替换）。
+    public nonisolated func evictFromDisk(path: String) {
+        guard let pack else { return }
+        let fileManager = FileManager.default
+        var isDirectory: ObjCBool = false
+        guard fileManager.fileExists(atPath: path, isDirectory: &isDirectory) else { return }
+        let files = isDirectory.boolValue
+            ? ((try? fileManager.contentsOfDirectory(atPath: path)) ?? []).map { (path as NSString).appendingPathComponent($0) }
+            : [path]
+        let keys = files.compactMap { file -> UInt64? in
+            guard let modified = (try? fileManager.attributesOfItem(atPath: file))?[.modificationDate] as? Date else {
+                return nil
+            }
+            return Self.cacheKey(path: file, modificationDate: modified, maxPixelSize: maxPixelSize)
+        }
+        try? pack.remove(keys: keys)
+    }
+
+    /// 清空内存缓存（磁盘缓存保留）
+    public func removeAllFromMemory() {
+        memory.removeAll()
+        recency.removeAll()
+    }
+
+    /// 内存缓存条数
+    public var memoryCount: Int { memory.count }
+
+    /// 磁盘缓存条数
+    public var diskCount: Int { pack?.count ?? 0 }
+
+    // MARK: - 缓存键
+
+    /// 磁盘缓存键：XXH3(路径 \0 mtime \0 尺寸)
+    ///
+    /// 缩略图文件被覆盖后 mtime 变化，旧条目自然失效，由容量淘汰回收。
+    public static func cacheKey(path: String, modificationDate: Date, maxPixelSize: Int) -> UInt64 {
+        let seed = "\(path)\u{0}\(modificationDate.timeIntervalSince1970.bitPattern)\u{0}\(maxPixelSize)"
+        return seed.utf8CString.withUnsafeBytes { raw in
+            // 不含末尾 NUL
+            UInt64(XXH3_64bits(raw.baseAddress, raw.count - 1))
+        }
+    }
+
+    // MARK: - Private
+
+    private func insert(_ path: String, _ image: ThumbnailImage) {
+        if memory[path] == nil, memory.count >= memoryCapacity, let oldest = recency.first {
+            memory.removeValue(forKey: oldest)
+            recency.removeFirst()
+        }
+        memory[path] = image
+        touch(path)
+    }
+
+    private func touch(_ path: String) {
+        if let idx = recency.lastIndex(of: path) {
+            recency.remove(at: idx)
+        }
+        recency.append(path)
+    }
+
+    /// 磁盘缓存 → 解码（在后台线程执行）
+    static func loadUncached(path: String, maxPixelSize: Int, pack: ThumbnailPackStore?) -> Loaded {
+        guard let attributes = try? FileManager.default.attributesOfItem(atPath: path),
+              let modified = attributes[.modificationDate] as? Date else {
+            return Loaded(image: nil, source: .failed)
+        }
+        let key = cacheKey(path: path, modificationDate: modified, maxPixelSize: maxPixelSize)
+        if let image = pack?.read(key: key) {
+            return Loaded(image: image, source: .disk)
+        }
+        guard let image = decode(path: path, maxPixelSize: maxPixelSize) else {
+            return Loaded(image: nil, source: .failed)
+        }
+        try? pack?.write(key: key, image: image)
+        return Loaded(image: image, source: .decoded)
+    }
+
+    /// ImageIO 解码为 RGBA8 后用 `ThumbnailResizer` 下采样
+    ///
+    /// 源图远大于目标尺寸时先让 ImageIO 以 2 倍目标尺寸解码
+    /// （JPEG 可在 DCT 阶段降采样），再由内核做最终面积平均。
+    static func decode(path: String, maxPixelSize: Int) -> ThumbnailImage? {
+        let url = URL(fileURLWithPath: path)
+        guard let source = CGImageSourceCreateWithURL(url as CFURL, nil) else { return nil }
+        return decode(source: source, maxPixelSize: maxPixelSize)
+    }
+
+    /// 解码内存中的编码图像（JPEG / PNG 等）
+    static func decode(data: Data, maxPixelSize: Int) -> ThumbnailImage? {
+        guard let source = CGImageSourceCreateWithData(data as CFData, nil) else { return nil }
+        return decode(source: source, maxPixelSize: maxPixelSize)
+    }
+
+    private static func decode(source: CGImageSource, maxPixelSize: Int) -> ThumbnailImage? {
+        let properties = CGImageSourceCopyPropertiesAtIndex(source, 0, nil) as? [CFString: Any]
+        let sourceWidth = properties?[kCGImagePropertyPixelWidth] as? Int ?? 0
+        let sourceHeight = properties?[kCGImagePropertyPixelHeight] as? Int ?? 0
+
+        let decoded: CGImage?
+        if max(sourceWidth, sourceHeight) > maxPixelSize * 4 {
+            let options: [CFString: Any] = [
+                kCGImageSourceThumbnailMaxPixelSize: maxPixelSize * 2,
+                kCGImageSourceCreateThumbnailFromImageAlways: true,
+                kCGImageSourceCreateThumbnailWithTransform: true,
+            ]
+            decoded = CGImageSourceCreateThumbnailAtIndex(source, 0, options as CFDictionary)
+        } else {
+            decoded = CGImageSourceCreateImageAtIndex(source, 0, nil)
+        }
+        guard let image = decoded,
+              let colorSpace = CGColorSpace(name: CGColorSpace.sRGB) else { return nil }
+
+        let width = image.width
+        let height = image.height
+        guard width > 0, height > 0 else { return nil }
+        let rowBytes = width * 4
+        var buffer = [UInt8](repeating: 0, count: rowBytes * height)
+        let drawn = buffer.withUnsafeMutableBytes { raw -> Bool in
+            guard let context = CGContext(
+                data: raw.baseAddress,
+                width: width,
+                height: height,
+                bitsPerComponent: 8,
+                bytesPerRow: rowBytes,
+                space: colorSpace,
+                bitmapInfo: CGImageAlphaInfo.premultipliedLast.rawValue
+            ) else { return false }
+            context.draw(image, in: CGRect(x: 0, y: 0, width: width, height: height))
+            return true
+        }
+        guard drawn else { return nil }
+
+        return buffer.withUnsafeBytes {
+            ThumbnailResizer.downsample($0, width: width, height: height, rowBytes: rowBytes, maxPixelSize: maxPixelSize)
+        }
+    }
+}
+
+// MARK: - CGImage
+
+extension ThumbnailImage {
+    /// 包装为 CGImage（sRGB，预乘 alpha）
+    public func makeCGImage() -> CGImage? {
+        guard let provider = CGDataProvider(data: Data(pixels) as CFData),
+              let colorSpace = CGColorSpace(name: CGColorSpace.sRGB) else { return nil }
+        return CGImage(
+            width: width,
+            height: height,
+            bitsPerComponent: 8,
+            bitsPerPixel: 32,
+            bytesPerRow: width * 4,
+            space: colorSpace,
+            bitmapInfo: CGBitmapInfo(rawValue: CGImageAlphaInfo.premultipliedLast.rawValue),
+            provider: provider,
+            decode: nil,
+            shouldInterpolate: true,
+            intent: .defaultIntent
+        )
+    }
+}
@@ -0,0 +1,335 @@
+import Foundation
+#if canImport(Darwin)
+import Darwin
+#else
+import Glibc
+#endif
+
+/// 文件标签写入错误
+public enum FileTagError: LocalizedError {
+    /// 系统调用失败
+    case systemCall(String, errno: Int32)
+
+    public var errorDescription: String? {
+        switch self {
+        case .systemCall(let call, let code):
+            return "文件标签 \(call) 失败: \(String(cString: strerror(code)))"
+        }
+    }
+}
+
+/// 文件标签存储后端
+///
+/// 读写文件的完整标签列表（颜色标签以 `"Name\nNumber"` 形式出现在列表中）。
+public protocol FileTagBackend: Sendable {
+    /// 读取标签（无标签返回空数组）
+    func readTags(path: String) throws -> [String]
+    /// 覆盖写入标签（空数组 = 移除）
+    func writeTags(_ tags: [String], path: String) throws
+}
+
+#if os(macOS)
+/// macOS Finder 标签（`NSURLTagNamesKey`，即 `com.apple.metadata:_kMDItemUserTags`）
+public struct FinderTagBackend: FileTagBackend {
+    public init() {}
+
+    public func readTags(path: String) throws -> [String] {
+        let nsurl = URL(fileURLWithPath: path) as NSURL
+        var tagValue: AnyObject?
+        try nsurl.getResourceValue(&tagValue, forKey: .tagNamesKey)
+        return (tagValue as? [String]) ?? []
+    }
+
+    public func writeTags(_ tags: [String], path: String) throws {
+        let nsurl = URL(fileURLWithPath: path) as NSURL
+        try nsurl.setResourceValue(tags, forKey: .tagNamesKey)
+    }
+}
+#endif
+
+/// 扩展属性后端：标签以 NUL 分隔的 UTF-8 存于单个 xattr
+///
+/// Linux 上使用 `user.*` 命名空间（普通用户可写，tmpfs/ext4/btrfs 均支持），
+/// 用于在非 macOS 环境测试写入队列；macOS 上同样可用（属性名不受命名空间限制）。
+public struct UserXattrTagBackend: FileTagBackend {
+    /// 扩展属性名
+    public let name: String
+
+    public init(name: String = "user.findit.tags") {
+        self.name = name
+    }
+
+    public func readTags(path: String) throws -> [String] {
+        let size = Self.get(path, name, nil, 0)
+        if size < 0 {
+            if errno == Self.noAttribute { return [] }
+            throw FileTagError.systemCall("getxattr", errno: errno)
+        }
+        var buffer = [UInt8](repeating: 0, count: size)
+        let read = buffer.withUnsafeMutableBytes { Self.get(path, name, $0.baseAddress, size) }
+        guard read >= 0 else { throw FileTagError.systemCall("getxattr", errno: errno) }
+        return buffer.prefix(read)
+            .split(separator: 0, omittingEmptySubsequences: true)
+            .map { String(decoding: $0, as: UTF8.self) }
+    }
+
+    public func writeTags(_ tags: [String], path: String) throws {
+        guard !tags.isEmpty else {
+            if Self.remove(path, name) != 0, errno != Self.noAttribute {
+                throw FileTagError.systemCall("removexattr", errno: errno)
+            }
+            return
+        }
+        let bytes = Array(tags.joined(separator: "\0").utf8)
+        let result = bytes.withUnsafeBytes { Self.set(path, name, $0.baseAddress, bytes.count) }
+        guard result == 0 else { throw FileTagError.systemCall("setxattr", errno: errno) }
+    }
+
+    // MARK: - 平台差异
+
+    #if canImport(Darwin)
+    private static let noAttribute = ENOATTR
+    private static func get(_ path: String, _ name: String, _ value: UnsafeMutableRawPointer?, _ size: Int) -> Int {
+        getxattr(path, name, value, size, 0, 0)
+    }
+    private static func set(_ path: String, _ name: String, _ value: UnsafeRawPointer?, _ size: Int) -> Int32 {
+        setxattr(path, name, value, size, 0, 0)
+    }
+    private static func remove(_ path: String, _ name: String) -> Int32 {
+        removexattr(path, name, 0)
+    }
+    #else
+    private static let noAttribute = ENODATA
+    private static func get(_ path: String, _ name: String, _ value: UnsafeMutableRawPointer?, _ size: Int) -> Int {
+        getxattr(path, name, value, size)
+    }
+    private static func set(_ path: String, _ name: String, _ value: UnsafeRawPointer?, _ size: Int) -> Int32 {
+        setxattr(path, name, value, size, 0)
+    }
+    private static func remove(_ path: String, _ name: String) -> Int32 {
+        removexattr(path, name)
+    }
+    #endif
+}
+
+/// 异步批量文件标签写入器
+///
+/// `ClipLabel.syncFinderTag` 同步读改写扩展属性，在网络盘 / USB 盘上批量打标签时
+/// 每个文件一次往返，调用方（UI）被阻塞数秒。写入器：
+/// - 入队立即返回；同一文件的多次修改只保留最后一次（last write wins）
+/// - 延迟 `flushDelay` 后批量写出，按卷（`st_dev`）分组并行，
+///   慢速卷不会拖住其他卷，同一卷内顺序写避免磁头/网络抖动
+/// - 瞬时错误（EINTR / EAGAIN / EBUSY / ETIMEDOUT / 网络错误）按指数退避重试，
+///   期间若有新值入队则直接以新值替换；永久错误（只读卷、文件不存在等）丢弃
+public final class FileTagWriter: @unchecked Sendable {
+
+    /// 写入器配置
+    public struct Config: Sendable {
+        /// 首次入队到写出的合并窗口（秒）
+        public var flushDelay: TimeInterval
+        /// 最大尝试次数（含首次）
+        public var maxAttempts: Int
+        /// 首次重试退避（秒，之后每次翻倍）
+        public var retryBackoff: TimeInterval
+
+        public static let `default` = Config()
+
+        public init(flushDelay: TimeInterval = 0.3, maxAttempts: Int = 4, retryBackoff: TimeInterval = 0.5) {
+            self.flushDelay = flushDelay
+            self.maxAttempts = max(1, maxAttempts)
+            self.retryBackoff = retryBackoff
+        }
+    }
+
+    /// 累计统计
+    public struct Stats: Sendable, Equatable {
+        /// 成功写入的文件数
+        public var written = 0
+        /// 被后续修改覆盖而省去的写入数
+        public var coalesced = 0
+        /// 重试次数
+        public var retried = 0
+        /// 最终失败数
+        public var failed = 0
+    }
+
+    /// App 共享实例
+    public static let shared: FileTagWriter = {
+        #if os(macOS)
+        return FileTagWriter(backend: FinderTagBackend())
+        #else
+        return FileTagWriter(backend: UserXattrTagBackend())
+        #endif
+    }()
+
+    public let backend: FileTagBackend
+    public let config: Config
+
+    private struct Item {
+        var label: ColorLabel?
+        var attempts = 0
+        var notBefore: Date
+    }
+
+    private let lock = NSLock()
+    private var pending: [String: Item] = [:]
+    private var inFlight: Set<String> = []
+    private var stats = Stats()
+    private var worker: Task<Void, Never>?
+
+    public init(backend: FileTagBackend, config: Config = .default) {
+        self.backend = backend
+        self.config = config
+    }
+
+    // MARK: - 入队
+
+    /// 设置文件的颜色标签（nil = 移除），立即返回
+    public func enqueue(path: String, label: ColorLabel?) {
+        lock.lock(); defer { lock.unlock() }
+        if pending[path] != nil { stats.coalesced += 1 }
+        pending[path] = Item(label: label, notBefore: Date().addingTimeInterval(config.flushDelay))
+        startWorkerLocked()
+    }
+
+    /// 当前统计
+    public var currentStats: Stats {
+        lock.lock(); defer { lock.unlock() }
+        return stats
+    }
+
+    /// 尚未写出的文件数（含写入中）
+    public var pendingCount: Int {
+        lock.lock(); defer { lock.unlock() }
+        return pending.count + inFlight.count
+    }
+
+    /// 立即写出全部待写标签并等待完成（忽略合并窗口与退避，重试用尽为止）
+    ///
+    /// App 退出前或测试中调用。
+    public func flush() async {
+        while true {
+            let batch = take(ignoringSchedule: true)
+            if batch.isEmpty {
+                if pendingCount == 0 { return }
+                // 其他批次写入中
+                try? await Task.sleep(nanoseconds: 5_000_000)
+                continue
+            }
+            await write(batch)
+        }
+    }
+
+    // MARK: - Private
+
+    private func startWorkerLocked() {
+        guard worker == nil else { return }
+        worker = Task.detached(priority: .utility) { [weak self] in
+            await self?.run()
+        }
+    }
+
+    /// 后台循环：等待最早到期项，取出到期批次写出，直到队列清空
+    private func run() async {
+        while true {
+            let batch = take(ignoringSchedule: false)
+            if !batch.isEmpty {
+                await write(batch)
+                continue
+            }
+            lock.lock()
+            if pending.isEmpty {
+                worker = nil
+                lock.unlock()
+                return
+            }
+            let wait = pending.values.map(\.notBefore).min().map { $0.timeIntervalSinceNow } ?? 0
+            lock.unlock()
+            try? await Task.sleep(nanoseconds: UInt64(max(0.005, wait) * 1_000_000_000))
+        }
+    }
+
+    /// 取出可写项（跳过正在写入的路径，保证同一文件串行）
+    private func take(ignoringSchedule: Bool) -> [(path: String, item: Item)] {
+        lock.lock(); defer { lock.unlock() }
+        let now = Date()
+        let ready = pending.filter { path, item in
+            !inFlight.contains(path) && (ignoringSchedule || item.notBefore <= now)
+        }
+        for path in ready.keys {
+            pending.removeValue(forKey: path)
+            inFlight.insert(path)
+        }
+        return ready.map { ($0.key, $0.value) }
+    }
+
+    /// 按卷分组并行写出
+    private func write(_ batch: [(path: String, item: Item)]) async {
+        let groups = Dictionary(grouping: batch) { Self.volumeKey($0.path) }
+        let backend = self.backend
+        let outcomes = await withTaskGroup(of: [(String, Item, Error?)].self) { group in
+            for entries in groups.values {
+                group.addTask {
+                    entries.map { entry in
+                        do {
+                            try ClipLabel.syncFinderTag(filePath: entry.path, label: entry.item.label, backend: backend)
+                            return (entry.path, entry.item, nil)
+                        } catch {
+                            return (entry.path, entry.item, error)
+                        }
+                    }
+                }
+            }
+            var all: [(String, Item, Error?)] = []
+            for await results in group { all += results }
+            return all
+        }
+
+        lock.lock(); defer { lock.unlock() }
+        for (path, item, error) in outcomes {
+            inFlight.remove(path)
+            guard let error else {
+                stats.written += 1
+                continue
+            }
+            // 写入期间已有新值入队：新值会覆盖，本次结果无关紧要
+            guard pending[path] == nil else { continue }
+            var retry = item
+            retry.attempts += 1
+            if Self.isTransient(error), retry.attempts < config.maxAttempts {
+                stats.retried += 1
+                let backoff = config.retryBackoff * pow(2, Double(retry.attempts - 1))
+                retry.notBefore = Date().addingTimeInterval(backoff)
+                pending[path] = retry
+            } else {
+                stats.failed += 1
+                print("[FileTagWriter] 标签写入失败: \(path) - \(error.localizedDescription)")
+            }
+        }
+        if !pending.isEmpty { startWorkerLocked() }
+    }
+
+    /// 卷标识（stat 失败时归入同一组，由写入报告错误）
+    static func volumeKey(_ path: String) -> UInt64 {
+        var info = stat()
+        guard stat(path, &info) == 0 else { return .max }
+        return UInt64(truncatingIfNeeded: Int64(info.st_dev))
+    }
+
+    /// 可重试的瞬时错误
+    static func isTransient(_ error: Error) -> Bool {
+        let transient: Set<Int32> = [EINTR, EAGAIN, EBUSY, ETIMEDOUT, EIO, ENETDOWN, ENETUNREACH,
+                                     ECONNRESET, ECONNABORTED, EHOSTUNREACH, ENOLCK]
+        if case FileTagError.systemCall(_, let code) = error {
+            return transient.contains(code)
+        }
+        let nsError = error as NSError
+        if nsError.domain == NSPOSIXErrorDomain {
+            return transient.contains(Int32(nsError.code))
+        }
+        if let underlying = nsError.userInfo[NSUnderlyingErrorKey] as? Error {
+            return isTransient(underlying)
+        }
+        return false
+    }
+}
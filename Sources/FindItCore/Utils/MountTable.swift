@@ -0,0 +1,221 @@
+import Foundation
+import DiskArbitration
+
+/// 挂载表缓存
+///
+/// `VolumeResolver` 原先每次按 UUID 查挂载点都要枚举全部卷并逐个读取资源值，
+/// 同步、路径重定向、健康检查又按路径反复解析。本缓存一次读取系统挂载表，建立：
+/// - UUID → 挂载点索引
+/// - 挂载点 → 卷信息索引（按路径逐级向上查找，最长前缀匹配，代价 = 路径深度）
+///
+/// 只在挂载变化时失效：共享实例注册 DiskArbitration 回调（卷出现 / 消失 / 挂载路径变化），
+/// 回调只标记过期，下次查询时才重建，连续事件只重建一次。
+public final class MountTable: @unchecked Sendable {
+
+    /// 挂载项
+    public struct Mount: Sendable, Equatable {
+        /// 挂载点（无尾随斜杠，根卷为 "/"）
+        public let mountPoint: String
+        /// 卷信息
+        public let volume: VolumeResolver.VolumeInfo
+
+        public init(mountPoint: String, volume: VolumeResolver.VolumeInfo) {
+            self.mountPoint = mountPoint
+            self.volume = volume
+        }
+    }
+
+    /// 进程共享实例（监听挂载变化）
+    public static let shared: MountTable = {
+        let table = MountTable(source: MountTable.systemMounts)
+        table.startMonitoring()
+        return table
+    }()
+
+    private let lock = NSLock()
+    private let source: @Sendable () -> [Mount]
+    private var byMountPoint: [String: Mount] = [:]
+    private var byUUID: [String: Mount] = [:]
+    /// 落在根卷上的路径的逐路径解析结果（见 `volumeInfo(forPath:)`）
+    private var rootPathCache: [String: VolumeResolver.VolumeInfo] = [:]
+    private var isStale = true
+    private var session: DASession?
+
+    private var rebuilds = 0
+
+    /// 已重建次数（诊断用）
+    public var refreshCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return rebuilds
+    }
+
+    /// 以固定挂载项构建（不读取系统挂载表，不监听变化）
+    public convenience init(mounts: [Mount]) {
+        self.init(source: { mounts })
+    }
+
+    init(source: @escaping @Sendable () -> [Mount]) {
+        self.source = source
+    }
+
+    deinit {
+        if let session {
+            DASessionSetDispatchQueue(session, nil)
+        }
+    }
+
+    // MARK: - 查询
+
+    /// 当前全部挂载项（按挂载点排序）
+    public var mounts: [Mount] {
+        withTable { $0.byMountPoint.values.sorted { $0.mountPoint < $1.mountPoint } }
+    }
+
+    /// 路径所在的挂载项（最长前缀匹配，目录边界对齐）
+    public func mount(containing path: String) -> Mount? {
+        withTable { table in
+            var candidate = Self.normalize(path)
+            while true {
+                if let mount = table.byMountPoint[candidate] { return mount }
+                guard candidate != "/" else { return nil }
+                candidate = Self.parent(of: candidate)
+            }
+        }
+    }
+
+    /// UUID 对应的挂载点（未挂载返回 nil）
+    public func mountPoint(forVolumeUUID uuid: String) -> String? {
+        guard !uuid.isEmpty else { return nil }
+        return withTable { $0.byUUID[uuid]?.mountPoint }
+    }
+
+    /// 路径所在卷的信息
+    ///
+    /// 非根挂载点下的路径直接取挂载表中的卷信息。落在根卷 "/" 上的路径
+    /// 可能经 firmlink 实际位于数据卷（如 `/Users`），其 UUID 与根卷不同，
+    /// 因此按路径读取一次资源值并缓存，同样在挂载变化时失效。
+    ///
+    /// - Returns: nil = 路径不在任何已知挂载点下
+    func volumeInfo(forPath path: String, resolveOnRoot: (String) -> VolumeResolver.VolumeInfo) -> VolumeResolver.VolumeInfo? {
+        guard let mount = mount(containing: path) else { return nil }
+        guard mount.mountPoint == "/" else { return mount.volume }
+
+        let key = Self.normalize(path)
+        lock.lock()
+        let cached = rootPathCache[key]
+        lock.unlock()
+        if let cached { return cached }
+
+        let info = resolveOnRoot(key)
+        lock.lock()
+        rootPathCache[key] = info
+        lock.unlock()
+        return info
+    }
+
+    // MARK: - 失效
+
+    /// 标记过期（挂载变化时调用，下次查询重建）
+    public func invalidate() {
+        lock.lock()
+        isStale = true
+        lock.unlock()
+    }
+
+    /// 在锁内读取索引（过期时先重建）
+    private func withTable<T>(_ body: (MountTable) -> T) -> T {
+        lock.lock()
+        defer { lock.unlock() }
+        if isStale {
+            rebuild(source())
+        }
+        return body(self)
+    }
+
+    /// 重建索引（调用方持锁）
+    private func rebuild(_ entries: [Mount]) {
+        byMountPoint.removeAll(keepingCapacity: true)
+        byUUID.removeAll(keepingCapacity: true)
+        rootPathCache.removeAll(keepingCapacity: true)
+        for entry in entries {
+            let mount = Mount(mountPoint: Self.normalize(entry.mountPoint), volume: entry.volume)
+            byMountPoint[mount.mountPoint] = mount
+            // 同一 UUID 出现在多个挂载点时（如系统卷的隐藏别名），取最短路径
+            if let uuid = mount.volume.uuid, !uuid.isEmpty {
+                if let existing = byUUID[uuid], existing.mountPoint.count <= mount.mountPoint.count { continue }
+                byUUID[uuid] = mount
+            }
+        }
+        isStale = false
+        rebuilds += 1
+    }
+
+    // MARK: - 系统挂载表
+
+    /// 读取系统挂载表（一次枚举，资源值随枚举批量取回）
+    static let systemMounts: @Sendable () -> [Mount] = {
+        let keys: [URLResourceKey] = [
+            .volumeUUIDStringKey,
+            .volumeNameKey,
+            .volumeIsRemovableKey,
+            .volumeIsInternalKey,
+        ]
+        guard let urls = FileManager.default.mountedVolumeURLs(includingResourceValuesForKeys: keys, options: []) else {
+            return []
+        }
+        return urls.map { url in
+            let values = try? url.resourceValues(forKeys: Set(keys))
+            return Mount(
+                mountPoint: url.path,
+                volume: VolumeResolver.VolumeInfo(
+                    uuid: values?.volumeUUIDString,
+                    name: values?.volumeName,
+                    isRemovable: values?.volumeIsRemovable ?? false,
+                    isInternal: values?.volumeIsInternal ?? true
+                )
+            )
+        }
+    }
+
+    /// 注册 DiskArbitration 回调：卷出现、消失或挂载路径变化时标记过期
+    private func startMonitoring() {
+        guard let session = DASessionCreate(kCFAllocatorDefault) else { return }
+        self.session = session
+        // 共享实例常驻进程生命周期，回调上下文无需持有引用
+        let context = Unmanaged.passUnretained(self).toOpaque()
+
+        DARegisterDiskAppearedCallback(session, nil, { _, ctx in
+            guard let ctx else { return }
+            Unmanaged<MountTable>.fromOpaque(ctx).takeUnretainedValue().invalidate()
+        }, context)
+        DARegisterDiskDisappearedCallback(session, nil, { _, ctx in
+            guard let ctx else { return }
+            Unmanaged<MountTable>.fromOpaque(ctx).takeUnretainedValue().invalidate()
+        }, context)
+        DARegisterDiskDescriptionChangedCallback(
+            session, nil, [kDADiskDescriptionVolumePathKey] as CFArray, { _, _, ctx in
+                guard let ctx else { return }
+                Unmanaged<MountTable>.fromOpaque(ctx).takeUnretainedValue().invalidate()
+            }, context
+        )
+        DASessionSetDispatchQueue(session, DispatchQueue(label: "com.findit.mount-table"))
+    }
+
+    // MARK: - 路径工具
+
+    /// 移除尾随斜杠（根路径除外）
+    static func normalize(_ path: String) -> String {
+        var normalized = path
+        while normalized.count > 1 && normalized.hasSuffix("/") {
+            normalized.removeLast()
+        }
+        return normalized.isEmpty ? "/" : normalized
+    }
+
+    /// 父目录（"/a/b" → "/a"，"/a" → "/"）
+    static func parent(of path: String) -> String {
+        guard let slash = path.lastIndex(of: "/"), slash != path.startIndex else { return "/" }
+        return String(path[..<slash])
+    }
+}
@@ -4,7 +4,7 @@ import Foundation
 ///
 /// 从文件路径解析所在卷的元数据（UUID、名称、可移除性等），
 /// 支持通过 UUID 在已挂载卷中查找匹配的挂载点。
-/// 纯 Foundation 框架，零外部依赖。
+/// 查询走 `MountTable.shared` 缓存，挂载变化前不重复枚举卷。
 public enum VolumeResolver {
 
     /// 卷信息
@@ -28,12 +28,21 @@ public enum VolumeResolver {
 
     /// 从文件路径解析所在卷的信息
     ///
-    /// 使用 `URL.resourceValues` 读取卷属性。
+    /// 先查挂载表缓存，未命中时用 `URL.resourceValues` 读取卷属性。
     /// 路径不存在或读取失败时返回默认值（nil uuid/name，非可移除，内置）。
     ///
-    /// - Parameter path: 文件或目录的绝对路径
+    /// - Parameters:
+    ///   - path: 文件或目录的绝对路径
+    ///   - mountTable: 挂载表（默认进程共享实例）
     /// - Returns: 卷信息
-    public static func resolve(path: String) -> VolumeInfo {
+    public static func resolve(path: String, mountTable: MountTable = .shared) -> VolumeInfo {
+        guard isAccessible(path: path) else { return VolumeInfo() }
+        return mountTable.volumeInfo(forPath: path, resolveOnRoot: resolveUncached)
+            ?? resolveUncached(path: path)
+    }
+
+    /// 直接读取路径的卷属性（不经缓存）
+    static func resolveUncached(path: String) -> VolumeInfo {
         let url = URL(fileURLWithPath: path)
 
         do {
@@ -71,23 +80,12 @@ public enum VolumeResolver {
     /// 用于外接硬盘重新连接后，通过 UUID 匹配新的挂载路径
     /// （即使挂载点变了也能识别同一个卷）。
     ///
-    /// - Parameter uuid: 目标卷的 UUID 字符串
+    /// - Parameters:
+    ///   - uuid: 目标卷的 UUID 字符串
+    ///   - mountTable: 挂载表（默认进程共享实例）
     /// - Returns: 匹配卷的挂载点路径，未找到返回 nil
-    public static func findMountPoint(forVolumeUUID uuid: String) -> String? {
-        guard !uuid.isEmpty else { return nil }
-
-        // 获取所有挂载点
-        let mountPoints = mountedVolumePaths()
-
-        for mountPath in mountPoints {
-            let url = URL(fileURLWithPath: mountPath)
-            if let values = try? url.resourceValues(forKeys: [.volumeUUIDStringKey]),
-               values.volumeUUIDString == uuid {
-                return mountPath
-            }
-        }
-
-        return nil
+    public static func findMountPoint(forVolumeUUID uuid: String, mountTable: MountTable = .shared) -> String? {
+        mountTable.mountPoint(forVolumeUUID: uuid)
     }
 
     /// 通过卷 UUID 更新文件夹路径
@@ -99,11 +97,15 @@ public enum VolumeResolver {
     ///   - oldPath: 旧的文件夹绝对路径
     ///   - volumeUUID: 卷 UUID
     /// - Returns: 更新后的路径，未找到返回 nil
-    public static func resolveUpdatedPath(oldPath: String, volumeUUID: String) -> String? {
-        guard let newMountPoint = findMountPoint(forVolumeUUID: volumeUUID) else { return nil }
+    public static func resolveUpdatedPath(
+        oldPath: String,
+        volumeUUID: String,
+        mountTable: MountTable = .shared
+    ) -> String? {
+        guard let newMountPoint = findMountPoint(forVolumeUUID: volumeUUID, mountTable: mountTable) else { return nil }
 
         // 获取旧路径所在的旧挂载点
-        let oldMountPoint = mountPointForPath(oldPath)
+        let oldMountPoint = mountPointForPath(oldPath, mountTable: mountTable)
 
         // 计算相对路径
         guard oldPath.hasPrefix(oldMountPoint) else { return nil }
@@ -151,7 +153,12 @@ public enum VolumeResolver {
     }
 
     /// 获取路径所在卷的挂载点
-    private static func mountPointForPath(_ path: String) -> String {
+    ///
+    /// 旧挂载点仍在挂载表中时直接取用；已卸载（挂载点变化的典型场景）时按 /Volumes 约定推断。
+    private static func mountPointForPath(_ path: String, mountTable: MountTable) -> String {
+        if let mount = mountTable.mount(containing: path), mount.mountPoint != "/" {
+            return mount.mountPoint
+        }
         // /Volumes/DiskName/some/folder → /Volumes/DiskName
         if path.hasPrefix("/Volumes/") {
             let parts = path.split(separator: "/", maxSplits: 3)
@@ -32,6 +32,19 @@ final class AudioExtractorTests: XCTestCase {
         XCTAssertEqual(args.last, "/输出/音频.wav")
     }
 
+    func testBuildSliceArguments() {
+        let args = AudioExtractor.buildSliceArguments(
+            inputPath: "/tmp/video_1.wav",
+            outputPath: "/tmp/video_1_part2.wav",
+            start: 1230.5,
+            duration: 600
+        )
+        XCTAssertEqual(Array(args.prefix(4)), ["-ss", "1230.500", "-t", "600.000"], "-ss 置于 -i 之前（快速定位）")
+        XCTAssertEqual(args[5], "/tmp/video_1.wav")
+        XCTAssertTrue(args.contains("copy"), "PCM 流复制，不重新编码")
+        XCTAssertEqual(args.last, "/tmp/video_1_part2.wav")
+    }
+
     // MARK: - 输入验证
 
     func testExtractAudioFileNotFound() {
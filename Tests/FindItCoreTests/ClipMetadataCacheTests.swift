@@ -0,0 +1,263 @@
+import XCTest
+import GRDB
+@testable import FindItCore
+
+final class ClipMetadataCacheTests: XCTestCase {
+
+    private var tempDir: URL!
+
+    override func setUpWithError() throws {
+        tempDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("ClipMetadataCacheTests-\(UUID().uuidString)")
+        try FileManager.default.createDirectory(at: tempDir, withIntermediateDirectories: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: tempDir)
+    }
+
+    // MARK: - Helper
+
+    /// 全局库：一个视频下两个片段 + 一个无视频片段
+    private func makeDB() throws -> (DatabaseQueue, [Int64]) {
+        let db = try DatabaseManager.makeGlobalInMemoryDatabase()
+        let ids: [Int64] = try db.write { dbConn in
+            try dbConn.execute(sql: """
+                INSERT INTO videos (source_folder, source_video_id, file_path, file_name)
+                VALUES ('/A', 1, '/A/sub/beach.mov', 'beach.mov')
+                """)
+            let videoId = dbConn.lastInsertedRowID
+            try dbConn.execute(sql: """
+                INSERT INTO clips (source_folder, source_clip_id, video_id, start_time, end_time,
+                                   scene, tags, rating, shot_type, mood)
+                VALUES ('/A', 1, ?, 0, 5, '海滩日落', 'beach', 4, 'wide', 'calm'),
+                       ('/A', 2, ?, 5, 9.5, '海浪', NULL, 0, 'wide', NULL)
+                """, arguments: [videoId, videoId])
+            try dbConn.execute(sql: """
+                INSERT INTO clips (source_folder, source_clip_id, start_time, end_time, scene)
+                VALUES ('/B', 3, 1, 2, '城市')
+                """)
+            return try Int64.fetchAll(dbConn, sql: "SELECT clip_id FROM clips ORDER BY clip_id")
+        }
+        return (db, ids)
+    }
+
+    private func sqlRecords(_ db: DatabaseQueue) throws -> [ClipMetadataRecord] {
+        try db.read { dbConn in
+            try Row.fetchAll(dbConn, sql: ClipMetadataRecord.selectSQL + "\nORDER BY c.clip_id")
+                .map(ClipMetadataRecord.init(row:))
+        }
+    }
+
+    // MARK: - 列式文件
+
+    func testEncodeDecodeRoundTrip() throws {
+        let (db, _) = try makeDB()
+        let records = try sqlRecords(db)
+
+        let data = ClipMetadataColumns.encode(records, fingerprint: "fp")
+        let columns = try ClipMetadataColumns(data: data)
+
+        XCTAssertEqual(columns.count, 3)
+        XCTAssertEqual(columns.fingerprint, "fp")
+        XCTAssertEqual((0..<3).map(columns.record(at:)), records)
+        XCTAssertNil(columns.row(for: 999))
+    }
+
+    func testCorruptFileIsRejected() throws {
+        let (db, _) = try makeDB()
+        var data = ClipMetadataColumns.encode(try sqlRecords(db), fingerprint: "fp")
+        data[30] ^= 0xFF
+        XCTAssertThrowsError(try ClipMetadataColumns(data: data))
+    }
+
+    // MARK: - 加载
+
+    func testLoadReusesFileWhenFingerprintMatches() async throws {
+        let (db, ids) = try makeDB()
+        let url = tempDir.appendingPathComponent("meta.cache")
+
+        let first = ClipMetadataCache(fileURL: url)
+        let reusedFirst = try await first.load(from: db)
+        XCTAssertFalse(reusedFirst)
+
+        let second = ClipMetadataCache(fileURL: url)
+        let reusedSecond = try await second.load(from: db)
+        XCTAssertTrue(reusedSecond)
+        XCTAssertEqual(second.records(for: [ids[0]])[ids[0]]?.fileName, "beach.mov")
+
+        // 新增片段后指纹变化，应重建
+        try db.write { dbConn in
+            try dbConn.execute(sql: """
+                INSERT INTO clips (source_folder, source_clip_id, start_time, end_time) VALUES ('/B', 4, 0, 1)
+                """)
+        }
+        let third = ClipMetadataCache(fileURL: url)
+        let reusedThird = try await third.load(from: db)
+        XCTAssertFalse(reusedThird)
+        XCTAssertEqual(third.count, 4)
+    }
+
+    // MARK: - 增量
+
+    func testApplySyncDeltaUpdatesOverlay() async throws {
+        let (db, ids) = try makeDB()
+        let cache = ClipMetadataCache(fileURL: nil)
+        try await cache.load(from: db)
+
+        let added: Int64 = try db.write { dbConn in
+            try dbConn.execute(sql: "UPDATE clips SET mood = 'tense' WHERE clip_id = ?", arguments: [ids[1]])
+            try dbConn.execute(sql: "DELETE FROM clips WHERE clip_id = ?", arguments: [ids[2]])
+            try dbConn.execute(sql: """
+                INSERT INTO clips (source_folder, source_clip_id, start_time, end_time, shot_type)
+                VALUES ('/B', 5, 0, 1, 'close')
+                """)
+            return dbConn.lastInsertedRowID
+        }
+        try await cache.applySyncDelta(SyncEngine.SyncResult(
+            syncedVideos: 0, syncedClips: 2,
+            addedClipIds: [added], updatedClipIds: [ids[1]], removedClipIds: [ids[2]]
+        ), from: db)
+
+        let records = cache.records(for: [ids[1], ids[2], added])
+        XCTAssertEqual(records[ids[1]]?.mood, "tense")
+        XCTAssertNil(records[ids[2]])
+        XCTAssertEqual(records[added]?.shotType, "close")
+        XCTAssertEqual(cache.count, 3)
+
+        // 合并后结果不变
+        try await cache.compact(from: db)
+        XCTAssertEqual(cache.records(for: [ids[1], ids[2], added]), records)
+    }
+
+    func testPatchUpdatesRatingAndInvalidatesFile() async throws {
+        let (db, ids) = try makeDB()
+        let url = tempDir.appendingPathComponent("meta.cache")
+        let cache = ClipMetadataCache(fileURL: url)
+        try await cache.load(from: db)
+
+        cache.patch(clipId: ids[0]) { $0.rating = 2 }
+
+        XCTAssertEqual(cache.records(for: [ids[0]])[ids[0]]?.rating, 2)
+        XCTAssertFalse(FileManager.default.fileExists(atPath: url.path), "未合并的修改应使磁盘文件失效")
+    }
+
+    func testPatchSurvivesCompactionAndReload() async throws {
+        let (db, ids) = try makeDB()
+        let url = tempDir.appendingPathComponent("meta.cache")
+        let cache = ClipMetadataCache(fileURL: url)
+        try await cache.load(from: db)
+
+        try db.write { try $0.execute(sql: "UPDATE clips SET rating = 1 WHERE clip_id = ?", arguments: [ids[0]]) }
+        cache.patch(clipId: ids[0]) { $0.rating = 1 }
+        try await cache.compact(from: db)
+        XCTAssertTrue(FileManager.default.fileExists(atPath: url.path), "修改已折叠进新文件")
+
+        let reopened = ClipMetadataCache(fileURL: url)
+        let reused = try await reopened.load(from: db)
+        XCTAssertTrue(reused)
+        XCTAssertEqual(reopened.records(for: [ids[0]])[ids[0]]?.rating, 1)
+    }
+
+    func testDeltaDuringRebuildIsNotLost() async throws {
+        let (db, ids) = try makeDB()
+        let cache = ClipMetadataCache(fileURL: nil)
+        try await cache.load(from: db)
+
+        for round in 0..<20 {
+            let mood = "第\(round)轮"
+            try db.write { try $0.execute(sql: "UPDATE clips SET mood = ? WHERE clip_id = ?", arguments: [mood, ids[1]]) }
+            // 重建与增量并发：无论先后，最终都应反映最新值
+            async let rebuilt: Void = cache.rebuild(from: db)
+            async let applied: Void = cache.applySyncDelta(SyncEngine.SyncResult(
+                syncedVideos: 0, syncedClips: 1, updatedClipIds: [ids[1]]
+            ), from: db)
+            _ = try await (rebuilt, applied)
+            XCTAssertEqual(cache.records(for: [ids[1]])[ids[1]]?.mood, mood)
+        }
+    }
+
+    // MARK: - Hydration
+
+    func testHydrationFallsBackToSQLiteForUncachedClips() async throws {
+        let (db, ids) = try makeDB()
+        let cache = ClipMetadataCache(fileURL: nil)
+        try await cache.load(from: db)
+
+        // 刚同步、缓存尚未收到增量的 clip
+        let fresh: Int64 = try db.write { dbConn in
+            try dbConn.execute(sql: """
+                INSERT INTO clips (source_folder, source_clip_id, video_id, start_time, end_time, scene)
+                VALUES ('/A', 9, (SELECT video_id FROM videos LIMIT 1), 10, 12, '新片段')
+                """)
+            return dbConn.lastInsertedRowID
+        }
+        let storeResults: [(clipId: Int64, similarity: Float)] = [(fresh, 0.95), (ids[0], 0.8), (ids[2], 0.7)]
+
+        let results = try db.read { dbConn in
+            try SearchEngine.vectorSearchFromStore(
+                dbConn, storeResults: storeResults, metadataCache: cache,
+                folderPaths: ["/A"], pathPrefixFilter: nil, limit: 10
+            )
+        }
+        XCTAssertEqual(results.map(\.clipId), [fresh, ids[0]])
+        XCTAssertEqual(results.first?.filePath, "/A/sub/beach.mov")
+    }
+
+    func testHydrationMatchesSQLite() async throws {
+        let (db, ids) = try makeDB()
+        let cache = ClipMetadataCache(fileURL: nil)
+        try await cache.load(from: db)
+        let storeResults: [(clipId: Int64, similarity: Float)] = [(ids[2], 0.9), (ids[0], 0.8), (ids[1], 0.7)]
+
+        for (folders, prefix) in [(nil, nil), (Set(["/A"]), nil), (nil, "/A/sub"), (Set<String>(), nil)] as [(Set<String>?, String?)] {
+            let fromSQL = try db.read { dbConn in
+                try SearchEngine.vectorSearchFromStore(
+                    dbConn, storeResults: storeResults,
+                    folderPaths: folders, pathPrefixFilter: prefix, limit: 10
+                )
+            }
+            let fromCache = try db.read { dbConn in
+                try SearchEngine.vectorSearchFromStore(
+                    dbConn, storeResults: storeResults, metadataCache: cache,
+                    folderPaths: folders, pathPrefixFilter: prefix, limit: 10
+                )
+            }
+            XCTAssertEqual(fromCache.map(\.clipId), fromSQL.map(\.clipId))
+            XCTAssertEqual(fromCache.map(\.filePath), fromSQL.map(\.filePath))
+            XCTAssertEqual(fromCache.map(\.rating), fromSQL.map(\.rating))
+            XCTAssertEqual(fromCache.map(\.scene), fromSQL.map(\.scene))
+            XCTAssertEqual(fromCache.map(\.tags), fromSQL.map(\.tags))
+        }
+    }
+
+    func testLongTextStaysOutOfCacheFile() async throws {
+        let (db, ids) = try makeDB()
+        let description = String(repeating: "海浪拍打礁石，远处的灯塔在薄雾中闪烁。", count: 20)
+        let transcript = "潮水退去之后的沙滩上只剩下脚印"
+        try db.write { dbConn in
+            try dbConn.execute(sql: "UPDATE clips SET description = ?, transcript = ? WHERE clip_id = ?",
+                               arguments: [description, transcript, ids[0]])
+        }
+        let url = tempDir.appendingPathComponent("meta.cache")
+        let cache = ClipMetadataCache(fileURL: url)
+        try await cache.load(from: db)
+
+        // 字符串池只有短字段
+        let file = try Data(contentsOf: url)
+        XCTAssertNil(file.range(of: Data(description.utf8)))
+        XCTAssertNil(file.range(of: Data(transcript.utf8)))
+        XCTAssertNil(file.range(of: Data("海滩日落".utf8)))
+
+        // 展示行的文本按主键补全
+        let results = try db.read { dbConn in
+            try SearchEngine.vectorSearchFromStore(
+                dbConn, storeResults: [(ids[0], 0.9), (ids[1], 0.8)], metadataCache: cache, limit: 10
+            )
+        }
+        XCTAssertEqual(results.first?.clipDescription, description)
+        XCTAssertEqual(results.first?.transcript, transcript)
+        XCTAssertEqual(results.first?.scene, "海滩日落")
+        XCTAssertEqual(results.first?.fileName, "beach.mov")
+    }
+}
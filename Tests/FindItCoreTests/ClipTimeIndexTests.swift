@@ -0,0 +1,121 @@
+import XCTest
+import GRDB
+@testable import FindItCore
+
+final class ClipTimeIndexTests: XCTestCase {
+
+    // MARK: - Helper
+
+    /// 一个文件夹、两个视频：视频 1 切为 [0,5) [5,12) [10,20)（后两段重叠），视频 2 一段 [0,30)
+    private func makeFolderDB() throws -> (DatabaseQueue, video1: Int64, video2: Int64) {
+        let db = try DatabaseManager.makeFolderInMemoryDatabase()
+        let ids = try db.write { db -> (Int64, Int64) in
+            var folder = WatchedFolder(folderPath: "/Volumes/A/素材")
+            try folder.insert(db)
+            var v1 = Video(folderId: folder.folderId, filePath: "/Volumes/A/素材/long.mov", fileName: "long.mov")
+            try v1.insert(db)
+            var v2 = Video(folderId: folder.folderId, filePath: "/Volumes/A/素材/b.mov", fileName: "b.mov")
+            try v2.insert(db)
+            for (videoId, start, end) in [(v1.videoId, 0.0, 5.0), (v1.videoId, 5.0, 12.0),
+                                          (v1.videoId, 10.0, 20.0), (v2.videoId, 0.0, 30.0)] {
+                var clip = Clip(videoId: videoId, startTime: start, endTime: end)
+                try clip.insert(db)
+            }
+            return (v1.videoId!, v2.videoId!)
+        }
+        return (db, ids.0, ids.1)
+    }
+
+    private func ranges(_ spans: [ClipTimeIndex.Span]) -> [ClosedRange<Double>] {
+        spans.map { $0.startTime...$0.endTime }
+    }
+
+    // MARK: - 点查
+
+    func testPointLookupIsHalfOpen() throws {
+        let (db, video1, _) = try makeFolderDB()
+        try db.read { db in
+            XCTAssertEqual(ranges(try ClipTimeIndex.clips(db, videoId: video1, at: 2.5)), [0...5])
+            XCTAssertEqual(ranges(try ClipTimeIndex.clips(db, videoId: video1, at: 5)), [5...12], "交界时刻属于后一段")
+            XCTAssertEqual(ranges(try ClipTimeIndex.clips(db, videoId: video1, at: 11)), [5...12, 10...20])
+            XCTAssertTrue(try ClipTimeIndex.clips(db, videoId: video1, at: 20).isEmpty)
+            XCTAssertTrue(try ClipTimeIndex.clips(db, videoId: video1, at: -1).isEmpty)
+        }
+    }
+
+    func testSingleClipPrefersLatestStart() throws {
+        let (db, video1, video2) = try makeFolderDB()
+        try db.read { db in
+            XCTAssertEqual(try ClipTimeIndex.clip(db, videoId: video1, at: 11)?.startTime, 10)
+            XCTAssertEqual(try ClipTimeIndex.clip(db, videoId: video2, at: 11)?.videoId, video2, "不串到其他视频")
+            XCTAssertNil(try ClipTimeIndex.clip(db, videoId: video2, at: 30))
+        }
+    }
+
+    // MARK: - 区间查询
+
+    func testRangeReturnsOverlaps() throws {
+        let (db, video1, _) = try makeFolderDB()
+        try db.read { db in
+            XCTAssertEqual(ranges(try ClipTimeIndex.clips(db, videoId: video1, from: 4, to: 6)), [0...5, 5...12])
+            XCTAssertEqual(ranges(try ClipTimeIndex.clips(db, videoId: video1, from: 5, to: 10)), [5...12], "端点相接不算重叠")
+            XCTAssertEqual(try ClipTimeIndex.clips(db, videoId: video1, from: 0, to: 100).count, 3)
+            XCTAssertEqual(ranges(try ClipTimeIndex.clips(db, videoId: video1, from: 3, to: 3)), [0...5])
+            XCTAssertTrue(try ClipTimeIndex.clips(db, videoId: video1, from: 6, to: 4).isEmpty)
+        }
+    }
+
+    // MARK: - 触发器维护
+
+    func testIndexFollowsClipWrites() throws {
+        let (db, video1, video2) = try makeFolderDB()
+        try db.write { db in
+            try db.execute(sql: "UPDATE clips SET start_time = 40, end_time = 45 WHERE video_id = ? AND start_time = 0", arguments: [video1])
+            XCTAssertTrue(try ClipTimeIndex.clips(db, videoId: video1, at: 2).isEmpty)
+            XCTAssertEqual(try ClipTimeIndex.clip(db, videoId: video1, at: 42)?.startTime, 40)
+
+            // 只改无关列不影响索引
+            try db.execute(sql: "UPDATE clips SET tags = '海边' WHERE video_id = ?", arguments: [video1])
+            XCTAssertTrue(try ClipTimeIndex.isConsistent(db))
+
+            // 删除视频级联删除 clips，索引同步清理
+            try db.execute(sql: "DELETE FROM videos WHERE video_id = ?", arguments: [video2])
+            XCTAssertNil(try ClipTimeIndex.clip(db, videoId: video2, at: 1))
+            XCTAssertTrue(try ClipTimeIndex.isConsistent(db))
+        }
+    }
+
+    func testReversedClipDoesNotBlockWrites() throws {
+        let (db, video1, _) = try makeFolderDB()
+        try db.write { db in
+            var clip = Clip(videoId: video1, startTime: 60, endTime: 50)
+            XCTAssertNoThrow(try clip.insert(db))
+            XCTAssertTrue(try ClipTimeIndex.isConsistent(db))
+        }
+    }
+
+    func testRebuildRestoresDriftedIndex() throws {
+        let (db, video1, _) = try makeFolderDB()
+        try db.write { db in
+            try db.execute(sql: "DELETE FROM \(ClipTimeIndex.tableName)")
+            XCTAssertFalse(try ClipTimeIndex.isConsistent(db))
+            try ClipTimeIndex.rebuild(db)
+            XCTAssertTrue(try ClipTimeIndex.isConsistent(db))
+            XCTAssertEqual(try ClipTimeIndex.clips(db, videoId: video1, at: 11).count, 2)
+        }
+    }
+
+    // MARK: - 全局库
+
+    func testGlobalIndexFollowsSync() throws {
+        let (folderDB, _, _) = try makeFolderDB()
+        let globalDB = try DatabaseManager.makeGlobalInMemoryDatabase()
+        _ = try SyncEngine.sync(folderPath: "/Volumes/A/素材", folderDB: folderDB, globalDB: globalDB)
+
+        try globalDB.read { db in
+            XCTAssertTrue(try ClipTimeIndex.isConsistent(db))
+            let globalVideo = try XCTUnwrap(Int64.fetchOne(db, sql: "SELECT video_id FROM videos WHERE file_name = 'long.mov'"))
+            XCTAssertEqual(ranges(try ClipTimeIndex.clips(db, videoId: globalVideo, at: 11)), [5...12, 10...20])
+        }
+    }
+}
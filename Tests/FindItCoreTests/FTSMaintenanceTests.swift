@@ -0,0 +1,146 @@
+import XCTest
+import GRDB
+@testable import FindItCore
+
+final class FTSMaintenanceTests: XCTestCase {
+
+    // MARK: - Helper
+
+    /// 关闭 automerge 后逐事务插入，每个事务产生一个 level-0 段
+    private func makeFragmentedDB(segments: Int) throws -> DatabaseQueue {
+        let db = try DatabaseManager.makeGlobalInMemoryDatabase()
+        try db.write { db in
+            try db.execute(sql: "INSERT INTO clips_fts(clips_fts, rank) VALUES('automerge', 0)")
+        }
+        for i in 0..<segments {
+            try db.write { db in
+                try db.execute(sql: """
+                    INSERT INTO clips (source_folder, source_clip_id, start_time, end_time, tags, description)
+                    VALUES ('/test', ?, 0, 5, ?, ?)
+                    """, arguments: [i, "tag\(i)", "海滩 日落 clip \(i)"])
+            }
+        }
+        return db
+    }
+
+    private func segmentCount(_ db: DatabaseQueue) throws -> Int {
+        try db.read { try FTSSegmentStructure.read($0)?.segmentCount ?? 0 }
+    }
+
+    // MARK: - 结构解析
+
+    func testDecodeStructureRecord() throws {
+        // cookie | nLevel=2 | nSegment=3 | nWrite=300
+        // L0: nMerge=0 nSeg=2 (1,1,3) (2,4,4)；L1: nMerge=0 nSeg=1 (3,5,14)
+        let bytes: [UInt8] = [0, 0, 0, 1, 2, 3, 0x82, 0x2C,
+                              0, 2, 1, 1, 3, 2, 4, 4,
+                              0, 1, 3, 5, 14]
+        let structure = try XCTUnwrap(FTSSegmentStructure.decode(Data(bytes)))
+
+        XCTAssertEqual(structure.writeCounter, 300)
+        XCTAssertEqual(structure.levels.map(\.segmentPages), [[3, 1], [10]])
+        XCTAssertEqual(structure.segmentCount, 3)
+        XCTAssertEqual(structure.pageCount, 14)
+        XCTAssertEqual(structure.maxSegmentsPerLevel, 2)
+    }
+
+    func testDecodeV2StructureRecord() throws {
+        // V2 标记后多一个 nOriginCntr，每段多 5 个字段
+        let bytes: [UInt8] = [0, 0, 0, 1, 0xFF, 0x00, 0x00, 0x01, 1, 1, 7, 9,
+                              0, 1, 1, 1, 6, 1, 1, 0, 0, 42]
+        let structure = try XCTUnwrap(FTSSegmentStructure.decode(Data(bytes)))
+        XCTAssertEqual(structure.writeCounter, 7)
+        XCTAssertEqual(structure.levels.map(\.segmentPages), [[6]])
+    }
+
+    func testDecodeTruncatedRecordReturnsNil() {
+        XCTAssertNil(FTSSegmentStructure.decode(Data([0, 0, 0, 1, 2, 3, 5, 0, 2, 1])))
+    }
+
+    func testReadsLiveStructure() throws {
+        let db = try makeFragmentedDB(segments: 5)
+        let structure = try XCTUnwrap(db.read { try FTSSegmentStructure.read($0) })
+        XCTAssertEqual(structure.segmentCount, 5)
+        XCTAssertGreaterThan(structure.writeCounter, 0)
+    }
+
+    // MARK: - 维护
+
+    func testMergesWhenSegmentsExceedThreshold() async throws {
+        let db = try makeFragmentedDB(segments: 12)
+        let maintenance = FTSMaintenance(db: db, mode: .balanced, isConstrained: { false })
+
+        let report = try await maintenance.runOnce()
+
+        guard case .merged(let steps) = report.action else {
+            return XCTFail("期望增量合并，实际 \(report.action)")
+        }
+        XCTAssertGreaterThan(steps, 0)
+        XCTAssertEqual(report.segmentsBefore, 12)
+        XCTAssertLessThan(report.segmentsAfter, 12)
+    }
+
+    func testOptimizesOnceAfterQuiescence() async throws {
+        let db = try makeFragmentedDB(segments: 3)
+        let maintenance = FTSMaintenance(db: db, mode: .balanced, isConstrained: { false })
+        let start = Date()
+
+        let first = try await maintenance.runOnce(now: start)
+        XCTAssertEqual(first.action, .idle, "刚观察到写入，未静默")
+
+        let quiet = try await maintenance.runOnce(now: start.addingTimeInterval(601))
+        XCTAssertEqual(quiet.action, .optimized)
+        XCTAssertEqual(quiet.segmentsAfter, 1)
+
+        let again = try await maintenance.runOnce(now: start.addingTimeInterval(1200))
+        XCTAssertEqual(again.action, .idle)
+
+        // 搜索结果不受影响
+        let results = try db.read { try SearchEngine.search($0, query: "日落") }
+        XCTAssertEqual(results.count, 3)
+    }
+
+    func testSkipsWhenSystemConstrained() async throws {
+        let db = try makeFragmentedDB(segments: 12)
+        let maintenance = FTSMaintenance(db: db, mode: .fullSpeed, isConstrained: { true })
+
+        let report = try await maintenance.runOnce()
+        XCTAssertEqual(report.action, .skipped)
+        XCTAssertEqual(try segmentCount(db), 12)
+    }
+
+    func testForceOptimizeIgnoresConstraints() async throws {
+        let db = try makeFragmentedDB(segments: 4)
+        let maintenance = FTSMaintenance(db: db, isConstrained: { true })
+
+        let report = try await maintenance.runOnce(forceOptimize: true)
+        XCTAssertEqual(report.action, .optimized)
+        XCTAssertEqual(try segmentCount(db), 1)
+    }
+
+    func testAppliesModeConfig() async throws {
+        let db = try makeFragmentedDB(segments: 1)
+        let maintenance = FTSMaintenance(db: db, mode: .background, isConstrained: { false })
+        try await maintenance.runOnce()
+
+        let config = try db.read { db in
+            try Dictionary(uniqueKeysWithValues: Row.fetchAll(db, sql: "SELECT k, v FROM clips_fts_config")
+                .compactMap { row -> (String, Int)? in
+                    guard let key: String = row["k"], let value: Int = row["v"] else { return nil }
+                    return (key, value)
+                })
+        }
+        XCTAssertEqual(config["automerge"], 8)
+        XCTAssertEqual(config["crisismerge"], 24)
+        XCTAssertEqual(config["usermerge"], 2)
+    }
+
+    func testHeavyFragmentationLowersAutomerge() {
+        let base = FTSMaintenance.Policy.standard(for: .balanced)
+        let fragmented = FTSSegmentStructure(
+            writeCounter: 1,
+            levels: [FTSSegmentStructure.Level(merging: 0, segmentPages: Array(repeating: 1, count: 40))]
+        )
+        XCTAssertEqual(FTSMaintenance.effectivePolicy(base, structure: fragmented).automerge, 2)
+    }
+}
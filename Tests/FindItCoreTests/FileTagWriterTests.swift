@@ -0,0 +1,155 @@
+import XCTest
+@testable import FindItCore
+
+final class FileTagWriterTests: XCTestCase {
+
+    private var tempDir: URL!
+
+    override func setUpWithError() throws {
+        tempDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("FileTagWriterTests-\(UUID().uuidString)", isDirectory: true)
+        try FileManager.default.createDirectory(at: tempDir, withIntermediateDirectories: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: tempDir)
+    }
+
+    // MARK: - Helper
+
+    private func makeFile(_ name: String) -> String {
+        let path = tempDir.appendingPathComponent(name).path
+        FileManager.default.createFile(atPath: path, contents: Data("test".utf8))
+        return path
+    }
+
+    /// 内存后端：记录写入次数，可注入前 N 次失败
+    private final class RecordingBackend: FileTagBackend, @unchecked Sendable {
+        private let lock = NSLock()
+        private var storage: [String: [String]] = [:]
+        private(set) var writes: [String] = []
+        var failuresRemaining = 0
+        var failureCode: Int32 = EAGAIN
+
+        func readTags(path: String) throws -> [String] {
+            lock.lock(); defer { lock.unlock() }
+            return storage[path] ?? []
+        }
+
+        func writeTags(_ tags: [String], path: String) throws {
+            lock.lock(); defer { lock.unlock() }
+            if failuresRemaining > 0 {
+                failuresRemaining -= 1
+                throw FileTagError.systemCall("setxattr", errno: failureCode)
+            }
+            storage[path] = tags
+            writes.append(path)
+        }
+
+        func tags(_ path: String) -> [String] {
+            lock.lock(); defer { lock.unlock() }
+            return storage[path] ?? []
+        }
+    }
+
+    // MARK: - xattr 后端
+
+    func testUserXattrBackendRoundTrip() throws {
+        let path = makeFile("clip.mov")
+        let backend = UserXattrTagBackend()
+
+        XCTAssertEqual(try backend.readTags(path: path), [])
+        try backend.writeTags(["B-roll", "Red\n6"], path: path)
+        XCTAssertEqual(try backend.readTags(path: path), ["B-roll", "Red\n6"])
+        try backend.writeTags([], path: path)
+        XCTAssertEqual(try backend.readTags(path: path), [])
+        try backend.writeTags([], path: path)  // 重复移除不报错
+    }
+
+    func testSyncFinderTagWithXattrBackendPreservesCustomTags() throws {
+        let path = makeFile("clip.mov")
+        let backend = UserXattrTagBackend()
+        try backend.writeTags(["Interview"], path: path)
+
+        try ClipLabel.syncFinderTag(filePath: path, label: .red, backend: backend)
+        try ClipLabel.syncFinderTag(filePath: path, label: .blue, backend: backend)
+        XCTAssertEqual(try backend.readTags(path: path), ["Interview", "Blue\n4"])
+
+        try ClipLabel.syncFinderTag(filePath: path, label: nil, backend: backend)
+        XCTAssertEqual(try backend.readTags(path: path), ["Interview"])
+    }
+
+    func testMergedTagsRecognizesBareColorNames() {
+        XCTAssertEqual(ClipLabel.mergedTags(["Red", "B-roll", "Green\n2"], label: .gray), ["B-roll", "Gray\n1"])
+    }
+
+    // MARK: - 写入队列
+
+    func testEnqueueCoalescesToLastWrite() async throws {
+        let backend = RecordingBackend()
+        let writer = FileTagWriter(backend: backend, config: .init(flushDelay: 10))
+        let path = makeFile("a.mov")
+
+        writer.enqueue(path: path, label: .red)
+        writer.enqueue(path: path, label: .green)
+        writer.enqueue(path: path, label: .blue)
+        XCTAssertTrue(backend.writes.isEmpty, "入队立即返回，不同步写入")
+
+        await writer.flush()
+        XCTAssertEqual(backend.writes, [path])
+        XCTAssertEqual(backend.tags(path), ["Blue\n4"])
+        XCTAssertEqual(writer.currentStats.coalesced, 2)
+        XCTAssertEqual(writer.currentStats.written, 1)
+        XCTAssertEqual(writer.pendingCount, 0)
+    }
+
+    func testBackgroundFlushAfterDelay() async throws {
+        let backend = RecordingBackend()
+        let writer = FileTagWriter(backend: backend, config: .init(flushDelay: 0.05))
+        let paths = (0..<20).map { makeFile("\($0).mov") }
+        for path in paths { writer.enqueue(path: path, label: .yellow) }
+
+        for _ in 0..<200 where writer.pendingCount > 0 {
+            try await Task.sleep(nanoseconds: 10_000_000)
+        }
+        XCTAssertEqual(writer.pendingCount, 0)
+        XCTAssertEqual(Set(backend.writes), Set(paths))
+    }
+
+    func testRetriesTransientErrors() async {
+        let backend = RecordingBackend()
+        backend.failuresRemaining = 2
+        let writer = FileTagWriter(backend: backend, config: .init(flushDelay: 0, maxAttempts: 4, retryBackoff: 0.01))
+        let path = makeFile("a.mov")
+
+        writer.enqueue(path: path, label: .purple)
+        await writer.flush()
+
+        XCTAssertEqual(backend.tags(path), ["Purple\n3"])
+        XCTAssertEqual(writer.currentStats.retried, 2)
+        XCTAssertEqual(writer.currentStats.failed, 0)
+    }
+
+    func testPermanentErrorsAreDropped() async {
+        let backend = RecordingBackend()
+        backend.failuresRemaining = 1
+        backend.failureCode = EROFS
+        let writer = FileTagWriter(backend: backend, config: .init(flushDelay: 0))
+
+        writer.enqueue(path: makeFile("a.mov"), label: .red)
+        await writer.flush()
+
+        XCTAssertEqual(writer.currentStats.retried, 0)
+        XCTAssertEqual(writer.currentStats.failed, 1)
+        XCTAssertTrue(backend.writes.isEmpty)
+    }
+
+    func testTransientClassification() {
+        XCTAssertTrue(FileTagWriter.isTransient(FileTagError.systemCall("setxattr", errno: EBUSY)))
+        XCTAssertFalse(FileTagWriter.isTransient(FileTagError.systemCall("setxattr", errno: ENOENT)))
+        let wrapped = NSError(domain: NSCocoaErrorDomain, code: 512, userInfo: [
+            NSUnderlyingErrorKey: NSError(domain: NSPOSIXErrorDomain, code: Int(ETIMEDOUT)),
+        ])
+        XCTAssertTrue(FileTagWriter.isTransient(wrapped))
+    }
+}
@@ -0,0 +1,126 @@
+import XCTest
+import GRDB
+@testable import FindItCore
+
+final class FolderDatabasePoolTests: XCTestCase {
+
+    private var tempDir: URL!
+
+    override func setUpWithError() throws {
+        tempDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("FolderDatabasePoolTests-\(UUID().uuidString)", isDirectory: true)
+        try FileManager.default.createDirectory(at: tempDir, withIntermediateDirectories: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: tempDir)
+    }
+
+    // MARK: - Helper
+
+    private func makeFolder(_ name: String) throws -> String {
+        let url = tempDir.appendingPathComponent(name, isDirectory: true)
+        try FileManager.default.createDirectory(at: url, withIntermediateDirectories: true)
+        return url.path
+    }
+
+    // MARK: - 复用与配置
+
+    func testReusesPoolAndAppliesConfig() throws {
+        let manager = FolderDatabasePool(config: .init(maxOpenPools: 2, cacheBudgetKiB: 12 * 1024, maximumReaderCount: 2))
+        let folder = try makeFolder("a")
+
+        let first = try manager.database(at: folder)
+        let second = try manager.database(at: folder)
+        XCTAssertTrue(first === second, "同一文件夹复用连接池")
+
+        // 12 MiB / (2 池 × 3 连接) = 2 MiB
+        let cacheSize = try first.read { try Int.fetchOne($0, sql: "PRAGMA cache_size") }
+        XCTAssertEqual(cacheSize, -2048)
+
+        let tables = try first.read { try $0.tableExists("transcript_segments") }
+        XCTAssertTrue(tables, "首次打开执行迁移")
+    }
+
+    func testConcurrentOpensShareOnePool() throws {
+        let manager = FolderDatabasePool()
+        let folder = try makeFolder("a")
+        let other = try makeFolder("b")
+
+        let lock = NSLock()
+        var pools: [ObjectIdentifier] = []
+        DispatchQueue.concurrentPerform(iterations: 8) { i in
+            guard let pool = try? manager.database(at: i % 4 == 3 ? other : folder) else { return }
+            lock.lock()
+            if i % 4 != 3 { pools.append(ObjectIdentifier(pool)) }
+            lock.unlock()
+        }
+
+        XCTAssertEqual(pools.count, 6)
+        XCTAssertEqual(Set(pools).count, 1, "同一文件夹的并发打开只建一个池")
+        XCTAssertEqual(manager.openFolderPaths, [folder, other].sorted())
+    }
+
+    func testEvictsLeastRecentlyUsedBeyondLimit() throws {
+        let manager = FolderDatabasePool(config: .init(maxOpenPools: 2))
+        let start = Date()
+        let a = try makeFolder("a"), b = try makeFolder("b"), c = try makeFolder("c")
+
+        _ = try manager.database(at: a, now: start)
+        _ = try manager.database(at: b, now: start.addingTimeInterval(1))
+        _ = try manager.database(at: a, now: start.addingTimeInterval(2))
+        _ = try manager.database(at: c, now: start.addingTimeInterval(3))
+
+        XCTAssertEqual(manager.openFolderPaths, [a, c].sorted())
+    }
+
+    func testClosesIdlePools() throws {
+        let manager = FolderDatabasePool(config: .init(idleTimeout: 60))
+        let start = Date()
+        let a = try makeFolder("a"), b = try makeFolder("b")
+        _ = try manager.database(at: a, now: start)
+        _ = try manager.database(at: b, now: start.addingTimeInterval(50))
+
+        XCTAssertEqual(manager.closeIdle(now: start.addingTimeInterval(70)), 1)
+        XCTAssertEqual(manager.openFolderPaths, [b])
+
+        manager.close(folderPath: b)
+        XCTAssertTrue(manager.openFolderPaths.isEmpty)
+    }
+
+    func testHeldPoolStaysUsableAfterEviction() throws {
+        let manager = FolderDatabasePool()
+        let folder = try makeFolder("a")
+        let pool = try manager.database(at: folder)
+        manager.closeAll()
+
+        try pool.write { db in
+            var folderRecord = WatchedFolder(folderPath: folder)
+            try folderRecord.insert(db)
+        }
+        let reopened = try manager.database(at: folder)
+        XCTAssertFalse(pool === reopened)
+        XCTAssertEqual(try reopened.read { try WatchedFolder.fetchCount($0) }, 1)
+    }
+
+    func testThrowsForMissingFolder() {
+        let manager = FolderDatabasePool()
+        XCTAssertThrowsError(try manager.database(at: tempDir.appendingPathComponent("missing").path))
+        XCTAssertTrue(manager.openFolderPaths.isEmpty)
+    }
+
+    // MARK: - 迁移缓存
+
+    func testMigrationSkippedWhenSchemaVersionMatches() throws {
+        let db = try DatabaseManager.makeRawInMemoryDatabase()
+        XCTAssertTrue(try DatabaseManager.migrateFolderIfNeeded(db))
+        XCTAssertFalse(try DatabaseManager.migrateFolderIfNeeded(db), "版本一致时跳过迁移器")
+
+        let version = try db.read { try Int.fetchOne($0, sql: "PRAGMA user_version") }
+        XCTAssertEqual(version, DatabaseManager.folderSchemaVersion)
+
+        // 旧版本写入的库（无 user_version）仍会走迁移器补齐版本号
+        try db.writeWithoutTransaction { try $0.execute(sql: "PRAGMA user_version = 0") }
+        XCTAssertTrue(try DatabaseManager.migrateFolderIfNeeded(db))
+    }
+}
@@ -0,0 +1,121 @@
+import XCTest
+import CoreGraphics
+import ImageIO
+import UniformTypeIdentifiers
+@testable import FindItCore
+
+final class FrameQualityTests: XCTestCase {
+
+    private var tempDir: URL!
+
+    override func setUpWithError() throws {
+        tempDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("FrameQualityTests-\(UUID().uuidString)")
+        try FileManager.default.createDirectory(at: tempDir, withIntermediateDirectories: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: tempDir)
+    }
+
+    // MARK: - Helper
+
+    /// 按像素函数生成 RGBA 图像
+    private func makeImage(width: Int = 64, height: Int = 64,
+                           _ pixel: (Int, Int) -> (UInt8, UInt8, UInt8)) -> ThumbnailImage {
+        var pixels: [UInt8] = []
+        pixels.reserveCapacity(width * height * 4)
+        for y in 0..<height {
+            for x in 0..<width {
+                let (r, g, b) = pixel(x, y)
+                pixels += [r, g, b, 255]
+            }
+        }
+        return ThumbnailImage(width: width, height: height, pixels: pixels)
+    }
+
+    /// 8px 方格棋盘（清晰边缘）
+    private func checkerboard() -> ThumbnailImage {
+        makeImage { x, y in ((x / 8 + y / 8) % 2 == 0) ? (40, 40, 40) : (210, 210, 210) }
+    }
+
+    /// 水平渐变（无边缘，模拟失焦）
+    private func gradient() -> ThumbnailImage {
+        makeImage { x, _ in let v = UInt8(60 + x * 2); return (v, v, v) }
+    }
+
+    private func writePNG(_ image: ThumbnailImage, name: String) throws -> String {
+        let cgImage = try XCTUnwrap(image.makeCGImage())
+        let url = tempDir.appendingPathComponent(name)
+        let destination = try XCTUnwrap(
+            CGImageDestinationCreateWithURL(url as CFURL, UTType.png.identifier as CFString, 1, nil)
+        )
+        CGImageDestinationAddImage(destination, cgImage, nil)
+        XCTAssertTrue(CGImageDestinationFinalize(destination))
+        return url.path
+    }
+
+    // MARK: - 评分
+
+    func testSharpFrameScoresAboveBlurredFrame() {
+        let sharp = FrameQuality.score(checkerboard())
+        let blurred = FrameQuality.score(gradient())
+        XCTAssertGreaterThan(sharp.sharpness, blurred.sharpness * 10)
+        XCTAssertGreaterThan(sharp.overall, blurred.overall)
+    }
+
+    func testBlackFrameIsPenalized() {
+        let black = FrameQuality.score(makeImage { _, _ in (3, 3, 3) })
+        XCTAssertEqual(black.darkFraction, 1, accuracy: 1e-6)
+        XCTAssertLessThan(black.overall, 0.05)
+        XCTAssertLessThan(black.overall, FrameQuality.score(gradient()).overall)
+    }
+
+    func testExposureFractions() {
+        // 左半过曝、右半正常
+        let score = FrameQuality.score(makeImage { x, _ in x < 32 ? (255, 255, 255) : (120, 120, 120) })
+        XCTAssertEqual(score.brightFraction, 0.5, accuracy: 1e-6)
+        XCTAssertEqual(score.darkFraction, 0, accuracy: 1e-6)
+    }
+
+    func testColorfulness() {
+        let gray = FrameQuality.score(gradient())
+        XCTAssertEqual(gray.colorfulness, 0, accuracy: 1e-3)
+
+        let vivid = FrameQuality.score(makeImage { x, _ in x % 2 == 0 ? (230, 20, 20) : (20, 40, 230) })
+        XCTAssertGreaterThan(vivid.colorfulness, 80)
+    }
+
+    // MARK: - 选帧
+
+    func testSelectBestPicksSharpestFile() throws {
+        let blurred = try writePNG(gradient(), name: "blur.png")
+        let sharp = try writePNG(checkerboard(), name: "sharp.png")
+        let black = try writePNG(makeImage { _, _ in (0, 0, 0) }, name: "black.png")
+
+        XCTAssertEqual(FrameQuality.selectBest(from: [black, blurred, sharp]), sharp)
+        XCTAssertEqual(PipelineManager.selectThumbnail(from: [blurred, sharp]), sharp)
+    }
+
+    func testScoreEncodedDataMatchesFile() throws {
+        let path = try writePNG(checkerboard(), name: "sharp.png")
+        let data = try Data(contentsOf: URL(fileURLWithPath: path))
+        XCTAssertEqual(FrameQuality.score(data: data), FrameQuality.score(path: path))
+        XCTAssertNil(FrameQuality.score(data: Data([0xFF, 0xD8, 0x00])))
+    }
+
+    func testRepresentativeThumbnailsUseExtractionScores() {
+        typealias Frame = KeyframeExtractor.ExtractedFrame
+        let frames = [
+            Frame(sceneIndex: 0, timestamp: 1, filePath: "/t/a.jpg", quality: 0.2),
+            Frame(sceneIndex: 0, timestamp: 2, filePath: "/t/b.jpg", quality: 0.7),
+            Frame(sceneIndex: 1, timestamp: 6, filePath: "/t/c.jpg"),
+            Frame(sceneIndex: 1, timestamp: 7, filePath: "/t/d.jpg"),
+        ]
+        XCTAssertEqual(
+            PipelineManager.representativeThumbnails(frames: frames, sceneCount: 3),
+            ["/t/b.jpg", "/t/c.jpg", nil],
+            "未评分场景取第一帧，无帧场景为 nil"
+        )
+    }
+}
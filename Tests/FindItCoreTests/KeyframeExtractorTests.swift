@@ -254,6 +254,40 @@ final class KeyframeExtractorTests: XCTestCase {
         XCTAssertEqual(args[toIndex + 1], "60.000")
     }
 
+    // MARK: - 内存选帧
+
+    func testPipeArgumentsWriteMJPEGToStdout() {
+        let args = KeyframeExtractor.buildExtractArguments(
+            inputPath: "/v.mp4",
+            timestamp: 5.0,
+            outputPath: KeyframeExtractor.pipeOutput,
+            config: .default
+        )
+        let piped = KeyframeExtractor.pipeArguments(args)
+        XCTAssertEqual(Array(piped.suffix(5)), ["-f", "image2pipe", "-c:v", "mjpeg", "pipe:1"])
+        XCTAssertTrue(piped.contains("-q:v"), "编码质量参数保留")
+
+        let toFile = ["-i", "/v.mp4", "/o.jpg"]
+        XCTAssertEqual(KeyframeExtractor.pipeArguments(toFile), toFile)
+    }
+
+    func testSplitJPEGStream() {
+        let first: [UInt8] = [0xFF, 0xD8, 0x01, 0xFF, 0x00, 0x02, 0xFF, 0xD9]
+        let second: [UInt8] = [0xFF, 0xD8, 0x03, 0xFF, 0xD9]
+        let truncated: [UInt8] = [0xFF, 0xD8, 0x04]
+        let images = KeyframeExtractor.splitJPEGStream(Data(first + second + truncated))
+        XCTAssertEqual(images, [Data(first), Data(second)], "截断的末帧丢弃")
+        XCTAssertTrue(KeyframeExtractor.splitJPEGStream(Data()).isEmpty)
+    }
+
+    func testSelectFramesKeepsBestInTimeOrder() {
+        XCTAssertEqual(KeyframeExtractor.selectFrames(scores: [0.1, 0.9, 0.5], keep: 2), [1, 2])
+        XCTAssertEqual(KeyframeExtractor.selectFrames(scores: [nil, 0.3, nil], keep: 1), [1])
+        XCTAssertEqual(KeyframeExtractor.selectFrames(scores: [nil, nil, nil], keep: 2), [0, 1], "均无法评分时取最早帧")
+        XCTAssertEqual(KeyframeExtractor.selectFrames(scores: [0.4, 0.2], keep: 2), [0, 1])
+        XCTAssertEqual(KeyframeExtractor.selectFrames(scores: [0.4, 0.2], keep: 0), [0], "至少保留一帧")
+    }
+
     // MARK: - Config
 
     func testDefaultConfig() {
@@ -10,7 +10,7 @@ final class MigrationsTests: XCTestCase {
         // Arrange & Act
         let db = try DatabaseManager.makeFolderInMemoryDatabase()
 
-        // Assert: 三张表存在
+        // Assert: 业务表与 clips 时间区间 R*Tree（含其影子表）存在
         let tables = try db.read { db in
             try String.fetchAll(db, sql: """
                 SELECT name FROM sqlite_master
@@ -18,7 +18,50 @@ final class MigrationsTests: XCTestCase {
                 ORDER BY name
                 """)
         }
-        XCTAssertEqual(tables, ["clips", "videos", "watched_folders"])
+        XCTAssertEqual(tables, [
+            "clips", "clips_time_rtree", "clips_time_rtree_node", "clips_time_rtree_parent",
+            "clips_time_rtree_rowid", "file_garbage", "stage_artifacts", "transcript_segments",
+            "videos", "watched_folders",
+        ])
+    }
+
+    func testFolderMigrationStageArtifactsSchema() throws {
+        let db = try DatabaseManager.makeFolderInMemoryDatabase()
+
+        let columns = try db.read { db in
+            try Row.fetchAll(db, sql: "PRAGMA table_info(stage_artifacts)")
+        }
+        XCTAssertEqual(columns.map { $0["name"] as String },
+                       ["video_id", "kind", "unit", "file_hash", "payload", "updated_at_ns"])
+        let primaryKey = columns
+            .filter { ($0["pk"] as Int) > 0 }
+            .sorted { ($0["pk"] as Int) < ($1["pk"] as Int) }
+            .map { $0["name"] as String }
+        XCTAssertEqual(primaryKey, ["video_id", "kind", "unit"])
+
+        // 删除视频级联清除产物
+        let foreignKeys = try db.read { db in
+            try Row.fetchAll(db, sql: "PRAGMA foreign_key_list(stage_artifacts)")
+        }
+        XCTAssertEqual(foreignKeys.map { $0["table"] as String }, ["videos"])
+        XCTAssertEqual(foreignKeys.map { $0["on_delete"] as String }, ["CASCADE"])
+    }
+
+    func testFolderMigrationFileGarbageSchema() throws {
+        let db = try DatabaseManager.makeFolderInMemoryDatabase()
+
+        let columns = try db.read { db in
+            try Row.fetchAll(db, sql: "PRAGMA table_info(file_garbage)")
+        }
+        XCTAssertEqual(columns.map { $0["name"] as String }, ["path", "enqueued_at_ns", "attempts"])
+        XCTAssertEqual(columns.filter { ($0["pk"] as Int) > 0 }.map { $0["name"] as String }, ["path"])
+
+        // 同一路径重复入队只保留一行
+        try db.write { db in
+            try FileGarbageCollector.enqueue(db, paths: ["/tmp/a", "/tmp/a"])
+        }
+        XCTAssertEqual(try db.read(FileGarbageCollector.pendingCount), 1)
+        XCTAssertEqual(try db.read { try Int.fetchOne($0, sql: "SELECT attempts FROM file_garbage") }, 0)
     }
 
     func testFolderMigrationWatchedFoldersColumns() throws {
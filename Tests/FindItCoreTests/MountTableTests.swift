@@ -0,0 +1,107 @@
+import XCTest
+@testable import FindItCore
+
+final class MountTableTests: XCTestCase {
+
+    private let root = MountTable.Mount(
+        mountPoint: "/",
+        volume: VolumeResolver.VolumeInfo(uuid: "ROOT", name: "Macintosh HD")
+    )
+    private let t7 = MountTable.Mount(
+        mountPoint: "/Volumes/T7",
+        volume: VolumeResolver.VolumeInfo(uuid: "T7-UUID", name: "T7", isRemovable: true, isInternal: false)
+    )
+    private let t70 = MountTable.Mount(
+        mountPoint: "/Volumes/T70/",
+        volume: VolumeResolver.VolumeInfo(uuid: "T70-UUID", name: "T70", isRemovable: true, isInternal: false)
+    )
+
+    // MARK: - 最长前缀
+
+    func testMountContainingUsesLongestPrefix() {
+        let table = MountTable(mounts: [root, t7, t70])
+        XCTAssertEqual(table.mount(containing: "/Volumes/T7/项目/a.mov")?.mountPoint, "/Volumes/T7")
+        XCTAssertEqual(table.mount(containing: "/Volumes/T7")?.mountPoint, "/Volumes/T7")
+        XCTAssertEqual(table.mount(containing: "/Volumes/T70/x")?.mountPoint, "/Volumes/T70", "挂载点尾随斜杠已规范化")
+        XCTAssertEqual(table.mount(containing: "/Volumes/T7x/y")?.mountPoint, "/", "目录边界对齐，不做字符串前缀匹配")
+        XCTAssertEqual(table.mount(containing: "/Users/me/")?.mountPoint, "/")
+    }
+
+    func testMountContainingWithoutRoot() {
+        let table = MountTable(mounts: [t7])
+        XCTAssertNil(table.mount(containing: "/Users/me"))
+    }
+
+    // MARK: - UUID 索引
+
+    func testMountPointForUUID() {
+        let table = MountTable(mounts: [root, t7, t70])
+        XCTAssertEqual(table.mountPoint(forVolumeUUID: "T7-UUID"), "/Volumes/T7")
+        XCTAssertNil(table.mountPoint(forVolumeUUID: "MISSING"))
+        XCTAssertNil(table.mountPoint(forVolumeUUID: ""))
+    }
+
+    func testDuplicateUUIDPrefersShortestMountPoint() {
+        let alias = MountTable.Mount(mountPoint: "/System/Volumes/Preboot", volume: root.volume)
+        let table = MountTable(mounts: [alias, root])
+        XCTAssertEqual(table.mountPoint(forVolumeUUID: "ROOT"), "/")
+    }
+
+    // MARK: - 失效与重建
+
+    func testRebuildsOnlyAfterInvalidate() {
+        final class Box: @unchecked Sendable { var mounts: [MountTable.Mount] = [] }
+        let box = Box()
+        box.mounts = [root]
+        let table = MountTable(source: { box.mounts })
+
+        XCTAssertNil(table.mountPoint(forVolumeUUID: "T7-UUID"))
+        XCTAssertEqual(table.mount(containing: "/Volumes/T7/a")?.mountPoint, "/")
+        XCTAssertEqual(table.refreshCount, 1, "多次查询只读取一次挂载表")
+
+        box.mounts = [root, t7]
+        XCTAssertNil(table.mountPoint(forVolumeUUID: "T7-UUID"), "未收到挂载变化前沿用缓存")
+
+        table.invalidate()
+        table.invalidate()
+        XCTAssertEqual(table.mountPoint(forVolumeUUID: "T7-UUID"), "/Volumes/T7")
+        XCTAssertEqual(table.refreshCount, 2, "连续失效只重建一次")
+    }
+
+    func testVolumeInfoCachesRootPaths() {
+        let table = MountTable(mounts: [root, t7])
+        var calls = 0
+        let resolver: (String) -> VolumeResolver.VolumeInfo = { _ in
+            calls += 1
+            return VolumeResolver.VolumeInfo(uuid: "DATA", name: "Data")
+        }
+
+        XCTAssertEqual(table.volumeInfo(forPath: "/Volumes/T7/a", resolveOnRoot: resolver), t7.volume)
+        XCTAssertEqual(calls, 0, "外接卷直接取挂载表")
+
+        XCTAssertEqual(table.volumeInfo(forPath: "/Users/me", resolveOnRoot: resolver)?.uuid, "DATA")
+        XCTAssertEqual(table.volumeInfo(forPath: "/Users/me/", resolveOnRoot: resolver)?.uuid, "DATA")
+        XCTAssertEqual(calls, 1, "根卷路径逐路径解析一次后缓存")
+
+        table.invalidate()
+        _ = table.volumeInfo(forPath: "/Users/me", resolveOnRoot: resolver)
+        XCTAssertEqual(calls, 2, "挂载变化后重新解析")
+    }
+
+    // MARK: - 系统挂载表
+
+    func testSharedTableMatchesResolver() {
+        let mount = MountTable.shared.mount(containing: "/")
+        XCTAssertEqual(mount?.mountPoint, "/", "系统挂载表应包含根卷")
+        if let uuid = VolumeResolver.resolveUncached(path: "/").uuid {
+            XCTAssertNotNil(VolumeResolver.findMountPoint(forVolumeUUID: uuid))
+        }
+    }
+
+    func testPathHelpers() {
+        XCTAssertEqual(MountTable.normalize("/a/b///"), "/a/b")
+        XCTAssertEqual(MountTable.normalize("/"), "/")
+        XCTAssertEqual(MountTable.parent(of: "/a/b"), "/a")
+        XCTAssertEqual(MountTable.parent(of: "/a"), "/")
+    }
+}
@@ -199,6 +199,7 @@ final class OrphanRecoveryTests: XCTestCase {
         )
 
         XCTAssertEqual(result.markedCount, 2)
+        XCTAssertEqual(result.removedGlobalClipIds.count, 3)
         XCTAssertEqual(try folderVideoCount(status: "orphaned"), 2)
         XCTAssertEqual(try globalVideoCount(), 0)
     }
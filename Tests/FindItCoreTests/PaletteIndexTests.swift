@@ -0,0 +1,249 @@
+import XCTest
+import GRDB
+import ImageIO
+import UniformTypeIdentifiers
+@testable import FindItCore
+
+final class PaletteIndexTests: XCTestCase {
+
+    // MARK: - 辅助
+
+    /// 按比例拼接的多色图（每种颜色占若干行）
+    private func stripes(_ colors: [((UInt8, UInt8, UInt8), rows: Int)], width: Int = 8) -> ThumbnailImage {
+        var pixels: [UInt8] = []
+        for (c, rows) in colors {
+            for _ in 0..<rows * width { pixels += [c.0, c.1, c.2, 255] }
+        }
+        return ThumbnailImage(width: width, height: colors.map { $0.rows }.reduce(0, +), pixels: pixels)
+    }
+
+    private func signature(_ colors: [((UInt8, UInt8, UInt8), rows: Int)]) -> ColorSignature {
+        PixelStatistics.analyze(stripes(colors)).colorSignature
+    }
+
+    private let orange: (UInt8, UInt8, UInt8) = (235, 130, 40)
+    private let teal: (UInt8, UInt8, UInt8) = (0, 128, 128)
+    private let gray: (UInt8, UInt8, UInt8) = (128, 128, 128)
+
+    // MARK: - 签名
+
+    func testSignatureIsNormalized() {
+        let sig = signature([(orange, 5), (teal, 3), (gray, 2)])
+        XCTAssertLessThanOrEqual(sig.mass, 255)
+        XCTAssertGreaterThan(sig.mass, 240, "向下取整损失应很小")
+        XCTAssertEqual(sig.intersection(sig), 1, accuracy: 1e-6)
+    }
+
+    func testDataRoundTrip() throws {
+        let sig = signature([(orange, 1), (teal, 1)])
+        XCTAssertEqual(sig.data.count, ColorSignature.binCount)
+        XCTAssertEqual(ColorSignature(data: sig.data), sig)
+        XCTAssertNil(ColorSignature(data: Data([1, 2, 3])))
+    }
+
+    func testNeutralAndChromaticBins() {
+        let grayBins = signature([(gray, 4)]).bins
+        let chromaticMass = (ColorSignature.neutralBins..<ColorSignature.binCount).reduce(0) { $0 + Int(grayBins[$1]) }
+        XCTAssertEqual(chromaticMass, 0, "中性灰只落在中性桶")
+
+        let orangeBins = signature([(orange, 4)]).bins
+        let neutralMass = (0..<ColorSignature.neutralBins).reduce(0) { $0 + Int(orangeBins[$1]) }
+        XCTAssertEqual(neutralMass, 0)
+    }
+
+    func testLightnessBoundaryIsSoftAssigned() {
+        // 同一色相，L* 落在 40 档位边界两侧
+        var below = [Float](repeating: 0, count: ColorSignature.binCount)
+        var above = [Float](repeating: 0, count: ColorSignature.binCount)
+        let hue: Float = 15 * .pi / 180
+        ColorSignature.accumulate(l: 39.5, chroma: 40, hue: hue, weight: 1, into: &below)
+        ColorSignature.accumulate(l: 40.5, chroma: 40, hue: hue, weight: 1, into: &above)
+        XCTAssertGreaterThan(ColorSignature(histogram: below).intersection(ColorSignature(histogram: above)), 0.9)
+
+        var gray = [Float](repeating: 0, count: ColorSignature.binCount)
+        ColorSignature.accumulate(l: 50, chroma: 0, hue: 0, weight: 1, into: &gray)
+        XCTAssertEqual(gray[1], 0.5, accuracy: 1e-6, "中性色同样在相邻 L* 档间分配")
+        XCTAssertEqual(gray[2], 0.5, accuracy: 1e-6)
+
+        // 两端档中心以外全部归入端档
+        XCTAssertEqual(ColorSignature.lightnessShare(0, levels: 5).lower, 0)
+        XCTAssertEqual(ColorSignature.lightnessShare(0, levels: 5).upper, 0)
+        XCTAssertEqual(ColorSignature.lightnessShare(100, levels: 5).lower, 3)
+        XCTAssertEqual(ColorSignature.lightnessShare(100, levels: 5).upper, 1)
+    }
+
+    // MARK: - 调色板解析
+
+    func testPaletteParsing() throws {
+        let byName = try ColorSignature.palette("orange, teal")
+        let byHex = try ColorSignature.palette("#eb8228 #008080")
+        XCTAssertEqual(byName, byHex)
+
+        let weighted = try ColorSignature.palette("orange:3,teal")
+        XCTAssertGreaterThan(weighted.intersection(signature([(orange, 1)])), 0.7)
+
+        XCTAssertThrowsError(try ColorSignature.palette("  ")) { error in
+            guard case PaletteError.empty = error else { return XCTFail("应为 empty，实际: \(error)") }
+        }
+        XCTAssertThrowsError(try ColorSignature.palette("chartreuse-ish")) { error in
+            guard case PaletteError.unknownColor = error else { return XCTFail("应为 unknownColor，实际: \(error)") }
+        }
+        XCTAssertThrowsError(try ColorSignature.palette("red:-1"))
+    }
+
+    func testPaletteMatchesFrameColors() throws {
+        let query = try ColorSignature.palette("orange,teal")
+        let both = signature([(orange, 4), (teal, 4)])
+        let orangeOnly = signature([(orange, 8)])
+        let grayOnly = signature([(gray, 8)])
+
+        XCTAssertGreaterThan(query.intersection(both), 0.8)
+        XCTAssertEqual(query.intersection(orangeOnly), 0.5, accuracy: 0.1)
+        XCTAssertEqual(query.intersection(grayOnly), 0, accuracy: 1e-6)
+    }
+
+    // MARK: - 索引
+
+    func testSearchRanksByCoverage() throws {
+        let index = PaletteIndex(entries: [
+            (1, signature([(gray, 8)]).data),
+            (2, signature([(orange, 8)]).data),
+            (3, signature([(orange, 4), (teal, 4)]).data),
+            (4, Data([0, 1])),   // 损坏的 BLOB 跳过
+        ])
+        XCTAssertEqual(index.count, 3)
+
+        let query = try ColorSignature.palette("orange,teal")
+        let hits = index.search(query, limit: 10)
+        XCTAssertEqual(hits.map(\.clipId), [3, 2], "无重叠的 clip 不返回")
+        XCTAssertGreaterThan(hits[0].score, hits[1].score)
+
+        XCTAssertEqual(index.search(query, limit: 1).map(\.clipId), [3])
+        XCTAssertEqual(index.search(query, limit: 10, minScore: 0.8).map(\.clipId), [3])
+    }
+
+    func testUpsertAndRemove() throws {
+        var index = PaletteIndex()
+        index.upsert(clipId: 1, signature: signature([(orange, 8)]))
+        index.upsert(clipId: 2, signature: signature([(teal, 8)]))
+        index.upsert(clipId: 1, signature: signature([(gray, 8)]))
+        XCTAssertEqual(index.count, 2)
+
+        let query = try ColorSignature.palette("orange")
+        XCTAssertTrue(index.search(query).isEmpty, "替换后不再匹配")
+
+        index.remove(clipIds: [2])
+        XCTAssertEqual(index.count, 1)
+        XCTAssertTrue(index.search(try ColorSignature.palette("teal")).isEmpty)
+    }
+
+    // MARK: - 补算
+
+    func testBackfillFillsMissingSignatures() throws {
+        let dir = FileManager.default.temporaryDirectory.appendingPathComponent("palette-\(UUID().uuidString)")
+        try FileManager.default.createDirectory(at: dir, withIntermediateDirectories: true)
+        defer { try? FileManager.default.removeItem(at: dir) }
+        let thumbURL = dir.appendingPathComponent("0.png")
+        let image = try XCTUnwrap(stripes([(orange, 4), (teal, 4)]).makeCGImage())
+        let destination = try XCTUnwrap(
+            CGImageDestinationCreateWithURL(thumbURL as CFURL, UTType.png.identifier as CFString, 1, nil)
+        )
+        CGImageDestinationAddImage(destination, image, nil)
+        XCTAssertTrue(CGImageDestinationFinalize(destination))
+
+        let folderDB = try DatabaseManager.makeFolderInMemoryDatabase()
+        try folderDB.write { db in
+            var folder = WatchedFolder(folderPath: dir.path)
+            try folder.insert(db)
+            var video = Video(folderId: folder.folderId, filePath: "\(dir.path)/a.mov", fileName: "a.mov")
+            try video.insert(db)
+            var old = Clip(videoId: video.videoId, startTime: 0, endTime: 5, thumbnailPath: thumbURL.path)
+            try old.insert(db)
+            var missing = Clip(videoId: video.videoId, startTime: 5, endTime: 10, thumbnailPath: dir.path + "/gone.png")
+            try missing.insert(db)
+            var signed = Clip(videoId: video.videoId, startTime: 10, endTime: 15, thumbnailPath: thumbURL.path,
+                              colorSignature: signature([(gray, 8)]).data)
+            try signed.insert(db)
+        }
+
+        let result = try PipelineManager.backfillColorSignatures(folderDB: folderDB, batchSize: 2)
+        XCTAssertEqual(result, .init(updated: 1, skipped: 1))
+        let index = try folderDB.read { try PaletteIndex.load($0) }
+        XCTAssertEqual(index.count, 2)
+        let hits = index.search(try ColorSignature.palette("orange teal"), limit: 10)
+        XCTAssertEqual(hits.count, 1, "已有签名默认不重算")
+        XCTAssertGreaterThan(hits.first?.score ?? 0, 0.8)
+
+        let forced = try PipelineManager.backfillColorSignatures(folderDB: folderDB, force: true)
+        XCTAssertEqual(forced, .init(updated: 2, skipped: 1))
+        let reindexed = try folderDB.read { try PaletteIndex.load($0) }
+        XCTAssertEqual(reindexed.search(try ColorSignature.palette("orange teal"), limit: 10).count, 2)
+    }
+
+    // MARK: - 同步 + 检索
+
+    func testPaletteSearchAfterSync() throws {
+        let folderPath = "/Volumes/调色/project"
+        let folderDB = try DatabaseManager.makeFolderInMemoryDatabase()
+        let globalDB = try DatabaseManager.makeGlobalInMemoryDatabase()
+
+        try folderDB.write { db in
+            var folder = WatchedFolder(folderPath: folderPath)
+            try folder.insert(db)
+            var video = Video(folderId: folder.folderId, filePath: "\(folderPath)/a.mov", fileName: "a.mov")
+            try video.insert(db)
+            for (i, sig) in [signature([(orange, 4), (teal, 4)]), signature([(gray, 8)])].enumerated() {
+                var clip = Clip(videoId: video.videoId, startTime: Double(i * 5), endTime: Double(i * 5 + 5),
+                                colorSignature: sig.data)
+                try clip.insert(db)
+            }
+            var unsigned = Clip(videoId: video.videoId, startTime: 10, endTime: 15)
+            try unsigned.insert(db)
+        }
+        _ = try SyncEngine.sync(folderPath: folderPath, folderDB: folderDB, globalDB: globalDB)
+
+        let query = try ColorSignature.palette("orange teal")
+        let results = try globalDB.read { db in
+            try SearchEngine.paletteSearch(db, palette: query, limit: 10)
+        }
+        XCTAssertEqual(results.count, 1)
+        XCTAssertEqual(results.first?.startTime, 0)
+        XCTAssertEqual(results.first?.fileName, "a.mov")
+        XCTAssertGreaterThan(results.first?.similarity ?? 0, 0.8)
+
+        let elsewhere = try globalDB.read { db in
+            try SearchEngine.paletteSearch(db, palette: query, folderPaths: ["/Volumes/其他"], limit: 10)
+        }
+        XCTAssertTrue(elsewhere.isEmpty)
+    }
+
+    func testApplySyncDeltaRefreshesIndex() throws {
+        let db = try DatabaseManager.makeGlobalInMemoryDatabase()
+        let warm = signature([(orange, 4), (teal, 4)])
+        let cold = signature([(gray, 8)])
+        let insert = "INSERT INTO clips (clip_id, source_folder, source_clip_id, start_time, end_time, color_signature) VALUES (?, '/A', ?, 0, 5, ?)"
+        try db.write { db in
+            for (id, sig) in [(Int64(1), warm), (2, cold), (3, warm)] {
+                try db.execute(sql: insert, arguments: [id, id, sig.data])
+            }
+        }
+        var index = try db.read { try PaletteIndex.load($0) }
+        XCTAssertEqual(index.count, 3)
+
+        // 更新签名、清空签名、删除、新增各一
+        try db.write { db in
+            try db.execute(sql: "UPDATE clips SET color_signature = ? WHERE clip_id = 2", arguments: [warm.data])
+            try db.execute(sql: "UPDATE clips SET color_signature = NULL WHERE clip_id = 3")
+            try db.execute(sql: "DELETE FROM clips WHERE clip_id = 1")
+            try db.execute(sql: insert, arguments: [4, 4, warm.data])
+        }
+        let delta = SyncEngine.SyncResult(
+            syncedVideos: 0, syncedClips: 3, addedClipIds: [4], updatedClipIds: [2, 3], removedClipIds: [1]
+        )
+        try db.read { dbConn in try index.applySyncDelta(delta, from: dbConn) }
+
+        XCTAssertEqual(index.count, 2)
+        let query = try ColorSignature.palette("orange teal")
+        XCTAssertEqual(index.search(query, limit: 10).map(\.clipId), [2, 4])
+    }
+}
@@ -0,0 +1,135 @@
+import XCTest
+@testable import FindItCore
+
+final class PixelStatisticsTests: XCTestCase {
+
+    // MARK: - 辅助
+
+    /// 纯色图
+    private func solid(_ r: UInt8, _ g: UInt8, _ b: UInt8, size: Int = 16) -> ThumbnailImage {
+        let pixels = (0..<size * size).flatMap { _ in [r, g, b, 255] }
+        return ThumbnailImage(width: size, height: size, pixels: pixels)
+    }
+
+    /// 上半 / 下半两种颜色
+    private func split(_ top: (UInt8, UInt8, UInt8), _ bottom: (UInt8, UInt8, UInt8), size: Int = 16) -> ThumbnailImage {
+        var pixels: [UInt8] = []
+        for y in 0..<size {
+            let c = y < size / 2 ? top : bottom
+            for _ in 0..<size { pixels += [c.0, c.1, c.2, 255] }
+        }
+        return ThumbnailImage(width: size, height: size, pixels: pixels)
+    }
+
+    // MARK: - 主色
+
+    func testSolidColorIsSingleCluster() {
+        let stats = PixelStatistics.analyze(solid(30, 60, 220))
+        XCTAssertEqual(stats.dominantColors.count, 1)
+        XCTAssertEqual(stats.dominantColors[0].weight, 1, accuracy: 1e-6)
+        XCTAssertEqual(stats.dominantColors[0].name, "blue")
+        XCTAssertEqual(stats.colors, "blue")
+        XCTAssertEqual(stats.contrast, 0, accuracy: 1e-4, "纯色无对比度")
+    }
+
+    func testTwoColorsSplitEvenly() {
+        let stats = PixelStatistics.analyze(split((220, 30, 30), (30, 160, 40)))
+        XCTAssertEqual(stats.dominantColors.count, 2)
+        for color in stats.dominantColors {
+            XCTAssertEqual(color.weight, 0.5, accuracy: 1e-6)
+        }
+        XCTAssertEqual(Set(stats.dominantColors.map(\.name)), ["red", "green"])
+    }
+
+    func testLabOfWhiteAndBlack() {
+        let white = PixelStatistics.analyze(solid(255, 255, 255)).dominantColors[0]
+        XCTAssertEqual(white.l, 100, accuracy: 0.1)
+        XCTAssertEqual(white.a, 0, accuracy: 0.1)
+        XCTAssertEqual(white.b, 0, accuracy: 0.1)
+
+        let black = PixelStatistics.analyze(solid(0, 0, 0)).dominantColors[0]
+        XCTAssertEqual(black.l, 0, accuracy: 0.1)
+    }
+
+    func testDeterministic() {
+        let image = split((200, 120, 40), (20, 40, 90))
+        XCTAssertEqual(PixelStatistics.analyze(image), PixelStatistics.analyze(image))
+    }
+
+    // MARK: - 亮度 / 对比度 / 色温
+
+    func testBrightnessLevels() {
+        XCTAssertEqual(PixelStatistics.analyze(solid(20, 20, 20)).lighting, "very dark")
+        XCTAssertEqual(PixelStatistics.analyze(solid(128, 128, 128)).lighting, "normal")
+        XCTAssertEqual(PixelStatistics.analyze(solid(245, 245, 245)).lighting, "very bright")
+    }
+
+    func testHighContrast() {
+        let stats = PixelStatistics.analyze(split((0, 0, 0), (255, 255, 255)))
+        XCTAssertEqual(stats.brightness, 0.5, accuracy: 0.01)
+        XCTAssertEqual(stats.contrast, 0.5, accuracy: 0.01)
+        XCTAssertEqual(stats.lighting, "normal, high contrast")
+    }
+
+    func testColorTemperature() {
+        let neutral = PixelStatistics.analyze(solid(128, 128, 128))
+        XCTAssertEqual(neutral.colorTemperature, 6500, accuracy: 50, "中性灰 ≈ D65")
+
+        let warm = PixelStatistics.analyze(solid(255, 180, 100))
+        XCTAssertLessThan(warm.colorTemperature, PixelStatistics.warmBelow)
+        XCTAssertTrue(warm.lighting.hasSuffix("warm light"))
+
+        let cool = PixelStatistics.analyze(solid(150, 180, 255))
+        XCTAssertTrue(cool.lighting.hasSuffix("cool light"))
+    }
+
+    func testCombineAveragesFrames() throws {
+        let a = PixelStatistics.analyze(solid(20, 20, 20))
+        let b = PixelStatistics.analyze(solid(230, 230, 230))
+        let combined = try XCTUnwrap(PixelStatistics.combine([a, b]))
+        XCTAssertEqual(combined.brightness, (a.brightness + b.brightness) / 2, accuracy: 1e-6)
+        XCTAssertEqual(combined.dominantColors.map(\.weight), [0.5, 0.5])
+        XCTAssertEqual(Set(combined.dominantColors.map(\.name)), ["black", "white"])
+        XCTAssertNil(PixelStatistics.combine([]))
+    }
+
+    // MARK: - 与视觉模型的分工
+
+    func testPixelFieldsPreferLocalOnMerge() {
+        let local = AnalysisResult(
+            scene: "beach", subjects: [], actions: [], objects: [],
+            mood: nil, shotType: nil, lighting: "bright, warm light", colors: "orange blue",
+            description: nil
+        )
+        let remote = AnalysisResult(
+            scene: "海滩", subjects: [], actions: [], objects: [],
+            mood: nil, shotType: nil, lighting: "柔和", colors: "暖色调",
+            description: nil
+        )
+        let merged = LocalVisionAnalyzer.mergeResults(local: local, remote: remote)
+        XCTAssertEqual(merged.scene, "海滩")
+        XCTAssertEqual(merged.lighting, "bright, warm light", "像素统计值优先")
+        XCTAssertEqual(merged.colors, "orange blue")
+    }
+
+    func testModelFieldsExcludePixelDerived() {
+        let fields = VisionField.modelFields()
+        XCTAssertFalse(fields.contains(.lighting))
+        XCTAssertFalse(fields.contains(.colors))
+        XCTAssertEqual(fields.count, VisionField.allActive.count - 2)
+        XCTAssertEqual(VisionField.modelFields(includePixelDerived: true), VisionField.allActive)
+
+        // 本地像素统计缺失时补回对应字段
+        XCTAssertEqual(VisionField.modelFields(fields) { _ in "x" }, fields)
+        XCTAssertEqual(VisionField.modelFields(fields) { $0 == .colors ? nil : "x" },
+                       VisionField.allActive.filter { $0 != .lighting })
+        XCTAssertEqual(VisionField.modelFields(fields) { _ in nil }, VisionField.allActive)
+        XCTAssertEqual(VisionField.modelFields(VisionField.allActive) { _ in "x" }, VisionField.allActive)
+
+        let schema = VisionField.buildResponseSchema(fields: fields)
+        let properties = schema["properties"] as? [String: Any]
+        XCTAssertNil(properties?["lighting"])
+        XCTAssertNotNil(properties?["scene"])
+        XCTAssertFalse(LocalVLMAnalyzer.analysisPrompt(fields: fields).contains("lighting"))
+    }
+}
@@ -0,0 +1,202 @@
+import XCTest
+import GRDB
+@testable import FindItCore
+
+final class QueryPlannerTests: XCTestCase {
+
+    // MARK: - Helper
+
+    /// 全局库：/A 8 条 "beach"，/B 2 条 "city night"，均带 2 维向量
+    private func makeDB() throws -> DatabaseQueue {
+        let db = try DatabaseManager.makeGlobalInMemoryDatabase()
+        try db.write { dbConn in
+            for i in 0..<10 {
+                let isA = i < 8
+                let vector: [Float] = isA ? [1, 0] : [0, 1]
+                try dbConn.execute(sql: """
+                    INSERT INTO clips (source_folder, source_clip_id, start_time, end_time,
+                                       tags, description, embedding, embedding_model)
+                    VALUES (?, ?, 0, 5, ?, ?, ?, 'test')
+                    """, arguments: [
+                        isA ? "/A" : "/B", i,
+                        isA ? "beach" : "city",
+                        isA ? "sunny beach" : "city night",
+                        EmbeddingUtils.serializeEmbedding(vector),
+                    ])
+            }
+        }
+        return db
+    }
+
+    // MARK: - 解析
+
+    func testParseHandlesOperatorsColumnsAndPrefixes() {
+        let parsed = QueryPlanner.parse(#"tags:Beach sun* NOT rain OR "city night""#)
+
+        XCTAssertEqual(parsed.terms.map(\.text), ["beach", "sun", "rain", "city", "night"])
+        XCTAssertEqual(parsed.terms.map(\.isPrefix), [false, true, false, false, false])
+        XCTAssertEqual(parsed.terms.map(\.isNegated), [false, false, true, false, false])
+        XCTAssertTrue(parsed.hasOr)
+        XCTAssertTrue(parsed.hasPhrase)
+    }
+
+    func testTokenizeFoldsCaseAndDiacritics() {
+        XCTAssertEqual(QueryPlanner.tokenize("Café-Noir 海滩日落"), ["cafe", "noir", "海滩日落"])
+    }
+
+    // MARK: - 统计
+
+    func testStatisticsUseVocabAndFolderCounts() throws {
+        let db = try makeDB()
+        let stats = try db.read { dbConn in
+            try QueryPlanner.statistics(dbConn, query: "beach", folderPaths: ["/B"])
+        }
+
+        XCTAssertEqual(stats.totalClips, 10)
+        XCTAssertEqual(stats.scopeClips, 2)
+        XCTAssertEqual(stats.termFrequencies["beach"], 8)
+        XCTAssertEqual(stats.ftsEstimate, 8)
+        XCTAssertTrue(stats.ftsEstimateIsExact)
+        XCTAssertEqual(stats.ftsEstimateInScope, 2)
+    }
+
+    func testStatisticsCacheReusesCountsUntilInvalidated() throws {
+        let db = try makeDB()
+        let cache = QueryStatisticsCache()
+        let stats: () throws -> QueryStatistics = {
+            try db.read { dbConn in
+                try QueryPlanner.statistics(dbConn, query: "beach", folderPaths: ["/B"], cache: cache)
+            }
+        }
+        XCTAssertEqual(try stats().totalClips, 10)
+        XCTAssertEqual(try stats().scopeClips, 2)
+
+        try db.write { dbConn in
+            try dbConn.execute(sql: """
+                INSERT INTO clips (source_folder, source_clip_id, start_time, end_time, tags)
+                VALUES ('/B', 99, 0, 5, 'city')
+                """)
+        }
+        // 同步前不重新计数（词频仍实时读取 fts5vocab）
+        XCTAssertEqual(try stats().totalClips, 10)
+
+        cache.invalidate()
+        let refreshed = try stats()
+        XCTAssertEqual(refreshed.totalClips, 11)
+        XCTAssertEqual(refreshed.scopeClips, 3)
+    }
+
+    func testPrefixTermSumsVocabRange() throws {
+        let db = try makeDB()
+        let stats = try db.read { dbConn in
+            try QueryPlanner.statistics(dbConn, query: "ci*")
+        }
+        XCTAssertEqual(stats.ftsEstimate, 2)
+        XCTAssertFalse(stats.ftsEstimateIsExact)
+    }
+
+    // MARK: - 规划
+
+    func testUnknownTermSkipsFTS() {
+        let stats = QueryStatistics(totalClips: 1000, termFrequencies: ["zzz": 0], ftsEstimate: 0, vectorStoreCount: 1000)
+        let plan = QueryPlanner.plan(query: "zzz", mode: .hybrid, hasEmbedding: true, statistics: stats, limit: 20)
+
+        XCTAssertFalse(plan.runsFTS)
+        XCTAssertEqual(plan.vectorAccess, .store)
+        XCTAssertEqual(plan.vectorCandidates, 20, "单路不需要 2 倍过取")
+        XCTAssertTrue(plan.explain().hasPrefix("PLAN VECTOR ONLY"))
+    }
+
+    func testFrequentQuotedTermSkipsVector() {
+        let stats = QueryStatistics(totalClips: 1000, ftsEstimate: 300, ftsEstimateIsExact: true, vectorStoreCount: 1000)
+        let plan = QueryPlanner.plan(query: "\"beach\"", mode: .auto, hasEmbedding: true, statistics: stats, limit: 20)
+
+        XCTAssertTrue(plan.runsFTS)
+        XCTAssertFalse(plan.runsVector)
+        XCTAssertEqual(plan.ftsLimit, 20)
+    }
+
+    func testSelectiveFilterPrefiltersWithoutOverfetch() {
+        let stats = QueryStatistics(totalClips: 100_000, scopeClips: 500, ftsEstimate: 50, vectorStoreCount: 100_000)
+        let plan = QueryPlanner.plan(query: "beach", mode: .auto, hasEmbedding: true, statistics: stats, limit: 50)
+
+        XCTAssertEqual(plan.filterPlacement, .prefilter)
+        XCTAssertEqual(plan.vectorCandidates, 100)
+    }
+
+    func testBroadFilterPostfiltersWithInflatedTopK() {
+        let stats = QueryStatistics(totalClips: 100_000, scopeClips: 80_000, ftsEstimate: 50, vectorStoreCount: 100_000)
+        let plan = QueryPlanner.plan(query: "beach", mode: .auto, hasEmbedding: true, statistics: stats, limit: 50)
+
+        XCTAssertEqual(plan.filterPlacement, .postfilter)
+        // 100 / 0.8 × 1.2 ≈ 150（浮点误差可能向上取整到 151）
+        XCTAssertTrue((150...151).contains(plan.vectorCandidates))
+    }
+
+    func testUnloadedStoreScans() {
+        let stats = QueryStatistics(totalClips: 100, ftsEstimate: 5)
+        let plan = QueryPlanner.plan(query: "beach", mode: .hybrid, hasEmbedding: true, statistics: stats, limit: 10)
+        XCTAssertEqual(plan.vectorAccess, .scan)
+    }
+
+    func testEmptyScopeRunsNothing() {
+        let stats = QueryStatistics(totalClips: 100, scopeClips: 0, ftsEstimate: 5, vectorStoreCount: 100)
+        let plan = QueryPlanner.plan(query: "beach", mode: .auto, hasEmbedding: true, statistics: stats, limit: 10)
+        XCTAssertFalse(plan.runsFTS)
+        XCTAssertFalse(plan.runsVector)
+    }
+
+    // MARK: - 执行
+
+    func testPlannedSearchMatchesHeuristicSearch() throws {
+        let db = try makeDB()
+        let embedding: [Float] = [0.9, 0.1]
+
+        let (planned, heuristic) = try db.read { dbConn in
+            let stats = try QueryPlanner.statistics(dbConn, query: "beach")
+            let plan = QueryPlanner.plan(query: "beach", mode: .hybrid, hasEmbedding: true, statistics: stats, limit: 5)
+            let planned = try SearchEngine.hybridSearch(
+                dbConn, query: "beach", queryEmbedding: embedding, embeddingModel: "test",
+                mode: .hybrid, plan: plan, limit: 5
+            )
+            let heuristic = try SearchEngine.hybridSearch(
+                dbConn, query: "beach", queryEmbedding: embedding, embeddingModel: "test",
+                mode: .hybrid, limit: 5
+            )
+            return (planned, heuristic)
+        }
+        XCTAssertEqual(planned.map(\.clipId), heuristic.map(\.clipId))
+    }
+
+    func testPlannedPostfilterDropsOutOfScopeResults() throws {
+        let db = try makeDB()
+        let stats = QueryStatistics(totalClips: 10, scopeClips: 8, ftsEstimate: 0, vectorStoreCount: 10)
+        let plan = QueryPlanner.plan(query: "ocean", mode: .hybrid, hasEmbedding: true, statistics: stats, limit: 3)
+        XCTAssertEqual(plan.filterPlacement, .postfilter)
+
+        let ids = try db.read { dbConn in
+            try Int64.fetchAll(dbConn, sql: "SELECT clip_id FROM clips ORDER BY clip_id")
+        }
+        // 全库 top-K：/B 的两条相似度最高，应在补全时剔除
+        let storeResults: [(clipId: Int64, similarity: Float)] =
+            [(ids[8], 0.99), (ids[9], 0.98)] + ids[0..<8].enumerated().map { ($1, 0.9 - Float($0) * 0.01) }
+        let results = try db.read { dbConn in
+            try SearchEngine.hybridSearch(
+                dbConn, query: "ocean", queryEmbedding: [0, 1], embeddingModel: "test",
+                vectorStoreResults: storeResults, mode: .hybrid, plan: plan,
+                folderPaths: ["/A"], limit: 3
+            )
+        }
+        XCTAssertEqual(results.map(\.clipId), Array(ids[0..<3]))
+    }
+
+    func testMissingEmbeddingFallsBackToFTS() throws {
+        let db = try makeDB()
+        let results = try db.read { dbConn in
+            let stats = try QueryPlanner.statistics(dbConn, query: "city")
+            let plan = QueryPlanner.plan(query: "city", mode: .hybrid, hasEmbedding: true, statistics: stats, limit: 5)
+            return try SearchEngine.hybridSearch(dbConn, query: "city", mode: .hybrid, plan: plan, limit: 5)
+        }
+        XCTAssertEqual(results.count, 2)
+    }
+}
@@ -0,0 +1,134 @@
+import XCTest
+import GRDB
+@testable import FindItCore
+
+final class ResultDiversifierTests: XCTestCase {
+
+    // MARK: - 分组
+
+    func testCopyKeysCollapseRegardlessOfVectors() {
+        let groups = ResultDiversifier.group(
+            copyKeys: ["h1#0-50", "h2#0-50", "h1#0-50", nil],
+            vectors: [nil, nil, nil, nil],
+            threshold: 0.97
+        )
+        XCTAssertEqual(groups, [[0, 2], [1], [3]])
+    }
+
+    func testNearIdenticalVectorsCollapseToRepresentative() {
+        let a: [Float] = [1, 0, 0]
+        let aPrime: [Float] = [0.99, 0.05, 0]
+        let b: [Float] = [0, 1, 0]
+        // 与 a 不够近、与 a' 很近：只与代表 a 比较，不会被串入
+        let drift: [Float] = [0.9, 0.44, 0]
+        let groups = ResultDiversifier.group(
+            copyKeys: [nil, nil, nil, nil],
+            vectors: [a, b, aPrime, drift],
+            threshold: 0.97
+        )
+        XCTAssertEqual(groups, [[0, 2], [1], [3]])
+    }
+
+    func testMissingOrMismatchedVectorsStayDistinct() {
+        let groups = ResultDiversifier.group(
+            copyKeys: [nil, nil, nil],
+            vectors: [[1, 0], nil, [1, 0, 0]],
+            threshold: 0.5
+        )
+        XCTAssertEqual(groups, [[0], [1], [2]])
+    }
+
+    func testGramMatrixIsCosine() throws {
+        let gram = try XCTUnwrap(ResultDiversifier.gramMatrix([[3, 4], nil, [4, 3]]))
+        XCTAssertEqual(gram.valid, [true, false, true])
+        XCTAssertEqual(gram.matrix[0 * 3 + 0], 1, accuracy: 1e-5)
+        XCTAssertEqual(gram.matrix[0 * 3 + 2], 24.0 / 25.0, accuracy: 1e-5)
+        XCTAssertEqual(gram.matrix[2 * 3 + 0], 24.0 / 25.0, accuracy: 1e-5)
+        XCTAssertNil(ResultDiversifier.gramMatrix([[1, 0], nil]), "不足两个有效向量")
+    }
+
+    func testCopyKeyToleratesRounding() {
+        XCTAssertEqual(
+            ResultDiversifier.copyKey(fileHash: "abc", startTime: 1.0, endTime: 5.0),
+            ResultDiversifier.copyKey(fileHash: "abc", startTime: 1.0000001, endTime: 4.9999999)
+        )
+        XCTAssertNil(ResultDiversifier.copyKey(fileHash: nil, startTime: 0, endTime: 1))
+        XCTAssertNil(ResultDiversifier.copyKey(fileHash: "", startTime: 0, endTime: 1))
+    }
+
+    // MARK: - 同步 + 检索
+
+    /// 两块盘上的同一素材 + 同一文件夹内两条近似 take
+    private func makeLibrary() throws -> DatabaseQueue {
+        let globalDB = try DatabaseManager.makeGlobalInMemoryDatabase()
+        let model = TinyImageDescriptor().name
+        let take: [Float] = [1, 0, 0, 0]
+        let retake: [Float] = [0.995, 0.1, 0, 0]
+        let other: [Float] = [0, 0, 1, 0]
+
+        for (folderPath, clips) in [
+            ("/Volumes/A/素材", [("海滩 日落", take, 0.0), ("海滩 冲浪", other, 10.0)]),
+            ("/Volumes/B/素材", [("海滩 日落", take, 0.0), ("海滩 日落 重拍", retake, 20.0)]),
+        ] {
+            let folderDB = try DatabaseManager.makeFolderInMemoryDatabase()
+            try folderDB.write { db in
+                var folder = WatchedFolder(folderPath: folderPath)
+                try folder.insert(db)
+                var video = Video(folderId: folder.folderId, filePath: "\(folderPath)/a.mov",
+                                  fileName: "a.mov", fileHash: "hash-a")
+                try video.insert(db)
+                for (tags, vector, start) in clips {
+                    var clip = Clip(
+                        videoId: video.videoId, startTime: start, endTime: start + 5, tags: tags,
+                        visualEmbedding: EmbeddingUtils.serializeEmbedding(vector), visualModel: model
+                    )
+                    try clip.insert(db)
+                }
+            }
+            _ = try SyncEngine.sync(folderPath: folderPath, folderDB: folderDB, globalDB: globalDB)
+        }
+        return globalDB
+    }
+
+    func testHybridSearchCollapsesCopiesAndTakes() throws {
+        let globalDB = try makeLibrary()
+        let (plain, deduped) = try globalDB.read { db in
+            (
+                try SearchEngine.hybridSearch(db, query: "海滩", mode: .fts, limit: 10),
+                try SearchEngine.hybridSearch(db, query: "海滩", mode: .fts, limit: 10, diversify: .default)
+            )
+        }
+        XCTAssertEqual(plain.count, 4)
+        XCTAssertTrue(plain.allSatisfy { $0.duplicateClipIds == nil }, "未开启时不改变结果")
+
+        XCTAssertEqual(deduped.count, 2, "副本 + 重拍折叠为一组，冲浪单独一组")
+        XCTAssertEqual(deduped.map(\.groupSize).sorted(), [1, 3])
+        let collapsed = Set(deduped.flatMap { [$0.clipId] + ($0.duplicateClipIds ?? []) })
+        XCTAssertEqual(collapsed, Set(plain.map(\.clipId)), "每条结果恰好归入一组")
+
+        // 代表为组内排名最高者
+        let rankOf = Dictionary(uniqueKeysWithValues: plain.enumerated().map { ($1.clipId, $0) })
+        for result in deduped {
+            for duplicate in result.duplicateClipIds ?? [] {
+                XCTAssertLessThan(rankOf[result.clipId]!, rankOf[duplicate]!)
+            }
+        }
+    }
+
+    func testDedupStillFillsLimit() throws {
+        let globalDB = try makeLibrary()
+        let results = try globalDB.read { db in
+            try SearchEngine.hybridSearch(db, query: "海滩", mode: .fts, limit: 2, diversify: .default)
+        }
+        XCTAssertEqual(results.count, 2, "候选放大后折叠，仍填满 limit")
+    }
+
+    func testThresholdOneKeepsTakesApart() throws {
+        let globalDB = try makeLibrary()
+        let strict = ResultDiversifier.Options(similarityThreshold: 1.01)
+        let results = try globalDB.read { db in
+            try SearchEngine.hybridSearch(db, query: "海滩", mode: .fts, limit: 10, diversify: strict)
+        }
+        XCTAssertEqual(results.count, 3, "只折叠 file_hash 副本")
+    }
+}
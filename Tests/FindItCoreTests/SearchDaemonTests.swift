@@ -0,0 +1,254 @@
+import XCTest
+import GRDB
+@testable import FindItCore
+
+final class SearchDaemonTests: XCTestCase {
+
+    // MARK: - Helper
+
+    private func makeDB() throws -> DatabaseQueue {
+        let db = try DatabaseManager.makeGlobalInMemoryDatabase()
+        try db.write { dbConn in
+            try dbConn.execute(sql: """
+                INSERT INTO clips (source_folder, source_clip_id, start_time, end_time, scene, tags)
+                VALUES ('/A', 1, 0, 5, '海滩日落', 'beach,sunset'),
+                       ('/B', 2, 0, 5, '城市夜景', 'city,night')
+                """)
+        }
+        return db
+    }
+
+    /// 短路径 socket（sun_path 上限约 104 字节）
+    private func makeSocketPath() -> String {
+        "/tmp/findit-test-\(UUID().uuidString.prefix(8)).sock"
+    }
+
+    // MARK: - 请求处理
+
+    func testPingAndStats() async throws {
+        let daemon = SearchDaemon(db: try makeDB(), provider: nil)
+
+        let ping = await daemon.handle(SearchDaemonRequest(id: 7, op: .ping))
+        XCTAssertTrue(ping.ok)
+        XCTAssertEqual(ping.id, 7)
+
+        let stats = await daemon.handle(SearchDaemonRequest(id: 8, op: .stats))
+        XCTAssertEqual(stats.stats?.requests, 2)
+        XCTAssertNil(stats.stats?.embeddingModel)
+    }
+
+    func testFTSSearchWithoutProvider() async throws {
+        let daemon = SearchDaemon(db: try makeDB(), provider: nil)
+
+        let response = await daemon.handle(SearchDaemonRequest(id: 1, op: .search, query: "beach", mode: .fts))
+
+        XCTAssertTrue(response.ok)
+        XCTAssertEqual(response.results?.map(\.sourceFolder), ["/A"])
+        XCTAssertNil(response.embeddingModel)
+        XCTAssertNotNil(response.elapsedMs)
+    }
+
+    func testFolderFilterIsApplied() async throws {
+        let daemon = SearchDaemon(db: try makeDB(), provider: nil)
+
+        let response = await daemon.handle(SearchDaemonRequest(
+            id: 1, op: .search, query: "beach", mode: .fts, folders: ["/B"]
+        ))
+
+        XCTAssertTrue(response.ok)
+        XCTAssertEqual(response.results?.count, 0)
+    }
+
+    func testPaletteSearchUsesResidentIndex() async throws {
+        let db = try makeDB()
+        let warm = try ColorSignature.palette("orange teal")
+        try db.write { dbConn in
+            try dbConn.execute(sql: "UPDATE clips SET color_signature = ? WHERE source_clip_id = 1", arguments: [warm.data])
+        }
+        let daemon = SearchDaemon(db: db, provider: nil)
+
+        let first = await daemon.handle(SearchDaemonRequest(id: 1, op: .palette, palette: "orange teal"))
+        XCTAssertTrue(first.ok)
+        XCTAssertEqual(first.results?.map(\.sourceFolder), ["/A"])
+
+        // 同进程同步：按增量刷新常驻索引，不重新加载
+        let added = try db.write { dbConn -> Int64 in
+            try dbConn.execute(sql: """
+                INSERT INTO clips (source_folder, source_clip_id, start_time, end_time, color_signature)
+                VALUES ('/B', 3, 0, 5, ?)
+                """, arguments: [warm.data])
+            return dbConn.lastInsertedRowID
+        }
+        await daemon.applySyncDelta(SyncEngine.SyncResult(syncedVideos: 0, syncedClips: 1, addedClipIds: [added]))
+        let second = await daemon.handle(SearchDaemonRequest(
+            id: 2, op: .palette, folders: ["/B"], palette: "orange teal"
+        ))
+        XCTAssertEqual(second.results?.map(\.sourceClipId), [3])
+
+        let stats = await daemon.handle(SearchDaemonRequest(id: 3, op: .stats))
+        XCTAssertEqual(stats.stats?.paletteCount, 2)
+
+        let missing = await daemon.handle(SearchDaemonRequest(id: 4, op: .palette))
+        XCTAssertFalse(missing.ok)
+    }
+
+    func testSimilarUsesResidentVisualStore() async throws {
+        let db = try makeDB()
+        let extractor = TinyImageDescriptor()
+        func visual(_ x: Float, _ y: Float) -> Data {
+            var vector = [Float](repeating: 0, count: extractor.dimensions)
+            vector[0] = x
+            vector[1] = y
+            return EmbeddingUtils.serializeEmbedding(vector)
+        }
+        let third = try db.write { dbConn -> Int64 in
+            try dbConn.execute(sql: "UPDATE clips SET visual_embedding = ?, visual_model = ? WHERE source_clip_id = 1",
+                               arguments: [visual(1, 0), extractor.name])
+            try dbConn.execute(sql: "UPDATE clips SET visual_embedding = ?, visual_model = ? WHERE source_clip_id = 2",
+                               arguments: [visual(0.9, 0.1), extractor.name])
+            try dbConn.execute(sql: """
+                INSERT INTO clips (source_folder, source_clip_id, start_time, end_time, visual_embedding, visual_model)
+                VALUES ('/A', 3, 5, 10, ?, ?)
+                """, arguments: [visual(0, 1), extractor.name])
+            return dbConn.lastInsertedRowID
+        }
+        let target = try await db.read { dbConn in
+            try XCTUnwrap(Int64.fetchOne(dbConn, sql: "SELECT clip_id FROM clips WHERE source_clip_id = 1"))
+        }
+        let daemon = SearchDaemon(db: db, provider: nil)
+
+        let all = await daemon.handle(SearchDaemonRequest(id: 1, op: .similar, clipId: target))
+        XCTAssertTrue(all.ok)
+        XCTAssertEqual(all.results?.map(\.sourceClipId), [2, 3])
+
+        let scoped = await daemon.handle(SearchDaemonRequest(id: 2, op: .similar, folders: ["/A"], clipId: target))
+        XCTAssertEqual(scoped.results?.map(\.clipId), [third])
+
+        // 同进程同步：按增量刷新常驻 store，不重新加载
+        let added = try db.write { dbConn -> Int64 in
+            try dbConn.execute(sql: """
+                INSERT INTO clips (source_folder, source_clip_id, start_time, end_time, visual_embedding, visual_model)
+                VALUES ('/A', 4, 10, 15, ?, ?)
+                """, arguments: [visual(0.95, 0.05), extractor.name])
+            return dbConn.lastInsertedRowID
+        }
+        await daemon.applySyncDelta(SyncEngine.SyncResult(syncedVideos: 0, syncedClips: 1, addedClipIds: [added]))
+        let refreshed = await daemon.handle(SearchDaemonRequest(
+            id: 3, op: .similar, limit: 1, folders: ["/A"], clipId: target
+        ))
+        XCTAssertEqual(refreshed.results?.map(\.sourceClipId), [4])
+
+        let stats = await daemon.handle(SearchDaemonRequest(id: 4, op: .stats))
+        XCTAssertEqual(stats.stats?.visualCount, 4)
+
+        let missing = await daemon.handle(SearchDaemonRequest(id: 5, op: .similar, clipId: 9999))
+        XCTAssertFalse(missing.ok)
+        let noTarget = await daemon.handle(SearchDaemonRequest(id: 6, op: .similar))
+        XCTAssertFalse(noTarget.ok)
+    }
+
+    func testMalformedLineReturnsError() async throws {
+        let daemon = SearchDaemon(db: try makeDB(), provider: nil)
+
+        let data = await daemon.handle(line: Data("not json".utf8))
+        let response = try JSONDecoder().decode(SearchDaemonResponse.self, from: data)
+
+        XCTAssertFalse(response.ok)
+        XCTAssertNotNil(response.error)
+    }
+
+    // MARK: - Socket
+
+    func testSocketRoundTrip() async throws {
+        let socketPath = makeSocketPath()
+        let daemon = SearchDaemon(db: try makeDB(), provider: nil)
+        let server = SearchDaemonServer(socketPath: socketPath, daemon: daemon)
+        try server.start()
+        defer { server.stop() }
+
+        let response = try await Task.detached {
+            let client = try SearchDaemonClient(socketPath: socketPath)
+            _ = try client.send(SearchDaemonRequest(id: 0, op: .ping))
+            return try client.send(SearchDaemonRequest(id: 0, op: .search, query: "night", mode: .fts))
+        }.value
+
+        XCTAssertTrue(response.ok)
+        XCTAssertEqual(response.id, 2, "同一连接上的请求 ID 应递增")
+        XCTAssertEqual(response.results?.first?.sourceFolder, "/B")
+    }
+
+    func testClientFailsWhenDaemonNotRunning() {
+        XCTAssertThrowsError(try SearchDaemonClient(socketPath: makeSocketPath())) { error in
+            guard case SearchDaemonSocketError.notRunning = error else {
+                return XCTFail("期望 notRunning，实际 \(error)")
+            }
+        }
+    }
+
+    func testSecondServerDoesNotStealLiveSocket() async throws {
+        let socketPath = makeSocketPath()
+        let daemon = SearchDaemon(db: try makeDB(), provider: nil)
+        let server = SearchDaemonServer(socketPath: socketPath, daemon: daemon)
+        try server.start()
+        defer { server.stop() }
+
+        let attrs = try FileManager.default.attributesOfItem(atPath: socketPath)
+        XCTAssertEqual((attrs[.posixPermissions] as? NSNumber)?.intValue, 0o600)
+
+        let second = SearchDaemonServer(socketPath: socketPath, daemon: daemon)
+        XCTAssertThrowsError(try second.start()) { error in
+            guard case SearchDaemonSocketError.alreadyRunning = error else {
+                return XCTFail("期望 alreadyRunning，实际 \(error)")
+            }
+        }
+
+        let response = try await Task.detached {
+            try SearchDaemonClient(socketPath: socketPath).send(SearchDaemonRequest(id: 0, op: .ping))
+        }.value
+        XCTAssertTrue(response.ok, "原守护进程仍可连接")
+    }
+
+    func testStaleSocketFileIsReplaced() throws {
+        let socketPath = makeSocketPath()
+        // 绑定后不监听即关闭：模拟异常退出残留的 socket 文件
+        let fd = try SearchDaemonSocket.makeSocket()
+        var addr = try SearchDaemonSocket.address(for: socketPath)
+        let bound = withUnsafePointer(to: &addr) {
+            $0.withMemoryRebound(to: sockaddr.self, capacity: 1) {
+                bind(fd, $0, socklen_t(MemoryLayout<sockaddr_un>.size))
+            }
+        }
+        XCTAssertEqual(bound, 0)
+        close(fd)
+
+        let server = SearchDaemonServer(socketPath: socketPath, daemon: SearchDaemon(db: try makeDB(), provider: nil))
+        XCTAssertNoThrow(try server.start())
+        server.stop()
+    }
+
+    func testOversizedRequestLineClosesConnection() async throws {
+        let socketPath = makeSocketPath()
+        let server = SearchDaemonServer(socketPath: socketPath, daemon: SearchDaemon(db: try makeDB(), provider: nil))
+        try server.start()
+        defer { server.stop() }
+
+        let closed = try await Task.detached { () -> Bool in
+            let fd = try SearchDaemonSocket.makeSocket()
+            defer { close(fd) }
+            var addr = try SearchDaemonSocket.address(for: socketPath)
+            let connected = withUnsafePointer(to: &addr) {
+                $0.withMemoryRebound(to: sockaddr.self, capacity: 1) {
+                    connect(fd, $0, socklen_t(MemoryLayout<sockaddr_un>.size))
+                }
+            }
+            guard connected == 0 else { return false }
+            SearchDaemonSocket.disableSigpipe(fd)
+            // 超过上限且没有换行：服务端应断开而不是继续缓冲
+            let payload = Data(repeating: 0x61, count: SearchDaemonSocket.maxRequestLength + 64 * 1024)
+            _ = payload.withUnsafeBytes { write(fd, $0.baseAddress!, $0.count) }
+            var byte: UInt8 = 0
+            return read(fd, &byte, 1) <= 0
+        }.value
+        XCTAssertTrue(closed)
+    }
+}
@@ -0,0 +1,142 @@
+import XCTest
+@testable import FindItCore
+
+final class SpeculativeQueryEmbedderTests: XCTestCase {
+
+    // MARK: - Helper
+
+    /// 计数的 mock provider（可选延迟，模拟远程嵌入耗时）
+    private final class CountingProvider: EmbeddingProvider, @unchecked Sendable {
+        let name = "mock"
+        let dimensions = 3
+        let delay: Duration
+        private let lock = NSLock()
+        private var _calls: [String] = []
+
+        init(delay: Duration = .zero) {
+            self.delay = delay
+        }
+
+        var calls: [String] {
+            lock.lock(); defer { lock.unlock() }
+            return _calls
+        }
+
+        func isAvailable() -> Bool { true }
+
+        func embed(text: String) async throws -> [Float] {
+            lock.lock(); _calls.append(text); lock.unlock()
+            if delay > .zero {
+                try await Task.sleep(for: delay)
+            }
+            return [Float(text.count), 1, 0]
+        }
+    }
+
+    // MARK: - Tests
+
+    func testPrefetchThenEmbeddingReusesInFlightTask() async throws {
+        let provider = CountingProvider(delay: .milliseconds(50))
+        let embedder = SpeculativeQueryEmbedder(provider: provider)
+
+        await embedder.prefetch("sunset")
+        let vector = try await embedder.embedding(for: "sunset")
+
+        XCTAssertEqual(vector, [6, 1, 0])
+        XCTAssertEqual(provider.calls, ["sunset"], "推测任务应被复用，不重复调用模型")
+        let stats = await embedder.stats
+        XCTAssertEqual(stats.inFlightHits, 1)
+        XCTAssertEqual(stats.misses, 0)
+    }
+
+    func testCachedPrefixHitsWithoutModelCall() async throws {
+        let provider = CountingProvider()
+        let embedder = SpeculativeQueryEmbedder(provider: provider)
+
+        _ = try await embedder.embedding(for: "beach")
+        _ = try await embedder.embedding(for: "  beach ")
+
+        XCTAssertEqual(provider.calls, ["beach"])
+        let stats = await embedder.stats
+        XCTAssertEqual(stats.cacheHits, 1)
+    }
+
+    func testNewPrefixCancelsStaleSpeculation() async throws {
+        let provider = CountingProvider(delay: .milliseconds(200))
+        let embedder = SpeculativeQueryEmbedder(provider: provider)
+
+        await embedder.prefetch("bea")
+        await embedder.prefetch("beach")
+        _ = try await embedder.embedding(for: "beach")
+
+        let stats = await embedder.stats
+        XCTAssertEqual(stats.cancelled, 1, "旧前缀的推测任务应被取消")
+        let staleCached = await embedder.isCached("bea")
+        XCTAssertFalse(staleCached)
+    }
+
+    func testCacheEvictsLeastRecentlyUsed() async throws {
+        let provider = CountingProvider()
+        let embedder = SpeculativeQueryEmbedder(provider: provider, capacity: 2)
+
+        _ = try await embedder.embedding(for: "a")
+        _ = try await embedder.embedding(for: "b")
+        _ = try await embedder.embedding(for: "a") // a 变为最近使用
+        _ = try await embedder.embedding(for: "c") // 淘汰 b
+
+        let hasA = await embedder.isCached("a")
+        let hasB = await embedder.isCached("b")
+        let hasC = await embedder.isCached("c")
+        XCTAssertTrue(hasA)
+        XCTAssertFalse(hasB)
+        XCTAssertTrue(hasC)
+    }
+
+    func testEmptyPrefetchIsIgnored() async {
+        let provider = CountingProvider()
+        let embedder = SpeculativeQueryEmbedder(provider: provider)
+
+        await embedder.prefetch("   ")
+        XCTAssertTrue(provider.calls.isEmpty)
+    }
+
+    func testShortPrefetchIsIgnored() async throws {
+        let provider = CountingProvider()
+        let embedder = SpeculativeQueryEmbedder(provider: provider, idleInterval: .zero)
+
+        await embedder.prefetch("a")
+        try await Task.sleep(for: .milliseconds(50))
+        XCTAssertTrue(provider.calls.isEmpty, "过短的输入不推测")
+
+        // 显式查询不受最短长度限制
+        _ = try await embedder.embedding(for: "a")
+        XCTAssertEqual(provider.calls, ["a"])
+    }
+
+    func testTypingBurstSendsOneRequestAfterIdle() async throws {
+        let provider = CountingProvider()
+        let embedder = SpeculativeQueryEmbedder(provider: provider, idleInterval: .milliseconds(100))
+
+        for prefix in ["su", "sun", "suns", "sunse", "sunset"] {
+            await embedder.prefetch(prefix)
+        }
+        XCTAssertTrue(provider.calls.isEmpty, "停顿前不调用模型")
+
+        try await Task.sleep(for: .milliseconds(300))
+        XCTAssertEqual(provider.calls, ["sunset"], "连续输入只发出最后一个请求")
+        let cached = await embedder.isCached("sunset")
+        XCTAssertTrue(cached)
+        let stats = await embedder.stats
+        XCTAssertEqual(stats.cancelled, 4)
+    }
+
+    func testCancelledPendingRequestNeverReachesModel() async throws {
+        let provider = CountingProvider()
+        let embedder = SpeculativeQueryEmbedder(provider: provider, idleInterval: .milliseconds(50))
+
+        await embedder.prefetch("beach")
+        await embedder.cancelPending()
+        try await Task.sleep(for: .milliseconds(150))
+        XCTAssertTrue(provider.calls.isEmpty)
+    }
+}
@@ -0,0 +1,199 @@
+import XCTest
+import GRDB
+@testable import FindItCore
+
+final class StageArtifactsTests: XCTestCase {
+
+    private var folderDB: DatabaseQueue!
+    private var videoId: Int64 = 0
+    private let hash = "0123456789abcdef0123456789abcdef"
+
+    override func setUpWithError() throws {
+        folderDB = try DatabaseManager.makeFolderInMemoryDatabase()
+        var video = Video(filePath: "/long.mov", fileName: "long.mov", fileHash: hash)
+        try folderDB.write { try video.insert($0) }
+        videoId = try XCTUnwrap(video.videoId)
+    }
+
+    override func tearDownWithError() throws {
+        folderDB = nil
+    }
+
+    // MARK: - 读写
+
+    func testSaveAndLoadRoundTrip() throws {
+        let cuts = StageArtifacts.SceneCuts(
+            duration: 12.5,
+            scenes: [SceneSegment(startTime: 0, endTime: 5), SceneSegment(startTime: 5, endTime: 12.5)],
+            hasAudio: true
+        )
+        try folderDB.write { db in
+            try StageArtifacts.save(db, cuts, kind: .scenes, videoId: videoId, fileHash: hash)
+        }
+        let loaded = try folderDB.read { db in
+            try StageArtifacts.load(db, StageArtifacts.SceneCuts.self, kind: .scenes, videoId: videoId, fileHash: hash)
+        }
+        XCTAssertEqual(loaded, cuts)
+    }
+
+    func testHashMismatchIsInvalid() throws {
+        try folderDB.write { db in
+            try StageArtifacts.save(db, StageArtifacts.Language(language: "ja"),
+                                    kind: .language, videoId: videoId, fileHash: hash)
+        }
+        let loaded = try folderDB.read { db in
+            try StageArtifacts.load(db, StageArtifacts.Language.self, kind: .language,
+                                    videoId: videoId, fileHash: "changed")
+        }
+        XCTAssertNil(loaded, "文件内容变更后检查点不可复用")
+
+        try folderDB.write { db in
+            try StageArtifacts.discardStale(db, videoId: videoId, fileHash: "changed")
+        }
+        let count = try folderDB.read { try Int.fetchOne($0, sql: "SELECT COUNT(*) FROM stage_artifacts") }
+        XCTAssertEqual(count, 0)
+    }
+
+    func testAudioIntegrityChecksSizeAndContent() throws {
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent("stage-\(UUID().uuidString).wav")
+        try Data(repeating: 0, count: 256).write(to: url)
+        defer { try? FileManager.default.removeItem(at: url) }
+
+        let audio = try XCTUnwrap(StageArtifacts.AudioFile.capture(path: url.path))
+        XCTAssertEqual(audio.size, 256)
+        XCTAssertTrue(audio.isIntact)
+        XCTAssertFalse(StageArtifacts.AudioFile(path: url.path, size: 100, contentHash: audio.contentHash).isIntact,
+                       "大小不一致视为半截文件")
+        XCTAssertFalse(StageArtifacts.AudioFile(path: url.path, size: 256, contentHash: nil).isIntact,
+                       "无哈希的旧检查点不复用")
+
+        // 同样大小、不同内容（同路径被其他提取覆盖）
+        try Data(repeating: 1, count: 256).write(to: url)
+        XCTAssertFalse(audio.isIntact)
+        XCTAssertNil(StageArtifacts.AudioFile.capture(path: url.path + ".missing"))
+    }
+
+    func testClearReturnsAudioFilesWithoutDeleting() throws {
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent("stage-\(UUID().uuidString).wav")
+        try Data(repeating: 0, count: 256).write(to: url)
+        defer { try? FileManager.default.removeItem(at: url) }
+        let audio = try XCTUnwrap(StageArtifacts.AudioFile.capture(path: url.path))
+
+        let doomed = try folderDB.write { db -> [String] in
+            try StageArtifacts.save(db, audio, kind: .audio, videoId: videoId, fileHash: hash)
+            try StageArtifacts.save(db, StageArtifacts.Language(language: "en"),
+                                    kind: .language, videoId: videoId, fileHash: hash)
+            let doomed = try StageArtifacts.clear(db, videoId: videoId, kinds: [.audio])
+            XCTAssertTrue(FileManager.default.fileExists(atPath: url.path), "事务内不删除文件")
+            return doomed
+        }
+        XCTAssertEqual(doomed, [url.path])
+        let kinds = try folderDB.read { try String.fetchAll($0, sql: "SELECT kind FROM stage_artifacts") }
+        XCTAssertEqual(kinds, ["language"])
+
+        StageArtifacts.removeFiles(doomed)
+        XCTAssertFalse(FileManager.default.fileExists(atPath: url.path))
+    }
+
+    func testAudioPathIsUniqueAcrossFolders() {
+        let a = StageArtifacts.audioPath(directory: "/tmp", folderPath: "/Volumes/A/素材", videoId: 7)
+        let b = StageArtifacts.audioPath(directory: "/tmp", folderPath: "/Volumes/B/素材", videoId: 7)
+        XCTAssertNotEqual(a, b, "不同文件夹的同号视频不共用临时文件")
+        XCTAssertEqual(a, StageArtifacts.audioPath(directory: "/tmp", folderPath: "/Volumes/A/素材", videoId: 7))
+        XCTAssertTrue(a.hasPrefix("/tmp/audio_"))
+        XCTAssertTrue(a.hasSuffix("_7.wav"))
+    }
+
+    func testDeletingVideoCascades() throws {
+        try folderDB.write { db in
+            try StageArtifacts.save(db, StageArtifacts.EmbeddingProgress(model: "gemini", lastClipId: 3),
+                                    kind: .embedding, videoId: videoId, fileHash: hash)
+            try db.execute(sql: "DELETE FROM videos WHERE video_id = ?", arguments: [videoId])
+        }
+        let count = try folderDB.read { try Int.fetchOne($0, sql: "SELECT COUNT(*) FROM stage_artifacts") }
+        XCTAssertEqual(count, 0)
+    }
+
+    // MARK: - 转录分块
+
+    func testShortVideoIsSingleChunk() {
+        let chunks = StageArtifacts.transcriptChunks(scenes: [], duration: 800, target: 600)
+        XCTAssertEqual(chunks.count, 1)
+        XCTAssertEqual(chunks[0].start, 0)
+        XCTAssertEqual(chunks[0].end, 800)
+    }
+
+    func testChunksCutAtSceneBoundaries() {
+        // 每 70 秒一个切点，2 小时素材
+        let scenes = stride(from: 0.0, to: 7200, by: 70).map {
+            SceneSegment(startTime: $0, endTime: min($0 + 70, 7200))
+        }
+        let chunks = StageArtifacts.transcriptChunks(scenes: scenes, duration: 7200, target: 600)
+
+        XCTAssertEqual(chunks.first?.start, 0)
+        XCTAssertEqual(chunks.last?.end, 7200)
+        for (a, b) in zip(chunks, chunks.dropFirst()) {
+            XCTAssertEqual(a.end, b.start, "分块首尾相接")
+            XCTAssertEqual(a.end.truncatingRemainder(dividingBy: 70), 0, "在场景切点处断开")
+            XCTAssertGreaterThanOrEqual(a.end - a.start, 600)
+        }
+        // 相同输入 → 相同规划（恢复时单元对齐）
+        let again = StageArtifacts.transcriptChunks(scenes: scenes, duration: 7200, target: 600)
+        XCTAssertEqual(again.map(\.end), chunks.map(\.end))
+    }
+
+    func testChunksHardCutWithoutScenes() {
+        let chunks = StageArtifacts.transcriptChunks(scenes: [], duration: 2000, target: 600)
+        XCTAssertEqual(chunks.map(\.start), [0, 600, 1200])
+        XCTAssertEqual(chunks.last?.end, 2000)
+    }
+
+    func testTranscribeResumableReusesCommittedChunks() async throws {
+        let chunks: [(start: Double, end: Double)] = [(0, 600), (600, 1300)]
+        try folderDB.write { db in
+            try StageArtifacts.save(db, StageArtifacts.TranscriptChunk(start: 0, end: 600, segments: [
+                TranscriptSegment(index: 1, startTime: 1, endTime: 2, text: "早上好"),
+            ]), kind: .transcript, unit: 0, videoId: videoId, fileHash: hash)
+            try StageArtifacts.save(db, StageArtifacts.TranscriptChunk(start: 600, end: 1300, segments: [
+                TranscriptSegment(index: 1, startTime: 601, endTime: 603, text: "开机"),
+            ]), kind: .transcript, unit: 1, videoId: videoId, fileHash: hash)
+        }
+
+        // 全部分块已提交：不触发任何转录引擎
+        let result = try await PipelineManager.transcribeResumable(
+            audioPath: "/nonexistent.wav",
+            chunks: chunks,
+            language: "zh",
+            whisperKit: nil,
+            videoId: videoId,
+            fileHash: hash,
+            folderDB: folderDB
+        )
+        XCTAssertEqual(result.segments.map(\.index), [1, 2], "合并后重新编号")
+        XCTAssertEqual(result.segments.map(\.text), ["早上好", "开机"])
+        XCTAssertEqual(result.segments.last?.startTime, 601)
+    }
+
+    func testMisalignedChunksAreDiscarded() async throws {
+        try folderDB.write { db in
+            try StageArtifacts.save(db, StageArtifacts.TranscriptChunk(start: 0, end: 500, segments: []),
+                                    kind: .transcript, unit: 0, videoId: videoId, fileHash: hash)
+        }
+        do {
+            _ = try await PipelineManager.transcribeResumable(
+                audioPath: "/nonexistent.wav",
+                chunks: [(0, 600), (600, 1300)],
+                language: nil,
+                whisperKit: nil,
+                videoId: videoId,
+                fileHash: hash,
+                folderDB: folderDB
+            )
+            XCTFail("音频不存在时应抛出错误")
+        } catch {}
+        let count = try await folderDB.read {
+            try Int.fetchOne($0, sql: "SELECT COUNT(*) FROM stage_artifacts WHERE kind = 'transcript'")
+        }
+        XCTAssertEqual(count, 0, "边界与规划不一致的分块全部作废")
+    }
+}
@@ -0,0 +1,103 @@
+import XCTest
+import GRDB
+@testable import FindItCore
+
+final class StorageProfileTests: XCTestCase {
+
+    private var tempDir: URL!
+
+    override func setUpWithError() throws {
+        tempDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("StorageProfileTests-\(UUID().uuidString)", isDirectory: true)
+        try FileManager.default.createDirectory(at: tempDir, withIntermediateDirectories: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: tempDir)
+    }
+
+    private func pragma(_ db: DatabaseReader, _ name: String) throws -> Int? {
+        try db.read { try Int.fetchOne($0, sql: "PRAGMA \(name)") }
+    }
+
+    // MARK: - 配置
+
+    func testDefaultProfileHasNoPragmas() {
+        XCTAssertTrue(StorageProfile.sqliteDefault.pragmas.isEmpty)
+        XCTAssertEqual(StorageProfile.standard(for: .global), .global)
+        XCTAssertEqual(StorageProfile.standard(for: .folder), .folder)
+    }
+
+    func testGlobalProfileAppliedToNewDatabase() throws {
+        let path = tempDir.appendingPathComponent("global.sqlite").path
+        let pool = try DatabaseManager.openPool(at: path, profile: .global)
+        try Migrations.globalMigrator().migrate(pool)
+
+        XCTAssertEqual(try pragma(pool, "page_size"), 16384)
+        XCTAssertEqual(try pragma(pool, "cache_size"), -32 * 1024)
+        XCTAssertEqual(try pragma(pool, "wal_autocheckpoint"), 8000)
+        XCTAssertEqual(try pragma(pool, "synchronous"), 1, "NORMAL")
+        XCTAssertEqual(try pragma(pool, "temp_store"), 2, "MEMORY")
+        let journalMode = try pool.read { try String.fetchOne($0, sql: "PRAGMA journal_mode") }
+        XCTAssertEqual(journalMode, "wal")
+    }
+
+    func testFolderProfileKeepsDefaultPageSize() throws {
+        let path = tempDir.appendingPathComponent("folder.sqlite").path
+        let pool = try DatabaseManager.openPool(at: path, profile: .folder)
+        try Migrations.folderMigrator().migrate(pool)
+        XCTAssertEqual(try pragma(pool, "page_size"), 4096)
+        XCTAssertEqual(try pragma(pool, "wal_autocheckpoint"), 4000)
+        XCTAssertEqual(try pragma(pool, "mmap_size"), 0, "外置卷上的文件夹库不做内存映射")
+        XCTAssertFalse(StorageProfile.folder.pragmas.contains { $0.contains("mmap_size") })
+    }
+
+    // MARK: - 检查点
+
+    func testCheckpointDrainsWAL() throws {
+        let path = tempDir.appendingPathComponent("ckpt.sqlite").path
+        let pool = try DatabaseManager.openPool(at: path, profile: .global)
+        try Migrations.globalMigrator().migrate(pool)
+        try pool.write { db in
+            for i in 0..<200 {
+                try db.execute(sql: """
+                    INSERT INTO clips (source_folder, source_clip_id, start_time, end_time, description)
+                    VALUES ('/t', ?, 0, 1, ?)
+                    """, arguments: [i, String(repeating: "x", count: 2000)])
+            }
+        }
+
+        let report = try WALCheckpointer.checkpoint(pool, truncateThresholdPages: 1)
+        XCTAssertFalse(report.busy)
+        XCTAssertGreaterThan(report.walPages, 0)
+        XCTAssertEqual(report.checkpointedPages, report.walPages)
+        XCTAssertTrue(report.truncated)
+
+        let walSize = try FileManager.default.attributesOfItem(atPath: path + "-wal")[.size] as? Int
+        XCTAssertEqual(walSize, 0, "TRUNCATE 后 WAL 文件清空")
+    }
+
+    // MARK: - 基准
+
+    func testBenchmarkProducesMeasurements() throws {
+        let workload = StorageBenchmark.Workload(clips: 200, batchSize: 20, pointReads: 100, ftsQueries: 10, dimensions: 64)
+        let result = try StorageBenchmark.run(
+            profile: .global, name: "global", backgroundCheckpoint: true,
+            workload: workload, directory: tempDir
+        )
+        XCTAssertEqual(result.profileName, "global")
+        XCTAssertGreaterThan(result.writeSeconds, 0)
+        XCTAssertGreaterThanOrEqual(result.commitMax, result.commitP99)
+        XCTAssertGreaterThanOrEqual(result.readP99, result.readP50)
+        XCTAssertGreaterThan(result.databaseBytes, 0)
+
+        let leftovers = try FileManager.default.contentsOfDirectory(atPath: tempDir.path)
+        XCTAssertTrue(leftovers.isEmpty, "基准结束后删除临时库")
+    }
+
+    func testPercentile() {
+        XCTAssertEqual(StorageBenchmark.percentile([], 0.5), 0)
+        XCTAssertEqual(StorageBenchmark.percentile([5, 1, 3], 0.5), 3)
+        XCTAssertEqual(StorageBenchmark.percentile(Array(1...100).map(Double.init), 0.99), 99)
+    }
+}
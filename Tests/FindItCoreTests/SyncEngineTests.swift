@@ -336,9 +336,10 @@ final class SyncEngineTests: XCTestCase {
 
     func testRemoveFolderData() throws {
         try seedFolderData(videoCount: 1, clipsPerVideo: 2)
-        _ = try SyncEngine.sync(folderPath: folderPath, folderDB: folderDB, globalDB: globalDB)
+        let synced = try SyncEngine.sync(folderPath: folderPath, folderDB: folderDB, globalDB: globalDB)
 
-        try SyncEngine.removeFolderData(folderPath: folderPath, from: globalDB)
+        let removed = try SyncEngine.removeFolderData(folderPath: folderPath, from: globalDB)
+        XCTAssertEqual(Set(removed), Set(synced.addedClipIds), "返回删除的全局 clip_id")
 
         let videoCount = try globalDB.read { db in try Int.fetchOne(db, sql: "SELECT COUNT(*) FROM videos") }
         let clipCount = try globalDB.read { db in try Int.fetchOne(db, sql: "SELECT COUNT(*) FROM clips") }
@@ -435,4 +436,50 @@ final class SyncEngineTests: XCTestCase {
         XCTAssertEqual(globalVideoCount, 1)
         XCTAssertEqual(globalClipCount, 1)
     }
+
+    // MARK: - 同步增量 clip_id
+
+    func testSyncReportsAddedClipIds() throws {
+        try seedFolderData(videoCount: 1, clipsPerVideo: 3)
+
+        let result = try SyncEngine.sync(folderPath: folderPath, folderDB: folderDB, globalDB: globalDB)
+
+        let globalIds = try globalDB.read { db in
+            try Int64.fetchAll(db, sql: "SELECT clip_id FROM clips ORDER BY clip_id")
+        }
+        XCTAssertEqual(result.addedClipIds, globalIds)
+        XCTAssertTrue(result.updatedClipIds.isEmpty)
+        XCTAssertTrue(result.removedClipIds.isEmpty)
+        XCTAssertTrue(result.hasClipChanges)
+    }
+
+    func testForceSyncReportsUpdatedClipIds() throws {
+        try seedFolderData(videoCount: 1, clipsPerVideo: 2)
+        let first = try SyncEngine.sync(folderPath: folderPath, folderDB: folderDB, globalDB: globalDB)
+
+        let forced = try SyncEngine.sync(
+            folderPath: folderPath, folderDB: folderDB, globalDB: globalDB, force: true
+        )
+        XCTAssertTrue(forced.addedClipIds.isEmpty, "已存在的 clip 不应报告为新增")
+        XCTAssertEqual(forced.updatedClipIds.sorted(), first.addedClipIds.sorted())
+    }
+
+    func testNoNewDataReportsNoClipChanges() throws {
+        try seedFolderData(videoCount: 1, clipsPerVideo: 2)
+        _ = try SyncEngine.sync(folderPath: folderPath, folderDB: folderDB, globalDB: globalDB)
+
+        let second = try SyncEngine.sync(folderPath: folderPath, folderDB: folderDB, globalDB: globalDB)
+        XCTAssertFalse(second.hasClipChanges)
+    }
+
+    func testAddingRemovedClipIdsSkipsRewrittenIds() {
+        let result = SyncEngine.SyncResult(
+            syncedVideos: 0, syncedClips: 1,
+            addedClipIds: [10], updatedClipIds: [11]
+        ).addingRemovedClipIds([1, 2, 2, 10, 11])
+
+        XCTAssertEqual(result.removedClipIds, [1, 2])
+        XCTAssertEqual(result.addedClipIds, [10])
+        XCTAssertEqual(result.updatedClipIds, [11])
+    }
 }
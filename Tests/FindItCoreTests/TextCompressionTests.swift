@@ -0,0 +1,257 @@
+import XCTest
+import GRDB
+@testable import FindItCore
+
+final class TextCompressionTests: XCTestCase {
+
+    // MARK: - Helper
+
+    private let subjects = ["harbor", "forest trail", "city rooftop", "mountain lake", "night market"]
+    private let details = ["fishing boats drifting", "mist rolling between trees", "neon signs flickering",
+                           "reflections on still water", "crowds moving past food stalls"]
+
+    /// 结构相似、措辞各异的长描述（与 VLM 输出的句式重复度相近）
+    private func description(_ i: Int) -> String {
+        "A slow dolly shot of the \(subjects[i % subjects.count]) at golden hour, "
+            + "with \(details[(i / 2) % details.count]) in the background. "
+            + "Warm color palette, shallow depth of field, handheld camera, take \(i)."
+    }
+
+    private func transcript(_ i: Int) -> String {
+        "Okay, we are rolling now. Take number \(i), let's get the wide shot first and then move closer."
+    }
+
+    /// 全局库插入 `count` 个带长描述 / 转录的 clip（第 0 个描述含独有词 lighthouse）
+    private func makeGlobalDB(count: Int = 40) throws -> DatabaseQueue {
+        let db = try DatabaseManager.makeGlobalInMemoryDatabase()
+        try db.write { db in
+            try db.execute(sql: """
+                INSERT INTO videos (source_folder, source_video_id, file_path, file_name, duration)
+                VALUES ('/素材/A', 1, '/素材/A/a.mov', 'a.mov', 600.0)
+                """)
+            let videoId = db.lastInsertedRowID
+            for i in 0..<count {
+                let text = i == 0 ? description(i) + " A lighthouse on the cliff." : description(i)
+                try db.execute(sql: """
+                    INSERT INTO clips (source_folder, source_clip_id, video_id, start_time, end_time,
+                        description, tags, transcript)
+                    VALUES ('/素材/A', ?, ?, ?, ?, ?, '户外', ?)
+                    """, arguments: [i + 1, videoId, Double(i) * 5, Double(i) * 5 + 5, text, transcript(i)])
+            }
+        }
+        return db
+    }
+
+    // MARK: - 编解码
+
+    func testRoundTripWithoutDictionary() throws {
+        let text = String(repeating: "海浪轻拍岸边，金色夕阳下的沙滩。", count: 8)
+        let encoded = TextCompression.Encoder(dictionary: nil).encode(text)
+        let blob = try XCTUnwrap(encoded as? Data)
+        XCTAssertLessThan(blob.count, text.utf8.count)
+
+        let decoded = try TextCompression.decode(blob.databaseValue) { _ in XCTFail("无字典不应查字典"); return nil }
+        XCTAssertEqual(decoded, text)
+    }
+
+    func testShortAndIncompressibleTextStaysText() throws {
+        let encoder = TextCompression.Encoder(dictionary: nil)
+        XCTAssertEqual(encoder.encode("海边") as? String, "海边")
+        XCTAssertNil(encoder.encode(nil))
+
+        let noise = (0..<80).map { _ in String(UnicodeScalar(UInt8.random(in: 0x21...0x7E))) }.joined()
+        XCTAssertEqual(encoder.encode(noise) as? String, noise, "压缩后不更短时保持原文")
+    }
+
+    func testDictionaryRoundTripAndUnknownDictionary() throws {
+        let samples = (0..<40).map(description)
+        let data = try XCTUnwrap(TextDictionaryTrainer().train(samples))
+        let dictionary = TextCompression.CompressionDictionary(data: data)
+
+        let text = description(99)
+        let withDictionary = try XCTUnwrap(TextCompression.Encoder(dictionary: dictionary).encode(text) as? Data)
+        let withoutDictionary = TextCompression.Encoder(dictionary: nil).encode(text)
+        if let plain = withoutDictionary as? Data {
+            XCTAssertLessThan(withDictionary.count, plain.count, "字典应改善短文本压缩")
+        }
+
+        let decoded = try TextCompression.decode(withDictionary.databaseValue) {
+            $0 == dictionary.id ? dictionary.data : nil
+        }
+        XCTAssertEqual(decoded, text)
+
+        XCTAssertThrowsError(try TextCompression.decode(withDictionary.databaseValue) { _ in nil }) { error in
+            guard case TextCompressionError.unknownDictionary(let id) = error else {
+                return XCTFail("应为 unknownDictionary，实际 \(error)")
+            }
+            XCTAssertEqual(id, dictionary.id)
+        }
+    }
+
+    func testTrainerNeedsEnoughSamples() {
+        XCTAssertNil(TextDictionaryTrainer().train((0..<5).map(description)))
+        XCTAssertNil(TextDictionaryTrainer(minimumSamples: 2).train(["abcdefghijk", "zyxwvutsrqp"]), "无重复片段")
+    }
+
+    // MARK: - 整理
+
+    func testCompactRewritesRowsAndKeepsSearch() throws {
+        let db = try makeGlobalDB()
+        let vocabulary = "SELECT term, doc, cnt FROM clips_fts_vocab ORDER BY term"
+        let ftsBefore = try db.read { try Row.fetchAll($0, sql: vocabulary) }
+
+        let report = try TextCompression.compact(db)
+        XCTAssertTrue(report.trained)
+        XCTAssertNotNil(report.dictionaryId)
+        XCTAssertEqual(report.rewrittenRows, 40)
+        XCTAssertLessThan(report.bytesAfter, report.bytesBefore)
+
+        try db.read { db in
+            let blobs = try Int.fetchOne(db, sql: "SELECT COUNT(*) FROM clips WHERE typeof(description) = 'blob'")
+            XCTAssertEqual(blobs, 40)
+            let ftsAfter = try Row.fetchAll(db, sql: vocabulary)
+            XCTAssertEqual(ftsAfter, ftsBefore, "改写为压缩存储不改变 FTS 索引内容")
+
+            let results = try SearchEngine.search(db, query: "lighthouse")
+            XCTAssertEqual(results.count, 1)
+            XCTAssertEqual(results.first?.clipDescription, description(0) + " A lighthouse on the cliff.")
+            XCTAssertEqual(results.first?.transcript, transcript(0))
+        }
+
+        let again = try TextCompression.compact(db)
+        XCTAssertFalse(again.trained, "已有字典不重复训练")
+        XCTAssertEqual(again.rewrittenRows, 0)
+    }
+
+    func testUpdatingCompressedTextReindexesFTS() throws {
+        let db = try makeGlobalDB()
+        try TextCompression.compact(db)
+
+        try db.write { db in
+            // 两列都改回明文：触发器整行重建
+            try db.execute(sql: """
+                UPDATE clips SET description = 'A windmill turning slowly', transcript = 'quiet take'
+                WHERE source_clip_id = 1
+                """)
+            XCTAssertTrue(try SearchEngine.search(db, query: "lighthouse").isEmpty)
+            XCTAssertEqual(try SearchEngine.search(db, query: "windmill").count, 1)
+            XCTAssertEqual(try SearchEngine.search(db, query: "quiet").count, 1)
+
+            // 另一列仍为压缩值：触发器跳过，写入方经 reindex 补写
+            try db.execute(sql: "UPDATE clips SET description = 'A lone kite' WHERE source_clip_id = 4")
+            let clipId = try XCTUnwrap(Int64.fetchOne(db, sql: "SELECT clip_id FROM clips WHERE source_clip_id = 4"))
+            try TextCompression.reindex(db, clipId: clipId)
+            XCTAssertEqual(try SearchEngine.search(db, query: "kite").count, 1)
+            XCTAssertEqual(try SearchEngine.search(db, query: "rolling").count, 39, "压缩的转录仍被索引")
+
+            // 只改评分不影响 FTS
+            try db.execute(sql: "UPDATE clips SET rating = 5 WHERE source_clip_id = 2")
+            XCTAssertEqual(try SearchEngine.search(db, query: "golden").count, 38)
+
+            try db.execute(sql: "DELETE FROM clips WHERE source_clip_id = 3")
+            XCTAssertEqual(try SearchEngine.search(db, query: "golden").count, 37)
+        }
+    }
+
+    // MARK: - Schema
+
+    func testSchemaCallsNoAppFunction() throws {
+        let db = try makeGlobalDB()
+        try TextCompression.compact(db)
+        try db.read { db in
+            let references = try Int.fetchOne(db, sql: """
+                SELECT COUNT(*) FROM sqlite_master WHERE sql LIKE '%findit_text%'
+                """)
+            XCTAssertEqual(references, 0, "触发器与视图不依赖应用函数")
+        }
+
+        // 未注册任何函数、关闭 trusted_schema 的连接照常写入
+        try db.write { db in
+            try db.execute(sql: "PRAGMA trusted_schema = OFF")
+            try db.execute(sql: """
+                UPDATE clips SET description = 'A windmill turning slowly', transcript = NULL
+                WHERE source_clip_id = 2
+                """)
+            try db.execute(sql: "DELETE FROM clips WHERE source_clip_id = 3")
+            XCTAssertEqual(try SearchEngine.search(db, query: "windmill").count, 1)
+        }
+    }
+
+    func testMigrationIndexesCompressedRowsFromV14() throws {
+        let migrator = Migrations.globalMigrator()
+        let db = try DatabaseManager.makeRawInMemoryDatabase()
+        try migrator.migrate(db, upTo: "v15_purgeOrphanTranscriptSegments")
+
+        // v14 schema：经 findit_text() 视图索引压缩值
+        let text = description(3) + " A lighthouse on the cliff."
+        let blob = try XCTUnwrap(TextCompression.Encoder(dictionary: nil).encode(text) as? Data)
+        try db.write { db in
+            try TextCompression.withLegacyFunction(db) {
+                try db.execute(sql: """
+                    INSERT INTO clips (source_folder, source_clip_id, start_time, end_time, description, transcript)
+                    VALUES ('/素材/A', 1, 0, 5, ?, 'short take')
+                    """, arguments: [blob])
+            }
+        }
+
+        try migrator.migrate(db)
+        try db.read { db in
+            XCTAssertEqual(try SearchEngine.search(db, query: "lighthouse").count, 1)
+            XCTAssertEqual(try SearchEngine.search(db, query: "take").count, 1)
+            XCTAssertFalse(try db.viewExists("clips_fts_content"))
+            XCTAssertFalse(try db.tableExists("clips_fts_content"), "无内容表不存原文")
+        }
+    }
+
+    func testCompactShrinksDatabase() throws {
+        let db = try makeGlobalDB(count: 200)
+        func vacuumedPageCount() throws -> Int {
+            try db.writeWithoutTransaction { db in
+                try db.execute(sql: "VACUUM")
+                return try Int.fetchOne(db, sql: "PRAGMA page_count") ?? 0
+            }
+        }
+
+        let before = try vacuumedPageCount()
+        try TextCompression.compact(db)
+        let after = try vacuumedPageCount()
+
+        // FTS 不存原文，压缩 clips 即缩小全库
+        XCTAssertLessThan(after, before)
+        try db.read { db in
+            XCTAssertFalse(try db.tableExists("clips_fts_content"))
+            XCTAssertEqual(try SearchEngine.search(db, query: "lighthouse").count, 1)
+        }
+    }
+
+    // MARK: - 同步
+
+    func testSyncWritesWithActiveDictionary() throws {
+        let globalDB = try makeGlobalDB()
+        let report = try TextCompression.compact(globalDB)
+        let dictionaryId = try XCTUnwrap(report.dictionaryId)
+
+        let folderPath = "/Volumes/B/素材"
+        let folderDB = try DatabaseManager.makeFolderInMemoryDatabase()
+        try folderDB.write { db in
+            var folder = WatchedFolder(folderPath: folderPath)
+            try folder.insert(db)
+            var video = Video(folderId: folder.folderId, filePath: "\(folderPath)/b.mov", fileName: "b.mov")
+            try video.insert(db)
+            var clip = Clip(videoId: video.videoId, startTime: 0, endTime: 5, clipDescription: description(7),
+                            transcript: transcript(7))
+            try clip.insert(db)
+        }
+        _ = try SyncEngine.sync(folderPath: folderPath, folderDB: folderDB, globalDB: globalDB)
+
+        try globalDB.read { db in
+            let stored = try XCTUnwrap(Data.fetchOne(db, sql: """
+                SELECT description FROM clips WHERE source_folder = ?
+                """, arguments: [folderPath]))
+            XCTAssertEqual(TextCompression.Header(stored)?.dictionaryId, dictionaryId)
+
+            let results = try SearchEngine.search(db, query: "wide", folderPaths: [folderPath])
+            XCTAssertEqual(results.map(\.clipDescription), [description(7)])
+        }
+    }
+}
@@ -0,0 +1,208 @@
+import XCTest
+import CoreGraphics
+import ImageIO
+import UniformTypeIdentifiers
+@testable import FindItCore
+
+final class ThumbnailServiceTests: XCTestCase {
+
+    private var tempDir: URL!
+
+    override func setUpWithError() throws {
+        tempDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("ThumbnailServiceTests-\(UUID().uuidString)")
+        try FileManager.default.createDirectory(at: tempDir, withIntermediateDirectories: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: tempDir)
+    }
+
+    // MARK: - Helper
+
+    /// 生成纯色 PNG
+    private func writePNG(width: Int, height: Int, rgba: (UInt8, UInt8, UInt8, UInt8), name: String) throws -> String {
+        let pixels = [UInt8]((0..<(width * height)).flatMap { _ in [rgba.0, rgba.1, rgba.2, rgba.3] })
+        let image = try XCTUnwrap(ThumbnailImage(width: width, height: height, pixels: pixels).makeCGImage())
+        let url = tempDir.appendingPathComponent(name)
+        let destination = try XCTUnwrap(
+            CGImageDestinationCreateWithURL(url as CFURL, UTType.png.identifier as CFString, 1, nil)
+        )
+        CGImageDestinationAddImage(destination, image, nil)
+        XCTAssertTrue(CGImageDestinationFinalize(destination))
+        return url.path
+    }
+
+    private func solidImage(width: Int, height: Int, value: UInt8) -> ThumbnailImage {
+        ThumbnailImage(width: width, height: height, pixels: [UInt8](repeating: value, count: width * height * 4))
+    }
+
+    // MARK: - Resizer
+
+    func testTargetSizeKeepsAspectAndNeverUpscales() {
+        XCTAssertTrue(ThumbnailResizer.targetSize(width: 910, height: 512, maxPixelSize: 300) == (300, 169))
+        XCTAssertTrue(ThumbnailResizer.targetSize(width: 200, height: 100, maxPixelSize: 300) == (200, 100))
+    }
+
+    func testDownsampleAveragesBlocks() {
+        // 4×2 → 2×1：每个目标像素是 2×2 块的平均
+        let source: [UInt8] = [
+            0, 0, 0, 255,     100, 100, 100, 255,   200, 0, 0, 255,   200, 0, 0, 255,
+            100, 100, 100, 255, 200, 200, 200, 255, 0, 0, 200, 255,   0, 0, 200, 255,
+        ]
+        let result = source.withUnsafeBytes {
+            ThumbnailResizer.downsample($0, width: 4, height: 2, rowBytes: 16, targetWidth: 2, targetHeight: 1)
+        }
+        XCTAssertEqual(result, [100, 100, 100, 255, 100, 0, 100, 255])
+    }
+
+    func testDownsampleNonIntegerScalePreservesSolidColor() {
+        let image = solidImage(width: 91, height: 51, value: 77)
+        let result = image.pixels.withUnsafeBytes {
+            ThumbnailResizer.downsample($0, width: 91, height: 51, rowBytes: 91 * 4, maxPixelSize: 30)
+        }
+        XCTAssertEqual(result.width, 30)
+        XCTAssertEqual(result.height, 17)
+        XCTAssertTrue(result.pixels.allSatisfy { $0 == 77 })
+    }
+
+    // MARK: - Pack store
+
+    func testPackStoreRoundTripAcrossReopen() throws {
+        let url = tempDir.appendingPathComponent("thumbs.pack")
+        let image = solidImage(width: 3, height: 2, value: 9)
+        do {
+            let store = try ThumbnailPackStore(url: url)
+            try store.write(key: 42, image: image)
+            try store.write(key: 42, image: solidImage(width: 3, height: 2, value: 10))
+            XCTAssertEqual(store.count, 1)
+        }
+
+        let reopened = try ThumbnailPackStore(url: url)
+        XCTAssertEqual(reopened.read(key: 42), solidImage(width: 3, height: 2, value: 10))
+        XCTAssertNil(reopened.read(key: 7))
+    }
+
+    func testPackStoreTruncatesTornTail() throws {
+        let url = tempDir.appendingPathComponent("thumbs.pack")
+        let store = try ThumbnailPackStore(url: url)
+        try store.write(key: 1, image: solidImage(width: 2, height: 2, value: 1))
+        try store.write(key: 2, image: solidImage(width: 2, height: 2, value: 2))
+        let fullSize = store.fileSize
+
+        // 模拟写入中途退出：去掉最后 5 字节
+        let handle = try FileHandle(forUpdating: url)
+        try handle.truncate(atOffset: UInt64(fullSize - 5))
+        try handle.close()
+
+        let reopened = try ThumbnailPackStore(url: url)
+        XCTAssertEqual(reopened.count, 1)
+        XCTAssertNotNil(reopened.read(key: 1))
+        XCTAssertNil(reopened.read(key: 2))
+        XCTAssertLessThan(reopened.fileSize, fullSize - 5)
+    }
+
+    func testPackStoreCompactsOverBudgetKeepingNewest() throws {
+        let url = tempDir.appendingPathComponent("thumbs.pack")
+        let store = try ThumbnailPackStore(url: url, budgetBytes: 1024 * 1024)
+        // 每条约 256 KB，第 4 条写入后超出 1 MB，压缩到 3/4 只保留最新两条
+        for key in 0..<5 {
+            try store.write(key: UInt64(key), image: solidImage(width: 256, height: 256, value: UInt8(key)))
+        }
+
+        XCTAssertLessThanOrEqual(store.fileSize, 1024 * 1024)
+        XCTAssertEqual(store.count, 3)
+        XCTAssertNil(store.read(key: 0))
+        XCTAssertNil(store.read(key: 1))
+        XCTAssertEqual(store.read(key: 4), solidImage(width: 256, height: 256, value: 4))
+    }
+
+    func testPackStoreRemoveWritesTombstone() throws {
+        let url = tempDir.appendingPathComponent("thumbs.pack")
+        let store = try ThumbnailPackStore(url: url)
+        let other = try ThumbnailPackStore(url: url)
+        try store.write(key: 1, image: solidImage(width: 2, height: 2, value: 1))
+        try store.write(key: 2, image: solidImage(width: 2, height: 2, value: 2))
+        XCTAssertNotNil(other.read(key: 1))
+
+        try store.remove(keys: [1, 99])
+        XCTAssertNil(store.read(key: 1))
+        XCTAssertEqual(store.count, 1)
+        // 另一句柄扫描到墓碑后失效（只读新增部分，需通过写入触发刷新）
+        try other.write(key: 3, image: solidImage(width: 1, height: 1, value: 3))
+        XCTAssertNil(other.read(key: 1))
+
+        let reopened = try ThumbnailPackStore(url: url)
+        XCTAssertNil(reopened.read(key: 1))
+        XCTAssertEqual(reopened.read(key: 2), solidImage(width: 2, height: 2, value: 2))
+        XCTAssertEqual(reopened.count, 2)
+    }
+
+    func testPackStoreSeesAppendsFromAnotherHandle() throws {
+        let url = tempDir.appendingPathComponent("thumbs.pack")
+        let app = try ThumbnailPackStore(url: url)
+        let cli = try ThumbnailPackStore(url: url)
+
+        try cli.write(key: 5, image: solidImage(width: 1, height: 1, value: 5))
+        try app.write(key: 6, image: solidImage(width: 1, height: 1, value: 6))
+
+        XCTAssertEqual(app.read(key: 5), solidImage(width: 1, height: 1, value: 5))
+        XCTAssertEqual(cli.read(key: 6), solidImage(width: 1, height: 1, value: 6))
+    }
+
+    // MARK: - Service
+
+    func testServiceDecodesOnceThenHitsDiskAcrossInstances() async throws {
+        let path = try writePNG(width: 64, height: 36, rgba: (255, 0, 0, 255), name: "a.png")
+        let packURL = tempDir.appendingPathComponent("thumbs.pack")
+
+        let first = ThumbnailService(packURL: packURL, maxPixelSize: 32)
+        let loaded = await first.thumbnail(for: path)
+        let image = try XCTUnwrap(loaded)
+        XCTAssertEqual(image.width, 32)
+        XCTAssertEqual(image.height, 18)
+        XCTAssertEqual(Array(image.pixels.prefix(4)), [255, 0, 0, 255])
+        _ = await first.thumbnail(for: path)
+        let firstStats = await first.stats
+        XCTAssertEqual(firstStats.decodes, 1)
+        XCTAssertEqual(firstStats.memoryHits, 1)
+
+        let second = ThumbnailService(packURL: packURL, maxPixelSize: 32)
+        let again = await second.thumbnail(for: path)
+        XCTAssertEqual(again, image)
+        let secondStats = await second.stats
+        XCTAssertEqual(secondStats.diskHits, 1)
+        XCTAssertEqual(secondStats.decodes, 0)
+    }
+
+    func testServiceMissingFileReturnsNil() async {
+        let service = ThumbnailService(packURL: nil)
+        let image = await service.thumbnail(for: tempDir.appendingPathComponent("missing.jpg").path)
+        XCTAssertNil(image)
+        let stats = await service.stats
+        XCTAssertEqual(stats.failures, 1)
+    }
+
+    func testMemoryLRUEvictsOldest() async throws {
+        let paths = try (0..<3).map { try writePNG(width: 8, height: 8, rgba: (0, 0, UInt8($0), 255), name: "\($0).png") }
+        let service = ThumbnailService(packURL: nil, maxPixelSize: 8, memoryCapacity: 2)
+
+        for path in paths {
+            _ = await service.thumbnail(for: path)
+        }
+        _ = await service.thumbnail(for: paths[0])
+
+        let stats = await service.stats
+        XCTAssertEqual(stats.decodes, 4, "最早的条目被淘汰后需重新解码")
+        let memoryCount = await service.memoryCount
+        XCTAssertEqual(memoryCount, 2)
+    }
+
+    func testCacheKeyChangesWithModificationDate() {
+        let date = Date(timeIntervalSince1970: 1_700_000_000)
+        let key = ThumbnailService.cacheKey(path: "/a.jpg", modificationDate: date, maxPixelSize: 300)
+        XCTAssertEqual(key, ThumbnailService.cacheKey(path: "/a.jpg", modificationDate: date, maxPixelSize: 300))
+        XCTAssertNotEqual(key, ThumbnailService.cacheKey(path: "/a.jpg", modificationDate: date + 1, maxPixelSize: 300))
+        XCTAssertNotEqual(key, ThumbnailService.cacheKey(path: "/a.jpg", modificationDate: date, maxPixelSize: 200))
+    }
+}
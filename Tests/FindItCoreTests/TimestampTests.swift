@@ -0,0 +1,131 @@
+import XCTest
+import GRDB
+@testable import FindItCore
+
+final class TimestampTests: XCTestCase {
+
+    private var folderDB: DatabaseQueue!
+
+    override func setUpWithError() throws {
+        folderDB = try DatabaseManager.makeFolderInMemoryDatabase()
+    }
+
+    override func tearDownWithError() throws {
+        folderDB = nil
+    }
+
+    // MARK: - Helper
+
+    private func insertVideo(_ video: Video) throws -> Int64 {
+        var video = video
+        try folderDB.write { try video.insert($0) }
+        return try XCTUnwrap(video.videoId)
+    }
+
+    private func row(_ videoId: Int64) throws -> Row {
+        try XCTUnwrap(folderDB.read { db in
+            try Row.fetchOne(db, sql: "SELECT * FROM videos WHERE video_id = ?", arguments: [videoId])
+        })
+    }
+
+    // MARK: - 转换
+
+    func testDateRoundTrip() {
+        let date = Date(timeIntervalSince1970: 1_700_000_000.25)
+        let ns = Timestamp.nanoseconds(date)
+        XCTAssertEqual(ns, 1_700_000_000_250_000_000)
+        XCTAssertEqual(Timestamp.date(ns).timeIntervalSince1970, 1_700_000_000.25, accuracy: 1e-6)
+        XCTAssertEqual(Timestamp.ago(seconds: 2, from: ns), ns - 2_000_000_000)
+    }
+
+    func testStatReportsSizeAndSubsecondMtime() throws {
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent("ts-\(UUID().uuidString).bin")
+        try Data(repeating: 7, count: 1234).write(to: url)
+        defer { try? FileManager.default.removeItem(at: url) }
+        let mtime = Date(timeIntervalSince1970: 1_600_000_000.5)
+        try FileManager.default.setAttributes([.modificationDate: mtime], ofItemAtPath: url.path)
+
+        let stat = try XCTUnwrap(Timestamp.stat(path: url.path))
+        XCTAssertEqual(stat.size, 1234)
+        XCTAssertEqual(stat.modified, 1_600_000_000_500_000_000)
+        XCTAssertNil(Timestamp.stat(path: url.path + ".missing"))
+    }
+
+    // MARK: - 字符串镜像
+
+    func testNanosecondWriteMirrorsText() throws {
+        let id = try insertVideo(Video(filePath: "/a.mov", fileName: "a.mov",
+                                       fileModifiedNs: 1_600_000_000_500_000_000))
+        var r = try row(id)
+        XCTAssertEqual(r["file_modified"] as String?, "2020-09-13 12:26:40")
+        XCTAssertEqual(r["file_modified_ns"] as Int64?, 1_600_000_000_500_000_000, "纳秒值不被秒级镜像覆盖")
+
+        try folderDB.write { db in
+            try db.execute(sql: "UPDATE videos SET orphaned_at_ns = ? WHERE video_id = ?",
+                           arguments: [1_600_000_100_000_000_000 as Int64, id])
+        }
+        r = try row(id)
+        XCTAssertEqual(r["orphaned_at"] as String?, "2020-09-13 12:28:20")
+
+        try folderDB.write { db in
+            try db.execute(sql: "UPDATE videos SET orphaned_at_ns = NULL WHERE video_id = ?", arguments: [id])
+        }
+        XCTAssertNil(try row(id)["orphaned_at"] as String?)
+    }
+
+    func testLegacyTextWriteMirrorsNanoseconds() throws {
+        let id = try insertVideo(Video(filePath: "/b.mov", fileName: "b.mov", orphanedAt: "2020-01-01 00:00:00"))
+        XCTAssertEqual(try row(id)["orphaned_at_ns"] as Int64?, 1_577_836_800_000_000_000)
+
+        try folderDB.write { db in
+            try db.execute(sql: "UPDATE videos SET orphaned_at = datetime('now', '-60 days') WHERE video_id = ?",
+                           arguments: [id])
+        }
+        let ns = try XCTUnwrap(try row(id)["orphaned_at_ns"] as Int64?)
+        XCTAssertEqual(Double(ns) / 1e9, Date().timeIntervalSince1970 - 60 * 86400, accuracy: 5)
+    }
+
+    func testRecordUpdateDoesNotClobberNanoseconds() throws {
+        var video = Video(filePath: "/c.mov", fileName: "c.mov", fileModifiedNs: 1_600_000_000_123_456_789)
+        try folderDB.write { try video.insert($0) }
+
+        // 内存中的字符串仍为 nil，update 不应把镜像或纳秒值清空
+        try folderDB.write { db in
+            try video.updateIndexStatus(db, status: "completed")
+        }
+        let fetched = try XCTUnwrap(folderDB.read { try Video.fetchOne($0, key: video.videoId) })
+        XCTAssertEqual(fetched.fileModifiedNs, 1_600_000_000_123_456_789)
+        XCTAssertNotNil(fetched.fileModified)
+        XCTAssertNotNil(fetched.indexedAtNs)
+        XCTAssertNotNil(fetched.indexedAt)
+    }
+
+    // MARK: - 迁移
+
+    func testMigrationBackfillsExistingRows() throws {
+        let db = try DatabaseManager.makeRawInMemoryDatabase()
+        try Migrations.folderMigrator().migrate(db, upTo: "v9_addTranscriptSegments")
+        try db.write { db in
+            try db.execute(sql: """
+                INSERT INTO videos (file_path, file_name, file_modified, created_at, indexed_at)
+                VALUES ('/old.mov', 'old.mov', '2021-06-01 08:00:00', '2021-06-01 08:00:01', NULL)
+                """)
+        }
+        try Migrations.folderMigrator().migrate(db)
+
+        let row = try XCTUnwrap(db.read { try Row.fetchOne($0, sql: "SELECT * FROM videos") })
+        XCTAssertEqual(row["file_modified_ns"] as Int64?, 1_622_534_400_000_000_000)
+        XCTAssertEqual(row["created_at_ns"] as Int64?, 1_622_534_401_000_000_000)
+        XCTAssertNil(row["indexed_at_ns"] as Int64?)
+    }
+
+    func testOrphanExpiryUsesIntegerIndex() throws {
+        let plan = try folderDB.read { db in
+            try Row.fetchAll(db, sql: """
+                EXPLAIN QUERY PLAN SELECT video_id FROM videos
+                WHERE index_status = 'orphaned' AND orphaned_at_ns < ?
+                """, arguments: [Timestamp.now()])
+        }.map { $0["detail"] as String }.joined(separator: "\n")
+        XCTAssertTrue(plan.contains("idx_videos_orphaned_at_ns"), plan)
+    }
+}
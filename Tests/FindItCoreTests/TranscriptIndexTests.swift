@@ -0,0 +1,179 @@
+import XCTest
+import GRDB
+@testable import FindItCore
+
+final class TranscriptIndexTests: XCTestCase {
+
+    private var folderDB: DatabaseQueue!
+    private var globalDB: DatabaseQueue!
+    private let folderPath = "/Volumes/素材盘/访谈"
+    private var videoId: Int64!
+
+    override func setUpWithError() throws {
+        folderDB = try DatabaseManager.makeFolderInMemoryDatabase()
+        globalDB = try DatabaseManager.makeGlobalInMemoryDatabase()
+
+        // 一个视频、两个 10 秒场景
+        videoId = try folderDB.write { db in
+            var folder = WatchedFolder(folderPath: folderPath)
+            try folder.insert(db)
+            var video = Video(
+                folderId: folder.folderId,
+                filePath: "\(folderPath)/interview.mov",
+                fileName: "interview.mov",
+                duration: 20
+            )
+            try video.insert(db)
+            for c in 0..<2 {
+                var clip = Clip(videoId: video.videoId, startTime: Double(c * 10), endTime: Double((c + 1) * 10))
+                try clip.insert(db)
+            }
+            return try XCTUnwrap(video.videoId)
+        }
+    }
+
+    override func tearDownWithError() throws {
+        folderDB = nil
+        globalDB = nil
+    }
+
+    // MARK: - Helper
+
+    private let segments = [
+        TranscriptSegment(index: 1, startTime: 1.0, endTime: 4.0, text: "welcome to the show"),
+        TranscriptSegment(index: 2, startTime: 12.0, endTime: 16.0, text: "the quick brown fox jumps"),
+        TranscriptSegment(index: 3, startTime: 17.0, endTime: 19.0, text: "brown bread is tasty"),
+    ]
+
+    private func writeAndSync(_ segments: [TranscriptSegment]) throws -> SyncEngine.SyncResult {
+        try folderDB.write { db in
+            try TranscriptIndex.replaceSegments(db, videoId: videoId, segments: segments)
+        }
+        return try SyncEngine.sync(folderPath: folderPath, folderDB: folderDB, globalDB: globalDB)
+    }
+
+    private func search(_ query: String) throws -> [TranscriptIndex.Hit] {
+        try globalDB.read { try TranscriptIndex.search($0, query: query) }
+    }
+
+    // MARK: - 文件夹库
+
+    func testReplaceSegmentsOverwritesVideo() throws {
+        try folderDB.write { db in
+            try TranscriptIndex.replaceSegments(db, videoId: videoId, segments: segments)
+            try TranscriptIndex.replaceSegments(db, videoId: videoId, segments: [
+                TranscriptSegment(index: 1, startTime: 0, endTime: 2, text: "  "),
+                TranscriptSegment(index: 2, startTime: 2, endTime: 5, text: "retake"),
+            ])
+        }
+        let stored = try folderDB.read { try TranscriptIndex.fetchSegments($0, videoId: videoId) }
+        XCTAssertEqual(stored.map(\.text), ["retake"], "空白字幕不入库")
+    }
+
+    // MARK: - 同步 + 检索
+
+    func testSearchReturnsSegmentTimecodeAndClip() throws {
+        let result = try writeAndSync(segments)
+        XCTAssertEqual(result.syncedSegments, 3)
+
+        let hits = try search("fox")
+        XCTAssertEqual(hits.count, 1)
+        let hit = try XCTUnwrap(hits.first)
+        XCTAssertEqual(hit.startTime, 12.0)
+        XCTAssertEqual(hit.endTime, 16.0)
+        XCTAssertEqual(hit.fileName, "interview.mov")
+        XCTAssertEqual(hit.snippet, "the quick brown [fox] jumps")
+
+        // "fox" 位于第 16 个字符（共 25 个）：12 + 4 × 16/25
+        XCTAssertEqual(hit.matchTime, 12.0 + 4.0 * 16.0 / 25.0, accuracy: 1e-9)
+
+        // 片段归属：12s 落在第二个场景
+        let secondClip = try globalDB.read { db in
+            try Int64.fetchOne(db, sql: "SELECT clip_id FROM clips WHERE start_time = 10")
+        }
+        XCTAssertEqual(hit.clipId, secondClip)
+    }
+
+    func testPhraseMatchesWithinSegmentOnly() throws {
+        _ = try writeAndSync(segments)
+        XCTAssertEqual(try search("\"brown fox\"").map(\.startTime), [12.0])
+        // 跨字幕的词不构成短语
+        XCTAssertTrue(try search("\"jumps brown\"").isEmpty)
+    }
+
+    func testNearQuery() throws {
+        _ = try writeAndSync(segments)
+        XCTAssertEqual(TranscriptIndex.nearQuery("quick jumps", distance: 2), "NEAR(\"quick\" \"jumps\", 2)")
+        XCTAssertEqual(TranscriptIndex.nearQuery("\"quick jumps\"", distance: 2), "\"quick jumps\"")
+        XCTAssertEqual(TranscriptIndex.nearQuery("fox", distance: 2), "fox")
+
+        XCTAssertEqual(try search(TranscriptIndex.nearQuery("quick jumps", distance: 2)).count, 1)
+        XCTAssertTrue(try search(TranscriptIndex.nearQuery("quick jumps", distance: 0)).isEmpty)
+    }
+
+    func testRetranscribeReplacesGlobalSegments() throws {
+        _ = try writeAndSync(segments)
+        _ = try writeAndSync([TranscriptSegment(index: 1, startTime: 5, endTime: 8, text: "a new take")])
+
+        XCTAssertTrue(try search("fox").isEmpty)
+        XCTAssertEqual(try search("take").map(\.startTime), [5.0])
+        let count = try globalDB.read { try Int.fetchOne($0, sql: "SELECT COUNT(*) FROM transcript_segments") }
+        XCTAssertEqual(count, 1)
+    }
+
+    func testRetranscribeWithoutSegmentsClearsGlobalSegments() throws {
+        _ = try writeAndSync(segments)
+        try folderDB.write { db in
+            try TranscriptIndex.replaceSegments(db, videoId: videoId, segments: [])
+        }
+        // 重索引后 clips 被重新同步（管线重建 clips 或强制同步）
+        _ = try SyncEngine.sync(folderPath: folderPath, folderDB: folderDB, globalDB: globalDB, force: true)
+
+        XCTAssertTrue(try search("fox").isEmpty)
+        let count = try globalDB.read { try Int.fetchOne($0, sql: "SELECT COUNT(*) FROM transcript_segments") }
+        XCTAssertEqual(count, 0)
+    }
+
+    func testRemovingVideoDeletesGlobalSegments() throws {
+        _ = try writeAndSync(segments)
+        try VideoManager.removeVideo(
+            videoPath: "\(folderPath)/interview.mov",
+            folderPath: folderPath,
+            folderDB: folderDB,
+            globalDB: globalDB,
+            collector: nil
+        )
+
+        XCTAssertTrue(try search("fox").isEmpty)
+        let count = try globalDB.read { try Int.fetchOne($0, sql: "SELECT COUNT(*) FROM transcript_segments") }
+        XCTAssertEqual(count, 0)
+    }
+
+    func testSearchSkipsSegmentsWithoutVideo() throws {
+        _ = try writeAndSync(segments)
+        try globalDB.write { db in
+            try db.execute(sql: "DELETE FROM videos WHERE source_folder = ?", arguments: [folderPath])
+        }
+        XCTAssertTrue(try search("fox").isEmpty, "视频已删除的遗留片段不返回")
+    }
+
+    func testIncrementalSyncSkipsUnchangedSegments() throws {
+        _ = try writeAndSync(segments)
+        let again = try SyncEngine.sync(folderPath: folderPath, folderDB: folderDB, globalDB: globalDB)
+        XCTAssertEqual(again.syncedSegments, 0)
+    }
+
+    func testFolderFilterAndRemoval() throws {
+        _ = try writeAndSync(segments)
+        XCTAssertTrue(try globalDB.read {
+            try TranscriptIndex.search($0, query: "fox", folderPaths: ["/other"])
+        }.isEmpty)
+
+        try SyncEngine.removeFolderData(folderPath: folderPath, from: globalDB)
+        XCTAssertTrue(try search("fox").isEmpty)
+    }
+
+    func testMatchTimeFallsBackToStartWithoutMarker() {
+        XCTAssertEqual(TranscriptIndex.matchTime(marked: "plain", startTime: 3, endTime: 5), 3)
+    }
+}
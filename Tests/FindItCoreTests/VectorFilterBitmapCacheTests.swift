@@ -0,0 +1,175 @@
+import XCTest
+import GRDB
+@testable import FindItCore
+
+final class VectorFilterBitmapCacheTests: XCTestCase {
+
+    // MARK: - Helper
+
+    private func serialize(_ vector: [Float]) -> Data {
+        vector.withUnsafeBufferPointer { Data(buffer: $0) }
+    }
+
+    /// 全局库：/A 两条、/B 一条；/A 的第二条属于 /A/sub 下的视频
+    private func makeFixture() async throws -> (DatabaseQueue, VectorStore, [Int64]) {
+        let db = try DatabaseManager.makeGlobalInMemoryDatabase()
+        let ids: [Int64] = try db.write { dbConn in
+            try dbConn.execute(sql: """
+                INSERT INTO videos (source_folder, source_video_id, file_path, file_name)
+                VALUES ('/A', 1, '/A/sub/x.mov', 'x.mov')
+                """)
+            let videoId = dbConn.lastInsertedRowID
+            var ids: [Int64] = []
+            for (folder, sourceId, video) in [("/A", 1, nil), ("/A", 2, videoId), ("/B", 3, nil)] as [(String, Int64, Int64?)] {
+                try dbConn.execute(sql: """
+                    INSERT INTO clips (source_folder, source_clip_id, video_id, start_time, end_time)
+                    VALUES (?, ?, ?, 0, 5)
+                    """, arguments: [folder, sourceId, video])
+                ids.append(dbConn.lastInsertedRowID)
+            }
+            return ids
+        }
+
+        let store = VectorStore(dimensions: 2, embeddingModel: "test")
+        await store.load(entries: [
+            (clipId: ids[0], embeddingData: serialize([1, 0])),
+            (clipId: ids[1], embeddingData: serialize([0.9, 0.1])),
+            (clipId: ids[2], embeddingData: serialize([0.8, 0.2])),
+        ])
+        return (db, store, ids)
+    }
+
+    // MARK: - RowBitmap
+
+    func testRowBitmapSetOperations() async {
+        let store = VectorStore(dimensions: 2, embeddingModel: "test")
+        let layout = await store.layout
+        var a = RowBitmap(layout: layout, rowCount: 130)
+        var b = RowBitmap(layout: layout, rowCount: 130)
+        [0, 64, 129].forEach { a.insert($0) }
+        [64, 100].forEach { b.insert($0) }
+        a.insert(500) // 越界忽略
+
+        XCTAssertEqual(a.cardinality, 3)
+        XCTAssertTrue(a.contains(129))
+        XCTAssertFalse(a.contains(500))
+
+        var rows: [Int] = []
+        a.union(b).forEachRow { rows.append($0) }
+        XCTAssertEqual(rows, [0, 64, 100, 129])
+
+        rows.removeAll()
+        a.intersection(b).forEachRow { rows.append($0) }
+        XCTAssertEqual(rows, [64])
+    }
+
+    func testStoreLayoutChangesOnlyWhenRowsChange() async {
+        let store = VectorStore(dimensions: 2, embeddingModel: "test")
+        await store.append(clipId: 1, embedding: [1, 0])
+        let before = await store.layout
+
+        await store.append(clipId: 1, embedding: [0, 1]) // 原地替换
+        let afterReplace = await store.layout
+        XCTAssertEqual(before, afterReplace)
+
+        await store.append(clipId: 2, embedding: [1, 1])
+        let afterAppend = await store.layout
+        XCTAssertNotEqual(before, afterAppend)
+    }
+
+    func testSearchRejectsStaleBitmap() async {
+        let store = VectorStore(dimensions: 2, embeddingModel: "test")
+        await store.append(clipId: 1, embedding: [1, 0])
+        let bitmap = await store.rowBitmap(for: [1])
+        await store.append(clipId: 2, embedding: [0, 1])
+
+        let results = await store.search(query: [1, 0], limit: 5, allowedRows: bitmap)
+        XCTAssertNil(results)
+    }
+
+    // MARK: - Cache
+
+    func testFolderSwitchReusesCachedBitmaps() async throws {
+        let (db, store, ids) = try await makeFixture()
+        let cache = VectorFilterBitmapCache()
+
+        let a = try await cache.search(store: store, query: [0, 1], limit: 5, folders: ["/A"], pathPrefix: nil, db: db)
+        let b = try await cache.search(store: store, query: [0, 1], limit: 5, folders: ["/B"], pathPrefix: nil, db: db)
+        let both = try await cache.search(store: store, query: [0, 1], limit: 5, folders: ["/A", "/B"], pathPrefix: nil, db: db)
+        _ = try await cache.search(store: store, query: [0, 1], limit: 5, folders: ["/A"], pathPrefix: nil, db: db)
+
+        XCTAssertEqual(Set(a.map(\.clipId)), [ids[0], ids[1]])
+        XCTAssertEqual(b.map(\.clipId), [ids[2]])
+        XCTAssertEqual(both.count, 3)
+        let stats = await cache.stats
+        XCTAssertEqual(stats.misses, 2, "每个文件夹只查询一次")
+        XCTAssertEqual(stats.hits, 3)
+    }
+
+    func testFolderAndPathPrefixIntersect() async throws {
+        let (db, store, ids) = try await makeFixture()
+        let cache = VectorFilterBitmapCache()
+
+        let results = try await cache.search(
+            store: store, query: [1, 0], limit: 5,
+            folders: ["/A", "/B"], pathPrefix: "/A/sub", db: db
+        )
+
+        XCTAssertEqual(results.map(\.clipId), [ids[1]])
+    }
+
+    func testEmptyFolderFilterReturnsNothing() async throws {
+        let (db, store, _) = try await makeFixture()
+        let cache = VectorFilterBitmapCache()
+
+        let results = try await cache.search(store: store, query: [1, 0], limit: 5, folders: [], pathPrefix: nil, db: db)
+        XCTAssertTrue(results.isEmpty)
+    }
+
+    func testBitmapRebuiltAfterStoreRemoval() async throws {
+        let (db, store, ids) = try await makeFixture()
+        let cache = VectorFilterBitmapCache()
+
+        _ = try await cache.search(store: store, query: [1, 0], limit: 5, folders: ["/A"], pathPrefix: nil, db: db)
+        await store.remove(clipId: ids[0])
+        let results = try await cache.search(store: store, query: [1, 0], limit: 5, folders: ["/A"], pathPrefix: nil, db: db)
+
+        XCTAssertEqual(results.map(\.clipId), [ids[1]])
+        let stats = await cache.stats
+        XCTAssertEqual(stats.misses, 2, "布局变化后应重建位图")
+    }
+
+    func testPathRebaseInvalidatesPrefixBitmaps() async throws {
+        let (db, store, ids) = try await makeFixture()
+        let cache = VectorFilterBitmapCache()
+
+        let before = try await cache.search(store: store, query: [1, 0], limit: 5, folders: nil, pathPrefix: "/A/sub", db: db)
+        XCTAssertEqual(before.map(\.clipId), [ids[1]])
+        _ = try await cache.search(store: store, query: [1, 0], limit: 5, folders: ["/A"], pathPrefix: nil, db: db)
+
+        // 路径重定向：file_path 变化，clip_id 与 store 布局不变
+        try await db.write { dbConn in
+            try dbConn.execute(sql: "UPDATE videos SET file_path = '/A/moved/x.mov'")
+        }
+        await cache.invalidatePathPrefixes()
+
+        let stale = try await cache.search(store: store, query: [1, 0], limit: 5, folders: nil, pathPrefix: "/A/sub", db: db)
+        XCTAssertTrue(stale.isEmpty)
+        let moved = try await cache.search(store: store, query: [1, 0], limit: 5, folders: nil, pathPrefix: "/A/moved", db: db)
+        XCTAssertEqual(moved.map(\.clipId), [ids[1]])
+
+        _ = try await cache.search(store: store, query: [1, 0], limit: 5, folders: ["/A"], pathPrefix: nil, db: db)
+        let stats = await cache.stats
+        XCTAssertEqual(stats.hits, 1, "文件夹位图不受影响")
+    }
+
+    func testLayoutsOfDistinctStoresNeverCollide() async {
+        var layouts = Set<VectorStore.Layout>()
+        for _ in 0..<100 {
+            // 每个 store 用完即释放，地址可能被下一个复用
+            let store = VectorStore(dimensions: 2, embeddingModel: "test")
+            layouts.insert(await store.layout)
+        }
+        XCTAssertEqual(layouts.count, 100)
+    }
+}
@@ -0,0 +1,188 @@
+import XCTest
+import GRDB
+@testable import FindItCore
+
+final class VectorStoreSnapshotTests: XCTestCase {
+
+    private var tempDir: URL!
+
+    override func setUpWithError() throws {
+        tempDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("VectorStoreSnapshotTests-\(UUID().uuidString)")
+        try FileManager.default.createDirectory(at: tempDir, withIntermediateDirectories: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: tempDir)
+    }
+
+    // MARK: - Helper
+
+    private func serialize(_ vector: [Float]) -> Data {
+        vector.withUnsafeBufferPointer { Data(buffer: $0) }
+    }
+
+    @discardableResult
+    private func insertClip(_ db: DatabaseQueue, _ sourceId: Int64, _ vector: [Float]) throws -> Int64 {
+        try db.write { dbConn in
+            try dbConn.execute(sql: """
+                INSERT INTO clips (source_folder, source_clip_id, start_time, end_time, embedding, embedding_model)
+                VALUES ('/A', ?, 0, 5, ?, 'test')
+                """, arguments: [sourceId, serialize(vector)])
+            return dbConn.lastInsertedRowID
+        }
+    }
+
+    private let fingerprint = VectorStoreSnapshot.Fingerprint(clipCount: 2, maxClipId: 8, lastSyncedAt: nil)
+
+    // MARK: - Snapshot
+
+    func testWriteAndReadRoundTrip() async throws {
+        let store = VectorStore(dimensions: 3, embeddingModel: "test")
+        await store.append(clipId: 5, embedding: [1, 0, 0])
+        await store.append(clipId: 8, embedding: [0, 3, 4])
+        let url = tempDir.appendingPathComponent("v.snapshot")
+
+        try await VectorStoreSnapshot.write(store, fingerprint: fingerprint, to: url)
+        let contents = try VectorStoreSnapshot.read(from: url, dimensions: 3, embeddingModel: "test")
+
+        XCTAssertEqual(contents.clipIds, [5, 8])
+        XCTAssertEqual(contents.norms, [1, 5])
+        XCTAssertEqual(contents.vectors, [1, 0, 0, 0, 3, 4])
+        XCTAssertEqual(contents.fingerprint, fingerprint.encoded)
+
+        let restored = VectorStore(dimensions: 3, embeddingModel: "test")
+        let ok = await restored.restore(clipIds: contents.clipIds, norms: contents.norms, vectors: contents.vectors)
+        XCTAssertTrue(ok)
+        let results = await restored.search(query: [0, 0.6, 0.8], limit: 1)
+        XCTAssertEqual(results.first?.clipId, 8)
+    }
+
+    func testCorruptedSnapshotFailsChecksum() throws {
+        var data = VectorStoreSnapshot.encode(
+            dimensions: 2, embeddingModel: "test", fingerprint: "x",
+            clipIds: [1], norms: [1], vectors: [1, 0]
+        )
+        data[data.count - 12] ^= 0xFF
+
+        XCTAssertThrowsError(try VectorStoreSnapshot.decode(data)) { error in
+            guard case VectorStoreSnapshotError.checksumMismatch = error else {
+                return XCTFail("期望 checksumMismatch，实际 \(error)")
+            }
+        }
+    }
+
+    func testModelMismatchIsRejected() async throws {
+        let store = VectorStore(dimensions: 3, embeddingModel: "test")
+        await store.append(clipId: 1, embedding: [1, 0, 0])
+        let url = tempDir.appendingPathComponent("v.snapshot")
+        try await VectorStoreSnapshot.write(store, fingerprint: fingerprint, to: url)
+
+        XCTAssertThrowsError(try VectorStoreSnapshot.read(from: url, dimensions: 3, embeddingModel: "other"))
+    }
+
+    // MARK: - Warmup
+
+    func testWarmupBuildsThenRestoresFromSnapshot() async throws {
+        let db = try DatabaseManager.makeGlobalInMemoryDatabase()
+        let a = try insertClip(db, 1, [1, 0, 0])
+        try insertClip(db, 2, [0, 1, 0])
+        let url = tempDir.appendingPathComponent("v.snapshot")
+
+        let first = VectorStoreWarmup(db: db, embeddingModel: "test", dimensions: 3, snapshotURL: url)
+        let built = await first.store()
+        let builtCount = await built?.count
+        XCTAssertEqual(builtCount, 2)
+        let firstStatus = await first.status
+        XCTAssertEqual(firstStatus, .ready(count: 2, fromSnapshot: false))
+        XCTAssertTrue(FileManager.default.fileExists(atPath: url.path))
+
+        let second = VectorStoreWarmup(db: db, embeddingModel: "test", dimensions: 3, snapshotURL: url)
+        let restored = await second.store()
+        let secondStatus = await second.status
+        XCTAssertEqual(secondStatus, .ready(count: 2, fromSnapshot: true))
+        let results = await restored?.search(query: [1, 0, 0], limit: 1)
+        XCTAssertEqual(results?.first?.clipId, a)
+    }
+
+    func testWarmupRebuildsWhenSnapshotIsStale() async throws {
+        let db = try DatabaseManager.makeGlobalInMemoryDatabase()
+        try insertClip(db, 1, [1, 0, 0])
+        let url = tempDir.appendingPathComponent("v.snapshot")
+
+        let first = VectorStoreWarmup(db: db, embeddingModel: "test", dimensions: 3, snapshotURL: url)
+        _ = await first.store()
+
+        // 快照之后新增 clip：指纹变化，应回退到数据库构建
+        let added = try insertClip(db, 2, [0, 0, 1])
+        let second = VectorStoreWarmup(db: db, embeddingModel: "test", dimensions: 3, snapshotURL: url)
+        let store = await second.store()
+
+        let status = await second.status
+        XCTAssertEqual(status, .ready(count: 2, fromSnapshot: false))
+        let hasAdded = await store?.contains(clipId: added)
+        XCTAssertEqual(hasAdded, true)
+    }
+
+    func testSaveLabelsSnapshotWithAppliedFingerprint() async throws {
+        let db = try DatabaseManager.makeGlobalInMemoryDatabase()
+        try insertClip(db, 1, [1, 0, 0])
+        let url = tempDir.appendingPathComponent("v.snapshot")
+
+        let first = VectorStoreWarmup(db: db, embeddingModel: "test", dimensions: 3, snapshotURL: url)
+        let store = try XCTUnwrap(await first.store())
+
+        // 已提交但尚未应用到 store 的同步：保存的快照不应声称包含它
+        let added = try insertClip(db, 2, [0, 0, 1])
+        await first.saveSnapshot()
+        let stale = VectorStoreWarmup(db: db, embeddingModel: "test", dimensions: 3, snapshotURL: url)
+        _ = await stale.store()
+        let staleStatus = await stale.status
+        XCTAssertEqual(staleStatus, .ready(count: 2, fromSnapshot: false))
+
+        // 应用增量后再保存：指纹随增量更新，快照可直接恢复
+        try FileManager.default.removeItem(at: url)
+        try await store.applySyncDelta(SyncEngine.SyncResult(syncedVideos: 0, syncedClips: 1, addedClipIds: [added]), from: db)
+        await first.saveSnapshot()
+        let fresh = VectorStoreWarmup(db: db, embeddingModel: "test", dimensions: 3, snapshotURL: url)
+        _ = await fresh.store()
+        let freshStatus = await fresh.status
+        XCTAssertEqual(freshStatus, .ready(count: 2, fromSnapshot: true))
+    }
+
+    func testRemovalDeltaKeepsSnapshotUsable() async throws {
+        let db = try DatabaseManager.makeGlobalInMemoryDatabase()
+        let kept = try insertClip(db, 1, [1, 0, 0])
+        let removed = try insertClip(db, 2, [0, 1, 0])
+        let url = tempDir.appendingPathComponent("v.snapshot")
+
+        let first = VectorStoreWarmup(db: db, embeddingModel: "test", dimensions: 3, snapshotURL: url)
+        let store = try XCTUnwrap(await first.store())
+
+        // 删除视频：按删除的 clip_id 增量移除后保存，无需丢弃快照重建
+        try db.write { try $0.execute(sql: "DELETE FROM clips WHERE clip_id = ?", arguments: [removed]) }
+        try await store.applySyncDelta(SyncEngine.SyncResult(syncedVideos: 0, syncedClips: 0, removedClipIds: [removed]), from: db)
+        await first.saveSnapshot()
+
+        let second = VectorStoreWarmup(db: db, embeddingModel: "test", dimensions: 3, snapshotURL: url)
+        let restored = await second.store()
+        let status = await second.status
+        XCTAssertEqual(status, .ready(count: 1, fromSnapshot: true))
+        let hasKept = await restored?.contains(clipId: kept)
+        XCTAssertEqual(hasKept, true)
+    }
+
+    func testInvalidateDiscardsSnapshotOnlyWhenAsked() async throws {
+        let db = try DatabaseManager.makeGlobalInMemoryDatabase()
+        try insertClip(db, 1, [1, 0, 0])
+        let url = tempDir.appendingPathComponent("v.snapshot")
+
+        let warmup = VectorStoreWarmup(db: db, embeddingModel: "test", dimensions: 3, snapshotURL: url)
+        _ = await warmup.store()
+        await warmup.invalidate()
+        XCTAssertTrue(FileManager.default.fileExists(atPath: url.path), "过期与否由指纹判定，普通失效保留快照")
+
+        await warmup.invalidate(discardingSnapshot: true)
+        XCTAssertFalse(FileManager.default.fileExists(atPath: url.path))
+    }
+}
@@ -369,4 +369,92 @@ final class VectorStoreTests: XCTestCase {
         XCTAssertEqual(results[0].clipId, clipB)
     }
 
+    // MARK: - 批量增量
+
+    func testBatchAppendInsertsAndReplaces() async {
+        let store = VectorStore(dimensions: 4, embeddingModel: "test")
+        await store.append(clipId: 1, embedding: [1, 0, 0, 0])
+
+        await store.append(entries: [
+            (clipId: 1, embeddingData: serialize([0, 0, 1, 0])),
+            (clipId: 2, embeddingData: serialize([0, 1, 0, 0])),
+        ])
+
+        let count = await store.count
+        XCTAssertEqual(count, 2)
+        let results = await store.search(query: [0, 0, 1, 0], limit: 1)
+        XCTAssertEqual(results.first?.clipId, 1, "已有 clip 应原地替换为新向量")
+    }
+
+    func testBatchRemovePreservesRemainingRows() async {
+        let store = VectorStore(dimensions: 4, embeddingModel: "test")
+        await store.load(entries: [
+            (clipId: 1, embeddingData: serialize([1, 0, 0, 0])),
+            (clipId: 2, embeddingData: serialize([0, 1, 0, 0])),
+            (clipId: 3, embeddingData: serialize([0, 0, 1, 0])),
+            (clipId: 4, embeddingData: serialize([0, 0, 0, 1])),
+        ])
+
+        await store.remove(clipIds: [1, 3, 999])
+
+        let count = await store.count
+        XCTAssertEqual(count, 2)
+        let hasOne = await store.contains(clipId: 1)
+        XCTAssertFalse(hasOne)
+
+        // 压缩后剩余行仍与各自向量对齐
+        let r2 = await store.search(query: [0, 1, 0, 0], limit: 1)
+        XCTAssertEqual(r2.first?.clipId, 2)
+        XCTAssertEqual(r2.first?.similarity ?? 0, 1.0, accuracy: 0.001)
+        let r4 = await store.search(query: [0, 0, 0, 1], limit: 1)
+        XCTAssertEqual(r4.first?.clipId, 4)
+        XCTAssertEqual(r4.first?.similarity ?? 0, 1.0, accuracy: 0.001)
+
+        // 删除后再追加仍可正确定位
+        await store.append(clipId: 5, embedding: [1, 0, 0, 0])
+        await store.remove(clipId: 2)
+        let r5 = await store.search(query: [1, 0, 0, 0], limit: 1)
+        XCTAssertEqual(r5.first?.clipId, 5)
+    }
+
+    func testApplySyncDeltaFromDatabase() async throws {
+        let db = try DatabaseManager.makeGlobalInMemoryDatabase()
+        let store = VectorStore(dimensions: 4, embeddingModel: "test")
+
+        func insertClip(_ sourceId: Int64, _ vector: [Float]?, model: String = "test") throws -> Int64 {
+            try db.write { dbConn in
+                try dbConn.execute(sql: """
+                    INSERT INTO clips (source_folder, source_clip_id, start_time, end_time, embedding, embedding_model)
+                    VALUES ('/A', ?, 0, 5, ?, ?)
+                    """, arguments: [sourceId, vector.map(serialize), model])
+                return dbConn.lastInsertedRowID
+            }
+        }
+
+        let kept = try insertClip(1, [1, 0, 0, 0])
+        let gone = try insertClip(2, [0, 1, 0, 0])
+        await store.load(entries: [
+            (clipId: kept, embeddingData: serialize([1, 0, 0, 0])),
+            (clipId: gone, embeddingData: serialize([0, 1, 0, 0])),
+        ])
+
+        // 新增一条、更新一条为其他模型（应被移除）、删除一条
+        let added = try insertClip(3, [0, 0, 1, 0])
+        try db.write { dbConn in
+            try dbConn.execute(sql: "UPDATE clips SET embedding_model = 'other' WHERE clip_id = ?", arguments: [kept])
+            try dbConn.execute(sql: "DELETE FROM clips WHERE clip_id = ?", arguments: [gone])
+        }
+
+        let delta = SyncEngine.SyncResult(
+            syncedVideos: 0, syncedClips: 2,
+            addedClipIds: [added], updatedClipIds: [kept], removedClipIds: [gone]
+        )
+        let applied = try await store.applySyncDelta(delta, from: db)
+
+        XCTAssertEqual(applied, 1)
+        let count = await store.count
+        XCTAssertEqual(count, 1)
+        let hasAdded = await store.contains(clipId: added)
+        XCTAssertTrue(hasAdded)
+    }
 }
@@ -0,0 +1,134 @@
+import XCTest
+import GRDB
+@testable import FindItCore
+
+final class VideoGroupedSearchTests: XCTestCase {
+
+    // MARK: - Helper
+
+    /// 与查询 [1, 0] 余弦相似度恰为 `similarity` 的单位向量
+    private func vector(similarity: Float) -> [Float] {
+        [similarity, (1 - similarity * similarity).squareRoot()]
+    }
+
+    /// 视频 1：一个极佳 clip + 一个弱 clip；视频 2：三个较好 clip
+    private func makeStore() async -> VectorStore {
+        let store = VectorStore(dimensions: 2, embeddingModel: "test")
+        let clips: [(Int64, Float)] = [(10, 1.0), (11, 0.5), (20, 0.95), (21, 0.94), (22, 0.93)]
+        for (clipId, similarity) in clips {
+            await store.append(clipId: clipId, embedding: vector(similarity: similarity))
+        }
+        await store.assignVideos([10: 1, 11: 1, 20: 2, 21: 2, 22: 2])
+        return store
+    }
+
+    // MARK: - 聚合
+
+    func testMaxAggregationOneHitPerVideo() async {
+        let store = await makeStore()
+        let hits = await store.searchVideos(query: [1, 0], limit: 10, clipsPerVideo: 2)
+
+        XCTAssertEqual(hits.map(\.videoId), [1, 2])
+        XCTAssertEqual(hits[0].score, 1.0, accuracy: 1e-5)
+        XCTAssertEqual(hits[0].clips.map(\.clipId), [10, 11])
+        XCTAssertEqual(hits[1].clips.map(\.clipId), [20, 21], "每个视频只附带 clipsPerVideo 个")
+    }
+
+    func testTopSumRewardsRepeatedMatches() async {
+        let store = await makeStore()
+        let hits = await store.searchVideos(query: [1, 0], limit: 10, clipsPerVideo: 1, aggregation: .topSum(3))
+
+        XCTAssertEqual(hits.map(\.videoId), [2, 1])
+        XCTAssertEqual(hits[0].score, 0.95 + 0.94 + 0.93, accuracy: 1e-4)
+        XCTAssertEqual(hits[1].score, 1.0 + 0.5, accuracy: 1e-4, "不足 n 个时只累加已有")
+        XCTAssertEqual(hits[0].clips.count, 1)
+    }
+
+    func testLimitCountsVideosNotClips() async {
+        let store = await makeStore()
+        let hits = await store.searchVideos(query: [1, 0], limit: 1, aggregation: .topSum(3))
+        XCTAssertEqual(hits.count, 1)
+        XCTAssertEqual(hits[0].videoId, 2)
+    }
+
+    func testUnassignedRowsAreSingletons() async {
+        let store = await makeStore()
+        await store.append(clipId: 30, embedding: vector(similarity: 0.97))
+        await store.append(clipId: 31, embedding: vector(similarity: 0.96))
+
+        let hits = await store.searchVideos(query: [1, 0], limit: 10)
+        XCTAssertEqual(hits.map { $0.clips.map(\.clipId) }, [[10, 11], [30], [31], [20, 21, 22]])
+        XCTAssertNil(hits[1].videoId)
+        let unassigned = await store.unassignedVideoClipIds()
+        XCTAssertEqual(unassigned.sorted(), [30, 31])
+    }
+
+    func testAllowedClipIDsFilterBeforeAggregation() async {
+        let store = await makeStore()
+        let hits = await store.searchVideos(query: [1, 0], limit: 10, allowedClipIDs: [11, 22])
+        XCTAssertEqual(hits.map(\.videoId), [2, 1])
+        XCTAssertEqual(hits.map { $0.clips.map(\.clipId) }, [[22], [11]])
+    }
+
+    func testGroupsSurviveRemoval() async {
+        let store = await makeStore()
+        await store.remove(clipIds: [10, 20])
+
+        let unassigned = await store.unassignedVideoClipIds()
+        XCTAssertTrue(unassigned.isEmpty, "压缩后分组随行移动")
+        let hits = await store.searchVideos(query: [1, 0], limit: 10)
+        XCTAssertEqual(hits.map(\.videoId), [2, 1])
+        XCTAssertEqual(hits.map { $0.clips.map(\.clipId) }, [[21, 22], [11]])
+    }
+
+    // MARK: - 同步 + 检索
+
+    func testVideoSearchAgainstSyncedLibrary() async throws {
+        let globalDB = try DatabaseManager.makeGlobalInMemoryDatabase()
+        let folderDB = try DatabaseManager.makeFolderInMemoryDatabase()
+        let folderPath = "/Volumes/A/素材"
+        try await folderDB.write { db in
+            var folder = WatchedFolder(folderPath: folderPath)
+            try folder.insert(db)
+            for (name, sims) in [("long.mov", [0.9, 0.89, 0.88]), ("short.mov", [0.92])] as [(String, [Float])] {
+                var video = Video(folderId: folder.folderId, filePath: "\(folderPath)/\(name)", fileName: name)
+                try video.insert(db)
+                for (i, similarity) in sims.enumerated() {
+                    var clip = Clip(
+                        videoId: video.videoId, startTime: Double(i) * 5, endTime: Double(i) * 5 + 5,
+                        embedding: EmbeddingUtils.serializeEmbedding(self.vector(similarity: similarity)),
+                        embeddingModel: "test"
+                    )
+                    try clip.insert(db)
+                }
+            }
+        }
+        _ = try SyncEngine.sync(folderPath: folderPath, folderDB: folderDB, globalDB: globalDB)
+
+        let entries = try await globalDB.read { db in
+            try Row.fetchAll(db, sql: "SELECT clip_id, embedding FROM clips").map { row -> (clipId: Int64, embeddingData: Data) in
+                (row["clip_id"], row["embedding"])
+            }
+        }
+        let store = VectorStore(dimensions: 2, embeddingModel: "test")
+        await store.load(entries: entries)
+
+        let byMax = try await SearchEngine.videoSearch(globalDB, store: store, queryEmbedding: [1, 0])
+        XCTAssertEqual(byMax.map(\.fileName), ["short.mov", "long.mov"])
+        XCTAssertEqual(byMax[1].clips.count, 3)
+        XCTAssertEqual(byMax[1].clips.map(\.startTime), [0, 5, 10], "clip 按相似度降序")
+        XCTAssertTrue(byMax.allSatisfy { $0.videoId != nil })
+
+        let bySum = try await SearchEngine.videoSearch(
+            globalDB, store: store, queryEmbedding: [1, 0], aggregation: .topSum(3)
+        )
+        XCTAssertEqual(bySum.map(\.fileName), ["long.mov", "short.mov"])
+        let refreshed = try await store.refreshVideoGroups(from: globalDB)
+        XCTAssertEqual(refreshed, 0, "分组已补齐，不再重复查询")
+
+        let elsewhere = try await SearchEngine.videoSearch(
+            globalDB, store: store, queryEmbedding: [1, 0], folderPaths: ["/Volumes/B/素材"]
+        )
+        XCTAssertTrue(elsewhere.isEmpty)
+    }
+}
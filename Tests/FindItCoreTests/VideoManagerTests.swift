@@ -186,7 +186,13 @@ final class VideoManagerTests: XCTestCase {
         try seedAndSync(videoCount: 3, clipsPerVideo: 2)
         XCTAssertEqual(try folderVideoCount(), 3)
 
-        let count = try VideoManager.removeVideos(
+        let remaining = try globalDB.read { db in
+            try Int64.fetchAll(db, sql: """
+                SELECT c.clip_id FROM clips c JOIN videos v ON v.video_id = c.video_id
+                WHERE v.file_name = 'video3.mp4'
+                """)
+        }
+        let result = try VideoManager.removeVideos(
             videoPaths: [
                 "\(folderPath)/video1.mp4",
                 "\(folderPath)/video2.mp4"
@@ -196,7 +202,9 @@ final class VideoManagerTests: XCTestCase {
             globalDB: globalDB
         )
 
-        XCTAssertEqual(count, 2)
+        XCTAssertEqual(result.removedFromFolder, 2)
+        XCTAssertEqual(result.removedGlobalClipIds.count, 4)
+        XCTAssertTrue(Set(result.removedGlobalClipIds).isDisjoint(with: remaining), "只返回被删除的全局 clip_id")
         XCTAssertEqual(try folderVideoCount(), 1)
         XCTAssertEqual(try folderClipCount(), 2)
         XCTAssertEqual(try globalVideoCount(), 1)
@@ -206,21 +214,22 @@ final class VideoManagerTests: XCTestCase {
     func testRemoveVideos_emptyList_returnsZero() throws {
         try seedAndSync(videoCount: 1, clipsPerVideo: 2)
 
-        let count = try VideoManager.removeVideos(
+        let result = try VideoManager.removeVideos(
             videoPaths: [],
             folderPath: folderPath,
             folderDB: folderDB,
             globalDB: globalDB
         )
 
-        XCTAssertEqual(count, 0)
+        XCTAssertEqual(result.removedFromFolder, 0)
+        XCTAssertTrue(result.removedGlobalClipIds.isEmpty)
         XCTAssertEqual(try folderVideoCount(), 1)
     }
 
     func testRemoveVideos_mixedExistingAndNonexistent() throws {
         try seedAndSync(videoCount: 2, clipsPerVideo: 1)
 
-        let count = try VideoManager.removeVideos(
+        let result = try VideoManager.removeVideos(
             videoPaths: [
                 "\(folderPath)/video1.mp4",      // 存在
                 "\(folderPath)/nonexistent.mp4",  // 不存在
@@ -231,7 +240,7 @@ final class VideoManagerTests: XCTestCase {
             globalDB: globalDB
         )
 
-        XCTAssertEqual(count, 2)
+        XCTAssertEqual(result.removedFromFolder, 2)
         XCTAssertEqual(try folderVideoCount(), 0)
     }
 
@@ -297,3 +306,154 @@ final class VideoManagerTests: XCTestCase {
         XCTAssertEqual(try folderVideoCount(), 0)
     }
 }
+
+// MARK: - 批量删除 + 文件回收
+
+final class FileGarbageCollectorTests: XCTestCase {
+
+    private var folderDB: DatabaseQueue!
+    private var globalDB: DatabaseQueue!
+    private var folderPath: String!
+
+    override func setUpWithError() throws {
+        folderDB = try DatabaseManager.makeFolderInMemoryDatabase()
+        globalDB = try DatabaseManager.makeGlobalInMemoryDatabase()
+        folderPath = FileManager.default.temporaryDirectory
+            .appendingPathComponent("gc-\(UUID().uuidString)").path
+        try FileManager.default.createDirectory(atPath: folderPath, withIntermediateDirectories: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(atPath: folderPath)
+        folderDB = nil
+        globalDB = nil
+    }
+
+    /// 插入视频并在磁盘上创建缩略图目录
+    private func seed(videoCount: Int) throws -> [String] {
+        var paths: [String] = []
+        try folderDB.write { db in
+            var folder = WatchedFolder(folderPath: folderPath)
+            try folder.insert(db)
+            for v in 1...videoCount {
+                var video = Video(folderId: folder.folderId, filePath: "\(folderPath!)/v\(v).mov", fileName: "v\(v).mov")
+                try video.insert(db)
+                var clip = Clip(videoId: video.videoId, startTime: 0, endTime: 5, scene: "场景\(v)")
+                try clip.insert(db)
+                let thumbDir = PipelineManager.thumbnailDirectory(folderPath: folderPath, videoId: video.videoId!)
+                try FileManager.default.createDirectory(atPath: thumbDir, withIntermediateDirectories: true)
+                FileManager.default.createFile(atPath: thumbDir + "/0.jpg", contents: Data([0xFF]))
+                paths.append(video.filePath)
+            }
+        }
+        _ = try SyncEngine.sync(folderPath: folderPath, folderDB: folderDB, globalDB: globalDB)
+        return paths
+    }
+
+    private func count(_ db: DatabaseQueue, _ table: String) throws -> Int {
+        try db.read { try Int.fetchOne($0, sql: "SELECT COUNT(*) FROM \(table)") ?? 0 }
+    }
+
+    private func thumbnailDirs() -> [String] {
+        let root = (folderPath as NSString).appendingPathComponent(".clip-index/thumbnails")
+        return (try? FileManager.default.contentsOfDirectory(atPath: root)) ?? []
+    }
+
+    func testBulkRemovalDefersFileCleanup() throws {
+        let paths = try seed(videoCount: 3)
+        XCTAssertEqual(thumbnailDirs().count, 3)
+
+        let removed = try VideoManager.removeVideos(
+            videoPaths: Array(paths.prefix(2)) + ["\(folderPath!)/missing.mov", paths[0]],
+            folderPath: folderPath, folderDB: folderDB, globalDB: globalDB,
+            collector: nil
+        )
+        XCTAssertEqual(removed.removedFromFolder, 2, "不存在与重复的路径忽略")
+        XCTAssertEqual(try count(folderDB, "videos"), 1)
+        XCTAssertEqual(try count(folderDB, "clips"), 1)
+        XCTAssertEqual(try count(globalDB, "videos"), 1)
+        XCTAssertEqual(try count(globalDB, "clips"), 1)
+
+        // 数据库已删除，文件仍在回收队列中
+        XCTAssertEqual(thumbnailDirs().count, 3)
+        XCTAssertEqual(try folderDB.read(FileGarbageCollector.pendingCount), 2)
+
+        let collected = try FileGarbageCollector().collectAll(folderDB: folderDB)
+        XCTAssertEqual(collected, 2)
+        XCTAssertEqual(thumbnailDirs().count, 1)
+        XCTAssertEqual(try folderDB.read(FileGarbageCollector.pendingCount), 0)
+    }
+
+    func testRemovalCollectsStageAudioAndPackEntries() throws {
+        let paths = try seed(videoCount: 1)
+        let videoId = try XCTUnwrap(folderDB.read { try Int64.fetchOne($0, sql: "SELECT video_id FROM videos") })
+
+        // 中断的转录留下的临时 WAV
+        let wavPath = StageArtifacts.audioPath(directory: folderPath, folderPath: folderPath, videoId: videoId)
+        FileManager.default.createFile(atPath: wavPath, contents: Data(repeating: 1, count: 64))
+        let audio = try XCTUnwrap(StageArtifacts.AudioFile.capture(path: wavPath))
+        try folderDB.write { db in
+            try StageArtifacts.save(db, audio, kind: .audio, videoId: videoId, fileHash: "h")
+        }
+
+        // 缩略图打包缓存中的条目
+        let packURL = URL(fileURLWithPath: folderPath).appendingPathComponent("thumbs.pack")
+        let thumbnails = ThumbnailService(packURL: packURL, maxPixelSize: 8)
+        let thumbPath = PipelineManager.thumbnailDirectory(folderPath: folderPath, videoId: videoId) + "/0.jpg"
+        let modified = try XCTUnwrap(
+            FileManager.default.attributesOfItem(atPath: thumbPath)[.modificationDate] as? Date
+        )
+        let key = ThumbnailService.cacheKey(path: thumbPath, modificationDate: modified, maxPixelSize: 8)
+        try ThumbnailPackStore(url: packURL)
+            .write(key: key, image: ThumbnailImage(width: 1, height: 1, pixels: [1, 2, 3, 4]))
+
+        try VideoManager.removeVideos(videoPaths: paths, folderPath: folderPath, folderDB: folderDB, collector: nil)
+        XCTAssertEqual(try count(folderDB, "stage_artifacts"), 0)
+        XCTAssertEqual(try folderDB.read(FileGarbageCollector.pendingCount), 2, "缩略图目录 + 临时 WAV")
+
+        try FileGarbageCollector(thumbnails: thumbnails).collectAll(folderDB: folderDB)
+        XCTAssertFalse(FileManager.default.fileExists(atPath: wavPath))
+        XCTAssertTrue(thumbnailDirs().isEmpty)
+        XCTAssertNil(try ThumbnailPackStore(url: packURL).read(key: key), "打包缓存条目随目录回收")
+    }
+
+    func testCollectBatchHonorsBatchSize() throws {
+        let paths = try seed(videoCount: 5)
+        try VideoManager.removeVideos(videoPaths: paths, folderPath: folderPath, folderDB: folderDB, collector: nil)
+
+        let collector = FileGarbageCollector(config: .init(batchSize: 2))
+        XCTAssertEqual(try collector.collectBatch(folderDB: folderDB), 2)
+        XCTAssertEqual(try folderDB.read(FileGarbageCollector.pendingCount), 3)
+        XCTAssertEqual(try collector.collectAll(folderDB: folderDB), 3)
+        XCTAssertTrue(thumbnailDirs().isEmpty)
+    }
+
+    func testQueueSurvivesAndSkipsMissingOrReferencedPaths() throws {
+        let srtPath = "\(folderPath!)/srt/keep.srt"
+        try FileManager.default.createDirectory(atPath: "\(folderPath!)/srt", withIntermediateDirectories: true)
+        FileManager.default.createFile(atPath: srtPath, contents: Data("1".utf8))
+        try folderDB.write { db in
+            var folder = WatchedFolder(folderPath: folderPath)
+            try folder.insert(db)
+            var video = Video(folderId: folder.folderId, filePath: "\(folderPath!)/a.mov", fileName: "a.mov", srtPath: srtPath)
+            try video.insert(db)
+            try FileGarbageCollector.enqueue(db, paths: [srtPath, "\(folderPath!)/gone", ""])
+        }
+        XCTAssertEqual(try folderDB.read(FileGarbageCollector.pendingCount), 2, "空路径不入队")
+
+        XCTAssertEqual(try FileGarbageCollector().collectAll(folderDB: folderDB), 2)
+        XCTAssertTrue(FileManager.default.fileExists(atPath: srtPath), "仍被视频引用的 SRT 不删除")
+    }
+
+    func testScheduledCollectorDrainsInBackground() async throws {
+        let paths = try seed(videoCount: 2)
+        let collector = FileGarbageCollector(config: .init(batchSize: 1, batchInterval: 0.01))
+        try VideoManager.removeVideos(videoPaths: paths, folderPath: folderPath, folderDB: folderDB, collector: collector)
+
+        for _ in 0..<200 where !thumbnailDirs().isEmpty {
+            try await Task.sleep(nanoseconds: 10_000_000)
+        }
+        XCTAssertTrue(thumbnailDirs().isEmpty)
+        XCTAssertEqual(try folderDB.read(FileGarbageCollector.pendingCount), 0)
+    }
+}
@@ -0,0 +1,158 @@
+import XCTest
+import GRDB
+@testable import FindItCore
+
+final class VisualSimilarityTests: XCTestCase {
+
+    private let extractor = TinyImageDescriptor()
+
+    // MARK: - 辅助
+
+    /// 按函数逐像素生成的测试图
+    private func image(size: Int = 32, _ pixel: (Int, Int) -> (UInt8, UInt8, UInt8)) -> ThumbnailImage {
+        var pixels: [UInt8] = []
+        for y in 0..<size {
+            for x in 0..<size {
+                let (r, g, b) = pixel(x, y)
+                pixels += [r, g, b, 255]
+            }
+        }
+        return ThumbnailImage(width: size, height: size, pixels: pixels)
+    }
+
+    /// 天空在上、草地在下的"风景"构图（offset 模拟曝光差异）
+    private func landscape(offset: Int = 0) -> ThumbnailImage {
+        image { _, y in
+            let o = UInt8(clamping: offset)
+            return y < 16 ? (90 &+ o, 150 &+ o, 230) : (60 &+ o, 140 &+ o, 50 &+ o)
+        }
+    }
+
+    /// 竖条纹 / 横条纹
+    private func stripes(vertical: Bool) -> ThumbnailImage {
+        image { x, y in ((vertical ? x : y) / 4) % 2 == 0 ? (30, 30, 30) : (220, 220, 220) }
+    }
+
+    private func cosine(_ a: [Float], _ b: [Float]) -> Float {
+        EmbeddingUtils.cosineSimilarity(a, b)
+    }
+
+    // MARK: - 描述子
+
+    func testDescriptorShapeAndNorm() {
+        let v = extractor.features(of: landscape())
+        XCTAssertEqual(v.count, extractor.dimensions)
+        let norm = v.reduce(0) { $0 + $1 * $1 }.squareRoot()
+        XCTAssertEqual(norm, 1, accuracy: 1e-4, "两部分各自归一化后等权拼接，整体单位长度")
+        XCTAssertEqual(v, extractor.features(of: landscape()), "确定性")
+    }
+
+    func testSimilarCompositionsAreNeighbors() {
+        let base = extractor.features(of: landscape())
+        let brighter = extractor.features(of: landscape(offset: 20))
+        let flipped = extractor.features(of: image { _, y in
+            y >= 16 ? (90, 150, 230) : (60, 140, 50)
+        })
+        XCTAssertGreaterThan(cosine(base, brighter), 0.95)
+        XCTAssertGreaterThan(cosine(base, brighter), cosine(base, flipped), "构图颠倒应比曝光差异更远")
+        // 去均值后微缩图部分反相，只剩相同的方向能量
+        XCTAssertLessThan(cosine(base, flipped), 0.6)
+        XCTAssertLessThan(cosine(base, extractor.features(of: stripes(vertical: false))), 0.5, "无关画面不应接近 1")
+    }
+
+    func testMeanCenteringPerChannel() {
+        let centered = TinyImageDescriptor.meanCentered([1, 10, 3, 20, 5, 30], channels: 2)
+        XCTAssertEqual(centered, [-2, -10, 0, 0, 2, 10])
+        XCTAssertEqual(TinyImageDescriptor.meanCentered([], channels: 3), [])
+    }
+
+    func testOrientationEnergySeparatesTextureDirection() {
+        let vertical = TinyImageDescriptor.orientationEnergy(
+            l: PixelStatistics.LabBuffer(stripes(vertical: true)).l, width: 32, height: 32
+        )
+        let horizontal = TinyImageDescriptor.orientationEnergy(
+            l: PixelStatistics.LabBuffer(stripes(vertical: false)).l, width: 32, height: 32
+        )
+        // 竖条纹：水平梯度（0°）；横条纹：垂直梯度（90°）
+        let bins = TinyImageDescriptor.orientationBins
+        func energy(_ h: [Float], bin: Int) -> Float {
+            stride(from: bin, to: h.count, by: bins).reduce(0) { $0 + h[$1] }
+        }
+        XCTAssertGreaterThan(energy(vertical, bin: 0), 0)
+        XCTAssertEqual(energy(vertical, bin: bins / 2), 0)
+        XCTAssertGreaterThan(energy(horizontal, bin: bins / 2), 0)
+        XCTAssertEqual(energy(horizontal, bin: 0), 0)
+    }
+
+    func testClipFeaturesAverageFrames() throws {
+        XCTAssertNil(extractor.clipFeatures(images: []))
+        let single = try XCTUnwrap(extractor.clipFeatures(images: [landscape()]))
+        XCTAssertEqual(cosine(single, extractor.features(of: landscape())), 1, accuracy: 1e-5)
+
+        let mixed = try XCTUnwrap(extractor.clipFeatures(images: [landscape(), stripes(vertical: true)]))
+        XCTAssertLessThan(cosine(mixed, single), 1)
+        XCTAssertGreaterThan(cosine(mixed, single), 0.5)
+    }
+
+    // MARK: - 同步 + 检索
+
+    func testSimilarClipsAfterSync() async throws {
+        let folderPath = "/Volumes/素材/外景"
+        let folderDB = try DatabaseManager.makeFolderInMemoryDatabase()
+        let globalDB = try DatabaseManager.makeGlobalInMemoryDatabase()
+
+        let frames = [landscape(), landscape(offset: 15), stripes(vertical: true), stripes(vertical: false)]
+        try await folderDB.write { [extractor] db in
+            var folder = WatchedFolder(folderPath: folderPath)
+            try folder.insert(db)
+            var video = Video(folderId: folder.folderId, filePath: "\(folderPath)/a.mov", fileName: "a.mov")
+            try video.insert(db)
+            for (i, frame) in frames.enumerated() {
+                let vector = try XCTUnwrap(extractor.clipFeatures(images: [frame]))
+                var clip = Clip(
+                    videoId: video.videoId, startTime: Double(i * 5), endTime: Double(i * 5 + 5),
+                    visualEmbedding: EmbeddingUtils.serializeEmbedding(vector), visualModel: extractor.name
+                )
+                try clip.insert(db)
+            }
+            var other = Clip(videoId: video.videoId, startTime: 20, endTime: 25,
+                             visualEmbedding: Data(count: 8), visualModel: "other-model")
+            try other.insert(db)
+        }
+        let sync = try SyncEngine.sync(folderPath: folderPath, folderDB: folderDB, globalDB: globalDB)
+
+        let store = try await VisualSimilarity.loadStore(from: globalDB, extractor: extractor)
+        let loaded = await store.count
+        XCTAssertEqual(loaded, 4, "只加载同一提取器的向量")
+
+        // 同步增量刷新走同一套 VectorStore 机制（读取 visual_* 列）
+        let incremental = VectorStore(dimensions: extractor.dimensions, embeddingModel: extractor.name, source: .visual)
+        try await incremental.applySyncDelta(sync, from: globalDB)
+        let incrementalCount = await incremental.count
+        XCTAssertEqual(incrementalCount, 4)
+
+        let firstId = try await globalDB.read { db in
+            try XCTUnwrap(Int64.fetchOne(db, sql: "SELECT clip_id FROM clips WHERE start_time = 0"))
+        }
+        let results = try await VisualSimilarity.similarClips(to: firstId, store: store, db: globalDB, limit: 3)
+        XCTAssertFalse(results.contains { $0.clipId == firstId }, "不含自身")
+        XCTAssertEqual(results.first?.startTime, 5, "曝光不同的同一构图最相似")
+        XCTAssertEqual(results.count, 3)
+
+        // 文件夹范围按行位图先过滤，再取 top-K
+        let bitmaps = VectorFilterBitmapCache()
+        let scoped = try await VisualSimilarity.similarClips(
+            to: firstId, store: store, db: globalDB, folderPaths: [folderPath], limit: 1, filterBitmaps: bitmaps
+        )
+        XCTAssertEqual(scoped.map(\.startTime), [5])
+        let elsewhere = try await VisualSimilarity.similarClips(
+            to: firstId, store: store, db: globalDB, folderPaths: ["/Volumes/其他"], filterBitmaps: bitmaps
+        )
+        XCTAssertTrue(elsewhere.isEmpty)
+        let bitmapStats = await bitmaps.stats
+        XCTAssertEqual(bitmapStats.misses, 2)
+
+        let missing = try await VisualSimilarity.similarClips(to: 9999, store: store, db: globalDB)
+        XCTAssertTrue(missing.isEmpty)
+    }
+}